@@ -1790,6 +1790,200 @@ def warp_54():
 
     return 'success'
 
+###############################################################################
+# Test ChunkAndWarpMulti() with several workers warping chunks concurrently
+
+def warp_55():
+
+    src_ds = gdal.Translate('', '../gcore/data/byte.tif',
+                            options = '-of MEM -outsize 400 400')
+    ref_ds = gdal.Warp('', src_ds, options = '-of MEM -r cubic -tr 2 2 -wm 0.1')
+    ref_cs = ref_ds.GetRasterBand(1).Checksum()
+    ref_ds = None
+
+    for options in [ '-multi -wm 0.1',
+                     '-multi -wm 0.1 -wo NUM_CHUNK_THREADS=1',
+                     '-multi -wm 0.1 -wo NUM_CHUNK_THREADS=4',
+                     '-multi -wm 0.1 -wo NUM_CHUNK_THREADS=ALL_CPUS -wo NUM_THREADS=2' ]:
+        dst_ds = gdal.Warp('', src_ds,
+                           options = '-of MEM -r cubic -tr 2 2 ' + options)
+        got_cs = dst_ds.GetRasterBand(1).Checksum()
+        dst_ds = None
+        if got_cs != ref_cs:
+            gdaltest.post_reason('fail')
+            print(options)
+            print(got_cs)
+            print(ref_cs)
+            return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test reusing source coordinate grids with SRC_COORD_CACHE
+
+def warp_56_error_handler(err_type, err_no, err_msg):
+    gdaltest.warp_56_msgs.append(err_msg)
+
+def warp_56():
+
+    src_ds = gdal.Translate('tmp/warp_56_src.tif', '../gcore/data/byte.tif',
+                            options = '-outsize 400 400')
+    ref_ds = gdal.Warp('', src_ds, options = '-of MEM -r cubic -tr 2 2 -wm 0.1')
+    ref_cs = ref_ds.GetRasterBand(1).Checksum()
+    ref_ds = None
+
+    # The first run fills the caches, and writes the grids in the directory.
+    # Next ones use the in-memory cache.
+    cache_dir = 'tmp/warp_56'
+    gdal.Mkdir(cache_dir, 0o755)
+    cached_files = []
+    for (options, cache_max) in [
+            ('-wo SRC_COORD_CACHE=YES -wo SRC_COORD_CACHE_DIR=' + cache_dir, None),
+            ('-wo SRC_COORD_CACHE=YES', None),
+            ('-wo SRC_COORD_CACHE=YES -wo NUM_THREADS=2', None),
+            # Grids too large to be cached
+            ('-wo SRC_COORD_CACHE=YES', '0') ]:
+        gdaltest.warp_56_msgs = []
+        gdal.SetConfigOption('GDAL_WARP_SRC_COORD_CACHE_MAX', cache_max)
+        gdal.SetConfigOption('CPL_DEBUG', 'ON')
+        gdal.PushErrorHandler(warp_56_error_handler)
+        dst_ds = gdal.Warp('', src_ds,
+                           options = '-of MEM -r cubic -tr 2 2 -wm 0.1 ' + options)
+        gdal.PopErrorHandler()
+        gdal.SetConfigOption('CPL_DEBUG', None)
+        gdal.SetConfigOption('GDAL_WARP_SRC_COORD_CACHE_MAX', None)
+        got_cs = dst_ds.GetRasterBand(1).Checksum()
+        dst_ds = None
+        if got_cs != ref_cs:
+            gdaltest.post_reason('fail')
+            print(options)
+            print(got_cs)
+            print(ref_cs)
+            return 'fail'
+
+        reused = [ msg for msg in gdaltest.warp_56_msgs
+                   if msg.find('WARP: Reusing cached source coordinate grid') == 0 ]
+        if len(cached_files) == 0:
+            # The grids of all chunks must have been written
+            cached_files = [ f for f in gdal.ReadDir(cache_dir) if f not in ['.', '..'] ]
+            if len(cached_files) == 0 or len(reused) != 0 or \
+               len([f for f in cached_files if not f.endswith('.grd')]) != 0:
+                gdaltest.post_reason('fail')
+                print(cached_files)
+                print(reused)
+                return 'fail'
+        elif len(reused) != len(cached_files):
+            # The grid of each chunk must come from the in-memory cache
+            gdaltest.post_reason('fail')
+            print(options)
+            print(gdaltest.warp_56_msgs)
+            return 'fail'
+
+    src_ds = None
+
+    # A new process must read the grids from the directory, and ignore
+    # corrupted ones.
+    import test_cli_utilities
+    if test_cli_utilities.get_gdalwarp_path() is not None:
+        for corrupted in [ False, True ]:
+            if corrupted:
+                for f in cached_files:
+                    fp = gdal.VSIFOpenL(cache_dir + '/' + f, 'rb+')
+                    gdal.VSIFWriteL('XXXXXXXX', 1, 8, fp)
+                    gdal.VSIFCloseL(fp)
+                expected_msg = 'WARP: Ignoring invalid or non matching'
+            else:
+                expected_msg = 'WARP: Reusing source coordinate grid from'
+
+            (ret, err) = gdaltest.runexternal_out_and_err(
+                test_cli_utilities.get_gdalwarp_path() +
+                ' --debug on -overwrite -r cubic -tr 2 2 -wm 0.1' +
+                ' -wo SRC_COORD_CACHE=YES -wo SRC_COORD_CACHE_DIR=' + cache_dir +
+                ' tmp/warp_56_src.tif tmp/warp_56_dst.tif')
+            if len([ line for line in err.split('\n') if line.find(expected_msg) == 0 ]) != len(cached_files):
+                gdaltest.post_reason('fail')
+                print(corrupted)
+                print(err)
+                return 'fail'
+
+            ds = gdal.Open('tmp/warp_56_dst.tif')
+            got_cs = ds.GetRasterBand(1).Checksum()
+            ds = None
+            if got_cs != ref_cs:
+                gdaltest.post_reason('fail')
+                print(corrupted)
+                print(got_cs)
+                print(ref_cs)
+                return 'fail'
+        gdal.GetDriverByName('GTiff').Delete('tmp/warp_56_dst.tif')
+
+    gdal.GetDriverByName('GTiff').Delete('tmp/warp_56_src.tif')
+    for f in gdal.ReadDir(cache_dir):
+        if f not in ['.', '..']:
+            gdal.Unlink(cache_dir + '/' + f)
+    gdal.Rmdir(cache_dir)
+
+    return 'success'
+
+###############################################################################
+# Test mode resampling on the various working data types, including values
+# that used to be handled specifically (-1 for Int16, signed zeros)
+
+def warp_57():
+
+    import struct
+
+    # Values of the 4 source pixels of each of the 2x2 destination pixels
+    # and the expected mode: on ties, the value that first reaches the
+    # highest count wins
+    tests = [ ( gdal.GDT_Byte, [ [ 3, 3, 200, 7 ], [ 255, 0, 255, 0 ],
+                                 [ 1, 2, 3, 3 ], [ 9, 9, 9, 9 ] ],
+                                 [ 3, 255, 3, 9 ] ),
+              ( gdal.GDT_Int16, [ [ -1, -1, 5, 7 ], [ -32768, 1, -32768, 1 ],
+                                  [ 32767, -1, 32767, 2 ], [ 4, 5, 6, 6 ] ],
+                                  [ -1, -32768, 32767, 6 ] ),
+              ( gdal.GDT_UInt16, [ [ 65535, 65535, 0, 1 ], [ 7, 8, 8, 7 ],
+                                   [ 1, 2, 3, 4 ], [ 0, 0, 0, 1 ] ],
+                                   [ 65535, 8, 1, 0 ] ),
+              ( gdal.GDT_Int32, [ [ -1, -1, 5, 7 ], [ 16777217, 16777216, 16777217, 3 ],
+                                  [ -2147483648, 2, -2147483648, 2 ], [ 4, 5, 6, 6 ] ],
+                                  [ -1, 16777217, -2147483648, 6 ] ),
+              ( gdal.GDT_Float32, [ [ 1.5, 1.5, 2.5, 3.5 ], [ 0.0, -0.0, 0.0, 1.5 ],
+                                    [ -2.5, 1, 1, -2.5 ], [ 1e30, 1e30, 1e30, 1 ] ],
+                                    [ 1.5, 0.0, 1, 1e30 ] ),
+              ( gdal.GDT_Float64, [ [ 0.1, 0.1, 0.2, 0.3 ], [ 1e-300, 2e-300, 2e-300, 1 ],
+                                    [ 5, 6, 7, 8 ], [ -1, -1, -1, -1 ] ],
+                                    [ 0.1, 2e-300, 5, -1 ] ),
+              ( gdal.GDT_CFloat32, [ [ 1.5, 1.5, 2.5, 3.5 ], [ 7, 8, 8, 7 ],
+                                     [ 1, 2, 3, 3 ], [ 4, 4, 4, 4 ] ],
+                                     [ 1.5, 8, 3, 4 ] ) ]
+
+    for (dt, blocks, expected) in tests:
+        src_ds = gdal.GetDriverByName('MEM').Create('', 4, 4, 1, dt)
+        src_ds.SetGeoTransform([0, 1, 0, 4, 0, -1])
+        values = [ 0 ] * 16
+        for i in range(4):
+            (x0, y0) = ((i % 2) * 2, (i // 2) * 2)
+            for j in range(4):
+                values[(y0 + j // 2) * 4 + x0 + j % 2] = blocks[i][j]
+        src_ds.GetRasterBand(1).WriteRaster(0, 0, 4, 4,
+                                            struct.pack('d' * 16, *values),
+                                            buf_type = gdal.GDT_Float64)
+
+        dst_ds = gdal.Warp('', src_ds, options = '-of MEM -r mode -tr 2 2')
+        got = struct.unpack('d' * 4, dst_ds.GetRasterBand(1).ReadRaster(
+                                        buf_type = gdal.GDT_Float64))
+        if dt == gdal.GDT_Float32:
+            expected = [ struct.unpack('f', struct.pack('f', x))[0] for x in expected ]
+        if list(got) != expected:
+            gdaltest.post_reason('fail')
+            print(gdal.GetDataTypeName(dt))
+            print(got)
+            print(expected)
+            return 'fail'
+
+    return 'success'
+
 
 gdaltest_list = [
     warp_1,
@@ -1862,7 +2056,10 @@ gdaltest_list = [
     warp_51,
     warp_52,
     warp_53,
-    warp_54
+    warp_54,
+    warp_55,
+    warp_56,
+    warp_57
     ]
 #gdaltest_list = [ warp_54 ]
 
@@ -33,9 +33,12 @@
 #include <tut.h>
 #include <gdal.h>
 #include <gdal_priv.h>
+#include <gdal_proxy.h>
 #include <gdal_utils.h>
+#include <cpl_multiproc.h>
 #include <string>
 #include <limits>
+#include <vector>
 
 namespace tut
 {
@@ -321,4 +324,225 @@ namespace tut
 
     }
 
+
+    // Test prefetching of blocks by AdviseRead() with GDAL_ADVISE_READ_PREFETCH
+    template<> template<> void object::test<11>()
+    {
+        GDALDriverH hDrv = GDALGetDriverByName("GTiff");
+        if( hDrv == NULL )
+            return;
+        const char* const apszOptions[] = { "TILED=YES", "BLOCKXSIZE=16",
+                                            "BLOCKYSIZE=16", NULL };
+        const int nSize = 100;
+        GDALDatasetH hDS = GDALCreate(hDrv, "/vsimem/test_gdal_11.tif",
+                                      nSize, nSize, 2, GDT_Byte,
+                                      const_cast<char**>(apszOptions));
+        ensure(hDS != NULL);
+        GByte abyRef[2 * nSize * nSize];
+        for( int i = 0; i < 2 * nSize * nSize; i++ )
+            abyRef[i] = static_cast<GByte>((i * 7) % 251);
+        ensure_equals( GDALDatasetRasterIO(hDS, GF_Write, 0, 0, nSize, nSize,
+                                           abyRef, nSize, nSize, GDT_Byte,
+                                           2, NULL, 0, 0, 0), CE_None );
+        GDALClose(hDS);
+
+        CPLSetConfigOption("GDAL_ADVISE_READ_PREFETCH", "YES");
+        hDS = GDALOpen("/vsimem/test_gdal_11.tif", GA_ReadOnly);
+        ensure(hDS != NULL);
+        GByte abyBuffer[2 * nSize * nSize];
+        memset(abyBuffer, 0, sizeof(abyBuffer));
+        for( int iYOff = 0; iYOff < nSize; iYOff += 25 )
+        {
+            ensure_equals( GDALDatasetAdviseRead(hDS, 0, iYOff, nSize, 25,
+                                                 nSize, 25, GDT_Byte, 0, NULL,
+                                                 NULL), CE_None );
+            ensure_equals( GDALDatasetRasterIO(hDS, GF_Read, 0, iYOff,
+                                               nSize, 25,
+                                               abyBuffer + iYOff * nSize,
+                                               nSize, 25, GDT_Byte,
+                                               2, NULL, 0, 0,
+                                               nSize * nSize), CE_None );
+        }
+        ensure( memcmp(abyBuffer, abyRef, sizeof(abyRef)) == 0 );
+
+        // Close while blocks are likely still being prefetched.
+        ensure_equals( GDALDatasetAdviseRead(hDS, 0, 0, nSize, nSize,
+                                             nSize, nSize, GDT_Byte, 0, NULL,
+                                             NULL), CE_None );
+        GDALClose(hDS);
+        CPLSetConfigOption("GDAL_ADVISE_READ_PREFETCH", NULL);
+
+        VSIUnlink("/vsimem/test_gdal_11.tif");
+    }
+
+    struct ProxyPoolReaderArgs
+    {
+        GDALRasterBand* poBand;
+        const GByte*    pabyRef;
+        int             nSize;
+        bool            bOK;
+    };
+
+    static void ProxyPoolReader(void* pData)
+    {
+        ProxyPoolReaderArgs* psArgs = static_cast<ProxyPoolReaderArgs*>(pData);
+        const int nSize = psArgs->nSize;
+        std::vector<GByte> abyBuffer(nSize * nSize);
+        for( int iIter = 0; iIter < 20 && psArgs->bOK; iIter++ )
+        {
+            for( int iYOff = 0; iYOff < nSize; iYOff += 10 )
+            {
+                if( psArgs->poBand->RasterIO(GF_Read, 0, iYOff, nSize, 10,
+                                             &abyBuffer[iYOff * nSize],
+                                             nSize, 10, GDT_Byte, 0, 0,
+                                             NULL) != CE_None )
+                {
+                    psArgs->bOK = false;
+                }
+            }
+            if( memcmp(&abyBuffer[0], psArgs->pabyRef, nSize * nSize) != 0 )
+                psArgs->bOK = false;
+        }
+    }
+
+    // Test concurrent reads of a GDALProxyPoolDataset from several threads
+    template<> template<> void object::test<12>()
+    {
+        GDALDriverH hDrv = GDALGetDriverByName("GTiff");
+        if( hDrv == NULL )
+            return;
+        const int nSize = 100;
+        GDALDatasetH hDS = GDALCreate(hDrv, "/vsimem/test_gdal_12.tif",
+                                      nSize, nSize, 1, GDT_Byte, NULL);
+        ensure(hDS != NULL);
+        std::vector<GByte> abyRef(nSize * nSize);
+        for( int i = 0; i < nSize * nSize; i++ )
+            abyRef[i] = static_cast<GByte>((i * 13) % 253);
+        ensure_equals( GDALDatasetRasterIO(hDS, GF_Write, 0, 0, nSize, nSize,
+                                           &abyRef[0], nSize, nSize, GDT_Byte,
+                                           1, NULL, 0, 0, 0), CE_None );
+        GDALClose(hDS);
+
+        for( int bShared = FALSE; bShared <= TRUE; bShared++ )
+        {
+            GDALProxyPoolDataset* poProxyDS = new GDALProxyPoolDataset(
+                "/vsimem/test_gdal_12.tif", nSize, nSize, GA_ReadOnly,
+                bShared);
+            poProxyDS->AddSrcBandDescription(GDT_Byte, nSize, 1);
+
+            const int nThreads = 4;
+            ProxyPoolReaderArgs asArgs[nThreads];
+            CPLJoinableThread* ahThreads[nThreads];
+            for( int i = 0; i < nThreads; i++ )
+            {
+                asArgs[i].poBand = poProxyDS->GetRasterBand(1);
+                asArgs[i].pabyRef = &abyRef[0];
+                asArgs[i].nSize = nSize;
+                asArgs[i].bOK = true;
+                ahThreads[i] = CPLCreateJoinableThread(ProxyPoolReader,
+                                                       &asArgs[i]);
+                ensure(ahThreads[i] != NULL);
+            }
+            for( int i = 0; i < nThreads; i++ )
+            {
+                CPLJoinThread(ahThreads[i]);
+                ensure(asArgs[i].bOK);
+            }
+
+            delete poProxyDS;
+        }
+
+        VSIUnlink("/vsimem/test_gdal_12.tif");
+    }
+
+    // Test concurrent reads of the mask and overview bands of a
+    // GDALProxyPoolDataset from several threads
+    template<> template<> void object::test<13>()
+    {
+        GDALDriverH hDrv = GDALGetDriverByName("GTiff");
+        if( hDrv == NULL )
+            return;
+        const int nSize = 100;
+        const int nOvrSize = nSize / 2;
+        GDALDatasetH hDS = GDALCreate(hDrv, "/vsimem/test_gdal_13.tif",
+                                      nSize, nSize, 1, GDT_Byte, NULL);
+        ensure(hDS != NULL);
+        std::vector<GByte> abyRef(nSize * nSize);
+        std::vector<GByte> abyMaskRef(nSize * nSize);
+        for( int i = 0; i < nSize * nSize; i++ )
+        {
+            abyRef[i] = static_cast<GByte>((i * 13) % 253);
+            abyMaskRef[i] = (i % 3) ? 255 : 0;
+        }
+        ensure_equals( GDALDatasetRasterIO(hDS, GF_Write, 0, 0, nSize, nSize,
+                                           &abyRef[0], nSize, nSize, GDT_Byte,
+                                           1, NULL, 0, 0, 0), CE_None );
+        CPLSetConfigOption("GDAL_TIFF_INTERNAL_MASK", "YES");
+        ensure_equals( GDALCreateDatasetMaskBand(hDS, GMF_PER_DATASET),
+                       CE_None );
+        CPLSetConfigOption("GDAL_TIFF_INTERNAL_MASK", NULL);
+        GDALRasterBandH hMaskBand =
+            GDALGetMaskBand(GDALGetRasterBand(hDS, 1));
+        ensure_equals( GDALRasterIO(hMaskBand, GF_Write, 0, 0, nSize, nSize,
+                                    &abyMaskRef[0], nSize, nSize, GDT_Byte,
+                                    0, 0), CE_None );
+        int nOvrFactor = 2;
+        ensure_equals( GDALBuildOverviews(hDS, "NEAREST", 1, &nOvrFactor,
+                                          0, NULL, NULL, NULL), CE_None );
+        std::vector<GByte> abyOvrRef(nOvrSize * nOvrSize);
+        GDALRasterBandH hOvrBand =
+            GDALGetOverview(GDALGetRasterBand(hDS, 1), 0);
+        ensure(hOvrBand != NULL);
+        ensure_equals( GDALRasterIO(hOvrBand, GF_Read, 0, 0,
+                                    nOvrSize, nOvrSize, &abyOvrRef[0],
+                                    nOvrSize, nOvrSize, GDT_Byte,
+                                    0, 0), CE_None );
+        GDALClose(hDS);
+
+        for( int bShared = FALSE; bShared <= TRUE; bShared++ )
+        {
+            GDALProxyPoolDataset* poProxyDS = new GDALProxyPoolDataset(
+                "/vsimem/test_gdal_13.tif", nSize, nSize, GA_ReadOnly,
+                bShared);
+            poProxyDS->AddSrcBandDescription(GDT_Byte, nSize, 1);
+            GDALRasterBand* poProxyBand = poProxyDS->GetRasterBand(1);
+            GDALRasterBand* poProxyMaskBand = poProxyBand->GetMaskBand();
+            GDALRasterBand* poProxyOvrBand = poProxyBand->GetOverview(0);
+            ensure(poProxyMaskBand != NULL);
+            ensure(poProxyOvrBand != NULL);
+
+            const int nThreads = 4;
+            ProxyPoolReaderArgs asArgs[nThreads];
+            CPLJoinableThread* ahThreads[nThreads];
+            for( int i = 0; i < nThreads; i++ )
+            {
+                if( (i % 2) == 0 )
+                {
+                    asArgs[i].poBand = poProxyMaskBand;
+                    asArgs[i].pabyRef = &abyMaskRef[0];
+                    asArgs[i].nSize = nSize;
+                }
+                else
+                {
+                    asArgs[i].poBand = poProxyOvrBand;
+                    asArgs[i].pabyRef = &abyOvrRef[0];
+                    asArgs[i].nSize = nOvrSize;
+                }
+                asArgs[i].bOK = true;
+                ahThreads[i] = CPLCreateJoinableThread(ProxyPoolReader,
+                                                       &asArgs[i]);
+                ensure(ahThreads[i] != NULL);
+            }
+            for( int i = 0; i < nThreads; i++ )
+            {
+                CPLJoinThread(ahThreads[i]);
+                ensure(asArgs[i].bOK);
+            }
+
+            delete poProxyDS;
+        }
+
+        VSIUnlink("/vsimem/test_gdal_13.tif");
+    }
+
 } // namespace tut
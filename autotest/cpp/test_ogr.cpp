@@ -31,8 +31,11 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 #include <tut.h>
+#include <tut_gdal.h>
+#include <gdal_common.h>
 #include <ogrsf_frmts.h>
 #include <string>
+#include <vector>
 
 namespace tut
 {
@@ -463,4 +466,606 @@ namespace tut
       OGR_SM_Destroy(hSM);
     }
 
+    // Test that the compiled evaluation of attribute filters gives the
+    // same results as the expression tree walker
+    template<>
+    template<>
+    void object::test<8>()
+    {
+        OGRFeatureDefn* poDefn = new OGRFeatureDefn("test");
+        poDefn->Reference();
+        {
+            OGRFieldDefn oFieldInt("int", OFTInteger);
+            poDefn->AddFieldDefn(&oFieldInt);
+            OGRFieldDefn oFieldInt64("int64", OFTInteger64);
+            poDefn->AddFieldDefn(&oFieldInt64);
+            OGRFieldDefn oFieldReal("real", OFTReal);
+            poDefn->AddFieldDefn(&oFieldReal);
+            OGRFieldDefn oFieldStr("str", OFTString);
+            poDefn->AddFieldDefn(&oFieldStr);
+            OGRFieldDefn oFieldDT("dt", OFTDateTime);
+            poDefn->AddFieldDefn(&oFieldDT);
+            OGRFieldDefn oFieldBool("bool", OFTInteger);
+            oFieldBool.SetSubType(OFSTBoolean);
+            poDefn->AddFieldDefn(&oFieldBool);
+        }
+
+        const int nFeatures = 12;
+        OGRFeature* apoFeatures[nFeatures];
+        const char* const apszStr[] = { "abc", "ABC", "a_c", "xyz", "", "m" };
+        for( int i = 0; i < nFeatures; i++ )
+        {
+            OGRFeature* poFeature = new OGRFeature(poDefn);
+            poFeature->SetFID(i);
+            if( i % 5 != 4 )
+                poFeature->SetField(0, i % 6);
+            if( i % 4 != 3 )
+                poFeature->SetField(1, static_cast<GIntBig>(i) * 2000000000);
+            if( i % 3 != 2 )
+                poFeature->SetField(2, i * 0.5);
+            if( i != 7 )
+                poFeature->SetField(3, apszStr[i % 6]);
+            if( i % 2 == 0 )
+                poFeature->SetField(4, 2016, 1, 1 + i / 2, 3, 4, 5, 0);
+            if( i != 5 )
+                poFeature->SetField(5, i % 2);
+            if( i % 3 == 0 )
+                poFeature->SetGeometryDirectly(new OGRPoint(i, i));
+            else if( i % 3 == 1 )
+                poFeature->SetStyleString("PEN(c:#FF0000)");
+            apoFeatures[i] = poFeature;
+        }
+
+        const char* const apszExpr[] = {
+            "int = 1", "int <> 1", "int >= 2", "int < 3 AND int64 > 0",
+            "int > 2 AND real < 3.5", "int IN (1, 3, 5)",
+            "int BETWEEN 2 AND 4", "real BETWEEN 1 AND 2.5",
+            "real IN (1.5, 2)", "real = 1", "int = 1.0",
+            "int64 > 5000000000", "int64 IN (4000000000, 6000000000)",
+            "str = 'abc'", "str <> 'abc'", "str > 'b'",
+            "str LIKE 'a%'", "str LIKE 'a!_%' ESCAPE '!'",
+            "str IN ('abc', 'XYZ')", "str BETWEEN 'a' AND 'm'",
+            "str IS NULL", "str IS NOT NULL", "NOT (int = 1)",
+            "NOT str = 'abc'", "int = 1 OR str = 'abc'",
+            "int IS NULL OR int > 3", "int > 3 OR int IS NULL",
+            "bool", "bool = 1", "NOT bool", "bool OR int = 0",
+            "bool AND int = 1", "int = 1 AND bool",
+            "int + 1 = 3", "int % 2 = 0 AND str IS NOT NULL",
+            "CONCAT(str, 'x') = 'abcx'", "SUBSTR(str, 1, 1) = 'a' OR int = 0",
+            "CAST(int AS CHARACTER(10)) = '1'",
+            "dt = '2016/01/02 03:04:05'", "dt > '2016/01/03'",
+            "dt IS NULL", "FID IN (0, 2)", "FID > 5",
+            "OGR_GEOMETRY = 'POINT'", "OGR_GEOM_WKT LIKE 'POINT%'",
+            "OGR_STYLE IS NULL AND real * 2 > 3", "1", "0", "int"
+        };
+
+        for( size_t iExpr = 0; iExpr < sizeof(apszExpr)/sizeof(apszExpr[0]);
+             iExpr++ )
+        {
+            OGRFeatureQuery oQueryTree;
+            OGRFeatureQuery oQueryCompiled;
+            ensure_equals(apszExpr[iExpr],
+                oQueryTree.Compile(poDefn, apszExpr[iExpr]), OGRERR_NONE);
+            ensure_equals(apszExpr[iExpr],
+                oQueryCompiled.Compile(poDefn, apszExpr[iExpr]), OGRERR_NONE);
+
+            for( int i = 0; i < nFeatures; i++ )
+            {
+                CPLSetConfigOption("OGR_FEATURE_QUERY_COMPILE", "NO");
+                const int bTree = oQueryTree.Evaluate(apoFeatures[i]);
+                CPLSetConfigOption("OGR_FEATURE_QUERY_COMPILE", NULL);
+                const int bCompiled = oQueryCompiled.Evaluate(apoFeatures[i]);
+                ensure_equals(CPLSPrintf("%s, feature %d", apszExpr[iExpr], i),
+                              bCompiled, bTree);
+            }
+        }
+
+        OGRFeatureQuery oQuery;
+        oQuery.Compile(poDefn, "int IN (1, 3) OR str LIKE 'a%'");
+        int nCount = 0;
+        for( int i = 0; i < nFeatures; i++ )
+            nCount += oQuery.Evaluate(apoFeatures[i]);
+        ensure_equals(nCount, 7);
+
+        for( int i = 0; i < nFeatures; i++ )
+            delete apoFeatures[i];
+        poDefn->Release();
+    }
+
+    // Test filling a feature batch and building features back from it
+    template<>
+    template<>
+    void object::test<9>()
+    {
+        OGRFeatureDefn* poDefn = new OGRFeatureDefn("test");
+        poDefn->Reference();
+        {
+            OGRFieldDefn oFieldInt("int", OFTInteger);
+            poDefn->AddFieldDefn(&oFieldInt);
+            OGRFieldDefn oFieldInt64("int64", OFTInteger64);
+            poDefn->AddFieldDefn(&oFieldInt64);
+            OGRFieldDefn oFieldReal("real", OFTReal);
+            poDefn->AddFieldDefn(&oFieldReal);
+            OGRFieldDefn oFieldStr("str", OFTString);
+            poDefn->AddFieldDefn(&oFieldStr);
+            OGRFieldDefn oFieldDT("dt", OFTDateTime);
+            poDefn->AddFieldDefn(&oFieldDT);
+            OGRFieldDefn oFieldBin("bin", OFTBinary);
+            poDefn->AddFieldDefn(&oFieldBin);
+            OGRFieldDefn oFieldIntList("intlist", OFTIntegerList);
+            poDefn->AddFieldDefn(&oFieldIntList);
+            OGRFieldDefn oFieldRealList("reallist", OFTRealList);
+            poDefn->AddFieldDefn(&oFieldRealList);
+            OGRFieldDefn oFieldStrList("strlist", OFTStringList);
+            poDefn->AddFieldDefn(&oFieldStrList);
+            OGRFieldDefn oFieldBool("bool", OFTInteger);
+            oFieldBool.SetSubType(OFSTBoolean);
+            poDefn->AddFieldDefn(&oFieldBool);
+        }
+
+        OGRFeatureBatch oBatch(poDefn);
+        ensure_equals(oBatch.GetFeatureCount(), 0);
+
+        // Several passes, so that buffers are reused and grown.
+        for( int nPass = 0; nPass < 3; nPass++ )
+        {
+            const int nFeatures = 50 + nPass * 60;
+            oBatch.Reset();
+            std::vector<OGRFeature*> apoFeatures;
+            for( int i = 0; i < nFeatures; i++ )
+            {
+                OGRFeature* poFeature = new OGRFeature(poDefn);
+                poFeature->SetFID(1000 + i);
+                if( i % 5 != 4 )
+                    poFeature->SetField(0, i);
+                if( i % 4 != 3 )
+                    poFeature->SetField(1, static_cast<GIntBig>(i) * 2000000000);
+                if( i % 3 != 2 )
+                    poFeature->SetField(2, i * 0.5);
+                if( i % 7 != 6 )
+                    poFeature->SetField(3, CPLSPrintf("value %d", i * nPass));
+                if( i % 2 == 0 )
+                    poFeature->SetField(4, 2016, 1, 1 + i % 28, 3, 4, 5.5f, 100);
+                if( i % 6 == 0 )
+                {
+                    GByte abyData[3] = { 1, static_cast<GByte>(i), 0 };
+                    poFeature->SetField(5, i % 4, abyData);
+                }
+                if( i % 3 == 0 )
+                {
+                    int anValues[3] = { i, -i, 3 };
+                    poFeature->SetField(6, i % 4, anValues);
+                }
+                if( i % 3 == 1 )
+                {
+                    double adfValues[2] = { i * 0.25, -1.5 };
+                    poFeature->SetField(7, 2, adfValues);
+                }
+                if( i % 4 == 1 )
+                {
+                    char** papszList = NULL;
+                    for( int j = 0; j < i % 3; j++ )
+                        papszList = CSLAddString(papszList,
+                                                 j == 0 ? "" : "foo");
+                    poFeature->SetField(8, papszList);
+                    CSLDestroy(papszList);
+                }
+                if( i % 5 != 2 )
+                    poFeature->SetField(9, i % 2);
+                if( i % 3 == 0 )
+                    poFeature->SetGeometryDirectly(new OGRPoint(i, -i, i));
+                else if( i % 3 == 1 )
+                {
+                    OGRLineString* poLS = new OGRLineString();
+                    for( int j = 0; j < i; j++ )
+                        poLS->addPoint(j, j * 2);
+                    poFeature->SetGeometryDirectly(poLS);
+                }
+                ensure_equals(oBatch.AddFeature(poFeature), i);
+                apoFeatures.push_back(poFeature);
+            }
+            ensure_equals(oBatch.GetFeatureCount(), nFeatures);
+
+            const int* panOffsets = oBatch.GetFieldOffsets(3);
+            ensure(panOffsets != NULL);
+            ensure(oBatch.GetFieldOffsets(0) == NULL);
+            const GByte* pabyValidity = oBatch.GetFieldValidity(0);
+            const int* panValues =
+                static_cast<const int*>(oBatch.GetFieldValues(0));
+            for( int i = 0; i < nFeatures; i++ )
+            {
+                ensure_equals(oBatch.GetFIDs()[i], 1000 + i);
+                const bool bSet = (pabyValidity[i / 8] & (1 << (i % 8))) != 0;
+                ensure_equals(bSet, i % 5 != 4);
+                if( bSet )
+                    ensure_equals(panValues[i], i);
+                if( i % 7 != 6 )
+                {
+                    ensure_equals(std::string(oBatch.GetFieldAsString(i, 3)),
+                                  std::string(CPLSPrintf("value %d",
+                                                         i * nPass)));
+                }
+                else
+                {
+                    ensure(oBatch.GetFieldAsString(i, 3) == NULL);
+                    ensure_equals(panOffsets[i + 1], panOffsets[i]);
+                }
+
+                int nBytes = 0;
+                const GByte* pabyWKB = oBatch.GetGeomFieldAsWKB(i, 0, &nBytes);
+                if( i % 3 == 2 )
+                    ensure(pabyWKB == NULL);
+                else
+                {
+                    ensure(pabyWKB != NULL);
+                    ensure_equals(nBytes, apoFeatures[i]->GetGeometryRef()->WkbSize());
+                    ensure_equals(pabyWKB[0], static_cast<GByte>(wkbNDR));
+                }
+
+                OGRFeature* poFeature = oBatch.GetFeature(i);
+                ensure(CPLSPrintf("pass %d, feature %d", nPass, i),
+                       poFeature->Equal(apoFeatures[i]));
+                delete poFeature;
+                delete apoFeatures[i];
+            }
+            ensure(oBatch.GetFeature(nFeatures) == NULL);
+        }
+
+        // Setters convert values as OGRFeature does.
+        oBatch.Reset();
+        OGRFeature oFeature(poDefn);
+        ensure_equals(oBatch.AddEmptyFeature(5), 0);
+        oBatch.SetField(0, "12");
+        oFeature.SetField(0, "12");
+        oBatch.SetField(1, 3);
+        oFeature.SetField(1, 3);
+        oBatch.SetField(2, static_cast<GIntBig>(4));
+        oFeature.SetField(2, static_cast<GIntBig>(4));
+        oBatch.SetField(3, 1.5);
+        oFeature.SetField(3, 1.5);
+        oBatch.SetField(4, "2016/03/04 05:06:07");
+        oFeature.SetField(4, "2016/03/04 05:06:07");
+        oBatch.SetField(6, "(2:3,4)");
+        oFeature.SetField(6, "(2:3,4)");
+        oBatch.SetField(9, 1);
+        oFeature.SetField(9, 1);
+        oBatch.SetField(0, "13");
+        oFeature.SetField(0, "13");
+        oBatch.SetField(8, "x");
+        oBatch.UnsetField(8);
+        oBatch.SetFID(6);
+        oFeature.SetFID(6);
+        ensure(!oBatch.IsFieldSet(8));
+        ensure(oBatch.IsFieldSet(9));
+        ensure_equals(oBatch.SetGeomFieldDirectly(1, new OGRPoint(0, 0)),
+                      OGRERR_FAILURE);
+        OGRFeature* poFeature = oBatch.GetFeature(0);
+        ensure(poFeature->Equal(&oFeature));
+        delete poFeature;
+
+        poDefn->Release();
+    }
+
+    static void check_batch_reading( OGRLayer* poLayer, int nBatchSize )
+    {
+        std::vector<OGRFeature*> apoFeatures;
+        poLayer->ResetReading();
+        OGRFeature* poFeature;
+        while( (poFeature = poLayer->GetNextFeature()) != NULL )
+            apoFeatures.push_back(poFeature);
+
+        OGRFeatureBatchH hBatch = OGR_FB_Create(
+            reinterpret_cast<OGRFeatureDefnH>(poLayer->GetLayerDefn()));
+        poLayer->ResetReading();
+        size_t nRead = 0;
+        int nCount;
+        while( (nCount = OGR_L_GetNextFeatureBatch(
+                    reinterpret_cast<OGRLayerH>(poLayer), hBatch,
+                    nBatchSize)) > 0 )
+        {
+            ensure(nCount <= nBatchSize);
+            ensure_equals(OGR_FB_GetFeatureCount(hBatch), nCount);
+            for( int i = 0; i < nCount; i++ )
+            {
+                ensure(nRead < apoFeatures.size());
+                poFeature = reinterpret_cast<OGRFeature*>(
+                    OGR_FB_GetFeature(hBatch, i));
+                ensure(CPLSPrintf("%s, feature " CPL_FRMT_GIB,
+                                  poLayer->GetName(), poFeature->GetFID()),
+                       poFeature->Equal(apoFeatures[nRead]));
+                delete poFeature;
+                nRead++;
+            }
+        }
+        ensure_equals(nRead, apoFeatures.size());
+        OGR_FB_Destroy(hBatch);
+
+        for( size_t i = 0; i < apoFeatures.size(); i++ )
+            delete apoFeatures[i];
+    }
+
+    // Test OGRLayer::GetNextFeatureBatch() on the drivers which implement
+    // it, and on the generic implementation used with filters
+    template<>
+    template<>
+    void object::test<10>()
+    {
+        std::string osPoly(tut::common::data_basedir);
+        osPoly += SEP;
+        osPoly += "poly.shp";
+        GDALDataset* poSrcDS = reinterpret_cast<GDALDataset*>(
+            GDALOpenEx(osPoly.c_str(), GDAL_OF_VECTOR, NULL, NULL, NULL));
+        ensure(poSrcDS != NULL);
+        OGRLayer* poSrcLayer = poSrcDS->GetLayer(0);
+        ensure(poSrcLayer != NULL);
+
+        check_batch_reading(poSrcLayer, 7);
+        check_batch_reading(poSrcLayer, 1000);
+        poSrcLayer->SetAttributeFilter("EAS_ID > 170");
+        check_batch_reading(poSrcLayer, 3);
+        poSrcLayer->SetAttributeFilter(NULL);
+
+        const char* const apszDrivers[] = { "CSV", "GPKG" };
+        const char* const apszFilenames[] = { "/vsimem/batch.csv",
+                                              "/vsimem/batch.gpkg" };
+        for( int iDriver = 0; iDriver < 2; iDriver++ )
+        {
+            GDALDriver* poDriver = reinterpret_cast<GDALDriver*>(
+                GDALGetDriverByName(apszDrivers[iDriver]));
+            if( poDriver == NULL )
+                continue;
+            GDALDataset* poDS = poDriver->Create(apszFilenames[iDriver],
+                                                 0, 0, 0, GDT_Unknown, NULL);
+            ensure(poDS != NULL);
+            char** papszOptions = CSLSetNameValue(NULL, "GEOMETRY", "AS_WKT");
+            poDS->CopyLayer(poSrcLayer, "poly", papszOptions);
+            CSLDestroy(papszOptions);
+            GDALClose(poDS);
+
+            poDS = reinterpret_cast<GDALDataset*>(
+                GDALOpenEx(apszFilenames[iDriver], GDAL_OF_VECTOR, NULL,
+                           NULL, NULL));
+            ensure(poDS != NULL);
+            OGRLayer* poLayer = poDS->GetLayer(0);
+            ensure(poLayer != NULL);
+            check_batch_reading(poLayer, 4);
+            poLayer->SetAttributeFilter("EAS_ID > 170");
+            check_batch_reading(poLayer, 4);
+            GDALClose(poDS);
+            poDriver->Delete(apszFilenames[iDriver]);
+        }
+
+        GDALClose(poSrcDS);
+    }
+
+    // Test OGRFeaturePool and feature pooling of layers
+    template<>
+    template<>
+    void object::test<11>()
+    {
+        OGRFeatureDefn* poDefn = new OGRFeatureDefn();
+        poDefn->Reference();
+        {
+            OGRFieldDefn oField("str", OFTString);
+            poDefn->AddFieldDefn(&oField);
+        }
+        {
+            OGRFieldDefn oField("strlist", OFTStringList);
+            poDefn->AddFieldDefn(&oField);
+        }
+        {
+            OGRFieldDefn oField("intlist", OFTIntegerList);
+            poDefn->AddFieldDefn(&oField);
+        }
+        {
+            OGRFieldDefn oField("binary", OFTBinary);
+            poDefn->AddFieldDefn(&oField);
+        }
+
+        OGRFeaturePool* poPool = new OGRFeaturePool(poDefn);
+        ensure_equals(poDefn->GetReferenceCount(), 2);
+
+        OGRFeature* poFeature = poPool->GetFeature();
+        OGRFeature* poFirstFeature = poFeature;
+        char* apszList[] = { (char*)"a", (char*)"bc", NULL };
+        int anList[] = { 1, 2, 3 };
+        GByte abyData[] = { 0, 1, 2, 3, 4 };
+        for( int iIter = 0; iIter < 3; iIter++ )
+        {
+            // Features are reset when reused.
+            ensure_equals(poFeature, poFirstFeature);
+            for( int i = 0; i < poDefn->GetFieldCount(); i++ )
+                ensure(!poFeature->IsFieldSet(i));
+            ensure_equals(poFeature->GetFID(), OGRNullFID);
+            ensure(poFeature->GetStyleString() == NULL);
+
+            // Grows the arena of the feature at each iteration, and then
+            // overflows it, as long strings are not stored in it.
+            CPLString osStr;
+            osStr.assign(100 * (iIter + 1) * (iIter + 1), 'x');
+            poFeature->SetField(0, "first value");
+            poFeature->SetField(0, osStr.c_str());
+            poFeature->SetField(1, apszList);
+            poFeature->SetField(2, 3, anList);
+            poFeature->SetField(3, 5, abyData);
+            poFeature->SetFID(iIter);
+            poFeature->SetStyleString("PEN(c:#FF0000)");
+
+            OGRFeature* poClone = poFeature->Clone();
+            ensure(poClone->Equal(poFeature));
+            ensure_equals(CPLString(poClone->GetFieldAsString(0)), osStr);
+            ensure_equals(CSLCount(poClone->GetFieldAsStringList(1)), 2);
+            ensure_equals(
+                CPLString(poClone->GetFieldAsStringList(1)[1]), "bc");
+            delete poClone;
+
+            // Unsetting a field holding arena memory must not free it.
+            poFeature->UnsetField(1);
+            poFeature->SetField(1, apszList);
+
+            OGRFeature::DestroyFeature(poFeature);
+            poFeature = poPool->GetFeature();
+        }
+
+        // Features are given back to the pool with OGR_F_Destroy() too,
+        // and may be deleted.
+        OGRFeature* poOtherFeature = poPool->GetFeature();
+        ensure(poOtherFeature != poFeature);
+        OGR_F_Destroy(reinterpret_cast<OGRFeatureH>(poOtherFeature));
+        OGRFeature* poThirdFeature = poPool->GetFeature();
+        ensure_equals(poThirdFeature, poOtherFeature);
+        poThirdFeature->SetField(0, "foo");
+        delete poThirdFeature;
+
+        // Features obtained after a change of the feature definition
+        // follow it.
+        {
+            OGRFieldDefn oField("int", OFTInteger);
+            poDefn->AddFieldDefn(&oField);
+        }
+        poFeature->SetField(4, 5);
+        OGRFeature::DestroyFeature(poFeature);
+        poFeature = poPool->GetFeature();
+        ensure_equals(poFeature->GetFieldCount(), 5);
+        poFeature->SetField(4, 5);
+        ensure_equals(poFeature->GetFieldAsInteger(4), 5);
+
+        // Features remain valid after the pool is released.
+        poPool->Release();
+        poFeature->SetField(0, "bar");
+        ensure_equals(CPLString(poFeature->GetFieldAsString(0)), "bar");
+        OGRFeature::DestroyFeature(poFeature);
+        ensure_equals(poDefn->GetReferenceCount(), 1);
+        poDefn->Release();
+
+        // Layer with feature pooling: features read are the same as without
+        std::string osPoly(tut::common::data_basedir);
+        osPoly += SEP;
+        osPoly += "poly.shp";
+        GDALDataset* poDS = reinterpret_cast<GDALDataset*>(
+            GDALOpenEx(osPoly.c_str(), GDAL_OF_VECTOR, NULL, NULL, NULL));
+        ensure(poDS != NULL);
+        OGRLayer* poLayer = poDS->GetLayer(0);
+        ensure(poLayer != NULL);
+        std::vector<OGRFeature*> apoFeatures;
+        while( (poFeature = poLayer->GetNextFeature()) != NULL )
+            apoFeatures.push_back(poFeature);
+
+        ensure(!poLayer->GetFeaturePooling());
+        poLayer->SetFeaturePooling(TRUE);
+        ensure(poLayer->GetFeaturePooling());
+        poLayer->ResetReading();
+        size_t iFeature = 0;
+        OGRFeature* poLastFeature = NULL;
+        int nReused = 0;
+        while( (poFeature = poLayer->GetNextFeature()) != NULL )
+        {
+            ensure(iFeature < apoFeatures.size());
+            ensure(poFeature->Equal(apoFeatures[iFeature]));
+            if( poFeature == poLastFeature )
+                nReused++;
+            poLastFeature = poFeature;
+            OGRFeature::DestroyFeature(poFeature);
+            iFeature++;
+        }
+        ensure_equals(iFeature, apoFeatures.size());
+        ensure_equals(nReused, static_cast<int>(iFeature) - 1);
+
+        // Feature kept after the layer is closed.
+        poLayer->ResetReading();
+        poFeature = poLayer->GetNextFeature();
+        GDALClose(poDS);
+        ensure(poFeature->Equal(apoFeatures[0]));
+        OGRFeature::DestroyFeature(poFeature);
+
+        for( size_t i = 0; i < apoFeatures.size(); i++ )
+            OGRFeature::DestroyFeature(apoFeatures[i]);
+    }
+
+    // Test WKB import and export of curve coordinates, in both byte orders
+    template<>
+    template<>
+    void object::test<12>()
+    {
+        for( int iDim = 0; iDim < 4; iDim++ )
+        {
+            const bool bHasZ = (iDim & 1) != 0;
+            const bool bHasM = (iDim & 2) != 0;
+
+            OGRLineString oLS;
+            OGRLinearRing* poRing = new OGRLinearRing();
+            const int nPoints = 101;
+            for( int i = 0; i < nPoints; i++ )
+            {
+                const double dfX = i * 1.25 - 3;
+                const double dfY = -i * 0.5 + 1e10;
+                const double dfZ = i * 3.0;
+                const double dfM = -1.0 / (i + 1);
+                OGRSimpleCurve* apoCurves[] = { &oLS, poRing };
+                for( int iCurve = 0; iCurve < 2; iCurve++ )
+                {
+                    if( iCurve == 1 && i == nPoints - 1 )
+                        break;
+                    if( bHasZ && bHasM )
+                        apoCurves[iCurve]->addPoint(dfX, dfY, dfZ, dfM);
+                    else if( bHasM )
+                        apoCurves[iCurve]->addPointM(dfX, dfY, dfM);
+                    else if( bHasZ )
+                        apoCurves[iCurve]->addPoint(dfX, dfY, dfZ);
+                    else
+                        apoCurves[iCurve]->addPoint(dfX, dfY);
+                }
+            }
+            poRing->closeRings();
+            OGRPolygon oPoly;
+            oPoly.addRingDirectly(poRing);
+
+            OGRGeometry* apoGeoms[] = { &oLS, &oPoly };
+            for( int iGeom = 0; iGeom < 2; iGeom++ )
+            {
+                OGRGeometry* poGeom = apoGeoms[iGeom];
+                for( int iOrder = 0; iOrder < 2; iOrder++ )
+                {
+                    const OGRwkbByteOrder eOrder =
+                        iOrder == 0 ? wkbNDR : wkbXDR;
+                    std::vector<GByte> abyWKB(poGeom->WkbSize());
+                    ensure_equals(poGeom->exportToWkb(eOrder, &abyWKB[0],
+                                                      wkbVariantIso),
+                                  OGRERR_NONE);
+                    OGRGeometry* poGeom2 = NULL;
+                    ensure_equals(OGRGeometryFactory::createFromWkb(
+                                      &abyWKB[0], NULL, &poGeom2,
+                                      static_cast<int>(abyWKB.size()),
+                                      wkbVariantIso),
+                                  OGRERR_NONE);
+                    ensure(poGeom2 != NULL);
+                    ensure(poGeom2->Equals(poGeom));
+                    ensure_equals(poGeom2->Is3D(), poGeom->Is3D());
+                    ensure_equals(poGeom2->IsMeasured(),
+                                  poGeom->IsMeasured());
+                    if( bHasM )
+                    {
+                        const OGRSimpleCurve* poCurve = (iGeom == 0) ?
+                            static_cast<OGRSimpleCurve*>(poGeom2) :
+                            static_cast<OGRPolygon*>(poGeom2)->getExteriorRing();
+                        const OGRSimpleCurve* poRefCurve = (iGeom == 0) ?
+                            static_cast<OGRSimpleCurve*>(poGeom) :
+                            static_cast<OGRPolygon*>(poGeom)->getExteriorRing();
+                        for( int i = 0; i < poCurve->getNumPoints(); i++ )
+                            ensure_equals(poCurve->getM(i),
+                                          poRefCurve->getM(i));
+                    }
+
+                    // Exporting again gives the same bytes
+                    std::vector<GByte> abyWKB2(poGeom2->WkbSize());
+                    ensure_equals(poGeom2->exportToWkb(eOrder, &abyWKB2[0],
+                                                       wkbVariantIso),
+                                  OGRERR_NONE);
+                    ensure(abyWKB == abyWKB2);
+                    delete poGeom2;
+                }
+            }
+        }
+    }
+
 } // namespace tut
@@ -119,6 +119,96 @@ static int test_two_pages()
     return TRUE;
 }
 
+static void test_prefetch_cbk(CPLVirtualMem* /* ctxt */,
+                  size_t nOffset,
+                  void* pPageToFill,
+                  size_t nToFill,
+                  void* pUserData)
+{
+    GByte* pabyBacking = (GByte*) pUserData;
+    memcpy(pPageToFill, pabyBacking + nOffset, nToFill);
+}
+
+static void test_prefetch_uncache_cbk(CPLVirtualMem* /* ctxt */,
+                  size_t nOffset,
+                  const void* pPageToBeEvicted,
+                  size_t nToBeEvicted,
+                  void* pUserData)
+{
+    GByte* pabyBacking = (GByte*) pUserData;
+    memcpy(pabyBacking + nOffset, pPageToBeEvicted, nToBeEvicted);
+}
+
+static void test_prefetch(const char* pszEviction)
+{
+    printf("test_prefetch(eviction=%s)\n", pszEviction);
+
+    const int nPages = 256;
+    const size_t nSize = nPages * MINIMUM_PAGE_SIZE;
+    GByte* pabyBacking = (GByte*) CPLMalloc(nSize);
+    for( size_t i = 0; i < nSize; i++ )
+        pabyBacking[i] = (GByte)((i / MINIMUM_PAGE_SIZE + i) % 251);
+
+    CPLSetConfigOption("CPL_VIRTUAL_MEM_EVICTION", pszEviction);
+    CPLVirtualMem* ctxt = CPLVirtualMemNew(nSize,
+                        64 * MINIMUM_PAGE_SIZE,
+                        MINIMUM_PAGE_SIZE,
+                        FALSE,
+                        VIRTUALMEM_READWRITE,
+                        test_prefetch_cbk,
+                        test_prefetch_uncache_cbk,
+                        NULL, pabyBacking);
+    CPLSetConfigOption("CPL_VIRTUAL_MEM_EVICTION", NULL);
+    assert(ctxt);
+    assert(CPLVirtualMemGetPageSize(ctxt) == MINIMUM_PAGE_SIZE);
+    GByte* pabyAddr = (GByte*) CPLVirtualMemGetAddr(ctxt);
+    CPLVirtualMemDeclareThread(ctxt);
+
+    /* Sequential scan: most pages should be prefetched */
+    for( size_t i = 0; i < nSize; i++ )
+        assert(pabyAddr[i] == (GByte)((i / MINIMUM_PAGE_SIZE + i) % 251));
+    CPLVirtualMemStats sStats;
+    assert(CPLVirtualMemGetStats(ctxt, &sStats));
+    printf("  faults=%d soft faults=%d prefetched=%d evicted=%d\n",
+           (int)sStats.nPageFaults, (int)sStats.nSoftFaults,
+           (int)sStats.nPrefetchedPages, (int)sStats.nEvictedPages);
+    assert(sStats.nPageFaults + sStats.nPrefetchedPages >= (GUIntBig)nPages);
+    assert(sStats.nPrefetchedPages > 0);
+    assert(sStats.nPageFaults < (GUIntBig)nPages / 2);
+    assert(sStats.nEvictedPages > 0);
+    assert(sStats.dfFaultWaitTime >= 0);
+
+    /* Random read and write accesses */
+    CPLVirtualMemResetStats(ctxt);
+    unsigned int nSeed = 1;
+    for( int i = 0; i < 10000; i++ )
+    {
+        nSeed = nSeed * 1103515245U + 12345U;
+        const size_t nIdx = (nSeed >> 4) % nSize;
+        if( (i % 3) == 0 )
+            pabyAddr[nIdx] = 255;
+        else
+            assert(pabyAddr[nIdx] == 255 ||
+                   pabyAddr[nIdx] == (GByte)((nIdx / MINIMUM_PAGE_SIZE + nIdx) % 251));
+    }
+    assert(CPLVirtualMemGetStats(ctxt, &sStats));
+    assert(sStats.nPageFaults > 0);
+
+    CPLVirtualMemUnDeclareThread(ctxt);
+    CPLVirtualMemFree(ctxt);
+
+    /* All the writes must have been flushed */
+    nSeed = 1;
+    for( int i = 0; i < 10000; i++ )
+    {
+        nSeed = nSeed * 1103515245U + 12345U;
+        const size_t nIdx = (nSeed >> 4) % nSize;
+        if( (i % 3) == 0 )
+            assert(pabyBacking[nIdx] == 255);
+    }
+    CPLFree(pabyBacking);
+}
+
 static void test_raw_auto(const char* pszFormat, int bFileMapping)
 {
     printf("test_raw_auto(format=%s, bFileMapping=%d)\n", pszFormat, bFileMapping);
@@ -227,6 +317,9 @@ int main(int /* argc */, char* /* argv */[])
     if( !test_two_pages() )
         return 0;
 
+    test_prefetch("FIFO");
+    test_prefetch("CLOCK");
+
     test_raw_auto("EHDR", TRUE);
     test_raw_auto("EHDR", FALSE);
     test_raw_auto("GTIFF", TRUE);
@@ -0,0 +1,303 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of the exact and approximate GenImgProj
+ *           transformers, as used by the warper, from several threads.
+ * Author:   Even Rouault, <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <math.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "cpl_conv.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+#include "gdal.h"
+#include "gdal_alg.h"
+#include "ogr_srs_api.h"
+
+static void Usage()
+{
+    printf("Usage: testperfapproxtransform [-width val] [-height val] "
+           "[-threads val] [-loops val] [-error val]\n"
+           "                               [-s_srs srs_def] "
+           "[-t_srs srs_def]\n");
+    exit(1);
+}
+
+typedef struct
+{
+    GDALDatasetH hSrcDS;
+    GDALDatasetH hDstDS;
+    double       dfMaxError;
+    int          nLoops;
+    double       dfMaxDiff;
+} ThreadData;
+
+/************************************************************************/
+/*                             ThreadFunc()                             */
+/*                                                                      */
+/*      Transform every pixel center of the destination dataset back   */
+/*      to the source, one scanline at a time, like the warper does.    */
+/*      The approximate transform is checked against the exact one.     */
+/************************************************************************/
+
+static void ThreadFunc( void* pData )
+{
+    ThreadData* psData = static_cast<ThreadData*>(pData);
+    const int nXSize = GDALGetRasterXSize(psData->hDstDS);
+    const int nYSize = GDALGetRasterYSize(psData->hDstDS);
+
+    // Each thread owns its transformers, as the warper workers do.
+    void* hBaseTransformer = GDALCreateGenImgProjTransformer2(
+        psData->hSrcDS, psData->hDstDS, NULL);
+    if( hBaseTransformer == NULL )
+        return;
+    void* hTransformer = hBaseTransformer;
+    GDALTransformerFunc pfnTransformer = GDALGenImgProjTransform;
+    if( psData->dfMaxError > 0 )
+    {
+        hTransformer = GDALCreateApproxTransformer(
+            GDALGenImgProjTransform, hBaseTransformer, psData->dfMaxError);
+        pfnTransformer = GDALApproxTransform;
+    }
+
+    double* padfX = static_cast<double*>(CPLMalloc(nXSize * sizeof(double)));
+    double* padfY = static_cast<double*>(CPLMalloc(nXSize * sizeof(double)));
+    double* padfZ = static_cast<double*>(CPLMalloc(nXSize * sizeof(double)));
+    double* padfXRef =
+        static_cast<double*>(CPLMalloc(nXSize * sizeof(double)));
+    double* padfYRef =
+        static_cast<double*>(CPLMalloc(nXSize * sizeof(double)));
+    int* panSuccess = static_cast<int*>(CPLMalloc(nXSize * sizeof(int)));
+
+    for( int iLoop = 0; iLoop < psData->nLoops; iLoop++ )
+    {
+        for( int iY = 0; iY < nYSize; iY++ )
+        {
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                padfX[iX] = iX + 0.5;
+                padfY[iX] = iY + 0.5;
+                padfZ[iX] = 0.0;
+            }
+            pfnTransformer(hTransformer, TRUE, nXSize,
+                           padfX, padfY, padfZ, panSuccess);
+
+            if( iLoop == 0 && pfnTransformer != GDALGenImgProjTransform )
+            {
+                for( int iX = 0; iX < nXSize; iX++ )
+                {
+                    padfXRef[iX] = iX + 0.5;
+                    padfYRef[iX] = iY + 0.5;
+                    padfZ[iX] = 0.0;
+                }
+                GDALGenImgProjTransform(hBaseTransformer, TRUE, nXSize,
+                                        padfXRef, padfYRef, padfZ,
+                                        panSuccess);
+                for( int iX = 0; iX < nXSize; iX++ )
+                {
+                    if( !panSuccess[iX] )
+                        continue;
+                    const double dfDiff = fabs(padfX[iX] - padfXRef[iX]) +
+                                          fabs(padfY[iX] - padfYRef[iX]);
+                    if( dfDiff > psData->dfMaxDiff )
+                        psData->dfMaxDiff = dfDiff;
+                }
+            }
+        }
+    }
+
+    CPLFree(padfX);
+    CPLFree(padfY);
+    CPLFree(padfZ);
+    CPLFree(padfXRef);
+    CPLFree(padfYRef);
+    CPLFree(panSuccess);
+
+    if( hTransformer != hBaseTransformer )
+        GDALDestroyApproxTransformer(hTransformer);
+    GDALDestroyGenImgProjTransformer(hBaseTransformer);
+}
+
+/************************************************************************/
+/*                                ToWKT()                               */
+/************************************************************************/
+
+static CPLString ToWKT( const char* pszUserInput )
+{
+    OGRSpatialReferenceH hSRS = OSRNewSpatialReference(NULL);
+    if( OSRSetFromUserInput(hSRS, pszUserInput) != OGRERR_NONE )
+        exit(1);
+    char* pszWKT = NULL;
+    OSRExportToWkt(hSRS, &pszWKT);
+    CPLString osWKT(pszWKT);
+    CPLFree(pszWKT);
+    OSRDestroySpatialReference(hSRS);
+    return osWKT;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    int nXSize = 2048;
+    int nYSize = 2048;
+    int nThreads = 1;
+    int nLoops = 5;
+    double dfMaxError = 0.125;
+    const char* pszSrcSRS = NULL;
+    const char* pszDstSRS = NULL;
+
+    argc = GDALGeneralCmdLineProcessor(argc, &argv, 0);
+    if( argc < 1 )
+        exit(-argc);
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "-width") && i + 1 < argc )
+            nXSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-height") && i + 1 < argc )
+            nYSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-threads") && i + 1 < argc )
+            nThreads = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-loops") && i + 1 < argc )
+            nLoops = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-error") && i + 1 < argc )
+            dfMaxError = CPLAtof(argv[++i]);
+        else if( EQUAL(argv[i], "-s_srs") && i + 1 < argc )
+            pszSrcSRS = argv[++i];
+        else if( EQUAL(argv[i], "-t_srs") && i + 1 < argc )
+            pszDstSRS = argv[++i];
+        else
+            Usage();
+    }
+    if( nXSize <= 0 || nYSize <= 0 || nThreads <= 0 || nLoops <= 0 ||
+        dfMaxError <= 0 || (pszSrcSRS == NULL) != (pszDstSRS == NULL) )
+        Usage();
+
+    GDALAllRegister();
+
+    // Without SRS, the source and target only differ by their geotransform,
+    // and the reprojection step of the GenImgProj transformer is skipped.
+    GDALDriverH hMemDriver = GDALGetDriverByName("MEM");
+    GDALDatasetH hSrcDS = GDALCreate(hMemDriver, "", 1000, 1000, 0,
+                                     GDT_Byte, NULL);
+    GDALDatasetH hDstDS = GDALCreate(hMemDriver, "", nXSize, nYSize, 0,
+                                     GDT_Byte, NULL);
+    if( pszSrcSRS != NULL )
+    {
+        // Source in geographic coordinates, target in the target SRS
+        // over the same area.
+        double adfSrcGT[6] = { -10.0, 0.02, 0.0, 50.0, 0.0, -0.02 };
+        GDALSetGeoTransform(hSrcDS, adfSrcGT);
+        CPLString osSrcWKT = ToWKT(pszSrcSRS);
+        CPLString osDstWKT = ToWKT(pszDstSRS);
+        GDALSetProjection(hSrcDS, osSrcWKT);
+        GDALSetProjection(hDstDS, osDstWKT);
+        char** papszOptions = CSLSetNameValue(NULL, "DST_SRS", osDstWKT);
+        void* hTransformArg =
+            GDALCreateGenImgProjTransformer2(hSrcDS, NULL, papszOptions);
+        CSLDestroy(papszOptions);
+        if( hTransformArg == NULL )
+            exit(1);
+        double adfDstGT[6];
+        int nPixels = 0;
+        int nLines = 0;
+        if( GDALSuggestedWarpOutput(hSrcDS, GDALGenImgProjTransform,
+                                    hTransformArg, adfDstGT,
+                                    &nPixels, &nLines) != CE_None )
+            exit(1);
+        GDALDestroyGenImgProjTransformer(hTransformArg);
+        adfDstGT[1] = adfDstGT[1] * nPixels / nXSize;
+        adfDstGT[5] = adfDstGT[5] * nLines / nYSize;
+        GDALSetGeoTransform(hDstDS, adfDstGT);
+    }
+    else
+    {
+        double adfSrcGT[6] = { 0.0, 1.0, 0.0, 1000.0, 0.0, -1.0 };
+        double adfDstGT[6] = { 10.0, 900.0 / nXSize, 0.1,
+                               990.0, 0.05, -900.0 / nYSize };
+        GDALSetGeoTransform(hSrcDS, adfSrcGT);
+        GDALSetGeoTransform(hDstDS, adfDstGT);
+    }
+
+    const char* const apszModes[] = { "exact", "approx" };
+    for( int iMode = 0; iMode < 2; iMode++ )
+    {
+        ThreadData* pasData = static_cast<ThreadData*>(
+            CPLCalloc(nThreads, sizeof(ThreadData)));
+        CPLJoinableThread** pahThreads = static_cast<CPLJoinableThread**>(
+            CPLCalloc(nThreads, sizeof(CPLJoinableThread*)));
+
+        const clock_t start = clock();
+        for( int i = 0; i < nThreads; i++ )
+        {
+            pasData[i].hSrcDS = hSrcDS;
+            pasData[i].hDstDS = hDstDS;
+            pasData[i].dfMaxError = iMode == 0 ? 0.0 : dfMaxError;
+            pasData[i].nLoops = nLoops;
+            pahThreads[i] = CPLCreateJoinableThread(ThreadFunc, &pasData[i]);
+        }
+        double dfMaxDiff = 0.0;
+        for( int i = 0; i < nThreads; i++ )
+        {
+            CPLJoinThread(pahThreads[i]);
+            if( pasData[i].dfMaxDiff > dfMaxDiff )
+                dfMaxDiff = pasData[i].dfMaxDiff;
+        }
+        // clock() accumulates the CPU time of all threads, so this is
+        // the throughput of a single thread.
+        const double dfTime = (clock() - start) * 1.0 / CLOCKS_PER_SEC;
+        const double dfPoints =
+            static_cast<double>(nXSize) * nYSize * nLoops * nThreads;
+
+        printf("%s, %d thread(s): %.2f s, %.1f Mpoints/s per thread",
+               apszModes[iMode], nThreads, dfTime,
+               dfTime > 0 ? dfPoints / dfTime / 1e6 : 0.0);
+        if( iMode == 1 )
+        {
+            // The error threshold is only checked at the middle of each
+            // interpolated segment, so this is informative only.
+            printf(", max deviation from exact: %g pixel", dfMaxDiff);
+        }
+        printf("\n");
+
+        CPLFree(pasData);
+        CPLFree(pahThreads);
+    }
+
+    GDALClose(hSrcDS);
+    GDALClose(hDstDS);
+
+    CSLDestroy(argv);
+    GDALDestroyDriverManager();
+
+    return 0;
+}
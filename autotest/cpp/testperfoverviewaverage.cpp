@@ -0,0 +1,192 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance and consistency of the generic, SSE2 and AVX2
+ *           code paths of AVERAGE overview computation.
+ * Author:   Even Rouault, <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "gdal.h"
+
+static void Usage()
+{
+    printf("Usage: testperfoverviewaverage [-width val] [-height val] "
+           "[-loops val]\n");
+    exit(1);
+}
+
+/************************************************************************/
+/*                           ComputeOverview()                          */
+/************************************************************************/
+
+static void* ComputeOverview( GDALRasterBandH hSrcBand, int nLoops,
+                              double* pdfTime )
+{
+    const int nOvrXSize = (GDALGetRasterBandXSize(hSrcBand) + 1) / 2;
+    const int nOvrYSize = (GDALGetRasterBandYSize(hSrcBand) + 1) / 2;
+    const GDALDataType eDT = GDALGetRasterDataType(hSrcBand);
+    GDALDatasetH hOvrDS = GDALCreate(GDALGetDriverByName("MEM"), "",
+                                     nOvrXSize, nOvrYSize, 1, eDT, NULL);
+    GDALRasterBandH hOvrBand = GDALGetRasterBand(hOvrDS, 1);
+
+    const clock_t start = clock();
+    for( int i = 0; i < nLoops; i++ )
+    {
+        GDALRegenerateOverviews(hSrcBand, 1, &hOvrBand, "AVERAGE",
+                                NULL, NULL);
+    }
+    *pdfTime = (clock() - start) * 1.0 / CLOCKS_PER_SEC;
+
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDT);
+    void* pBuffer = CPLMalloc(
+        static_cast<size_t>(nOvrXSize) * nOvrYSize * nDTSize);
+    CPL_IGNORE_RET_VAL(GDALRasterIO(hOvrBand, GF_Read, 0, 0,
+                                    nOvrXSize, nOvrYSize,
+                                    pBuffer, nOvrXSize, nOvrYSize, eDT,
+                                    0, 0));
+    GDALClose(hOvrDS);
+    return pBuffer;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    int nXSize = 4096;
+    int nYSize = 4096;
+    int nLoops = 5;
+
+    argc = GDALGeneralCmdLineProcessor(argc, &argv, 0);
+    if( argc < 1 )
+        exit(-argc);
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "-width") && i + 1 < argc )
+            nXSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-height") && i + 1 < argc )
+            nYSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-loops") && i + 1 < argc )
+            nLoops = atoi(argv[++i]);
+        else
+            Usage();
+    }
+
+    GDALAllRegister();
+
+    const GDALDataType aeDT[] = { GDT_Byte, GDT_UInt16, GDT_Float32 };
+    const char* const apszModes[] = { "generic", "SSE2", "AVX2" };
+    int nRet = 0;
+
+    for( size_t iDT = 0; iDT < sizeof(aeDT) / sizeof(aeDT[0]); iDT++ )
+    {
+        const GDALDataType eDT = aeDT[iDT];
+        GDALDatasetH hSrcDS = GDALCreate(GDALGetDriverByName("MEM"), "",
+                                         nXSize, nYSize, 1, eDT, NULL);
+        GDALRasterBandH hSrcBand = GDALGetRasterBand(hSrcDS, 1);
+
+        // Pseudo-random content, with 1/16th of pixels at the nodata value.
+        GUInt32 nSeed = 1;
+        double* padfLine = static_cast<double*>(
+            CPLMalloc(nXSize * sizeof(double)));
+        for( int iY = 0; iY < nYSize; iY++ )
+        {
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                nSeed = nSeed * 1103515245U + 12345U;
+                const GUInt32 nVal = (nSeed >> 16) & 0x7FFF;
+                if( (nVal & 15) == 0 )
+                    padfLine[iX] = 0;
+                else if( eDT == GDT_Byte )
+                    padfLine[iX] = nVal & 0xFF;
+                else if( eDT == GDT_UInt16 )
+                    padfLine[iX] = nVal * 2;
+                else
+                    padfLine[iX] = (static_cast<int>(nVal) - 16384) * 0.123;
+            }
+            CPL_IGNORE_RET_VAL(GDALRasterIO(hSrcBand, GF_Write, 0, iY,
+                                            nXSize, 1, padfLine, nXSize, 1,
+                                            GDT_Float64, 0, 0));
+        }
+        CPLFree(padfLine);
+
+        for( int bNoData = FALSE; bNoData <= TRUE; bNoData++ )
+        {
+            if( bNoData )
+                GDALSetRasterNoDataValue(hSrcBand, 0);
+
+            void* pRef = NULL;
+            for( int iMode = 0; iMode < 3; iMode++ )
+            {
+                CPLSetConfigOption("GDAL_USE_SSE2",
+                                   iMode == 0 ? "NO" : NULL);
+                CPLSetConfigOption("GDAL_USE_AVX2",
+                                   iMode == 1 ? "NO" : NULL);
+                double dfTime = 0;
+                void* pRes = ComputeOverview(hSrcBand, nLoops, &dfTime);
+                printf("%s%s, %s: %.2f s\n",
+                       GDALGetDataTypeName(eDT),
+                       bNoData ? " with nodata" : "",
+                       apszModes[iMode], dfTime);
+                if( pRef == NULL )
+                {
+                    pRef = pRes;
+                }
+                else
+                {
+                    if( memcmp(pRef, pRes,
+                               static_cast<size_t>((nXSize + 1) / 2) *
+                               ((nYSize + 1) / 2) *
+                               GDALGetDataTypeSizeBytes(eDT)) != 0 )
+                    {
+                        printf("Results of %s and %s code paths differ!\n",
+                               apszModes[0], apszModes[iMode]);
+                        nRet = 1;
+                    }
+                    CPLFree(pRes);
+                }
+            }
+            CPLFree(pRef);
+        }
+        CPLSetConfigOption("GDAL_USE_SSE2", NULL);
+        CPLSetConfigOption("GDAL_USE_AVX2", NULL);
+
+        GDALClose(hSrcDS);
+    }
+
+    CSLDestroy(argv);
+    GDALDestroyDriverManager();
+
+    return nRet;
+}
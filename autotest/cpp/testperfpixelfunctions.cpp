@@ -0,0 +1,221 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance and consistency of the per-pixel and typed
+ *           whole-buffer code paths of the VRT built-in pixel functions.
+ * Author:   Even Rouault, <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "gdal.h"
+
+static void Usage()
+{
+    printf("Usage: testperfpixelfunctions [-width val] [-height val] "
+           "[-sources val] [-loops val]\n");
+    exit(1);
+}
+
+/************************************************************************/
+/*                            CreateSources()                           */
+/************************************************************************/
+
+static void CreateSources( GDALDataType eDT, int nXSize, int nYSize,
+                           int nSources )
+{
+    GUInt32 nSeed = 1;
+    double* padfLine = static_cast<double*>(
+        CPLMalloc(nXSize * sizeof(double)));
+    for( int iSrc = 0; iSrc < nSources; iSrc++ )
+    {
+        GDALDatasetH hDS = GDALCreate(GDALGetDriverByName("GTiff"),
+                        CPLSPrintf("/vsimem/testperfpixelfunctions_%d.tif",
+                                   iSrc),
+                        nXSize, nYSize, 1, eDT, NULL);
+        GDALRasterBandH hBand = GDALGetRasterBand(hDS, 1);
+        for( int iY = 0; iY < nYSize; iY++ )
+        {
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                nSeed = nSeed * 1103515245U + 12345U;
+                const GUInt32 nVal = (nSeed >> 16) & 0x7FFF;
+                if( eDT == GDT_Int16 )
+                    padfLine[iX] = static_cast<int>(nVal) - 16384;
+                else
+                    padfLine[iX] = (static_cast<int>(nVal) - 16384) * 0.123;
+            }
+            CPL_IGNORE_RET_VAL(GDALRasterIO(hBand, GF_Write, 0, iY,
+                                            nXSize, 1, padfLine, nXSize, 1,
+                                            GDT_Float64, 0, 0));
+        }
+        GDALClose(hDS);
+    }
+    CPLFree(padfLine);
+}
+
+/************************************************************************/
+/*                           EvalPixelFunction()                        */
+/************************************************************************/
+
+static void* EvalPixelFunction( const char* pszFunc, GDALDataType eSrcDT,
+                                int nXSize, int nYSize, int nSources,
+                                int nLoops, double* pdfTime )
+{
+    CPLString osXML;
+    osXML.Printf("<VRTDataset rasterXSize=\"%d\" rasterYSize=\"%d\">"
+                 "<VRTRasterBand dataType=\"Float32\" band=\"1\" "
+                 "subClass=\"VRTDerivedRasterBand\">"
+                 "<PixelFunctionType>%s</PixelFunctionType>"
+                 "<SourceTransferType>%s</SourceTransferType>",
+                 nXSize, nYSize, pszFunc, GDALGetDataTypeName(eSrcDT));
+    for( int iSrc = 0; iSrc < nSources; iSrc++ )
+    {
+        osXML += CPLSPrintf("<SimpleSource><SourceFilename>"
+                            "/vsimem/testperfpixelfunctions_%d.tif"
+                            "</SourceFilename>"
+                            "<SourceBand>1</SourceBand></SimpleSource>",
+                            iSrc);
+    }
+    osXML += "</VRTRasterBand></VRTDataset>";
+
+    GDALDatasetH hDS = GDALOpen(osXML, GA_ReadOnly);
+    GDALRasterBandH hBand = GDALGetRasterBand(hDS, 1);
+    float* pafBuffer = static_cast<float*>(
+        CPLMalloc(static_cast<size_t>(nXSize) * nYSize * sizeof(float)));
+
+    const clock_t start = clock();
+    for( int i = 0; i < nLoops; i++ )
+    {
+        CPL_IGNORE_RET_VAL(GDALRasterIO(hBand, GF_Read, 0, 0,
+                                        nXSize, nYSize,
+                                        pafBuffer, nXSize, nYSize,
+                                        GDT_Float32, 0, 0));
+    }
+    *pdfTime = (clock() - start) * 1.0 / CLOCKS_PER_SEC;
+
+    GDALClose(hDS);
+    return pafBuffer;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    int nXSize = 2048;
+    int nYSize = 2048;
+    int nSources = 3;
+    int nLoops = 5;
+
+    argc = GDALGeneralCmdLineProcessor(argc, &argv, 0);
+    if( argc < 1 )
+        exit(-argc);
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "-width") && i + 1 < argc )
+            nXSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-height") && i + 1 < argc )
+            nYSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-sources") && i + 1 < argc )
+            nSources = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-loops") && i + 1 < argc )
+            nLoops = atoi(argv[++i]);
+        else
+            Usage();
+    }
+    if( nSources < 2 )
+        Usage();
+
+    GDALAllRegister();
+
+    const GDALDataType aeDT[] = { GDT_Float32, GDT_Int16 };
+    const char* const apszFuncs[] = { "sum", "diff", "mul", "dB" };
+    const char* const apszModes[] = { "per-pixel", "vectorized" };
+    int nRet = 0;
+
+    for( size_t iDT = 0; iDT < sizeof(aeDT) / sizeof(aeDT[0]); iDT++ )
+    {
+        const GDALDataType eDT = aeDT[iDT];
+        CreateSources(eDT, nXSize, nYSize, nSources);
+
+        for( size_t iFunc = 0;
+             iFunc < sizeof(apszFuncs) / sizeof(apszFuncs[0]); iFunc++ )
+        {
+            const char* pszFunc = apszFuncs[iFunc];
+            // diff takes exactly 2 sources, dB exactly one.
+            const int nFuncSources = EQUAL(pszFunc, "diff") ? 2 :
+                                     EQUAL(pszFunc, "dB") ? 1 : nSources;
+
+            void* pRef = NULL;
+            for( int iMode = 0; iMode < 2; iMode++ )
+            {
+                CPLSetConfigOption("VRT_VECTORIZED_PIXEL_FUNCTIONS",
+                                   iMode == 0 ? "NO" : "YES");
+                double dfTime = 0;
+                void* pRes = EvalPixelFunction(pszFunc, eDT, nXSize, nYSize,
+                                               nFuncSources, nLoops, &dfTime);
+                printf("%s, %s (%d sources), %s: %.2f s\n",
+                       GDALGetDataTypeName(eDT), pszFunc, nFuncSources,
+                       apszModes[iMode], dfTime);
+                if( pRef == NULL )
+                {
+                    pRef = pRes;
+                }
+                else
+                {
+                    if( memcmp(pRef, pRes, static_cast<size_t>(nXSize) *
+                                           nYSize * sizeof(float)) != 0 )
+                    {
+                        printf("Results of %s and %s code paths differ!\n",
+                               apszModes[0], apszModes[iMode]);
+                        nRet = 1;
+                    }
+                    CPLFree(pRes);
+                }
+            }
+            CPLFree(pRef);
+        }
+        CPLSetConfigOption("VRT_VECTORIZED_PIXEL_FUNCTIONS", NULL);
+
+        for( int iSrc = 0; iSrc < nSources; iSrc++ )
+        {
+            VSIUnlink(CPLSPrintf("/vsimem/testperfpixelfunctions_%d.tif",
+                                 iSrc));
+        }
+    }
+
+    CSLDestroy(argv);
+    GDALDestroyDriverManager();
+
+    return nRet;
+}
@@ -0,0 +1,246 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of the average and mode resampling of the
+ *           warper, and check the mode result on a known pattern.
+ * Author:   Even Rouault, <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "gdal.h"
+#include "gdalwarper.h"
+
+static void Usage()
+{
+    printf("Usage: testperfwarpaverageormode [-width val] [-height val] "
+           "[-factor val]\n"
+           "                                  [-classes val] [-loops val]\n");
+    exit(1);
+}
+
+/************************************************************************/
+/*                              ClassValue()                            */
+/************************************************************************/
+
+static double ClassValue( GDALDataType eDT, int nClass )
+{
+    if( eDT == GDT_Float32 || eDT == GDT_Float64 )
+        return nClass * 0.25 + 0.125;
+    if( eDT == GDT_Int32 )
+        return nClass * 1000 - 100000;
+    return nClass;
+}
+
+/************************************************************************/
+/*                                Warp()                                */
+/************************************************************************/
+
+static double Warp( GDALDatasetH hSrcDS, GDALDatasetH hDstDS,
+                    GDALResampleAlg eResampleAlg, int nLoops )
+{
+    GDALWarpOptions* psWO = GDALCreateWarpOptions();
+    psWO->hSrcDS = hSrcDS;
+    psWO->hDstDS = hDstDS;
+    psWO->eResampleAlg = eResampleAlg;
+    psWO->nBandCount = 1;
+    psWO->panSrcBands = static_cast<int*>(CPLMalloc(sizeof(int)));
+    psWO->panSrcBands[0] = 1;
+    psWO->panDstBands = static_cast<int*>(CPLMalloc(sizeof(int)));
+    psWO->panDstBands[0] = 1;
+    int bHasNoData = FALSE;
+    const double dfNoData =
+        GDALGetRasterNoDataValue(GDALGetRasterBand(hSrcDS, 1), &bHasNoData);
+    if( bHasNoData )
+    {
+        psWO->padfSrcNoDataReal =
+            static_cast<double*>(CPLMalloc(sizeof(double)));
+        psWO->padfSrcNoDataReal[0] = dfNoData;
+        psWO->padfSrcNoDataImag =
+            static_cast<double*>(CPLMalloc(sizeof(double)));
+        psWO->padfSrcNoDataImag[0] = 0.0;
+    }
+    psWO->pTransformerArg =
+        GDALCreateGenImgProjTransformer2(hSrcDS, hDstDS, NULL);
+    if( psWO->pTransformerArg == NULL )
+        exit(1);
+    psWO->pfnTransformer = GDALGenImgProjTransform;
+
+    GDALWarpOperationH hOperation = GDALCreateWarpOperation(psWO);
+    const clock_t start = clock();
+    for( int i = 0; i < nLoops; i++ )
+    {
+        CPL_IGNORE_RET_VAL(GDALChunkAndWarpImage(
+            hOperation, 0, 0,
+            GDALGetRasterXSize(hDstDS), GDALGetRasterYSize(hDstDS)));
+    }
+    const double dfTime = (clock() - start) * 1.0 / CLOCKS_PER_SEC;
+    GDALDestroyWarpOperation(hOperation);
+
+    GDALDestroyGenImgProjTransformer(psWO->pTransformerArg);
+    GDALDestroyWarpOptions(psWO);
+    return dfTime;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    int nXSize = 2048;
+    int nYSize = 2048;
+    int nFactor = 16;
+    int nClasses = 64;
+    int nLoops = 3;
+
+    argc = GDALGeneralCmdLineProcessor(argc, &argv, 0);
+    if( argc < 1 )
+        exit(-argc);
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "-width") && i + 1 < argc )
+            nXSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-height") && i + 1 < argc )
+            nYSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-factor") && i + 1 < argc )
+            nFactor = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-classes") && i + 1 < argc )
+            nClasses = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-loops") && i + 1 < argc )
+            nLoops = atoi(argv[++i]);
+        else
+            Usage();
+    }
+    if( nFactor <= 0 || nXSize < nFactor || nYSize < nFactor ||
+        nClasses < 2 || nClasses > 255 || nLoops <= 0 )
+        Usage();
+
+    GDALAllRegister();
+
+    const int nDstXSize = nXSize / nFactor;
+    const int nDstYSize = nYSize / nFactor;
+    const GDALDataType aeDT[] = { GDT_Byte, GDT_UInt16, GDT_Int32,
+                                  GDT_Float32, GDT_Float64 };
+    const GDALResampleAlg aeAlg[] = { GRA_NearestNeighbour, GRA_Average,
+                                      GRA_Mode };
+    const char* const apszAlgs[] = { "near", "average", "mode" };
+    GDALDriverH hMemDriver = GDALGetDriverByName("MEM");
+    int nRet = 0;
+
+    for( size_t iDT = 0; iDT < sizeof(aeDT) / sizeof(aeDT[0]); iDT++ )
+    {
+        const GDALDataType eDT = aeDT[iDT];
+        GDALDatasetH hSrcDS = GDALCreate(hMemDriver, "", nXSize, nYSize, 1,
+                                         eDT, NULL);
+        GDALRasterBandH hSrcBand = GDALGetRasterBand(hSrcDS, 1);
+        double adfSrcGT[6] = { 0.0, 1.0, 0.0, static_cast<double>(nYSize),
+                               0.0, -1.0 };
+        GDALSetGeoTransform(hSrcDS, adfSrcGT);
+
+        // Each nFactor x nFactor block has a dominant class, 3 pixels out of
+        // 4, the others being random classes, so that the mode of a
+        // destination pixel is known. Class 0 is the nodata value.
+        GUInt32 nSeed = 1;
+        double* padfLine = static_cast<double*>(
+            CPLMalloc(nXSize * sizeof(double)));
+        for( int iY = 0; iY < nYSize; iY++ )
+        {
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                const int nBlock = (iY / nFactor) * nDstXSize + iX / nFactor;
+                int nClass = 1 + nBlock % (nClasses - 1);
+                nSeed = nSeed * 1103515245U + 12345U;
+                const GUInt32 nVal = (nSeed >> 16) & 0x7FFF;
+                if( (nVal & 3) == 0 )
+                    nClass = (nVal >> 2) % nClasses;
+                padfLine[iX] = ClassValue(eDT, nClass);
+            }
+            CPL_IGNORE_RET_VAL(GDALRasterIO(hSrcBand, GF_Write, 0, iY,
+                                            nXSize, 1, padfLine, nXSize, 1,
+                                            GDT_Float64, 0, 0));
+        }
+        CPLFree(padfLine);
+
+        GDALDatasetH hDstDS = GDALCreate(hMemDriver, "",
+                                         nDstXSize, nDstYSize, 1, eDT, NULL);
+        double adfDstGT[6] = { 0.0, static_cast<double>(nFactor), 0.0,
+                               static_cast<double>(nYSize),
+                               0.0, -static_cast<double>(nFactor) };
+        GDALSetGeoTransform(hDstDS, adfDstGT);
+
+        for( int bNoData = FALSE; bNoData <= TRUE; bNoData++ )
+        {
+            if( bNoData )
+                GDALSetRasterNoDataValue(hSrcBand, ClassValue(eDT, 0));
+
+            for( size_t iAlg = 0; iAlg < sizeof(aeAlg) / sizeof(aeAlg[0]);
+                 iAlg++ )
+            {
+                const double dfTime =
+                    Warp(hSrcDS, hDstDS, aeAlg[iAlg], nLoops);
+                printf("%s%s, %s: %.2f s\n",
+                       GDALGetDataTypeName(eDT),
+                       bNoData ? " with nodata" : "",
+                       apszAlgs[iAlg], dfTime);
+                if( aeAlg[iAlg] != GRA_Mode )
+                    continue;
+
+                double* padfDst = static_cast<double*>(
+                    CPLMalloc(sizeof(double) * nDstXSize * nDstYSize));
+                CPL_IGNORE_RET_VAL(GDALRasterIO(
+                    GDALGetRasterBand(hDstDS, 1), GF_Read, 0, 0,
+                    nDstXSize, nDstYSize, padfDst, nDstXSize, nDstYSize,
+                    GDT_Float64, 0, 0));
+                for( int i = 0; i < nDstXSize * nDstYSize; i++ )
+                {
+                    const double dfExpected =
+                        ClassValue(eDT, 1 + i % (nClasses - 1));
+                    if( padfDst[i] != dfExpected )
+                    {
+                        printf("Mode of pixel %d is %g, expected %g\n",
+                               i, padfDst[i], dfExpected);
+                        nRet = 1;
+                        break;
+                    }
+                }
+                CPLFree(padfDst);
+            }
+        }
+
+        GDALClose(hDstDS);
+        GDALClose(hSrcDS);
+    }
+
+    CSLDestroy(argv);
+    GDALDestroyDriverManager();
+
+    return nRet;
+}
@@ -0,0 +1,246 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  GDAL Core
+ * Purpose:  Test performance of the convolution based resampling methods
+ *           of the warper, and check that the SSE2 and AVX2 code paths
+ *           give the same results.
+ * Author:   Even Rouault, <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cpl_conv.h"
+#include "cpl_string.h"
+#include "gdal.h"
+#include "gdalwarper.h"
+
+static void Usage()
+{
+    printf("Usage: testperfwarpresampling [-width val] [-height val] "
+           "[-bands val] [-loops val]\n");
+    exit(1);
+}
+
+/************************************************************************/
+/*                                Warp()                                */
+/************************************************************************/
+
+static double Warp( GDALDatasetH hSrcDS, GDALDatasetH hDstDS,
+                    GDALResampleAlg eResampleAlg, int nLoops )
+{
+    const int nBands = GDALGetRasterCount(hSrcDS);
+    GDALWarpOptions* psWO = GDALCreateWarpOptions();
+    psWO->hSrcDS = hSrcDS;
+    psWO->hDstDS = hDstDS;
+    psWO->eResampleAlg = eResampleAlg;
+    psWO->nBandCount = nBands;
+    psWO->panSrcBands = static_cast<int*>(CPLMalloc(nBands * sizeof(int)));
+    psWO->panDstBands = static_cast<int*>(CPLMalloc(nBands * sizeof(int)));
+    for( int i = 0; i < nBands; i++ )
+    {
+        psWO->panSrcBands[i] = i + 1;
+        psWO->panDstBands[i] = i + 1;
+    }
+    psWO->pTransformerArg =
+        GDALCreateGenImgProjTransformer2(hSrcDS, hDstDS, NULL);
+    if( psWO->pTransformerArg == NULL )
+        exit(1);
+    psWO->pfnTransformer = GDALGenImgProjTransform;
+
+    GDALWarpOperationH hOperation = GDALCreateWarpOperation(psWO);
+    const clock_t start = clock();
+    for( int i = 0; i < nLoops; i++ )
+    {
+        CPL_IGNORE_RET_VAL(GDALChunkAndWarpImage(
+            hOperation, 0, 0,
+            GDALGetRasterXSize(hDstDS), GDALGetRasterYSize(hDstDS)));
+    }
+    const double dfTime = (clock() - start) * 1.0 / CLOCKS_PER_SEC;
+    GDALDestroyWarpOperation(hOperation);
+
+    GDALDestroyGenImgProjTransformer(psWO->pTransformerArg);
+    GDALDestroyWarpOptions(psWO);
+    return dfTime;
+}
+
+/************************************************************************/
+/*                             ReadDataset()                            */
+/************************************************************************/
+
+static double* ReadDataset( GDALDatasetH hDS )
+{
+    const int nXSize = GDALGetRasterXSize(hDS);
+    const int nYSize = GDALGetRasterYSize(hDS);
+    const int nBands = GDALGetRasterCount(hDS);
+    double* padfData = static_cast<double*>(
+        CPLMalloc(sizeof(double) * nXSize * nYSize * nBands));
+    CPL_IGNORE_RET_VAL(GDALDatasetRasterIO(hDS, GF_Read, 0, 0,
+                                           nXSize, nYSize, padfData,
+                                           nXSize, nYSize, GDT_Float64,
+                                           nBands, NULL, 0, 0, 0));
+    return padfData;
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main(int argc, char* argv[])
+{
+    int nXSize = 2048;
+    int nYSize = 2048;
+    int nBands = 3;
+    int nLoops = 1;
+
+    argc = GDALGeneralCmdLineProcessor(argc, &argv, 0);
+    if( argc < 1 )
+        exit(-argc);
+
+    for( int i = 1; i < argc; i++ )
+    {
+        if( EQUAL(argv[i], "-width") && i + 1 < argc )
+            nXSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-height") && i + 1 < argc )
+            nYSize = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-bands") && i + 1 < argc )
+            nBands = atoi(argv[++i]);
+        else if( EQUAL(argv[i], "-loops") && i + 1 < argc )
+            nLoops = atoi(argv[++i]);
+        else
+            Usage();
+    }
+    if( nXSize < 16 || nYSize < 16 || nBands <= 0 || nLoops <= 0 )
+        Usage();
+
+    GDALAllRegister();
+
+    const GDALDataType aeDT[] = { GDT_Byte, GDT_UInt16, GDT_Float32 };
+    const GDALResampleAlg aeAlg[] = { GRA_Cubic, GRA_CubicSpline,
+                                      GRA_Lanczos };
+    const char* const apszAlgs[] = { "cubic", "cubicspline", "lanczos" };
+    // Destination pixel size, in source pixels, and sub-pixel shift of the
+    // destination grid.
+    const double adfFactor[] = { 2.0, 1.3, 1.0 };
+    const double adfShift[] = { 0.0, 0.0, 0.3 };
+    GDALDriverH hMemDriver = GDALGetDriverByName("MEM");
+    int nRet = 0;
+
+    for( size_t iDT = 0; iDT < sizeof(aeDT) / sizeof(aeDT[0]); iDT++ )
+    {
+        const GDALDataType eDT = aeDT[iDT];
+        GDALDatasetH hSrcDS = GDALCreate(hMemDriver, "", nXSize, nYSize,
+                                         nBands, eDT, NULL);
+        double adfSrcGT[6] = { 0.0, 1.0, 0.0, static_cast<double>(nYSize),
+                               0.0, -1.0 };
+        GDALSetGeoTransform(hSrcDS, adfSrcGT);
+
+        // Smooth gradients plus some noise.
+        const double dfMax = (eDT == GDT_Byte) ? 255.0 : 65535.0;
+        GUInt32 nSeed = 1;
+        double* padfLine = static_cast<double*>(
+            CPLMalloc(nXSize * sizeof(double)));
+        for( int iBand = 1; iBand <= nBands; iBand++ )
+        {
+            GDALRasterBandH hSrcBand = GDALGetRasterBand(hSrcDS, iBand);
+            for( int iY = 0; iY < nYSize; iY++ )
+            {
+                for( int iX = 0; iX < nXSize; iX++ )
+                {
+                    nSeed = nSeed * 1103515245U + 12345U;
+                    const double dfNoise = ((nSeed >> 16) & 0xFF) / 255.0;
+                    padfLine[iX] = dfMax * (0.4 * (iX + iBand * iY) /
+                                            (nXSize + nBands * nYSize) +
+                                            0.3 * ((iX / 8 + iY / 8) % 2) +
+                                            0.3 * dfNoise);
+                    if( eDT != GDT_Float32 )
+                        padfLine[iX] = static_cast<int>(padfLine[iX]);
+                }
+                CPL_IGNORE_RET_VAL(GDALRasterIO(hSrcBand, GF_Write, 0, iY,
+                                                nXSize, 1, padfLine,
+                                                nXSize, 1,
+                                                GDT_Float64, 0, 0));
+            }
+        }
+        CPLFree(padfLine);
+
+        for( size_t iFactor = 0;
+             iFactor < sizeof(adfFactor) / sizeof(adfFactor[0]); iFactor++ )
+        {
+            const double dfFactor = adfFactor[iFactor];
+            const double dfShift = adfShift[iFactor];
+            const int nDstXSize =
+                static_cast<int>((nXSize - 2 * dfShift) / dfFactor);
+            const int nDstYSize =
+                static_cast<int>((nYSize - 2 * dfShift) / dfFactor);
+            GDALDatasetH hDstDS = GDALCreate(hMemDriver, "",
+                                             nDstXSize, nDstYSize, nBands,
+                                             eDT, NULL);
+            double adfDstGT[6] = { dfShift, dfFactor, 0.0,
+                                   nYSize - dfShift, 0.0, -dfFactor };
+            GDALSetGeoTransform(hDstDS, adfDstGT);
+
+            for( size_t iAlg = 0; iAlg < sizeof(aeAlg) / sizeof(aeAlg[0]);
+                 iAlg++ )
+            {
+                CPLSetConfigOption("GDAL_USE_AVX2", "NO");
+                const double dfTimeNoAVX2 =
+                    Warp(hSrcDS, hDstDS, aeAlg[iAlg], nLoops);
+                double* padfRef = ReadDataset(hDstDS);
+
+                CPLSetConfigOption("GDAL_USE_AVX2", NULL);
+                const double dfTime =
+                    Warp(hSrcDS, hDstDS, aeAlg[iAlg], nLoops);
+                double* padfRes = ReadDataset(hDstDS);
+
+                printf("%s, %s, factor %.1f%s: %.2f s (GDAL_USE_AVX2=NO: "
+                       "%.2f s)\n",
+                       GDALGetDataTypeName(eDT), apszAlgs[iAlg], dfFactor,
+                       dfShift != 0.0 ? " shifted" : "",
+                       dfTime, dfTimeNoAVX2);
+
+                if( memcmp(padfRef, padfRes, sizeof(double) * nDstXSize *
+                           nDstYSize * nBands) != 0 )
+                {
+                    printf("Results differ with and without AVX2\n");
+                    nRet = 1;
+                }
+                CPLFree(padfRef);
+                CPLFree(padfRes);
+            }
+
+            GDALClose(hDstDS);
+        }
+
+        GDALClose(hSrcDS);
+    }
+
+    CSLDestroy(argv);
+    GDALDestroyDriverManager();
+
+    return nRet;
+}
@@ -743,6 +743,74 @@ def stats_uint16():
 
     return 'success'
 
+###############################################################################
+# Test that computing statistics, min/max and histogram with GDAL_NUM_THREADS
+# gives the same results as single-threaded computation
+
+def stats_multithreaded():
+
+    for (dt, nodata, scale, options) in [
+            (gdal.GDT_Byte, None, '-100 1000', ''), (gdal.GDT_Byte, 0, '-100 1000', ''),
+            (gdal.GDT_Byte, None, '-100 100', '-co PIXELTYPE=SIGNEDBYTE'),
+            (gdal.GDT_UInt16, None, '-100 1000', ''),
+            (gdal.GDT_Int16, 0, '-100 1000', ''),
+            (gdal.GDT_Int32, None, '-2000000000 2000000000', ''),
+            (gdal.GDT_Int32, 0, '-100 1000', ''),
+            (gdal.GDT_UInt32, None, '0 4000000000', ''),
+            (gdal.GDT_CInt16, None, '-30000 30000', ''),
+            (gdal.GDT_CInt32, None, '-2000000000 2000000000', ''),
+            (gdal.GDT_Float32, None, '-100 1000', ''), (gdal.GDT_Float32, 0, '-100 1000', ''),
+            (gdal.GDT_Float64, None, '-100 1000', '') ]:
+
+        ds = gdal.Translate('/vsimem/stats_multithreaded.tif',
+                            '../gdrivers/data/small_world.tif',
+                            options = '-b 1 -ot %s -scale 0 255 %s '
+                                      '-co TILED=YES -co BLOCKXSIZE=32 '
+                                      '-co BLOCKYSIZE=32 %s' %
+                                      (gdal.GetDataTypeName(dt), scale, options))
+        if nodata is not None:
+            ds.GetRasterBand(1).SetNoDataValue(nodata)
+        ds = None
+
+        res = []
+        for num_threads in [ None, '2', '3', '4' ]:
+            gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+            ds = gdal.Open('/vsimem/stats_multithreaded.tif')
+            band = ds.GetRasterBand(1)
+            stats = band.ComputeStatistics(0)
+            approx_stats = band.ComputeStatistics(1)
+            minmax = band.ComputeRasterMinMax(0)
+            hist = band.GetHistogram(-100.5, 1000.5, 1101, 0, 0)
+            ds = None
+            gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+            res.append([stats, approx_stats, minmax, hist])
+
+        gdal.GetDriverByName('GTiff').Delete('/vsimem/stats_multithreaded.tif')
+
+        is_float = dt in (gdal.GDT_Float32, gdal.GDT_Float64)
+        for k in range(1, len(res)):
+            # Integer types are processed with integral intermediate
+            # results, so threads must not change the statistics at all.
+            if not is_float and (res[0][0] != res[k][0] or res[0][1] != res[k][1]):
+                gdaltest.post_reason('did not get exactly the same stats')
+                print(gdal.GetDataTypeName(dt), nodata)
+                print(res[0][0:2], res[k][0:2])
+                return 'fail'
+            for i in range(2):
+                for j in range(4):
+                    if abs(res[0][i][j] - res[k][i][j]) > 1e-10 * abs(res[0][i][j]):
+                        gdaltest.post_reason('did not get expected stats')
+                        print(gdal.GetDataTypeName(dt), nodata)
+                        print(res)
+                        return 'fail'
+            if res[0][2] != res[k][2] or res[0][3] != res[k][3]:
+                gdaltest.post_reason('did not get expected min/max or histogram')
+                print(gdal.GetDataTypeName(dt), nodata)
+                print(res[0][2], res[k][2])
+                return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Run tests
 
@@ -768,7 +836,8 @@ gdaltest_list = [
     stats_flt_min,
     stats_dbl_min,
     stats_byte_partial_tiles,
-    stats_uint16
+    stats_uint16,
+    stats_multithreaded
     ]
 
 if __name__ == '__main__':
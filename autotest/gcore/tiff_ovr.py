@@ -2146,6 +2146,45 @@ def tiff_ovr_53():
 
     return 'success'
 
+###############################################################################
+# Test that multi-threaded overview computation (GDAL_NUM_THREADS) gives the
+# same result as the single-threaded one
+
+def tiff_ovr_54():
+
+    src_ds = gdal.Translate('', 'data/rgbsmall.tif', format = 'MEM',
+                            width = 1000, height = 1000)
+
+    # Single band and multi band (compressed pixel-interleaved) code paths,
+    # with several overview levels to test the cascading path as well
+    for options in [ [], ['COMPRESS=DEFLATE'] ]:
+        for resampling in [ 'NEAR', 'AVERAGE', 'GAUSS', 'MODE', 'CUBIC' ]:
+
+            cs_ref = None
+            for num_threads in [ None, '4' ]:
+                gdal.GetDriverByName('GTiff').CreateCopy(
+                    '/vsimem/tiff_ovr_54.tif', src_ds, options = options)
+                ds = gdal.Open('/vsimem/tiff_ovr_54.tif', gdal.GA_Update)
+                gdal.SetConfigOption('GDAL_NUM_THREADS', num_threads)
+                ret = ds.BuildOverviews(resampling, [2, 4, 8])
+                gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+                if ret != 0:
+                    gdaltest.post_reason('fail')
+                    return 'fail'
+                cs = [ ds.GetRasterBand(i+1).GetOverview(j).Checksum()
+                       for i in range(3) for j in range(3) ]
+                ds = None
+                gdal.GetDriverByName('GTiff').Delete('/vsimem/tiff_ovr_54.tif')
+
+                if cs_ref is None:
+                    cs_ref = cs
+                elif cs != cs_ref:
+                    gdaltest.post_reason('fail')
+                    print(options, resampling, cs, cs_ref)
+                    return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Cleanup
 
@@ -2263,7 +2302,8 @@ gdaltest_list.append(tiff_ovr_restore_endianness)
 
 gdaltest_list += [ tiff_ovr_51,
                    tiff_ovr_52,
-                   tiff_ovr_53 ]
+                   tiff_ovr_53,
+                   tiff_ovr_54 ]
 
 if __name__ == '__main__':
 
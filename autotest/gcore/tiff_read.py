@@ -2722,6 +2722,45 @@ def tiff_read_one_band_from_two_bands():
 
     return 'success'
 
+###############################################################################
+# Test multi-threaded decoding
+
+def tiff_read_multi_threaded():
+
+    src_ds = gdal.Open('data/stefan_full_rgba.tif')
+    for options in [ ['TILED=YES', 'BLOCKXSIZE=16', 'BLOCKYSIZE=16', 'COMPRESS=DEFLATE'],
+                     ['TILED=YES', 'BLOCKXSIZE=16', 'BLOCKYSIZE=16', 'COMPRESS=LZW', 'PREDICTOR=2', 'INTERLEAVE=BAND'],
+                     ['BLOCKYSIZE=7', 'COMPRESS=PACKBITS', 'SPARSE_OK=YES'] ]:
+        gdal.GetDriverByName('GTiff').CreateCopy('/vsimem/tiff_read_multi_threaded.tif', src_ds, options = options)
+
+        ds = gdal.Open('/vsimem/tiff_read_multi_threaded.tif')
+        expected_data = ds.ReadRaster()
+        expected_data_band = ds.GetRasterBand(3).ReadRaster(3,5,100,50)
+        ds = None
+
+        ds = gdal.OpenEx('/vsimem/tiff_read_multi_threaded.tif', open_options = ['NUM_THREADS=4'])
+        data_band = ds.GetRasterBand(3).ReadRaster(3,5,100,50)
+        data = ds.ReadRaster()
+        ds = None
+        if data != expected_data or data_band != expected_data_band:
+            gdaltest.post_reason('fail')
+            print(options)
+            return 'fail'
+
+        gdal.SetConfigOption('GDAL_NUM_THREADS', 'ALL_CPUS')
+        ds = gdal.Open('/vsimem/tiff_read_multi_threaded.tif')
+        gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+        data = ds.ReadRaster()
+        ds = None
+        if data != expected_data:
+            gdaltest.post_reason('fail')
+            print(options)
+            return 'fail'
+
+    gdal.Unlink('/vsimem/tiff_read_multi_threaded.tif')
+
+    return 'success'
+
 ###############################################################################
 
 for item in init_list:
@@ -2807,6 +2846,7 @@ gdaltest_list.append( (tiff_read_gcp_internal_and_auxxml) )
 gdaltest_list.append( (tiff_read_aux) )
 
 gdaltest_list.append( (tiff_read_one_band_from_two_bands) )
+gdaltest_list.append( (tiff_read_multi_threaded) )
 
 #gdaltest_list = [ tiff_read_aux ]
 
@@ -7266,6 +7266,53 @@ def tiff_write_158():
 
     return 'success'
 
+###############################################################################
+# Test reading ahead the source in a background thread in CreateCopy()
+# (NUM_THREADS option of GDALDatasetCopyWholeRaster())
+
+def tiff_write_159():
+
+    src_ds = gdal.Translate('', 'data/byte.tif',
+                            options = '-of MEM -outsize 1000 1000 -b 1 -b 1 -b 1 -r bilinear')
+    expected_cs = [ src_ds.GetRasterBand(i+1).Checksum() for i in range(3) ]
+
+    for options in [ [],
+                     ['COMPRESS=DEFLATE'],
+                     ['COMPRESS=DEFLATE', 'INTERLEAVE=BAND'],
+                     ['TILED=YES', 'BLOCKXSIZE=64', 'BLOCKYSIZE=32'] ]:
+        for num_threads in [ '2', 'ALL_CPUS' ]:
+            ds = gdaltest.tiff_drv.CreateCopy('/vsimem/tiff_write_159.tif', src_ds,
+                    options = options + [ 'NUM_THREADS=' + num_threads ])
+            ds = None
+            ds = gdal.Open('/vsimem/tiff_write_159.tif')
+            got_cs = [ ds.GetRasterBand(i+1).Checksum() for i in range(3) ]
+            ds = None
+            if got_cs != expected_cs:
+                gdaltest.post_reason('failure')
+                print(options, num_threads)
+                print(got_cs)
+                print(expected_cs)
+                return 'fail'
+
+    # Small swaths to have many of them in flight
+    gdal.SetConfigOption('GDAL_SWATH_SIZE', '1000000')
+    gdal.SetConfigOption('GDAL_NUM_THREADS', '4')
+    ds = gdal.Translate('/vsimem/tiff_write_159.tif', src_ds,
+                        options = '-co INTERLEAVE=BAND')
+    gdal.SetConfigOption('GDAL_SWATH_SIZE', None)
+    gdal.SetConfigOption('GDAL_NUM_THREADS', None)
+    got_cs = [ ds.GetRasterBand(i+1).Checksum() for i in range(3) ]
+    ds = None
+    if got_cs != expected_cs:
+        gdaltest.post_reason('failure')
+        print(got_cs)
+        print(expected_cs)
+        return 'fail'
+
+    gdaltest.tiff_drv.Delete('/vsimem/tiff_write_159.tif')
+
+    return 'success'
+
 ###############################################################################
 # Ask to run again tests with GDAL_API_PROXY=YES
 
@@ -7454,6 +7501,7 @@ gdaltest_list = [
     tiff_write_156,
     tiff_write_157,
     tiff_write_158,
+    tiff_write_159,
     #tiff_write_api_proxy,
     tiff_write_cleanup ]
 
@@ -1191,6 +1191,204 @@ def vrt_read_26():
     return 'success'
 
 
+###############################################################################
+# Test reading a VRT with many sources (spatial index over the sources)
+
+def vrt_read_27():
+
+    import struct
+
+    src_ds = gdal.Open('data/byte.tif')
+    src_data = src_ds.GetRasterBand(1).ReadRaster()
+    src_ds = None
+
+    vrt_xml = '<VRTDataset rasterXSize="400" rasterYSize="400">\n'
+    vrt_xml += '  <VRTRasterBand dataType="Byte" band="1">\n'
+    for j in range(20):
+        for i in range(20):
+            vrt_xml += """    <SimpleSource>
+      <SourceFilename relativeToVRT="0">data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="%d" yOff="%d" xSize="20" ySize="20" />
+    </SimpleSource>\n""" % (i * 20, j * 20)
+    # Sources coming later must still be painted over earlier ones
+    vrt_xml += """    <ComplexSource>
+      <SourceFilename relativeToVRT="0">data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <ScaleOffset>255</ScaleOffset>
+      <ScaleRatio>0</ScaleRatio>
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="60" yOff="80" xSize="20" ySize="20" />
+    </ComplexSource>\n"""
+    vrt_xml += '  </VRTRasterBand>\n</VRTDataset>'
+    ds = gdal.Open(vrt_xml)
+    band = ds.GetRasterBand(1)
+
+    if band.ReadRaster(140, 220, 20, 20) != src_data:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    if band.ReadRaster(60, 80, 20, 20) != struct.pack('B', 255) * 400:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    # Window straddling 4 sources
+    data = band.ReadRaster(30, 10, 20, 20)
+    if data[0:10] != src_data[10*20+10:10*20+20] or \
+       data[10:20] != src_data[10*20:10*20+10]:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    if band.Checksum() != 27448:
+        gdaltest.post_reason('fail')
+        print(band.Checksum())
+        return 'fail'
+
+    # Sources added or modified after a first read must be taken into account
+    band.SetMetadataItem('source_401', """<ComplexSource>
+      <SourceFilename relativeToVRT="0">data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <ScaleOffset>9</ScaleOffset>
+      <ScaleRatio>0</ScaleRatio>
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="380" yOff="380" xSize="20" ySize="20" />
+    </ComplexSource>""", 'new_vrt_sources')
+    band.SetMetadataItem('source_400', """<ComplexSource>
+      <SourceFilename relativeToVRT="0">data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <ScaleOffset>7</ScaleOffset>
+      <ScaleRatio>0</ScaleRatio>
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="0" yOff="0" xSize="20" ySize="20" />
+    </ComplexSource>""", 'vrt_sources')
+    if band.ReadRaster(0, 0, 20, 20) != struct.pack('B', 7) * 400:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if band.ReadRaster(60, 80, 20, 20) != src_data:
+        gdaltest.post_reason('fail')
+        return 'fail'
+    if band.ReadRaster(380, 380, 20, 20) != struct.pack('B', 9) * 400:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
+
+###############################################################################
+# Test reading sources with several threads (VRT_NUM_THREADS)
+
+def vrt_read_28_error_handler(err_type, err_no, err_msg):
+    gdaltest.vrt_read_28_msgs.append((err_type, err_msg))
+
+def vrt_read_28_read(vrt_xml, num_threads):
+
+    gdaltest.vrt_read_28_msgs = []
+    gdal.SetConfigOption('VRT_NUM_THREADS', num_threads)
+    gdal.SetConfigOption('CPL_DEBUG', 'ON')
+    gdal.PushErrorHandler(vrt_read_28_error_handler)
+    ds = gdal.Open(vrt_xml)
+    ret = [ ds.GetRasterBand(1).ReadRaster(),
+            ds.GetRasterBand(1).ReadRaster(0, 0, 200, 200, 77, 77),
+            ds.GetRasterBand(1).ReadRaster(15, 25, 100, 50),
+            ds.ReadRaster() ]
+    ds = None
+    gdal.PopErrorHandler()
+    gdal.SetConfigOption('CPL_DEBUG', None)
+    gdal.SetConfigOption('VRT_NUM_THREADS', None)
+    return ret
+
+def vrt_read_28():
+
+    # Sources are only read concurrently if they come from different datasets
+    src_ds = gdal.Open('data/byte.tif')
+    for k in range(4):
+        gdal.GetDriverByName('GTiff').CreateCopy('/vsimem/vrt_read_28_%d.tif' % k, src_ds)
+    src_ds = None
+
+    # Disjoint destination windows on even rows, overlapping ones on odd rows
+    vrt_xml = '<VRTDataset rasterXSize="200" rasterYSize="200">\n'
+    vrt_xml += '  <VRTRasterBand dataType="Byte" band="1">\n'
+    for j in range(10):
+        if (j % 2) == 0:
+            dst_size = 20
+        else:
+            dst_size = 30
+        for i in range(10):
+            vrt_xml += """    <ComplexSource>
+      <SourceFilename relativeToVRT="0">/vsimem/vrt_read_28_%d.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <ScaleOffset>%d</ScaleOffset>
+      <ScaleRatio>1</ScaleRatio>
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="%d" yOff="%d" xSize="%d" ySize="%d" />
+    </ComplexSource>\n""" % ((i + j) % 4, (i + j) % 7, i * 20, j * 20, dst_size, dst_size)
+    vrt_xml += '  </VRTRasterBand>\n</VRTDataset>'
+
+    ref_data = vrt_read_28_read(vrt_xml, '1')
+    if len([msg for (err_type, msg) in gdaltest.vrt_read_28_msgs if msg.find('VRT: Reading') == 0]) != 0:
+        gdaltest.post_reason('fail')
+        print(gdaltest.vrt_read_28_msgs)
+        return 'fail'
+
+    data = vrt_read_28_read(vrt_xml, '4')
+    for k in range(4):
+        gdal.Unlink('/vsimem/vrt_read_28_%d.tif' % k)
+
+    for i in range(len(ref_data)):
+        if data[i] is None or data[i] != ref_data[i]:
+            gdaltest.post_reason('fail')
+            print(i)
+            return 'fail'
+
+    # Check that the sources of the whole raster have been read in parallel
+    found = False
+    for (err_type, msg) in gdaltest.vrt_read_28_msgs:
+        if msg.find('VRT: Reading 100 sources in ') == 0:
+            nbatches = int(msg[len('VRT: Reading 100 sources in '):].split(' ')[0])
+            if nbatches >= 100:
+                gdaltest.post_reason('fail')
+                print(msg)
+                return 'fail'
+            found = True
+    if not found:
+        gdaltest.post_reason('fail')
+        print(gdaltest.vrt_read_28_msgs)
+        return 'fail'
+
+    # Errors of the worker threads must reach the error handler of the caller
+    vrt_xml = '<VRTDataset rasterXSize="40" rasterYSize="20">\n'
+    vrt_xml += '  <VRTRasterBand dataType="Byte" band="1">\n'
+    for (i, filename) in enumerate(['data/byte.tif', '/vsimem/vrt_read_28_non_existing.tif']):
+        vrt_xml += """    <SimpleSource>
+      <SourceFilename relativeToVRT="0">%s</SourceFilename>
+      <SourceBand>1</SourceBand>
+      <SourceProperties RasterXSize="20" RasterYSize="20" DataType="Byte" BlockXSize="20" BlockYSize="20" />
+      <SrcRect xOff="0" yOff="0" xSize="20" ySize="20" />
+      <DstRect xOff="%d" yOff="0" xSize="20" ySize="20" />
+    </SimpleSource>\n""" % (filename, i * 20)
+    vrt_xml += '  </VRTRasterBand>\n</VRTDataset>'
+
+    gdaltest.vrt_read_28_msgs = []
+    gdal.SetConfigOption('VRT_NUM_THREADS', '2')
+    gdal.SetConfigOption('CPL_DEBUG', 'ON')
+    gdal.PushErrorHandler(vrt_read_28_error_handler)
+    ds = gdal.Open(vrt_xml)
+    ds.GetRasterBand(1).ReadRaster()
+    ds = None
+    gdal.PopErrorHandler()
+    gdal.SetConfigOption('CPL_DEBUG', None)
+    gdal.SetConfigOption('VRT_NUM_THREADS', None)
+
+    if len([msg for (err_type, msg) in gdaltest.vrt_read_28_msgs if msg.find('VRT: Reading 2 sources in 1 batches') == 0]) != 1 or \
+       len([msg for (err_type, msg) in gdaltest.vrt_read_28_msgs if err_type == gdal.CE_Failure]) == 0:
+        gdaltest.post_reason('fail')
+        print(gdaltest.vrt_read_28_msgs)
+        return 'fail'
+
+    return 'success'
+
+
 for item in init_list:
     ut = gdaltest.GDALTest( 'VRT', item[0], item[1], item[2] )
     if ut is None:
@@ -1224,6 +1422,8 @@ gdaltest_list.append( vrt_read_23 )
 gdaltest_list.append( vrt_read_24 )
 gdaltest_list.append( vrt_read_25 )
 gdaltest_list.append( vrt_read_26 )
+gdaltest_list.append( vrt_read_27 )
+gdaltest_list.append( vrt_read_28 )
 
 if __name__ == '__main__':
 
@@ -29,6 +29,7 @@
 ###############################################################################
 
 import sys
+import struct
 from osgeo import gdal
 from osgeo import ogr
 from sys import version_info
@@ -345,6 +346,305 @@ def vsicurl_test_redirect():
 
     return 'success'
 
+###############################################################################
+# Read the first 100 bytes of /test_persistent_cache/test.bin in a new
+# process, so that the in-memory cache of /vsicurl/ is empty.
+
+def vsicurl_read_persistent_cache_in_subprocess(cache_dir):
+
+    python_exe = sys.executable
+    if sys.platform == 'win32':
+        python_exe = python_exe.replace('\\', '/')
+
+    ret = gdaltest.runexternal(python_exe + ' vsicurl.py read_persistent_cache %d %s' % (gdaltest.webserver_port, cache_dir))
+    return ret.strip()
+
+###############################################################################
+# Test the persistent cache (CPL_VSIL_CURL_PERSISTENT_CACHE_DIR)
+
+def vsicurl_test_persistent_cache():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    cache_dir = 'tmp/vsicurl_persistent_cache'
+    gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_DIR', cache_dir)
+
+    f = gdal.VSIFOpenL('/vsicurl/http://localhost:%d/test_persistent_cache/test.bin' % gdaltest.webserver_port, 'rb')
+    if f is None:
+        gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_DIR', None)
+        gdaltest.post_reason('fail')
+        return 'fail'
+    content = gdal.VSIFReadL(1, 100, f).decode('ascii')
+    if content != ''.join(['x' for i in range(100)]):
+        gdaltest.post_reason('fail')
+        print(content)
+        gdal.VSIFCloseL(f)
+        gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_DIR', None)
+        return 'fail'
+
+    cached_files = [x for x in gdal.ReadDirRecursive(cache_dir) if not x.endswith('/')]
+    if len(cached_files) != 1:
+        gdaltest.post_reason('fail')
+        print(cached_files)
+        gdal.VSIFCloseL(f)
+        gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_DIR', None)
+        return 'fail'
+
+    # The server now returns other data, but with the same ETag: a new
+    # process must be served the cached data.
+    gdaltest.gdalurlopen('http://localhost:%d/test_persistent_cache/set_state?char=y' % gdaltest.webserver_port)
+    content = vsicurl_read_persistent_cache_in_subprocess(cache_dir)
+    if content != ''.join(['x' for i in range(100)]):
+        gdaltest.post_reason('fail')
+        print(content)
+        gdal.VSIFCloseL(f)
+        gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_DIR', None)
+        return 'fail'
+
+    # With a new ETag, the cached chunk must no longer be used
+    gdaltest.gdalurlopen('http://localhost:%d/test_persistent_cache/set_state?etag=persistent_cache_etag2' % gdaltest.webserver_port)
+    content = vsicurl_read_persistent_cache_in_subprocess(cache_dir)
+    gdaltest.gdalurlopen('http://localhost:%d/test_persistent_cache/set_state?char=x&etag=persistent_cache_etag' % gdaltest.webserver_port)
+    if content != ''.join(['y' for i in range(100)]):
+        gdaltest.post_reason('fail')
+        print(content)
+        gdal.VSIFCloseL(f)
+        gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_DIR', None)
+        return 'fail'
+
+    cached_files = [x for x in gdal.ReadDirRecursive(cache_dir) if not x.endswith('/')]
+    if len(cached_files) != 2:
+        gdaltest.post_reason('fail')
+        print(cached_files)
+        gdal.VSIFCloseL(f)
+        gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_DIR', None)
+        return 'fail'
+
+    # Writing a new chunk should evict the least recently used ones
+    gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_MAX_SIZE', '1')
+    gdal.VSIFSeekL(f, 500000, 0)
+    content = gdal.VSIFReadL(1, 100, f).decode('ascii')
+    gdal.VSIFCloseL(f)
+    gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_MAX_SIZE', None)
+    gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_DIR', None)
+    if content != ''.join(['x' for i in range(100)]):
+        gdaltest.post_reason('fail')
+        print(content)
+        return 'fail'
+
+    cached_files = [x for x in gdal.ReadDirRecursive(cache_dir) if not x.endswith('/')]
+    if len(cached_files) != 0:
+        gdaltest.post_reason('fail')
+        print(cached_files)
+        return 'fail'
+
+    for subdir in gdal.ReadDir(cache_dir):
+        if subdir not in ['.', '..']:
+            gdal.Rmdir(cache_dir + '/' + subdir)
+    gdal.Rmdir(cache_dir)
+
+    return 'success'
+
+###############################################################################
+# Return, and reset on the server side, the Range headers received by the
+# webserver on /test_multirange/test.tif
+
+def vsicurl_get_multirange_requests():
+
+    f = gdaltest.gdalurlopen('http://localhost:%d/test_multirange/requests' % gdaltest.webserver_port)
+    if f is None:
+        return None
+    content = f.read().decode('ascii')
+    f.close()
+    if content == '':
+        return []
+    return content.split('\n')
+
+###############################################################################
+# Return the merged byte ranges of a window of /test_multirange/test.tif, as
+# computed from the strip offsets of a local copy of the file.
+
+def vsicurl_get_multirange_expected_ranges(xoff, yoff, xsize, ysize):
+
+    gdal.FileFromMemBuffer('/vsimem/vsicurl_multirange.tif',
+                           webserver.get_multirange_tif_content())
+    ds = gdal.Open('/vsimem/vsicurl_multirange.tif')
+    band = ds.GetRasterBand(1)
+    width = webserver.MULTIRANGE_TIF_SIZE
+    blockysize = webserver.MULTIRANGE_TIF_BLOCKYSIZE
+    ranges = []
+    for y in range(yoff, yoff + ysize):
+        strip_offset = int(band.GetMetadataItem('BLOCK_OFFSET_0_%d' % (y // blockysize), 'TIFF'))
+        start = strip_offset + (y % blockysize) * width + xoff
+        if len(ranges) > 0 and ranges[-1][1] + 1 == start:
+            ranges[-1] = (ranges[-1][0], start + xsize - 1)
+        else:
+            ranges.append((start, start + xsize - 1))
+    ds = None
+    gdal.Unlink('/vsimem/vsicurl_multirange.tif')
+
+    return [ '%d-%d' % (start, end) for (start, end) in ranges ]
+
+###############################################################################
+# Read a window of /test_multirange/test.tif with GTIFF_DIRECT_IO, which uses
+# VSIFReadMultiRangeL(), and check both the pixel values and the requests
+# received by the server.
+
+def vsicurl_check_multirange_read(xoff, yoff, xsize, ysize, strategy,
+                                  max_parallel_requests = None):
+
+    gdal.SetConfigOption('GDAL_DISABLE_READDIR_ON_OPEN', 'EMPTY_DIR')
+    gdal.SetConfigOption('GTIFF_DIRECT_IO', 'YES')
+    ds = gdal.Open('/vsicurl/http://localhost:%d/test_multirange/test.tif' % gdaltest.webserver_port)
+    gdal.SetConfigOption('GTIFF_DIRECT_IO', None)
+    gdal.SetConfigOption('GDAL_DISABLE_READDIR_ON_OPEN', None)
+    if ds is None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    # A first read makes sure that the TIFF directory has been fetched, so
+    # that the second one only requests pixel data.
+    ds.GetRasterBand(1).ReadRaster(xoff, yoff, xsize, ysize)
+    vsicurl_get_multirange_requests()
+
+    gdal.SetConfigOption('GDAL_HTTP_MULTIRANGE', strategy)
+    gdal.SetConfigOption('CPL_VSIL_CURL_MAX_PARALLEL_REQUESTS', max_parallel_requests)
+    data = ds.GetRasterBand(1).ReadRaster(xoff, yoff, xsize, ysize)
+    gdal.SetConfigOption('GDAL_HTTP_MULTIRANGE', None)
+    gdal.SetConfigOption('CPL_VSIL_CURL_MAX_PARALLEL_REQUESTS', None)
+    ds = None
+
+    requests = vsicurl_get_multirange_requests()
+
+    expected_data = struct.pack('B' * (xsize * ysize),
+                                *[(x + 7 * y) % 256 for y in range(yoff, yoff + ysize)
+                                                    for x in range(xoff, xoff + xsize)])
+    if data != expected_data:
+        gdaltest.post_reason('fail')
+        print(strategy)
+        return 'fail'
+
+    expected_ranges = vsicurl_get_multirange_expected_ranges(xoff, yoff, xsize, ysize)
+    if strategy == 'SINGLE_GET':
+        expected_requests = [ 'bytes=' + ','.join(expected_ranges) ]
+    else:
+        expected_requests = [ 'bytes=' + rng for rng in expected_ranges ]
+    if strategy == 'PARALLEL':
+        # Parallel requests may reach the server in any order
+        requests = sorted(requests)
+        expected_requests = sorted(expected_requests)
+    if requests != expected_requests:
+        gdaltest.post_reason('fail')
+        print(strategy)
+        print(requests)
+        print(expected_requests)
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test multi-range reads with parallel range requests (the default)
+
+def vsicurl_test_multirange_parallel():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    # Non contiguous ranges over two strips
+    if vsicurl_check_multirange_read(10, 6, 5, 4, 'PARALLEL') != 'success':
+        return 'fail'
+
+    # Whole lines: contiguous ranges are merged in a single request
+    if vsicurl_check_multirange_read(0, 6, 1000, 4, 'PARALLEL') != 'success':
+        return 'fail'
+
+    # More ranges than allowed parallel requests
+    if vsicurl_check_multirange_read(10, 2, 5, 20, 'PARALLEL', '2') != 'success':
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test multi-range reads with GDAL_HTTP_MULTIRANGE=SERIAL
+
+def vsicurl_test_multirange_serial():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    if vsicurl_check_multirange_read(10, 6, 5, 4, 'SERIAL') != 'success':
+        return 'fail'
+
+    if vsicurl_check_multirange_read(0, 6, 1000, 4, 'SERIAL') != 'success':
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test multi-range reads with GDAL_HTTP_MULTIRANGE=SINGLE_GET, that is to say
+# a single multipart/byteranges request
+
+def vsicurl_test_multirange_single_get():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    if vsicurl_check_multirange_read(10, 6, 5, 4, 'SINGLE_GET') != 'success':
+        return 'fail'
+
+    if vsicurl_check_multirange_read(0, 6, 1000, 4, 'SINGLE_GET') != 'success':
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test CPL_VSIL_CURL_CHUNK_SIZE. The value is read once per process, hence
+# the use of an external gdalinfo.
+
+def vsicurl_test_chunk_size():
+
+    if gdaltest.webserver_port == 0:
+        return 'skip'
+
+    import test_cli_utilities
+    if test_cli_utilities.get_gdalinfo_path() is None:
+        return 'skip'
+
+    gdal.FileFromMemBuffer('/vsimem/vsicurl_multirange.tif',
+                           webserver.get_multirange_tif_content())
+    ds = gdal.Open('/vsimem/vsicurl_multirange.tif')
+    expected_cs = ds.GetRasterBand(1).Checksum()
+    ds = None
+    gdal.Unlink('/vsimem/vsicurl_multirange.tif')
+
+    vsicurl_get_multirange_requests()
+    ret = gdaltest.runexternal(test_cli_utilities.get_gdalinfo_path() +
+        ' -checksum --config CPL_VSIL_CURL_CHUNK_SIZE 4096' +
+        ' --config GDAL_DISABLE_READDIR_ON_OPEN EMPTY_DIR' +
+        ' /vsicurl/http://localhost:%d/test_multirange/test.tif' % gdaltest.webserver_port)
+    requests = vsicurl_get_multirange_requests()
+
+    if ret.find('Checksum=%d' % expected_cs) < 0:
+        gdaltest.post_reason('fail')
+        print(ret)
+        return 'fail'
+
+    # All downloads must start on a 4096 byte boundary, and the first one
+    # must be a single chunk.
+    if len(requests) == 0 or requests[0] != 'bytes=0-4095':
+        gdaltest.post_reason('fail')
+        print(requests)
+        return 'fail'
+    for rng in requests:
+        start = int(rng[len('bytes='):].split('-')[0])
+        if (start % 4096) != 0:
+            gdaltest.post_reason('fail')
+            print(requests)
+            return 'fail'
+
+    return 'success'
+
 ###############################################################################
 def vsicurl_stop_webserver():
 
@@ -368,10 +668,25 @@ gdaltest_list = [ vsicurl_1,
                   vsicurl_11,
                   vsicurl_start_webserver,
                   vsicurl_test_redirect,
+                  vsicurl_test_persistent_cache,
+                  vsicurl_test_multirange_parallel,
+                  vsicurl_test_multirange_serial,
+                  vsicurl_test_multirange_single_get,
+                  vsicurl_test_chunk_size,
                   vsicurl_stop_webserver ]
 
 if __name__ == '__main__':
 
+    if len(sys.argv) == 4 and sys.argv[1] == 'read_persistent_cache':
+        gdal.SetConfigOption('CPL_VSIL_CURL_PERSISTENT_CACHE_DIR', sys.argv[3])
+        f = gdal.VSIFOpenL('/vsicurl/http://localhost:%s/test_persistent_cache/test.bin' % sys.argv[2], 'rb')
+        if f is None:
+            print('cannot open file')
+            sys.exit(1)
+        print(gdal.VSIFReadL(1, 100, f).decode('ascii'))
+        gdal.VSIFCloseL(f)
+        sys.exit(0)
+
     if gdal.GetConfigOption('GDAL_RUN_SLOW_TESTS') is None:
         print('Enabling slow tests as GDAL_RUN_SLOW_TESTS is not defined')
         gdal.SetConfigOption('GDAL_RUN_SLOW_TESTS', 'YES')
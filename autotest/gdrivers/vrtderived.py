@@ -945,6 +945,161 @@ def vrtderived_15():
     return ret
 
 
+###############################################################################
+# Test PixelFunctionLanguage=Expression
+
+def vrtderived_16():
+
+    ds = gdal.Open("""<VRTDataset rasterXSize="20" rasterYSize="20">
+  <VRTRasterBand dataType="Float32" band="1" subClass="VRTDerivedRasterBand">
+    <PixelFunctionLanguage>Expression</PixelFunctionLanguage>
+    <PixelFunctionCode><![CDATA[B1 > 120 ? (B1 - B2) * 2 + min(B1, 200) : max(B2 / 2, 10)]]></PixelFunctionCode>
+    <SimpleSource>
+      <SourceFilename>data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+    </SimpleSource>
+    <SimpleSource>
+      <SourceFilename>data/int16.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+    </SimpleSource>
+  </VRTRasterBand>
+</VRTDataset>""")
+    cs = ds.GetRasterBand(1).Checksum()
+    if cs != 4336:
+        gdaltest.post_reason( 'invalid checksum' )
+        print(cs)
+        return 'fail'
+
+    # Check serialization
+    out_ds = gdal.GetDriverByName('VRT').CreateCopy('/vsimem/vrtderived_16.vrt', ds)
+    out_ds = None
+    ds = None
+    ds = gdal.Open('/vsimem/vrtderived_16.vrt')
+    cs = ds.GetRasterBand(1).Checksum()
+    ds = None
+    gdal.Unlink('/vsimem/vrtderived_16.vrt')
+    if cs != 4336:
+        gdaltest.post_reason( 'invalid checksum' )
+        print(cs)
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test nodata handling of PixelFunctionLanguage=Expression
+
+def vrtderived_17():
+
+    template = """<VRTDataset rasterXSize="20" rasterYSize="20">
+  <VRTRasterBand dataType="Float32" band="1" subClass="VRTDerivedRasterBand">
+    <NoDataValue>107</NoDataValue>
+    <PixelFunctionLanguage>Expression</PixelFunctionLanguage>
+    <PixelFunctionCode>B1 + 1</PixelFunctionCode>
+    %s
+    <SimpleSource>
+      <SourceFilename>data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+    </SimpleSource>
+  </VRTRasterBand>
+</VRTDataset>"""
+
+    # Pixels at nodata in the sources are nodata in the output
+    ds = gdal.Open(template % '')
+    cs = ds.GetRasterBand(1).Checksum()
+    if cs != 4398:
+        gdaltest.post_reason( 'invalid checksum' )
+        print(cs)
+        return 'fail'
+
+    ds = gdal.Open(template % '<PixelFunctionArguments propagate_nodata="NO"/>')
+    cs = ds.GetRasterBand(1).Checksum()
+    if cs != 4455:
+        gdaltest.post_reason( 'invalid checksum' )
+        print(cs)
+        return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test errors with PixelFunctionLanguage=Expression
+
+def vrtderived_18():
+
+    template = """<VRTDataset rasterXSize="20" rasterYSize="20">
+  <VRTRasterBand dataType="Float32" band="1" subClass="VRTDerivedRasterBand">
+    <PixelFunctionLanguage>Expression</PixelFunctionLanguage>
+    %s
+    <SimpleSource>
+      <SourceFilename>data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+    </SimpleSource>
+  </VRTRasterBand>
+</VRTDataset>"""
+
+    for code in [ '',
+                  '<PixelFunctionCode>B1 +</PixelFunctionCode>',
+                  '<PixelFunctionCode>(B1</PixelFunctionCode>',
+                  '<PixelFunctionCode>B1 ? 1</PixelFunctionCode>',
+                  '<PixelFunctionCode>B0</PixelFunctionCode>',
+                  '<PixelFunctionCode>B2</PixelFunctionCode>',
+                  '<PixelFunctionCode>foo(B1)</PixelFunctionCode>',
+                  '<PixelFunctionCode>min(B1)</PixelFunctionCode>',
+                  '<PixelFunctionCode>unknown</PixelFunctionCode>' ]:
+        gdal.PushErrorHandler('CPLQuietErrorHandler')
+        ds = gdal.Open(template % code)
+        gdal.PopErrorHandler()
+        if ds is not None:
+            gdaltest.post_reason( 'expected error' )
+            print(code)
+            return 'fail'
+
+    return 'success'
+
+###############################################################################
+# Test that deeply nested expressions are rejected rather than overflowing
+# the stack of the parser.
+
+def vrtderived_19():
+
+    template = """<VRTDataset rasterXSize="20" rasterYSize="20">
+  <VRTRasterBand dataType="Float32" band="1" subClass="VRTDerivedRasterBand">
+    <PixelFunctionLanguage>Expression</PixelFunctionLanguage>
+    <PixelFunctionCode>%s</PixelFunctionCode>
+    <SimpleSource>
+      <SourceFilename>data/byte.tif</SourceFilename>
+      <SourceBand>1</SourceBand>
+    </SimpleSource>
+  </VRTRasterBand>
+</VRTDataset>"""
+
+    # Reasonable nesting is still accepted.
+    ds = gdal.Open(template % ('(' * 32 + 'B1' + ')' * 32))
+    if ds is None or ds.GetRasterBand(1).Checksum() != 4672:
+        gdaltest.post_reason( 'fail' )
+        return 'fail'
+    ds = None
+
+    for code in [ '(' * 10000 + 'B1' + ')' * 10000,
+                  '-' * 10000 + 'B1',
+                  '!' * 10000 + 'B1',
+                  'abs(' * 10000 + 'B1' + ')' * 10000,
+                  'B1^' * 10000 + 'B1',
+                  'B1?' * 10000 + 'B1' + ':B1' * 10000 ]:
+        gdal.ErrorReset()
+        gdal.PushErrorHandler('CPLQuietErrorHandler')
+        ds = gdal.Open(template % code)
+        gdal.PopErrorHandler()
+        if ds is not None:
+            gdaltest.post_reason( 'expected error' )
+            print(code[0:10])
+            return 'fail'
+        if gdal.GetLastErrorMsg().find('nested') < 0:
+            gdaltest.post_reason( 'fail' )
+            print(gdal.GetLastErrorMsg()[-100:])
+            return 'fail'
+
+    return 'success'
+
 ###############################################################################
 # Cleanup.
 
@@ -971,6 +1126,10 @@ gdaltest_list = [
     vrtderived_13,
     vrtderived_14,
     vrtderived_15,
+    vrtderived_16,
+    vrtderived_17,
+    vrtderived_18,
+    vrtderived_19,
     vrtderived_cleanup,
 ]
 
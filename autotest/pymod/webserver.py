@@ -44,11 +44,98 @@ do_log = False
 
 TIME_SKEW = 30 * 60
 
+###############################################################################
+# Content of /test_multirange/test.tif: an uncompressed striped GeoTIFF, so
+# that GTIFF_DIRECT_IO reads of a sub-window go through multi-range reads.
+# The value of pixel (x, y) is (x + 7 * y) % 256.
+
+MULTIRANGE_TIF_SIZE = 1000
+MULTIRANGE_TIF_BLOCKYSIZE = 8
+
+def get_multirange_tif_content():
+    from osgeo import gdal
+    import struct
+
+    filename = '/vsimem/webserver_multirange_test.tif'
+    ds = gdal.GetDriverByName('GTiff').Create(filename,
+                        MULTIRANGE_TIF_SIZE, MULTIRANGE_TIF_SIZE, 1,
+                        options = ['BLOCKYSIZE=%d' % MULTIRANGE_TIF_BLOCKYSIZE])
+    for y in range(MULTIRANGE_TIF_SIZE):
+        line = struct.pack('B' * MULTIRANGE_TIF_SIZE,
+                           *[(x + 7 * y) % 256 for x in range(MULTIRANGE_TIF_SIZE)])
+        ds.GetRasterBand(1).WriteRaster(0, y, MULTIRANGE_TIF_SIZE, 1, line)
+    ds = None
+
+    f = gdal.VSIFOpenL(filename, 'rb')
+    gdal.VSIFSeekL(f, 0, 2)
+    size = gdal.VSIFTellL(f)
+    gdal.VSIFSeekL(f, 0, 0)
+    content = gdal.VSIFReadL(1, size, f)
+    gdal.VSIFCloseL(f)
+    gdal.Unlink(filename)
+    return content
+
 class GDAL_Handler(BaseHTTPRequestHandler):
 
     def log_request(self, code='-', size='-'):
         return
 
+    # Serve a (possibly multi-)range request on content, and record the
+    # Range header so that tests can check the request pattern.
+    def send_multirange_response(self, content):
+        # Close the connection after each response, so that parallel
+        # requests on several connections do not block this single
+        # threaded server.
+        self.protocol_version = 'HTTP/1.0'
+        if 'Range' not in self.headers:
+            self.send_response(200)
+            self.send_header('Content-type', 'application/octet-stream')
+            self.send_header('Content-Length', len(content))
+            self.end_headers()
+            self.wfile.write(content)
+            return
+
+        rng_header = self.headers['Range']
+        self.server.multirange_requests.append(rng_header)
+
+        ranges = []
+        for rng in rng_header[len('bytes='):].split(','):
+            (start, end) = rng.split('-')
+            ranges.append((int(start), min(int(end), len(content) - 1)))
+
+        if len(ranges) == 1:
+            (start, end) = ranges[0]
+            self.send_response(206)
+            self.send_header('Content-type', 'application/octet-stream')
+            self.send_header('Content-Range', 'bytes %d-%d/%d' % (start, end, len(content)))
+            self.send_header('Content-Length', end - start + 1)
+            self.end_headers()
+            self.wfile.write(content[start:end+1])
+            return
+
+        boundary = 'gdal_multirange_boundary'
+        body = ''.encode('ascii')
+        for (start, end) in ranges:
+            part_header = '--%s\r\n' % boundary
+            part_header += 'Content-Type: application/octet-stream\r\n'
+            part_header += 'Content-Range: bytes %d-%d/%d\r\n' % (start, end, len(content))
+            part_header += '\r\n'
+            body += part_header.encode('ascii')
+            body += content[start:end+1]
+            body += '\r\n'.encode('ascii')
+        body += ('--%s--\r\n' % boundary).encode('ascii')
+
+        self.send_response(206)
+        self.send_header('Content-Type', 'multipart/byteranges; boundary=%s' % boundary)
+        self.send_header('Content-Length', len(body))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def get_multirange_tif(self):
+        if self.server.multirange_tif_content is None:
+            self.server.multirange_tif_content = get_multirange_tif_content()
+        return self.server.multirange_tif_content
+
     def do_HEAD(self):
         if do_log:
             f = open('/tmp/log.txt', 'a')
@@ -75,6 +162,23 @@ class GDAL_Handler(BaseHTTPRequestHandler):
             self.wfile.write(response.encode('ascii'))
             return
 
+        if self.path == '/test_persistent_cache/test.bin':
+            self.send_response(200)
+            self.send_header('Content-type', 'application/octet-stream')
+            self.send_header('Content-Length', 1000000)
+            self.send_header('ETag', self.server.persistent_cache_etag)
+            self.end_headers()
+            return
+
+        if self.path == '/test_multirange/test.tif':
+            content = self.get_multirange_tif()
+            self.protocol_version = 'HTTP/1.0'
+            self.send_response(200)
+            self.send_header('Content-type', 'application/octet-stream')
+            self.send_header('Content-Length', len(content))
+            self.end_headers()
+            return
+
         # Simulate that we don't accept HEAD on signed URLs. The client should retry with a GET
         if self.path.startswith('/foo.s3.amazonaws.com/test_redirected/test.bin?Signature=foo&Expires='):
             import time
@@ -395,6 +499,50 @@ class GDAL_Handler(BaseHTTPRequestHandler):
                 self.wfile.write(''.join(['x' for i in range(16384)]).encode('ascii'))
                 return
 
+            if self.path == '/test_persistent_cache/test.bin' and 'Range' in self.headers:
+                rng = self.headers['Range'][len('bytes='):].split('-')
+                start = int(rng[0])
+                end = min(int(rng[1]), 1000000 - 1)
+                self.protocol_version = 'HTTP/1.1'
+                self.send_response(206)
+                self.send_header('Content-type', 'application/octet-stream')
+                self.send_header('Content-Range', 'bytes %d-%d/1000000' % (start, end))
+                self.send_header('Content-Length', end - start + 1)
+                self.send_header('ETag', self.server.persistent_cache_etag)
+                self.end_headers()
+                self.wfile.write(''.join([self.server.persistent_cache_char for i in range(end - start + 1)]).encode('ascii'))
+                return
+
+            # Change the content and/or the ETag of /test_persistent_cache/test.bin
+            if self.path.startswith('/test_persistent_cache/set_state?'):
+                for param in self.path[self.path.find('?')+1:].split('&'):
+                    (key, value) = param.split('=')
+                    if key == 'char':
+                        self.server.persistent_cache_char = value
+                    elif key == 'etag':
+                        self.server.persistent_cache_etag = '"%s"' % value
+                self.send_response(200)
+                self.send_header('Content-Length', 0)
+                self.end_headers()
+                return
+
+            if self.path == '/test_multirange/test.tif':
+                self.send_multirange_response(self.get_multirange_tif())
+                return
+
+            # Return, and forget, the Range headers received so far on
+            # /test_multirange/test.tif
+            if self.path == '/test_multirange/requests':
+                content = '\n'.join(self.server.multirange_requests).encode('ascii')
+                self.server.multirange_requests = []
+                self.protocol_version = 'HTTP/1.0'
+                self.send_response(200)
+                self.send_header('Content-type', 'text/plain')
+                self.send_header('Content-Length', len(content))
+                self.end_headers()
+                self.wfile.write(content)
+                return
+
             if self.path == '/s3_delete_bucket/delete_file' and getattr(self.server, 'has_requested_s3_delete_bucket_delete_file', None) is None:
                 self.server.has_requested_s3_delete_bucket_delete_file = True
                 self.protocol_version = 'HTTP/1.1'
@@ -967,6 +1115,10 @@ class GDAL_HttpServer(HTTPServer):
         HTTPServer.__init__(self, server_address, handlerClass)
         self.running = False
         self.stop_requested = False
+        self.persistent_cache_etag = '"persistent_cache_etag"'
+        self.persistent_cache_char = 'x'
+        self.multirange_tif_content = None
+        self.multirange_requests = []
 
     def is_running(self):
         return self.running
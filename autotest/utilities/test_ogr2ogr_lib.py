@@ -33,7 +33,7 @@ import sys
 
 sys.path.append( '../pymod' )
 
-from osgeo import gdal, ogr
+from osgeo import gdal, ogr, osr
 import gdaltest
 import ogrtest
 
@@ -389,6 +389,155 @@ def test_ogr2ogr_lib_17():
 
     return 'success'
 
+###############################################################################
+# Test -threads
+
+def test_ogr2ogr_lib_18_create_source():
+
+    ll_srs = osr.SpatialReference()
+    ll_srs.SetWellKnownGeogCS('WGS84')
+
+    src_ds = gdal.GetDriverByName('Memory').Create('', 0, 0, 0)
+    src_lyr = src_ds.CreateLayer('test', srs = ll_srs, geom_type = ogr.wkbUnknown)
+    src_lyr.CreateField(ogr.FieldDefn('id', ogr.OFTInteger))
+    src_lyr.CreateField(ogr.FieldDefn('name', ogr.OFTString))
+    for i in range(3000):
+        f = ogr.Feature(src_lyr.GetLayerDefn())
+        f.SetFID(10 + 3 * i)
+        f.SetField('id', i)
+        f.SetField('name', 'feature %d' % i)
+        x = 1 + (i % 60) * 0.05
+        y = 40 + (i // 60) * 0.05
+        if i % 3 == 0:
+            wkt = 'MULTIPOLYGON (((%f %f,%f %f,%f %f,%f %f)),((%f %f,%f %f,%f %f,%f %f)))' % \
+                (x, y, x, y + 0.02, x + 0.02, y, x, y,
+                 x + 0.03, y, x + 0.03, y + 0.02, x + 0.05, y, x + 0.03, y)
+        elif i % 3 == 1:
+            wkt = 'POLYGON ((%f %f,%f %f,%f %f,%f %f))' % \
+                (x, y, x, y + 0.04, x + 0.04, y, x, y)
+        else:
+            wkt = 'POINT (%f %f)' % (x, y)
+        f.SetGeometry(ogr.CreateGeometryFromWkt(wkt))
+        src_lyr.CreateFeature(f)
+
+    return src_ds
+
+def test_ogr2ogr_lib_18_translate(dst, src_ds, options):
+
+    errors = []
+    def error_handler(err_type, err_no, err_msg):
+        errors.append((err_type, err_no, err_msg))
+
+    gdal.PushErrorHandler(error_handler)
+    ds = gdal.VectorTranslate(dst, src_ds, options = options)
+    gdal.PopErrorHandler()
+
+    return (ds, errors)
+
+# Check that -threads gives the same features, with the same FIDs and in
+# the same order, and the same errors in the same order, as a sequential
+# translation
+def test_ogr2ogr_lib_18_compare(src_ds, options, ref_dst = '', dst = ''):
+
+    (ref_ds, ref_errors) = test_ogr2ogr_lib_18_translate(ref_dst, src_ds, options)
+    (ds, errors) = test_ogr2ogr_lib_18_translate(dst, src_ds, options + ' -threads 4')
+    if ref_ds is None or ds is None:
+        gdaltest.post_reason('fail')
+        print(options)
+        return False
+    if errors != ref_errors:
+        gdaltest.post_reason('fail')
+        print(options)
+        print(ref_errors[0:10])
+        print(errors[0:10])
+        return False
+
+    ref_lyr = ref_ds.GetLayer(0)
+    lyr = ds.GetLayer(0)
+    if lyr.GetFeatureCount() != ref_lyr.GetFeatureCount():
+        gdaltest.post_reason('fail')
+        print(options)
+        print(ref_lyr.GetFeatureCount())
+        print(lyr.GetFeatureCount())
+        return False
+    for i in range(ref_lyr.GetFeatureCount()):
+        ref_f = ref_lyr.GetNextFeature()
+        f = lyr.GetNextFeature()
+        # Not OGRFeature::Equal(), that requires the same feature definition
+        same = (f.GetFID() == ref_f.GetFID())
+        for j in range(ref_f.GetFieldCount()):
+            if f.GetField(j) != ref_f.GetField(j):
+                same = False
+        ref_geom = ref_f.GetGeometryRef()
+        geom = f.GetGeometryRef()
+        if (ref_geom is None) != (geom is None) or \
+           (ref_geom is not None and geom.ExportToWkt() != ref_geom.ExportToWkt()):
+            same = False
+        if not same:
+            gdaltest.post_reason('fail')
+            print(options)
+            f.DumpReadable()
+            ref_f.DumpReadable()
+            return False
+
+    return True
+
+def test_ogr2ogr_lib_18():
+
+    src_ds = test_ogr2ogr_lib_18_create_source()
+
+    for options in [ '-segmentize 0.01 -gt 3',
+                     '-preserve_fid -where "id % 7 <> 0"',
+                     '-explodecollections',
+                     # Errors emitted by the workers (no GEOS, or GEOS
+                     # errors) must be reported by the calling thread
+                     '-clipsrc 1.5 40.5 2.5 41.5 -explodecollections' ]:
+        if not test_ogr2ogr_lib_18_compare(src_ds, '-f Memory ' + options):
+            return 'fail'
+        # -where is left on the source layer
+        src_ds.GetLayer(0).SetAttributeFilter(None)
+
+    if not ogrtest.have_geos():
+        (ds, errors) = test_ogr2ogr_lib_18_translate('', src_ds,
+                                '-f Memory -clipsrc 1.5 40.5 2.5 41.5 -threads 4')
+        if len(errors) != 3000:
+            gdaltest.post_reason('fail')
+            print(len(errors))
+            return 'fail'
+
+    # Failures to write features skipped with -skipfailures
+    ret = test_ogr2ogr_lib_18_compare(src_ds,
+                            '-f "ESRI Shapefile" -skipfailures -nlt POINT',
+                            '/vsimem/test_ogr2ogr_lib_18_ref.shp',
+                            '/vsimem/test_ogr2ogr_lib_18.shp')
+    gdal.GetDriverByName('ESRI Shapefile').Delete('/vsimem/test_ogr2ogr_lib_18_ref.shp')
+    gdal.GetDriverByName('ESRI Shapefile').Delete('/vsimem/test_ogr2ogr_lib_18.shp')
+    if not ret:
+        return 'fail'
+
+    # Reprojection
+    utm_proj4 = '+proj=utm +zone=31 +datum=WGS84 +units=m +no_defs'
+    utm_srs = osr.SpatialReference()
+    utm_srs.ImportFromProj4(utm_proj4)
+    try:
+        with gdaltest.error_handler():
+            ct = osr.CoordinateTransformation(src_ds.GetLayer(0).GetSpatialRef(), utm_srs)
+    except ValueError:
+        ct = None
+    if ct is not None and ct.this is not None:
+        if not test_ogr2ogr_lib_18_compare(src_ds,
+                    '-f Memory -t_srs "%s"' % utm_proj4):
+            return 'fail'
+
+    # Interruption from the callback
+    with gdaltest.error_handler():
+        ds = gdal.VectorTranslate('', src_ds, options = '-f Memory -threads 4', callback = mycallback_with_failure)
+    if ds is not None:
+        gdaltest.post_reason('fail')
+        return 'fail'
+
+    return 'success'
+
 gdaltest_list = [
     test_ogr2ogr_lib_1,
     test_ogr2ogr_lib_2,
@@ -406,7 +555,8 @@ gdaltest_list = [
     test_ogr2ogr_lib_14,
     test_ogr2ogr_lib_15,
     test_ogr2ogr_lib_16,
-    test_ogr2ogr_lib_17
+    test_ogr2ogr_lib_17,
+    test_ogr2ogr_lib_18
     ]
 
 if __name__ == '__main__':
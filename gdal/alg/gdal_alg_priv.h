@@ -151,6 +151,27 @@ void* GDALCreateTPSTransformerInt( int nGCPCount, const GDAL_GCP *pasGCPList,
 
 void CPL_DLL * GDALCloneTransformer( void *pTransformerArg );
 
+/************************************************************************/
+/*      Warp source coordinate grids (SRC_COORD_CACHE warp option)      */
+/************************************************************************/
+
+/* Source pixel/line coordinates of the centers of the pixels of a */
+/* destination window, as computed by the warp kernel. While pabyRowDone */
+/* is not NULL, the grid is being filled by the kernel that has it. */
+typedef struct
+{
+    int     nXSize;
+    int     nYSize;
+    double *padfX;
+    double *padfY;
+    int    *pabSuccess;
+    GByte  *pabyRowDone;
+    int     nRefCount;
+    GUIntBig nLastUse;
+} GDALWarpSrcCoordGrid;
+
+void GDALCleanupWarpSrcCoordCache();
+
 /************************************************************************/
 /*      Color table related                                             */
 /************************************************************************/
@@ -39,6 +39,11 @@
 #include <cmath>
 #include <algorithm>
 
+#if (defined(__x86_64) || defined(_M_X64))
+#define USE_SSE2_OPTIM
+#include "gdalsse_priv.h"
+#endif
+
 CPL_CVSID("$Id$");
 
 CPL_C_START
@@ -2667,6 +2672,59 @@ void GDALDestroyApproxTransformer( void * pCBData )
     CPLFree( pCBData );
 }
 
+/************************************************************************/
+/*                      GDALApproxInterpolateLine()                     */
+/*                                                                      */
+/*      Evaluate the linear approximation over a whole run of points    */
+/*      sharing the same y: each output is the transformed position of */
+/*      the first point plus the per-unit delta times the distance to   */
+/*      it along x.                                                     */
+/************************************************************************/
+
+static void GDALApproxInterpolateLine( int nPoints,
+                                       double *x, double *y, double *z,
+                                       int *panSuccess,
+                                       double dfX0Transformed,
+                                       double dfY0Transformed,
+                                       double dfZ0Transformed,
+                                       double dfDeltaX, double dfDeltaY,
+                                       double dfDeltaZ )
+{
+    const double dfX0 = x[0];
+    int i = 0;
+
+#ifdef USE_SSE2_OPTIM
+    const XMMReg2Double x0 = XMMReg2Double::Load1ValHighAndLow(&dfX0);
+    const XMMReg2Double xT0 =
+        XMMReg2Double::Load1ValHighAndLow(&dfX0Transformed);
+    const XMMReg2Double yT0 =
+        XMMReg2Double::Load1ValHighAndLow(&dfY0Transformed);
+    const XMMReg2Double zT0 =
+        XMMReg2Double::Load1ValHighAndLow(&dfZ0Transformed);
+    const XMMReg2Double deltaX = XMMReg2Double::Load1ValHighAndLow(&dfDeltaX);
+    const XMMReg2Double deltaY = XMMReg2Double::Load1ValHighAndLow(&dfDeltaY);
+    const XMMReg2Double deltaZ = XMMReg2Double::Load1ValHighAndLow(&dfDeltaZ);
+    for( ; i + 1 < nPoints; i += 2 )
+    {
+        const XMMReg2Double dist = XMMReg2Double::Load2Val(x + i) - x0;
+        (xT0 + deltaX * dist).Store2Double(x + i);
+        (yT0 + deltaY * dist).Store2Double(y + i);
+        (zT0 + deltaZ * dist).Store2Double(z + i);
+        panSuccess[i] = TRUE;
+        panSuccess[i+1] = TRUE;
+    }
+#endif
+
+    for( ; i < nPoints; i++ )
+    {
+        const double dfDist = x[i] - dfX0;
+        x[i] = dfX0Transformed + dfDeltaX * dfDist;
+        y[i] = dfY0Transformed + dfDeltaY * dfDist;
+        z[i] = dfZ0Transformed + dfDeltaZ * dfDist;
+        panSuccess[i] = TRUE;
+    }
+}
+
 /************************************************************************/
 /*                      GDALApproxTransformInternal()                   */
 /************************************************************************/
@@ -2678,8 +2736,8 @@ static int GDALApproxTransformInternal( void *pCBData, int bDstToSrc, int nPoint
                                         const double zSMETransformed[3])
 {
     ApproxTransformInfo *psATInfo = (ApproxTransformInfo *) pCBData;
-    double dfDeltaX, dfDeltaY, dfError, dfDist, dfDeltaZ;
-    int nMiddle, i, bSuccess;
+    double dfDeltaX, dfDeltaY, dfError, dfDeltaZ;
+    int nMiddle, bSuccess;
 
     nMiddle = (nPoints-1)/2;
 
@@ -2899,28 +2957,28 @@ static int GDALApproxTransformInternal( void *pCBData, int bDstToSrc, int nPoint
 /*      NOTE: the above comment is not true: gdalwarp uses approximator */
 /*      also to compute the source pixel of each target pixel.          */
 /* -------------------------------------------------------------------- */
-    for( i = nPoints-1; i >= 0; i-- )
-    {
 #ifdef check_error
+    for( int i = nPoints-1; i >= 0; i-- )
+    {
         double xtemp = x[i], ytemp = y[i], ztemp = z[i];
         double x_ori = xtemp, y_ori = ytemp;
         int btemp;
         psATInfo->pfnBaseTransformer( psATInfo->pBaseCBData, bDstToSrc,
                                       1, &xtemp, &ytemp, &ztemp, &btemp);
-#endif
-        dfDist = (x[i] - x[0]);
-        x[i] = xSMETransformed[0] + dfDeltaX * dfDist;
-        y[i] = ySMETransformed[0] + dfDeltaY * dfDist;
-        z[i] = zSMETransformed[0] + dfDeltaZ * dfDist;
-#ifdef check_error
-        dfError = fabs(x[i] - xtemp) + fabs(y[i] - ytemp);
+        const double dfDist = (x[i] - x[0]);
+        dfError = fabs(xSMETransformed[0] + dfDeltaX * dfDist - xtemp) +
+                  fabs(ySMETransformed[0] + dfDeltaY * dfDist - ytemp);
         if( dfError > 4 /*10 * psATInfo->dfMaxError*/ )
         {
             printf("Error = %f on (%f, %f)\n", dfError,  x_ori, y_ori);
         }
-#endif
-        panSuccess[i] = TRUE;
     }
+#endif
+
+    GDALApproxInterpolateLine( nPoints, x, y, z, panSuccess,
+                               xSMETransformed[0], ySMETransformed[0],
+                               zSMETransformed[0],
+                               dfDeltaX, dfDeltaY, dfDeltaZ );
 
     return TRUE;
 }
@@ -1151,6 +1151,13 @@ GDALWarpDstAlphaMasker( void *pMaskFuncArg, int nBandCount,
  * set the number of threads to use to parallelize the computation part of the
  * warping. If not set, computation will be done in a single thread.</li>
  *
+ * <li>NUM_CHUNK_THREADS: (GDAL >= 2.2) Can be set to a numeric value or
+ * ALL_CPUS to set the number of threads processing chunks in
+ * GDALWarpOperation::ChunkAndWarpMulti(). Defaults to 2, which overlaps the
+ * input/output of a chunk with the warping of another one. With higher
+ * values, several chunks are warped concurrently, and the memory used can
+ * reach this number of times the warp memory limit.</li>
+ *
  * <li>STREAMABLE_OUTPUT: (GDAL >= 2.0) This defaults to FALSE, but may
  * be set to TRUE typically when writing to a streamed file. The
  * gdalwarp utility automatically sets this option when writing to
@@ -1173,6 +1180,22 @@ GDALWarpDstAlphaMasker( void *pMaskFuncArg, int nBandCount,
  * reprojections must statistically be done with a frequency of
  * 4*error_threshold/SRC_COORD_PRECISION.</li>
  *
+ * <li>SRC_COORD_CACHE: (GDAL >= 2.2). Advanced setting. This defaults to
+ * FALSE. If set to TRUE, the source image coordinates computed for each
+ * destination chunk are kept in a process-wide cache, keyed by the
+ * serialized transformer and the chunk window, so that warping again with
+ * an identical transformer and the same chunks (for example a time series
+ * of identically gridded rasters) only does the resampling. The memory
+ * used by the cache is limited by the GDAL_WARP_SRC_COORD_CACHE_MAX
+ * configuration option, in MB (default 256). Only the nearest, bilinear,
+ * cubic, cubicspline and lanczos kernels use and fill the cache. The
+ * transformer must be serializable.</li>
+ *
+ * <li>SRC_COORD_CACHE_DIR: (GDAL >= 2.2). Advanced setting. When
+ * SRC_COORD_CACHE is set, name of an existing directory where the source
+ * coordinate grids are also saved, and looked for when they are not in
+ * memory, so that they can be reused by other processes.</li>
+ *
  * <li>SRC_ALPHA_MAX: (GDAL >= 2.2). Maximum value for the alpha band of the
  * source dataset. If the value is not set and the alpha band has a NBITS
  * metadata item, it is used to set SRC_ALPHA_MAX = 2^NBITS-1. Otherwise, if the
@@ -384,6 +384,8 @@ public:
 /*! @cond Doxygen_Suppress */
     /** Per-thread data. Internally set */
     void                *psThreadData;
+    /** Source coordinate grid to use or fill. Internally set */
+    void                *psSrcCoordGrid;
 /*! @endcond */
 
                        GDALWarpKernel();
@@ -443,6 +445,15 @@ private:
 
     void           *psThreadData;
 
+    // Key of the source coordinate grids of this operation when the
+    // SRC_COORD_CACHE warp option is set, otherwise NULL.
+    char           *pszSrcCoordCacheKey;
+
+    // Set by the ChunkAndWarpMulti() worker that currently holds hIOMutex.
+    void           *psCurrentChunkWorker;
+
+    static void     ChunkThreadMain( void * );
+
     void            WipeChunkList();
     CPLErr          CollectChunkList( int nDstXOff, int nDstYOff,
                                       int nDstXSize, int nDstYSize );
@@ -38,6 +38,7 @@
 #include "cpl_string.h"
 #include "gdalwarpkernel_opencl.h"
 #include "cpl_atomic_ops.h"
+#include "cpl_cpu_features.h"
 #include "cpl_worker_thread_pool.h"
 #include <limits>
 #include <new>
@@ -210,6 +211,27 @@ static int GWKProgressThread(GWKJobStruct* psJob)
     return bStop;
 }
 
+/************************************************************************/
+/*                            GWKJobFailed()                            */
+/************************************************************************/
+
+/* Interrupt the computation after a failure of a job, that must have been */
+/* reported with CPLError(). */
+static void GWKJobFailed(GWKJobStruct* psJob)
+{
+    if( psJob->hCondMutex != NULL )
+    {
+        CPLAcquireMutex(psJob->hCondMutex, 1.0);
+        *(psJob->pbStop) = TRUE;
+        CPLCondSignal(psJob->hCond);
+        CPLReleaseMutex(psJob->hCondMutex);
+    }
+    else
+    {
+        *(psJob->pbStop) = TRUE;
+    }
+}
+
 /************************************************************************/
 /*                      GWKProgressMonoThread()                         */
 /************************************************************************/
@@ -489,6 +511,9 @@ static CPLErr GWKRun( GDALWarpKernel *poWK,
         while(nCounter < nDstYSize)
         {
             CPLCondWait(psThreadData->hCond, psThreadData->hCondMutex);
+            /* A failed job will not report progress for all its lines */
+            if( bStop )
+                break;
 
             if( !poWK->pfnProgress( poWK->dfProgressBase + poWK->dfProgressScale *
                                     (nCounter / (double) nDstYSize),
@@ -974,6 +999,7 @@ GDALWarpKernel::GDALWarpKernel()
     papszWarpOptions = NULL;
     padfDstNoDataReal = NULL;
     psThreadData = NULL;
+    psSrcCoordGrid = NULL;
 }
 
 /************************************************************************/
@@ -3084,6 +3110,369 @@ static double GWKBSpline4Values( double* padfValues )
     }
     return padfValues[0] + padfValues[1] + padfValues[2] + padfValues[3];
 }
+
+/************************************************************************/
+/*                            GWKUseAVX2()                              */
+/************************************************************************/
+
+// Setting GDAL_USE_AVX2=NO forces the SSE2 convolution code, which gives
+// the same results, to benchmark both implementations.
+static bool GWKUseAVX2()
+{
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && ( defined(__x86_64) || defined(_M_X64) )
+    return CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX2", "YES")) &&
+           CPLHaveRuntimeAVX2();
+#else
+    return false;
+#endif
+}
+
+/* We restrict to 64bit processors because they are guaranteed to have SSE2 */
+/* Could possibly be used too on 32bit, but we would need to check at runtime */
+#if defined(__x86_64) || defined(_M_X64)
+
+/************************************************************************/
+/*                    Horizontal convolution kernels                    */
+/************************************************************************/
+
+// The kernels below compute the weighted sums of nCols consecutive source
+// pixels for 4 (or 2) source rows, nSrcXSize pixels apart. The AVX2 versions,
+// in gdalwarpkernel_avx2.cpp, give exactly the same results as the SSE2 ones.
+// The NoMasks4Rows kernels are used by GWKResampleNoMasks_SSE2_T(), and the
+// Lanczos kernels, which sum the pixels of each row from left to right as
+// GWKResampleOptimizedLanczos() always did, by GWKLanczosAccumulateT().
+
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+void GWKResampleNoMasks4Rows_Byte_AVX2( const GByte* pSrc, int nSrcXSize,
+                                        int nCols, const double* padfWeights,
+                                        double* padfRowAcc );
+void GWKResampleNoMasks4Rows_Int16_AVX2( const GInt16* pSrc, int nSrcXSize,
+                                         int nCols, const double* padfWeights,
+                                         double* padfRowAcc );
+void GWKResampleNoMasks4Rows_UInt16_AVX2( const GUInt16* pSrc, int nSrcXSize,
+                                          int nCols,
+                                          const double* padfWeights,
+                                          double* padfRowAcc );
+void GWKResampleNoMasks4Rows_Float_AVX2( const float* pSrc, int nSrcXSize,
+                                         int nCols, const double* padfWeights,
+                                         double* padfRowAcc );
+void GWKLanczos4Rows_Byte_AVX2( const GByte* pSrc, int nSrcXSize,
+                                int nCols, const double* padfWeights,
+                                double* padfRowAcc );
+void GWKLanczos4Rows_Int16_AVX2( const GInt16* pSrc, int nSrcXSize,
+                                 int nCols, const double* padfWeights,
+                                 double* padfRowAcc );
+void GWKLanczos4Rows_UInt16_AVX2( const GUInt16* pSrc, int nSrcXSize,
+                                  int nCols, const double* padfWeights,
+                                  double* padfRowAcc );
+void GWKLanczos4Rows_Float_AVX2( const float* pSrc, int nSrcXSize,
+                                 int nCols, const double* padfWeights,
+                                 double* padfRowAcc );
+#endif
+
+/************************************************************************/
+/*                    GWKResampleNoMasks4Rows_SSE2()                    */
+/************************************************************************/
+
+template<class T>
+static void GWKResampleNoMasks4Rows_SSE2( const T* pSrc, int nSrcXSize,
+                                          int nCols, const double* padfWeights,
+                                          double* padfRowAcc )
+{
+    int i = 0;
+    /* Process by chunk of 4 cols */
+    XMMReg4Double v_acc_1 = XMMReg4Double::Zero();
+    XMMReg4Double v_acc_2 = XMMReg4Double::Zero();
+    XMMReg4Double v_acc_3 = XMMReg4Double::Zero();
+    XMMReg4Double v_acc_4 = XMMReg4Double::Zero();
+    for(; i+3 < nCols; i+=4 )
+    {
+        // Retrieve the pixel & accumulate
+        XMMReg4Double v_pixels_1 = XMMReg4Double::Load4Val(pSrc+i);
+        XMMReg4Double v_pixels_2 = XMMReg4Double::Load4Val(pSrc+i+nSrcXSize);
+        XMMReg4Double v_pixels_3 = XMMReg4Double::Load4Val(pSrc+i+2*nSrcXSize);
+        XMMReg4Double v_pixels_4 = XMMReg4Double::Load4Val(pSrc+i+3*nSrcXSize);
+
+        XMMReg4Double v_padfWeight = XMMReg4Double::Load4Val(padfWeights + i);
+
+        v_acc_1 += v_pixels_1 * v_padfWeight;
+        v_acc_2 += v_pixels_2 * v_padfWeight;
+        v_acc_3 += v_pixels_3 * v_padfWeight;
+        v_acc_4 += v_pixels_4 * v_padfWeight;
+    }
+
+    if( i+1 < nCols )
+    {
+        XMMReg2Double v_pixels_1 = XMMReg2Double::Load2Val(pSrc+i);
+        XMMReg2Double v_pixels_2 = XMMReg2Double::Load2Val(pSrc+i+nSrcXSize);
+        XMMReg2Double v_pixels_3 = XMMReg2Double::Load2Val(pSrc+i+2*nSrcXSize);
+        XMMReg2Double v_pixels_4 = XMMReg2Double::Load2Val(pSrc+i+3*nSrcXSize);
+
+        XMMReg2Double v_padfWeight = XMMReg2Double::Load2Val(padfWeights + i);
+
+        v_acc_1.GetLow() += v_pixels_1 * v_padfWeight;
+        v_acc_2.GetLow() += v_pixels_2 * v_padfWeight;
+        v_acc_3.GetLow() += v_pixels_3 * v_padfWeight;
+        v_acc_4.GetLow() += v_pixels_4 * v_padfWeight;
+
+        i+=2;
+    }
+
+    v_acc_1.AddLowAndHigh();
+    v_acc_2.AddLowAndHigh();
+    v_acc_3.AddLowAndHigh();
+    v_acc_4.AddLowAndHigh();
+
+    padfRowAcc[0] = (double)v_acc_1.GetLow();
+    padfRowAcc[1] = (double)v_acc_2.GetLow();
+    padfRowAcc[2] = (double)v_acc_3.GetLow();
+    padfRowAcc[3] = (double)v_acc_4.GetLow();
+
+    if( i < nCols )
+    {
+        padfRowAcc[0] += (double)pSrc[i] * padfWeights[i];
+        padfRowAcc[1] += (double)pSrc[i + nSrcXSize] * padfWeights[i];
+        padfRowAcc[2] += (double)pSrc[i + 2 * nSrcXSize] * padfWeights[i];
+        padfRowAcc[3] += (double)pSrc[i + 3 * nSrcXSize] * padfWeights[i];
+    }
+}
+
+/************************************************************************/
+/*                      GWKResampleNoMasks4Rows()                       */
+/************************************************************************/
+
+template<class T>
+static inline void GWKResampleNoMasks4Rows( CPL_UNUSED bool bUseAVX2,
+                                            const T* pSrc, int nSrcXSize,
+                                            int nCols,
+                                            const double* padfWeights,
+                                            double* padfRowAcc )
+{
+    GWKResampleNoMasks4Rows_SSE2(pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+static inline void GWKResampleNoMasks4Rows( CPL_UNUSED bool bUseAVX2,
+                                            const GByte* pSrc, int nSrcXSize,
+                                            int nCols,
+                                            const double* padfWeights,
+                                            double* padfRowAcc )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+    {
+        GWKResampleNoMasks4Rows_Byte_AVX2(pSrc, nSrcXSize, nCols,
+                                          padfWeights, padfRowAcc);
+        return;
+    }
+#endif
+    GWKResampleNoMasks4Rows_SSE2(pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+static inline void GWKResampleNoMasks4Rows( CPL_UNUSED bool bUseAVX2,
+                                            const GInt16* pSrc, int nSrcXSize,
+                                            int nCols,
+                                            const double* padfWeights,
+                                            double* padfRowAcc )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+    {
+        GWKResampleNoMasks4Rows_Int16_AVX2(pSrc, nSrcXSize, nCols,
+                                           padfWeights, padfRowAcc);
+        return;
+    }
+#endif
+    GWKResampleNoMasks4Rows_SSE2(pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+static inline void GWKResampleNoMasks4Rows( CPL_UNUSED bool bUseAVX2,
+                                            const GUInt16* pSrc, int nSrcXSize,
+                                            int nCols,
+                                            const double* padfWeights,
+                                            double* padfRowAcc )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+    {
+        GWKResampleNoMasks4Rows_UInt16_AVX2(pSrc, nSrcXSize, nCols,
+                                            padfWeights, padfRowAcc);
+        return;
+    }
+#endif
+    GWKResampleNoMasks4Rows_SSE2(pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+static inline void GWKResampleNoMasks4Rows( CPL_UNUSED bool bUseAVX2,
+                                            const float* pSrc, int nSrcXSize,
+                                            int nCols,
+                                            const double* padfWeights,
+                                            double* padfRowAcc )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+    {
+        GWKResampleNoMasks4Rows_Float_AVX2(pSrc, nSrcXSize, nCols,
+                                           padfWeights, padfRowAcc);
+        return;
+    }
+#endif
+    GWKResampleNoMasks4Rows_SSE2(pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+/************************************************************************/
+/*                      GWKLanczos2Rows_SSE2()                          */
+/************************************************************************/
+
+// Each of the 2 lanes of the accumulator holds one row, and 2x2 blocks
+// of pixels are transposed, so that each row accumulates its pixels from
+// left to right.
+template<class T>
+static void GWKLanczos2Rows_SSE2( const T* pSrc, int nSrcXSize,
+                                  int nCols, const double* padfWeights,
+                                  double* padfRowAcc )
+{
+    XMMReg2Double v_acc = XMMReg2Double::Zero();
+    int i = 0;
+    for( ; i+1 < nCols; i+=2 )
+    {
+        XMMReg2Double v_col_1 = XMMReg2Double::Load2Val(pSrc+i);
+        XMMReg2Double v_col_2 = XMMReg2Double::Load2Val(pSrc+i+nSrcXSize);
+        XMMReg2Double::Transpose(v_col_1, v_col_2);
+        v_acc += v_col_1 * XMMReg2Double::Load1ValHighAndLow(padfWeights + i);
+        v_acc += v_col_2 * XMMReg2Double::Load1ValHighAndLow(padfWeights + i + 1);
+    }
+    v_acc.Store2Double(padfRowAcc);
+
+    if( i < nCols )
+    {
+        padfRowAcc[0] += (double)pSrc[i] * padfWeights[i];
+        padfRowAcc[1] += (double)pSrc[i + nSrcXSize] * padfWeights[i];
+    }
+}
+
+/************************************************************************/
+/*                         GWKLanczos4Rows()                            */
+/************************************************************************/
+
+template<class T>
+static inline void GWKLanczos4Rows( CPL_UNUSED bool bUseAVX2,
+                                    const T* pSrc, int nSrcXSize,
+                                    int nCols, const double* padfWeights,
+                                    double* padfRowAcc )
+{
+    GWKLanczos2Rows_SSE2(pSrc, nSrcXSize, nCols, padfWeights, padfRowAcc);
+    GWKLanczos2Rows_SSE2(pSrc + 2 * nSrcXSize, nSrcXSize, nCols, padfWeights,
+                         padfRowAcc + 2);
+}
+
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+
+static inline void GWKLanczos4Rows( bool bUseAVX2,
+                                    const GByte* pSrc, int nSrcXSize,
+                                    int nCols, const double* padfWeights,
+                                    double* padfRowAcc )
+{
+    if( bUseAVX2 )
+        GWKLanczos4Rows_Byte_AVX2(pSrc, nSrcXSize, nCols, padfWeights,
+                                  padfRowAcc);
+    else
+        GWKLanczos4Rows<GByte>(false, pSrc, nSrcXSize, nCols, padfWeights,
+                               padfRowAcc);
+}
+
+static inline void GWKLanczos4Rows( bool bUseAVX2,
+                                    const GInt16* pSrc, int nSrcXSize,
+                                    int nCols, const double* padfWeights,
+                                    double* padfRowAcc )
+{
+    if( bUseAVX2 )
+        GWKLanczos4Rows_Int16_AVX2(pSrc, nSrcXSize, nCols, padfWeights,
+                                   padfRowAcc);
+    else
+        GWKLanczos4Rows<GInt16>(false, pSrc, nSrcXSize, nCols, padfWeights,
+                                padfRowAcc);
+}
+
+static inline void GWKLanczos4Rows( bool bUseAVX2,
+                                    const GUInt16* pSrc, int nSrcXSize,
+                                    int nCols, const double* padfWeights,
+                                    double* padfRowAcc )
+{
+    if( bUseAVX2 )
+        GWKLanczos4Rows_UInt16_AVX2(pSrc, nSrcXSize, nCols, padfWeights,
+                                    padfRowAcc);
+    else
+        GWKLanczos4Rows<GUInt16>(false, pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+static inline void GWKLanczos4Rows( bool bUseAVX2,
+                                    const float* pSrc, int nSrcXSize,
+                                    int nCols, const double* padfWeights,
+                                    double* padfRowAcc )
+{
+    if( bUseAVX2 )
+        GWKLanczos4Rows_Float_AVX2(pSrc, nSrcXSize, nCols, padfWeights,
+                                   padfRowAcc);
+    else
+        GWKLanczos4Rows<float>(false, pSrc, nSrcXSize, nCols, padfWeights,
+                               padfRowAcc);
+}
+
+#endif /* HAVE_AVX2_AT_COMPILE_TIME */
+
+/************************************************************************/
+/*                       GWKLanczosAccumulateT()                        */
+/************************************************************************/
+
+// Returns the sum of the nRows x nCols source pixels starting at pSrc,
+// weighted by padfWeightsX[] horizontally and padfWeightsY[] vertically,
+// in the same order as the generic code of GWKResampleOptimizedLanczos().
+template<class T>
+static double GWKLanczosAccumulateT( bool bUseAVX2,
+                                     const T* pSrc, int nSrcXSize,
+                                     int nRows, int nCols,
+                                     const double* padfWeightsX,
+                                     const double* padfWeightsY )
+{
+    double dfAccumulator = 0.0;
+    double adfRowAcc[4];
+    int j = 0;
+    for( ; j+3 < nRows; j+=4 )
+    {
+        GWKLanczos4Rows(bUseAVX2, pSrc + j * nSrcXSize, nSrcXSize, nCols,
+                        padfWeightsX, adfRowAcc);
+        dfAccumulator += adfRowAcc[0] * padfWeightsY[j];
+        dfAccumulator += adfRowAcc[1] * padfWeightsY[j+1];
+        dfAccumulator += adfRowAcc[2] * padfWeightsY[j+2];
+        dfAccumulator += adfRowAcc[3] * padfWeightsY[j+3];
+    }
+    if( j+1 < nRows )
+    {
+        GWKLanczos2Rows_SSE2(pSrc + j * nSrcXSize, nSrcXSize, nCols,
+                             padfWeightsX, adfRowAcc);
+        dfAccumulator += adfRowAcc[0] * padfWeightsY[j];
+        dfAccumulator += adfRowAcc[1] * padfWeightsY[j+1];
+        j += 2;
+    }
+    if( j < nRows )
+    {
+        const T* pSrcRow = pSrc + j * nSrcXSize;
+        double dfRowAcc = 0.0;
+        for( int i = 0; i < nCols; ++i )
+            dfRowAcc += (double)pSrcRow[i] * padfWeightsX[i];
+        dfAccumulator += dfRowAcc * padfWeightsY[j];
+    }
+    return dfAccumulator;
+}
+
+#endif /* defined(__x86_64) || defined(_M_X64) */
+
 /************************************************************************/
 /*                       GWKResampleWrkStruct                           */
 /************************************************************************/
@@ -3105,10 +3494,15 @@ struct _GWKResampleWrkStruct
     bool    *pabCalcX;
 
     double  *padfWeightsY; // only used by GWKResampleOptimizedLanczos
-    int      iLastSrcX; // only used by GWKResampleOptimizedLanczos
-    int      iLastSrcY; // only used by GWKResampleOptimizedLanczos
+    // Range of kernel offsets for which padfWeightsX/Y hold the weights of
+    // dfLastDeltaX/Y.
+    int      iLastMinX; // only used by GWKResampleOptimizedLanczos
+    int      iLastMaxX; // only used by GWKResampleOptimizedLanczos
+    int      iLastMinY; // only used by GWKResampleOptimizedLanczos
+    int      iLastMaxY; // only used by GWKResampleOptimizedLanczos
     double   dfLastDeltaX; // only used by GWKResampleOptimizedLanczos
     double   dfLastDeltaY; // only used by GWKResampleOptimizedLanczos
+    bool     bUseAVX2; // only used by GWKResampleOptimizedLanczos
 
     // Space for saving a row of pixels
     double  *padfRowDensity;
@@ -3145,10 +3539,13 @@ static GWKResampleWrkStruct* GWKResampleCreateWrkStruct(GDALWarpKernel *poWK)
     psWrkStruct->pabCalcX = (bool *)CPLMalloc( nXDist * sizeof(bool) );
 
     psWrkStruct->padfWeightsY = (double *)CPLCalloc( nYDist, sizeof(double) );
-    psWrkStruct->iLastSrcX = -10;
-    psWrkStruct->iLastSrcY = -10;
+    psWrkStruct->iLastMinX = 0;
+    psWrkStruct->iLastMaxX = -1;
+    psWrkStruct->iLastMinY = 0;
+    psWrkStruct->iLastMaxY = -1;
     psWrkStruct->dfLastDeltaX = -10;
     psWrkStruct->dfLastDeltaY = -10;
+    psWrkStruct->bUseAVX2 = GWKUseAVX2();
 
     // Alloc space for saving a row of pixels
     if( poWK->pafUnifiedSrcDensity == NULL &&
@@ -3454,8 +3851,11 @@ static bool GWKResampleOptimizedLanczos( GDALWarpKernel *poWK, int iBand,
         while( iMax - dfDeltaX > 3.0 )
             iMax --;
 
-        if( iSrcX != psWrkStruct->iLastSrcX ||
-            dfDeltaX != psWrkStruct->dfLastDeltaX )
+        // The weights only depend on dfDeltaX, so they can be reused for
+        // another source pixel, as long as they have been computed for all
+        // the offsets of the kernel.
+        if( dfDeltaX != psWrkStruct->dfLastDeltaX ||
+            iMin < psWrkStruct->iLastMinX || iMax > psWrkStruct->iLastMaxX )
         {
             // Optimisation of GWKLanczosSinc(i - dfDeltaX) based on the following
             // trigonometric formulas.
@@ -3498,7 +3898,8 @@ static bool GWKResampleOptimizedLanczos( GDALWarpKernel *poWK, int iBand,
                 //CPLAssert(fabs(padfWeightsX[i-poWK->nFiltInitX] - GWKLanczosSinc(dfX, 3.0)) < 1e-10);
             }
 
-            psWrkStruct->iLastSrcX = iSrcX;
+            psWrkStruct->iLastMinX = iMin;
+            psWrkStruct->iLastMaxX = iMax;
             psWrkStruct->dfLastDeltaX = dfDeltaX;
         }
     }
@@ -3518,8 +3919,8 @@ static bool GWKResampleOptimizedLanczos( GDALWarpKernel *poWK, int iBand,
         while( jMax - dfDeltaY > 3.0 )
             jMax --;
 
-        if( iSrcY != psWrkStruct->iLastSrcY ||
-            dfDeltaY != psWrkStruct->dfLastDeltaY )
+        if( dfDeltaY != psWrkStruct->dfLastDeltaY ||
+            jMin < psWrkStruct->iLastMinY || jMax > psWrkStruct->iLastMaxY )
         {
             double dfSinPIDeltaYOver3 = sin((-M_PI / 3) * dfDeltaY);
             double dfSin2PIDeltaYOver3 = dfSinPIDeltaYOver3 * dfSinPIDeltaYOver3;
@@ -3551,7 +3952,8 @@ static bool GWKResampleOptimizedLanczos( GDALWarpKernel *poWK, int iBand,
                 //CPLAssert(fabs(padfWeightsY[j-poWK->nFiltInitY] - GWKLanczosSinc(dfY, 3.0)) < 1e-10);
             }
 
-            psWrkStruct->iLastSrcY = iSrcY;
+            psWrkStruct->iLastMinY = jMin;
+            psWrkStruct->iLastMaxY = jMax;
             psWrkStruct->dfLastDeltaY = dfDeltaY;
         }
     }
@@ -3577,8 +3979,64 @@ static bool GWKResampleOptimizedLanczos( GDALWarpKernel *poWK, int iBand,
 
     const bool bIsNonComplex = !GDALDataTypeIsComplex(poWK->eWorkingDataType);
 
+    bool bRowsDone = false;
+#if defined(__x86_64) || defined(_M_X64)
+    // Without masks, read the source pixels in place rather than through
+    // GWKGetPixelRow(), and process several rows at once.
+    if( padfRowDensity == NULL )
+    {
+        const int nRows = jMax - jMin + 1;
+        const int nCols = iMax - iMin + 1;
+        const int iFirstOffset = iSrcOffset + jMin * nSrcXSize + iMin;
+        const double* padfWeightsXFirst = padfWeightsX + iMin - poWK->nFiltInitX;
+        const double* padfWeightsYFirst = padfWeightsY + jMin - poWK->nFiltInitY;
+        const bool bUseAVX2 = psWrkStruct->bUseAVX2;
+        bRowsDone = true;
+        switch( poWK->eWorkingDataType )
+        {
+            case GDT_Byte:
+                dfAccumulatorReal = GWKLanczosAccumulateT( bUseAVX2,
+                    poWK->papabySrcImage[iBand] + iFirstOffset,
+                    nSrcXSize, nRows, nCols,
+                    padfWeightsXFirst, padfWeightsYFirst );
+                break;
+            case GDT_Int16:
+                dfAccumulatorReal = GWKLanczosAccumulateT( bUseAVX2,
+                    reinterpret_cast<const GInt16*>(
+                        poWK->papabySrcImage[iBand]) + iFirstOffset,
+                    nSrcXSize, nRows, nCols,
+                    padfWeightsXFirst, padfWeightsYFirst );
+                break;
+            case GDT_UInt16:
+                dfAccumulatorReal = GWKLanczosAccumulateT( bUseAVX2,
+                    reinterpret_cast<const GUInt16*>(
+                        poWK->papabySrcImage[iBand]) + iFirstOffset,
+                    nSrcXSize, nRows, nCols,
+                    padfWeightsXFirst, padfWeightsYFirst );
+                break;
+            case GDT_Float32:
+                dfAccumulatorReal = GWKLanczosAccumulateT( bUseAVX2,
+                    reinterpret_cast<const float*>(
+                        poWK->papabySrcImage[iBand]) + iFirstOffset,
+                    nSrcXSize, nRows, nCols,
+                    padfWeightsXFirst, padfWeightsYFirst );
+                break;
+            case GDT_Float64:
+                dfAccumulatorReal = GWKLanczosAccumulateT( bUseAVX2,
+                    reinterpret_cast<const double*>(
+                        poWK->papabySrcImage[iBand]) + iFirstOffset,
+                    nSrcXSize, nRows, nCols,
+                    padfWeightsXFirst, padfWeightsYFirst );
+                break;
+            default:
+                bRowsDone = false;
+                break;
+        }
+    }
+#endif
+
     // Loop over pixel rows in the kernel
-    for ( int j = jMin; j <= jMax; ++j )
+    for ( int j = jMin; !bRowsDone && j <= jMax; ++j )
     {
         double  dfWeight1;
 
@@ -3678,6 +4136,165 @@ static bool GWKResampleOptimizedLanczos( GDALWarpKernel *poWK, int iBand,
     return true;
 }
 
+/************************************************************************/
+/*                     GWKResampleNoMasksWeights                        */
+/************************************************************************/
+
+// Kernel weights of GWKResampleNoMasksT(). They only depend on the
+// fractional part of the source coordinates and on the clipping of the
+// kernel at the edges of the source window, so they are kept from one call
+// to the next. This saves their computation for all the bands of a pixel
+// but the first one, and for consecutive destination pixels when the
+// scaling ratio is an integer.
+typedef struct
+{
+    double *padfWeightsX;
+    double *padfWeightsY;
+    double  dfWeightSumX;
+    double  dfWeightSumY;
+    double  dfLastDeltaX;
+    double  dfLastDeltaY;
+    int     iLastMinX;
+    int     iLastMaxX;
+    int     iLastMinY;
+    int     iLastMaxY;
+    bool    bUseAVX2;
+} GWKResampleNoMasksWeights;
+
+static void GWKResampleNoMasksInitWeights( const GDALWarpKernel *poWK,
+                                           GWKResampleNoMasksWeights* psWeights )
+{
+    psWeights->padfWeightsX =
+        (double *)CPLCalloc( 1 + poWK->nXRadius * 2, sizeof(double) );
+    psWeights->padfWeightsY =
+        (double *)CPLCalloc( 1 + poWK->nYRadius * 2, sizeof(double) );
+    psWeights->dfWeightSumX = 0.0;
+    psWeights->dfWeightSumY = 0.0;
+    // Fractional parts are in [0,1[, so this invalidates the cache.
+    psWeights->dfLastDeltaX = -1.0;
+    psWeights->dfLastDeltaY = -1.0;
+    psWeights->iLastMinX = 0;
+    psWeights->iLastMaxX = 0;
+    psWeights->iLastMinY = 0;
+    psWeights->iLastMaxY = 0;
+    psWeights->bUseAVX2 = GWKUseAVX2();
+}
+
+static void GWKResampleNoMasksFreeWeights( GWKResampleNoMasksWeights* psWeights )
+{
+    CPLFree( psWeights->padfWeightsX );
+    CPLFree( psWeights->padfWeightsY );
+}
+
+/************************************************************************/
+/*                  GWKResampleNoMasksComputeWeights()                  */
+/************************************************************************/
+
+// Computes the weights for the kernel offsets iMin to iMax into
+// padfWeights[0..iMax-iMin], and returns their sum. If pfnGetWeight4Values
+// is not NULL, they are computed by groups of 4.
+static double GWKResampleNoMasksComputeWeights(
+    FilterFuncType pfnGetWeight, FilterFunc4ValuesType pfnGetWeight4Values,
+    int iMin, int iMax, double dfDelta, double dfScale, double* padfWeights )
+{
+    double dfWeightSum = 0.0;
+    int i = iMin;
+    int iC = 0;
+    if( pfnGetWeight4Values != NULL )
+    {
+        for( ; i+2 < iMax; i+=4, iC+=4 )
+        {
+            padfWeights[iC] = (i - dfDelta) * dfScale;
+            padfWeights[iC+1] = padfWeights[iC] + dfScale;
+            padfWeights[iC+2] = padfWeights[iC+1] + dfScale;
+            padfWeights[iC+3] = padfWeights[iC+2] + dfScale;
+            dfWeightSum += pfnGetWeight4Values(padfWeights+iC);
+        }
+    }
+    for( ; i <= iMax; ++i, ++iC )
+    {
+        const double dfWeight = pfnGetWeight((i - dfDelta) * dfScale);
+        padfWeights[iC] = dfWeight;
+        dfWeightSum += dfWeight;
+    }
+    return dfWeightSum;
+}
+
+/************************************************************************/
+/*                  GWKResampleNoMasksUpdateWeights()                   */
+/************************************************************************/
+
+// Computes the extent of the kernel around (iSrcX, iSrcY), clipped to the
+// source window, and makes sure that psWeights holds the matching weights.
+// The X weights are always computed by groups of 4. The Y weights are
+// computed by groups of 4 only if bYWeightsBy4 is set, to match what the
+// caller did before the weights were cached.
+static void GWKResampleNoMasksUpdateWeights( const GDALWarpKernel *poWK,
+                                             int iSrcX, int iSrcY,
+                                             double dfDeltaX, double dfDeltaY,
+                                             bool bYWeightsBy4,
+                                             GWKResampleNoMasksWeights* psWeights,
+                                             int& iMin, int& iMax,
+                                             int& jMin, int& jMax )
+{
+    const int nSrcXSize = poWK->nSrcXSize;
+    const int nSrcYSize = poWK->nSrcYSize;
+    const int nXRadius = poWK->nXRadius;
+    const int nYRadius = poWK->nYRadius;
+
+    iMin = 1 - nXRadius;
+    if( iSrcX + iMin < 0 )
+        iMin = -iSrcX;
+    iMax = nXRadius;
+    if( iSrcX + iMax >= nSrcXSize-1 )
+        iMax = nSrcXSize-1 - iSrcX;
+
+    jMin = 1 - nYRadius;
+    if( iSrcY + jMin < 0 )
+        jMin = -iSrcY;
+    jMax = nYRadius;
+    if( iSrcY + jMax >= nSrcYSize-1 )
+        jMax = nSrcYSize-1 - iSrcY;
+
+    if( dfDeltaX == psWeights->dfLastDeltaX &&
+        iMin == psWeights->iLastMinX && iMax == psWeights->iLastMaxX &&
+        dfDeltaY == psWeights->dfLastDeltaY &&
+        jMin == psWeights->iLastMinY && jMax == psWeights->iLastMaxY )
+    {
+        return;
+    }
+
+    FilterFuncType pfnGetWeight = apfGWKFilter[poWK->eResample];
+    CPLAssert(pfnGetWeight);
+    FilterFunc4ValuesType pfnGetWeight4Values = apfGWKFilter4Values[poWK->eResample];
+    CPLAssert(pfnGetWeight4Values);
+
+    const double dfXScale = std::min(poWK->dfXScale, 1.0);
+    const double dfYScale = std::min(poWK->dfYScale, 1.0);
+
+    if( dfDeltaX != psWeights->dfLastDeltaX ||
+        iMin != psWeights->iLastMinX || iMax != psWeights->iLastMaxX )
+    {
+        psWeights->dfWeightSumX = GWKResampleNoMasksComputeWeights(
+            pfnGetWeight, pfnGetWeight4Values, iMin, iMax, dfDeltaX, dfXScale,
+            psWeights->padfWeightsX );
+        psWeights->dfLastDeltaX = dfDeltaX;
+        psWeights->iLastMinX = iMin;
+        psWeights->iLastMaxX = iMax;
+    }
+
+    if( dfDeltaY != psWeights->dfLastDeltaY ||
+        jMin != psWeights->iLastMinY || jMax != psWeights->iLastMaxY )
+    {
+        psWeights->dfWeightSumY = GWKResampleNoMasksComputeWeights(
+            pfnGetWeight, bYWeightsBy4 ? pfnGetWeight4Values : NULL,
+            jMin, jMax, dfDeltaY, dfYScale, psWeights->padfWeightsY );
+        psWeights->dfLastDeltaY = dfDeltaY;
+        psWeights->iLastMinY = jMin;
+        psWeights->iLastMaxY = jMax;
+    }
+}
+
 /************************************************************************/
 /*                        GWKResampleNoMasksT()                         */
 /************************************************************************/
@@ -3685,7 +4302,7 @@ static bool GWKResampleOptimizedLanczos( GDALWarpKernel *poWK, int iBand,
 template <class T>
 static bool GWKResampleNoMasksT( GDALWarpKernel *poWK, int iBand,
                                 double dfSrcX, double dfSrcY,
-                                T *pValue, double *padfWeight )
+                                T *pValue, GWKResampleNoMasksWeights* psWeights )
 
 {
     // Commonly used; save locally
@@ -3699,8 +4316,6 @@ static bool GWKResampleNoMasksT( GDALWarpKernel *poWK, int iBand,
     double  dfDeltaX = dfSrcX - 0.5 - iSrcX;
     double  dfDeltaY = dfSrcY - 0.5 - iSrcY;
 
-    double  dfXScale = poWK->dfXScale;
-    double  dfYScale = poWK->dfYScale;
     int     nXRadius = poWK->nXRadius;
     int     nYRadius = poWK->nYRadius;
 
@@ -3711,85 +4326,50 @@ static bool GWKResampleNoMasksT( GDALWarpKernel *poWK, int iBand,
          || nXRadius > nSrcXSize || nYRadius > nSrcYSize )
         return GWKBilinearResampleNoMasks4SampleT( poWK, iBand, dfSrcX, dfSrcY, pValue);
 
-    FilterFuncType pfnGetWeight = apfGWKFilter[poWK->eResample];
-    CPLAssert(pfnGetWeight);
-    FilterFunc4ValuesType pfnGetWeight4Values = apfGWKFilter4Values[poWK->eResample];
-    CPLAssert(pfnGetWeight4Values);
-
-    if( dfXScale > 1.0 ) dfXScale = 1.0;
-    if( dfYScale > 1.0 ) dfYScale = 1.0;
+    int iMin, iMax, jMin, jMax;
+    GWKResampleNoMasksUpdateWeights( poWK, iSrcX, iSrcY, dfDeltaX, dfDeltaY,
+                                     false, psWeights,
+                                     iMin, iMax, jMin, jMax );
+    const double* padfWeightsX = psWeights->padfWeightsX;
+    const double* padfWeightsY = psWeights->padfWeightsY;
 
     // Loop over all rows in the kernel
-    double dfAccumulatorWeightHorizontal = 0.0;
-    double dfAccumulatorWeightVertical = 0.0;
-
-    int iMin = 1 - nXRadius;
-    if( iSrcX + iMin < 0 )
-        iMin = -iSrcX;
-    int iMax = nXRadius;
-    if( iSrcX + iMax >= nSrcXSize-1 )
-        iMax = nSrcXSize-1 - iSrcX;
-    int i, iC;
-    for(iC = 0, i = iMin; i+2 < iMax; i+=4, iC+=4 )
-    {
-        padfWeight[iC] = (i - dfDeltaX) * dfXScale;
-        padfWeight[iC+1] = padfWeight[iC] + dfXScale;
-        padfWeight[iC+2] = padfWeight[iC+1] + dfXScale;
-        padfWeight[iC+3] = padfWeight[iC+2] + dfXScale;
-        dfAccumulatorWeightHorizontal += pfnGetWeight4Values(padfWeight+iC);
-    }
-    for(; i <= iMax; ++i, ++iC )
-    {
-        double dfWeight = pfnGetWeight((i - dfDeltaX) * dfXScale);
-        padfWeight[iC] = dfWeight;
-        dfAccumulatorWeightHorizontal += dfWeight;
-    }
-
-    int j = 1 - nYRadius;
-    if(  iSrcY + j < 0 )
-        j = -iSrcY;
-    int jMax = nYRadius;
-    if( iSrcY + jMax >= nSrcYSize-1 )
-        jMax = nSrcYSize-1 - iSrcY;
-
-    for ( ; j <= jMax; ++j )
+    for ( int j = jMin; j <= jMax; ++j )
     {
         int     iSampJ = iSrcOffset + j * nSrcXSize;
 
         // Loop over all pixels in the row
         double dfAccumulatorLocal = 0.0;
         double dfAccumulatorLocal2 = 0.0;
-        iC = 0;
-        i = iMin;
+        int iC = 0;
+        int i = iMin;
         /* Process by chunk of 4 cols */
         for(; i+2 < iMax; i+=4, iC+=4 )
         {
             // Retrieve the pixel & accumulate
-            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeight[iC];
-            dfAccumulatorLocal += (double)pSrcBand[i+1+iSampJ] * padfWeight[iC+1];
-            dfAccumulatorLocal2 += (double)pSrcBand[i+2+iSampJ] * padfWeight[iC+2];
-            dfAccumulatorLocal2 += (double)pSrcBand[i+3+iSampJ] * padfWeight[iC+3];
+            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeightsX[iC];
+            dfAccumulatorLocal += (double)pSrcBand[i+1+iSampJ] * padfWeightsX[iC+1];
+            dfAccumulatorLocal2 += (double)pSrcBand[i+2+iSampJ] * padfWeightsX[iC+2];
+            dfAccumulatorLocal2 += (double)pSrcBand[i+3+iSampJ] * padfWeightsX[iC+3];
         }
         dfAccumulatorLocal += dfAccumulatorLocal2;
         if( i < iMax )
         {
-            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeight[iC];
-            dfAccumulatorLocal += (double)pSrcBand[i+1+iSampJ] * padfWeight[iC+1];
+            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeightsX[iC];
+            dfAccumulatorLocal += (double)pSrcBand[i+1+iSampJ] * padfWeightsX[iC+1];
             i+=2;
             iC+=2;
         }
         if( i == iMax )
         {
-            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeight[iC];
+            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeightsX[iC];
         }
 
-        // Calculate the Y weight
-        double  dfWeight = pfnGetWeight((j - dfDeltaY) * dfYScale);
-        dfAccumulator += dfWeight * dfAccumulatorLocal;
-        dfAccumulatorWeightVertical += dfWeight;
+        // Apply the Y weight
+        dfAccumulator += padfWeightsY[j - jMin] * dfAccumulatorLocal;
     }
 
-    double dfAccumulatorWeight = dfAccumulatorWeightHorizontal * dfAccumulatorWeightVertical;
+    double dfAccumulatorWeight = psWeights->dfWeightSumX * psWeights->dfWeightSumY;
 
     *pValue = GWKClampValueT<T>(dfAccumulator / dfAccumulatorWeight);
 
@@ -3807,7 +4387,8 @@ static bool GWKResampleNoMasksT( GDALWarpKernel *poWK, int iBand,
 template<class T>
 static bool GWKResampleNoMasks_SSE2_T( GDALWarpKernel *poWK, int iBand,
                                       double dfSrcX, double dfSrcY,
-                                      T *pValue, double *padfWeight )
+                                      T *pValue,
+                                      GWKResampleNoMasksWeights* psWeights )
 {
     // Commonly used; save locally
     int     nSrcXSize = poWK->nSrcXSize;
@@ -3820,8 +4401,6 @@ static bool GWKResampleNoMasks_SSE2_T( GDALWarpKernel *poWK, int iBand,
     double  dfDeltaX = dfSrcX - 0.5 - iSrcX;
     double  dfDeltaY = dfSrcY - 0.5 - iSrcY;
 
-    double  dfXScale = poWK->dfXScale;
-    double  dfYScale = poWK->dfYScale;
     int     nXRadius = poWK->nXRadius;
     int     nYRadius = poWK->nYRadius;
 
@@ -3832,138 +4411,44 @@ static bool GWKResampleNoMasks_SSE2_T( GDALWarpKernel *poWK, int iBand,
          || nXRadius > nSrcXSize || nYRadius > nSrcYSize )
         return GWKBilinearResampleNoMasks4SampleT( poWK, iBand, dfSrcX, dfSrcY, pValue);
 
-    FilterFuncType pfnGetWeight = apfGWKFilter[poWK->eResample];
-    CPLAssert(pfnGetWeight);
-    FilterFunc4ValuesType pfnGetWeight4Values = apfGWKFilter4Values[poWK->eResample];
-    CPLAssert(pfnGetWeight4Values);
-
-    if( dfXScale > 1.0 ) dfXScale = 1.0;
-    if( dfYScale > 1.0 ) dfYScale = 1.0;
-
-    // Loop over all rows in the kernel
-    double dfAccumulatorWeightHorizontal = 0.0;
-    double dfAccumulatorWeightVertical = 0.0;
-
-    int iMin = 1 - nXRadius;
-    if( iSrcX + iMin < 0 )
-        iMin = -iSrcX;
-    int iMax = nXRadius;
-    if( iSrcX + iMax >= nSrcXSize-1 )
-        iMax = nSrcXSize-1 - iSrcX;
-    int i, iC;
-    for(iC = 0, i = iMin; i+2 < iMax; i+=4, iC+=4 )
-    {
-        padfWeight[iC] = (i - dfDeltaX) * dfXScale;
-        padfWeight[iC+1] = padfWeight[iC] + dfXScale;
-        padfWeight[iC+2] = padfWeight[iC+1] + dfXScale;
-        padfWeight[iC+3] = padfWeight[iC+2] + dfXScale;
-        dfAccumulatorWeightHorizontal += pfnGetWeight4Values(padfWeight+iC);
-    }
-    for(; i <= iMax; ++i, ++iC )
-    {
-        double dfWeight = pfnGetWeight((i - dfDeltaX) * dfXScale);
-        padfWeight[iC] = dfWeight;
-        dfAccumulatorWeightHorizontal += dfWeight;
-    }
-
-    int j = 1 - nYRadius;
-    if(  iSrcY + j < 0 )
-        j = -iSrcY;
-    int jMax = nYRadius;
-    if( iSrcY + jMax >= nSrcYSize-1 )
-        jMax = nSrcYSize-1 - iSrcY;
+    int iMin, iMax, jMin, jMax;
+    GWKResampleNoMasksUpdateWeights( poWK, iSrcX, iSrcY, dfDeltaX, dfDeltaY,
+                                     true, psWeights,
+                                     iMin, iMax, jMin, jMax );
+    const double* padfWeightsX = psWeights->padfWeightsX;
+    const double* padfWeightsY = psWeights->padfWeightsY;
+    const int nCols = iMax - iMin + 1;
 
+    int j = jMin;
     /* Process by chunk of 4 rows */
     for ( ; j+2 < jMax; j+=4 )
+    {
+        double adfRowAcc[4];
+        GWKResampleNoMasks4Rows( psWeights->bUseAVX2,
+                                 pSrcBand + iSrcOffset + j * nSrcXSize + iMin,
+                                 nSrcXSize, nCols, padfWeightsX, adfRowAcc );
+
+        // Apply the Y weights
+        const double* padfWeightsYRows = padfWeightsY + (j - jMin);
+        dfAccumulator += padfWeightsYRows[0] * adfRowAcc[0];
+        dfAccumulator += padfWeightsYRows[1] * adfRowAcc[1];
+        dfAccumulator += padfWeightsYRows[2] * adfRowAcc[2];
+        dfAccumulator += padfWeightsYRows[3] * adfRowAcc[3];
+    }
+    for ( ; j <= jMax; ++j )
     {
         int     iSampJ = iSrcOffset + j * nSrcXSize;
 
         // Loop over all pixels in the row
-        iC = 0;
-        i = iMin;
-        /* Process by chunk of 4 cols */
-        XMMReg4Double v_acc_1 = XMMReg4Double::Zero();
-        XMMReg4Double v_acc_2 = XMMReg4Double::Zero();
-        XMMReg4Double v_acc_3 = XMMReg4Double::Zero();
-        XMMReg4Double v_acc_4 = XMMReg4Double::Zero();
-        for(; i+2 < iMax; i+=4, iC+=4 )
-        {
-            // Retrieve the pixel & accumulate
-            XMMReg4Double v_pixels_1 = XMMReg4Double::Load4Val(pSrcBand+i+iSampJ);
-            XMMReg4Double v_pixels_2 = XMMReg4Double::Load4Val(pSrcBand+i+iSampJ+nSrcXSize);
-            XMMReg4Double v_pixels_3 = XMMReg4Double::Load4Val(pSrcBand+i+iSampJ+2*nSrcXSize);
-            XMMReg4Double v_pixels_4 = XMMReg4Double::Load4Val(pSrcBand+i+iSampJ+3*nSrcXSize);
-
-            XMMReg4Double v_padfWeight = XMMReg4Double::Load4Val(padfWeight + iC);
-
-            v_acc_1 += v_pixels_1 * v_padfWeight;
-            v_acc_2 += v_pixels_2 * v_padfWeight;
-            v_acc_3 += v_pixels_3 * v_padfWeight;
-            v_acc_4 += v_pixels_4 * v_padfWeight;
-        }
-
-        if( i < iMax )
-        {
-            XMMReg2Double v_pixels_1 = XMMReg2Double::Load2Val(pSrcBand+i+iSampJ);
-            XMMReg2Double v_pixels_2 = XMMReg2Double::Load2Val(pSrcBand+i+iSampJ+nSrcXSize);
-            XMMReg2Double v_pixels_3 = XMMReg2Double::Load2Val(pSrcBand+i+iSampJ+2*nSrcXSize);
-            XMMReg2Double v_pixels_4 = XMMReg2Double::Load2Val(pSrcBand+i+iSampJ+3*nSrcXSize);
-
-            XMMReg2Double v_padfWeight = XMMReg2Double::Load2Val(padfWeight + iC);
-
-            v_acc_1.GetLow() += v_pixels_1 * v_padfWeight;
-            v_acc_2.GetLow() += v_pixels_2 * v_padfWeight;
-            v_acc_3.GetLow() += v_pixels_3 * v_padfWeight;
-            v_acc_4.GetLow() += v_pixels_4 * v_padfWeight;
-
-            i+=2;
-            iC+=2;
-        }
-
-        v_acc_1.AddLowAndHigh();
-        v_acc_2.AddLowAndHigh();
-        v_acc_3.AddLowAndHigh();
-        v_acc_4.AddLowAndHigh();
-
-        double dfAccumulatorLocal_1 = (double)v_acc_1.GetLow(),
-               dfAccumulatorLocal_2 = (double)v_acc_2.GetLow(),
-               dfAccumulatorLocal_3 = (double)v_acc_3.GetLow(),
-               dfAccumulatorLocal_4 = (double)v_acc_4.GetLow();
-
-        if( i == iMax )
-        {
-            dfAccumulatorLocal_1 += (double)pSrcBand[i+iSampJ] * padfWeight[iC];
-            dfAccumulatorLocal_2 += (double)pSrcBand[i+iSampJ + nSrcXSize] * padfWeight[iC];
-            dfAccumulatorLocal_3 += (double)pSrcBand[i+iSampJ + 2 * nSrcXSize] * padfWeight[iC];
-            dfAccumulatorLocal_4 += (double)pSrcBand[i+iSampJ + 3 * nSrcXSize] * padfWeight[iC];
-        }
-
-        // Calculate the Y weight
-        double adfWeight[4];
-        adfWeight[0] = (j - dfDeltaY) * dfYScale;
-        adfWeight[1] = adfWeight[0] + dfYScale;
-        adfWeight[2] = adfWeight[1] + dfYScale;
-        adfWeight[3] = adfWeight[2] + dfYScale;
-        dfAccumulatorWeightVertical += pfnGetWeight4Values(adfWeight);
-        dfAccumulator += adfWeight[0] * dfAccumulatorLocal_1;
-        dfAccumulator += adfWeight[1] * dfAccumulatorLocal_2;
-        dfAccumulator += adfWeight[2] * dfAccumulatorLocal_3;
-        dfAccumulator += adfWeight[3] * dfAccumulatorLocal_4;
-    }
-    for ( ; j <= jMax; ++j )
-    {
-        int     iSampJ = iSrcOffset + j * nSrcXSize;
-
-        // Loop over all pixels in the row
-        iC = 0;
-        i = iMin;
+        int iC = 0;
+        int i = iMin;
         /* Process by chunk of 4 cols */
         XMMReg4Double v_acc = XMMReg4Double::Zero();
         for(; i+2 < iMax; i+=4, iC+=4 )
         {
             // Retrieve the pixel & accumulate
             XMMReg4Double v_pixels= XMMReg4Double::Load4Val(pSrcBand+i+iSampJ);
-            XMMReg4Double v_padfWeight = XMMReg4Double::Load4Val(padfWeight + iC);
+            XMMReg4Double v_padfWeight = XMMReg4Double::Load4Val(padfWeightsX + iC);
 
             v_acc += v_pixels * v_padfWeight;
         }
@@ -3974,23 +4459,21 @@ static bool GWKResampleNoMasks_SSE2_T( GDALWarpKernel *poWK, int iBand,
 
         if( i < iMax )
         {
-            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeight[iC];
-            dfAccumulatorLocal += (double)pSrcBand[i+1+iSampJ] * padfWeight[iC+1];
+            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeightsX[iC];
+            dfAccumulatorLocal += (double)pSrcBand[i+1+iSampJ] * padfWeightsX[iC+1];
             i+=2;
             iC+=2;
         }
         if( i == iMax )
         {
-            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeight[iC];
+            dfAccumulatorLocal += (double)pSrcBand[i+iSampJ] * padfWeightsX[iC];
         }
 
-        // Calculate the Y weight
-        double  dfWeight = pfnGetWeight((j - dfDeltaY) * dfYScale);
-        dfAccumulator += dfWeight * dfAccumulatorLocal;
-        dfAccumulatorWeightVertical += dfWeight;
+        // Apply the Y weight
+        dfAccumulator += padfWeightsY[j - jMin] * dfAccumulatorLocal;
     }
 
-    double dfAccumulatorWeight = dfAccumulatorWeightHorizontal * dfAccumulatorWeightVertical;
+    double dfAccumulatorWeight = psWeights->dfWeightSumX * psWeights->dfWeightSumY;
 
     *pValue = GWKClampValueT<T>(dfAccumulator / dfAccumulatorWeight);
 
@@ -4004,9 +4487,10 @@ static bool GWKResampleNoMasks_SSE2_T( GDALWarpKernel *poWK, int iBand,
 template<>
 bool GWKResampleNoMasksT<GByte>( GDALWarpKernel *poWK, int iBand,
                                 double dfSrcX, double dfSrcY,
-                                GByte *pValue, double *padfWeight )
+                                GByte *pValue,
+                                GWKResampleNoMasksWeights* psWeights )
 {
-    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, padfWeight);
+    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, psWeights);
 }
 
 /************************************************************************/
@@ -4016,9 +4500,10 @@ bool GWKResampleNoMasksT<GByte>( GDALWarpKernel *poWK, int iBand,
 template<>
 bool GWKResampleNoMasksT<GInt16>( GDALWarpKernel *poWK, int iBand,
                                  double dfSrcX, double dfSrcY,
-                                 GInt16 *pValue, double *padfWeight )
+                                 GInt16 *pValue,
+                                 GWKResampleNoMasksWeights* psWeights )
 {
-    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, padfWeight);
+    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, psWeights);
 }
 
 /************************************************************************/
@@ -4028,9 +4513,10 @@ bool GWKResampleNoMasksT<GInt16>( GDALWarpKernel *poWK, int iBand,
 template<>
 bool GWKResampleNoMasksT<GUInt16>( GDALWarpKernel *poWK, int iBand,
                                   double dfSrcX, double dfSrcY,
-                                  GUInt16 *pValue, double *padfWeight )
+                                  GUInt16 *pValue,
+                                  GWKResampleNoMasksWeights* psWeights )
 {
-    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, padfWeight);
+    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, psWeights);
 }
 
 /************************************************************************/
@@ -4040,9 +4526,10 @@ bool GWKResampleNoMasksT<GUInt16>( GDALWarpKernel *poWK, int iBand,
 template<>
 bool GWKResampleNoMasksT<float>( GDALWarpKernel *poWK, int iBand,
                                  double dfSrcX, double dfSrcY,
-                                 float *pValue, double *padfWeight )
+                                 float *pValue,
+                                 GWKResampleNoMasksWeights* psWeights )
 {
-    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, padfWeight);
+    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, psWeights);
 }
 
 #ifdef INSTANTIATE_FLOAT64_SSE2_IMPL
@@ -4054,9 +4541,10 @@ bool GWKResampleNoMasksT<float>( GDALWarpKernel *poWK, int iBand,
 template<>
 bool GWKResampleNoMasksT<double>( GDALWarpKernel *poWK, int iBand,
                                  double dfSrcX, double dfSrcY,
-                                 double *pValue, double *padfWeight )
+                                 double *pValue,
+                                 GWKResampleNoMasksWeights* psWeights )
 {
-    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, padfWeight);
+    return GWKResampleNoMasks_SSE2_T(poWK, iBand, dfSrcX, dfSrcY, pValue, psWeights);
 }
 
 #endif /* INSTANTIATE_FLOAT64_SSE2_IMPL */
@@ -4110,6 +4598,76 @@ static void GWKRoundSourceCoordinates(int nDstXSize,
     }
 }
 
+/************************************************************************/
+/*                     GWKComputeSourceCoordinates()                    */
+/*                                                                      */
+/*      Compute the source pixel/line coordinates of the centers of     */
+/*      the pixels of destination line iDstY. padfX must be             */
+/*      2 * nDstXSize large, its second half holding the destination    */
+/*      pixel x coordinates. If the kernel has a complete source        */
+/*      coordinate grid, the coordinates are taken from it instead of   */
+/*      running the transformer; if it has a grid being filled, the     */
+/*      computed coordinates are recorded into it.                      */
+/************************************************************************/
+
+static void GWKComputeSourceCoordinates( GDALWarpKernel *poWK,
+                                         void* pTransformerArg,
+                                         int iDstY,
+                                         double* padfX,
+                                         double* padfY,
+                                         double* padfZ,
+                                         int* pabSuccess,
+                                         double dfSrcCoordPrecision,
+                                         double dfErrorThreshold )
+{
+    const int nDstXSize = poWK->nDstXSize;
+    GDALWarpSrcCoordGrid* psGrid =
+        static_cast<GDALWarpSrcCoordGrid*>(poWK->psSrcCoordGrid);
+    const size_t nGridOffset = static_cast<size_t>(iDstY) * nDstXSize;
+
+    if( psGrid != NULL && psGrid->pabyRowDone == NULL )
+    {
+        memcpy( padfX, psGrid->padfX + nGridOffset,
+                sizeof(double) * nDstXSize );
+        memcpy( padfY, psGrid->padfY + nGridOffset,
+                sizeof(double) * nDstXSize );
+        memcpy( pabSuccess, psGrid->pabSuccess + nGridOffset,
+                sizeof(int) * nDstXSize );
+        return;
+    }
+
+    memcpy( padfX, padfX + nDstXSize, sizeof(double) * nDstXSize );
+    const double dfY = iDstY + 0.5 + poWK->nDstYOff;
+    for( int iDstX = 0; iDstX < nDstXSize; iDstX++ )
+        padfY[iDstX] = dfY;
+    memset( padfZ, 0, sizeof(double) * nDstXSize );
+
+    poWK->pfnTransformer( pTransformerArg, TRUE, nDstXSize,
+                          padfX, padfY, padfZ, pabSuccess );
+    if( dfSrcCoordPrecision > 0.0 )
+    {
+        GWKRoundSourceCoordinates(nDstXSize, padfX, padfY, padfZ, pabSuccess,
+                                  dfSrcCoordPrecision,
+                                  dfErrorThreshold,
+                                  poWK->pfnTransformer,
+                                  pTransformerArg,
+                                  0.5 + poWK->nDstXOff,
+                                  iDstY + 0.5 + poWK->nDstYOff);
+    }
+
+    if( psGrid != NULL )
+    {
+        // Each line is computed by a single thread, so no locking needed.
+        memcpy( psGrid->padfX + nGridOffset, padfX,
+                sizeof(double) * nDstXSize );
+        memcpy( psGrid->padfY + nGridOffset, padfY,
+                sizeof(double) * nDstXSize );
+        memcpy( psGrid->pabSuccess + nGridOffset, pabSuccess,
+                sizeof(int) * nDstXSize );
+        psGrid->pabyRowDone[iDstY] = TRUE;
+    }
+}
+
 /************************************************************************/
 /*                           GWKOpenCLCase()                            */
 /*                                                                      */
@@ -4559,31 +5117,13 @@ static void GWKGeneralCaseThread( void* pData)
     {
         int iDstX;
 
-/* -------------------------------------------------------------------- */
-/*      Setup points to transform to source image space.                */
-/* -------------------------------------------------------------------- */
-        memcpy( padfX, padfX + nDstXSize, sizeof(double) * nDstXSize );
-        const double dfY = iDstY + 0.5 + poWK->nDstYOff;
-        for( iDstX = 0; iDstX < nDstXSize; iDstX++ )
-            padfY[iDstX] = dfY;
-        memset( padfZ, 0, sizeof(double) * nDstXSize );
-
 /* -------------------------------------------------------------------- */
 /*      Transform the points from destination pixel/line coordinates    */
 /*      to source pixel/line coordinates.                               */
 /* -------------------------------------------------------------------- */
-        poWK->pfnTransformer( psJob->pTransformerArg, TRUE, nDstXSize,
-                              padfX, padfY, padfZ, pabSuccess );
-        if( dfSrcCoordPrecision > 0.0 )
-        {
-            GWKRoundSourceCoordinates(nDstXSize, padfX, padfY, padfZ, pabSuccess,
-                                      dfSrcCoordPrecision,
-                                      dfErrorThreshold,
-                                      poWK->pfnTransformer,
-                                      psJob->pTransformerArg,
-                                      0.5 + poWK->nDstXOff,
-                                      iDstY + 0.5 + poWK->nDstYOff);
-        }
+        GWKComputeSourceCoordinates( poWK, psJob->pTransformerArg, iDstY,
+                                     padfX, padfY, padfZ, pabSuccess,
+                                     dfSrcCoordPrecision, dfErrorThreshold );
 
 /* ==================================================================== */
 /*      Loop over pixels in output scanline.                            */
@@ -4784,31 +5324,13 @@ static void GWKRealCaseThread( void* pData)
     {
         int iDstX;
 
-/* -------------------------------------------------------------------- */
-/*      Setup points to transform to source image space.                */
-/* -------------------------------------------------------------------- */
-        memcpy( padfX, padfX + nDstXSize, sizeof(double) * nDstXSize );
-        const double dfY = iDstY + 0.5 + poWK->nDstYOff;
-        for( iDstX = 0; iDstX < nDstXSize; iDstX++ )
-            padfY[iDstX] = dfY;
-        memset( padfZ, 0, sizeof(double) * nDstXSize );
-
 /* -------------------------------------------------------------------- */
 /*      Transform the points from destination pixel/line coordinates    */
 /*      to source pixel/line coordinates.                               */
 /* -------------------------------------------------------------------- */
-        poWK->pfnTransformer( psJob->pTransformerArg, TRUE, nDstXSize,
-                              padfX, padfY, padfZ, pabSuccess );
-        if( dfSrcCoordPrecision > 0.0 )
-        {
-            GWKRoundSourceCoordinates(nDstXSize, padfX, padfY, padfZ, pabSuccess,
-                                      dfSrcCoordPrecision,
-                                      dfErrorThreshold,
-                                      poWK->pfnTransformer,
-                                      psJob->pTransformerArg,
-                                      0.5 + poWK->nDstXOff,
-                                      iDstY + 0.5 + poWK->nDstYOff);
-        }
+        GWKComputeSourceCoordinates( poWK, psJob->pTransformerArg, iDstY,
+                                     padfX, padfY, padfZ, pabSuccess,
+                                     dfSrcCoordPrecision, dfErrorThreshold );
 
 /* ==================================================================== */
 /*      Loop over pixels in output scanline.                            */
@@ -5009,8 +5531,8 @@ static void GWKResampleNoMasksOrDstDensityOnlyThreadInternal( void* pData )
     padfZ = (double *) CPLMalloc(sizeof(double) * nDstXSize);
     pabSuccess = (int *) CPLMalloc(sizeof(int) * nDstXSize);
 
-    int     nXRadius = poWK->nXRadius;
-    double  *padfWeight = (double *)CPLCalloc( 1 + nXRadius * 2, sizeof(double) );
+    GWKResampleNoMasksWeights sWeights;
+    GWKResampleNoMasksInitWeights( poWK, &sWeights );
     double dfSrcCoordPrecision = CPLAtof(
         CSLFetchNameValueDef(poWK->papszWarpOptions, "SRC_COORD_PRECISION", "0"));
     double dfErrorThreshold = CPLAtof(
@@ -5027,31 +5549,13 @@ static void GWKResampleNoMasksOrDstDensityOnlyThreadInternal( void* pData )
     {
         int iDstX;
 
-/* -------------------------------------------------------------------- */
-/*      Setup points to transform to source image space.                */
-/* -------------------------------------------------------------------- */
-        memcpy( padfX, padfX + nDstXSize, sizeof(double) * nDstXSize );
-        const double dfY = iDstY + 0.5 + poWK->nDstYOff;
-        for( iDstX = 0; iDstX < nDstXSize; iDstX++ )
-            padfY[iDstX] = dfY;
-        memset( padfZ, 0, sizeof(double) * nDstXSize );
-
 /* -------------------------------------------------------------------- */
 /*      Transform the points from destination pixel/line coordinates    */
 /*      to source pixel/line coordinates.                               */
 /* -------------------------------------------------------------------- */
-        poWK->pfnTransformer( psJob->pTransformerArg, TRUE, nDstXSize,
-                              padfX, padfY, padfZ, pabSuccess );
-        if( dfSrcCoordPrecision > 0.0 )
-        {
-            GWKRoundSourceCoordinates(nDstXSize, padfX, padfY, padfZ, pabSuccess,
-                                      dfSrcCoordPrecision,
-                                      dfErrorThreshold,
-                                      poWK->pfnTransformer,
-                                      psJob->pTransformerArg,
-                                      0.5 + poWK->nDstXOff,
-                                      iDstY + 0.5 + poWK->nDstYOff);
-        }
+        GWKComputeSourceCoordinates( poWK, psJob->pTransformerArg, iDstY,
+                                     padfX, padfY, padfZ, pabSuccess,
+                                     dfSrcCoordPrecision, dfErrorThreshold );
 
 /* ==================================================================== */
 /*      Loop over pixels in output scanline.                            */
@@ -5096,7 +5600,7 @@ static void GWKResampleNoMasksOrDstDensityOnlyThreadInternal( void* pData )
                                     padfX[iDstX]-poWK->nSrcXOff,
                                     padfY[iDstX]-poWK->nSrcYOff,
                                     &value,
-                                    padfWeight);
+                                    &sWeights);
                 ((T *)poWK->papabyDstImage[iBand])[iDstOffset] = value;
             }
 
@@ -5118,7 +5622,7 @@ static void GWKResampleNoMasksOrDstDensityOnlyThreadInternal( void* pData )
     CPLFree( padfY );
     CPLFree( padfZ );
     CPLFree( pabSuccess );
-    CPLFree( padfWeight );
+    GWKResampleNoMasksFreeWeights( &sWeights );
 }
 
 template<class T,GDALResampleAlg eResample>
@@ -5231,31 +5735,13 @@ static void GWKNearestThread( void* pData )
     {
         int iDstX;
 
-/* -------------------------------------------------------------------- */
-/*      Setup points to transform to source image space.                */
-/* -------------------------------------------------------------------- */
-        memcpy( padfX, padfX + nDstXSize, sizeof(double) * nDstXSize );
-        const double dfY = iDstY + 0.5 + poWK->nDstYOff;
-        for( iDstX = 0; iDstX < nDstXSize; iDstX++ )
-            padfY[iDstX] = dfY;
-        memset( padfZ, 0, sizeof(double) * nDstXSize );
-
 /* -------------------------------------------------------------------- */
 /*      Transform the points from destination pixel/line coordinates    */
 /*      to source pixel/line coordinates.                               */
 /* -------------------------------------------------------------------- */
-        poWK->pfnTransformer( psJob->pTransformerArg, TRUE, nDstXSize,
-                              padfX, padfY, padfZ, pabSuccess );
-        if( dfSrcCoordPrecision > 0.0 )
-        {
-            GWKRoundSourceCoordinates(nDstXSize, padfX, padfY, padfZ, pabSuccess,
-                                      dfSrcCoordPrecision,
-                                      dfErrorThreshold,
-                                      poWK->pfnTransformer,
-                                      psJob->pTransformerArg,
-                                      0.5 + poWK->nDstXOff,
-                                      iDstY + 0.5 + poWK->nDstYOff);
-        }
+        GWKComputeSourceCoordinates( poWK, psJob->pTransformerArg, iDstY,
+                                     padfX, padfY, padfZ, pabSuccess,
+                                     dfSrcCoordPrecision, dfErrorThreshold );
 /* ==================================================================== */
 /*      Loop over pixels in output scanline.                            */
 /* ==================================================================== */
@@ -5441,6 +5927,423 @@ static CPLErr GWKAverageOrMode( GDALWarpKernel *poWK )
     return GWKRun( poWK, "GWKAverageOrMode", GWKAverageOrModeThread );
 }
 
+/************************************************************************/
+/*                       GWKAOMIsValidSource()                          */
+/************************************************************************/
+
+/* Same test as GWKGetPixelValue() followed by the BAND_DENSITY_THRESHOLD */
+/* check of GWKAverageOrModeThread(), without fetching the value. */
+
+static CPL_INLINE bool GWKAOMIsValidSource( const GDALWarpKernel *poWK,
+                                            const GUInt32 *panBandSrcValid,
+                                            int iSrcOffset )
+{
+    if( poWK->panUnifiedSrcValid != NULL
+        && !(poWK->panUnifiedSrcValid[iSrcOffset>>5]
+             & (0x01 << (iSrcOffset & 0x1f))) )
+        return false;
+
+    if( panBandSrcValid != NULL
+        && !(panBandSrcValid[iSrcOffset>>5] & (0x01 << (iSrcOffset & 0x1f))) )
+        return false;
+
+    if( poWK->pafUnifiedSrcDensity != NULL
+        && !(poWK->pafUnifiedSrcDensity[iSrcOffset] > BAND_DENSITY_THRESHOLD) )
+        return false;
+
+    return true;
+}
+
+/************************************************************************/
+/*                           GWKModeCounter                             */
+/************************************************************************/
+
+/* Occurrence counter of the mode resampling. Byte, UInt16, Int16 and */
+/* CInt16 values are counted in an array of 65536 (256 for Byte) bins, */
+/* other values in a small open-addressing hash table keyed by the value. */
+/* Entries carry the generation at which they were last set, so that */
+/* Reset() is O(1) and the same buffers are reused for all the destination */
+/* pixels processed by a thread. */
+/* The mode is the value whose count first reaches the highest count. */
+
+class GWKModeCounter
+{
+    typedef struct
+    {
+        GUInt32 nCount;
+        GUInt32 nGeneration;
+    } Bin;
+
+    typedef struct
+    {
+        double  dfValue;
+        GUInt32 nCount;
+        GUInt32 nGeneration;
+    } Entry;
+
+    Bin     *pasBins;
+    int      nBins;
+    int      nBinsOffset;
+
+    Entry   *pasEntries;
+    int      nEntriesLog2;
+    int      nEntriesUsed;
+
+    GUInt32  nGeneration;
+    GUInt32  nMaxCount;
+    int      iModeBin;
+    double   dfMode;
+    bool     bError;
+
+    static CPL_INLINE GUInt32 Hash( double dfValue, int nLog2 )
+    {
+        GUIntBig nBits;
+        memcpy(&nBits, &dfValue, sizeof(nBits));
+        // Fibonacci hashing: the multiplication mixes all the bits of the
+        // value into the top ones.
+        nBits *= (static_cast<GUIntBig>(0x9E3779B9U) << 32) | 0x7F4A7C15U;
+        return static_cast<GUInt32>(nBits >> (64 - nLog2));
+    }
+
+    void InsertNewEntry( double dfValue, GUInt32 nCount );
+    bool GrowEntries();
+
+    CPL_DISALLOW_COPY_ASSIGN(GWKModeCounter)
+
+    CPL_INLINE void AddBin( int iBin )
+    {
+        Bin* psBin = pasBins + iBin;
+        if( psBin->nGeneration != nGeneration )
+        {
+            psBin->nGeneration = nGeneration;
+            psBin->nCount = 0;
+        }
+        if( ++psBin->nCount > nMaxCount )
+        {
+            nMaxCount = psBin->nCount;
+            iModeBin = iBin;
+        }
+    }
+
+    void AddToHash( double dfValue )
+    {
+        // Turn -0.0 into 0.0 so that both share the same entry, as they
+        // compare equal.
+        dfValue += 0.0;
+
+        const GUInt32 nMask = (1U << nEntriesLog2) - 1;
+        GUInt32 i = Hash(dfValue, nEntriesLog2);
+        while( true )
+        {
+            Entry* psEntry = pasEntries + i;
+            if( psEntry->nGeneration != nGeneration )
+                break;
+            if( memcmp(&psEntry->dfValue, &dfValue, sizeof(double)) == 0 )
+            {
+                if( ++psEntry->nCount > nMaxCount )
+                {
+                    nMaxCount = psEntry->nCount;
+                    dfMode = dfValue;
+                }
+                return;
+            }
+            i = (i + 1) & nMask;
+        }
+
+        if( 2 * (nEntriesUsed + 1) > (1 << nEntriesLog2) )
+        {
+            if( !GrowEntries() )
+            {
+                bError = true;
+                return;
+            }
+            InsertNewEntry(dfValue, 1);
+        }
+        else
+        {
+            pasEntries[i].dfValue = dfValue;
+            pasEntries[i].nCount = 1;
+            pasEntries[i].nGeneration = nGeneration;
+            nEntriesUsed ++;
+        }
+        if( nMaxCount == 0 )
+        {
+            nMaxCount = 1;
+            dfMode = dfValue;
+        }
+    }
+
+  public:
+    GWKModeCounter() : pasBins(NULL), nBins(0), nBinsOffset(0),
+                       pasEntries(NULL), nEntriesLog2(0), nEntriesUsed(0),
+                       nGeneration(1), nMaxCount(0), iModeBin(0), dfMode(0.0),
+                       bError(false) {}
+    ~GWKModeCounter() { VSIFree(pasBins); VSIFree(pasEntries); }
+
+    bool Init( GDALDataType eWorkingDataType );
+
+    CPL_INLINE void Reset()
+    {
+        nMaxCount = 0;
+        nEntriesUsed = 0;
+        if( ++nGeneration == 0 )
+        {
+            // Wrap around: forget about all the previous generations.
+            if( pasBins != NULL )
+                memset(pasBins, 0, nBins * sizeof(Bin));
+            if( pasEntries != NULL )
+                memset(pasEntries, 0, (static_cast<size_t>(1) << nEntriesLog2) *
+                                                            sizeof(Entry));
+            nGeneration = 1;
+        }
+    }
+
+    CPL_INLINE void Add( GByte nValue ) { AddBin(nValue); }
+    CPL_INLINE void Add( GUInt16 nValue ) { AddBin(nValue); }
+    CPL_INLINE void Add( GInt16 nValue ) { AddBin(nValue + nBinsOffset); }
+    CPL_INLINE void Add( GInt32 nValue ) { AddToHash(nValue); }
+    CPL_INLINE void Add( GUInt32 nValue ) { AddToHash(nValue); }
+    CPL_INLINE void Add( float fValue ) { AddToHash(fValue); }
+    CPL_INLINE void Add( double dfValue ) { AddToHash(dfValue); }
+
+    // Whether a value could not be counted, which has been reported with
+    // CPLError().
+    bool HasFailed() const { return bError; }
+
+    bool GetMode( double* pdfValue ) const
+    {
+        if( nMaxCount == 0 )
+            return false;
+        if( pasBins != NULL )
+            *pdfValue = iModeBin - nBinsOffset;
+        else
+            *pdfValue = dfMode;
+        return true;
+    }
+};
+
+/************************************************************************/
+/*                        GWKModeCounter::Init()                        */
+/************************************************************************/
+
+bool GWKModeCounter::Init( GDALDataType eWorkingDataType )
+{
+    if( eWorkingDataType == GDT_Byte ||
+        eWorkingDataType == GDT_UInt16 ||
+        eWorkingDataType == GDT_Int16 ||
+        eWorkingDataType == GDT_CInt16 )
+    {
+        nBins = (eWorkingDataType == GDT_Byte) ? 256 : 65536;
+        nBinsOffset = (eWorkingDataType == GDT_Int16 ||
+                       eWorkingDataType == GDT_CInt16) ? 32768 : 0;
+        pasBins = static_cast<Bin*>(VSI_CALLOC_VERBOSE(nBins, sizeof(Bin)));
+        return pasBins != NULL;
+    }
+
+    nEntriesLog2 = 6;
+    pasEntries = static_cast<Entry*>(
+        VSI_CALLOC_VERBOSE(static_cast<size_t>(1) << nEntriesLog2, sizeof(Entry)));
+    return pasEntries != NULL;
+}
+
+/************************************************************************/
+/*                   GWKModeCounter::InsertNewEntry()                   */
+/************************************************************************/
+
+/* dfValue must not be already present in the table, which must have a free */
+/* slot. */
+
+void GWKModeCounter::InsertNewEntry( double dfValue, GUInt32 nCount )
+{
+    const GUInt32 nMask = (1U << nEntriesLog2) - 1;
+    GUInt32 i = Hash(dfValue, nEntriesLog2);
+    while( pasEntries[i].nGeneration == nGeneration )
+        i = (i + 1) & nMask;
+    pasEntries[i].dfValue = dfValue;
+    pasEntries[i].nCount = nCount;
+    pasEntries[i].nGeneration = nGeneration;
+    nEntriesUsed ++;
+}
+
+/************************************************************************/
+/*                    GWKModeCounter::GrowEntries()                     */
+/************************************************************************/
+
+bool GWKModeCounter::GrowEntries()
+{
+    if( nEntriesLog2 == 30 )
+    {
+        CPLError(CE_Failure, CPLE_OutOfMemory,
+                 "Too many distinct values for mode resampling");
+        return false;
+    }
+
+    Entry* pasNewEntries = static_cast<Entry*>(
+        VSI_CALLOC_VERBOSE(static_cast<size_t>(1) << (nEntriesLog2 + 1),
+                           sizeof(Entry)));
+    if( pasNewEntries == NULL )
+        return false;
+
+    Entry* pasOldEntries = pasEntries;
+    const int nOldEntries = 1 << nEntriesLog2;
+    pasEntries = pasNewEntries;
+    nEntriesLog2 ++;
+    nEntriesUsed = 0;
+
+    // The new table starts at generation 0, so it must be restarted at 1
+    // to keep the current entries apart from the zeroed slots.
+    const GUInt32 nOldGeneration = nGeneration;
+    nGeneration = 1;
+    for( int i = 0; i < nOldEntries; i++ )
+    {
+        if( pasOldEntries[i].nGeneration == nOldGeneration )
+            InsertNewEntry(pasOldEntries[i].dfValue, pasOldEntries[i].nCount);
+    }
+    VSIFree(pasOldEntries);
+    return true;
+}
+
+/************************************************************************/
+/*                           GWKAverageT()                              */
+/************************************************************************/
+
+/* Average of the real part of the valid source pixels of the */
+/* [iSrcXMin,iSrcXMax[x[iSrcYMin,iSrcYMax[ window, accumulated in the same */
+/* order as the generic code did. nStride is 2 for complex data types. */
+
+template<class T, int nStride>
+static bool GWKAverageT( const GDALWarpKernel *poWK, int iBand,
+                         int iSrcXMin, int iSrcXMax,
+                         int iSrcYMin, int iSrcYMax,
+                         GWKModeCounter& /* oCounter */,
+                         double *pdfValue )
+{
+    const int nSrcXSize = poWK->nSrcXSize;
+    const T* pSrc = reinterpret_cast<const T*>(poWK->papabySrcImage[iBand]);
+    const GUInt32* panBandSrcValid = (poWK->papanBandSrcValid != NULL) ?
+                                        poWK->papanBandSrcValid[iBand] : NULL;
+    const bool bCheckValidity = poWK->panUnifiedSrcValid != NULL ||
+                                panBandSrcValid != NULL ||
+                                poWK->pafUnifiedSrcDensity != NULL;
+
+    double dfTotal = 0.0;
+    int nCount = 0;
+    for( int iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
+    {
+        const int iSrcOffsetStart = iSrcXMin + iSrcY * nSrcXSize;
+        const int iSrcOffsetEnd = iSrcXMax + iSrcY * nSrcXSize;
+        if( !bCheckValidity )
+        {
+            for( int iSrcOffset = iSrcOffsetStart;
+                 iSrcOffset < iSrcOffsetEnd; iSrcOffset++ )
+            {
+                dfTotal += pSrc[iSrcOffset * nStride];
+            }
+            nCount += iSrcOffsetEnd - iSrcOffsetStart;
+        }
+        else
+        {
+            for( int iSrcOffset = iSrcOffsetStart;
+                 iSrcOffset < iSrcOffsetEnd; iSrcOffset++ )
+            {
+                if( GWKAOMIsValidSource(poWK, panBandSrcValid, iSrcOffset) )
+                {
+                    dfTotal += pSrc[iSrcOffset * nStride];
+                    nCount ++;
+                }
+            }
+        }
+    }
+
+    if( nCount == 0 )
+        return false;
+    *pdfValue = dfTotal / nCount;
+    return true;
+}
+
+/************************************************************************/
+/*                             GWKModeT()                               */
+/************************************************************************/
+
+/* Most frequent value of the real part of the valid source pixels of the */
+/* [iSrcXMin,iSrcXMax[x[iSrcYMin,iSrcYMax[ window. */
+
+template<class T, int nStride>
+static bool GWKModeT( const GDALWarpKernel *poWK, int iBand,
+                      int iSrcXMin, int iSrcXMax,
+                      int iSrcYMin, int iSrcYMax,
+                      GWKModeCounter& oCounter,
+                      double *pdfValue )
+{
+    const int nSrcXSize = poWK->nSrcXSize;
+    const T* pSrc = reinterpret_cast<const T*>(poWK->papabySrcImage[iBand]);
+    const GUInt32* panBandSrcValid = (poWK->papanBandSrcValid != NULL) ?
+                                        poWK->papanBandSrcValid[iBand] : NULL;
+    const bool bCheckValidity = poWK->panUnifiedSrcValid != NULL ||
+                                panBandSrcValid != NULL ||
+                                poWK->pafUnifiedSrcDensity != NULL;
+
+    oCounter.Reset();
+    for( int iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
+    {
+        const int iSrcOffsetStart = iSrcXMin + iSrcY * nSrcXSize;
+        const int iSrcOffsetEnd = iSrcXMax + iSrcY * nSrcXSize;
+        for( int iSrcOffset = iSrcOffsetStart;
+             iSrcOffset < iSrcOffsetEnd; iSrcOffset++ )
+        {
+            if( !bCheckValidity ||
+                GWKAOMIsValidSource(poWK, panBandSrcValid, iSrcOffset) )
+            {
+                oCounter.Add(pSrc[iSrcOffset * nStride]);
+            }
+        }
+    }
+
+    return oCounter.GetMode(pdfValue);
+}
+
+typedef bool (*GWKAOMFunc)( const GDALWarpKernel *poWK, int iBand,
+                            int iSrcXMin, int iSrcXMax,
+                            int iSrcYMin, int iSrcYMax,
+                            GWKModeCounter& oCounter,
+                            double *pdfValue );
+
+/************************************************************************/
+/*                        GWKGetAverageOrModeFunc()                     */
+/************************************************************************/
+
+template<class T, int nStride>
+static GWKAOMFunc GWKGetAverageOrModeFunc( bool bMode )
+{
+    if( bMode )
+        return GWKModeT<T, nStride>;
+    return GWKAverageT<T, nStride>;
+}
+
+static GWKAOMFunc GWKGetAverageOrModeFunc( GDALDataType eWorkingDataType,
+                                           bool bMode )
+{
+    switch( eWorkingDataType )
+    {
+      case GDT_Byte:     return GWKGetAverageOrModeFunc<GByte, 1>(bMode);
+      case GDT_UInt16:   return GWKGetAverageOrModeFunc<GUInt16, 1>(bMode);
+      case GDT_Int16:    return GWKGetAverageOrModeFunc<GInt16, 1>(bMode);
+      case GDT_UInt32:   return GWKGetAverageOrModeFunc<GUInt32, 1>(bMode);
+      case GDT_Int32:    return GWKGetAverageOrModeFunc<GInt32, 1>(bMode);
+      case GDT_Float32:  return GWKGetAverageOrModeFunc<float, 1>(bMode);
+      case GDT_Float64:  return GWKGetAverageOrModeFunc<double, 1>(bMode);
+      case GDT_CInt16:   return GWKGetAverageOrModeFunc<GInt16, 2>(bMode);
+      case GDT_CInt32:   return GWKGetAverageOrModeFunc<GInt32, 2>(bMode);
+      case GDT_CFloat32: return GWKGetAverageOrModeFunc<float, 2>(bMode);
+      case GDT_CFloat64: return GWKGetAverageOrModeFunc<double, 2>(bMode);
+      default:           return NULL;
+    }
+}
+
+/************************************************************************/
+/*                       GWKAverageOrModeThread()                       */
+/************************************************************************/
+
 // overall logic based on GWKGeneralCaseThread()
 static void GWKAverageOrModeThread( void* pData)
 {
@@ -5459,15 +6362,6 @@ static void GWKAverageOrModeThread( void* pData)
 /* -------------------------------------------------------------------- */
     int nAlgo = 0;
 
-    // these vars only used with nAlgo == 3
-    int *panVals = NULL;
-    int nBins = 0;
-    int nBinsOffset = 0;
-
-    // only used with nAlgo = 2
-    float*   pafVals = NULL;
-    int*     panSums = NULL;
-
     // only used with nAlgo = 6
     float quant = 0.5;
 
@@ -5483,43 +6377,10 @@ static void GWKAverageOrModeThread( void* pData)
              poWK->eWorkingDataType == GDT_Int16 )
         {
             nAlgo = GWKAOM_Imode;
-
-            /* In the case of a paletted or non-paletted byte band, */
-            /* input values are between 0 and 255 */
-            if ( poWK->eWorkingDataType == GDT_Byte )
-            {
-                nBins = 256;
-            }
-            /* In the case of Int16, input values are between -32768 and 32767 */
-            else if ( poWK->eWorkingDataType == GDT_Int16 )
-            {
-                nBins = 65536;
-                nBinsOffset = 32768;
-            }
-            /* In the case of UInt16, input values are between 0 and 65537 */
-            else if ( poWK->eWorkingDataType == GDT_UInt16 )
-            {
-                nBins = 65536;
-            }
-            panVals = (int*) VSI_MALLOC_VERBOSE(nBins * sizeof(int));
-            if( panVals == NULL )
-                return;
         }
         else
         {
             nAlgo = GWKAOM_Fmode;
-
-            if ( nSrcXSize > 0 && nSrcYSize > 0 )
-            {
-                pafVals = (float*) VSI_MALLOC3_VERBOSE(nSrcXSize, nSrcYSize, sizeof(float));
-                panSums = (int*) VSI_MALLOC3_VERBOSE(nSrcXSize, nSrcYSize, sizeof(int));
-                if( pafVals == NULL || panSums == NULL )
-                {
-                    VSIFree(pafVals);
-                    VSIFree(panSums);
-                    return;
-                }
-            }
         }
     }
     else if( poWK->eResample == GRA_Max )
@@ -5553,6 +6414,32 @@ static void GWKAverageOrModeThread( void* pData)
     }
     CPLDebug( "GDAL", "GDALWarpKernel():GWKAverageOrModeThread() using algo %d", nAlgo );
 
+/* -------------------------------------------------------------------- */
+/*      Average and mode are computed by type specialized functions,    */
+/*      the mode ones sharing the counter scratch buffers of the        */
+/*      thread.                                                         */
+/* -------------------------------------------------------------------- */
+    GWKAOMFunc pfnAverageOrMode = NULL;
+    GWKModeCounter oModeCounter;
+    if( nAlgo == GWKAOM_Average || nAlgo == GWKAOM_Imode ||
+        nAlgo == GWKAOM_Fmode )
+    {
+        pfnAverageOrMode = GWKGetAverageOrModeFunc(poWK->eWorkingDataType,
+                                                   nAlgo != GWKAOM_Average);
+        if( pfnAverageOrMode == NULL )
+            return;
+        if( nAlgo != GWKAOM_Average &&
+            !oModeCounter.Init(poWK->eWorkingDataType) )
+        {
+            GWKJobFailed(psJob);
+            return;
+        }
+    }
+    bool bFailed = false;
+
+    // Only used with nAlgo = 6. Reused from one pixel to the other.
+    std::vector<double> dfValuesTmp;
+
 /* -------------------------------------------------------------------- */
 /*      Allocate x,y,z coordinate arrays for transformation ... two     */
 /*      scanlines worth of positions.                                   */
@@ -5652,7 +6539,6 @@ static void GWKAverageOrModeThread( void* pData)
 
                 double dfTotal = 0;
                 int    nCount = 0;  // count of pixels used to compute average/mode
-                int    nCount2 = 0; // count of all pixels sampled, including nodata
 
                 // Compute corners in source crs.
                 int iSrcXMin =
@@ -5691,149 +6577,22 @@ static void GWKAverageOrModeThread( void* pData)
 
                 // loop over source lines and pixels - 3 possible algorithms
 
-                if ( nAlgo == GWKAOM_Average ) // poWK->eResample == GRA_Average
+                if ( pfnAverageOrMode != NULL ) // GRA_Average or GRA_Mode
                 {
-                    // this code adapted from GDALDownsampleChunk32R_AverageT() in gcore/overview.cpp
-                    for( iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
+                    if( pfnAverageOrMode( poWK, iBand,
+                                          iSrcXMin, iSrcXMax,
+                                          iSrcYMin, iSrcYMax,
+                                          oModeCounter, &dfValueReal ) )
                     {
-                        for( iSrcX = iSrcXMin; iSrcX < iSrcXMax; iSrcX++ )
-                        {
-                            iSrcOffset = iSrcX + iSrcY * nSrcXSize;
-
-                            if( poWK->panUnifiedSrcValid != NULL
-                                && !(poWK->panUnifiedSrcValid[iSrcOffset>>5]
-                                     & (0x01 << (iSrcOffset & 0x1f))) )
-                            {
-                                continue;
-                            }
-
-                            nCount2++;
-                            if ( GWKGetPixelValue( poWK, iBand, iSrcOffset,
-                                                   &dfBandDensity, &dfValueRealTmp, &dfValueImagTmp ) && dfBandDensity > BAND_DENSITY_THRESHOLD )
-                            {
-                                nCount++;
-                                dfTotal += dfValueRealTmp;
-                            }
-                        }
-                    }
-
-                    if ( nCount > 0 )
-                    {
-                        dfValueReal = dfTotal / nCount;
                         dfBandDensity = 1;
                         bHasFoundDensity = true;
                     }
-                } // GRA_Average
-
-                else if ( nAlgo == GWKAOM_Imode || nAlgo == GWKAOM_Fmode ) // poWK->eResample == GRA_Mode
-                {
-                    // this code adapted from GDALDownsampleChunk32R_Mode() in gcore/overview.cpp
-
-                    if ( nAlgo == GWKAOM_Fmode ) // int32 or float
-                    {
-                        /* I'm not sure how much sense it makes to run a
-                           majority filter on floating point data, but here it
-                           is for the sake of compatibility. It won't look
-                           right on RGB images by the nature of the filter. */
-                        int iMaxInd = 0;
-                        int iMaxVal = -1;
-                        int i = 0;
-
-                        for( iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
-                        {
-                            for( iSrcX = iSrcXMin; iSrcX < iSrcXMax; iSrcX++ )
-                            {
-                                iSrcOffset = iSrcX + iSrcY * nSrcXSize;
-
-                                if( poWK->panUnifiedSrcValid != NULL
-                                    && !(poWK->panUnifiedSrcValid[iSrcOffset>>5]
-                                         & (0x01 << (iSrcOffset & 0x1f))) )
-                                    continue;
-
-                                nCount2++;
-                                if ( GWKGetPixelValue( poWK, iBand, iSrcOffset,
-                                                       &dfBandDensity, &dfValueRealTmp, &dfValueImagTmp ) && dfBandDensity > BAND_DENSITY_THRESHOLD )
-                                {
-                                    nCount++;
-
-                                    float fVal = (float)dfValueRealTmp;
-
-                                    //Check array for existing entry
-                                    for( i = 0; i < iMaxInd; ++i )
-                                        if( pafVals[i] == fVal
-                                            && ++panSums[i] > panSums[iMaxVal] )
-                                        {
-                                            iMaxVal = i;
-                                            break;
-                                        }
-
-                                    //Add to arr if entry not already there
-                                    if( i == iMaxInd )
-                                    {
-                                        pafVals[iMaxInd] = fVal;
-                                        panSums[iMaxInd] = 1;
-
-                                        if( iMaxVal < 0 )
-                                            iMaxVal = iMaxInd;
-
-                                        ++iMaxInd;
-                                    }
-                                }
-                            }
-                        }
-
-                        if( iMaxVal != -1 )
-                        {
-                            dfValueReal = pafVals[iMaxVal];
-                            dfBandDensity = 1;
-                            bHasFoundDensity = true;
-                        }
-                    }
-
-                    else // byte or int16
+                    else if( oModeCounter.HasFailed() )
                     {
-                        int nMaxVal = 0;
-                        int iMaxInd = -1;
-
-                        memset(panVals, 0, nBins*sizeof(int));
-
-                        for( iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
-                        {
-                            for( iSrcX = iSrcXMin; iSrcX < iSrcXMax; iSrcX++ )
-                            {
-                                iSrcOffset = iSrcX + iSrcY * nSrcXSize;
-
-                                if( poWK->panUnifiedSrcValid != NULL
-                                    && !(poWK->panUnifiedSrcValid[iSrcOffset>>5]
-                                         & (0x01 << (iSrcOffset & 0x1f))) )
-                                    continue;
-
-                                nCount2++;
-                                if ( GWKGetPixelValue( poWK, iBand, iSrcOffset,
-                                                       &dfBandDensity, &dfValueRealTmp, &dfValueImagTmp ) && dfBandDensity > BAND_DENSITY_THRESHOLD )
-                                {
-                                    nCount++;
-
-                                    int nVal = (int) dfValueRealTmp;
-                                    if ( ++panVals[nVal+nBinsOffset] > nMaxVal)
-                                    {
-                                        //Sum the density
-                                        //Is it the most common value so far?
-                                        iMaxInd = nVal;
-                                        nMaxVal = panVals[nVal+nBinsOffset];
-                                    }
-                                }
-                            }
-                        }
-
-                        if( iMaxInd != -1 )
-                        {
-                            dfValueReal = (float)iMaxInd;
-                            dfBandDensity = 1;
-                            bHasFoundDensity = true;
-                        }
+                        bFailed = true;
+                        break;
                     }
-                } // GRA_Mode
+                } // GRA_Average or GRA_Mode
                 else if ( nAlgo == GWKAOM_Max ) // poWK->eResample == GRA_Max
                 {
                     dfTotal = -DBL_MAX;
@@ -5910,7 +6669,7 @@ static void GWKAverageOrModeThread( void* pData)
                 } // GRA_Min
                 else if ( nAlgo == GWKAOM_Quant ) // poWK->eResample == GRA_Med | GRA_Q1 | GRA_Q3
                 {
-                    std::vector<double> dfValuesTmp;
+                    dfValuesTmp.resize(0);
 
                     // this code adapted from nAlgo 1 method, GRA_Average
                     for( iSrcY = iSrcYMin; iSrcY < iSrcYMax; iSrcY++ )
@@ -5944,7 +6703,6 @@ static void GWKAverageOrModeThread( void* pData)
 
                         dfBandDensity = 1;
                         bHasFoundDensity = true;
-                        dfValuesTmp.clear();
                     }
                 } // Quantile
 
@@ -5965,6 +6723,9 @@ static void GWKAverageOrModeThread( void* pData)
                 }
             }
 
+            if( bFailed )
+                break;
+
             if (!bHasFoundDensity)
                 continue;
 
@@ -5980,6 +6741,12 @@ static void GWKAverageOrModeThread( void* pData)
             }
         } /* Next iDstX */
 
+        if( bFailed )
+        {
+            GWKJobFailed(psJob);
+            break;
+        }
+
 /* -------------------------------------------------------------------- */
 /*      Report progress to the user, and optionally cancel out.         */
 /* -------------------------------------------------------------------- */
@@ -5998,7 +6765,4 @@ static void GWKAverageOrModeThread( void* pData)
     CPLFree( padfZ2 );
     CPLFree( pabSuccess );
     CPLFree( pabSuccess2 );
-    VSIFree( panVals );
-    VSIFree(pafVals);
-    VSIFree(panSums);
 }
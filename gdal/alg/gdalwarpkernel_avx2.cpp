@@ -0,0 +1,316 @@
+/******************************************************************************
+ *
+ * Project:  High Performance Image Reprojector
+ * Purpose:  AVX2 specializations of the convolution kernels of the warper
+ * Author:   Even Rouault <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+
+CPL_CVSID("$Id$");
+
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && ( defined(__x86_64) || defined(_M_X64) )
+
+#include <immintrin.h>
+
+// The kernels below compute the weighted sums of nCols consecutive source
+// pixels, for 4 consecutive source rows (separated by nSrcXSize pixels),
+// with the weights of padfWeights, and store them in padfRowAcc[].
+//
+// The NoMasks4Rows variants use the same summation order as
+// GWKResampleNoMasks_SSE2_T(), and the Lanczos4Rows variants the same
+// summation order as GWKResampleOptimizedLanczos() (that is sequential
+// within each row), so that they give exactly the same results as the
+// non-AVX2 code.
+
+void GWKResampleNoMasks4Rows_Byte_AVX2( const GByte* pSrc, int nSrcXSize,
+                                        int nCols, const double* padfWeights,
+                                        double* padfRowAcc );
+void GWKResampleNoMasks4Rows_Int16_AVX2( const GInt16* pSrc, int nSrcXSize,
+                                         int nCols, const double* padfWeights,
+                                         double* padfRowAcc );
+void GWKResampleNoMasks4Rows_UInt16_AVX2( const GUInt16* pSrc, int nSrcXSize,
+                                          int nCols,
+                                          const double* padfWeights,
+                                          double* padfRowAcc );
+void GWKResampleNoMasks4Rows_Float_AVX2( const float* pSrc, int nSrcXSize,
+                                         int nCols, const double* padfWeights,
+                                         double* padfRowAcc );
+void GWKLanczos4Rows_Byte_AVX2( const GByte* pSrc, int nSrcXSize,
+                                int nCols, const double* padfWeights,
+                                double* padfRowAcc );
+void GWKLanczos4Rows_Int16_AVX2( const GInt16* pSrc, int nSrcXSize,
+                                 int nCols, const double* padfWeights,
+                                 double* padfRowAcc );
+void GWKLanczos4Rows_UInt16_AVX2( const GUInt16* pSrc, int nSrcXSize,
+                                  int nCols, const double* padfWeights,
+                                  double* padfRowAcc );
+void GWKLanczos4Rows_Float_AVX2( const float* pSrc, int nSrcXSize,
+                                 int nCols, const double* padfWeights,
+                                 double* padfRowAcc );
+
+/************************************************************************/
+/*                            GWKLoad4Val()                             */
+/************************************************************************/
+
+static inline __m256d GWKLoad4Val( const GByte* ptr )
+{
+    GInt32 n;
+    memcpy(&n, ptr, sizeof(n));
+    return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(n)));
+}
+
+static inline __m256d GWKLoad4Val( const GInt16* ptr )
+{
+    return _mm256_cvtepi32_pd(_mm_cvtepi16_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr))));
+}
+
+static inline __m256d GWKLoad4Val( const GUInt16* ptr )
+{
+    return _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr))));
+}
+
+static inline __m256d GWKLoad4Val( const float* ptr )
+{
+    return _mm256_cvtps_pd(_mm_loadu_ps(ptr));
+}
+
+static inline __m128d GWKLoad2Val( const GByte* ptr )
+{
+    return _mm_set_pd(ptr[1], ptr[0]);
+}
+
+static inline __m128d GWKLoad2Val( const GInt16* ptr )
+{
+    return _mm_set_pd(ptr[1], ptr[0]);
+}
+
+static inline __m128d GWKLoad2Val( const GUInt16* ptr )
+{
+    return _mm_set_pd(ptr[1], ptr[0]);
+}
+
+static inline __m128d GWKLoad2Val( const float* ptr )
+{
+    return _mm_set_pd(ptr[1], ptr[0]);
+}
+
+/************************************************************************/
+/*                       GWKAddLowAndHigh()                             */
+/************************************************************************/
+
+// Same as XMMReg4Double::AddLowAndHigh() followed by GetLow(), the low
+// 128 bits being given separately since they might have received the
+// contribution of 2 extra pixels.
+static inline double GWKAddLowAndHigh( __m128d xmm_low, __m256d ymm )
+{
+    __m128d xmm = _mm_add_pd(xmm_low, _mm256_extractf128_pd(ymm, 1));
+    xmm = _mm_add_pd(xmm, _mm_shuffle_pd(xmm, xmm, _MM_SHUFFLE2(0,1)));
+    return _mm_cvtsd_f64(xmm);
+}
+
+/************************************************************************/
+/*                    GWKResampleNoMasks4Rows_AVX2()                    */
+/************************************************************************/
+
+template<class T>
+static void GWKResampleNoMasks4Rows_AVX2( const T* pSrc, int nSrcXSize,
+                                          int nCols, const double* padfWeights,
+                                          double* padfRowAcc )
+{
+    __m256d ymm_acc_1 = _mm256_setzero_pd();
+    __m256d ymm_acc_2 = _mm256_setzero_pd();
+    __m256d ymm_acc_3 = _mm256_setzero_pd();
+    __m256d ymm_acc_4 = _mm256_setzero_pd();
+    int i = 0;
+    for( ; i + 3 < nCols; i += 4 )
+    {
+        const __m256d ymm_weight = _mm256_loadu_pd(padfWeights + i);
+        ymm_acc_1 = _mm256_add_pd(ymm_acc_1,
+            _mm256_mul_pd(GWKLoad4Val(pSrc + i), ymm_weight));
+        ymm_acc_2 = _mm256_add_pd(ymm_acc_2,
+            _mm256_mul_pd(GWKLoad4Val(pSrc + i + nSrcXSize), ymm_weight));
+        ymm_acc_3 = _mm256_add_pd(ymm_acc_3,
+            _mm256_mul_pd(GWKLoad4Val(pSrc + i + 2 * nSrcXSize), ymm_weight));
+        ymm_acc_4 = _mm256_add_pd(ymm_acc_4,
+            _mm256_mul_pd(GWKLoad4Val(pSrc + i + 3 * nSrcXSize), ymm_weight));
+    }
+
+    __m128d xmm_acc_1 = _mm256_castpd256_pd128(ymm_acc_1);
+    __m128d xmm_acc_2 = _mm256_castpd256_pd128(ymm_acc_2);
+    __m128d xmm_acc_3 = _mm256_castpd256_pd128(ymm_acc_3);
+    __m128d xmm_acc_4 = _mm256_castpd256_pd128(ymm_acc_4);
+    if( i + 1 < nCols )
+    {
+        const __m128d xmm_weight = _mm_loadu_pd(padfWeights + i);
+        xmm_acc_1 = _mm_add_pd(xmm_acc_1,
+            _mm_mul_pd(GWKLoad2Val(pSrc + i), xmm_weight));
+        xmm_acc_2 = _mm_add_pd(xmm_acc_2,
+            _mm_mul_pd(GWKLoad2Val(pSrc + i + nSrcXSize), xmm_weight));
+        xmm_acc_3 = _mm_add_pd(xmm_acc_3,
+            _mm_mul_pd(GWKLoad2Val(pSrc + i + 2 * nSrcXSize), xmm_weight));
+        xmm_acc_4 = _mm_add_pd(xmm_acc_4,
+            _mm_mul_pd(GWKLoad2Val(pSrc + i + 3 * nSrcXSize), xmm_weight));
+        i += 2;
+    }
+
+    padfRowAcc[0] = GWKAddLowAndHigh(xmm_acc_1, ymm_acc_1);
+    padfRowAcc[1] = GWKAddLowAndHigh(xmm_acc_2, ymm_acc_2);
+    padfRowAcc[2] = GWKAddLowAndHigh(xmm_acc_3, ymm_acc_3);
+    padfRowAcc[3] = GWKAddLowAndHigh(xmm_acc_4, ymm_acc_4);
+
+    if( i < nCols )
+    {
+        const double dfWeight = padfWeights[i];
+        padfRowAcc[0] += (double)pSrc[i] * dfWeight;
+        padfRowAcc[1] += (double)pSrc[i + nSrcXSize] * dfWeight;
+        padfRowAcc[2] += (double)pSrc[i + 2 * nSrcXSize] * dfWeight;
+        padfRowAcc[3] += (double)pSrc[i + 3 * nSrcXSize] * dfWeight;
+    }
+}
+
+/************************************************************************/
+/*                       GWKLanczos4Rows_AVX2()                         */
+/************************************************************************/
+
+// Each of the 4 lanes of the accumulator holds one row. Blocks of 4x4
+// pixels are transposed so that each row still accumulates its pixels
+// from left to right.
+template<class T>
+static void GWKLanczos4Rows_AVX2( const T* pSrc, int nSrcXSize,
+                                  int nCols, const double* padfWeights,
+                                  double* padfRowAcc )
+{
+    __m256d ymm_acc = _mm256_setzero_pd();
+    int i = 0;
+    for( ; i + 3 < nCols; i += 4 )
+    {
+        const __m256d ymm_row_1 = GWKLoad4Val(pSrc + i);
+        const __m256d ymm_row_2 = GWKLoad4Val(pSrc + i + nSrcXSize);
+        const __m256d ymm_row_3 = GWKLoad4Val(pSrc + i + 2 * nSrcXSize);
+        const __m256d ymm_row_4 = GWKLoad4Val(pSrc + i + 3 * nSrcXSize);
+
+        const __m256d ymm_tmp_1 = _mm256_unpacklo_pd(ymm_row_1, ymm_row_2);
+        const __m256d ymm_tmp_2 = _mm256_unpackhi_pd(ymm_row_1, ymm_row_2);
+        const __m256d ymm_tmp_3 = _mm256_unpacklo_pd(ymm_row_3, ymm_row_4);
+        const __m256d ymm_tmp_4 = _mm256_unpackhi_pd(ymm_row_3, ymm_row_4);
+
+        const __m256d ymm_col_1 =
+            _mm256_permute2f128_pd(ymm_tmp_1, ymm_tmp_3, 0x20);
+        const __m256d ymm_col_2 =
+            _mm256_permute2f128_pd(ymm_tmp_2, ymm_tmp_4, 0x20);
+        const __m256d ymm_col_3 =
+            _mm256_permute2f128_pd(ymm_tmp_1, ymm_tmp_3, 0x31);
+        const __m256d ymm_col_4 =
+            _mm256_permute2f128_pd(ymm_tmp_2, ymm_tmp_4, 0x31);
+
+        ymm_acc = _mm256_add_pd(ymm_acc, _mm256_mul_pd(ymm_col_1,
+                                    _mm256_broadcast_sd(padfWeights + i)));
+        ymm_acc = _mm256_add_pd(ymm_acc, _mm256_mul_pd(ymm_col_2,
+                                    _mm256_broadcast_sd(padfWeights + i + 1)));
+        ymm_acc = _mm256_add_pd(ymm_acc, _mm256_mul_pd(ymm_col_3,
+                                    _mm256_broadcast_sd(padfWeights + i + 2)));
+        ymm_acc = _mm256_add_pd(ymm_acc, _mm256_mul_pd(ymm_col_4,
+                                    _mm256_broadcast_sd(padfWeights + i + 3)));
+    }
+    _mm256_storeu_pd(padfRowAcc, ymm_acc);
+
+    for( ; i < nCols; ++i )
+    {
+        const double dfWeight = padfWeights[i];
+        padfRowAcc[0] += (double)pSrc[i] * dfWeight;
+        padfRowAcc[1] += (double)pSrc[i + nSrcXSize] * dfWeight;
+        padfRowAcc[2] += (double)pSrc[i + 2 * nSrcXSize] * dfWeight;
+        padfRowAcc[3] += (double)pSrc[i + 3 * nSrcXSize] * dfWeight;
+    }
+}
+
+/************************************************************************/
+/*                 Non-template entry points                            */
+/************************************************************************/
+
+void GWKResampleNoMasks4Rows_Byte_AVX2( const GByte* pSrc, int nSrcXSize,
+                                        int nCols, const double* padfWeights,
+                                        double* padfRowAcc )
+{
+    GWKResampleNoMasks4Rows_AVX2(pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+void GWKResampleNoMasks4Rows_Int16_AVX2( const GInt16* pSrc, int nSrcXSize,
+                                         int nCols, const double* padfWeights,
+                                         double* padfRowAcc )
+{
+    GWKResampleNoMasks4Rows_AVX2(pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+void GWKResampleNoMasks4Rows_UInt16_AVX2( const GUInt16* pSrc, int nSrcXSize,
+                                          int nCols,
+                                          const double* padfWeights,
+                                          double* padfRowAcc )
+{
+    GWKResampleNoMasks4Rows_AVX2(pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+void GWKResampleNoMasks4Rows_Float_AVX2( const float* pSrc, int nSrcXSize,
+                                         int nCols, const double* padfWeights,
+                                         double* padfRowAcc )
+{
+    GWKResampleNoMasks4Rows_AVX2(pSrc, nSrcXSize, nCols, padfWeights,
+                                 padfRowAcc);
+}
+
+void GWKLanczos4Rows_Byte_AVX2( const GByte* pSrc, int nSrcXSize,
+                                int nCols, const double* padfWeights,
+                                double* padfRowAcc )
+{
+    GWKLanczos4Rows_AVX2(pSrc, nSrcXSize, nCols, padfWeights, padfRowAcc);
+}
+
+void GWKLanczos4Rows_Int16_AVX2( const GInt16* pSrc, int nSrcXSize,
+                                 int nCols, const double* padfWeights,
+                                 double* padfRowAcc )
+{
+    GWKLanczos4Rows_AVX2(pSrc, nSrcXSize, nCols, padfWeights, padfRowAcc);
+}
+
+void GWKLanczos4Rows_UInt16_AVX2( const GUInt16* pSrc, int nSrcXSize,
+                                  int nCols, const double* padfWeights,
+                                  double* padfRowAcc )
+{
+    GWKLanczos4Rows_AVX2(pSrc, nSrcXSize, nCols, padfWeights, padfRowAcc);
+}
+
+void GWKLanczos4Rows_Float_AVX2( const float* pSrc, int nSrcXSize,
+                                 int nCols, const double* padfWeights,
+                                 double* padfRowAcc )
+{
+    GWKLanczos4Rows_AVX2(pSrc, nSrcXSize, nCols, padfWeights, padfRowAcc);
+}
+
+#endif /* defined(HAVE_AVX2_AT_COMPILE_TIME) && ( defined(__x86_64) || defined(_M_X64) ) */
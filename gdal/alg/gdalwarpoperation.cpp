@@ -28,12 +28,17 @@
  ****************************************************************************/
 
 #include "gdalwarper.h"
+#include "gdal_alg_priv.h"
 #include "cpl_string.h"
+#include "cpl_hash_set.h"
 #include "cpl_multiproc.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_api.h"
 #include "gdal_priv.h"
 
 #include <algorithm>
+#include <map>
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -43,6 +48,427 @@ struct _GDALWarpChunk {
     int sExtraSx, sExtraSy;
 };
 
+/************************************************************************/
+/* ==================================================================== */
+/*                     Source coordinate grid cache                     */
+/*                                                                      */
+/*      When the SRC_COORD_CACHE warp option is set, the source         */
+/*      coordinates computed by the warp kernel for a destination       */
+/*      window are kept in a process-wide cache, keyed by the           */
+/*      serialized transformer and the window, so that warping again    */
+/*      the same window with an identical transformer (e.g. a time      */
+/*      series of identically gridded rasters) skips the transformer.   */
+/*      Grids can also be persisted in a directory given by the         */
+/*      SRC_COORD_CACHE_DIR warp option.                                */
+/* ==================================================================== */
+/************************************************************************/
+
+typedef std::map<CPLString, GDALWarpSrcCoordGrid*> GDALWarpSrcCoordGridMap;
+
+static CPLMutex* hSrcCoordCacheMutex = NULL;
+static GDALWarpSrcCoordGridMap* poSrcCoordCache = NULL;
+static GUIntBig nSrcCoordCacheUsed = 0;
+static GUIntBig nSrcCoordCacheCounter = 0;
+
+static const char SRC_COORD_GRID_MAGIC[] = "GDALSCG1";
+
+/************************************************************************/
+/*                       GDALWarpSrcCoordGridSize()                     */
+/************************************************************************/
+
+static GUIntBig GDALWarpSrcCoordGridSize( int nXSize, int nYSize )
+{
+    return static_cast<GUIntBig>(nXSize) * nYSize *
+                                (2 * sizeof(double) + sizeof(int));
+}
+
+/************************************************************************/
+/*                    GDALWarpSrcCoordCacheGetMax()                     */
+/************************************************************************/
+
+static GUIntBig GDALWarpSrcCoordCacheGetMax()
+{
+    // In MB.
+    return static_cast<GUIntBig>(atoi(
+        CPLGetConfigOption("GDAL_WARP_SRC_COORD_CACHE_MAX", "256"))) *
+                                                            1024 * 1024;
+}
+
+/************************************************************************/
+/*                       GDALWarpSrcCoordGridFree()                     */
+/************************************************************************/
+
+static void GDALWarpSrcCoordGridFree( GDALWarpSrcCoordGrid* psGrid )
+{
+    if( psGrid == NULL )
+        return;
+    VSIFree(psGrid->padfX);
+    VSIFree(psGrid->padfY);
+    VSIFree(psGrid->pabSuccess);
+    VSIFree(psGrid->pabyRowDone);
+    CPLFree(psGrid);
+}
+
+/************************************************************************/
+/*                      GDALWarpSrcCoordGridCreate()                    */
+/************************************************************************/
+
+static GDALWarpSrcCoordGrid* GDALWarpSrcCoordGridCreate( int nXSize,
+                                                         int nYSize,
+                                                         bool bToFill )
+{
+    GDALWarpSrcCoordGrid* psGrid = static_cast<GDALWarpSrcCoordGrid*>(
+        CPLCalloc(1, sizeof(GDALWarpSrcCoordGrid)));
+    psGrid->nXSize = nXSize;
+    psGrid->nYSize = nYSize;
+    const size_t nPixels = static_cast<size_t>(nXSize) * nYSize;
+    psGrid->padfX = static_cast<double*>(
+        VSI_MALLOC2_VERBOSE(nPixels, sizeof(double)));
+    psGrid->padfY = static_cast<double*>(
+        VSI_MALLOC2_VERBOSE(nPixels, sizeof(double)));
+    psGrid->pabSuccess = static_cast<int*>(
+        VSI_MALLOC2_VERBOSE(nPixels, sizeof(int)));
+    if( bToFill )
+        psGrid->pabyRowDone = static_cast<GByte*>(
+            VSI_CALLOC_VERBOSE(nYSize, 1));
+    if( psGrid->padfX == NULL || psGrid->padfY == NULL ||
+        psGrid->pabSuccess == NULL ||
+        (bToFill && psGrid->pabyRowDone == NULL) )
+    {
+        GDALWarpSrcCoordGridFree(psGrid);
+        return NULL;
+    }
+    return psGrid;
+}
+
+/************************************************************************/
+/*                     GDALWarpSrcCoordGridFilename()                   */
+/************************************************************************/
+
+static CPLString GDALWarpSrcCoordGridFilename( const char* pszDir,
+                                               const CPLString& osKey )
+{
+    // The hash only needs to be discriminant enough: the full key is
+    // stored in the file and checked when reading it.
+    return CPLFormFilename(pszDir,
+                           CPLSPrintf("gdal_srccoord_%08x_%u",
+                                      static_cast<unsigned>(
+                                          CPLHashSetHashStr(osKey.c_str())),
+                                      static_cast<unsigned>(osKey.size())),
+                           "grd");
+}
+
+/************************************************************************/
+/*                       GDALWarpSrcCoordGridRead()                     */
+/*                                                                      */
+/*      Sidecar files are made of the magic, the key size and the key,  */
+/*      the grid dimensions, and then the X, Y and success arrays, all  */
+/*      in little-endian order.                                         */
+/************************************************************************/
+
+static GDALWarpSrcCoordGrid* GDALWarpSrcCoordGridRead( const char* pszDir,
+                                                       const CPLString& osKey,
+                                                       int nXSize, int nYSize )
+{
+    const CPLString osFilename(GDALWarpSrcCoordGridFilename(pszDir, osKey));
+    VSILFILE* fp = VSIFOpenL(osFilename, "rb");
+    if( fp == NULL )
+        return NULL;
+
+    bool bOK = true;
+    char achMagic[8] = { 0 };
+    GUInt32 nKeySize = 0;
+    bOK &= VSIFReadL(achMagic, 8, 1, fp) == 1 &&
+           memcmp(achMagic, SRC_COORD_GRID_MAGIC, 8) == 0;
+    bOK &= bOK && VSIFReadL(&nKeySize, sizeof(nKeySize), 1, fp) == 1;
+    CPL_LSBPTR32(&nKeySize);
+    bOK &= bOK && nKeySize == osKey.size();
+    if( bOK )
+    {
+        char* pszKey = static_cast<char*>(VSI_MALLOC_VERBOSE(nKeySize + 1));
+        bOK = pszKey != NULL && VSIFReadL(pszKey, 1, nKeySize, fp) == nKeySize;
+        if( bOK )
+        {
+            pszKey[nKeySize] = '\0';
+            bOK = osKey == pszKey;
+        }
+        VSIFree(pszKey);
+    }
+    GInt32 anSize[2] = { 0, 0 };
+    bOK &= bOK && VSIFReadL(anSize, sizeof(anSize), 1, fp) == 1;
+    CPL_LSBPTR32(&anSize[0]);
+    CPL_LSBPTR32(&anSize[1]);
+    bOK &= anSize[0] == nXSize && anSize[1] == nYSize;
+
+    GDALWarpSrcCoordGrid* psGrid = NULL;
+    if( bOK )
+        psGrid = GDALWarpSrcCoordGridCreate(nXSize, nYSize, false);
+    if( psGrid != NULL )
+    {
+        const size_t nPixels = static_cast<size_t>(nXSize) * nYSize;
+        if( VSIFReadL(psGrid->padfX, sizeof(double), nPixels, fp) != nPixels ||
+            VSIFReadL(psGrid->padfY, sizeof(double), nPixels, fp) != nPixels ||
+            VSIFReadL(psGrid->pabSuccess, sizeof(int), nPixels, fp) != nPixels )
+        {
+            GDALWarpSrcCoordGridFree(psGrid);
+            psGrid = NULL;
+        }
+#ifdef CPL_MSB
+        else
+        {
+            GDALSwapWordsEx(psGrid->padfX, sizeof(double), nPixels,
+                            sizeof(double));
+            GDALSwapWordsEx(psGrid->padfY, sizeof(double), nPixels,
+                            sizeof(double));
+            GDALSwapWordsEx(psGrid->pabSuccess, sizeof(int), nPixels,
+                            sizeof(int));
+        }
+#endif
+    }
+    CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+
+    if( psGrid == NULL )
+        CPLDebug("WARP", "Ignoring invalid or non matching %s",
+                 osFilename.c_str());
+    else
+        CPLDebug("WARP", "Reusing source coordinate grid from %s",
+                 osFilename.c_str());
+    return psGrid;
+}
+
+/************************************************************************/
+/*                      GDALWarpSrcCoordGridWrite()                     */
+/************************************************************************/
+
+static void GDALWarpSrcCoordGridWrite( const char* pszDir,
+                                       const CPLString& osKey,
+                                       GDALWarpSrcCoordGrid* psGrid )
+{
+    // Write to a temporary file that is renamed at the end, so that
+    // concurrent readers never see a partially written grid.
+    const CPLString osFilename(GDALWarpSrcCoordGridFilename(pszDir, osKey));
+    const CPLString osTmpFilename(CPLFormFilename(pszDir,
+                    CPLGetFilename(CPLGenerateTempFilename("srccoord")),
+                    "tmp"));
+    VSILFILE* fp = VSIFOpenL(osTmpFilename, "wb");
+    if( fp == NULL )
+    {
+        CPLDebug("WARP", "Cannot create %s", osTmpFilename.c_str());
+        return;
+    }
+
+    const size_t nPixels = static_cast<size_t>(psGrid->nXSize) * psGrid->nYSize;
+    GUInt32 nKeySize = static_cast<GUInt32>(osKey.size());
+    CPL_LSBPTR32(&nKeySize);
+    GInt32 anSize[2] = { psGrid->nXSize, psGrid->nYSize };
+    CPL_LSBPTR32(&anSize[0]);
+    CPL_LSBPTR32(&anSize[1]);
+#ifdef CPL_MSB
+    GDALSwapWordsEx(psGrid->padfX, sizeof(double), nPixels, sizeof(double));
+    GDALSwapWordsEx(psGrid->padfY, sizeof(double), nPixels, sizeof(double));
+    GDALSwapWordsEx(psGrid->pabSuccess, sizeof(int), nPixels, sizeof(int));
+#endif
+    bool bOK =
+        VSIFWriteL(SRC_COORD_GRID_MAGIC, 8, 1, fp) == 1 &&
+        VSIFWriteL(&nKeySize, sizeof(nKeySize), 1, fp) == 1 &&
+        VSIFWriteL(osKey.c_str(), 1, osKey.size(), fp) == osKey.size() &&
+        VSIFWriteL(anSize, sizeof(anSize), 1, fp) == 1 &&
+        VSIFWriteL(psGrid->padfX, sizeof(double), nPixels, fp) == nPixels &&
+        VSIFWriteL(psGrid->padfY, sizeof(double), nPixels, fp) == nPixels &&
+        VSIFWriteL(psGrid->pabSuccess, sizeof(int), nPixels, fp) == nPixels;
+#ifdef CPL_MSB
+    GDALSwapWordsEx(psGrid->padfX, sizeof(double), nPixels, sizeof(double));
+    GDALSwapWordsEx(psGrid->padfY, sizeof(double), nPixels, sizeof(double));
+    GDALSwapWordsEx(psGrid->pabSuccess, sizeof(int), nPixels, sizeof(int));
+#endif
+    bOK &= VSIFCloseL(fp) == 0;
+    if( !bOK || VSIRename(osTmpFilename, osFilename) != 0 )
+    {
+        CPLDebug("WARP", "Cannot write %s", osFilename.c_str());
+        VSIUnlink(osTmpFilename);
+    }
+}
+
+/************************************************************************/
+/*                      GDALWarpSrcCoordCacheEvict()                    */
+/*                                                                      */
+/*      Evict the least recently used grids not in use until the cache */
+/*      fits in its maximum size. Must be called with the mutex held.   */
+/************************************************************************/
+
+static void GDALWarpSrcCoordCacheEvict()
+{
+    const GUIntBig nMax = GDALWarpSrcCoordCacheGetMax();
+    while( nSrcCoordCacheUsed > nMax )
+    {
+        GDALWarpSrcCoordGridMap::iterator oIterLRU = poSrcCoordCache->end();
+        for( GDALWarpSrcCoordGridMap::iterator oIter = poSrcCoordCache->begin();
+             oIter != poSrcCoordCache->end(); ++oIter )
+        {
+            if( oIter->second->nRefCount == 0 &&
+                (oIterLRU == poSrcCoordCache->end() ||
+                 oIter->second->nLastUse < oIterLRU->second->nLastUse) )
+            {
+                oIterLRU = oIter;
+            }
+        }
+        if( oIterLRU == poSrcCoordCache->end() )
+            break;
+        GDALWarpSrcCoordGrid* psGrid = oIterLRU->second;
+        nSrcCoordCacheUsed -= GDALWarpSrcCoordGridSize(psGrid->nXSize,
+                                                       psGrid->nYSize);
+        GDALWarpSrcCoordGridFree(psGrid);
+        poSrcCoordCache->erase(oIterLRU);
+    }
+}
+
+/************************************************************************/
+/*                      GDALWarpSrcCoordCacheInsert()                   */
+/*                                                                      */
+/*      Insert a complete grid, returning the one that must be used     */
+/*      (which may be another one inserted concurrently). Must be       */
+/*      called with the mutex held.                                     */
+/************************************************************************/
+
+static GDALWarpSrcCoordGrid* GDALWarpSrcCoordCacheInsert(
+                                            const CPLString& osKey,
+                                            GDALWarpSrcCoordGrid* psGrid )
+{
+    if( poSrcCoordCache == NULL )
+        poSrcCoordCache = new GDALWarpSrcCoordGridMap();
+    GDALWarpSrcCoordGridMap::iterator oIter = poSrcCoordCache->find(osKey);
+    if( oIter != poSrcCoordCache->end() )
+    {
+        GDALWarpSrcCoordGridFree(psGrid);
+        return oIter->second;
+    }
+    (*poSrcCoordCache)[osKey] = psGrid;
+    nSrcCoordCacheUsed += GDALWarpSrcCoordGridSize(psGrid->nXSize,
+                                                   psGrid->nYSize);
+    psGrid->nLastUse = ++nSrcCoordCacheCounter;
+    return psGrid;
+}
+
+/************************************************************************/
+/*                     GDALWarpSrcCoordCacheAcquire()                   */
+/*                                                                      */
+/*      Return the cached grid for the key, which must be released      */
+/*      with GDALWarpSrcCoordCacheRelease(). If there is none, return   */
+/*      a new grid to be filled by the warp kernel, or NULL if it       */
+/*      would not fit in the cache.                                     */
+/************************************************************************/
+
+static GDALWarpSrcCoordGrid* GDALWarpSrcCoordCacheAcquire(
+                                            const CPLString& osKey,
+                                            int nXSize, int nYSize,
+                                            const char* pszDir )
+{
+    {
+        CPLMutexHolderD(&hSrcCoordCacheMutex);
+        if( poSrcCoordCache != NULL )
+        {
+            GDALWarpSrcCoordGridMap::iterator oIter =
+                poSrcCoordCache->find(osKey);
+            if( oIter != poSrcCoordCache->end() )
+            {
+                CPLDebug("WARP", "Reusing cached source coordinate grid "
+                         "of %dx%d", nXSize, nYSize);
+                oIter->second->nRefCount++;
+                oIter->second->nLastUse = ++nSrcCoordCacheCounter;
+                return oIter->second;
+            }
+        }
+    }
+
+    if( GDALWarpSrcCoordGridSize(nXSize, nYSize) >
+                                        GDALWarpSrcCoordCacheGetMax() )
+    {
+        CPLDebug("WARP", "Source coordinate grid of %dx%d does not fit in "
+                 "GDAL_WARP_SRC_COORD_CACHE_MAX", nXSize, nYSize);
+        return NULL;
+    }
+
+    if( pszDir != NULL )
+    {
+        GDALWarpSrcCoordGrid* psGrid =
+            GDALWarpSrcCoordGridRead(pszDir, osKey, nXSize, nYSize);
+        if( psGrid != NULL )
+        {
+            CPLMutexHolderD(&hSrcCoordCacheMutex);
+            psGrid = GDALWarpSrcCoordCacheInsert(osKey, psGrid);
+            psGrid->nRefCount++;
+            GDALWarpSrcCoordCacheEvict();
+            return psGrid;
+        }
+    }
+
+    return GDALWarpSrcCoordGridCreate(nXSize, nYSize, true);
+}
+
+/************************************************************************/
+/*                     GDALWarpSrcCoordCacheRelease()                   */
+/*                                                                      */
+/*      Release a grid returned by GDALWarpSrcCoordCacheAcquire(). A    */
+/*      grid filled by the kernel is inserted into the cache (and the   */
+/*      cache directory) if it has been completely filled.              */
+/************************************************************************/
+
+static void GDALWarpSrcCoordCacheRelease( const CPLString& osKey,
+                                          GDALWarpSrcCoordGrid* psGrid,
+                                          bool bWarpSucceeded,
+                                          const char* pszDir )
+{
+    if( psGrid->pabyRowDone == NULL )
+    {
+        CPLMutexHolderD(&hSrcCoordCacheMutex);
+        psGrid->nRefCount--;
+        return;
+    }
+
+    // Some kernels (average/mode, OpenCL) do not use the grid.
+    bool bComplete = bWarpSucceeded;
+    for( int i = 0; bComplete && i < psGrid->nYSize; i++ )
+        bComplete = psGrid->pabyRowDone[i] != 0;
+    if( !bComplete )
+    {
+        GDALWarpSrcCoordGridFree(psGrid);
+        return;
+    }
+    VSIFree(psGrid->pabyRowDone);
+    psGrid->pabyRowDone = NULL;
+
+    if( pszDir != NULL )
+        GDALWarpSrcCoordGridWrite(pszDir, osKey, psGrid);
+
+    CPLMutexHolderD(&hSrcCoordCacheMutex);
+    GDALWarpSrcCoordCacheInsert(osKey, psGrid);
+    GDALWarpSrcCoordCacheEvict();
+}
+
+/************************************************************************/
+/*                    GDALCleanupWarpSrcCoordCache()                    */
+/************************************************************************/
+
+void GDALCleanupWarpSrcCoordCache()
+{
+    if( poSrcCoordCache != NULL )
+    {
+        for( GDALWarpSrcCoordGridMap::iterator oIter = poSrcCoordCache->begin();
+             oIter != poSrcCoordCache->end(); ++oIter )
+        {
+            GDALWarpSrcCoordGridFree(oIter->second);
+        }
+        delete poSrcCoordCache;
+        poSrcCoordCache = NULL;
+    }
+    nSrcCoordCacheUsed = 0;
+    if( hSrcCoordCacheMutex != NULL )
+    {
+        CPLDestroyMutex(hSrcCoordCacheMutex);
+        hSrcCoordCacheMutex = NULL;
+    }
+}
+
 /************************************************************************/
 /* ==================================================================== */
 /*                          GDALWarpOperation                           */
@@ -135,6 +561,8 @@ GDALWarpOperation::GDALWarpOperation()
     bReportTimings = FALSE;
     nLastTimeReported = 0;
     psThreadData = NULL;
+    pszSrcCoordCacheKey = NULL;
+    psCurrentChunkWorker = NULL;
 }
 
 /************************************************************************/
@@ -180,6 +608,8 @@ void GDALWarpOperation::WipeOptions()
         GDALDestroyWarpOptions( psOptions );
         psOptions = NULL;
     }
+    CPLFree( pszSrcCoordCacheKey );
+    pszSrcCoordCacheKey = NULL;
 }
 
 /************************************************************************/
@@ -643,6 +1073,41 @@ CPLErr GDALWarpOperation::Initialize( const GDALWarpOptions *psNewOptions )
             eErr = CE_Failure;
     }
 
+/* -------------------------------------------------------------------- */
+/*      If source coordinates must be cached, they are keyed by the     */
+/*      serialized transformer and the options altering them.           */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None &&
+        CPLFetchBool( psOptions->papszWarpOptions, "SRC_COORD_CACHE", false ) )
+    {
+        CPLXMLNode* psTree = NULL;
+        if( psOptions->pfnTransformer != NULL )
+        {
+            CPLPushErrorHandler(CPLQuietErrorHandler);
+            psTree = GDALSerializeTransformer( psOptions->pfnTransformer,
+                                               psOptions->pTransformerArg );
+            CPLPopErrorHandler();
+        }
+        if( psTree == NULL )
+        {
+            CPLDebug( "WARP", "Cannot serialize transformer: "
+                      "SRC_COORD_CACHE ignored" );
+        }
+        else
+        {
+            char* pszXML = CPLSerializeXMLTree( psTree );
+            CPLDestroyXMLNode( psTree );
+            CPLString osKey( pszXML );
+            CPLFree( pszXML );
+            osKey += CPLSPrintf( "SRC_COORD_PRECISION=%s\nERROR_THRESHOLD=%s\n",
+                    CSLFetchNameValueDef( psOptions->papszWarpOptions,
+                                          "SRC_COORD_PRECISION", "0" ),
+                    CSLFetchNameValueDef( psOptions->papszWarpOptions,
+                                          "ERROR_THRESHOLD", "0" ) );
+            pszSrcCoordCacheKey = CPLStrdup( osKey );
+        }
+    }
+
     return eErr;
 }
 
@@ -810,60 +1275,142 @@ CPLErr GDALChunkAndWarpImage( GDALWarpOperationH hOperation,
 /*                          ChunkThreadMain()                           */
 /************************************************************************/
 
+struct _ChunkThreadData;
+
+/* State shared by the workers of ChunkAndWarpMulti(). */
 typedef struct
 {
     GDALWarpOperation *poOperation;
-    GDALWarpChunk     *pasChunkInfo;
-    CPLJoinableThread *hThreadHandle;
-    CPLErr             eErr;
-    double             dfProgressBase;
-    double             dfProgressScale;
+    GDALWarpChunk     *pasChunkList;
+    int                nChunkListCount;
     CPLMutex          *hIOMutex;
 
-    CPLMutex          *hCondMutex;
-    volatile int       bIOMutexTaken;
-    CPLCond           *hCond;
-} ChunkThreadData;
+    /* Protected by hIOMutex */
+    int                iNextChunk;
+    double             dfPixelsScheduled;
+    bool               bStop;
+    CPLErr             eErr;
 
-static void ChunkThreadMain( void *pThreadData )
+    double             dfTotalPixels;
 
+    /* When true, each worker has its own transformer and kernel threads, */
+    /* and warps concurrently with the others. */
+    bool               bConcurrentWarps;
+
+    /* Progress of concurrent warps, protected by hProgressMutex */
+    CPLMutex          *hProgressMutex;
+    double             dfProgressDone;
+    int                nWorkers;
+    struct _ChunkThreadData *pasWorkers;
+    GDALProgressFunc   pfnProgress;
+    void              *pProgressArg;
+} ChunkThreadSharedData;
+
+typedef struct _ChunkThreadData
+{
+    ChunkThreadSharedData *psShared;
+
+    /* Only used if psShared->bConcurrentWarps */
+    void              *pTransformerArg;
+    void              *psThreadData;
+    double             dfCurrentProgress;
+} ChunkThreadData;
+
+/* Progress callback of the concurrent warps, that reports the sum of the */
+/* progress of the finished chunks and of the chunks being warped. */
+static int CPL_STDCALL GDALWarpChunkProgress( double dfComplete,
+                                              const char * /* pszMessage */,
+                                              void *pProgressArg )
 {
-    volatile ChunkThreadData* psData = (volatile ChunkThreadData*) pThreadData;
+    ChunkThreadData* psData = static_cast<ChunkThreadData*>(pProgressArg);
+    ChunkThreadSharedData* psShared = psData->psShared;
+
+    CPLMutexHolderD( &psShared->hProgressMutex );
+    psData->dfCurrentProgress = dfComplete;
+    double dfTotal = psShared->dfProgressDone;
+    for( int i = 0; i < psShared->nWorkers; i++ )
+        dfTotal += psShared->pasWorkers[i].dfCurrentProgress;
+    return psShared->pfnProgress( std::min(1.0, dfTotal), "",
+                                  psShared->pProgressArg );
+}
 
-    GDALWarpChunk *pasChunkInfo = psData->pasChunkInfo;
+/* Worker of ChunkAndWarpMulti(): processes chunks taken from the shared */
+/* list until it is exhausted. The next chunk is taken while holding the */
+/* IO mutex, so that the reading of chunks starts in their order. */
+void GDALWarpOperation::ChunkThreadMain( void *pThreadData )
 
+{
+    ChunkThreadData* psData = static_cast<ChunkThreadData*>(pThreadData);
+    ChunkThreadSharedData* psShared = psData->psShared;
+
+    while( true )
+    {
 /* -------------------------------------------------------------------- */
 /*      Acquire IO mutex.                                               */
 /* -------------------------------------------------------------------- */
-    if( !CPLAcquireMutex( psData->hIOMutex, 600.0 ) )
-    {
-        CPLError( CE_Failure, CPLE_AppDefined,
-                    "Failed to acquire IOMutex in WarpRegion()." );
-        psData->eErr = CE_Failure;
-    }
-    else
-    {
-        if (psData->hCond != NULL)
+        if( !CPLAcquireMutex( psShared->hIOMutex, 600.0 ) )
         {
-            CPLAcquireMutex( psData->hCondMutex, 1.0 );
-            psData->bIOMutexTaken = TRUE;
-            CPLCondSignal(psData->hCond);
-            CPLReleaseMutex( psData->hCondMutex );
+            CPLError( CE_Failure, CPLE_AppDefined,
+                        "Failed to acquire IOMutex in WarpRegion()." );
+            psShared->bStop = true;
+            psShared->eErr = CE_Failure;
+            return;
         }
 
-        psData->eErr = psData->poOperation->WarpRegion(
+        if( psShared->bStop ||
+            psShared->iNextChunk >= psShared->nChunkListCount )
+        {
+            CPLReleaseMutex( psShared->hIOMutex );
+            return;
+        }
+
+        const int iChunk = psShared->iNextChunk ++;
+        GDALWarpChunk *pasChunkInfo = psShared->pasChunkList + iChunk;
+        const double dfChunkPixels =
+            pasChunkInfo->dsx * static_cast<double>(pasChunkInfo->dsy);
+
+        /* With concurrent warps, progress is reported by */
+        /* GDALWarpChunkProgress() that only needs the contribution of */
+        /* this chunk. */
+        double dfProgressBase = 0.0;
+        if( !psShared->bConcurrentWarps )
+            dfProgressBase =
+                psShared->dfPixelsScheduled / psShared->dfTotalPixels;
+        const double dfProgressScale = dfChunkPixels / psShared->dfTotalPixels;
+        psShared->dfPixelsScheduled += dfChunkPixels;
+
+        CPLDebug( "GDAL", "Start chunk %d.", iChunk );
+
+        GDALWarpOperation* poOperation = psShared->poOperation;
+        poOperation->psCurrentChunkWorker = psData;
+        const CPLErr eErr = poOperation->WarpRegion(
                                     pasChunkInfo->dx, pasChunkInfo->dy,
                                     pasChunkInfo->dsx, pasChunkInfo->dsy,
                                     pasChunkInfo->sx, pasChunkInfo->sy,
                                     pasChunkInfo->ssx, pasChunkInfo->ssy,
                                     pasChunkInfo->sExtraSx, pasChunkInfo->sExtraSy,
-                                    psData->dfProgressBase,
-                                    psData->dfProgressScale);
+                                    dfProgressBase, dfProgressScale);
+        poOperation->psCurrentChunkWorker = NULL;
 
-    /* -------------------------------------------------------------------- */
-    /*      Release the IO mutex.                                           */
-    /* -------------------------------------------------------------------- */
-        CPLReleaseMutex( psData->hIOMutex );
+        if( eErr != CE_None && !psShared->bStop )
+        {
+            psShared->bStop = true;
+            psShared->eErr = eErr;
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Release the IO mutex.                                           */
+/* -------------------------------------------------------------------- */
+        CPLReleaseMutex( psShared->hIOMutex );
+
+        CPLDebug( "GDAL", "Finished chunk %d.", iChunk );
+
+        if( psShared->bConcurrentWarps )
+        {
+            CPLMutexHolderD( &psShared->hProgressMutex );
+            psShared->dfProgressDone += dfProgressScale;
+            psData->dfCurrentProgress = 0.0;
+        }
     }
 }
 
@@ -883,6 +1430,14 @@ static void ChunkThreadMain( void *pThreadData )
  * internally this method uses multiple threads to interleave input/output
  * for one region while the processing is being done for another.
  *
+ * The number of worker threads, that take chunks from a shared list,
+ * is set by the NUM_CHUNK_THREADS warp option and defaults to 2, in which
+ * case the warping of a chunk overlaps the input/output of the next one.
+ * With more workers (GDAL >= 2.2), several chunks are warped concurrently,
+ * each worker using its own copy of the transformer, and the threads set
+ * with the NUM_THREADS warp option are shared among the workers.
+ * Input/output operations are always serialized.
+ *
  * @param nDstXOff X offset to window of destination data to be produced.
  * @param nDstYOff Y offset to window of destination data to be produced.
  * @param nDstXSize Width of output window on destination file to be produced.
@@ -895,15 +1450,14 @@ CPLErr GDALWarpOperation::ChunkAndWarpMulti(
     int nDstXOff, int nDstYOff,  int nDstXSize, int nDstYSize )
 
 {
-    hIOMutex = CPLCreateMutex();
-    hWarpMutex = CPLCreateMutex();
-
-    CPLReleaseMutex( hIOMutex );
-    CPLReleaseMutex( hWarpMutex );
+    if( hIOMutex == NULL )
+    {
+        hIOMutex = CPLCreateMutex();
+        hWarpMutex = CPLCreateMutex();
 
-    CPLCond* hCond = CPLCreateCond();
-    CPLMutex* hCondMutex = CPLCreateMutex();
-    CPLReleaseMutex(hCondMutex);
+        CPLReleaseMutex( hIOMutex );
+        CPLReleaseMutex( hWarpMutex );
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Collect the list of chunks to operate on.                       */
@@ -916,106 +1470,126 @@ CPLErr GDALWarpOperation::ChunkAndWarpMulti(
         qsort(pasChunkList, nChunkListCount, sizeof(GDALWarpChunk), OrderWarpChunk);
 
 /* -------------------------------------------------------------------- */
-/*      Process them one at a time, updating the progress               */
-/*      information for each region.                                    */
-/* -------------------------------------------------------------------- */
-    ChunkThreadData volatile asThreadData[2];
-    memset((void*)&asThreadData, 0, sizeof(asThreadData));
-    asThreadData[0].poOperation = this;
-    asThreadData[0].hIOMutex = hIOMutex;
-    asThreadData[1].poOperation = this;
-    asThreadData[1].hIOMutex = hIOMutex;
-
-    int iChunk;
-    double dfPixelsProcessed = 0.0;
-    double dfTotalPixels = nDstXSize*(double)nDstYSize;
-
-    CPLErr eErr = CE_None;
-    for( iChunk = 0; iChunk < nChunkListCount+1; iChunk++ )
-    {
-        int iThread = iChunk % 2;
-
-/* -------------------------------------------------------------------- */
-/*      Launch thread for this chunk.                                   */
-/* -------------------------------------------------------------------- */
-        if( pasChunkList != NULL && iChunk < nChunkListCount )
+/*      Determine the number of workers.                                */
+/* -------------------------------------------------------------------- */
+    const char* pszChunkThreads =
+        CSLFetchNameValueDef(psOptions->papszWarpOptions,
+                             "NUM_CHUNK_THREADS", "2");
+    int nWorkers = EQUAL(pszChunkThreads, "ALL_CPUS") ?
+                        CPLGetNumCPUs() : atoi(pszChunkThreads);
+    nWorkers = std::max(1, std::min(128, std::min(nWorkers, nChunkListCount)));
+
+    ChunkThreadSharedData sShared;
+    sShared.poOperation = this;
+    sShared.pasChunkList = pasChunkList;
+    sShared.nChunkListCount = nChunkListCount;
+    sShared.hIOMutex = hIOMutex;
+    sShared.iNextChunk = 0;
+    sShared.dfPixelsScheduled = 0.0;
+    sShared.bStop = false;
+    sShared.eErr = CE_None;
+    sShared.dfTotalPixels = nDstXSize*(double)nDstYSize;
+    /* Pre and post warp chunk processors are not expected to be */
+    /* reentrant. */
+    sShared.bConcurrentWarps = nWorkers > 2 &&
+                               psOptions->pfnPreWarpChunkProcessor == NULL &&
+                               psOptions->pfnPostWarpChunkProcessor == NULL;
+    sShared.hProgressMutex = NULL;
+    sShared.dfProgressDone = 0.0;
+    sShared.nWorkers = nWorkers;
+    sShared.pfnProgress = psOptions->pfnProgress;
+    sShared.pProgressArg = psOptions->pProgressArg;
+
+    std::vector<ChunkThreadData> asThreadData(nWorkers);
+    sShared.pasWorkers = &asThreadData[0];
+    for( int i = 0; i < nWorkers; i++ )
+    {
+        asThreadData[i].psShared = &sShared;
+        asThreadData[i].pTransformerArg = NULL;
+        asThreadData[i].psThreadData = NULL;
+        asThreadData[i].dfCurrentProgress = 0.0;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      For concurrent warps, give each worker its own transformer and  */
+/*      its share of the computation threads.                           */
+/* -------------------------------------------------------------------- */
+    if( sShared.bConcurrentWarps )
+    {
+        const char* pszWarpThreads =
+            CSLFetchNameValue(psOptions->papszWarpOptions, "NUM_THREADS");
+        if( pszWarpThreads == NULL )
+            pszWarpThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
+        const int nWarpThreads = EQUAL(pszWarpThreads, "ALL_CPUS") ?
+                            CPLGetNumCPUs() : atoi(pszWarpThreads);
+        char** papszWorkerWarpOptions =
+            CSLSetNameValue(CSLDuplicate(psOptions->papszWarpOptions),
+                            "NUM_THREADS",
+                            CPLSPrintf("%d", std::max(1, nWarpThreads / nWorkers)));
+
+        for( int i = 0; i < nWorkers; i++ )
         {
-            GDALWarpChunk *pasThisChunk = pasChunkList + iChunk;
-            double dfChunkPixels = pasThisChunk->dsx * (double) pasThisChunk->dsy;
-
-            asThreadData[iThread].dfProgressBase = dfPixelsProcessed / dfTotalPixels;
-            asThreadData[iThread].dfProgressScale = dfChunkPixels / dfTotalPixels;
-
-            dfPixelsProcessed += dfChunkPixels;
-
-            asThreadData[iThread].pasChunkInfo = pasThisChunk;
-
-            if ( iChunk == 0 )
+            asThreadData[i].pTransformerArg =
+                GDALCloneTransformer(psOptions->pTransformerArg);
+            if( asThreadData[i].pTransformerArg == NULL )
             {
-                asThreadData[iThread].hCond = hCond;
-                asThreadData[iThread].hCondMutex = hCondMutex;
-            }
-            else
-            {
-                asThreadData[iThread].hCond = NULL;
-                asThreadData[iThread].hCondMutex = NULL;
-            }
-            asThreadData[iThread].bIOMutexTaken = FALSE;
-
-            CPLDebug( "GDAL", "Start chunk %d.", iChunk );
-            asThreadData[iThread].hThreadHandle =
-                CPLCreateJoinableThread( ChunkThreadMain, (void*) &asThreadData[iThread] );
-            if( asThreadData[iThread].hThreadHandle == NULL )
-            {
-                CPLError( CE_Failure, CPLE_AppDefined,
-                          "CPLCreateJoinableThread() failed in ChunkAndWarpMulti()" );
-                eErr = CE_Failure;
+                CPLDebug("WARP", "Cannot duplicate transformer function. "
+                         "Falling back to serialized warping of chunks");
+                sShared.bConcurrentWarps = false;
                 break;
             }
-
-            /* Wait that the first thread has acquired the IO mutex before proceeding. */
-            /* (This will ensure that the first thread will run before the second one). */
-            if( iChunk == 0 )
+            asThreadData[i].psThreadData =
+                GWKThreadsCreate(papszWorkerWarpOptions,
+                                 psOptions->pfnTransformer,
+                                 asThreadData[i].pTransformerArg);
+            if( asThreadData[i].psThreadData == NULL )
             {
-                CPLAcquireMutex(hCondMutex, 1.0);
-                while (asThreadData[iThread].bIOMutexTaken == FALSE)
-                    CPLCondWait(hCond, hCondMutex);
-                CPLReleaseMutex(hCondMutex);
+                sShared.bConcurrentWarps = false;
+                break;
             }
         }
+        CSLDestroy(papszWorkerWarpOptions);
+    }
 
 /* -------------------------------------------------------------------- */
-/*      Wait for previous chunks thread to complete.                    */
+/*      Process the chunks.                                             */
 /* -------------------------------------------------------------------- */
-        if( iChunk > 0 )
-        {
-            iThread = (iChunk-1) % 2;
-
-            /* Wait for thread to finish. */
-            CPLJoinThread(asThreadData[iThread].hThreadHandle);
-            asThreadData[iThread].hThreadHandle = NULL;
-
-            CPLDebug( "GDAL", "Finished chunk %d.", iChunk-1 );
+    CPLDebug( "WARP", "Using %d worker threads for %d chunks%s",
+              nWorkers, nChunkListCount,
+              sShared.bConcurrentWarps ? " with concurrent warping" : "" );
 
-            eErr = asThreadData[iThread].eErr;
-
-            if( eErr != CE_None )
-                break;
+    CPLErr eErr = CE_None;
+    if( nChunkListCount > 0 )
+    {
+        CPLWorkerThreadPool oThreadPool;
+        if( nWorkers == 1 )
+        {
+            ChunkThreadMain( &asThreadData[0] );
+        }
+        else if( oThreadPool.Setup(nWorkers, NULL, NULL) )
+        {
+            for( int i = 0; i < nWorkers; i++ )
+                oThreadPool.SubmitJob( ChunkThreadMain, &asThreadData[i] );
+            oThreadPool.WaitCompletion();
         }
+        else
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot create worker threads in ChunkAndWarpMulti()" );
+            sShared.eErr = CE_Failure;
+        }
+        eErr = sShared.eErr;
     }
 
-    /* -------------------------------------------------------------------- */
-    /*      Wait for all threads to complete.                               */
-    /* -------------------------------------------------------------------- */
-    int iThread;
-    for(iThread = 0; iThread < 2; iThread ++)
+    for( int i = 0; i < nWorkers; i++ )
     {
-        if (asThreadData[iThread].hThreadHandle)
-            CPLJoinThread(asThreadData[iThread].hThreadHandle);
+        if( asThreadData[i].psThreadData != NULL )
+            GWKThreadsEnd(asThreadData[i].psThreadData);
+        if( asThreadData[i].pTransformerArg != NULL )
+            GDALDestroyTransformer(asThreadData[i].pTransformerArg);
     }
-
-    CPLDestroyCond(hCond);
-    CPLDestroyMutex(hCondMutex);
+    if( sShared.hProgressMutex != NULL )
+        CPLDestroyMutex(sShared.hProgressMutex);
 
     WipeChunkList();
 
@@ -1676,6 +2250,23 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
     oWK.papszWarpOptions = psOptions->papszWarpOptions;
     oWK.psThreadData = psThreadData;
 
+/* -------------------------------------------------------------------- */
+/*      When called from a ChunkAndWarpMulti() worker doing concurrent  */
+/*      warps, use its own transformer and threads. This must be read   */
+/*      before releasing the IO mutex.                                  */
+/* -------------------------------------------------------------------- */
+    bool bSerializeWarp = true;
+    ChunkThreadData* psWorker =
+        static_cast<ChunkThreadData*>(psCurrentChunkWorker);
+    if( psWorker != NULL && psWorker->psShared->bConcurrentWarps )
+    {
+        bSerializeWarp = false;
+        oWK.pTransformerArg = psWorker->pTransformerArg;
+        oWK.psThreadData = psWorker->psThreadData;
+        oWK.pfnProgress = GDALWarpChunkProgress;
+        oWK.pProgress = psWorker;
+    }
+
     oWK.padfDstNoDataReal = psOptions->padfDstNoDataReal;
 
 /* -------------------------------------------------------------------- */
@@ -2026,7 +2617,7 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
     if( hIOMutex != NULL )
     {
         CPLReleaseMutex( hIOMutex );
-        if( !CPLAcquireMutex( hWarpMutex, 600.0 ) )
+        if( bSerializeWarp && !CPLAcquireMutex( hWarpMutex, 600.0 ) )
         {
             CPLError( CE_Failure, CPLE_AppDefined,
                       "Failed to acquire WarpMutex in WarpRegion()." );
@@ -2046,8 +2637,28 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
 /* -------------------------------------------------------------------- */
     if( eErr == CE_None )
     {
+        GDALWarpSrcCoordGrid* psSrcCoordGrid = NULL;
+        CPLString osSrcCoordKey;
+        const char* pszSrcCoordCacheDir = CSLFetchNameValue(
+            psOptions->papszWarpOptions, "SRC_COORD_CACHE_DIR" );
+        if( pszSrcCoordCacheKey != NULL )
+        {
+            osSrcCoordKey = pszSrcCoordCacheKey;
+            osSrcCoordKey += CPLSPrintf( "DST_WINDOW=%d,%d,%d,%d",
+                                         nDstXOff, nDstYOff,
+                                         nDstXSize, nDstYSize );
+            psSrcCoordGrid = GDALWarpSrcCoordCacheAcquire(
+                osSrcCoordKey, nDstXSize, nDstYSize, pszSrcCoordCacheDir );
+            oWK.psSrcCoordGrid = psSrcCoordGrid;
+        }
+
         eErr = oWK.PerformWarp();
         ReportTiming( "In memory warp operation" );
+
+        if( psSrcCoordGrid != NULL )
+            GDALWarpSrcCoordCacheRelease( osSrcCoordKey, psSrcCoordGrid,
+                                          eErr == CE_None,
+                                          pszSrcCoordCacheDir );
     }
 
 /* -------------------------------------------------------------------- */
@@ -2062,7 +2673,8 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
 /* -------------------------------------------------------------------- */
     if( hIOMutex != NULL )
     {
-        CPLReleaseMutex( hWarpMutex );
+        if( bSerializeWarp )
+            CPLReleaseMutex( hWarpMutex );
         if( !CPLAcquireMutex( hIOMutex, 600.0 ) )
         {
             CPLError( CE_Failure, CPLE_AppDefined,
@@ -178,7 +178,9 @@ nodata (unset/transparent) pixels. </dd>
 megabytes) that the warp API is allowed to use for caching.</dd>
 <dt> <b>-multi</b>:</dt><dd> Use multithreaded warping implementation.
 Multiple threads will be used to process chunks of image and perform
-input/output operation simultaneously.</dd>
+input/output operation simultaneously. Starting with GDAL 2.2, the number of
+threads processing chunks can be set with <b>-wo NUM_CHUNK_THREADS=val/ALL_CPUS</b>
+(2 by default), in which case several chunks are warped concurrently.</dd>
 <dt> <b>-q</b>:</dt><dd> Be quiet.</dd>
 <dt> <b>-of</b> <em>format</em>:</dt><dd> Select the output format. The default is GeoTIFF (GTiff). Use the short format name. </dd>
 <dt> <b>-co</b> <em>"NAME=VALUE"</em>:</dt><dd> passes a creation option to
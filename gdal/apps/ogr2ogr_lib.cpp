@@ -33,11 +33,14 @@
 #include "cpl_conv.h"
 #include "cpl_string.h"
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_api.h"
 #include "gdal.h"
 #include "gdal_utils_priv.h"
 #include "gdal_alg.h"
 #include "commonutils.h"
+#include <deque>
 #include <map>
 #include <vector>
 
@@ -58,6 +61,15 @@ typedef enum
     GTC_CONVERT_TO_CURVE,
 } GeomTypeConversion;
 
+/* Outcome of LayerTranslator::TransformFeature() */
+typedef enum
+{
+    TF_OK,
+    TF_SKIPPED,           /* geometry clipped out: nothing to write */
+    TF_SETFROM_FAILED,
+    TF_REPROJECT_FAILED,  /* target feature only kept with -skipfailures */
+} TransformFeatureStatus;
+
 #define GEOMTYPE_UNCHANGED  -2
 
 #define COORD_DIM_UNCHANGED -1
@@ -316,6 +328,11 @@ struct GDALVectorTranslateOptions
 
     /*! Whether layer and feature native data must be transferred. */
     bool bNativeData;
+
+    /*! number of threads used to transform features (field mapping, reprojection, geometric
+        operations and clipping) while the source layer is read in a separate thread.
+        Features are still written in the order they are read. 0 or 1 disables it. */
+    int nThreads;
 };
 
 typedef struct
@@ -331,6 +348,7 @@ typedef struct
     int          iSrcFIDField;
     int          iRequestedSrcGeomField;
     bool         bPreserveFID;
+    bool         bFeaturePoolingEnabled; // on poSrcLayer, by Setup()
 } TargetLayerInfo;
 
 typedef struct
@@ -406,6 +424,41 @@ public:
                                   GDALProgressFunc pfnProgress,
                                   void *pProgressArg,
                                   GDALVectorTranslateOptions *psOptions);
+
+    int                 TransformFeature(OGRFeature* poFeature,
+                                         int iPart,
+                                         int nParts,
+                                         TargetLayerInfo* psInfo,
+                                         OGRFeatureDefn* poDstDefn,
+                                         OGRCoordinateTransformation** papoCT,
+                                         OGRSpatialReference* poOutputSRS,
+                                         bool bSkipFailures,
+                                         OGRFeature** ppoDstFeature);
+
+private:
+    bool                WriteFeature(OGRFeature* poFeature,
+                                     OGRFeature* poDstFeature,
+                                     int eStatus,
+                                     TargetLayerInfo* psInfo,
+                                     int& nFeaturesInTransaction,
+                                     GIntBig& nTotalEventsDone,
+                                     GIntBig& nFeaturesWritten,
+                                     GDALVectorTranslateOptions *psOptions);
+
+    bool                TranslateMultiThreaded(TargetLayerInfo* psInfo,
+                                               OGRFeatureDefn* poDstDefn,
+                                               OGRSpatialReference* poOutputSRS,
+                                               bool bExplodeCollections,
+                                               GIntBig nCountLayerFeatures,
+                                               GIntBig* pnReadFeatureCount,
+                                               GIntBig& nCount,
+                                               int& nFeaturesInTransaction,
+                                               GIntBig& nTotalEventsDone,
+                                               GIntBig& nFeaturesWritten,
+                                               bool& bInterrupted,
+                                               GDALProgressFunc pfnProgress,
+                                               void *pProgressArg,
+                                               GDALVectorTranslateOptions *psOptions);
 };
 
 static OGRLayer* GetLayerAndOverwriteIfNecessary(GDALDataset *poDstDS,
@@ -3254,6 +3307,18 @@ TargetLayerInfo* SetupTargetLayer::Setup(OGRLayer* poSrcLayer,
     psInfo->bPerFeatureCT = false;
     psInfo->poSrcLayer = poSrcLayer;
     psInfo->poDstLayer = poDstLayer;
+
+    // ogr2ogr destroys each source feature once it has been written (by
+    // the writer thread with -threads), and never hands it to the caller,
+    // so the source layer can recycle them. The previous state is restored
+    // by FreeTargetLayerInfo().
+    psInfo->bFeaturePoolingEnabled = false;
+    if( !poSrcLayer->GetFeaturePooling() &&
+        CPLTestBool(CPLGetConfigOption("OGR2OGR_FEATURE_POOLING", "YES")) )
+    {
+        poSrcLayer->SetFeaturePooling(TRUE);
+        psInfo->bFeaturePoolingEnabled = true;
+    }
     psInfo->papoCT = (OGRCoordinateTransformation**)
         CPLCalloc(poDstLayer->GetLayerDefn()->GetGeomFieldCount(),
                   sizeof(OGRCoordinateTransformation*));
@@ -3280,6 +3345,8 @@ static void FreeTargetLayerInfo(TargetLayerInfo* psInfo)
 {
     if( psInfo == NULL )
         return;
+    if( psInfo->bFeaturePoolingEnabled )
+        psInfo->poSrcLayer->SetFeaturePooling(FALSE);
     for(int i=0;i<psInfo->poDstLayer->GetLayerDefn()->GetGeomFieldCount();i++)
     {
         delete psInfo->papoCT[i];
@@ -3455,6 +3522,399 @@ static bool SetupCT( TargetLayerInfo* psInfo,
     return true;
 }
 
+/************************************************************************/
+/*                            GetPartCount()                            */
+/************************************************************************/
+
+/* Return the number of target features produced from a source feature, */
+/* that is to say the number of parts of its geometry collection with */
+/* -explodecollections, or 1. *pnParts is set to 0 if the geometry must */
+/* not be exploded. */
+static int GetPartCount( OGRFeature* poFeature,
+                         TargetLayerInfo* psInfo,
+                         bool bExplodeCollections,
+                         int* pnParts )
+{
+    *pnParts = 0;
+    if( !bExplodeCollections )
+        return 1;
+
+    OGRGeometry* poSrcGeometry;
+    if( psInfo->iRequestedSrcGeomField >= 0 )
+        poSrcGeometry = poFeature->GetGeomFieldRef(
+                                psInfo->iRequestedSrcGeomField);
+    else
+        poSrcGeometry = poFeature->GetGeometryRef();
+    if (poSrcGeometry &&
+        OGR_GT_IsSubClassOf(poSrcGeometry->getGeometryType(), wkbGeometryCollection) )
+    {
+        *pnParts = ((OGRGeometryCollection*)poSrcGeometry)->getNumGeometries();
+        if( *pnParts > 0 )
+            return *pnParts;
+    }
+    return 1;
+}
+
+/************************************************************************/
+/*                 LayerTranslator::TransformFeature()                  */
+/************************************************************************/
+
+/* Build the target feature of the iPart(th) part of poFeature: field */
+/* mapping, FID, and for each geometry field the geometric operations, */
+/* clipping, reprojection and type conversion. This does not touch the */
+/* target layer, and failures reported through the returned status are */
+/* left to WriteFeature() to report, so it can run concurrently on */
+/* different features as long as each thread has its own papoCT. */
+/* Errors emitted by the operations themselves (reprojection, clipping, */
+/* ...) go to the error handler of the calling thread: see */
+/* LayerTranslatorTransformJob() for how they are forwarded. */
+int LayerTranslator::TransformFeature( OGRFeature* poFeature,
+                                       int iPart,
+                                       int nParts,
+                                       TargetLayerInfo* psInfo,
+                                       OGRFeatureDefn* poDstDefn,
+                                       OGRCoordinateTransformation** papoCT,
+                                       OGRSpatialReference* poOutputSRS,
+                                       bool bSkipFailures,
+                                       OGRFeature** ppoDstFeature )
+{
+    const int eGType = m_eGType;
+    const int iSrcZField = psInfo->iSrcZField;
+    const int nSrcGeomFieldCount = poFeature->GetDefnRef()->GetGeomFieldCount();
+    const int nDstGeomFieldCount = poDstDefn->GetGeomFieldCount();
+    const bool bExplodeCollections = m_bExplodeCollections && nDstGeomFieldCount <= 1;
+    int eStatus = TF_OK;
+
+    *ppoDstFeature = NULL;
+
+    OGRFeature* poDstFeature = OGRFeature::CreateFeature( poDstDefn );
+
+    /* Optimization to avoid duplicating the source geometry in the */
+    /* target feature : we steal it from the source feature for now... */
+    OGRGeometry* poStolenGeometry = NULL;
+    if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
+        nDstGeomFieldCount == 1 )
+    {
+        poStolenGeometry = poFeature->StealGeometry();
+    }
+    else if( !bExplodeCollections &&
+             psInfo->iRequestedSrcGeomField >= 0 )
+    {
+        poStolenGeometry = poFeature->StealGeometry(
+            psInfo->iRequestedSrcGeomField);
+    }
+
+    if( poDstFeature->SetFrom( poFeature, psInfo->panMap, TRUE ) != OGRERR_NONE )
+    {
+        OGRFeature::DestroyFeature( poDstFeature );
+        OGRGeometryFactory::destroyGeometry( poStolenGeometry );
+        return TF_SETFROM_FAILED;
+    }
+
+    /* ... and now we can attach the stolen geometry */
+    if( poStolenGeometry )
+    {
+        poDstFeature->SetGeometryDirectly(poStolenGeometry);
+    }
+
+    if( psInfo->bPreserveFID )
+        poDstFeature->SetFID( poFeature->GetFID() );
+    else if( psInfo->iSrcFIDField >= 0 &&
+             poFeature->IsFieldSet(psInfo->iSrcFIDField))
+        poDstFeature->SetFID( poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField) );
+
+    /* Erase native data if asked explicitly */
+    if( !m_bNativeData )
+    {
+        poDstFeature->SetNativeData(NULL);
+        poDstFeature->SetNativeMediaType(NULL);
+    }
+
+    for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
+    {
+        OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
+        if (poDstGeometry == NULL)
+            continue;
+
+        if (nParts > 0)
+        {
+            /* For -explodecollections, extract the iPart(th) of the geometry */
+            OGRGeometry* poPart = ((OGRGeometryCollection*)poDstGeometry)->getGeometryRef(iPart);
+            ((OGRGeometryCollection*)poDstGeometry)->removeGeometry(iPart, FALSE);
+            delete poDstGeometry;
+            poDstGeometry = poPart;
+        }
+
+        if (iSrcZField != -1)
+        {
+            SetZ(poDstGeometry, poFeature->GetFieldAsDouble(iSrcZField));
+            /* This will correct the coordinate dimension to 3 */
+            OGRGeometry* poDupGeometry = poDstGeometry->clone();
+            delete poDstGeometry;
+            poDstGeometry = poDupGeometry;
+        }
+
+        if (m_nCoordDim == 2 || m_nCoordDim == 3)
+            poDstGeometry->setCoordinateDimension( m_nCoordDim );
+        else if (m_nCoordDim == 4)
+        {
+            poDstGeometry->set3D( TRUE );
+            poDstGeometry->setMeasured( TRUE );
+        }
+        else if (m_nCoordDim == COORD_DIM_XYM)
+        {
+            poDstGeometry->set3D( FALSE );
+            poDstGeometry->setMeasured( TRUE );
+        }
+        else if ( m_nCoordDim == COORD_DIM_LAYER_DIM )
+        {
+            const OGRwkbGeometryType eDstLayerGeomType =
+              poDstDefn->GetGeomFieldDefn(iGeom)->GetType();
+            poDstGeometry->set3D( wkbHasZ(eDstLayerGeomType) );
+            poDstGeometry->setMeasured( wkbHasM(eDstLayerGeomType) );
+        }
+
+        if (m_eGeomOp == GEOMOP_SEGMENTIZE)
+        {
+            if (m_dfGeomOpParam > 0)
+                poDstGeometry->segmentize(m_dfGeomOpParam);
+        }
+        else if (m_eGeomOp == GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY)
+        {
+            if (m_dfGeomOpParam > 0)
+            {
+                OGRGeometry* poNewGeom = poDstGeometry->SimplifyPreserveTopology(m_dfGeomOpParam);
+                if (poNewGeom)
+                {
+                    delete poDstGeometry;
+                    poDstGeometry = poNewGeom;
+                }
+            }
+        }
+
+        if (m_poClipSrc)
+        {
+            OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipSrc);
+            delete poDstGeometry;
+            if (poClipped == NULL || poClipped->IsEmpty())
+            {
+                delete poClipped;
+                goto skip;
+            }
+            poDstGeometry = poClipped;
+        }
+
+        OGRCoordinateTransformation* poCT = papoCT[iGeom];
+        if( !m_bTransform )
+            poCT = m_poGCPCoordTrans;
+        char** papszTransformOptions = psInfo->papapszTransformOptions[iGeom];
+
+        if( poCT != NULL || papszTransformOptions != NULL)
+        {
+            OGRGeometry* poReprojectedGeom =
+                OGRGeometryFactory::transformWithOptions(poDstGeometry, poCT, papszTransformOptions);
+            if( poReprojectedGeom == NULL )
+            {
+                eStatus = TF_REPROJECT_FAILED;
+                if( !bSkipFailures )
+                {
+                    OGRFeature::DestroyFeature( poDstFeature );
+                    delete poDstGeometry;
+                    return eStatus;
+                }
+            }
+
+            delete poDstGeometry;
+            poDstGeometry = poReprojectedGeom;
+        }
+        else if (poOutputSRS != NULL)
+        {
+            poDstGeometry->assignSpatialReference(poOutputSRS);
+        }
+
+        if (m_poClipDst)
+        {
+            if( poDstGeometry == NULL )
+                goto skip;
+
+            OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipDst);
+            delete poDstGeometry;
+            if (poClipped == NULL || poClipped->IsEmpty())
+            {
+                delete poClipped;
+                goto skip;
+            }
+
+            poDstGeometry = poClipped;
+        }
+
+        if( eGType != GEOMTYPE_UNCHANGED )
+        {
+            poDstGeometry = OGRGeometryFactory::forceTo(
+                    poDstGeometry, (OGRwkbGeometryType)eGType);
+        }
+        else if( m_eGeomTypeConversion == GTC_PROMOTE_TO_MULTI ||
+                 m_eGeomTypeConversion == GTC_CONVERT_TO_LINEAR ||
+                 m_eGeomTypeConversion == GTC_CONVERT_TO_CURVE )
+        {
+            if( poDstGeometry != NULL )
+            {
+                OGRwkbGeometryType eTargetType = poDstGeometry->getGeometryType();
+                eTargetType = ConvertType(m_eGeomTypeConversion, eTargetType);
+                poDstGeometry = OGRGeometryFactory::forceTo(poDstGeometry, eTargetType);
+            }
+        }
+
+        poDstFeature->SetGeomFieldDirectly(iGeom, poDstGeometry);
+    }
+
+    *ppoDstFeature = poDstFeature;
+    return eStatus;
+
+skip:
+    OGRFeature::DestroyFeature( poDstFeature );
+    return (eStatus == TF_OK) ? TF_SKIPPED : eStatus;
+}
+
+/************************************************************************/
+/*                   LayerTranslator::WriteFeature()                    */
+/************************************************************************/
+
+/* Write the result of TransformFeature() into the target layer, taking */
+/* care of transaction grouping and of error reporting. poDstFeature is */
+/* owned by this method. Returns false if the translation must stop. */
+bool LayerTranslator::WriteFeature( OGRFeature* poFeature,
+                                    OGRFeature* poDstFeature,
+                                    int eStatus,
+                                    TargetLayerInfo* psInfo,
+                                    int& nFeaturesInTransaction,
+                                    GIntBig& nTotalEventsDone,
+                                    GIntBig& nFeaturesWritten,
+                                    GDALVectorTranslateOptions *psOptions )
+{
+    OGRLayer *poSrcLayer = psInfo->poSrcLayer;
+    OGRLayer *poDstLayer = psInfo->poDstLayer;
+    const bool bPreserveFID = psInfo->bPreserveFID;
+
+    if( psOptions->nLayerTransaction &&
+        ++nFeaturesInTransaction == psOptions->nGroupTransactions )
+    {
+        if( poDstLayer->CommitTransaction() != OGRERR_NONE ||
+            poDstLayer->StartTransaction() != OGRERR_NONE )
+        {
+            OGRFeature::DestroyFeature( poDstFeature );
+            return false;
+        }
+        nFeaturesInTransaction = 0;
+    }
+    else if( !psOptions->nLayerTransaction &&
+             psOptions->nGroupTransactions >= 0 &&
+             ++nTotalEventsDone >= psOptions->nGroupTransactions )
+    {
+        if( m_poODS->CommitTransaction() != OGRERR_NONE ||
+                m_poODS->StartTransaction(psOptions->bForceTransaction) != OGRERR_NONE )
+        {
+            OGRFeature::DestroyFeature( poDstFeature );
+            return false;
+        }
+        nTotalEventsDone = 0;
+    }
+
+    if( eStatus == TF_SETFROM_FAILED )
+    {
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+            {
+                if( poDstLayer->CommitTransaction() != OGRERR_NONE )
+                    return false;
+            }
+        }
+
+        CPLError( CE_Failure, CPLE_AppDefined,
+                "Unable to translate feature " CPL_FRMT_GIB " from layer %s.",
+                poFeature->GetFID(), poSrcLayer->GetName() );
+        return false;
+    }
+
+    if( eStatus == TF_REPROJECT_FAILED )
+    {
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+            {
+                if( poDstLayer->CommitTransaction() != OGRERR_NONE &&
+                    !psOptions->bSkipFailures )
+                {
+                    OGRFeature::DestroyFeature( poDstFeature );
+                    return false;
+                }
+            }
+        }
+
+        CPLError( CE_Failure, CPLE_AppDefined, "Failed to reproject feature " CPL_FRMT_GIB " (geometry probably out of source or destination SRS).",
+                  poFeature->GetFID() );
+        if( !psOptions->bSkipFailures )
+        {
+            OGRFeature::DestroyFeature( poDstFeature );
+            return false;
+        }
+    }
+
+    /* Clipped out */
+    if( poDstFeature == NULL )
+        return true;
+
+    CPLErrorReset();
+    if( poDstLayer->CreateFeature( poDstFeature ) == OGRERR_NONE )
+    {
+        nFeaturesWritten ++;
+        if( (bPreserveFID && poDstFeature->GetFID() != poFeature->GetFID()) ||
+            (!bPreserveFID && psInfo->iSrcFIDField >= 0 && poFeature->IsFieldSet(psInfo->iSrcFIDField) &&
+             poDstFeature->GetFID() != poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField)) )
+        {
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "Feature id not preserved");
+        }
+    }
+    else if( !psOptions->bSkipFailures )
+    {
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+                poDstLayer->RollbackTransaction();
+        }
+
+        CPLError( CE_Failure, CPLE_AppDefined,
+                "Unable to write feature " CPL_FRMT_GIB " from layer %s.",
+                poFeature->GetFID(), poSrcLayer->GetName() );
+
+        OGRFeature::DestroyFeature( poDstFeature );
+        return false;
+    }
+    else
+    {
+        CPLDebug( "GDALVectorTranslate", "Unable to write feature " CPL_FRMT_GIB " into layer %s.",
+                   poFeature->GetFID(), poSrcLayer->GetName() );
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+            {
+                poDstLayer->RollbackTransaction();
+                CPL_IGNORE_RET_VAL(poDstLayer->StartTransaction());
+            }
+            else
+            {
+                m_poODS->RollbackTransaction();
+                m_poODS->StartTransaction(psOptions->bForceTransaction);
+            }
+        }
+    }
+
+    OGRFeature::DestroyFeature( poDstFeature );
+    return true;
+}
+
 /************************************************************************/
 /*                     LayerTranslator::Translate()                     */
 /************************************************************************/
@@ -3470,16 +3930,13 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
 {
     OGRLayer    *poSrcLayer;
     OGRLayer    *poDstLayer;
-    const int         eGType = m_eGType;
     OGRSpatialReference* poOutputSRS = m_poOutputSRS;
 
     poSrcLayer = psInfo->poSrcLayer;
     poDstLayer = psInfo->poDstLayer;
-    int* const panMap = psInfo->panMap;
-    const int iSrcZField = psInfo->iSrcZField;
-    const bool bPreserveFID = psInfo->bPreserveFID;
+    OGRFeatureDefn* poDstDefn = poDstLayer->GetLayerDefn();
     const int nSrcGeomFieldCount = poSrcLayer->GetLayerDefn()->GetGeomFieldCount();
-    const int nDstGeomFieldCount = poDstLayer->GetLayerDefn()->GetGeomFieldCount();
+    const int nDstGeomFieldCount = poDstDefn->GetGeomFieldCount();
     const bool bExplodeCollections = m_bExplodeCollections && nDstGeomFieldCount <= 1;
 
     if( poOutputSRS == NULL && !m_bNullifyOutputSRS )
@@ -3495,6 +3952,25 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Check if features can be read and transformed in other          */
+/*      threads. The first feature is always translated here, so that   */
+/*      we know if the coordinate transformation is per feature.        */
+/* -------------------------------------------------------------------- */
+    bool bUseThreads = false;
+    if( psOptions->nThreads > 1 && poFeatureIn == NULL &&
+        psOptions->nFIDToFetch == OGRNullFID )
+    {
+        if( m_poGCPCoordTrans != NULL )
+            CPLDebug("GDALVectorTranslate",
+                     "-threads ignored: GCP transformation in use");
+        else if( m_poSrcDS == m_poODS )
+            CPLDebug("GDALVectorTranslate",
+                     "-threads ignored: source and target datasets are the same");
+        else
+            bUseThreads = true;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Transfer features.                                              */
 /* -------------------------------------------------------------------- */
@@ -3515,7 +3991,34 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
     bool bRet = true;
     while( true )
     {
-        OGRFeature      *poDstFeature = NULL;
+        if( bUseThreads && psInfo->nFeaturesRead > 0 )
+        {
+            if( psInfo->bPerFeatureCT )
+            {
+                CPLDebug("GDALVectorTranslate",
+                         "-threads ignored: source SRS is set per feature");
+                bUseThreads = false;
+            }
+            else
+            {
+                bool bInterrupted = false;
+                if( !TranslateMultiThreaded( psInfo, poDstDefn, poOutputSRS,
+                                             bExplodeCollections,
+                                             nCountLayerFeatures,
+                                             pnReadFeatureCount, nCount,
+                                             nFeaturesInTransaction,
+                                             nTotalEventsDone,
+                                             nFeaturesWritten, bInterrupted,
+                                             pfnProgress, pProgressArg,
+                                             psOptions) )
+                {
+                    return false;
+                }
+                if( bInterrupted )
+                    bRet = false;
+                break;
+            }
+        }
 
         if( poFeatureIn != NULL )
             poFeature = poFeatureIn;
@@ -3541,358 +4044,472 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
         psInfo->nFeaturesRead ++;
 
         int nParts = 0;
-        int nIters = 1;
-        if (bExplodeCollections)
+        const int nIters = GetPartCount(poFeature, psInfo,
+                                        bExplodeCollections, &nParts);
+
+        for(int iPart = 0; iPart < nIters; iPart++)
         {
-            OGRGeometry* poSrcGeometry;
-            if( psInfo->iRequestedSrcGeomField >= 0 )
-                poSrcGeometry = poFeature->GetGeomFieldRef(
-                                        psInfo->iRequestedSrcGeomField);
-            else
-                poSrcGeometry = poFeature->GetGeometryRef();
-            if (poSrcGeometry &&
-                OGR_GT_IsSubClassOf(poSrcGeometry->getGeometryType(), wkbGeometryCollection) )
+            OGRFeature* poDstFeature = NULL;
+            const int eStatus =
+                TransformFeature( poFeature, iPart, nParts, psInfo, poDstDefn,
+                                  psInfo->papoCT, poOutputSRS,
+                                  psOptions->bSkipFailures, &poDstFeature );
+            if( !WriteFeature( poFeature, poDstFeature, eStatus, psInfo,
+                               nFeaturesInTransaction, nTotalEventsDone,
+                               nFeaturesWritten, psOptions ) )
             {
-                nParts = ((OGRGeometryCollection*)poSrcGeometry)->getNumGeometries();
-                nIters = nParts;
-                if (nIters == 0)
-                    nIters = 1;
+                OGRFeature::DestroyFeature( poFeature );
+                return false;
             }
         }
 
-        for(int iPart = 0; iPart < nIters; iPart++)
+        OGRFeature::DestroyFeature( poFeature );
+
+        /* Report progress */
+        nCount ++;
+        bool bGoOn = true;
+        if (pfnProgress)
         {
-            if( psOptions->nLayerTransaction &&
-                ++nFeaturesInTransaction == psOptions->nGroupTransactions )
-            {
-                if( poDstLayer->CommitTransaction() != OGRERR_NONE ||
-                    poDstLayer->StartTransaction() != OGRERR_NONE )
-                {
-                    OGRFeature::DestroyFeature( poFeature );
-                    return false;
-                }
-                nFeaturesInTransaction = 0;
-            }
-            else if( !psOptions->nLayerTransaction &&
-                     psOptions->nGroupTransactions >= 0 &&
-                     ++nTotalEventsDone >= psOptions->nGroupTransactions )
-            {
-                if( m_poODS->CommitTransaction() != OGRERR_NONE ||
-                        m_poODS->StartTransaction(psOptions->bForceTransaction) != OGRERR_NONE )
-                {
-                    OGRFeature::DestroyFeature( poFeature );
-                    return false;
-                }
-                nTotalEventsDone = 0;
-            }
+            bGoOn = pfnProgress(nCount * 1.0 / nCountLayerFeatures, "", pProgressArg) != FALSE;
+        }
+        if( !bGoOn )
+        {
+            bRet = false;
+            break;
+        }
 
-            CPLErrorReset();
-            poDstFeature = OGRFeature::CreateFeature( poDstLayer->GetLayerDefn() );
+        if (pnReadFeatureCount)
+            *pnReadFeatureCount = nCount;
 
-            /* Optimization to avoid duplicating the source geometry in the */
-            /* target feature : we steal it from the source feature for now... */
-            OGRGeometry* poStolenGeometry = NULL;
-            if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
-                nDstGeomFieldCount == 1 )
-            {
-                poStolenGeometry = poFeature->StealGeometry();
-            }
-            else if( !bExplodeCollections &&
-                     psInfo->iRequestedSrcGeomField >= 0 )
-            {
-                poStolenGeometry = poFeature->StealGeometry(
-                    psInfo->iRequestedSrcGeomField);
-            }
+        if( psOptions->nFIDToFetch != OGRNullFID )
+            break;
+        if( poFeatureIn != NULL )
+            break;
+    }
 
-            if( poDstFeature->SetFrom( poFeature, panMap, TRUE ) != OGRERR_NONE )
-            {
-                if( psOptions->nGroupTransactions )
-                {
-                    if( psOptions->nLayerTransaction )
-                    {
-                        if( poDstLayer->CommitTransaction() != OGRERR_NONE )
-                        {
-                            OGRFeature::DestroyFeature( poFeature );
-                            OGRFeature::DestroyFeature( poDstFeature );
-                            OGRGeometryFactory::destroyGeometry( poStolenGeometry );
-                            return false;
-                        }
-                    }
-                }
+    if( psOptions->nGroupTransactions )
+    {
+        if( psOptions->nLayerTransaction )
+        {
+            if( poDstLayer->CommitTransaction() != OGRERR_NONE )
+                bRet = false;
+        }
+    }
 
-                CPLError( CE_Failure, CPLE_AppDefined,
-                        "Unable to translate feature " CPL_FRMT_GIB " from layer %s.",
-                        poFeature->GetFID(), poSrcLayer->GetName() );
+    if( poFeatureIn == NULL )
+    {
+        CPLDebug("GDALVectorTranslate", CPL_FRMT_GIB " features written in layer '%s'",
+                nFeaturesWritten, poDstLayer->GetName());
+    }
 
-                OGRFeature::DestroyFeature( poFeature );
-                OGRFeature::DestroyFeature( poDstFeature );
-                OGRGeometryFactory::destroyGeometry( poStolenGeometry );
-                return false;
-            }
+    return bRet;
+}
 
-            /* ... and now we can attach the stolen geometry */
-            if( poStolenGeometry )
-            {
-                poDstFeature->SetGeometryDirectly(poStolenGeometry);
-            }
+/************************************************************************/
+/*                      Multi-threaded translation                      */
+/*                                                                      */
+/*      A reader thread fetches source features by batches and queues   */
+/*      them. Each queued batch is transformed by a job of a worker     */
+/*      thread pool, and the calling thread writes the batches in the   */
+/*      order they were read, once they are transformed.                */
+/************************************************************************/
 
-            if( bPreserveFID )
-                poDstFeature->SetFID( poFeature->GetFID() );
-            else if( psInfo->iSrcFIDField >= 0 &&
-                     poFeature->IsFieldSet(psInfo->iSrcFIDField))
-                poDstFeature->SetFID( poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField) );
+#define TRANSLATE_BATCH_SIZE 256
 
-            /* Erase native data if asked explicitly */
-            if( !m_bNativeData )
-            {
-                poDstFeature->SetNativeData(NULL);
-                poDstFeature->SetNativeMediaType(NULL);
-            }
+typedef struct LayerTranslatorThreadContext LayerTranslatorThreadContext;
 
-            for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
-            {
-                OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
-                if (poDstGeometry == NULL)
-                    continue;
+class LayerTranslatorError
+{
+    public:
+        LayerTranslatorError( CPLErr eErrIn, CPLErrorNum nErrNoIn,
+                              const CPLString& osMsgIn ) :
+                eErr(eErrIn), nErrNo(nErrNoIn), osErrorMsg(osMsgIn) {}
+
+        CPLErr      eErr;
+        CPLErrorNum nErrNo;
+        CPLString   osErrorMsg;
+};
 
-                if (nParts > 0)
-                {
-                    /* For -explodecollections, extract the iPart(th) of the geometry */
-                    OGRGeometry* poPart = ((OGRGeometryCollection*)poDstGeometry)->getGeometryRef(iPart);
-                    ((OGRGeometryCollection*)poDstGeometry)->removeGeometry(iPart, FALSE);
-                    delete poDstGeometry;
-                    poDstGeometry = poPart;
-                }
+typedef struct
+{
+    LayerTranslatorThreadContext *psContext;
+    std::vector<OGRFeature*>      apoSrcFeatures;
+    /* One entry per part of each source feature */
+    std::vector<OGRFeature*>      apoDstFeatures;
+    std::vector<int>              aeStatus;
+    /* Index in aoErrors past the last error emitted by the part */
+    std::vector<size_t>           anErrorsEnd;
+    /* Errors emitted while transforming the batch, in feature order */
+    std::vector<LayerTranslatorError> aoErrors;
+    bool                          bClaimed;
+    bool                          bDone;
+} LayerTranslatorBatch;
+
+struct LayerTranslatorThreadContext
+{
+    LayerTranslator              *poTranslator;
+    TargetLayerInfo              *psInfo;
+    OGRFeatureDefn               *poDstDefn;
+    OGRSpatialReference          *poOutputSRS;
+    bool                          bExplodeCollections;
+    bool                          bSkipFailures;
+    CPLWorkerThreadPool          *poPool;
+
+    CPLMutex                     *hMutex;
+    CPLCond                      *hCond;
+    std::deque<LayerTranslatorBatch*> apoBatches; /* in reading order */
+    size_t                        nMaxBatches;
+    bool                          bReaderFinished;
+    bool                          bStop;
+
+    /* Coordinate transformations not currently used by a job */
+    std::vector<OGRCoordinateTransformation**> apapoFreeCT;
+};
 
-                if (iSrcZField != -1)
-                {
-                    SetZ(poDstGeometry, poFeature->GetFieldAsDouble(iSrcZField));
-                    /* This will correct the coordinate dimension to 3 */
-                    OGRGeometry* poDupGeometry = poDstGeometry->clone();
-                    delete poDstGeometry;
-                    poDstGeometry = poDupGeometry;
-                }
+/************************************************************************/
+/*                    LayerTranslatorErrorHandler()                     */
+/************************************************************************/
 
-                if (m_nCoordDim == 2 || m_nCoordDim == 3)
-                    poDstGeometry->setCoordinateDimension( m_nCoordDim );
-                else if (m_nCoordDim == 4)
-                {
-                    poDstGeometry->set3D( TRUE );
-                    poDstGeometry->setMeasured( TRUE );
-                }
-                else if (m_nCoordDim == COORD_DIM_XYM)
-                {
-                    poDstGeometry->set3D( FALSE );
-                    poDstGeometry->setMeasured( TRUE );
-                }
-                else if ( m_nCoordDim == COORD_DIM_LAYER_DIM )
-                {
-                    const OGRwkbGeometryType eDstLayerGeomType =
-                      poDstLayer->GetLayerDefn()->GetGeomFieldDefn(iGeom)->GetType();
-                    poDstGeometry->set3D( wkbHasZ(eDstLayerGeomType) );
-                    poDstGeometry->setMeasured( wkbHasM(eDstLayerGeomType) );
-                }
+/* Collect the errors of a worker thread, so that the writer thread can */
+/* emit them again, with the error handler installed by the caller, */
+/* before writing the feature they relate to. */
+static void CPL_STDCALL LayerTranslatorErrorHandler( CPLErr eErr,
+                                                     CPLErrorNum nErrNo,
+                                                     const char* pszErrorMsg )
+{
+    if( eErr == CE_Debug )
+    {
+        CPLDefaultErrorHandler(eErr, nErrNo, pszErrorMsg);
+        return;
+    }
+    LayerTranslatorBatch* psBatch =
+        static_cast<LayerTranslatorBatch*>(CPLGetErrorHandlerUserData());
+    psBatch->aoErrors.push_back(
+        LayerTranslatorError(eErr, nErrNo, pszErrorMsg));
+}
 
-                if (m_eGeomOp == GEOMOP_SEGMENTIZE)
-                {
-                    if (m_dfGeomOpParam > 0)
-                        poDstGeometry->segmentize(m_dfGeomOpParam);
-                }
-                else if (m_eGeomOp == GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY)
-                {
-                    if (m_dfGeomOpParam > 0)
-                    {
-                        OGRGeometry* poNewGeom = poDstGeometry->SimplifyPreserveTopology(m_dfGeomOpParam);
-                        if (poNewGeom)
-                        {
-                            delete poDstGeometry;
-                            poDstGeometry = poNewGeom;
-                        }
-                    }
-                }
+/************************************************************************/
+/*                     LayerTranslatorTransformJob()                    */
+/************************************************************************/
 
-                if (m_poClipSrc)
-                {
-                    OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipSrc);
-                    delete poDstGeometry;
-                    if (poClipped == NULL || poClipped->IsEmpty())
-                    {
-                        delete poClipped;
-                        goto end_loop;
-                    }
-                    poDstGeometry = poClipped;
-                }
+/* Transform the oldest batch not yet taken by another job. */
+static void LayerTranslatorTransformJob( void* pData )
+{
+    LayerTranslatorThreadContext* psContext =
+        (LayerTranslatorThreadContext*) pData;
+    LayerTranslatorBatch* psBatch = NULL;
+    OGRCoordinateTransformation** papoCT = NULL;
 
-                OGRCoordinateTransformation* poCT = psInfo->papoCT[iGeom];
-                if( !m_bTransform )
-                    poCT = m_poGCPCoordTrans;
-                char** papszTransformOptions = psInfo->papapszTransformOptions[iGeom];
+    CPLAcquireMutex(psContext->hMutex, 1000.0);
+    for( size_t i = 0; i < psContext->apoBatches.size(); i++ )
+    {
+        if( !psContext->apoBatches[i]->bClaimed )
+        {
+            psBatch = psContext->apoBatches[i];
+            psBatch->bClaimed = true;
+            break;
+        }
+    }
+    CPLAssert( psBatch != NULL );
+    /* Only happens if the reader had to run a job itself */
+    while( psContext->apapoFreeCT.empty() )
+        CPLCondWait(psContext->hCond, psContext->hMutex);
+    papoCT = psContext->apapoFreeCT.back();
+    psContext->apapoFreeCT.pop_back();
+    CPLReleaseMutex(psContext->hMutex);
+
+    if( psBatch == NULL )
+        return;
 
-                if( poCT != NULL || papszTransformOptions != NULL)
-                {
-                    OGRGeometry* poReprojectedGeom =
-                        OGRGeometryFactory::transformWithOptions(poDstGeometry, poCT, papszTransformOptions);
-                    if( poReprojectedGeom == NULL )
-                    {
-                        if( psOptions->nGroupTransactions )
-                        {
-                            if( psOptions->nLayerTransaction )
-                            {
-                                if( poDstLayer->CommitTransaction() != OGRERR_NONE &&
-                                    !psOptions->bSkipFailures )
-                                {
-                                    OGRFeature::DestroyFeature( poFeature );
-                                    OGRFeature::DestroyFeature( poDstFeature );
-                                    delete poDstGeometry;
-                                    return false;
-                                }
-                            }
-                        }
+    CPLPushErrorHandlerEx(LayerTranslatorErrorHandler, psBatch);
+    for( size_t i = 0; i < psBatch->apoSrcFeatures.size(); i++ )
+    {
+        OGRFeature* poFeature = psBatch->apoSrcFeatures[i];
+        int nParts = 0;
+        const int nIters = GetPartCount(poFeature, psContext->psInfo,
+                                        psContext->bExplodeCollections,
+                                        &nParts);
+        for( int iPart = 0; iPart < nIters; iPart++ )
+        {
+            OGRFeature* poDstFeature = NULL;
+            const int eStatus = psContext->poTranslator->TransformFeature(
+                poFeature, iPart, nParts, psContext->psInfo,
+                psContext->poDstDefn, papoCT, psContext->poOutputSRS,
+                psContext->bSkipFailures, &poDstFeature );
+            psBatch->apoDstFeatures.push_back(poDstFeature);
+            psBatch->aeStatus.push_back(eStatus);
+            psBatch->anErrorsEnd.push_back(psBatch->aoErrors.size());
+        }
+    }
+    CPLPopErrorHandler();
 
-                        CPLError( CE_Failure, CPLE_AppDefined, "Failed to reproject feature " CPL_FRMT_GIB " (geometry probably out of source or destination SRS).",
-                                  poFeature->GetFID() );
-                        if( !psOptions->bSkipFailures )
-                        {
-                            OGRFeature::DestroyFeature( poFeature );
-                            OGRFeature::DestroyFeature( poDstFeature );
-                            delete poDstGeometry;
-                            return false;
-                        }
-                    }
+    CPLAcquireMutex(psContext->hMutex, 1000.0);
+    psContext->apapoFreeCT.push_back(papoCT);
+    psBatch->bDone = true;
+    CPLCondBroadcast(psContext->hCond);
+    CPLReleaseMutex(psContext->hMutex);
+}
 
-                    delete poDstGeometry;
-                    poDstGeometry = poReprojectedGeom;
-                }
-                else if (poOutputSRS != NULL)
-                {
-                    poDstGeometry->assignSpatialReference(poOutputSRS);
-                }
+/************************************************************************/
+/*                     LayerTranslatorReaderThread()                    */
+/************************************************************************/
 
-                if (m_poClipDst)
-                {
-                    if( poDstGeometry == NULL )
-                        goto end_loop;
+static void LayerTranslatorReaderThread( void* pData )
+{
+    LayerTranslatorThreadContext* psContext =
+        (LayerTranslatorThreadContext*) pData;
+    OGRLayer* poSrcLayer = psContext->psInfo->poSrcLayer;
 
-                    OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipDst);
-                    delete poDstGeometry;
-                    if (poClipped == NULL || poClipped->IsEmpty())
-                    {
-                        delete poClipped;
-                        goto end_loop;
-                    }
+    while( true )
+    {
+        /* Wait for the writer to catch up */
+        CPLAcquireMutex(psContext->hMutex, 1000.0);
+        while( !psContext->bStop &&
+               psContext->apoBatches.size() >= psContext->nMaxBatches )
+        {
+            CPLCondWait(psContext->hCond, psContext->hMutex);
+        }
+        const bool bStop = psContext->bStop;
+        CPLReleaseMutex(psContext->hMutex);
+        if( bStop )
+            break;
 
-                    poDstGeometry = poClipped;
-                }
+        LayerTranslatorBatch* psBatch = new LayerTranslatorBatch;
+        psBatch->psContext = psContext;
+        psBatch->bClaimed = false;
+        psBatch->bDone = false;
+        psBatch->apoSrcFeatures.reserve(TRANSLATE_BATCH_SIZE);
+        while( psBatch->apoSrcFeatures.size() < TRANSLATE_BATCH_SIZE )
+        {
+            OGRFeature* poFeature = poSrcLayer->GetNextFeature();
+            if( poFeature == NULL )
+                break;
+            psBatch->apoSrcFeatures.push_back(poFeature);
+        }
+        if( psBatch->apoSrcFeatures.empty() )
+        {
+            delete psBatch;
+            break;
+        }
+        psContext->psInfo->nFeaturesRead +=
+            static_cast<GIntBig>(psBatch->apoSrcFeatures.size());
 
-                if( eGType != GEOMTYPE_UNCHANGED )
-                {
-                    poDstGeometry = OGRGeometryFactory::forceTo(
-                            poDstGeometry, (OGRwkbGeometryType)eGType);
-                }
-                else if( m_eGeomTypeConversion == GTC_PROMOTE_TO_MULTI ||
-                         m_eGeomTypeConversion == GTC_CONVERT_TO_LINEAR ||
-                         m_eGeomTypeConversion == GTC_CONVERT_TO_CURVE )
-                {
-                    if( poDstGeometry != NULL )
-                    {
-                        OGRwkbGeometryType eTargetType = poDstGeometry->getGeometryType();
-                        eTargetType = ConvertType(m_eGeomTypeConversion, eTargetType);
-                        poDstGeometry = OGRGeometryFactory::forceTo(poDstGeometry, eTargetType);
-                    }
-                }
+        CPLAcquireMutex(psContext->hMutex, 1000.0);
+        psContext->apoBatches.push_back(psBatch);
+        CPLCondBroadcast(psContext->hCond);
+        CPLReleaseMutex(psContext->hMutex);
 
-                poDstFeature->SetGeomFieldDirectly(iGeom, poDstGeometry);
-            }
+        if( !psContext->poPool->SubmitJob(LayerTranslatorTransformJob,
+                                          psContext) )
+        {
+            LayerTranslatorTransformJob(psContext);
+        }
+    }
 
-            CPLErrorReset();
-            if( poDstLayer->CreateFeature( poDstFeature ) == OGRERR_NONE )
-            {
-                nFeaturesWritten ++;
-                if( (bPreserveFID && poDstFeature->GetFID() != poFeature->GetFID()) ||
-                    (!bPreserveFID && psInfo->iSrcFIDField >= 0 && poFeature->IsFieldSet(psInfo->iSrcFIDField) &&
-                     poDstFeature->GetFID() != poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField)) )
-                {
-                    CPLError( CE_Warning, CPLE_AppDefined,
-                              "Feature id not preserved");
-                }
-            }
-            else if( !psOptions->bSkipFailures )
-            {
-                if( psOptions->nGroupTransactions )
-                {
-                    if( psOptions->nLayerTransaction )
-                        poDstLayer->RollbackTransaction();
-                }
+    CPLAcquireMutex(psContext->hMutex, 1000.0);
+    psContext->bReaderFinished = true;
+    CPLCondBroadcast(psContext->hCond);
+    CPLReleaseMutex(psContext->hMutex);
+}
 
-                CPLError( CE_Failure, CPLE_AppDefined,
-                        "Unable to write feature " CPL_FRMT_GIB " from layer %s.",
-                        poFeature->GetFID(), poSrcLayer->GetName() );
+/************************************************************************/
+/*               LayerTranslator::TranslateMultiThreaded()              */
+/************************************************************************/
 
-                OGRFeature::DestroyFeature( poFeature );
-                OGRFeature::DestroyFeature( poDstFeature );
-                return false;
-            }
-            else
+/* Translate the remaining features of the source layer, once the first */
+/* one has been translated by Translate(). Returns false if the */
+/* translation must be stopped without committing the current */
+/* transaction, and sets bInterrupted if it was cancelled by the */
+/* progress function. */
+bool LayerTranslator::TranslateMultiThreaded( TargetLayerInfo* psInfo,
+                                              OGRFeatureDefn* poDstDefn,
+                                              OGRSpatialReference* poOutputSRS,
+                                              bool bExplodeCollections,
+                                              GIntBig nCountLayerFeatures,
+                                              GIntBig* pnReadFeatureCount,
+                                              GIntBig& nCount,
+                                              int& nFeaturesInTransaction,
+                                              GIntBig& nTotalEventsDone,
+                                              GIntBig& nFeaturesWritten,
+                                              bool& bInterrupted,
+                                              GDALProgressFunc pfnProgress,
+                                              void *pProgressArg,
+                                              GDALVectorTranslateOptions *psOptions )
+{
+    const int nThreads = psOptions->nThreads;
+    const int nDstGeomFieldCount = poDstDefn->GetGeomFieldCount();
+    bool bRet = true;
+
+/* -------------------------------------------------------------------- */
+/*      Coordinate transformations are not thread-safe, so each         */
+/*      concurrent job needs its own ones.                              */
+/* -------------------------------------------------------------------- */
+    LayerTranslatorThreadContext sContext;
+    for( int i = 0; i < nThreads; i++ )
+    {
+        OGRCoordinateTransformation** papoCT =
+            (OGRCoordinateTransformation**)
+                CPLCalloc(sizeof(OGRCoordinateTransformation*),
+                          nDstGeomFieldCount);
+        sContext.apapoFreeCT.push_back(papoCT);
+        for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom++ )
+        {
+            OGRCoordinateTransformation* poCT = psInfo->papoCT[iGeom];
+            if( poCT == NULL )
+                continue;
+            papoCT[iGeom] = OGRCreateCoordinateTransformation(
+                                poCT->GetSourceCS(), poCT->GetTargetCS() );
+            if( papoCT[iGeom] == NULL )
+                bRet = false;
+        }
+    }
+
+    CPLWorkerThreadPool oPool;
+    if( bRet )
+        bRet = oPool.Setup(nThreads, NULL, NULL);
+
+    sContext.poTranslator = this;
+    sContext.psInfo = psInfo;
+    sContext.poDstDefn = poDstDefn;
+    sContext.poOutputSRS = poOutputSRS;
+    sContext.bExplodeCollections = bExplodeCollections;
+    sContext.bSkipFailures = psOptions->bSkipFailures;
+    sContext.poPool = &oPool;
+    sContext.hMutex = CPLCreateMutex();
+    CPLReleaseMutex(sContext.hMutex);
+    sContext.hCond = CPLCreateCond();
+    sContext.nMaxBatches = 2 * nThreads;
+    sContext.bReaderFinished = false;
+    sContext.bStop = false;
+
+    CPLJoinableThread* hReaderThread = NULL;
+    if( bRet )
+    {
+        hReaderThread =
+            CPLCreateJoinableThread(LayerTranslatorReaderThread, &sContext);
+        bRet = (hReaderThread != NULL);
+    }
+    if( !bRet )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Cannot initialize multi-threaded translation of layer %s.",
+                  psInfo->poSrcLayer->GetName() );
+    }
+    else
+    {
+        CPLDebug("GDALVectorTranslate",
+                 "Translating layer %s with %d threads",
+                 psInfo->poSrcLayer->GetName(), nThreads);
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Write batches in order.                                         */
+/* -------------------------------------------------------------------- */
+    while( bRet )
+    {
+        CPLAcquireMutex(sContext.hMutex, 1000.0);
+        while( (sContext.apoBatches.empty() && !sContext.bReaderFinished) ||
+               (!sContext.apoBatches.empty() &&
+                !sContext.apoBatches.front()->bDone) )
+        {
+            CPLCondWait(sContext.hCond, sContext.hMutex);
+        }
+        LayerTranslatorBatch* psBatch = NULL;
+        if( !sContext.apoBatches.empty() )
+        {
+            psBatch = sContext.apoBatches.front();
+            sContext.apoBatches.pop_front();
+            CPLCondBroadcast(sContext.hCond);
+        }
+        CPLReleaseMutex(sContext.hMutex);
+        if( psBatch == NULL )
+            break;
+
+        size_t iDst = 0;
+        for( size_t i = 0; i < psBatch->apoSrcFeatures.size(); i++ )
+        {
+            OGRFeature* poFeature = psBatch->apoSrcFeatures[i];
+            int nParts = 0;
+            const int nIters = GetPartCount(poFeature, psInfo,
+                                            bExplodeCollections, &nParts);
+            for( int iPart = 0; iPart < nIters; iPart++, iDst++ )
             {
-                CPLDebug( "GDALVectorTranslate", "Unable to write feature " CPL_FRMT_GIB " into layer %s.",
-                           poFeature->GetFID(), poSrcLayer->GetName() );
-                if( psOptions->nGroupTransactions )
+                if( bRet && !bInterrupted )
                 {
-                    if( psOptions->nLayerTransaction )
+                    const size_t iFirstError =
+                        iDst == 0 ? 0 : psBatch->anErrorsEnd[iDst - 1];
+                    for( size_t iErr = iFirstError;
+                         iErr < psBatch->anErrorsEnd[iDst]; iErr++ )
                     {
-                        poDstLayer->RollbackTransaction();
-                        CPL_IGNORE_RET_VAL(poDstLayer->StartTransaction());
+                        const LayerTranslatorError& oError =
+                            psBatch->aoErrors[iErr];
+                        CPLError( oError.eErr, oError.nErrNo, "%s",
+                                  oError.osErrorMsg.c_str() );
                     }
-                    else
+                    if( !WriteFeature( poFeature,
+                                       psBatch->apoDstFeatures[iDst],
+                                       psBatch->aeStatus[iDst], psInfo,
+                                       nFeaturesInTransaction,
+                                       nTotalEventsDone, nFeaturesWritten,
+                                       psOptions ) )
                     {
-                        m_poODS->RollbackTransaction();
-                        m_poODS->StartTransaction(psOptions->bForceTransaction);
+                        bRet = false;
                     }
                 }
+                else
+                    OGRFeature::DestroyFeature( psBatch->apoDstFeatures[iDst] );
             }
 
-end_loop:
-            OGRFeature::DestroyFeature( poDstFeature );
-        }
-
-        OGRFeature::DestroyFeature( poFeature );
+            OGRFeature::DestroyFeature( poFeature );
+            if( !bRet || bInterrupted )
+                continue;
 
-        /* Report progress */
-        nCount ++;
-        bool bGoOn = true;
-        if (pfnProgress)
-        {
-            bGoOn = pfnProgress(nCount * 1.0 / nCountLayerFeatures, "", pProgressArg) != FALSE;
-        }
-        if( !bGoOn )
-        {
-            bRet = false;
-            break;
+            /* Report progress */
+            nCount ++;
+            if (pfnProgress &&
+                !pfnProgress(nCount * 1.0 / nCountLayerFeatures, "", pProgressArg) )
+            {
+                bInterrupted = true;
+            }
+            else if (pnReadFeatureCount)
+                *pnReadFeatureCount = nCount;
         }
+        delete psBatch;
 
-        if (pnReadFeatureCount)
-            *pnReadFeatureCount = nCount;
-
-        if( psOptions->nFIDToFetch != OGRNullFID )
-            break;
-        if( poFeatureIn != NULL )
+        if( bInterrupted )
             break;
     }
 
-    if( psOptions->nGroupTransactions )
+/* -------------------------------------------------------------------- */
+/*      Stop the reader and wait for pending jobs before cleaning up.   */
+/* -------------------------------------------------------------------- */
+    CPLAcquireMutex(sContext.hMutex, 1000.0);
+    sContext.bStop = true;
+    CPLCondBroadcast(sContext.hCond);
+    CPLReleaseMutex(sContext.hMutex);
+    if( hReaderThread != NULL )
+        CPLJoinThread(hReaderThread);
+    oPool.WaitCompletion();
+
+    for( size_t i = 0; i < sContext.apoBatches.size(); i++ )
     {
-        if( psOptions->nLayerTransaction )
-        {
-            if( poDstLayer->CommitTransaction() != OGRERR_NONE )
-                bRet = false;
-        }
+        LayerTranslatorBatch* psBatch = sContext.apoBatches[i];
+        for( size_t j = 0; j < psBatch->apoSrcFeatures.size(); j++ )
+            OGRFeature::DestroyFeature( psBatch->apoSrcFeatures[j] );
+        for( size_t j = 0; j < psBatch->apoDstFeatures.size(); j++ )
+            OGRFeature::DestroyFeature( psBatch->apoDstFeatures[j] );
+        delete psBatch;
     }
 
-    if( poFeatureIn == NULL )
+    for( size_t i = 0; i < sContext.apapoFreeCT.size(); i++ )
     {
-        CPLDebug("GDALVectorTranslate", CPL_FRMT_GIB " features written in layer '%s'",
-                nFeaturesWritten, poDstLayer->GetName());
+        OGRCoordinateTransformation** papoCT = sContext.apapoFreeCT[i];
+        for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom++ )
+            delete papoCT[iGeom];
+        CPLFree(papoCT);
     }
+    CPLDestroyCond(sContext.hCond);
+    CPLDestroyMutex(sContext.hMutex);
 
     return bRet;
 }
@@ -3995,6 +4612,7 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
     psOptions->nTransformOrder = 0;  /* Default to 0 for now... let the lib decide */
     psOptions->hSpatialFilter = NULL;
     psOptions->bNativeData = true;
+    psOptions->nThreads = 0;
 
     int nArgc = CSLCount(papszArgv);
     for( int i = 0; i < nArgc; i++ )
@@ -4567,6 +5185,14 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
         {
             psOptions->bNativeData = false;
         }
+        else if( EQUAL(papszArgv[i],"-threads") && i+1 < nArgc )
+        {
+            ++i;
+            if( EQUAL(papszArgv[i], "ALL_CPUS") )
+                psOptions->nThreads = CPLGetNumCPUs();
+            else
+                psOptions->nThreads = atoi(papszArgv[i]);
+        }
         else if( EQUAL(papszArgv[i],"-mo") && i+1 < nArgc )
         {
             psOptions->papszMetadataOptions = CSLAddString( psOptions->papszMetadataOptions,
@@ -1183,6 +1183,35 @@ static const char* GetLayerNameForSQL( GDALDataset* poDS, const char* pszLayerNa
     return CPLSPrintf("\"%s\"", pszLayerName);
 }
 
+/************************************************************************/
+/*                         FeaturePoolingHolder                         */
+/*                                                                      */
+/*      Enables feature pooling on a layer for the lifetime of the      */
+/*      object, and restores its previous state on all exit paths.      */
+/************************************************************************/
+
+class FeaturePoolingHolder
+{
+    OGRLayer *poLayer;
+    int       bWasEnabled;
+
+    FeaturePoolingHolder( const FeaturePoolingHolder& );
+    FeaturePoolingHolder& operator=( const FeaturePoolingHolder& );
+
+  public:
+    explicit FeaturePoolingHolder( OGRLayer *poLayerIn ) :
+        poLayer(poLayerIn),
+        bWasEnabled(LOG_ACTION(poLayerIn->GetFeaturePooling()))
+    {
+        LOG_ACTION(poLayer->SetFeaturePooling(TRUE));
+    }
+
+    ~FeaturePoolingHolder()
+    {
+        LOG_ACTION(poLayer->SetFeaturePooling(bWasEnabled));
+    }
+};
+
 /************************************************************************/
 /*                      TestOGRLayerFeatureCount()                      */
 /*                                                                      */
@@ -1200,6 +1229,9 @@ static int TestOGRLayerFeatureCount( GDALDataset* poDS, OGRLayer *poLayer, int b
     OGRFeatureDefn* poLayerDefn = LOG_ACTION(poLayer->GetLayerDefn());
     int nGeomFieldCount = LOG_ACTION(poLayerDefn->GetGeomFieldCount());
 
+    // Each feature is destroyed before the next one is read, so exercise
+    // feature pooling for drivers that support it.
+    FeaturePoolingHolder oPoolingHolder(poLayer);
     poLayer->ResetReading();
     CPLErrorReset();
 
@@ -70,6 +70,12 @@
 #include <mutex>
 #endif
 
+// TIFFReadFromUserBuffer() is needed for multi-threaded decoding.
+#if defined(INTERNAL_LIBTIFF) || \
+    (defined(TIFFLIB_VERSION) && TIFFLIB_VERSION >= 20181110)
+#define SUPPORTS_MT_DECODING 1
+#endif
+
 
 CPL_CVSID("$Id$");
 
@@ -206,6 +212,21 @@ typedef struct
     bool          bReady;
 } GTiffCompressionJob;
 
+typedef struct
+{
+    GTiffDataset *poDS;
+    int           nBlockId;
+    GByte        *pabyCompressedData;
+    size_t        nCompressedSize;
+    int           nBlockBufSize;
+    int           nBlockReqSize;
+    // Either the block cache data of the single band, or a temporary buffer
+    // to deinterleave in papabyBandData[] for pixel-interleaved datasets.
+    GByte        *pabyDecodedData;
+    GByte       **papabyBandData;  // nBands entries, NULL if not needed.
+    bool          bSuccess;
+} GTiffDecompressionJob;
+
 class GTiffDataset CPL_FINAL : public GDALPamDataset
 {
     friend class GTiffBitmapBand;
@@ -422,6 +443,19 @@ class GTiffDataset CPL_FINAL : public GDALPamDataset
     bool           SubmitCompressionJob( int nStripOrTile, GByte* pabyData,
                                          int cc, int nHeight) ;
 
+    int            nDecompressionThreads;
+    CPLWorkerThreadPool *poDecompressThreadPool;
+    CPLMutex      *hDecompressTIFFHandlesMutex;
+    std::vector<TIFF*> ahDecompressTIFFHandles;
+    void           InitDecompressionThreads( char** papszOptions );
+    static void    ThreadDecompressionFunc( void* pData );
+    TIFF*          AcquireDecompressionTIFFHandle();
+    void           ReleaseDecompressionTIFFHandle( TIFF* hTIFFTmp );
+    bool           IsMultiThreadedDecodingCompatible();
+    void           CacheBlocksMultiThreaded( int nXOff, int nYOff,
+                                             int nXSize, int nYSize,
+                                             int nBandCount, int *panBandMap );
+
     int            GuessJPEGQuality( bool& bOutHasQuantizationTable,
                                      bool& bOutHasHuffmanTable );
 
@@ -1966,6 +2000,420 @@ CPLVirtualMem* GTiffRasterBand::GetVirtualMemAutoInternal( GDALRWFlag eRWFlag,
     return pVMem;
 }
 
+/************************************************************************/
+/*                   IsMultiThreadedDecodingCompatible()                */
+/************************************************************************/
+
+// Returns whether all bands are regular GTiffRasterBand whose blocks can be
+// decoded with TIFFReadFromUserBuffer() outside of the main TIFF handle.
+bool GTiffDataset::IsMultiThreadedDecodingCompatible()
+{
+#ifdef SUPPORTS_MT_DECODING
+    if( eAccess != GA_ReadOnly || bStreamingIn ||
+        nCompression == COMPRESSION_NONE ||
+        nCompression == COMPRESSION_OJPEG ||
+        (nCompression == COMPRESSION_JPEG &&
+         nPhotometric == PHOTOMETRIC_YCBCR) ||
+        bTreatAsRGBA || bTreatAsSplit || bTreatAsSplitBitmap ||
+        bPromoteTo8Bits )
+    {
+        return false;
+    }
+    if( nSampleFormat == SAMPLEFORMAT_IEEEFP &&
+        (nBitsPerSample == 16 || nBitsPerSample == 24) )
+    {
+        return false;
+    }
+    return nBitsPerSample == 8 || nBitsPerSample == 16 ||
+           nBitsPerSample == 32 || nBitsPerSample == 64 ||
+           nBitsPerSample == 128;
+#else
+    return false;
+#endif
+}
+
+/************************************************************************/
+/*                   AcquireDecompressionTIFFHandle()                   */
+/************************************************************************/
+
+// Returns a TIFF handle, private to the caller until released, that is
+// positioned on our directory. Only used to decode blocks from memory.
+TIFF* GTiffDataset::AcquireDecompressionTIFFHandle()
+{
+    {
+        CPLMutexHolderD(&hDecompressTIFFHandlesMutex);
+        if( !ahDecompressTIFFHandles.empty() )
+        {
+            TIFF* hTIFFTmp = ahDecompressTIFFHandles.back();
+            ahDecompressTIFFHandles.pop_back();
+            return hTIFFTmp;
+        }
+    }
+
+    const CPLString& osBaseFilename =
+        poBaseDS != NULL ? poBaseDS->osFilename : osFilename;
+    if( osBaseFilename.empty() )
+        return NULL;
+    VSILFILE* fpTmp = VSIFOpenL(osBaseFilename, "rb");
+    if( fpTmp == NULL )
+        return NULL;
+    TIFF* hTIFFTmp = VSI_TIFFOpen(osBaseFilename, "r", fpTmp);
+    if( hTIFFTmp == NULL )
+    {
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fpTmp));
+        return NULL;
+    }
+    if( TIFFCurrentDirOffset(hTIFFTmp) != nDirOffset &&
+        !TIFFSetSubDirectory(hTIFFTmp, nDirOffset) )
+    {
+        XTIFFClose(hTIFFTmp);
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fpTmp));
+        return NULL;
+    }
+    return hTIFFTmp;
+}
+
+/************************************************************************/
+/*                   ReleaseDecompressionTIFFHandle()                   */
+/************************************************************************/
+
+void GTiffDataset::ReleaseDecompressionTIFFHandle( TIFF* hTIFFTmp )
+{
+    CPLMutexHolderD(&hDecompressTIFFHandlesMutex);
+    ahDecompressTIFFHandles.push_back(hTIFFTmp);
+}
+
+/************************************************************************/
+/*                      ThreadDecompressionFunc()                       */
+/************************************************************************/
+
+void GTiffDataset::ThreadDecompressionFunc( void* pData )
+{
+    GTiffDecompressionJob* psJob = static_cast<GTiffDecompressionJob *>(pData);
+    GTiffDataset* poDS = psJob->poDS;
+
+#ifdef SUPPORTS_MT_DECODING
+    TIFF* hTIFFTmp = poDS->AcquireDecompressionTIFFHandle();
+    if( hTIFFTmp == NULL )
+        return;
+
+    // Errors are not reported from here: blocks that fail to decode are
+    // not cached, and will be read again, with error reporting, by the
+    // regular IReadBlock() path.
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    if( psJob->nBlockReqSize < psJob->nBlockBufSize )
+        memset( psJob->pabyDecodedData, 0, psJob->nBlockBufSize );
+    psJob->bSuccess =
+        TIFFReadFromUserBuffer( hTIFFTmp, psJob->nBlockId,
+                                psJob->pabyCompressedData,
+                                psJob->nCompressedSize,
+                                psJob->pabyDecodedData,
+                                psJob->nBlockReqSize ) != 0;
+    CPLPopErrorHandler();
+
+    poDS->ReleaseDecompressionTIFFHandle(hTIFFTmp);
+#endif
+
+    if( psJob->bSuccess && psJob->papabyBandData != NULL )
+    {
+        const GDALDataType eDT = poDS->GetRasterBand(1)->GetRasterDataType();
+        const int nWordBytes = poDS->nBitsPerSample / 8;
+        for( int iBand = 0; iBand < poDS->nBands; ++iBand )
+        {
+            if( psJob->papabyBandData[iBand] == NULL )
+                continue;
+            GDALCopyWords(psJob->pabyDecodedData + iBand * nWordBytes, eDT,
+                          poDS->nBands * nWordBytes,
+                          psJob->papabyBandData[iBand], eDT, nWordBytes,
+                          poDS->nBlockXSize * poDS->nBlockYSize);
+        }
+    }
+}
+
+/************************************************************************/
+/*                      CacheBlocksMultiThreaded()                      */
+/************************************************************************/
+
+// Loads in the block cache, by decoding them in parallel in a worker thread
+// pool, all the blocks intersecting the specified window that are not yet
+// cached. The compressed data of all those blocks is fetched first, from the
+// calling thread, with a single VSIFReadMultiRangeL() call. This does
+// nothing if NUM_THREADS is not set, or if the dataset is not eligible.
+void GTiffDataset::CacheBlocksMultiThreaded( int nXOff, int nYOff,
+                                             int nXSize, int nYSize,
+                                             int nBandCount, int *panBandMap )
+{
+    GTiffDataset* poBase = poBaseDS != NULL ? poBaseDS : this;
+    const int nThreads = poBase->nDecompressionThreads;
+    if( nThreads <= 1 || !IsMultiThreadedDecodingCompatible() )
+        return;
+
+    const int nBlockX1 = nXOff / nBlockXSize;
+    const int nBlockY1 = nYOff / nBlockYSize;
+    const int nBlockX2 = (nXOff + nXSize - 1) / nBlockXSize;
+    const int nBlockY2 = (nYOff + nYSize - 1) / nBlockYSize;
+    const int nXBlocks = nBlockX2 - nBlockX1 + 1;
+    const int nYBlocks = nBlockY2 - nBlockY1 + 1;
+    const bool bSeparate = nPlanarConfig == PLANARCONFIG_SEPARATE;
+    const int nBandsPerBlock = bSeparate ? 1 : nBands;
+    if( static_cast<GIntBig>(nXBlocks) * nYBlocks *
+            (bSeparate ? nBandCount : 1) < 2 )
+        return;
+
+    const GDALDataType eDT = GetRasterBand(1)->GetRasterDataType();
+    const int nBandBlockSize =
+        nBlockXSize * nBlockYSize * GDALGetDataTypeSizeBytes(eDT);
+    // Do not evict from the cache the blocks we are going to load.
+    const GIntBig nRequiredMem =
+        static_cast<GIntBig>(bSeparate ? nBandCount : nBands) *
+        nXBlocks * nYBlocks * nBandBlockSize;
+    if( nRequiredMem > GDALGetCacheMax64() / 2 )
+    {
+        CPLDebug( "GTiff",
+                  "Multi-threaded decoding not used: cache not big enough. "
+                  "At least " CPL_FRMT_GIB " bytes necessary",
+                  nRequiredMem * 2 );
+        return;
+    }
+
+    if( !SetDirectory() )
+        return;
+
+    const int nBlockBufSize = static_cast<int>(
+        TIFFIsTiled(hTIFF) ? TIFFTileSize(hTIFF) : TIFFStripSize(hTIFF));
+    const int nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
+
+/* -------------------------------------------------------------------- */
+/*      Lock the blocks that are not yet cached, and build jobs.        */
+/* -------------------------------------------------------------------- */
+    std::vector<GTiffDecompressionJob> asJobs;
+    std::vector<GDALRasterBlock*> apoBlocks;  // nBands entries per job.
+    std::vector<vsi_l_offset> anOffsets;
+    const int nSeparateBandCount = bSeparate ? nBandCount : 1;
+
+    for( int iY = nBlockY1; iY <= nBlockY2; ++iY )
+    {
+        for( int iX = nBlockX1; iX <= nBlockX2; ++iX )
+        {
+            for( int i = 0; i < nSeparateBandCount; ++i )
+            {
+                const int nBlockIdBand0 = iX + iY * nBlocksPerRow;
+                int nBlockId = nBlockIdBand0;
+                if( bSeparate )
+                    nBlockId += (panBandMap[i] - 1) * nBlocksPerBand;
+
+                const size_t nFirstBlockIdx = apoBlocks.size();
+                bool bHasMissingBlock = false;
+                for( int iBand = 0; iBand < nBands; ++iBand )
+                {
+                    GDALRasterBlock* poBlock = NULL;
+                    if( !bSeparate || iBand + 1 == panBandMap[i] )
+                    {
+                        GTiffRasterBand* poBand =
+                            reinterpret_cast<GTiffRasterBand *>(
+                                GetRasterBand(iBand + 1));
+                        poBlock = poBand->TryGetLockedBlockRef(iX, iY);
+                        if( poBlock != NULL )
+                        {
+                            poBlock->DropLock();
+                            poBlock = NULL;
+                        }
+                        else
+                        {
+                            poBlock = poBand->GetLockedBlockRef(iX, iY, TRUE);
+                            if( poBlock != NULL )
+                                bHasMissingBlock = true;
+                        }
+                    }
+                    apoBlocks.push_back(poBlock);
+                }
+                if( !bHasMissingBlock )
+                {
+                    apoBlocks.resize(nFirstBlockIdx);
+                    continue;
+                }
+
+                vsi_l_offset nOffset = 0;
+                vsi_l_offset nSize = 0;
+                const bool bAvailable =
+                    IsBlockAvailable(nBlockId, &nOffset, &nSize);
+                if( !bAvailable || nSize == 0 ||
+                    nSize > static_cast<vsi_l_offset>(INT_MAX) )
+                {
+                    for( int iBand = 0; iBand < nBands; ++iBand )
+                    {
+                        GDALRasterBlock* poBlock =
+                            apoBlocks[nFirstBlockIdx + iBand];
+                        if( poBlock == NULL )
+                            continue;
+                        if( !bAvailable )
+                        {
+                            // Sparse block.
+                            reinterpret_cast<GTiffRasterBand *>(
+                                GetRasterBand(iBand + 1))->
+                                    NullBlock(poBlock->GetDataRef());
+                            poBlock->DropLock();
+                        }
+                        else
+                        {
+                            poBlock->DropLock();
+                            GetRasterBand(iBand + 1)->FlushBlock(iX, iY,
+                                                                 FALSE);
+                        }
+                    }
+                    apoBlocks.resize(nFirstBlockIdx);
+                    continue;
+                }
+
+                GTiffDecompressionJob sJob;
+                memset(&sJob, 0, sizeof(sJob));
+                sJob.poDS = this;
+                sJob.nBlockId = nBlockId;
+                sJob.nCompressedSize = static_cast<size_t>(nSize);
+                sJob.nBlockBufSize = nBlockBufSize;
+                // The bottom most partial tiles and strips are sometimes
+                // only partially encoded (#1179).
+                sJob.nBlockReqSize = nBlockBufSize;
+                if( (iY + 1) * static_cast<int>(nBlockYSize) > nRasterYSize )
+                {
+                    sJob.nBlockReqSize = (nBlockBufSize / nBlockYSize) *
+                        (nBlockYSize -
+                         (((iY + 1) * nBlockYSize) % nRasterYSize));
+                }
+                asJobs.push_back(sJob);
+                anOffsets.push_back(nOffset);
+            }
+        }
+    }
+
+    if( asJobs.empty() )
+        return;
+
+/* -------------------------------------------------------------------- */
+/*      Allocate buffers and fetch the compressed data.                 */
+/* -------------------------------------------------------------------- */
+    const size_t nJobs = asJobs.size();
+    std::vector<GByte*> apabyBandData(nJobs * nBands, NULL);
+    std::vector<GByte*> apabyTempBuffers;
+    bool bOK = true;
+    for( size_t i = 0; i < nJobs && bOK; ++i )
+    {
+        GTiffDecompressionJob& sJob = asJobs[i];
+        sJob.pabyCompressedData = static_cast<GByte *>(
+            VSI_MALLOC_VERBOSE(sJob.nCompressedSize));
+        if( sJob.pabyCompressedData == NULL )
+        {
+            bOK = false;
+            break;
+        }
+        if( nBandsPerBlock == 1 )
+        {
+            for( int iBand = 0; iBand < nBands; ++iBand )
+            {
+                if( apoBlocks[i * nBands + iBand] != NULL )
+                {
+                    sJob.pabyDecodedData = static_cast<GByte *>(
+                        apoBlocks[i * nBands + iBand]->GetDataRef());
+                }
+            }
+        }
+        else
+        {
+            sJob.pabyDecodedData = static_cast<GByte *>(
+                VSI_MALLOC_VERBOSE(nBlockBufSize));
+            if( sJob.pabyDecodedData == NULL )
+            {
+                bOK = false;
+                break;
+            }
+            apabyTempBuffers.push_back(sJob.pabyDecodedData);
+            for( int iBand = 0; iBand < nBands; ++iBand )
+            {
+                if( apoBlocks[i * nBands + iBand] != NULL )
+                {
+                    apabyBandData[i * nBands + iBand] = static_cast<GByte *>(
+                        apoBlocks[i * nBands + iBand]->GetDataRef());
+                }
+            }
+            sJob.papabyBandData = &apabyBandData[i * nBands];
+        }
+    }
+
+    if( bOK )
+    {
+        // Sort ranges by increasing offset so that consecutive ranges can
+        // be merged by VSIFReadMultiRangeL() implementations.
+        std::vector<std::pair<vsi_l_offset, size_t> > aoRanges;
+        for( size_t i = 0; i < nJobs; ++i )
+            aoRanges.push_back(std::pair<vsi_l_offset, size_t>(anOffsets[i],
+                                                               i));
+        std::sort(aoRanges.begin(), aoRanges.end());
+        std::vector<void*> apData(nJobs);
+        std::vector<size_t> anSizes(nJobs);
+        std::vector<vsi_l_offset> anSortedOffsets(nJobs);
+        for( size_t i = 0; i < nJobs; ++i )
+        {
+            const GTiffDecompressionJob& sJob = asJobs[aoRanges[i].second];
+            apData[i] = sJob.pabyCompressedData;
+            anSizes[i] = sJob.nCompressedSize;
+            anSortedOffsets[i] = aoRanges[i].first;
+        }
+        VSILFILE* fp = VSI_TIFFGetVSILFile(TIFFClientdata( hTIFF ));
+        bOK = VSIFReadMultiRangeL( static_cast<int>(nJobs), &apData[0],
+                                   &anSortedOffsets[0], &anSizes[0],
+                                   fp ) == 0;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Decode in parallel.                                             */
+/* -------------------------------------------------------------------- */
+    if( bOK && poBase->poDecompressThreadPool == NULL )
+    {
+        CPLDebug("GTiff", "Using %d threads for decompression", nThreads);
+        poBase->poDecompressThreadPool = new CPLWorkerThreadPool();
+        if( !poBase->poDecompressThreadPool->Setup(nThreads, NULL, NULL) )
+        {
+            delete poBase->poDecompressThreadPool;
+            poBase->poDecompressThreadPool = NULL;
+            poBase->nDecompressionThreads = 0;
+            bOK = false;
+        }
+    }
+    if( bOK )
+    {
+        std::vector<void*> apJobs;
+        for( size_t i = 0; i < nJobs; ++i )
+            apJobs.push_back(&asJobs[i]);
+        poBase->poDecompressThreadPool->SubmitJobs(ThreadDecompressionFunc,
+                                                  apJobs);
+        poBase->poDecompressThreadPool->WaitCompletion();
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Release the blocks. Those that could not be decoded are         */
+/*      removed from the cache.                                         */
+/* -------------------------------------------------------------------- */
+    for( size_t i = 0; i < nJobs; ++i )
+    {
+        const GTiffDecompressionJob& sJob = asJobs[i];
+        const int nBlockIdBand0 = sJob.nBlockId % nBlocksPerBand;
+        const int iX = nBlockIdBand0 % nBlocksPerRow;
+        const int iY = nBlockIdBand0 / nBlocksPerRow;
+        for( int iBand = 0; iBand < nBands; ++iBand )
+        {
+            GDALRasterBlock* poBlock = apoBlocks[i * nBands + iBand];
+            if( poBlock == NULL )
+                continue;
+            poBlock->DropLock();
+            if( !sJob.bSuccess )
+                GetRasterBand(iBand + 1)->FlushBlock(iX, iY, FALSE);
+        }
+        VSIFree(sJob.pabyCompressedData);
+    }
+    for( size_t i = 0; i < apabyTempBuffers.size(); ++i )
+        VSIFree(apabyTempBuffers[i]);
+}
+
 /************************************************************************/
 /*                            IRasterIO()                               */
 /************************************************************************/
@@ -2021,6 +2469,12 @@ CPLErr GTiffDataset::IRasterIO( GDALRWFlag eRWFlag,
             return static_cast<CPLErr>(nErr);
     }
 
+    if( eRWFlag == GF_Read )
+    {
+        CacheBlocksMultiThreaded( nXOff, nYOff, nXSize, nYSize,
+                                  nBandCount, panBandMap );
+    }
+
     ++nJPEGOverviewVisibilityCounter;
     const CPLErr eErr =
         GDALPamDataset::IRasterIO(
@@ -3902,6 +4356,12 @@ CPLErr GTiffRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             return static_cast<CPLErr>(nErr);
     }
 
+    if( eRWFlag == GF_Read )
+    {
+        poGDS->CacheBlocksMultiThreaded( nXOff, nYOff, nXSize, nYSize,
+                                         1, &nBand );
+    }
+
     if( poGDS->nBands != 1 &&
         poGDS->nPlanarConfig == PLANARCONFIG_CONTIG &&
         eRWFlag == GF_Read &&
@@ -6807,6 +7267,9 @@ GTiffDataset::GTiffDataset() :
     bHasDiscardedLsb(false),
     poCompressThreadPool(NULL),
     hCompressThreadPoolMutex(NULL),
+    nDecompressionThreads(0),
+    poDecompressThreadPool(NULL),
+    hDecompressTIFFHandlesMutex(NULL),
     m_pTempBufferForCommonDirectIO(NULL),
     m_nTempBufferForCommonDirectIOSize(0),
     m_bReadGeoTransform(false),
@@ -6924,6 +7387,18 @@ int GTiffDataset::Finalize()
         CPLDestroyMutex(hCompressThreadPoolMutex);
     }
 
+    // Destroy decompression pool and the TIFF handles used by its jobs.
+    delete poDecompressThreadPool;
+    for( size_t i = 0; i < ahDecompressTIFFHandles.size(); ++i )
+    {
+        VSILFILE* fpTmp =
+            VSI_TIFFGetVSILFile(TIFFClientdata(ahDecompressTIFFHandles[i]));
+        XTIFFClose(ahDecompressTIFFHandles[i]);
+        CPL_IGNORE_RET_VAL(VSIFCloseL(fpTmp));
+    }
+    if( hDecompressTIFFHandlesMutex )
+        CPLDestroyMutex(hDecompressTIFFHandlesMutex);
+
 /* -------------------------------------------------------------------- */
 /*      If there is still changed metadata, then presumably we want     */
 /*      to push it into PAM.                                            */
@@ -7910,6 +8385,36 @@ void GTiffDataset::InitCompressionThreads( char** papszOptions )
     }
 }
 
+/************************************************************************/
+/*                       InitDecompressionThreads()                     */
+/************************************************************************/
+
+void GTiffDataset::InitDecompressionThreads( char** papszOptions )
+{
+    const char* pszValue = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszValue == NULL )
+        pszValue = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
+    if( pszValue == NULL )
+        return;
+
+    const int nThreads =
+        EQUAL(pszValue, "ALL_CPUS") ? CPLGetNumCPUs() : atoi(pszValue);
+    if( nThreads > 1 )
+    {
+        // The worker thread pool is only instantiated at the first read
+        // that can take advantage of it.
+        nDecompressionThreads = nThreads;
+    }
+    else if( nThreads < 0 ||
+             (!EQUAL(pszValue, "0") &&
+              !EQUAL(pszValue, "1") &&
+              !EQUAL(pszValue, "ALL_CPUS")) )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Invalid value for NUM_THREADS: %s", pszValue);
+    }
+}
+
 /************************************************************************/
 /*                       GetGTIFFKeysFlavor()                           */
 /************************************************************************/
@@ -11429,6 +11934,10 @@ GDALDataset *GTiffDataset::Open( GDALOpenInfo * poOpenInfo )
     {
         poDS->InitCreationOrOpenOptions(poOpenInfo->papszOpenOptions);
     }
+    else
+    {
+        poDS->InitDecompressionThreads(poOpenInfo->papszOpenOptions);
+    }
 
     if( l_nCompression == COMPRESSION_JPEG && poOpenInfo->eAccess == GA_Update )
     {
@@ -16219,10 +16728,20 @@ GTiffDataset::CreateCopy( const char * pszFilename, GDALDataset *poSrcDS,
     }
     else if( bTryCopy && eErr == CE_None )
     {
-        char* papszCopyWholeRasterOptions[3] = { NULL, NULL, NULL };
+        char* papszCopyWholeRasterOptions[4] = { NULL, NULL, NULL, NULL };
         int iNextOption = 0;
         papszCopyWholeRasterOptions[iNextOption++] =
                 const_cast<char *>( "SKIP_HOLES=YES" );
+        // Read the source in a background thread while we compress.
+        CPLString osNumThreads;
+        const char* pszNumThreads =
+            CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+        if( pszNumThreads != NULL )
+        {
+            osNumThreads.Printf("NUM_THREADS=%s", pszNumThreads);
+            papszCopyWholeRasterOptions[iNextOption++] =
+                const_cast<char *>( osNumThreads.c_str() );
+        }
         if( l_nCompression != COMPRESSION_NONE )
         {
             papszCopyWholeRasterOptions[iNextOption++] =
@@ -17513,7 +18032,7 @@ void GDALRegister_GTiff()
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, szCreateOptions );
     poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
 "<OpenOptionList>"
-"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression. Can be set to ALL_CPUS' default='1'/>"
+"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression (in update mode) or decompression (in read-only mode). Can be set to ALL_CPUS' default='1'/>"
 "   <Option name='GEOTIFF_KEYS_FLAVOR' type='string-select' default='STANDARD' description='Which flavor of GeoTIFF keys must be used (for writing)'>"
 "       <Value>STANDARD</Value>"
 "       <Value>ESRI_PE</Value>"
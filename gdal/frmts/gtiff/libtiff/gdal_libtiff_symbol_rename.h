@@ -503,6 +503,7 @@
 #define TIFFReadEncodedStrip gdal_TIFFReadEncodedStrip
 #define TIFFReadEncodedTile gdal_TIFFReadEncodedTile
 #define TIFFReadEXIFDirectory gdal_TIFFReadEXIFDirectory
+#define TIFFReadFromUserBuffer gdal_TIFFReadFromUserBuffer
 #define _tiffReadProc gdal__tiffReadProc
 #define TIFFReadRawStrip gdal_TIFFReadRawStrip
 #define TIFFReadRawStrip1 gdal_TIFFReadRawStrip1
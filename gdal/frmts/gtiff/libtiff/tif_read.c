@@ -1071,6 +1071,86 @@ TIFFStartTile(TIFF* tif, uint32 tile)
 			(uint16)(tile/td->td_stripsperimage)));
 }
 
+/*
+ * Decompress the strip or tile whose compressed content has been provided
+ * by the caller in inbuf, into outbuf. The TIFF handle state related to
+ * raw data buffering is saved and restored, so that this can be used on a
+ * handle dedicated to decoding, without any file I/O.
+ */
+int
+TIFFReadFromUserBuffer(TIFF* tif, uint32 strile,
+                       void* inbuf, tmsize_t insize,
+                       void* outbuf, tmsize_t outsize)
+{
+	static const char module[] = "TIFFReadFromUserBuffer";
+	TIFFDirectory *td = &tif->tif_dir;
+	int ret = 1;
+	uint32 old_tif_flags = tif->tif_flags;
+	tmsize_t old_rawdatasize = tif->tif_rawdatasize;
+	void* old_rawdata = tif->tif_rawdata;
+
+	if (tif->tif_mode == O_WRONLY) {
+		TIFFErrorExt(tif->tif_clientdata, tif->tif_name, "File not open for reading");
+		return 0;
+	}
+	if (tif->tif_flags&TIFF_NOREADRAW)
+	{
+		TIFFErrorExt(tif->tif_clientdata, module,
+		    "Compression scheme does not support access to raw uncompressed data");
+		return 0;
+	}
+
+	tif->tif_flags &= ~TIFF_MYBUFFER;
+	tif->tif_flags |= TIFF_BUFFERMMAP;
+	tif->tif_rawdatasize = insize;
+	tif->tif_rawdata = (uint8*) inbuf;
+	tif->tif_rawdataoff = 0;
+	tif->tif_rawdataloaded = insize;
+
+	if (!isFillOrder(tif, td->td_fillorder) &&
+	    (tif->tif_flags & TIFF_NOBITREV) == 0)
+	{
+		TIFFReverseBits((uint8*) inbuf, insize);
+	}
+
+	if (TIFFIsTiled(tif))
+	{
+		if (!TIFFStartTile(tif, strile) ||
+		    !(*tif->tif_decodetile)(tif, (uint8*) outbuf, outsize,
+		                            (uint16)(strile/td->td_stripsperimage)))
+		{
+			ret = 0;
+		}
+	}
+	else
+	{
+		if (!TIFFStartStrip(tif, strile) ||
+		    !(*tif->tif_decodestrip)(tif, (uint8*) outbuf, outsize,
+		                             (uint16)(strile/td->td_stripsperimage)))
+		{
+			ret = 0;
+		}
+	}
+	if (ret)
+	{
+		(*tif->tif_postdecode)(tif, (uint8*) outbuf, outsize);
+	}
+
+	if (!isFillOrder(tif, td->td_fillorder) &&
+	    (tif->tif_flags & TIFF_NOBITREV) == 0)
+	{
+		TIFFReverseBits((uint8*) inbuf, insize);
+	}
+
+	tif->tif_flags = old_tif_flags;
+	tif->tif_rawdatasize = old_rawdatasize;
+	tif->tif_rawdata = (uint8*) old_rawdata;
+	tif->tif_rawdataoff = 0;
+	tif->tif_rawdataloaded = 0;
+
+	return ret;
+}
+
 static int
 TIFFCheckRead(TIFF* tif, int tiles)
 {
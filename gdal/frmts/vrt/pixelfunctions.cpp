@@ -124,6 +124,219 @@ static CPLErr PowPixelFuncHelper( void **papoSources, int nSources, void *pData,
                                   int nPixelSpace, int nLineSpace,
                                   double base, double fact );
 
+/************************************************************************/
+/*                    Typed whole-buffer evaluation                     */
+/*                                                                      */
+/* For non-complex source types, the switch on eSrcType is done once    */
+/* per buffer rather than once per pixel (as SRCVAL does). The sources  */
+/* are then combined, one line at a time, by tight templated loops into */
+/* a contiguous array of doubles that is written to the output buffer   */
+/* with a single GDALCopyWords() call.                                  */
+/* Computations are done in double, as in the per-pixel code, so both   */
+/* paths produce identical results. The per-pixel code is still used    */
+/* for complex types and can be forced with                             */
+/* VRT_VECTORIZED_PIXEL_FUNCTIONS=NO (for benchmarking).                */
+/************************************************************************/
+
+namespace {
+
+// Each operation defines how the first source initializes the working
+// value, how subsequent sources are combined with it, and a final
+// transformation. The expressions are the ones of the per-pixel code.
+
+struct VRTSumOp
+{
+    double First( double dfVal ) const { return 0.0 + dfVal; }
+    double Combine( double dfAcc, double dfVal ) const
+        { return dfAcc + dfVal; }
+    double Finish( double dfAcc ) const { return dfAcc; }
+};
+
+struct VRTDiffOp
+{
+    double First( double dfVal ) const { return dfVal; }
+    double Combine( double dfAcc, double dfVal ) const
+        { return dfAcc - dfVal; }
+    double Finish( double dfAcc ) const { return dfAcc; }
+};
+
+struct VRTMulOp
+{
+    double First( double dfVal ) const { return 1.0 * dfVal; }
+    double Combine( double dfAcc, double dfVal ) const
+        { return dfAcc * dfVal; }
+    double Finish( double dfAcc ) const { return dfAcc; }
+};
+
+// Base for single source operations.
+struct VRTUnaryOp
+{
+    double First( double dfVal ) const { return dfVal; }
+    double Combine( double dfAcc, double /* dfVal */ ) const
+        { return dfAcc; }
+};
+
+struct VRTModOp : public VRTUnaryOp
+{
+    double Finish( double dfVal ) const { return fabs(dfVal); }
+};
+
+struct VRTPhaseOp : public VRTUnaryOp
+{
+    double Finish( double dfVal ) const { return (dfVal < 0) ? M_PI : 0.0; }
+};
+
+struct VRTInvOp : public VRTUnaryOp
+{
+    double Finish( double dfVal ) const { return 1.0 / dfVal; }
+};
+
+struct VRTIntensityOp : public VRTUnaryOp
+{
+    double Finish( double dfVal ) const { return dfVal * dfVal; }
+};
+
+struct VRTSqrtOp : public VRTUnaryOp
+{
+    double Finish( double dfVal ) const { return sqrt(dfVal); }
+};
+
+struct VRTLog10Op : public VRTUnaryOp
+{
+    double m_dfFact;
+    explicit VRTLog10Op( double dfFact ) : m_dfFact(dfFact) {}
+    double Finish( double dfVal ) const
+        { return m_dfFact * log10( fabs( dfVal ) ); }
+};
+
+struct VRTPowOp : public VRTUnaryOp
+{
+    double m_dfBase;
+    double m_dfFact;
+    VRTPowOp( double dfBase, double dfFact ) :
+        m_dfBase(dfBase), m_dfFact(dfFact) {}
+    double Finish( double dfVal ) const
+        { return pow(m_dfBase, dfVal / m_dfFact); }
+};
+
+}  // namespace
+
+/************************************************************************/
+/*                          VRTEvalLinesT()                             */
+/************************************************************************/
+
+template<class T, class Op>
+static void VRTEvalLinesT( void **papoSources, int nSources, void *pData,
+                           int nXSize, int nYSize,
+                           GDALDataType eBufType,
+                           int nPixelSpace, int nLineSpace,
+                           const Op& oOp, double* padfLine )
+{
+    for( int iLine = 0; iLine < nYSize; ++iLine )
+    {
+        const size_t nSrcOffset = static_cast<size_t>(iLine) * nXSize;
+
+        const T* const pSrc0 =
+            static_cast<const T*>(papoSources[0]) + nSrcOffset;
+        for( int iCol = 0; iCol < nXSize; ++iCol )
+            padfLine[iCol] = oOp.First(static_cast<double>(pSrc0[iCol]));
+
+        for( int iSrc = 1; iSrc < nSources; ++iSrc )
+        {
+            const T* const pSrc =
+                static_cast<const T*>(papoSources[iSrc]) + nSrcOffset;
+            for( int iCol = 0; iCol < nXSize; ++iCol )
+                padfLine[iCol] = oOp.Combine(padfLine[iCol],
+                                             static_cast<double>(pSrc[iCol]));
+        }
+
+        for( int iCol = 0; iCol < nXSize; ++iCol )
+            padfLine[iCol] = oOp.Finish(padfLine[iCol]);
+
+        GDALCopyWords( padfLine, GDT_Float64, sizeof(double),
+                       static_cast<GByte *>(pData) +
+                            static_cast<GPtrDiff_t>(nLineSpace) * iLine,
+                       eBufType, nPixelSpace, nXSize );
+    }
+}
+
+/************************************************************************/
+/*                           VRTEvalLines()                             */
+/*                                                                      */
+/* Returns false if the typed path cannot handle the request, in which  */
+/* case the caller must use the per-pixel code.                         */
+/************************************************************************/
+
+template<class Op>
+static bool VRTEvalLines( void **papoSources, int nSources, void *pData,
+                          int nXSize, int nYSize,
+                          GDALDataType eSrcType, GDALDataType eBufType,
+                          int nPixelSpace, int nLineSpace, const Op& oOp )
+{
+    if( GDALDataTypeIsComplex( eSrcType ) || nSources < 1 || nXSize <= 0 )
+        return false;
+    if( !CPLTestBool(CPLGetConfigOption("VRT_VECTORIZED_PIXEL_FUNCTIONS",
+                                        "YES")) )
+        return false;
+
+    double* padfLine = static_cast<double*>(
+        VSI_MALLOC2_VERBOSE(nXSize, sizeof(double)));
+    if( padfLine == NULL )
+        return false;
+
+    bool bRet = true;
+    switch( eSrcType )
+    {
+        case GDT_Byte:
+            VRTEvalLinesT<GByte>(papoSources, nSources, pData, nXSize, nYSize,
+                                 eBufType, nPixelSpace, nLineSpace,
+                                 oOp, padfLine);
+            break;
+        case GDT_UInt16:
+            VRTEvalLinesT<GUInt16>(papoSources, nSources, pData,
+                                   nXSize, nYSize,
+                                   eBufType, nPixelSpace, nLineSpace,
+                                   oOp, padfLine);
+            break;
+        case GDT_Int16:
+            VRTEvalLinesT<GInt16>(papoSources, nSources, pData,
+                                  nXSize, nYSize,
+                                  eBufType, nPixelSpace, nLineSpace,
+                                  oOp, padfLine);
+            break;
+        case GDT_UInt32:
+            VRTEvalLinesT<GUInt32>(papoSources, nSources, pData,
+                                   nXSize, nYSize,
+                                   eBufType, nPixelSpace, nLineSpace,
+                                   oOp, padfLine);
+            break;
+        case GDT_Int32:
+            VRTEvalLinesT<GInt32>(papoSources, nSources, pData,
+                                  nXSize, nYSize,
+                                  eBufType, nPixelSpace, nLineSpace,
+                                  oOp, padfLine);
+            break;
+        case GDT_Float32:
+            VRTEvalLinesT<float>(papoSources, nSources, pData,
+                                 nXSize, nYSize,
+                                 eBufType, nPixelSpace, nLineSpace,
+                                 oOp, padfLine);
+            break;
+        case GDT_Float64:
+            VRTEvalLinesT<double>(papoSources, nSources, pData,
+                                  nXSize, nYSize,
+                                  eBufType, nPixelSpace, nLineSpace,
+                                  oOp, padfLine);
+            break;
+        default:
+            bRet = false;
+            break;
+    }
+
+    VSIFree(padfLine);
+    return bRet;
+}
+
 static CPLErr RealPixelFunc( void **papoSources, int nSources, void *pData,
                              int nXSize, int nYSize,
                              GDALDataType eSrcType, GDALDataType eBufType,
@@ -255,7 +468,9 @@ static CPLErr ModulePixelFunc( void **papoSources, int nSources, void *pData,
             }
         }
     }
-    else
+    else if( !VRTEvalLines(papoSources, nSources, pData,
+                           nXSize, nYSize, eSrcType, eBufType,
+                           nPixelSpace, nLineSpace, VRTModOp()) )
     {
         /* ---- Set pixels ---- */
         for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
@@ -306,7 +521,9 @@ static CPLErr PhasePixelFunc( void **papoSources, int nSources, void *pData,
             }
         }
     }
-    else
+    else if( !VRTEvalLines(papoSources, nSources, pData,
+                           nXSize, nYSize, eSrcType, eBufType,
+                           nPixelSpace, nLineSpace, VRTPhaseOp()) )
     {
         /* ---- Set pixels ---- */
         for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
@@ -406,7 +623,9 @@ static CPLErr SumPixelFunc(void **papoSources, int nSources, void *pData,
             }
         }
     }
-    else
+    else if( !VRTEvalLines(papoSources, nSources, pData,
+                           nXSize, nYSize, eSrcType, eBufType,
+                           nPixelSpace, nLineSpace, VRTSumOp()) )
     {
         /* ---- Set pixels ---- */
         for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
@@ -466,7 +685,9 @@ static CPLErr DiffPixelFunc( void **papoSources, int nSources, void *pData,
             }
         }
     }
-    else
+    else if( !VRTEvalLines(papoSources, nSources, pData,
+                           nXSize, nYSize, eSrcType, eBufType,
+                           nPixelSpace, nLineSpace, VRTDiffOp()) )
     {
         /* ---- Set pixels ---- */
         for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
@@ -529,7 +750,9 @@ static CPLErr MulPixelFunc( void **papoSources, int nSources, void *pData,
             }
         }
     }
-    else
+    else if( !VRTEvalLines(papoSources, nSources, pData,
+                           nXSize, nYSize, eSrcType, eBufType,
+                           nPixelSpace, nLineSpace, VRTMulOp()) )
     {
         /* ---- Set pixels ---- */
         for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
@@ -646,7 +869,9 @@ static CPLErr InvPixelFunc( void **papoSources, int nSources, void *pData,
             }
         }
     }
-    else
+    else if( !VRTEvalLines(papoSources, nSources, pData,
+                           nXSize, nYSize, eSrcType, eBufType,
+                           nPixelSpace, nLineSpace, VRTInvOp()) )
     {
         /* ---- Set pixels ---- */
         for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
@@ -699,7 +924,9 @@ static CPLErr IntensityPixelFunc( void **papoSources, int nSources, void *pData,
             }
         }
     }
-    else
+    else if( !VRTEvalLines(papoSources, nSources, pData,
+                           nXSize, nYSize, eSrcType, eBufType,
+                           nPixelSpace, nLineSpace, VRTIntensityOp()) )
     {
         /* ---- Set pixels ---- */
         for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
@@ -729,6 +956,11 @@ static CPLErr SqrtPixelFunc( void **papoSources, int nSources, void *pData,
     if( nSources != 1 ) return CE_Failure;
     if( GDALDataTypeIsComplex( eSrcType ) ) return CE_Failure;
 
+    if( VRTEvalLines(papoSources, nSources, pData, nXSize, nYSize,
+                     eSrcType, eBufType, nPixelSpace, nLineSpace,
+                     VRTSqrtOp()) )
+        return CE_None;
+
     /* ---- Set pixels ---- */
     for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
         for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
@@ -783,7 +1015,9 @@ static CPLErr Log10PixelFuncHelper( void **papoSources, int nSources,
             }
         }
     }
-    else
+    else if( !VRTEvalLines(papoSources, nSources, pData,
+                           nXSize, nYSize, eSrcType, eBufType,
+                           nPixelSpace, nLineSpace, VRTLog10Op(fact)) )
     {
         /* ---- Set pixels ---- */
         for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
@@ -835,6 +1069,11 @@ static CPLErr PowPixelFuncHelper( void **papoSources, int nSources, void *pData,
     if( nSources != 1 ) return CE_Failure;
     if( GDALDataTypeIsComplex( eSrcType ) ) return CE_Failure;
 
+    if( VRTEvalLines(papoSources, nSources, pData, nXSize, nYSize,
+                     eSrcType, eBufType, nPixelSpace, nLineSpace,
+                     VRTPowOp(base, fact)) )
+        return CE_None;
+
     /* ---- Set pixels ---- */
     for( int iLine = 0, ii = 0; iLine < nYSize; ++iLine ) {
         for( int iCol = 0; iCol < nXSize; ++iCol, ++ii ) {
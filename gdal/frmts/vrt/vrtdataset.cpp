@@ -31,9 +31,11 @@
 
 #include "cpl_minixml.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_spatialref.h"
 
 #include <algorithm>
+#include <new>
 #include <typeinfo>
 
 /*! @cond Doxygen_Suppress */
@@ -54,7 +56,8 @@ VRTDataset::VRTDataset( int nXSize, int nYSize ) :
     m_bWritable(TRUE),
     m_pszVRTPath(NULL),
     m_poMaskBand(NULL),
-    m_bCompatibleForDatasetIO(-1)
+    m_bCompatibleForDatasetIO(-1),
+    m_poSourcesThreadPool(NULL)
 {
     nRasterXSize = nXSize;
     nRasterYSize = nYSize;
@@ -97,6 +100,7 @@ VRTDataset::~VRTDataset()
 
 {
     FlushCache();
+    delete m_poSourcesThreadPool;
     CPLFree( m_pszProjection );
 
     CPLFree( m_pszGCPProjection );
@@ -1239,6 +1243,30 @@ void VRTDataset::SetMaskBand(VRTRasterBand* poMaskBandIn)
     m_poMaskBand->SetIsMaskBand();
 }
 
+/************************************************************************/
+/*                        GetSourcesThreadPool()                        */
+/************************************************************************/
+
+// Return the pool of worker threads used by the bands of this dataset to
+// read their sources concurrently. The pool is created on first use with
+// nThreads threads, and then kept for the lifetime of the dataset, so that
+// threads are not started again for each request.
+
+CPLWorkerThreadPool* VRTDataset::GetSourcesThreadPool( int nThreads )
+{
+    if( m_poSourcesThreadPool != NULL )
+        return m_poSourcesThreadPool;
+
+    m_poSourcesThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+    if( m_poSourcesThreadPool != NULL &&
+        !m_poSourcesThreadPool->Setup( nThreads, NULL, NULL ) )
+    {
+        delete m_poSourcesThreadPool;
+        m_poSourcesThreadPool = NULL;
+    }
+    return m_poSourcesThreadPool;
+}
+
 /************************************************************************/
 /*                        CloseDependentDatasets()                      */
 /************************************************************************/
@@ -1540,20 +1568,34 @@ CPLErr VRTDataset::IRasterIO( GDALRWFlag eRWFlag,
         // they don't necessary instantiate all underlying rasterbands.
         VRTSourcedRasterBand* poBand = reinterpret_cast<VRTSourcedRasterBand *>(
             papoBands[nBands - 1] );
-        for( int iSource = 0;
-             eErr == CE_None && iSource < poBand->nSources;
-             iSource++ )
+        std::vector<int> anSources;
+        poBand->GetSourcesIntersecting( nXOff, nYOff, nXSize, nYSize,
+                                        anSources );
+        if( poBand->ReadSourcesConcurrently( anSources,
+                                             nXOff, nYOff, nXSize, nYSize,
+                                             pData, nBufXSize, nBufYSize,
+                                             eBufType,
+                                             nBandCount, panBandMap,
+                                             nPixelSpace, nLineSpace,
+                                             nBandSpace,
+                                             psExtraArg, &eErr ) )
+        {
+            return eErr;
+        }
+
+        const int nRequestSources = static_cast<int>(anSources.size());
+        for( int i = 0; eErr == CE_None && i < nRequestSources; i++ )
         {
             psExtraArg->pfnProgress = GDALScaledProgress;
             psExtraArg->pProgressData =
                 GDALCreateScaledProgress(
-                    1.0 * iSource / poBand->nSources,
-                    1.0 * (iSource + 1) / poBand->nSources,
+                    1.0 * i / nRequestSources,
+                    1.0 * (i + 1) / nRequestSources,
                     pfnProgressGlobal,
                     pProgressDataGlobal );
 
             VRTSimpleSource* poSource = reinterpret_cast<VRTSimpleSource *>(
-                poBand->papoSources[iSource] );
+                poBand->papoSources[anSources[i]] );
 
             eErr = poSource->DatasetRasterIO( nXOff, nYOff, nXSize, nYSize,
                                               pData, nBufXSize, nBufYSize,
@@ -34,6 +34,7 @@
 #ifndef DOXYGEN_SKIP
 
 #include "cpl_hash_set.h"
+#include "cpl_quad_tree.h"
 #include "gdal_pam.h"
 #include "gdal_priv.h"
 #include "gdal_vrt.h"
@@ -41,6 +42,8 @@
 #include <map>
 #include <vector>
 
+class CPLWorkerThreadPool;
+
 int VRTApplyMetadata( CPLXMLNode *, GDALMajorObject * );
 CPLXMLNode *VRTSerializeMetadata( GDALMajorObject * );
 CPLErr GDALRegisterDefaultPixelFunc();
@@ -152,6 +155,9 @@ class CPL_DLL VRTDataset : public GDALDataset
     std::vector<GDALDataset*> m_apoOverviews;
     std::vector<GDALDataset*> m_apoOverviewsBak;
 
+    // Worker threads used to read sources concurrently (VRT_NUM_THREADS).
+    CPLWorkerThreadPool *m_poSourcesThreadPool;
+
   protected:
     virtual int         CloseDependentDatasets();
 
@@ -160,6 +166,7 @@ class CPL_DLL VRTDataset : public GDALDataset
     virtual ~VRTDataset();
 
     void          SetNeedsFlush() { m_bNeedsFlush = TRUE; }
+    CPLWorkerThreadPool* GetSourcesThreadPool( int nThreads );
     virtual void  FlushCache();
 
     void SetWritable(int bWritableIn) { m_bWritable = bWritableIn; }
@@ -464,8 +471,15 @@ class CPL_DLL VRTSourcedRasterBand : public VRTRasterBand
     CPLString      m_osLastLocationInfo;
     char         **m_papszSourceList;
 
+    // Spatial index over the destination windows of the sources, lazily
+    // built when there are many sources, and invalidated when they change.
+    CPLQuadTree   *m_hSourcesQuadTree;
+    int            m_nSourcesInQuadTree;
+
     bool           CanUseSourcesMinMaxImplementations();
     void           CheckSource( VRTSimpleSource *poSS );
+    void           BuildSourcesQuadTree();
+    void           InvalidateSourcesQuadTree();
 
   public:
     int            nSources;
@@ -518,6 +532,21 @@ class CPL_DLL VRTSourcedRasterBand : public VRTRasterBand
                                   void *pProgressData );
 
     CPLErr         AddSource( VRTSource * );
+    void           GetSourcesIntersecting( int nXOff, int nYOff,
+                                           int nXSize, int nYSize,
+                                           std::vector<int>& anSources );
+    int            ReadSourcesConcurrently( const std::vector<int>& anSources,
+                                            int nXOff, int nYOff,
+                                            int nXSize, int nYSize,
+                                            void *pData,
+                                            int nBufXSize, int nBufYSize,
+                                            GDALDataType eBufType,
+                                            int nBandCount, int *panBandMap,
+                                            GSpacing nPixelSpace,
+                                            GSpacing nLineSpace,
+                                            GSpacing nBandSpace,
+                                            GDALRasterIOExtraArg* psExtraArg,
+                                            CPLErr* peErr );
     CPLErr         AddSimpleSource( GDALRasterBand *poSrcBand,
                                     double dfSrcXOff=-1, double dfSrcYOff=-1,
                                     double dfSrcXSize=-1, double dfSrcYSize=-1,
@@ -31,6 +31,7 @@
 #include "cpl_minixml.h"
 #include "cpl_string.h"
 #include "vrtdataset.h"
+#include "vrtexpression.h"
 #include "cpl_multiproc.h"
 #include "cpl_spawn.h"
 
@@ -853,6 +854,8 @@ class VRTDerivedRasterBandPrivateData
         bool      m_bExclusiveLock;
         bool      m_bFirstTime;
         std::vector< std::pair<CPLString,CPLString> > m_oFunctionArgs;
+        VRTExpression* m_poExpression;
+        bool      m_bPropagateNoData;
 
         VRTDerivedRasterBandPrivateData():
             m_osLanguage("C"),
@@ -862,12 +865,15 @@ class VRTDerivedRasterBandPrivateData
             m_bPythonInitializationDone(false),
             m_bPythonInitializationSuccess(false),
             m_bExclusiveLock(false),
-            m_bFirstTime(true)
+            m_bFirstTime(true),
+            m_poExpression(NULL),
+            m_bPropagateNoData(true)
         {
         }
 
         virtual ~VRTDerivedRasterBandPrivateData()
         {
+            delete m_poExpression;
             if( m_poGDALCreateNumpyArray )
                 Py_DecRef(m_poGDALCreateNumpyArray);
             if( m_poUserFunction )
@@ -1535,6 +1541,9 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     if( eSrcType == GDT_Unknown || eSrcType >= GDT_TypeCount ) {
         eSrcType = eBufType;
     }
+    // Expressions are always evaluated on doubles.
+    if( m_poPrivate->m_poExpression != NULL )
+        eSrcType = GDT_Float64;
     const int nSrcTypeSize = GDALGetDataTypeSizeBytes(eSrcType);
 
 /* -------------------------------------------------------------------- */
@@ -1921,6 +1930,16 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             VSIFree(pabyTmpBuffer);
         }
     }
+    else if( eErr == CE_None && m_poPrivate->m_poExpression != NULL )
+    {
+        // No lock is needed here: the compiled expression is read-only.
+        eErr = m_poPrivate->m_poExpression->Evaluate(
+                    reinterpret_cast<double **>( pBuffers ), nSources,
+                    pData, nBufXSize, nBufYSize,
+                    eBufType, nPixelSpace, nLineSpace,
+                    CPL_TO_BOOL(m_bNoDataValueSet), m_dfNoDataValue,
+                    m_poPrivate->m_bPropagateNoData );
+    }
     else if( eErr == CE_None && pfnPixelFunc != NULL ) {
         eErr = pfnPixelFunc( reinterpret_cast<void **>( pBuffers ), nSources,
                              pData, nBufXSize, nBufYSize,
@@ -1965,35 +1984,68 @@ CPLErr VRTDerivedRasterBand::XMLInit( CPLXMLNode *psTree,
     if( eErr != CE_None )
         return eErr;
 
-    // Read derived pixel function type.
-    SetPixelFunctionName( CPLGetXMLValue( psTree, "PixelFunctionType", NULL ) );
-    if( pszFuncName == NULL || EQUAL(pszFuncName, "") )
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "PixelFunctionType missing");
-        return CE_Failure;
-    }
-
     m_poPrivate->m_osLanguage = CPLGetXMLValue( psTree,
                                                 "PixelFunctionLanguage", "C" );
     if( !EQUAL(m_poPrivate->m_osLanguage, "C") &&
-        !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        !EQUAL(m_poPrivate->m_osLanguage, "Python") &&
+        !EQUAL(m_poPrivate->m_osLanguage, "Expression") )
     {
         CPLError(CE_Failure, CPLE_NotSupported,
                  "Unsupported PixelFunctionLanguage");
         return CE_Failure;
     }
+    const bool bIsExpression =
+        EQUAL(m_poPrivate->m_osLanguage, "Expression");
+
+    // Read derived pixel function type.
+    SetPixelFunctionName( CPLGetXMLValue( psTree, "PixelFunctionType",
+                                          bIsExpression ? "" : NULL ) );
+    if( !bIsExpression && (pszFuncName == NULL || EQUAL(pszFuncName, "")) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "PixelFunctionType missing");
+        return CE_Failure;
+    }
 
     m_poPrivate->m_osCode =
                         CPLGetXMLValue( psTree, "PixelFunctionCode", "" );
     if( !m_poPrivate->m_osCode.empty() &&
-        !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        !EQUAL(m_poPrivate->m_osLanguage, "Python") && !bIsExpression )
     {
         CPLError(CE_Failure, CPLE_NotSupported,
-                 "PixelFunctionCode can only be used with Python");
+                 "PixelFunctionCode can only be used with Python "
+                 "or Expression");
         return CE_Failure;
     }
 
+    // Expressions are compiled once here, and evaluated at each IRasterIO().
+    if( bIsExpression )
+    {
+        if( m_poPrivate->m_osCode.empty() )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "PixelFunctionCode missing");
+            return CE_Failure;
+        }
+        delete m_poPrivate->m_poExpression;
+        m_poPrivate->m_poExpression = new VRTExpression();
+        if( !m_poPrivate->m_poExpression->Compile(m_poPrivate->m_osCode) )
+        {
+            delete m_poPrivate->m_poExpression;
+            m_poPrivate->m_poExpression = NULL;
+            return CE_Failure;
+        }
+        if( m_poPrivate->m_poExpression->GetMaxSourceIndex() >= nSources )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "PixelFunctionCode references B%d, but the band has "
+                     "only %d source(s)",
+                     m_poPrivate->m_poExpression->GetMaxSourceIndex() + 1,
+                     nSources);
+            return CE_Failure;
+        }
+    }
+
     m_poPrivate->m_nBufferRadius =
                         atoi(CPLGetXMLValue( psTree, "BufferRadius", "0" ));
     if( m_poPrivate->m_nBufferRadius < 0 )
@@ -2012,10 +2064,11 @@ CPLErr VRTDerivedRasterBand::XMLInit( CPLXMLNode *psTree,
     CPLXMLNode* psArgs = CPLGetXMLNode( psTree, "PixelFunctionArguments" );
     if( psArgs != NULL )
     {
-        if( !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        if( !EQUAL(m_poPrivate->m_osLanguage, "Python") && !bIsExpression )
         {
             CPLError(CE_Failure, CPLE_NotSupported,
-                     "PixelFunctionArguments can only be used with Python");
+                     "PixelFunctionArguments can only be used with Python "
+                     "or Expression");
             return CE_Failure;
         }
         for( CPLXMLNode* psIter = psArgs->psChild;
@@ -2027,6 +2080,20 @@ CPLErr VRTDerivedRasterBand::XMLInit( CPLXMLNode *psTree,
                 m_poPrivate->m_oFunctionArgs.push_back(
                     std::pair<CPLString,CPLString>(psIter->pszValue,
                                                    psIter->psChild->pszValue));
+                if( !bIsExpression )
+                    continue;
+                if( EQUAL(psIter->pszValue, "propagate_nodata") )
+                {
+                    m_poPrivate->m_bPropagateNoData =
+                        CPLTestBool(psIter->psChild->pszValue);
+                }
+                else
+                {
+                    CPLError(CE_Warning, CPLE_NotSupported,
+                             "Unsupported argument '%s' for "
+                             "PixelFunctionLanguage=Expression",
+                             psIter->pszValue);
+                }
             }
         }
     }
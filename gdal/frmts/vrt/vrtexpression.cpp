@@ -0,0 +1,926 @@
+/******************************************************************************
+ *
+ * Project:  Virtual GDAL Datasets
+ * Purpose:  Compilation of derived band expressions to a postfix bytecode,
+ *           and block-wise evaluation of that bytecode.
+ * Author:   Even Rouault, <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *****************************************************************************/
+
+#include "vrtexpression.h"
+
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include <algorithm>
+#include <limits>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_string.h"
+
+/*! @cond Doxygen_Suppress */
+
+CPL_CVSID("$Id$");
+
+// Number of pixels processed by each instruction at a time. Small enough for
+// the evaluation stack to stay in the L1 cache.
+static const int VRT_EXPR_BLOCK_SIZE = 256;
+
+// Maximum nesting of parentheses, function calls and operators, so that
+// hostile expressions cannot exhaust the stack of the recursive parser.
+static const int VRT_EXPR_MAX_NESTING = 64;
+
+/************************************************************************/
+/* ==================================================================== */
+/*                          VRTExpressionParser                         */
+/* ==================================================================== */
+/************************************************************************/
+
+/* Recursive descent parser emitting postfix code. Grammar, from lowest to
+ * highest precedence:
+ *
+ *   expr     := or [ '?' expr ':' expr ]
+ *   or       := and { '||' and }
+ *   and      := equality { '&&' equality }
+ *   equality := relation { ('==' | '!=') relation }
+ *   relation := additive { ('<' | '<=' | '>' | '>=') additive }
+ *   additive := term { ('+' | '-') term }
+ *   term     := unary { ('*' | '/' | '%') unary }
+ *   unary    := ('-' | '+' | '!') unary | power
+ *   power    := primary [ '^' unary ]
+ *   primary  := number | Bn | pi | nodata | function '(' args ')'
+ *             | '(' expr ')'
+ */
+
+namespace {
+
+class VRTExpressionParser
+{
+    const char*                                 m_pszExpr;
+    const char*                                 m_pszCur;
+    std::vector<VRTExpression::Instruction>&    m_aoCode;
+    std::vector<int>&                           m_anSourcesUsed;
+    int                                         m_nDepth;
+    int                                         m_nMaxDepth;
+    int                                         m_nNesting;
+    bool                                        m_bError;
+
+    bool    Error( const char* pszMsg );
+    bool    EnterNesting();
+    void    LeaveNesting() { m_nNesting--; }
+    void    Emit( VRTExpression::Opcode eOp, int nArg = 0,
+                  double dfValue = 0.0 );
+    void    SkipSpaces();
+    bool    Accept( const char* pszToken );
+
+    bool    ParseExpr();
+    bool    ParseOr();
+    bool    ParseAnd();
+    bool    ParseEquality();
+    bool    ParseRelation();
+    bool    ParseAdditive();
+    bool    ParseTerm();
+    bool    ParseUnary();
+    bool    ParsePower();
+    bool    ParsePrimary();
+    bool    ParseFunction( const CPLString& osName );
+
+  public:
+    VRTExpressionParser( const char* pszExpr,
+                         std::vector<VRTExpression::Instruction>& aoCode,
+                         std::vector<int>& anSourcesUsed ) :
+        m_pszExpr(pszExpr),
+        m_pszCur(pszExpr),
+        m_aoCode(aoCode),
+        m_anSourcesUsed(anSourcesUsed),
+        m_nDepth(0),
+        m_nMaxDepth(0),
+        m_nNesting(0),
+        m_bError(false)
+    {}
+
+    bool    Parse();
+    int     GetMaxDepth() const { return m_nMaxDepth; }
+};
+
+/************************************************************************/
+/*                               Error()                                */
+/************************************************************************/
+
+bool VRTExpressionParser::Error( const char* pszMsg )
+{
+    if( !m_bError )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Invalid expression '%s': %s at character %d",
+                 m_pszExpr, pszMsg,
+                 static_cast<int>(m_pszCur - m_pszExpr) + 1);
+        m_bError = true;
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                            EnterNesting()                            */
+/************************************************************************/
+
+bool VRTExpressionParser::EnterNesting()
+{
+    if( ++m_nNesting > VRT_EXPR_MAX_NESTING )
+        return Error(CPLSPrintf("expression nested more than %d levels deep",
+                                VRT_EXPR_MAX_NESTING));
+    return true;
+}
+
+/************************************************************************/
+/*                                Emit()                                */
+/************************************************************************/
+
+void VRTExpressionParser::Emit( VRTExpression::Opcode eOp, int nArg,
+                                double dfValue )
+{
+    VRTExpression::Instruction sInstr;
+    sInstr.eOp = eOp;
+    sInstr.nArg = nArg;
+    sInstr.dfValue = dfValue;
+    m_aoCode.push_back(sInstr);
+
+    // Track the evaluation stack depth.
+    switch( eOp )
+    {
+        case VRTExpression::OP_CONST:
+        case VRTExpression::OP_SOURCE:
+        case VRTExpression::OP_NODATA:
+            m_nDepth++;
+            break;
+        case VRTExpression::OP_ADD:
+        case VRTExpression::OP_SUB:
+        case VRTExpression::OP_MUL:
+        case VRTExpression::OP_DIV:
+        case VRTExpression::OP_MOD:
+        case VRTExpression::OP_POW:
+        case VRTExpression::OP_LT:
+        case VRTExpression::OP_LE:
+        case VRTExpression::OP_GT:
+        case VRTExpression::OP_GE:
+        case VRTExpression::OP_EQ:
+        case VRTExpression::OP_NE:
+        case VRTExpression::OP_AND:
+        case VRTExpression::OP_OR:
+            m_nDepth--;
+            break;
+        case VRTExpression::OP_SELECT:
+            m_nDepth -= 2;
+            break;
+        case VRTExpression::OP_MIN:
+        case VRTExpression::OP_MAX:
+            m_nDepth -= nArg - 1;
+            break;
+        default:
+            break;
+    }
+    m_nMaxDepth = std::max(m_nMaxDepth, m_nDepth);
+}
+
+/************************************************************************/
+/*                             SkipSpaces()                             */
+/************************************************************************/
+
+void VRTExpressionParser::SkipSpaces()
+{
+    while( *m_pszCur == ' ' || *m_pszCur == '\t' ||
+           *m_pszCur == '\n' || *m_pszCur == '\r' )
+        m_pszCur++;
+}
+
+/************************************************************************/
+/*                               Accept()                               */
+/************************************************************************/
+
+bool VRTExpressionParser::Accept( const char* pszToken )
+{
+    SkipSpaces();
+    const size_t nLen = strlen(pszToken);
+    if( strncmp(m_pszCur, pszToken, nLen) != 0 )
+        return false;
+    m_pszCur += nLen;
+    return true;
+}
+
+/************************************************************************/
+/*                               Parse()                                */
+/************************************************************************/
+
+bool VRTExpressionParser::Parse()
+{
+    if( !ParseExpr() )
+        return false;
+    SkipSpaces();
+    if( *m_pszCur != '\0' )
+        return Error("unexpected character");
+    CPLAssert( m_nDepth == 1 );
+    return true;
+}
+
+/************************************************************************/
+/*                              ParseExpr()                             */
+/************************************************************************/
+
+bool VRTExpressionParser::ParseExpr()
+{
+    if( !ParseOr() )
+        return false;
+    if( Accept("?") )
+    {
+        // Both branches are evaluated, and OP_SELECT picks the result.
+        if( !EnterNesting() || !ParseExpr() )
+            return false;
+        if( !Accept(":") )
+            return Error("':' expected");
+        if( !ParseExpr() )
+            return false;
+        LeaveNesting();
+        Emit(VRTExpression::OP_SELECT);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                              ParseOr()                               */
+/************************************************************************/
+
+bool VRTExpressionParser::ParseOr()
+{
+    if( !ParseAnd() )
+        return false;
+    while( Accept("||") )
+    {
+        if( !ParseAnd() )
+            return false;
+        Emit(VRTExpression::OP_OR);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                              ParseAnd()                              */
+/************************************************************************/
+
+bool VRTExpressionParser::ParseAnd()
+{
+    if( !ParseEquality() )
+        return false;
+    while( Accept("&&") )
+    {
+        if( !ParseEquality() )
+            return false;
+        Emit(VRTExpression::OP_AND);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                            ParseEquality()                           */
+/************************************************************************/
+
+bool VRTExpressionParser::ParseEquality()
+{
+    if( !ParseRelation() )
+        return false;
+    while( true )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("==") )
+            eOp = VRTExpression::OP_EQ;
+        else if( Accept("!=") )
+            eOp = VRTExpression::OP_NE;
+        else
+            return true;
+        if( !ParseRelation() )
+            return false;
+        Emit(eOp);
+    }
+}
+
+/************************************************************************/
+/*                            ParseRelation()                           */
+/************************************************************************/
+
+bool VRTExpressionParser::ParseRelation()
+{
+    if( !ParseAdditive() )
+        return false;
+    while( true )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("<=") )
+            eOp = VRTExpression::OP_LE;
+        else if( Accept("<") )
+            eOp = VRTExpression::OP_LT;
+        else if( Accept(">=") )
+            eOp = VRTExpression::OP_GE;
+        else if( Accept(">") )
+            eOp = VRTExpression::OP_GT;
+        else
+            return true;
+        if( !ParseAdditive() )
+            return false;
+        Emit(eOp);
+    }
+}
+
+/************************************************************************/
+/*                            ParseAdditive()                           */
+/************************************************************************/
+
+bool VRTExpressionParser::ParseAdditive()
+{
+    if( !ParseTerm() )
+        return false;
+    while( true )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("+") )
+            eOp = VRTExpression::OP_ADD;
+        else if( Accept("-") )
+            eOp = VRTExpression::OP_SUB;
+        else
+            return true;
+        if( !ParseTerm() )
+            return false;
+        Emit(eOp);
+    }
+}
+
+/************************************************************************/
+/*                              ParseTerm()                             */
+/************************************************************************/
+
+bool VRTExpressionParser::ParseTerm()
+{
+    if( !ParseUnary() )
+        return false;
+    while( true )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("*") )
+            eOp = VRTExpression::OP_MUL;
+        else if( Accept("/") )
+            eOp = VRTExpression::OP_DIV;
+        else if( Accept("%") )
+            eOp = VRTExpression::OP_MOD;
+        else
+            return true;
+        if( !ParseUnary() )
+            return false;
+        Emit(eOp);
+    }
+}
+
+/************************************************************************/
+/*                             ParseUnary()                             */
+/************************************************************************/
+
+bool VRTExpressionParser::ParseUnary()
+{
+    if( Accept("-") )
+    {
+        if( !EnterNesting() || !ParseUnary() )
+            return false;
+        LeaveNesting();
+        Emit(VRTExpression::OP_NEG);
+        return true;
+    }
+    if( Accept("+") )
+    {
+        if( !EnterNesting() || !ParseUnary() )
+            return false;
+        LeaveNesting();
+        return true;
+    }
+    // Make sure that "!=" is not mistaken for a negation.
+    SkipSpaces();
+    if( m_pszCur[0] == '!' && m_pszCur[1] != '=' )
+    {
+        m_pszCur++;
+        if( !EnterNesting() || !ParseUnary() )
+            return false;
+        LeaveNesting();
+        Emit(VRTExpression::OP_NOT);
+        return true;
+    }
+    return ParsePower();
+}
+
+/************************************************************************/
+/*                             ParsePower()                             */
+/************************************************************************/
+
+bool VRTExpressionParser::ParsePower()
+{
+    if( !ParsePrimary() )
+        return false;
+    if( Accept("^") )
+    {
+        // Right associative: 2^3^2 = 2^(3^2).
+        if( !EnterNesting() || !ParseUnary() )
+            return false;
+        LeaveNesting();
+        Emit(VRTExpression::OP_POW);
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                            ParsePrimary()                            */
+/************************************************************************/
+
+bool VRTExpressionParser::ParsePrimary()
+{
+    SkipSpaces();
+
+    if( *m_pszCur == '(' )
+    {
+        m_pszCur++;
+        if( !EnterNesting() || !ParseExpr() )
+            return false;
+        LeaveNesting();
+        if( !Accept(")") )
+            return Error("')' expected");
+        return true;
+    }
+
+    if( (*m_pszCur >= '0' && *m_pszCur <= '9') ||
+        (*m_pszCur == '.' && m_pszCur[1] >= '0' && m_pszCur[1] <= '9') )
+    {
+        char* pszEnd = NULL;
+        const double dfValue = CPLStrtod(m_pszCur, &pszEnd);
+        m_pszCur = pszEnd;
+        Emit(VRTExpression::OP_CONST, 0, dfValue);
+        return true;
+    }
+
+    if( (*m_pszCur >= 'a' && *m_pszCur <= 'z') ||
+        (*m_pszCur >= 'A' && *m_pszCur <= 'Z') || *m_pszCur == '_' )
+    {
+        const char* pszStart = m_pszCur;
+        while( (*m_pszCur >= 'a' && *m_pszCur <= 'z') ||
+               (*m_pszCur >= 'A' && *m_pszCur <= 'Z') ||
+               (*m_pszCur >= '0' && *m_pszCur <= '9') || *m_pszCur == '_' )
+            m_pszCur++;
+        const CPLString osName(
+            std::string(pszStart, static_cast<size_t>(m_pszCur - pszStart)));
+
+        if( Accept("(") )
+            return ParseFunction(osName);
+
+        // Source reference: B1 is the first source.
+        if( (osName[0] == 'B' || osName[0] == 'b') && osName.size() > 1 &&
+            osName.size() < 8 &&
+            strspn(osName.c_str() + 1, "0123456789") == osName.size() - 1 )
+        {
+            const int nSource = atoi(osName.c_str() + 1);
+            if( nSource < 1 )
+            {
+                m_pszCur = pszStart;
+                return Error("source numbering starts at B1");
+            }
+            if( std::find(m_anSourcesUsed.begin(), m_anSourcesUsed.end(),
+                          nSource - 1) == m_anSourcesUsed.end() )
+                m_anSourcesUsed.push_back(nSource - 1);
+            Emit(VRTExpression::OP_SOURCE, nSource - 1);
+            return true;
+        }
+        if( EQUAL(osName, "pi") )
+        {
+            Emit(VRTExpression::OP_CONST, 0, M_PI);
+            return true;
+        }
+        if( EQUAL(osName, "nodata") )
+        {
+            Emit(VRTExpression::OP_NODATA);
+            return true;
+        }
+
+        m_pszCur = pszStart;
+        return Error(CPLSPrintf("unknown identifier '%s'", osName.c_str()));
+    }
+
+    if( *m_pszCur == '\0' )
+        return Error("unexpected end of expression");
+    return Error("unexpected character");
+}
+
+/************************************************************************/
+/*                           ParseFunction()                            */
+/************************************************************************/
+
+bool VRTExpressionParser::ParseFunction( const CPLString& osName )
+{
+    static const struct
+    {
+        const char*             pszName;
+        VRTExpression::Opcode   eOp;
+        int                     nMinArgs;
+        int                     nMaxArgs;
+    } asFunctions[] = {
+        { "min", VRTExpression::OP_MIN, 2, INT_MAX },
+        { "max", VRTExpression::OP_MAX, 2, INT_MAX },
+        { "pow", VRTExpression::OP_POW, 2, 2 },
+        { "abs", VRTExpression::OP_ABS, 1, 1 },
+        { "sqrt", VRTExpression::OP_SQRT, 1, 1 },
+        { "exp", VRTExpression::OP_EXP, 1, 1 },
+        { "log", VRTExpression::OP_LOG, 1, 1 },
+        { "log10", VRTExpression::OP_LOG10, 1, 1 },
+        { "floor", VRTExpression::OP_FLOOR, 1, 1 },
+        { "ceil", VRTExpression::OP_CEIL, 1, 1 },
+        { "round", VRTExpression::OP_ROUND, 1, 1 },
+        { "isnan", VRTExpression::OP_ISNAN, 1, 1 },
+        { "isnodata", VRTExpression::OP_ISNODATA, 1, 1 },
+    };
+
+    size_t iFunc = 0;
+    for( ; iFunc < CPL_ARRAYSIZE(asFunctions); iFunc++ )
+    {
+        if( EQUAL(osName, asFunctions[iFunc].pszName) )
+            break;
+    }
+    if( iFunc == CPL_ARRAYSIZE(asFunctions) )
+        return Error(CPLSPrintf("unknown function '%s'", osName.c_str()));
+
+    int nArgs = 0;
+    if( !Accept(")") )
+    {
+        do
+        {
+            if( !EnterNesting() || !ParseExpr() )
+                return false;
+            LeaveNesting();
+            nArgs++;
+        } while( Accept(",") );
+        if( !Accept(")") )
+            return Error("')' expected");
+    }
+    if( nArgs < asFunctions[iFunc].nMinArgs ||
+        nArgs > asFunctions[iFunc].nMaxArgs )
+    {
+        return Error(CPLSPrintf("wrong number of arguments for %s()",
+                                asFunctions[iFunc].pszName));
+    }
+
+    Emit(asFunctions[iFunc].eOp, nArgs);
+    return true;
+}
+
+}  // namespace
+
+/************************************************************************/
+/* ==================================================================== */
+/*                             VRTExpression                            */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                            VRTExpression()                           */
+/************************************************************************/
+
+VRTExpression::VRTExpression() :
+    m_nMaxStackDepth(0)
+{}
+
+/************************************************************************/
+/*                              Compile()                               */
+/************************************************************************/
+
+bool VRTExpression::Compile( const char* pszExpression )
+{
+    m_aoCode.clear();
+    m_anSourcesUsed.clear();
+    m_nMaxStackDepth = 0;
+
+    VRTExpressionParser oParser(pszExpression, m_aoCode, m_anSourcesUsed);
+    if( !oParser.Parse() )
+    {
+        m_aoCode.clear();
+        m_anSourcesUsed.clear();
+        return false;
+    }
+    m_nMaxStackDepth = oParser.GetMaxDepth();
+    std::sort(m_anSourcesUsed.begin(), m_anSourcesUsed.end());
+    return true;
+}
+
+/************************************************************************/
+/*                         GetMaxSourceIndex()                          */
+/************************************************************************/
+
+int VRTExpression::GetMaxSourceIndex() const
+{
+    return m_anSourcesUsed.empty() ? -1 : m_anSourcesUsed.back();
+}
+
+/************************************************************************/
+/*                           VRTIsNoData()                              */
+/************************************************************************/
+
+static inline bool VRTIsNoData( double dfVal, bool bHasNoData,
+                                double dfNoData, bool bNoDataIsNan )
+{
+    return bHasNoData &&
+           (bNoDataIsNan ? CPLIsNan(dfVal) != 0 : dfVal == dfNoData);
+}
+
+/************************************************************************/
+/*                              Evaluate()                              */
+/************************************************************************/
+
+/* papadfSources[i] is a nXSize * nYSize packed buffer of doubles for the i-th
+ * source. The result is written in pData with the eBufType, nPixelSpace and
+ * nLineSpace layout. When bPropagateNoData is set, pixels for which one of the
+ * sources used by the expression is at nodata are set to nodata.
+ */
+
+CPLErr VRTExpression::Evaluate( const double* const* papadfSources,
+                                int nSources,
+                                void *pData, int nXSize, int nYSize,
+                                GDALDataType eBufType,
+                                GSpacing nPixelSpace, GSpacing nLineSpace,
+                                bool bHasNoData, double dfNoData,
+                                bool bPropagateNoData ) const
+{
+    if( m_aoCode.empty() )
+        return CE_Failure;
+    if( GetMaxSourceIndex() >= nSources )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Expression references B%d, but the band has only "
+                 "%d source(s)", GetMaxSourceIndex() + 1, nSources);
+        return CE_Failure;
+    }
+
+    const int nBlockSize = std::min(nXSize, VRT_EXPR_BLOCK_SIZE);
+    double* padfStack = static_cast<double*>(
+        VSI_MALLOC3_VERBOSE(m_nMaxStackDepth, nBlockSize, sizeof(double)));
+    if( padfStack == NULL )
+        return CE_Failure;
+
+    const bool bNoDataIsNan = bHasNoData && CPLIsNan(dfNoData) != 0;
+    const double dfNoDataOrNan =
+        bHasNoData ? dfNoData : std::numeric_limits<double>::quiet_NaN();
+    const size_t nCodeSize = m_aoCode.size();
+
+    for( int iLine = 0; iLine < nYSize; iLine++ )
+    {
+        for( int iX = 0; iX < nXSize; iX += nBlockSize )
+        {
+            const int n = std::min(nBlockSize, nXSize - iX);
+            const size_t nSrcOffset = static_cast<size_t>(iLine) * nXSize + iX;
+            int nDepth = 0;
+
+            for( size_t iInstr = 0; iInstr < nCodeSize; iInstr++ )
+            {
+                const Instruction& sInstr = m_aoCode[iInstr];
+                // Next free entry, top of stack, and the entry below it.
+                double* const padfPush =
+                    padfStack + static_cast<size_t>(nDepth) * nBlockSize;
+                double* const padfTop =
+                    nDepth >= 1 ? padfPush - nBlockSize : padfStack;
+                double* const padfBelow =
+                    nDepth >= 2 ? padfTop - nBlockSize : padfStack;
+
+                switch( sInstr.eOp )
+                {
+                    case OP_CONST:
+                        std::fill(padfPush, padfPush + n, sInstr.dfValue);
+                        nDepth++;
+                        break;
+                    case OP_SOURCE:
+                        memcpy(padfPush, papadfSources[sInstr.nArg] + nSrcOffset,
+                               n * sizeof(double));
+                        nDepth++;
+                        break;
+                    case OP_NODATA:
+                        std::fill(padfPush, padfPush + n, dfNoDataOrNan);
+                        nDepth++;
+                        break;
+
+                    case OP_NEG:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = -padfTop[i];
+                        break;
+                    case OP_NOT:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = (padfTop[i] == 0.0) ? 1.0 : 0.0;
+                        break;
+                    case OP_ABS:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = fabs(padfTop[i]);
+                        break;
+                    case OP_SQRT:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = sqrt(padfTop[i]);
+                        break;
+                    case OP_EXP:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = exp(padfTop[i]);
+                        break;
+                    case OP_LOG:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = log(padfTop[i]);
+                        break;
+                    case OP_LOG10:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = log10(padfTop[i]);
+                        break;
+                    case OP_FLOOR:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = floor(padfTop[i]);
+                        break;
+                    case OP_CEIL:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = ceil(padfTop[i]);
+                        break;
+                    case OP_ROUND:
+                        // Half away from zero, as C99 round().
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = (padfTop[i] >= 0.0) ?
+                                floor(padfTop[i] + 0.5) :
+                                ceil(padfTop[i] - 0.5);
+                        break;
+                    case OP_ISNAN:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = CPLIsNan(padfTop[i]) ? 1.0 : 0.0;
+                        break;
+                    case OP_ISNODATA:
+                        for( int i = 0; i < n; i++ )
+                            padfTop[i] = VRTIsNoData(padfTop[i], bHasNoData,
+                                                     dfNoData, bNoDataIsNan)
+                                         ? 1.0 : 0.0;
+                        break;
+
+                    case OP_ADD:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] += padfTop[i];
+                        nDepth--;
+                        break;
+                    case OP_SUB:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] -= padfTop[i];
+                        nDepth--;
+                        break;
+                    case OP_MUL:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] *= padfTop[i];
+                        nDepth--;
+                        break;
+                    case OP_DIV:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] /= padfTop[i];
+                        nDepth--;
+                        break;
+                    case OP_MOD:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] = fmod(padfBelow[i], padfTop[i]);
+                        nDepth--;
+                        break;
+                    case OP_POW:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] = pow(padfBelow[i], padfTop[i]);
+                        nDepth--;
+                        break;
+                    case OP_LT:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] = padfBelow[i] < padfTop[i] ? 1.0 : 0.0;
+                        nDepth--;
+                        break;
+                    case OP_LE:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] = padfBelow[i] <= padfTop[i] ? 1.0 : 0.0;
+                        nDepth--;
+                        break;
+                    case OP_GT:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] = padfBelow[i] > padfTop[i] ? 1.0 : 0.0;
+                        nDepth--;
+                        break;
+                    case OP_GE:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] = padfBelow[i] >= padfTop[i] ? 1.0 : 0.0;
+                        nDepth--;
+                        break;
+                    case OP_EQ:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] = padfBelow[i] == padfTop[i] ? 1.0 : 0.0;
+                        nDepth--;
+                        break;
+                    case OP_NE:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] = padfBelow[i] != padfTop[i] ? 1.0 : 0.0;
+                        nDepth--;
+                        break;
+                    case OP_AND:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] =
+                                (padfBelow[i] != 0.0 && padfTop[i] != 0.0) ?
+                                    1.0 : 0.0;
+                        nDepth--;
+                        break;
+                    case OP_OR:
+                        for( int i = 0; i < n; i++ )
+                            padfBelow[i] =
+                                (padfBelow[i] != 0.0 || padfTop[i] != 0.0) ?
+                                    1.0 : 0.0;
+                        nDepth--;
+                        break;
+
+                    case OP_SELECT:
+                    {
+                        double* const padfCond = padfBelow - nBlockSize;
+                        for( int i = 0; i < n; i++ )
+                            padfCond[i] = (padfCond[i] != 0.0) ?
+                                            padfBelow[i] : padfTop[i];
+                        nDepth -= 2;
+                        break;
+                    }
+
+                    case OP_MIN:
+                    case OP_MAX:
+                    {
+                        // Fold the nArg topmost entries into the lowest one.
+                        double* const padfFirst = padfStack +
+                            static_cast<size_t>(nDepth - sInstr.nArg) *
+                                nBlockSize;
+                        for( int iArg = 1; iArg < sInstr.nArg; iArg++ )
+                        {
+                            const double* const padfArg =
+                                padfFirst +
+                                static_cast<size_t>(iArg) * nBlockSize;
+                            if( sInstr.eOp == OP_MIN )
+                            {
+                                for( int i = 0; i < n; i++ )
+                                    padfFirst[i] = padfArg[i] < padfFirst[i] ?
+                                                    padfArg[i] : padfFirst[i];
+                            }
+                            else
+                            {
+                                for( int i = 0; i < n; i++ )
+                                    padfFirst[i] = padfArg[i] > padfFirst[i] ?
+                                                    padfArg[i] : padfFirst[i];
+                            }
+                        }
+                        nDepth -= sInstr.nArg - 1;
+                        break;
+                    }
+                }
+            }
+            CPLAssert( nDepth == 1 );
+
+            if( bHasNoData && bPropagateNoData )
+            {
+                for( size_t iSrc = 0; iSrc < m_anSourcesUsed.size(); iSrc++ )
+                {
+                    const double* const padfSrc =
+                        papadfSources[m_anSourcesUsed[iSrc]] + nSrcOffset;
+                    for( int i = 0; i < n; i++ )
+                    {
+                        if( VRTIsNoData(padfSrc[i], bHasNoData, dfNoData,
+                                        bNoDataIsNan) )
+                            padfStack[i] = dfNoData;
+                    }
+                }
+            }
+
+            GDALCopyWords( padfStack, GDT_Float64, sizeof(double),
+                           static_cast<GByte *>(pData) +
+                                nLineSpace * iLine + nPixelSpace * iX,
+                           eBufType, static_cast<int>(nPixelSpace), n );
+        }
+    }
+
+    VSIFree(padfStack);
+    return CE_None;
+}
+
+/*! @endcond */
@@ -0,0 +1,124 @@
+/******************************************************************************
+ * $Id$
+ *
+ * Project:  Virtual GDAL Datasets
+ * Purpose:  Declaration of VRTExpression, the compiled form of the
+ *           expressions used by derived bands with the "Expression"
+ *           pixel function language.
+ * Author:   Even Rouault, <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef VRTEXPRESSION_H_INCLUDED
+#define VRTEXPRESSION_H_INCLUDED
+
+#ifndef DOXYGEN_SKIP
+
+#include "cpl_port.h"
+#include "gdal.h"
+
+#include <vector>
+
+/************************************************************************/
+/*                             VRTExpression                            */
+/*                                                                      */
+/* An expression is parsed once by Compile() into a compact postfix     */
+/* bytecode, which Evaluate() then runs over blocks of pixels: each     */
+/* instruction is applied to a whole block of values before moving to   */
+/* the next one. A compiled expression is never modified by Evaluate(), */
+/* so it can be evaluated concurrently from several threads.            */
+/************************************************************************/
+
+class VRTExpression
+{
+  public:
+    typedef enum
+    {
+        OP_CONST,
+        OP_SOURCE,
+        OP_NODATA,
+        OP_NEG,
+        OP_NOT,
+        OP_ADD,
+        OP_SUB,
+        OP_MUL,
+        OP_DIV,
+        OP_MOD,
+        OP_POW,
+        OP_LT,
+        OP_LE,
+        OP_GT,
+        OP_GE,
+        OP_EQ,
+        OP_NE,
+        OP_AND,
+        OP_OR,
+        OP_SELECT,
+        OP_MIN,
+        OP_MAX,
+        OP_ABS,
+        OP_SQRT,
+        OP_EXP,
+        OP_LOG,
+        OP_LOG10,
+        OP_FLOOR,
+        OP_CEIL,
+        OP_ROUND,
+        OP_ISNAN,
+        OP_ISNODATA
+    } Opcode;
+
+    struct Instruction
+    {
+        Opcode  eOp;
+        int     nArg;     // Source index for OP_SOURCE, arg count for MIN/MAX
+        double  dfValue;  // Value for OP_CONST
+    };
+
+  private:
+    std::vector<Instruction> m_aoCode;
+    std::vector<int>         m_anSourcesUsed;
+    int                      m_nMaxStackDepth;
+
+  public:
+    VRTExpression();
+
+    bool    Compile( const char* pszExpression );
+
+    bool    IsCompiled() const { return !m_aoCode.empty(); }
+    int     GetMaxStackDepth() const { return m_nMaxStackDepth; }
+
+    // Returns the highest (0-based) source index referenced, or -1.
+    int     GetMaxSourceIndex() const;
+
+    CPLErr  Evaluate( const double* const* papadfSources, int nSources,
+                      void *pData, int nXSize, int nYSize,
+                      GDALDataType eBufType,
+                      GSpacing nPixelSpace, GSpacing nLineSpace,
+                      bool bHasNoData, double dfNoData,
+                      bool bPropagateNoData ) const;
+};
+
+#endif /* #ifndef DOXYGEN_SKIP */
+
+#endif /* VRTEXPRESSION_H_INCLUDED */
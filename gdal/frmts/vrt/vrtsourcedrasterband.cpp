@@ -29,9 +29,14 @@
 
 #include "cpl_minixml.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_geometry.h"
 
 #include "vrtdataset.h"
+
+#include <algorithm>
+#include <map>
+
 CPL_CVSID("$Id$");
 
 /*! @cond Doxygen_Suppress */
@@ -49,6 +54,8 @@ CPL_CVSID("$Id$");
 VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataset *poDSIn, int nBandIn ) :
     m_nRecursionCounter(0),
     m_papszSourceList(NULL),
+    m_hSourcesQuadTree(NULL),
+    m_nSourcesInQuadTree(0),
     nSources(0),
     papoSources(NULL),
     bSkipBufferInitialization(FALSE)
@@ -68,6 +75,8 @@ VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataType eType,
                                             int nXSize, int nYSize ) :
     m_nRecursionCounter(0),
     m_papszSourceList(NULL),
+    m_hSourcesQuadTree(NULL),
+    m_nSourcesInQuadTree(0),
     nSources(0),
     papoSources(NULL),
     bSkipBufferInitialization(FALSE)
@@ -86,6 +95,8 @@ VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataset *poDSIn, int nBandIn,
                                             int nXSize, int nYSize ) :
     m_nRecursionCounter(0),
     m_papszSourceList(NULL),
+    m_hSourcesQuadTree(NULL),
+    m_nSourcesInQuadTree(0),
     nSources(0),
     papoSources(NULL),
     bSkipBufferInitialization(FALSE)
@@ -106,6 +117,7 @@ VRTSourcedRasterBand::~VRTSourcedRasterBand()
 
 {
     CloseDependentDatasets();
+    InvalidateSourcesQuadTree();
     CSLDestroy(m_papszSourceList);
 }
 
@@ -159,6 +171,13 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             return CE_None;
     }
 
+/* -------------------------------------------------------------------- */
+/*      Select the sources that may contribute to this request.         */
+/* -------------------------------------------------------------------- */
+    std::vector<int> anSources;
+    GetSourcesIntersecting( nXOff, nYOff, nXSize, nYSize, anSources );
+    const int nRequestSources = static_cast<int>(anSources.size());
+
     // If resampling with non-nearest neighbour, we need to be careful
     // if the VRT band exposes a nodata value, but the sources do not have it
     if( eRWFlag == GF_Read &&
@@ -166,17 +185,18 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         psExtraArg->eResampleAlg != GRIORA_NearestNeighbour &&
         m_bNoDataValueSet )
     {
-        for( int i = 0; i < nSources; i++ )
+        for( int i = 0; i < nRequestSources; i++ )
         {
+            VRTSource* const poSourceBase = papoSources[anSources[i]];
             bool bFallbackToBase = false;
-            if( !papoSources[i]->IsSimpleSource() )
+            if( !poSourceBase->IsSimpleSource() )
             {
                 bFallbackToBase = true;
             }
             else
             {
                 VRTSimpleSource* const poSource
-                    = reinterpret_cast<VRTSimpleSource *>( papoSources[i] );
+                    = reinterpret_cast<VRTSimpleSource *>( poSourceBase );
                 // The window we will actually request from the source raster band.
                 double dfReqXOff = 0.0;
                 double dfReqYOff = 0.0;
@@ -264,29 +284,43 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 
     m_nRecursionCounter++;
 
+/* -------------------------------------------------------------------- */
+/*      Read sources concurrently if requested and possible.            */
+/* -------------------------------------------------------------------- */
+    CPLErr eErr = CE_None;
+    if( eRWFlag == GF_Read &&
+        ReadSourcesConcurrently( anSources, nXOff, nYOff, nXSize, nYSize,
+                                 pData, nBufXSize, nBufYSize, eBufType,
+                                 0, NULL, nPixelSpace, nLineSpace, 0,
+                                 psExtraArg, &eErr ) )
+    {
+        m_nRecursionCounter--;
+        return eErr;
+    }
+
     GDALProgressFunc const pfnProgressGlobal = psExtraArg->pfnProgress;
     void * const pProgressDataGlobal = psExtraArg->pProgressData;
 
 /* -------------------------------------------------------------------- */
 /*      Overlay each source in turn over top this.                      */
 /* -------------------------------------------------------------------- */
-    CPLErr eErr = CE_None;
-    for( int iSource = 0; eErr == CE_None && iSource < nSources; iSource++ )
+    for( int i = 0; eErr == CE_None && i < nRequestSources; i++ )
     {
         psExtraArg->pfnProgress = GDALScaledProgress;
         psExtraArg->pProgressData =
-            GDALCreateScaledProgress( 1.0 * iSource / nSources,
-                                      1.0 * (iSource + 1) / nSources,
+            GDALCreateScaledProgress( 1.0 * i / nRequestSources,
+                                      1.0 * (i + 1) / nRequestSources,
                                       pfnProgressGlobal,
                                       pProgressDataGlobal );
         if( psExtraArg->pProgressData == NULL )
             psExtraArg->pfnProgress = NULL;
 
         eErr =
-            papoSources[iSource]->RasterIO( nXOff, nYOff, nXSize, nYSize,
-                                            pData, nBufXSize, nBufYSize,
-                                            eBufType, nPixelSpace, nLineSpace,
-                                            psExtraArg);
+            papoSources[anSources[i]]->RasterIO( nXOff, nYOff, nXSize, nYSize,
+                                                 pData, nBufXSize, nBufYSize,
+                                                 eBufType,
+                                                 nPixelSpace, nLineSpace,
+                                                 psExtraArg);
 
         GDALDestroyScaledProgress( psExtraArg->pProgressData );
     }
@@ -337,8 +371,11 @@ int  VRTSourcedRasterBand::IGetDataCoverageStatus( int nXOff,
     poLR->addPoint( nXOff, nYOff );
     poPolyNonCoveredBySources->addRingDirectly(poLR);
 
-    for( int iSource = 0; iSource < nSources; iSource++ )
+    std::vector<int> anSources;
+    GetSourcesIntersecting( nXOff, nYOff, nXSize, nYSize, anSources );
+    for( size_t i = 0; i < anSources.size(); i++ )
     {
+        const int iSource = anSources[i];
         if( !papoSources[iSource]->IsSimpleSource() )
         {
             delete poPolyNonCoveredBySources;
@@ -875,6 +912,8 @@ CPLErr VRTSourcedRasterBand::GetHistogram( double dfMin, double dfMax,
 CPLErr VRTSourcedRasterBand::AddSource( VRTSource *poNewSource )
 
 {
+    InvalidateSourcesQuadTree();
+
     nSources++;
 
     papoSources = static_cast<VRTSource **>(
@@ -900,6 +939,500 @@ CPLErr VRTSourcedRasterBand::AddSource( VRTSource *poNewSource )
 
 /*! @endcond */
 
+/************************************************************************/
+/*                        BuildSourcesQuadTree()                        */
+/************************************************************************/
+
+void VRTSourcedRasterBand::BuildSourcesQuadTree()
+{
+    InvalidateSourcesQuadTree();
+
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = 0;
+    sGlobalBounds.miny = 0;
+    sGlobalBounds.maxx = nRasterXSize;
+    sGlobalBounds.maxy = nRasterYSize;
+    m_hSourcesQuadTree = CPLQuadTreeCreate( &sGlobalBounds, NULL );
+    CPLQuadTreeSetMaxDepth( m_hSourcesQuadTree,
+                            CPLQuadTreeGetAdvisedMaxDepth(nSources) );
+
+    // The features inserted are the addresses of the slots of papoSources,
+    // so that the source index can be recovered from a search result.
+    for( int i = 0; i < nSources; i++ )
+    {
+        // Sources that are not simple sources, or simple sources without
+        // an explicit destination window, may contribute to any part of the
+        // raster, so they are indexed with the whole raster extent.
+        CPLRectObj sBounds = sGlobalBounds;
+        if( papoSources[i]->IsSimpleSource() )
+        {
+            VRTSimpleSource* poSS =
+                reinterpret_cast<VRTSimpleSource*>( papoSources[i] );
+            const double dfX1 = poSS->m_dfDstXOff;
+            const double dfY1 = poSS->m_dfDstYOff;
+            const double dfX2 = poSS->m_dfDstXOff + poSS->m_dfDstXSize;
+            const double dfY2 = poSS->m_dfDstYOff + poSS->m_dfDstYSize;
+            const bool bDstWinSet =
+                poSS->m_dfDstXOff != -1 || poSS->m_dfDstXSize != -1 ||
+                poSS->m_dfDstYOff != -1 || poSS->m_dfDstYSize != -1;
+            if( bDstWinSet &&
+                CPLIsFinite(dfX1) && CPLIsFinite(dfY1) &&
+                CPLIsFinite(dfX2) && CPLIsFinite(dfY2) )
+            {
+                sBounds.minx = std::min(dfX1, dfX2);
+                sBounds.miny = std::min(dfY1, dfY2);
+                sBounds.maxx = std::max(dfX1, dfX2);
+                sBounds.maxy = std::max(dfY1, dfY2);
+            }
+        }
+        CPLQuadTreeInsertWithBounds( m_hSourcesQuadTree,
+                                     papoSources + i, &sBounds );
+    }
+    m_nSourcesInQuadTree = nSources;
+}
+
+/************************************************************************/
+/*                      InvalidateSourcesQuadTree()                     */
+/************************************************************************/
+
+void VRTSourcedRasterBand::InvalidateSourcesQuadTree()
+{
+    if( m_hSourcesQuadTree != NULL )
+    {
+        CPLQuadTreeDestroy( m_hSourcesQuadTree );
+        m_hSourcesQuadTree = NULL;
+    }
+    m_nSourcesInQuadTree = 0;
+}
+
+/************************************************************************/
+/*                       GetSourcesIntersecting()                       */
+/************************************************************************/
+
+/**
+ * Return the indices, in increasing order, of the sources whose destination
+ * window may intersect the passed window.
+ *
+ * The returned list is a superset of the sources that actually contribute to
+ * the window: each source still checks the request against its own window.
+ * When the band has many sources, the selection is done with a spatial index
+ * that is built on the first request and discarded when the sources change.
+ * Otherwise, all the sources are returned.
+ */
+
+void VRTSourcedRasterBand::GetSourcesIntersecting( int nXOff, int nYOff,
+                                                   int nXSize, int nYSize,
+                                                   std::vector<int>& anSources )
+{
+    anSources.clear();
+
+    // Below that number of sources, a linear scan is cheap enough.
+    const int nMinSourcesForIndex = 64;
+    if( nSources < nMinSourcesForIndex )
+    {
+        anSources.resize( nSources );
+        for( int i = 0; i < nSources; i++ )
+            anSources[i] = i;
+        return;
+    }
+
+    if( m_hSourcesQuadTree == NULL || m_nSourcesInQuadTree != nSources )
+        BuildSourcesQuadTree();
+
+    // Enlarge the window by one pixel, so as to be conservative regarding
+    // sources with non-integer destination windows touching its edges.
+    CPLRectObj sAOI;
+    sAOI.minx = nXOff - 1;
+    sAOI.miny = nYOff - 1;
+    sAOI.maxx = static_cast<double>(nXOff) + nXSize + 1;
+    sAOI.maxy = static_cast<double>(nYOff) + nYSize + 1;
+
+    int nFeatureCount = 0;
+    void** pahFeatures =
+        CPLQuadTreeSearch( m_hSourcesQuadTree, &sAOI, &nFeatureCount );
+    anSources.resize( nFeatureCount );
+    for( int i = 0; i < nFeatureCount; i++ )
+    {
+        anSources[i] = static_cast<int>(
+            static_cast<VRTSource**>(pahFeatures[i]) - papoSources );
+    }
+    CPLFree( pahFeatures );
+
+    // Later sources are painted over earlier ones, so preserve their order.
+    std::sort( anSources.begin(), anSources.end() );
+}
+
+/************************************************************************/
+/*                       VRTGetSourcesNumThreads()                      */
+/************************************************************************/
+
+// Number of worker threads used to read the sources intersecting a request,
+// from the VRT_NUM_THREADS configuration option.
+static int VRTGetSourcesNumThreads()
+{
+    const char* pszValue = CPLGetConfigOption("VRT_NUM_THREADS", NULL);
+    if( pszValue == NULL )
+        return 1;
+    const int nThreads =
+        EQUAL(pszValue, "ALL_CPUS") ? CPLGetNumCPUs() : atoi(pszValue);
+    return std::max(1, std::min(128, nThreads));
+}
+
+/************************************************************************/
+/*                        VRTSourceReadJobError                         */
+/************************************************************************/
+
+class VRTSourceReadJobError
+{
+    public:
+        VRTSourceReadJobError( CPLErr eErrIn, CPLErrorNum nErrNoIn,
+                               const CPLString& osMsgIn ) :
+                eErr(eErrIn), nErrNo(nErrNoIn), osErrorMsg(osMsgIn) {}
+
+        CPLErr      eErr;
+        CPLErrorNum nErrNo;
+        CPLString   osErrorMsg;
+};
+
+/************************************************************************/
+/*                           VRTSourceReadJob                           */
+/************************************************************************/
+
+struct VRTSourceReadJob
+{
+    VRTSimpleSource      *poSource;
+    int                   nBatch;
+
+    // Window written by the source in the output buffer.
+    int                   nOutXOff;
+    int                   nOutYOff;
+    int                   nOutXSize;
+    int                   nOutYSize;
+
+    // Request parameters.
+    int                   nXOff;
+    int                   nYOff;
+    int                   nXSize;
+    int                   nYSize;
+    void                 *pData;
+    int                   nBufXSize;
+    int                   nBufYSize;
+    GDALDataType          eBufType;
+    int                   nBandCount;
+    int                  *panBandMap;
+    GSpacing              nPixelSpace;
+    GSpacing              nLineSpace;
+    GSpacing              nBandSpace;
+    GDALRasterIOExtraArg  sExtraArg;
+
+    CPLErr                eErr;
+    // Errors emitted while reading the source in a worker thread.
+    std::vector<VRTSourceReadJobError> aoErrors;
+};
+
+/************************************************************************/
+/*                     VRTSourceReadJobErrorHandler()                   */
+/************************************************************************/
+
+// Collect the errors of a worker thread, so that they can be emitted again
+// in the calling thread, with the error handler installed by the caller.
+static void CPL_STDCALL VRTSourceReadJobErrorHandler(
+    CPLErr eErr, CPLErrorNum nErrNo, const char* pszErrorMsg )
+{
+    if( eErr == CE_Debug )
+    {
+        CPLDefaultErrorHandler(eErr, nErrNo, pszErrorMsg);
+        return;
+    }
+    VRTSourceReadJob* psJob =
+        static_cast<VRTSourceReadJob*>(CPLGetErrorHandlerUserData());
+    psJob->aoErrors.push_back(
+        VRTSourceReadJobError(eErr, nErrNo, pszErrorMsg));
+}
+
+/************************************************************************/
+/*                        VRTSourceReadJobFunc()                        */
+/************************************************************************/
+
+static void VRTSourceReadJobFunc( void* pData )
+{
+    VRTSourceReadJob* psJob = static_cast<VRTSourceReadJob*>(pData);
+    CPLPushErrorHandlerEx( VRTSourceReadJobErrorHandler, psJob );
+    if( psJob->nBandCount == 0 )
+    {
+        psJob->eErr = psJob->poSource->RasterIO(
+            psJob->nXOff, psJob->nYOff, psJob->nXSize, psJob->nYSize,
+            psJob->pData, psJob->nBufXSize, psJob->nBufYSize,
+            psJob->eBufType, psJob->nPixelSpace, psJob->nLineSpace,
+            &psJob->sExtraArg );
+    }
+    else
+    {
+        psJob->eErr = psJob->poSource->DatasetRasterIO(
+            psJob->nXOff, psJob->nYOff, psJob->nXSize, psJob->nYSize,
+            psJob->pData, psJob->nBufXSize, psJob->nBufYSize,
+            psJob->eBufType, psJob->nBandCount, psJob->panBandMap,
+            psJob->nPixelSpace, psJob->nLineSpace, psJob->nBandSpace,
+            &psJob->sExtraArg );
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                       ReadSourcesConcurrently()                      */
+/************************************************************************/
+
+/**
+ * Read the passed sources into the output buffer with several threads, when
+ * the VRT_NUM_THREADS configuration option is set to a value greater than 1.
+ *
+ * The sources are grouped into successive batches whose sources are read
+ * concurrently. A source is put in a batch after the ones of all the previous
+ * sources it conflicts with, that is sources that write to an overlapping
+ * area of the output buffer, or that read from the same dataset (which cannot
+ * be accessed from several threads at once), so that the result is the same
+ * as painting the sources one after the other. Only SimpleSource and
+ * ComplexSource are read concurrently: other kinds of sources are read alone.
+ *
+ * If nBandCount is 0, the band-level RasterIO() method of the sources is
+ * used, otherwise their DatasetRasterIO() method.
+ *
+ * @return FALSE if the sources must be read sequentially by the caller, in
+ * which case nothing has been done. Otherwise, *peErr is set to the status
+ * of the reads.
+ */
+
+int VRTSourcedRasterBand::ReadSourcesConcurrently(
+    const std::vector<int>& anSources,
+    int nXOff, int nYOff, int nXSize, int nYSize,
+    void *pData, int nBufXSize, int nBufYSize,
+    GDALDataType eBufType,
+    int nBandCount, int *panBandMap,
+    GSpacing nPixelSpace, GSpacing nLineSpace, GSpacing nBandSpace,
+    GDALRasterIOExtraArg* psExtraArg,
+    CPLErr* peErr )
+{
+    if( anSources.size() < 2 || poDS == NULL )
+        return FALSE;
+    const int nThreads = VRTGetSourcesNumThreads();
+    if( nThreads <= 1 )
+        return FALSE;
+
+/* -------------------------------------------------------------------- */
+/*      Assign each source to a batch.                                  */
+/* -------------------------------------------------------------------- */
+    std::vector<VRTSourceReadJob> asJobs;
+    // Reserve so that the job addresses inserted in the quad tree remain
+    // valid.
+    asJobs.reserve( anSources.size() );
+
+    CPLRectObj sGlobalBounds;
+    sGlobalBounds.minx = 0;
+    sGlobalBounds.miny = 0;
+    sGlobalBounds.maxx = nBufXSize;
+    sGlobalBounds.maxy = nBufYSize;
+    CPLQuadTree* hJobsQuadTree = CPLQuadTreeCreate( &sGlobalBounds, NULL );
+
+    std::map<CPLString, int> oMapLastBatchOfDataset;
+    int nLastBatch = -1;
+    int nLastExclusiveBatch = -1;
+
+    for( size_t i = 0; i < anSources.size(); i++ )
+    {
+        VRTSource* poSource = papoSources[anSources[i]];
+        if( !poSource->IsSimpleSource() )
+        {
+            // The output window of other kinds of sources is unknown.
+            CPLQuadTreeDestroy( hJobsQuadTree );
+            return FALSE;
+        }
+        VRTSimpleSource* poSS = reinterpret_cast<VRTSimpleSource*>(poSource);
+
+        VRTSourceReadJob sJob;
+        double dfReqXOff = 0.0;
+        double dfReqYOff = 0.0;
+        double dfReqXSize = 0.0;
+        double dfReqYSize = 0.0;
+        int nReqXOff = 0;
+        int nReqYOff = 0;
+        int nReqXSize = 0;
+        int nReqYSize = 0;
+        if( !poSS->GetSrcDstWindow( nXOff, nYOff, nXSize, nYSize,
+                                    nBufXSize, nBufYSize,
+                                    &dfReqXOff, &dfReqYOff,
+                                    &dfReqXSize, &dfReqYSize,
+                                    &nReqXOff, &nReqYOff,
+                                    &nReqXSize, &nReqYSize,
+                                    &sJob.nOutXOff, &sJob.nOutYOff,
+                                    &sJob.nOutXSize, &sJob.nOutYSize ) )
+        {
+            // The source does not contribute to the request.
+            continue;
+        }
+
+        // Identify the dataset the source reads from.
+        CPLString osDatasetName;
+        GDALRasterBand* poSrcBand = poSS->m_poMaskBandMainBand != NULL ?
+            poSS->m_poMaskBandMainBand : poSS->m_poRasterBand;
+        GDALDataset* poSrcDS =
+            poSrcBand != NULL ? poSrcBand->GetDataset() : NULL;
+        if( poSrcDS != NULL )
+            osDatasetName = poSrcDS->GetDescription();
+
+        // Nested VRTs may share their own sources with other datasets, so
+        // they are not read concurrently.
+        const bool bConcurrent =
+            (EQUAL(poSS->GetType(), "SimpleSource") ||
+             EQUAL(poSS->GetType(), "ComplexSource")) &&
+            dynamic_cast<VRTFilteredSource*>(poSS) == NULL &&
+            !osDatasetName.empty() &&
+            !STARTS_WITH_CI(osDatasetName, "<VRTDataset") &&
+            !EQUAL(CPLGetExtension(osDatasetName), "vrt");
+
+        if( !bConcurrent )
+        {
+            sJob.nBatch = nLastBatch + 1;
+            nLastExclusiveBatch = sJob.nBatch;
+        }
+        else
+        {
+            sJob.nBatch = nLastExclusiveBatch + 1;
+
+            std::map<CPLString, int>::const_iterator oIter =
+                oMapLastBatchOfDataset.find(osDatasetName);
+            if( oIter != oMapLastBatchOfDataset.end() )
+                sJob.nBatch = std::max(sJob.nBatch, oIter->second + 1);
+
+            CPLRectObj sBounds;
+            sBounds.minx = sJob.nOutXOff;
+            sBounds.miny = sJob.nOutYOff;
+            sBounds.maxx = sJob.nOutXOff + sJob.nOutXSize;
+            sBounds.maxy = sJob.nOutYOff + sJob.nOutYSize;
+            int nFeatureCount = 0;
+            void** pahFeatures =
+                CPLQuadTreeSearch( hJobsQuadTree, &sBounds, &nFeatureCount );
+            for( int j = 0; j < nFeatureCount; j++ )
+            {
+                const VRTSourceReadJob* psOther =
+                    static_cast<const VRTSourceReadJob*>(pahFeatures[j]);
+                // The quad tree also returns windows that only touch.
+                if( psOther->nOutXOff < sJob.nOutXOff + sJob.nOutXSize &&
+                    sJob.nOutXOff < psOther->nOutXOff + psOther->nOutXSize &&
+                    psOther->nOutYOff < sJob.nOutYOff + sJob.nOutYSize &&
+                    sJob.nOutYOff < psOther->nOutYOff + psOther->nOutYSize )
+                {
+                    sJob.nBatch = std::max(sJob.nBatch, psOther->nBatch + 1);
+                }
+            }
+            CPLFree( pahFeatures );
+
+            oMapLastBatchOfDataset[osDatasetName] = sJob.nBatch;
+        }
+        nLastBatch = std::max(nLastBatch, sJob.nBatch);
+
+        sJob.poSource = poSS;
+        sJob.nXOff = nXOff;
+        sJob.nYOff = nYOff;
+        sJob.nXSize = nXSize;
+        sJob.nYSize = nYSize;
+        sJob.pData = pData;
+        sJob.nBufXSize = nBufXSize;
+        sJob.nBufYSize = nBufYSize;
+        sJob.eBufType = eBufType;
+        sJob.nBandCount = nBandCount;
+        sJob.panBandMap = panBandMap;
+        sJob.nPixelSpace = nPixelSpace;
+        sJob.nLineSpace = nLineSpace;
+        sJob.nBandSpace = nBandSpace;
+        sJob.sExtraArg = *psExtraArg;
+        sJob.sExtraArg.pfnProgress = NULL;
+        sJob.sExtraArg.pProgressData = NULL;
+        sJob.eErr = CE_None;
+        asJobs.push_back( sJob );
+
+        if( bConcurrent )
+        {
+            CPLRectObj sBounds;
+            sBounds.minx = sJob.nOutXOff;
+            sBounds.miny = sJob.nOutYOff;
+            sBounds.maxx = sJob.nOutXOff + sJob.nOutXSize;
+            sBounds.maxy = sJob.nOutYOff + sJob.nOutYSize;
+            CPLQuadTreeInsertWithBounds( hJobsQuadTree, &asJobs.back(),
+                                         &sBounds );
+        }
+    }
+    CPLQuadTreeDestroy( hJobsQuadTree );
+
+    const int nJobs = static_cast<int>(asJobs.size());
+    const int nBatches = nLastBatch + 1;
+    if( nBatches == nJobs )
+        return FALSE;
+
+    CPLWorkerThreadPool* poThreadPool =
+        reinterpret_cast<VRTDataset*>(poDS)->GetSourcesThreadPool( nThreads );
+    if( poThreadPool == NULL )
+        return FALSE;
+
+    CPLDebug( "VRT", "Reading %d sources in %d batches with %d threads",
+              nJobs, nBatches, poThreadPool->GetThreadCount() );
+
+/* -------------------------------------------------------------------- */
+/*      Read the sources, one batch after the other.                    */
+/* -------------------------------------------------------------------- */
+    std::vector< std::vector<VRTSourceReadJob*> > aapsBatches( nBatches );
+    for( int i = 0; i < nJobs; i++ )
+        aapsBatches[asJobs[i].nBatch].push_back( &asJobs[i] );
+
+    CPLErr eErr = CE_None;
+    int nJobsDone = 0;
+    for( int iBatch = 0; eErr == CE_None && iBatch < nBatches; iBatch++ )
+    {
+        const std::vector<VRTSourceReadJob*>& apsBatch = aapsBatches[iBatch];
+        if( apsBatch.size() == 1 )
+        {
+            VRTSourceReadJobFunc( apsBatch[0] );
+        }
+        else
+        {
+            for( size_t i = 0; i < apsBatch.size(); i++ )
+            {
+                if( !poThreadPool->SubmitJob( VRTSourceReadJobFunc,
+                                              apsBatch[i] ) )
+                {
+                    VRTSourceReadJobFunc( apsBatch[i] );
+                }
+            }
+            poThreadPool->WaitCompletion();
+        }
+
+        // Emit the errors of the batch in the order of the sources.
+        for( size_t i = 0; i < apsBatch.size(); i++ )
+        {
+            const std::vector<VRTSourceReadJobError>& aoErrors =
+                apsBatch[i]->aoErrors;
+            for( size_t j = 0; j < aoErrors.size(); j++ )
+            {
+                CPLError( aoErrors[j].eErr, aoErrors[j].nErrNo, "%s",
+                          aoErrors[j].osErrorMsg.c_str() );
+            }
+            if( apsBatch[i]->eErr != CE_None )
+                eErr = apsBatch[i]->eErr;
+        }
+        nJobsDone += static_cast<int>(apsBatch.size());
+
+        if( eErr == CE_None && psExtraArg->pfnProgress != NULL &&
+            !psExtraArg->pfnProgress( 1.0 * nJobsDone / nJobs, "",
+                                      psExtraArg->pProgressData ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    *peErr = eErr;
+    return TRUE;
+}
+
 /************************************************************************/
 /*                              VRTAddSource()                          */
 /************************************************************************/
@@ -1402,8 +1935,11 @@ const char *VRTSourcedRasterBand::GetMetadataItem( const char * pszName,
                                                       CPLHashSetEqualStr,
                                                       NULL );
 
-        for( int iSource = 0; iSource < nSources; iSource++ )
+        std::vector<int> anSources;
+        GetSourcesIntersecting( iPixel, iLine, 1, 1, anSources );
+        for( size_t i = 0; i < anSources.size(); i++ )
         {
+            const int iSource = anSources[i];
             if( !papoSources[iSource]->IsSimpleSource() )
                 continue;
 
@@ -1570,6 +2106,7 @@ CPLErr VRTSourcedRasterBand::SetMetadataItem( const char *pszName,
         {
             delete papoSources[iSource];
             papoSources[iSource] = poSource;
+            InvalidateSourcesQuadTree();
             reinterpret_cast<VRTDataset *>( poDS )->SetNeedsFlush();
             return CE_None;
         }
@@ -1601,6 +2138,7 @@ CPLErr VRTSourcedRasterBand::SetMetadata( char **papszNewMD, const char *pszDoma
             CPLFree( papoSources );
             papoSources = NULL;
             nSources = 0;
+            InvalidateSourcesQuadTree();
         }
 
         for( int i = 0; i < CSLCount(papszNewMD); i++ )
@@ -1661,6 +2199,7 @@ int VRTSourcedRasterBand::CloseDependentDatasets()
     CPLFree( papoSources );
     papoSources = NULL;
     nSources = 0;
+    InvalidateSourcesQuadTree();
 
     return TRUE;
 }
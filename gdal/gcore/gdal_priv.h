@@ -443,6 +443,12 @@ class CPL_DLL GDALDataset : public GDALMajorObject
 
     int          AcquireMutex();
     void         ReleaseMutex();
+
+    bool                IsPrefetchEnabled();
+    CPLErr              PrefetchBlocks( GDALRasterBand* poBand,
+                                        int nXBlockOff, int nYBlockOff,
+                                        int nXBlocks, int nYBlocks );
+    void                StopPrefetch();
 //! @endcond
 
   public:
@@ -663,6 +669,9 @@ class CPL_DLL GDALRasterBlock
 
     void        RecycleFor( int nXOffIn, int nYOffIn );
 
+    static int  FlushCacheBlock( struct GDALRasterBlockCacheShard* psShard,
+                                 int bDirtyBlocksOnly );
+
   public:
                 GDALRasterBlock( GDALRasterBand *, int, int );
                 GDALRasterBlock( int nXOffIn, int nYOffIn ); /* only for lookup purpose */
@@ -838,6 +847,9 @@ class CPL_DLL GDALRasterBand : public GDALMajorObject
 
     void           SetFlushBlockErr( CPLErr eErr );
     CPLErr         UnreferenceBlock( GDALRasterBlock* poBlock );
+    GDALRasterBlock *GetLockedBlockRefInternal( int nXBlockOff,
+                                                int nYBlockOff,
+                                                int bJustInitialize );
 
     void           Init(int bForceCachedIO);
 
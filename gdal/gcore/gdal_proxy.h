@@ -202,7 +202,6 @@ class CPL_DLL GDALProxyRasterBand : public GDALRasterBand
 /*                     GDALProxyPoolDataset                             */
 /* ******************************************************************** */
 
-typedef struct _GDALProxyPoolCacheEntry GDALProxyPoolCacheEntry;
 class     GDALProxyPoolRasterBand;
 
 class CPL_DLL GDALProxyPoolDataset : public GDALProxyDataset
@@ -220,8 +219,6 @@ class CPL_DLL GDALProxyPoolDataset : public GDALProxyDataset
         CPLHashSet      *metadataSet;
         CPLHashSet      *metadataItemSet;
 
-        GDALProxyPoolCacheEntry* cacheEntry;
-
     protected:
         virtual GDALDataset *RefUnderlyingDataset();
         virtual void UnrefUnderlyingDataset(GDALDataset* poUnderlyingDataset);
@@ -281,7 +278,25 @@ class CPL_DLL GDALProxyPoolRasterBand : public GDALProxyRasterBand
         GDALProxyPoolOverviewRasterBand **papoProxyOverviewRasterBand;
         GDALProxyPoolMaskBand            *poProxyMaskBand;
 
+        /* Where each currently referenced underlying band comes from: the */
+        /* pooled dataset for main bands, or the underlying main band for */
+        /* overview and mask bands. Several threads may hold references. */
+        struct UnderlyingRef
+        {
+            GDALDataset    *poDataset;
+            GDALRasterBand *poMainBand;
+            int             nRefCount;
+        };
+        std::map<GDALRasterBand*, UnderlyingRef> oMapUnderlyingRefs;
+        CPLMutex        *hMutexUnderlyingRefs;
+
         void Init();
+        void AddUnderlyingRef(GDALRasterBand* poUnderlyingRasterBand,
+                              GDALDataset* poUnderlyingDataset,
+                              GDALRasterBand* poUnderlyingMainRasterBand);
+        bool RemoveUnderlyingRef(GDALRasterBand* poUnderlyingRasterBand,
+                                 GDALDataset** ppoUnderlyingDataset,
+                                 GDALRasterBand** ppoUnderlyingMainRasterBand);
 
     protected:
         virtual GDALRasterBand* RefUnderlyingRasterBand();
@@ -326,9 +341,6 @@ class GDALProxyPoolOverviewRasterBand : public GDALProxyPoolRasterBand
         GDALProxyPoolRasterBand *poMainBand;
         int                      nOverviewBand;
 
-        GDALRasterBand          *poUnderlyingMainRasterBand;
-        int                      nRefCountUnderlyingMainRasterBand;
-
     protected:
         virtual GDALRasterBand* RefUnderlyingRasterBand();
         virtual void UnrefUnderlyingRasterBand(GDALRasterBand* poUnderlyingRasterBand);
@@ -350,9 +362,6 @@ class GDALProxyPoolMaskBand : public GDALProxyPoolRasterBand
     private:
         GDALProxyPoolRasterBand *poMainBand;
 
-        GDALRasterBand          *poUnderlyingMainRasterBand;
-        int                      nRefCountUnderlyingMainRasterBand;
-
     protected:
         virtual GDALRasterBand* RefUnderlyingRasterBand();
         virtual void UnrefUnderlyingRasterBand(GDALRasterBand* poUnderlyingRasterBand);
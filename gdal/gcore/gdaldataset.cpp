@@ -31,6 +31,7 @@
 #include "cpl_hash_set.h"
 #include "cpl_multiproc.h"
 #include "cpl_vsi_error.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_priv.h"
 #include "ogr_attrind.h"
 #include "ogr_featurestyle.h"
@@ -46,6 +47,7 @@
 #endif
 
 #include <algorithm>
+#include <deque>
 #include <map>
 #include <new>
 
@@ -74,6 +76,14 @@ typedef enum
 const GIntBig TOTAL_FEATURES_NOT_INIT = -2;
 const GIntBig TOTAL_FEATURES_UNKNOWN = -1;
 
+// Block to be loaded in the block cache by the prefetching thread.
+typedef struct
+{
+    GDALRasterBand *poBand;
+    int             nXBlockOff;
+    int             nYBlockOff;
+} GDALPrefetchRequest;
+
 class GDALDatasetPrivate
 {
     public:
@@ -91,6 +101,15 @@ class GDALDatasetPrivate
         GIntBig   nTotalFeatures;
         OGRLayer *poCurrentLayer;
 
+        // State of the prefetching of blocks done by AdviseRead()
+        bool      bPrefetchEnabled;
+        CPLWorkerThreadPool *poPrefetchThreadPool;
+        CPLMutex *hPrefetchMutex;
+        CPLCond  *hPrefetchCond;
+        std::deque<GDALPrefetchRequest> aoPrefetchRequests;
+        bool      bPrefetchJobRunning;
+        GIntBig   nPrefetchThreadPID;
+
         GDALDatasetPrivate() :
             hMutex(NULL),
             eStateReadWriteMutex(RW_MUTEX_STATE_UNKNOWN),
@@ -100,7 +119,13 @@ class GDALDatasetPrivate
             nFeatureReadInDataset(0),
             nTotalFeaturesInLayer(TOTAL_FEATURES_NOT_INIT),
             nTotalFeatures(TOTAL_FEATURES_NOT_INIT),
-            poCurrentLayer(NULL)
+            poCurrentLayer(NULL),
+            bPrefetchEnabled(false),
+            poPrefetchThreadPool(NULL),
+            hPrefetchMutex(NULL),
+            hPrefetchCond(NULL),
+            bPrefetchJobRunning(false),
+            nPrefetchThreadPID(0)
         {}
 };
 
@@ -269,6 +294,9 @@ void GDALDataset::Init(bool bForceCachedIOIn)
 GDALDataset::~GDALDataset()
 
 {
+    // Normally already done by GDALClose() or FlushCache().
+    StopPrefetch();
+
     // we don't want to report destruction of datasets that
     // were never really open or meant as internal
     if( !bIsInternal && ( nBands != 0 || !EQUAL(GetDescription(),"") ) )
@@ -350,6 +378,14 @@ GDALDataset::~GDALDataset()
     }
 
     GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
+    if( psPrivate != NULL )
+    {
+        delete psPrivate->poPrefetchThreadPool;
+        if( psPrivate->hPrefetchCond != NULL )
+            CPLDestroyCond( psPrivate->hPrefetchCond );
+        if( psPrivate->hPrefetchMutex != NULL )
+            CPLDestroyMutex( psPrivate->hPrefetchMutex );
+    }
     if( psPrivate != NULL && psPrivate->hMutex != NULL )
         CPLDestroyMutex( psPrivate->hMutex );
     delete psPrivate;
@@ -401,6 +437,8 @@ void GDALDataset::AddToDatasetOpenList()
 void GDALDataset::FlushCache()
 
 {
+    StopPrefetch();
+
     // This sometimes happens if a dataset is destroyed before completely
     // built.
 
@@ -3010,13 +3048,17 @@ void CPL_STDCALL GDALClose( GDALDatasetH hDS )
         if( poDS->Dereference() > 0 )
             return;
 
+        poDS->StopPrefetch();
         delete poDS;
         return;
     }
 
 /* -------------------------------------------------------------------- */
 /*      This is not shared dataset, so directly delete it.              */
+/*      Pending prefetching must be stopped before the destructor of    */
+/*      the driver releases its resources.                              */
 /* -------------------------------------------------------------------- */
+    poDS->StopPrefetch();
     delete poDS;
 }
 
@@ -6612,7 +6654,8 @@ OGRErr GDALDatasetRollbackTransaction(GDALDatasetH hDS)
 int GDALDataset::EnterReadWrite(GDALRWFlag eRWFlag)
 {
     GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
-    if( psPrivate != NULL && eAccess == GA_Update )
+    if( psPrivate != NULL &&
+        (eAccess == GA_Update || psPrivate->bPrefetchEnabled) )
     {
         if( psPrivate->eStateReadWriteMutex == RW_MUTEX_STATE_UNKNOWN )
         {
@@ -6775,4 +6818,197 @@ void GDALDataset::ReleaseMutex()
     if( psPrivate )
         CPLReleaseMutex(psPrivate->hMutex);
 }
+
+/************************************************************************/
+/*                         IsPrefetchEnabled()                          */
+/************************************************************************/
+
+bool GDALDataset::IsPrefetchEnabled()
+{
+    GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
+    return psPrivate != NULL && psPrivate->bPrefetchEnabled;
+}
+
+/************************************************************************/
+/*                       GDALDatasetPrefetchJob()                       */
+/************************************************************************/
+
+static void GDALDatasetPrefetchJob( void* pData )
+{
+    GDALDatasetPrivate* psPrivate = static_cast<GDALDatasetPrivate*>(pData);
+
+    // Errors will be emitted again when the block is read by the caller.
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    while( true )
+    {
+        CPLAcquireMutex(psPrivate->hPrefetchMutex, 1000.0);
+        if( psPrivate->aoPrefetchRequests.empty() )
+        {
+            psPrivate->bPrefetchJobRunning = false;
+            CPLCondBroadcast(psPrivate->hPrefetchCond);
+            CPLReleaseMutex(psPrivate->hPrefetchMutex);
+            break;
+        }
+        const GDALPrefetchRequest sRequest =
+            psPrivate->aoPrefetchRequests.front();
+        psPrivate->aoPrefetchRequests.pop_front();
+        psPrivate->nPrefetchThreadPID = CPLGetPID();
+        CPLReleaseMutex(psPrivate->hPrefetchMutex);
+
+        GDALRasterBlock* poBlock =
+            sRequest.poBand->GetLockedBlockRef(sRequest.nXBlockOff,
+                                               sRequest.nYBlockOff);
+        if( poBlock != NULL )
+            poBlock->DropLock();
+        CPLErrorReset();
+    }
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                          PrefetchBlocks()                            */
+/************************************************************************/
+
+// Queue the blocks of a window of a band of this dataset to be loaded in the
+// block cache by a background thread. Pending requests of the same band are
+// superseded by the new ones.
+CPLErr GDALDataset::PrefetchBlocks( GDALRasterBand* poBand,
+                                    int nXBlockOff, int nYBlockOff,
+                                    int nXBlocks, int nYBlocks )
+{
+    GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
+    if( psPrivate == NULL || eAccess != GA_ReadOnly )
+        return CE_None;
+
+    if( !psPrivate->bPrefetchEnabled )
+    {
+        // Reads must be serialized with the read-write mutex, so we cannot
+        // work without it.
+        if( psPrivate->eStateReadWriteMutex == RW_MUTEX_STATE_UNKNOWN )
+        {
+            psPrivate->eStateReadWriteMutex =
+                CPLTestBool(CPLGetConfigOption("GDAL_ENABLE_READ_WRITE_MUTEX",
+                                               "YES")) ?
+                    RW_MUTEX_STATE_ALLOWED : RW_MUTEX_STATE_DISABLED;
+        }
+        if( psPrivate->eStateReadWriteMutex != RW_MUTEX_STATE_ALLOWED )
+            return CE_None;
+
+        if( psPrivate->hMutex == NULL )
+        {
+            psPrivate->hMutex = CPLCreateMutex();
+            if( psPrivate->hMutex == NULL )
+                return CE_None;
+            CPLReleaseMutex(psPrivate->hMutex);
+        }
+        psPrivate->hPrefetchMutex = CPLCreateMutex();
+        if( psPrivate->hPrefetchMutex == NULL )
+            return CE_None;
+        CPLReleaseMutex(psPrivate->hPrefetchMutex);
+        psPrivate->hPrefetchCond = CPLCreateCond();
+        psPrivate->poPrefetchThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+        if( psPrivate->hPrefetchCond == NULL ||
+            psPrivate->poPrefetchThreadPool == NULL ||
+            !psPrivate->poPrefetchThreadPool->Setup(1, NULL, NULL) )
+        {
+            delete psPrivate->poPrefetchThreadPool;
+            psPrivate->poPrefetchThreadPool = NULL;
+            if( psPrivate->hPrefetchCond != NULL )
+                CPLDestroyCond(psPrivate->hPrefetchCond);
+            psPrivate->hPrefetchCond = NULL;
+            CPLDestroyMutex(psPrivate->hPrefetchMutex);
+            psPrivate->hPrefetchMutex = NULL;
+            return CE_None;
+        }
+        CPLDebug("GDAL", "Enabling prefetching of blocks of %s",
+                 GetDescription());
+        psPrivate->bPrefetchEnabled = true;
+    }
+
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const GIntBig nBlockBytes = static_cast<GIntBig>(nBlockXSize) *
+        nBlockYSize * GDALGetDataTypeSizeBytes(poBand->GetRasterDataType());
+    // Do not prefetch more than what would fit in half of the block cache,
+    // otherwise the prefetched blocks would evict each other.
+    const GIntBig nMaxBytes = GDALGetCacheMax64() / 2;
+
+    CPLMutexHolderD( &(psPrivate->hPrefetchMutex) );
+
+    std::deque<GDALPrefetchRequest> aoRequests;
+    GIntBig nQueuedBytes = 0;
+    for( size_t i = 0; i < psPrivate->aoPrefetchRequests.size(); i++ )
+    {
+        const GDALPrefetchRequest& sRequest = psPrivate->aoPrefetchRequests[i];
+        if( sRequest.poBand != poBand )
+        {
+            aoRequests.push_back(sRequest);
+            int nOtherBlockXSize = 0;
+            int nOtherBlockYSize = 0;
+            sRequest.poBand->GetBlockSize(&nOtherBlockXSize,
+                                          &nOtherBlockYSize);
+            nQueuedBytes += static_cast<GIntBig>(nOtherBlockXSize) *
+                nOtherBlockYSize * GDALGetDataTypeSizeBytes(
+                    sRequest.poBand->GetRasterDataType());
+        }
+    }
+    for( int iY = 0; iY < nYBlocks; iY++ )
+    {
+        for( int iX = 0; iX < nXBlocks; iX++ )
+        {
+            if( nQueuedBytes + nBlockBytes > nMaxBytes )
+                break;
+            nQueuedBytes += nBlockBytes;
+            GDALPrefetchRequest sRequest;
+            sRequest.poBand = poBand;
+            sRequest.nXBlockOff = nXBlockOff + iX;
+            sRequest.nYBlockOff = nYBlockOff + iY;
+            aoRequests.push_back(sRequest);
+        }
+    }
+    psPrivate->aoPrefetchRequests.swap(aoRequests);
+
+    if( !psPrivate->bPrefetchJobRunning &&
+        !psPrivate->aoPrefetchRequests.empty() )
+    {
+        psPrivate->bPrefetchJobRunning = true;
+        psPrivate->poPrefetchThreadPool->SubmitJob(GDALDatasetPrefetchJob,
+                                                   psPrivate);
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                           StopPrefetch()                             */
+/************************************************************************/
+
+// Cancel pending prefetch requests and wait for the block being loaded, if
+// any. Must be called before the resources used by IReadBlock() are released.
+void GDALDataset::StopPrefetch()
+{
+    GDALDatasetPrivate* psPrivate = (GDALDatasetPrivate* )m_hPrivateData;
+    if( psPrivate == NULL || psPrivate->hPrefetchMutex == NULL )
+        return;
+
+    CPLAcquireMutex(psPrivate->hPrefetchMutex, 1000.0);
+    psPrivate->aoPrefetchRequests.clear();
+    // Nothing to wait for if we are called from the prefetching thread
+    // itself.
+    const bool bWait = psPrivate->bPrefetchJobRunning &&
+                       psPrivate->nPrefetchThreadPID != CPLGetPID();
+    CPLReleaseMutex(psPrivate->hPrefetchMutex);
+    if( !bWait )
+        return;
+
+    // The prefetching thread might wait for the read-write lock held
+    // by the current thread.
+    TemporarilyDropReadWriteLock();
+    CPLAcquireMutex(psPrivate->hPrefetchMutex, 1000.0);
+    while( psPrivate->bPrefetchJobRunning )
+        CPLCondWait(psPrivate->hPrefetchCond, psPrivate->hPrefetchMutex);
+    CPLReleaseMutex(psPrivate->hPrefetchMutex);
+    ReacquireReadWriteLock();
+}
 //! @endcond
@@ -277,6 +277,11 @@ GDALDriverManager::~GDALDriverManager()
 /* -------------------------------------------------------------------- */
     GDALCleanupTransformDeserializerMutex();
 
+/* -------------------------------------------------------------------- */
+/*      Cleanup the warper source coordinate grid cache.                */
+/* -------------------------------------------------------------------- */
+    GDALCleanupWarpSrcCoordCache();
+
 /* -------------------------------------------------------------------- */
 /*      Cleanup cpl_error.cpp mutex.                                    */
 /* -------------------------------------------------------------------- */
@@ -28,8 +28,12 @@
  ****************************************************************************/
 
 #include "gdal_proxy.h"
+#include "cpl_atomic_ops.h"
 #include "cpl_multiproc.h"
 
+#include <algorithm>
+#include <vector>
+
 //! @cond Doxygen_Suppress
 
 CPL_CVSID("$Id$");
@@ -38,6 +42,11 @@ CPL_CVSID("$Id$");
 /* doing GDALOpen() calls that can indirectly call GDALOpenShared() on */
 /* an auxiliary dataset ... */
 /* Then we could get dead-locks in multi-threaded use case */
+/* That mutex is only taken when a dataset must be opened or closed. Getting */
+/* a dataset that is already opened only takes the mutex of the shard of the */
+/* pool where it is stored, so that threads reading from opened datasets do */
+/* not block each other. When both are needed, GDALGetphDLMutex() is always */
+/* taken first, and a thread never holds more than one shard mutex. */
 
 /* ******************************************************************** */
 /*                         GDALDatasetPool                              */
@@ -46,22 +55,46 @@ CPL_CVSID("$Id$");
 /* This class is a singleton that maintains a pool of opened datasets */
 /* The cache uses a LRU strategy */
 
+/* The pool may hold several handles on the same dataset, so that several */
+/* threads can use a GDALProxyPoolDataset at the same time. A thread gets */
+/* preferably the handle it used last, and a handle is never given to two */
+/* threads at once. */
+
 class GDALDatasetPool;
 static GDALDatasetPool* singleton = NULL;
 
 void GDALNullifyProxyPoolSingleton() { singleton = NULL; }
 
+typedef struct _GDALProxyPoolCacheEntry GDALProxyPoolCacheEntry;
+
 struct _GDALProxyPoolCacheEntry
 {
     GIntBig       responsiblePID;
     char         *pszFileName;
+    GDALAccess    eAccess;
+    char        **papszOpenOptions;
+    unsigned long nHash;
     GDALDataset  *poDS;
 
     /* Ref count of the cached dataset */
     int           refCount;
 
-    GDALProxyPoolCacheEntry* prev;
-    GDALProxyPoolCacheEntry* next;
+    /* Thread that holds the references when refCount > 0, or that */
+    /* used the dataset last otherwise */
+    GIntBig       nThreadId;
+
+    /* Value of the pool use counter when the dataset was last referenced */
+    int           nLastUse;
+};
+
+#define GDAL_PROXY_POOL_SHARD_COUNT 16
+
+/* Part of the pool that stores the entries whose file name hash modulo */
+/* GDAL_PROXY_POOL_SHARD_COUNT is its index in the pool. */
+struct GDALProxyPoolShard
+{
+    CPLMutex                             *hMutex;
+    std::vector<GDALProxyPoolCacheEntry*> apoEntries;
 };
 
 class GDALDatasetPool
@@ -74,9 +107,14 @@ class GDALDatasetPool
         int refCount;
 
         int maxSize;
+
+        /* Number of opened entries. Only modified with GDALGetphDLMutex() */
         int currentSize;
-        GDALProxyPoolCacheEntry* firstEntry;
-        GDALProxyPoolCacheEntry* lastEntry;
+
+        /* Incremented each time a dataset is referenced */
+        volatile int nUseCounter;
+
+        GDALProxyPoolShard aoShards[GDAL_PROXY_POOL_SHARD_COUNT];
 
         /* This variable prevents a dataset that is going to be opened in GDALDatasetPool::_RefDataset */
         /* from increasing refCount if, during its opening, it creates a GDALProxyPoolDataset */
@@ -88,25 +126,37 @@ class GDALDatasetPool
 
         /* Caution : to be sure that we don't run out of entries, size must be at */
         /* least greater or equal than the maximum number of threads */
-        GDALDatasetPool(int maxSize);
+        explicit GDALDatasetPool(int maxSize);
         ~GDALDatasetPool();
+
+        GDALProxyPoolShard& GetShard(unsigned long nHash)
+            { return aoShards[nHash % GDAL_PROXY_POOL_SHARD_COUNT]; }
+        GDALProxyPoolCacheEntry* _FindDataset(GDALProxyPoolShard& oShard,
+                                              const char* pszFileName,
+                                              unsigned long nHash,
+                                              GDALAccess eAccess,
+                                              char** papszOpenOptions,
+                                              int bShared);
         GDALProxyPoolCacheEntry* _RefDataset(const char* pszFileName,
                                              GDALAccess eAccess,
                                              char** papszOpenOptions,
                                              int bShared);
+        void _UnrefDataset(const char* pszFileName, GDALDataset* poDS);
+        void _UnrefEntry(GDALProxyPoolCacheEntry* cacheEntry);
         void _CloseDataset(const char* pszFileName, GDALAccess eAccess);
+        bool _CloseLeastRecentlyUsed();
+        void _CloseEntry(GDALProxyPoolCacheEntry* cacheEntry);
 
         void ShowContent();
-        void CheckLinks();
 
     public:
         static void Ref();
         static void Unref();
-        static GDALProxyPoolCacheEntry* RefDataset(const char* pszFileName,
-                                                   GDALAccess eAccess,
-                                                   char** papszOpenOptions,
-                                                   int bShared);
-        static void UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry);
+        static GDALDataset* RefDataset(const char* pszFileName,
+                                       GDALAccess eAccess,
+                                       char** papszOpenOptions,
+                                       int bShared);
+        static void UnrefDataset(const char* pszFileName, GDALDataset* poDS);
         static void CloseDataset(const char* pszFileName, GDALAccess eAccess);
 
         static void PreventDestroy();
@@ -121,10 +171,14 @@ GDALDatasetPool::GDALDatasetPool(int maxSizeIn)
 {
     maxSize = maxSizeIn;
     currentSize = 0;
-    firstEntry = NULL;
-    lastEntry = NULL;
+    nUseCounter = 0;
     refCount = 0;
     refCountOfDisableRefCount = 0;
+    for( int i = 0; i < GDAL_PROXY_POOL_SHARD_COUNT; i++ )
+    {
+        aoShards[i].hMutex = CPLCreateMutex();
+        CPLReleaseMutex(aoShards[i].hMutex);
+    }
 }
 
 /************************************************************************/
@@ -133,20 +187,25 @@ GDALDatasetPool::GDALDatasetPool(int maxSizeIn)
 
 GDALDatasetPool::~GDALDatasetPool()
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
     GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
-    while(cur)
+    for( int i = 0; i < GDAL_PROXY_POOL_SHARD_COUNT; i++ )
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
-        CPLFree(cur->pszFileName);
-        CPLAssert(cur->refCount == 0);
-        if (cur->poDS)
+        std::vector<GDALProxyPoolCacheEntry*>& apoEntries =
+            aoShards[i].apoEntries;
+        for( size_t j = 0; j < apoEntries.size(); j++ )
         {
-            GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
-            GDALClose(cur->poDS);
+            GDALProxyPoolCacheEntry* cur = apoEntries[j];
+            CPLAssert(cur->refCount == 0);
+            if (cur->poDS)
+            {
+                GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
+                GDALClose(cur->poDS);
+            }
+            CPLFree(cur->pszFileName);
+            CSLDestroy(cur->papszOpenOptions);
+            CPLFree(cur);
         }
-        CPLFree(cur);
-        cur = next;
+        CPLDestroyMutex(aoShards[i].hMutex);
     }
     GDALSetResponsiblePIDForCurrentThread(responsiblePID);
 }
@@ -157,34 +216,87 @@ GDALDatasetPool::~GDALDatasetPool()
 
 void GDALDatasetPool::ShowContent()
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
     int i = 0;
-    while(cur)
+    for( int iShard = 0; iShard < GDAL_PROXY_POOL_SHARD_COUNT; iShard++ )
     {
-        printf("[%d] pszFileName=%s, refCount=%d, responsiblePID=%d\n",
-               i, cur->pszFileName, cur->refCount, (int)cur->responsiblePID);
-        i++;
-        cur = cur->next;
+        CPLMutexHolder oShardHolder(&aoShards[iShard].hMutex);
+        std::vector<GDALProxyPoolCacheEntry*>& apoEntries =
+            aoShards[iShard].apoEntries;
+        for( size_t j = 0; j < apoEntries.size(); j++ )
+        {
+            GDALProxyPoolCacheEntry* cur = apoEntries[j];
+            printf("[%d] pszFileName=%s, refCount=%d, responsiblePID=%d, "
+                   "threadId=%d, lastUse=%d\n",
+                   i, cur->pszFileName, cur->refCount,
+                   (int)cur->responsiblePID, (int)cur->nThreadId,
+                   cur->nLastUse);
+            i++;
+        }
     }
 }
 
 /************************************************************************/
-/*                             CheckLinks()                             */
+/*                            _FindDataset()                            */
 /************************************************************************/
 
-void GDALDatasetPool::CheckLinks()
+/* Looks for an opened handle that the current thread can use, and */
+/* references it. The mutex of the shard must be held. */
+
+GDALProxyPoolCacheEntry* GDALDatasetPool::_FindDataset(
+    GDALProxyPoolShard& oShard, const char* pszFileName, unsigned long nHash,
+    GDALAccess eAccess, char** papszOpenOptions, int bShared)
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    int i = 0;
-    while(cur)
+    const GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
+    const GIntBig nThreadId = CPLGetPID();
+    GDALProxyPoolCacheEntry* poIdleEntry = NULL;
+    GDALProxyPoolCacheEntry* poEntry = NULL;
+
+    for( size_t i = 0; i < oShard.apoEntries.size(); i++ )
     {
-        CPLAssert(cur == firstEntry || cur->prev->next == cur);
-        CPLAssert(cur == lastEntry || cur->next->prev == cur);
-        ++i;
-        CPLAssert(cur->next != NULL || cur == lastEntry);
-        cur = cur->next;
+        GDALProxyPoolCacheEntry* cur = oShard.apoEntries[i];
+        if( cur->nHash != nHash || cur->eAccess != eAccess ||
+            strcmp(cur->pszFileName, pszFileName) != 0 ||
+            (bShared && cur->responsiblePID != responsiblePID) )
+            continue;
+
+        bool bSameOpenOptions =
+            CSLCount(cur->papszOpenOptions) == CSLCount(papszOpenOptions);
+        for( int j = 0; bSameOpenOptions && papszOpenOptions != NULL &&
+                        papszOpenOptions[j] != NULL; j++ )
+        {
+            bSameOpenOptions = strcmp(cur->papszOpenOptions[j],
+                                      papszOpenOptions[j]) == 0;
+        }
+        if( !bSameOpenOptions )
+            continue;
+
+        if( cur->refCount > 0 )
+        {
+            /* A shared dataset referenced again by the thread that is */
+            /* using it must get the same handle */
+            if( bShared && cur->nThreadId == nThreadId )
+            {
+                poEntry = cur;
+                break;
+            }
+        }
+        else if( poIdleEntry == NULL ||
+                 (cur->nThreadId == nThreadId &&
+                  poIdleEntry->nThreadId != nThreadId) )
+        {
+            poIdleEntry = cur;
+        }
     }
-    CPLAssert(i == currentSize);
+
+    if( poEntry == NULL )
+        poEntry = poIdleEntry;
+    if( poEntry != NULL )
+    {
+        poEntry->refCount ++;
+        poEntry->nThreadId = nThreadId;
+        poEntry->nLastUse = CPLAtomicInc(&nUseCounter);
+    }
+    return poEntry;
 }
 
 /************************************************************************/
@@ -196,161 +308,212 @@ GDALProxyPoolCacheEntry* GDALDatasetPool::_RefDataset(const char* pszFileName,
                                                       char** papszOpenOptions,
                                                       int bShared)
 {
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
-    GDALProxyPoolCacheEntry* lastEntryWithZeroRefCount = NULL;
+    const unsigned long nHash = CPLHashSetHashStr(pszFileName);
+    GDALProxyPoolShard& oShard = GetShard(nHash);
 
-    while(cur)
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
-
-        if (strcmp(cur->pszFileName, pszFileName) == 0 &&
-            ((bShared && cur->responsiblePID == responsiblePID) ||
-             (!bShared && cur->refCount == 0)) )
-        {
-            if (cur != firstEntry)
-            {
-                /* Move to begin */
-                if (cur->next)
-                    cur->next->prev = cur->prev;
-                else
-                    lastEntry = cur->prev;
-                cur->prev->next = cur->next;
-                cur->prev = NULL;
-                firstEntry->prev = cur;
-                cur->next = firstEntry;
-                firstEntry = cur;
-
-#ifdef DEBUG_PROXY_POOL
-                CheckLinks();
-#endif
-            }
-
-            cur->refCount ++;
+        CPLMutexHolder oShardHolder(&oShard.hMutex);
+        GDALProxyPoolCacheEntry* cur = _FindDataset(
+            oShard, pszFileName, nHash, eAccess, papszOpenOptions, bShared);
+        if( cur != NULL )
             return cur;
-        }
-
-        if (cur->refCount == 0)
-            lastEntryWithZeroRefCount = cur;
-
-        cur = next;
     }
 
-    if (currentSize == maxSize)
-    {
-        if (lastEntryWithZeroRefCount == NULL)
-        {
-            CPLError(CE_Failure, CPLE_AppDefined,
-                     "Too many threads are running for the current value of the dataset pool size (%d).\n"
-                     "or too many proxy datasets are opened in a cascaded way.\n"
-                     "Try increasing GDAL_MAX_DATASET_POOL_SIZE.", maxSize);
-            return NULL;
-        }
-
-        lastEntryWithZeroRefCount->pszFileName[0] = '\0';
-        if (lastEntryWithZeroRefCount->poDS)
-        {
-            /* Close by pretending we are the thread that GDALOpen'ed this */
-            /* dataset */
-            GDALSetResponsiblePIDForCurrentThread(lastEntryWithZeroRefCount->responsiblePID);
-
-            refCountOfDisableRefCount ++;
-            GDALClose(lastEntryWithZeroRefCount->poDS);
-            refCountOfDisableRefCount --;
+    CPLMutexHolderD( GDALGetphDLMutex() );
 
-            lastEntryWithZeroRefCount->poDS = NULL;
-            GDALSetResponsiblePIDForCurrentThread(responsiblePID);
-        }
-        CPLFree(lastEntryWithZeroRefCount->pszFileName);
-
-        /* Recycle this entry for the to-be-opened dataset and */
-        /* moves it to the top of the list */
-        if (lastEntryWithZeroRefCount->prev)
-            lastEntryWithZeroRefCount->prev->next = lastEntryWithZeroRefCount->next;
-        else {
-            CPLAssert(false);
-        }
-        if (lastEntryWithZeroRefCount->next)
-            lastEntryWithZeroRefCount->next->prev = lastEntryWithZeroRefCount->prev;
-        else
-        {
-            CPLAssert(lastEntryWithZeroRefCount == lastEntry);
-            lastEntry->prev->next = NULL;
-            lastEntry = lastEntry->prev;
-        }
-        lastEntryWithZeroRefCount->prev = NULL;
-        lastEntryWithZeroRefCount->next = firstEntry;
-        firstEntry->prev = lastEntryWithZeroRefCount;
-        cur = firstEntry = lastEntryWithZeroRefCount;
-#ifdef DEBUG_PROXY_POOL
-        CheckLinks();
-#endif
+    /* Another thread may have released a handle in the meantime */
+    {
+        CPLMutexHolder oShardHolder(&oShard.hMutex);
+        GDALProxyPoolCacheEntry* cur = _FindDataset(
+            oShard, pszFileName, nHash, eAccess, papszOpenOptions, bShared);
+        if( cur != NULL )
+            return cur;
     }
-    else
+
+    if (currentSize == maxSize && !_CloseLeastRecentlyUsed())
     {
-        /* Prepend */
-        cur = (GDALProxyPoolCacheEntry*) CPLMalloc(sizeof(GDALProxyPoolCacheEntry));
-        if (lastEntry == NULL)
-            lastEntry = cur;
-        cur->prev = NULL;
-        cur->next = firstEntry;
-        if (firstEntry)
-            firstEntry->prev = cur;
-        firstEntry = cur;
-        currentSize ++;
-#ifdef DEBUG_PROXY_POOL
-        CheckLinks();
-#endif
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Too many threads are running for the current value of the dataset pool size (%d).\n"
+                 "or too many proxy datasets are opened in a cascaded way.\n"
+                 "Try increasing GDAL_MAX_DATASET_POOL_SIZE.", maxSize);
+        return NULL;
     }
 
+    GDALProxyPoolCacheEntry* cur = static_cast<GDALProxyPoolCacheEntry*>(
+        CPLMalloc(sizeof(GDALProxyPoolCacheEntry)));
     cur->pszFileName = CPLStrdup(pszFileName);
-    cur->responsiblePID = responsiblePID;
+    cur->eAccess = eAccess;
+    cur->papszOpenOptions = CSLDuplicate(papszOpenOptions);
+    cur->nHash = nHash;
+    cur->responsiblePID = GDALGetResponsiblePIDForCurrentThread();
     cur->refCount = 1;
+    cur->nThreadId = CPLGetPID();
+    cur->nLastUse = CPLAtomicInc(&nUseCounter);
+    currentSize ++;
 
+    /* The entry is only made visible to the other threads once opened, */
+    /* so that they don't block on its shard in the meantime */
     refCountOfDisableRefCount ++;
     int nFlag = ((eAccess == GA_Update) ? GDAL_OF_UPDATE : GDAL_OF_READONLY) | GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR;
     cur->poDS = (GDALDataset*) GDALOpenEx( pszFileName, nFlag, NULL,
                            (const char* const* )papszOpenOptions, NULL );
     refCountOfDisableRefCount --;
 
+    {
+        CPLMutexHolder oShardHolder(&oShard.hMutex);
+        oShard.apoEntries.push_back(cur);
+    }
+
     return cur;
 }
 
 /************************************************************************/
-/*                       _CloseDataset()                                */
+/*                      _CloseLeastRecentlyUsed()                       */
 /************************************************************************/
 
-void GDALDatasetPool::_CloseDataset( const char* pszFileName,
-                                     GDALAccess /* eAccess */ )
-{
-    GDALProxyPoolCacheEntry* cur = firstEntry;
-    GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
+/* Closes the least recently used dataset that is not referenced. */
+/* GDALGetphDLMutex() must be held. */
 
-    while(cur)
+bool GDALDatasetPool::_CloseLeastRecentlyUsed()
+{
+    while( true )
     {
-        GDALProxyPoolCacheEntry* next = cur->next;
+        GDALProxyPoolCacheEntry* poLRUEntry = NULL;
+        int iLRUShard = -1;
+        unsigned int nMaxAge = 0;
+        for( int iShard = 0; iShard < GDAL_PROXY_POOL_SHARD_COUNT; iShard++ )
+        {
+            CPLMutexHolder oShardHolder(&aoShards[iShard].hMutex);
+            // No entry of the shard can have been used after that.
+            const unsigned int nNow = static_cast<unsigned int>(nUseCounter);
+            std::vector<GDALProxyPoolCacheEntry*>& apoEntries =
+                aoShards[iShard].apoEntries;
+            for( size_t i = 0; i < apoEntries.size(); i++ )
+            {
+                GDALProxyPoolCacheEntry* cur = apoEntries[i];
+                const unsigned int nAge =
+                    nNow - static_cast<unsigned int>(cur->nLastUse);
+                if( cur->refCount == 0 &&
+                    (poLRUEntry == NULL || nAge > nMaxAge) )
+                {
+                    poLRUEntry = cur;
+                    iLRUShard = iShard;
+                    nMaxAge = nAge;
+                }
+            }
+        }
+        if( poLRUEntry == NULL )
+            return false;
 
-        CPLAssert(cur->pszFileName);
-        if (strcmp(cur->pszFileName, pszFileName) == 0 && cur->refCount == 0 &&
-            cur->poDS != NULL )
         {
-            /* Close by pretending we are the thread that GDALOpen'ed this */
-            /* dataset */
-            GDALSetResponsiblePIDForCurrentThread(cur->responsiblePID);
+            CPLMutexHolder oShardHolder(&aoShards[iLRUShard].hMutex);
+            /* It might have been referenced again after the scan */
+            if( poLRUEntry->refCount != 0 )
+                continue;
+            std::vector<GDALProxyPoolCacheEntry*>& apoEntries =
+                aoShards[iLRUShard].apoEntries;
+            apoEntries.erase(std::find(apoEntries.begin(), apoEntries.end(),
+                                       poLRUEntry));
+        }
+
+        _CloseEntry(poLRUEntry);
+        return true;
+    }
+}
+
+/************************************************************************/
+/*                            _CloseEntry()                             */
+/************************************************************************/
+
+/* Closes and frees an entry that has been removed from its shard. */
+/* GDALGetphDLMutex() must be held. */
 
-            refCountOfDisableRefCount ++;
-            GDALClose(cur->poDS);
-            refCountOfDisableRefCount --;
+void GDALDatasetPool::_CloseEntry(GDALProxyPoolCacheEntry* cacheEntry)
+{
+    if (cacheEntry->poDS)
+    {
+        /* Close by pretending we are the thread that GDALOpen'ed this */
+        /* dataset */
+        GIntBig responsiblePID = GDALGetResponsiblePIDForCurrentThread();
+        GDALSetResponsiblePIDForCurrentThread(cacheEntry->responsiblePID);
+
+        refCountOfDisableRefCount ++;
+        GDALClose(cacheEntry->poDS);
+        refCountOfDisableRefCount --;
+
+        GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+    }
+    CPLFree(cacheEntry->pszFileName);
+    CSLDestroy(cacheEntry->papszOpenOptions);
+    CPLFree(cacheEntry);
+    currentSize --;
+}
 
-            GDALSetResponsiblePIDForCurrentThread(responsiblePID);
+/************************************************************************/
+/*                           _UnrefDataset()                            */
+/************************************************************************/
 
-            cur->poDS = NULL;
-            cur->pszFileName[0] = '\0';
-            break;
+void GDALDatasetPool::_UnrefDataset(const char* pszFileName,
+                                    GDALDataset* poDS)
+{
+    GDALProxyPoolShard& oShard = GetShard(CPLHashSetHashStr(pszFileName));
+    CPLMutexHolder oShardHolder(&oShard.hMutex);
+    for( size_t i = 0; i < oShard.apoEntries.size(); i++ )
+    {
+        GDALProxyPoolCacheEntry* cur = oShard.apoEntries[i];
+        if( cur->poDS == poDS && cur->refCount > 0 )
+        {
+            cur->refCount --;
+            return;
         }
+    }
+    CPLAssert(false);
+}
+
+/************************************************************************/
+/*                            _UnrefEntry()                             */
+/************************************************************************/
+
+void GDALDatasetPool::_UnrefEntry(GDALProxyPoolCacheEntry* cacheEntry)
+{
+    CPLMutexHolder oShardHolder(&GetShard(cacheEntry->nHash).hMutex);
+    cacheEntry->refCount --;
+}
+
+/************************************************************************/
+/*                       _CloseDataset()                                */
+/************************************************************************/
+
+/* Closes all the handles on a dataset that are not referenced. */
+/* GDALGetphDLMutex() must be held. */
+
+void GDALDatasetPool::_CloseDataset( const char* pszFileName,
+                                     GDALAccess eAccess )
+{
+    GDALProxyPoolShard& oShard = GetShard(CPLHashSetHashStr(pszFileName));
+    std::vector<GDALProxyPoolCacheEntry*> apoToClose;
 
-        cur = next;
+    {
+        CPLMutexHolder oShardHolder(&oShard.hMutex);
+        std::vector<GDALProxyPoolCacheEntry*>& apoEntries = oShard.apoEntries;
+        for( size_t i = 0; i < apoEntries.size(); )
+        {
+            GDALProxyPoolCacheEntry* cur = apoEntries[i];
+            if( cur->refCount == 0 && cur->eAccess == eAccess &&
+                strcmp(cur->pszFileName, pszFileName) == 0 )
+            {
+                apoToClose.push_back(cur);
+                apoEntries.erase(apoEntries.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
     }
+
+    for( size_t i = 0; i < apoToClose.size(); i++ )
+        _CloseEntry(apoToClose[i]);
 }
 
 /************************************************************************/
@@ -436,23 +599,28 @@ void GDALDatasetPoolForceDestroy()
 /*                           RefDataset()                               */
 /************************************************************************/
 
-GDALProxyPoolCacheEntry* GDALDatasetPool::RefDataset(const char* pszFileName,
-                                                     GDALAccess eAccess,
-                                                     char** papszOpenOptions,
-                                                     int bShared)
+GDALDataset* GDALDatasetPool::RefDataset(const char* pszFileName,
+                                         GDALAccess eAccess,
+                                         char** papszOpenOptions,
+                                         int bShared)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
-    return singleton->_RefDataset(pszFileName, eAccess, papszOpenOptions, bShared);
+    GDALProxyPoolCacheEntry* cacheEntry =
+        singleton->_RefDataset(pszFileName, eAccess, papszOpenOptions, bShared);
+    if (cacheEntry == NULL)
+        return NULL;
+    GDALDataset* poDS = cacheEntry->poDS;
+    if (poDS == NULL)
+        singleton->_UnrefEntry(cacheEntry);
+    return poDS;
 }
 
 /************************************************************************/
 /*                       UnrefDataset()                                 */
 /************************************************************************/
 
-void GDALDatasetPool::UnrefDataset(GDALProxyPoolCacheEntry* cacheEntry)
+void GDALDatasetPool::UnrefDataset(const char* pszFileName, GDALDataset* poDS)
 {
-    CPLMutexHolderD( GDALGetphDLMutex() );
-    cacheEntry->refCount --;
+    singleton->_UnrefDataset(pszFileName, poDS);
 }
 
 /************************************************************************/
@@ -595,7 +763,6 @@ GDALProxyPoolDataset::GDALProxyPoolDataset(const char* pszSourceDatasetDescripti
     pasGCPList = NULL;
     metadataSet = NULL;
     metadataItemSet = NULL;
-    cacheEntry = NULL;
 }
 
 /************************************************************************/
@@ -667,17 +834,11 @@ GDALDataset* GDALProxyPoolDataset::RefUnderlyingDataset()
     /* a VRT of GeoTIFFs that have associated .aux files */
     GIntBig curResponsiblePID = GDALGetResponsiblePIDForCurrentThread();
     GDALSetResponsiblePIDForCurrentThread(responsiblePID);
-    cacheEntry = GDALDatasetPool::RefDataset(GetDescription(), eAccess, papszOpenOptions,
-                                             GetShared());
+    GDALDataset* poUnderlyingDataset =
+        GDALDatasetPool::RefDataset(GetDescription(), eAccess,
+                                    papszOpenOptions, GetShared());
     GDALSetResponsiblePIDForCurrentThread(curResponsiblePID);
-    if (cacheEntry != NULL)
-    {
-        if (cacheEntry->poDS != NULL)
-            return cacheEntry->poDS;
-        else
-            GDALDatasetPool::UnrefDataset(cacheEntry);
-    }
-    return NULL;
+    return poUnderlyingDataset;
 }
 
 /************************************************************************/
@@ -685,14 +846,12 @@ GDALDataset* GDALProxyPoolDataset::RefUnderlyingDataset()
 /************************************************************************/
 
 void GDALProxyPoolDataset::UnrefUnderlyingDataset(
-    CPL_UNUSED GDALDataset* poUnderlyingDataset )
+    GDALDataset* poUnderlyingDataset )
 {
-    if (cacheEntry != NULL)
-    {
-        CPLAssert(cacheEntry->poDS == poUnderlyingDataset);
-        if (cacheEntry->poDS != NULL)
-            GDALDatasetPool::UnrefDataset(cacheEntry);
-    }
+    /* The same proxy may be used by several threads at once, each with its */
+    /* own underlying dataset, so the handle identifies the pool entry */
+    if (poUnderlyingDataset != NULL)
+        GDALDatasetPool::UnrefDataset(GetDescription(), poUnderlyingDataset);
 }
 
 /************************************************************************/
@@ -951,6 +1110,8 @@ void GDALProxyPoolRasterBand::Init()
     nSizeProxyOverviewRasterBand = 0;
     papoProxyOverviewRasterBand = NULL;
     poProxyMaskBand = NULL;
+
+    hMutexUnderlyingRefs = NULL;
 }
 
 /* ******************************************************************** */
@@ -975,6 +1136,61 @@ GDALProxyPoolRasterBand::~GDALProxyPoolRasterBand()
     CPLFree(papoProxyOverviewRasterBand);
     if (poProxyMaskBand)
         delete poProxyMaskBand;
+
+    CPLAssert(oMapUnderlyingRefs.empty());
+    if (hMutexUnderlyingRefs)
+        CPLDestroyMutex(hMutexUnderlyingRefs);
+}
+
+/************************************************************************/
+/*                        AddUnderlyingRef()                            */
+/************************************************************************/
+
+void GDALProxyPoolRasterBand::AddUnderlyingRef(
+    GDALRasterBand* poUnderlyingRasterBand,
+    GDALDataset* poUnderlyingDataset,
+    GDALRasterBand* poUnderlyingMainRasterBand )
+{
+    CPLMutexHolderD(&hMutexUnderlyingRefs);
+    std::map<GDALRasterBand*, UnderlyingRef>::iterator oIter =
+        oMapUnderlyingRefs.find(poUnderlyingRasterBand);
+    if( oIter != oMapUnderlyingRefs.end() )
+    {
+        /* Nested reference from the thread that holds the pooled handle */
+        CPLAssert(oIter->second.poDataset == poUnderlyingDataset);
+        CPLAssert(oIter->second.poMainBand == poUnderlyingMainRasterBand);
+        oIter->second.nRefCount ++;
+        return;
+    }
+    UnderlyingRef sRef;
+    sRef.poDataset = poUnderlyingDataset;
+    sRef.poMainBand = poUnderlyingMainRasterBand;
+    sRef.nRefCount = 1;
+    oMapUnderlyingRefs[poUnderlyingRasterBand] = sRef;
+}
+
+/************************************************************************/
+/*                       RemoveUnderlyingRef()                          */
+/************************************************************************/
+
+bool GDALProxyPoolRasterBand::RemoveUnderlyingRef(
+    GDALRasterBand* poUnderlyingRasterBand,
+    GDALDataset** ppoUnderlyingDataset,
+    GDALRasterBand** ppoUnderlyingMainRasterBand )
+{
+    CPLMutexHolderD(&hMutexUnderlyingRefs);
+    std::map<GDALRasterBand*, UnderlyingRef>::iterator oIter =
+        oMapUnderlyingRefs.find(poUnderlyingRasterBand);
+    if( oIter == oMapUnderlyingRefs.end() )
+    {
+        CPLAssert(false);
+        return false;
+    }
+    *ppoUnderlyingDataset = oIter->second.poDataset;
+    *ppoUnderlyingMainRasterBand = oIter->second.poMainBand;
+    if( --oIter->second.nRefCount == 0 )
+        oMapUnderlyingRefs.erase(oIter);
+    return true;
 }
 
 /************************************************************************/
@@ -1005,8 +1221,10 @@ GDALRasterBand* GDALProxyPoolRasterBand::RefUnderlyingRasterBand()
     if (poBand == NULL)
     {
         ((GDALProxyPoolDataset*)poDS)->UnrefUnderlyingDataset(poUnderlyingDataset);
+        return NULL;
     }
 
+    AddUnderlyingRef(poBand, poUnderlyingDataset, NULL);
     return poBand;
 }
 
@@ -1016,8 +1234,16 @@ GDALRasterBand* GDALProxyPoolRasterBand::RefUnderlyingRasterBand()
 
 void GDALProxyPoolRasterBand::UnrefUnderlyingRasterBand(GDALRasterBand* poUnderlyingRasterBand)
 {
-    if (poUnderlyingRasterBand)
-        ((GDALProxyPoolDataset*)poDS)->UnrefUnderlyingDataset(poUnderlyingRasterBand->GetDataset());
+    /* Unref the pooled dataset the band was obtained from, and not */
+    /* poUnderlyingRasterBand->GetDataset() that may be another dataset */
+    GDALDataset* poUnderlyingDataset = NULL;
+    GDALRasterBand* poUnderlyingMainRasterBand = NULL;
+    if (poUnderlyingRasterBand &&
+        RemoveUnderlyingRef(poUnderlyingRasterBand, &poUnderlyingDataset,
+                            &poUnderlyingMainRasterBand))
+    {
+        ((GDALProxyPoolDataset*)poDS)->UnrefUnderlyingDataset(poUnderlyingDataset);
+    }
 }
 
 /************************************************************************/
@@ -1236,9 +1462,6 @@ GDALProxyPoolOverviewRasterBand::GDALProxyPoolOverviewRasterBand(GDALProxyPoolDa
 {
     poMainBand = poMainBandIn;
     nOverviewBand = nOverviewBandIn;
-
-    poUnderlyingMainRasterBand = NULL;
-    nRefCountUnderlyingMainRasterBand = 0;
 }
 
 /* ******************************************************************** */
@@ -1247,7 +1470,6 @@ GDALProxyPoolOverviewRasterBand::GDALProxyPoolOverviewRasterBand(GDALProxyPoolDa
 
 GDALProxyPoolOverviewRasterBand::~GDALProxyPoolOverviewRasterBand()
 {
-    CPLAssert(nRefCountUnderlyingMainRasterBand == 0);
 }
 
 /* ******************************************************************** */
@@ -1256,12 +1478,20 @@ GDALProxyPoolOverviewRasterBand::~GDALProxyPoolOverviewRasterBand()
 
 GDALRasterBand* GDALProxyPoolOverviewRasterBand::RefUnderlyingRasterBand()
 {
-    poUnderlyingMainRasterBand = poMainBand->RefUnderlyingRasterBand();
+    GDALRasterBand* poUnderlyingMainRasterBand =
+        poMainBand->RefUnderlyingRasterBand();
     if (poUnderlyingMainRasterBand == NULL)
         return NULL;
 
-    nRefCountUnderlyingMainRasterBand ++;
-    return poUnderlyingMainRasterBand->GetOverview(nOverviewBand);
+    GDALRasterBand* poBand = poUnderlyingMainRasterBand->GetOverview(nOverviewBand);
+    if (poBand == NULL)
+    {
+        poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
+        return NULL;
+    }
+
+    AddUnderlyingRef(poBand, NULL, poUnderlyingMainRasterBand);
+    return poBand;
 }
 
 /* ******************************************************************** */
@@ -1269,10 +1499,16 @@ GDALRasterBand* GDALProxyPoolOverviewRasterBand::RefUnderlyingRasterBand()
 /* ******************************************************************** */
 
 void GDALProxyPoolOverviewRasterBand::UnrefUnderlyingRasterBand(
-    GDALRasterBand* /* poUnderlyingRasterBand */ )
+    GDALRasterBand* poUnderlyingRasterBand )
 {
-    poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
-    nRefCountUnderlyingMainRasterBand --;
+    GDALDataset* poUnderlyingDataset = NULL;
+    GDALRasterBand* poUnderlyingMainRasterBand = NULL;
+    if (poUnderlyingRasterBand &&
+        RemoveUnderlyingRef(poUnderlyingRasterBand, &poUnderlyingDataset,
+                            &poUnderlyingMainRasterBand))
+    {
+        poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
+    }
 }
 
 /* ******************************************************************** */
@@ -1285,9 +1521,6 @@ GDALProxyPoolMaskBand::GDALProxyPoolMaskBand(GDALProxyPoolDataset* poDSIn,
         GDALProxyPoolRasterBand(poDSIn, poUnderlyingMaskBand)
 {
     poMainBand = poMainBandIn;
-
-    poUnderlyingMainRasterBand = NULL;
-    nRefCountUnderlyingMainRasterBand = 0;
 }
 
 /* ******************************************************************** */
@@ -1301,9 +1534,6 @@ GDALProxyPoolMaskBand::GDALProxyPoolMaskBand(GDALProxyPoolDataset* poDSIn,
         GDALProxyPoolRasterBand(poDSIn, 1, eDataTypeIn, nBlockXSizeIn, nBlockYSizeIn)
 {
     poMainBand = poMainBandIn;
-
-    poUnderlyingMainRasterBand = NULL;
-    nRefCountUnderlyingMainRasterBand = 0;
 }
 
 /* ******************************************************************** */
@@ -1312,7 +1542,6 @@ GDALProxyPoolMaskBand::GDALProxyPoolMaskBand(GDALProxyPoolDataset* poDSIn,
 
 GDALProxyPoolMaskBand::~GDALProxyPoolMaskBand()
 {
-    CPLAssert(nRefCountUnderlyingMainRasterBand == 0);
 }
 
 /* ******************************************************************** */
@@ -1321,12 +1550,20 @@ GDALProxyPoolMaskBand::~GDALProxyPoolMaskBand()
 
 GDALRasterBand* GDALProxyPoolMaskBand::RefUnderlyingRasterBand()
 {
-    poUnderlyingMainRasterBand = poMainBand->RefUnderlyingRasterBand();
+    GDALRasterBand* poUnderlyingMainRasterBand =
+        poMainBand->RefUnderlyingRasterBand();
     if (poUnderlyingMainRasterBand == NULL)
         return NULL;
 
-    nRefCountUnderlyingMainRasterBand ++;
-    return poUnderlyingMainRasterBand->GetMaskBand();
+    GDALRasterBand* poBand = poUnderlyingMainRasterBand->GetMaskBand();
+    if (poBand == NULL)
+    {
+        poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
+        return NULL;
+    }
+
+    AddUnderlyingRef(poBand, NULL, poUnderlyingMainRasterBand);
+    return poBand;
 }
 
 /* ******************************************************************** */
@@ -1334,10 +1571,16 @@ GDALRasterBand* GDALProxyPoolMaskBand::RefUnderlyingRasterBand()
 /* ******************************************************************** */
 
 void GDALProxyPoolMaskBand::UnrefUnderlyingRasterBand(
-    GDALRasterBand* /* poUnderlyingRasterBand */ )
+    GDALRasterBand* poUnderlyingRasterBand )
 {
-    poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
-    nRefCountUnderlyingMainRasterBand --;
+    GDALDataset* poUnderlyingDataset = NULL;
+    GDALRasterBand* poUnderlyingMainRasterBand = NULL;
+    if (poUnderlyingRasterBand &&
+        RemoveUnderlyingRef(poUnderlyingRasterBand, &poUnderlyingDataset,
+                            &poUnderlyingMainRasterBand))
+    {
+        poMainBand->UnrefUnderlyingRasterBand(poUnderlyingMainRasterBand);
+    }
 }
 
 //! @endcond
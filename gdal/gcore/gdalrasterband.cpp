@@ -29,11 +29,13 @@
  ****************************************************************************/
 
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_priv.h"
 #include "gdal_rat.h"
 
 #include <algorithm>
 #include <limits>
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -1233,6 +1235,35 @@ GDALRasterBlock * GDALRasterBand::GetLockedBlockRef( int nXBlockOff,
                                                      int nYBlockOff,
                                                      int bJustInitialize )
 
+{
+/* -------------------------------------------------------------------- */
+/*      If blocks of the dataset are prefetched by a background         */
+/*      thread (see AdviseRead()), lookup and instantiation of blocks   */
+/*      must be serialized with it, so that a block is never seen       */
+/*      before it has been read.                                        */
+/* -------------------------------------------------------------------- */
+    if( poDS != NULL && poDS->IsPrefetchEnabled() )
+    {
+        const int bCallLeaveReadWrite = EnterReadWrite(GF_Read);
+        GDALRasterBlock *poBlock =
+            GetLockedBlockRefInternal( nXBlockOff, nYBlockOff,
+                                       bJustInitialize );
+        if( bCallLeaveReadWrite ) LeaveReadWrite();
+        return poBlock;
+    }
+
+    return GetLockedBlockRefInternal( nXBlockOff, nYBlockOff,
+                                      bJustInitialize );
+}
+
+/************************************************************************/
+/*                     GetLockedBlockRefInternal()                      */
+/************************************************************************/
+
+GDALRasterBlock *GDALRasterBand::GetLockedBlockRefInternal( int nXBlockOff,
+                                                            int nYBlockOff,
+                                                            int bJustInitialize )
+
 {
 /* -------------------------------------------------------------------- */
 /*      Try and fetch from cache.                                       */
@@ -1299,6 +1330,20 @@ GDALRasterBlock * GDALRasterBand::GetLockedBlockRef( int nXBlockOff,
             return NULL;
         }
 
+        // The read-write lock was dropped above, so a prefetching thread
+        // may have instantiated the same block in the meantime.
+        if( poDS != NULL && poDS->IsPrefetchEnabled() )
+        {
+            GDALRasterBlock *poOtherBlock =
+                TryGetLockedBlockRef( nXBlockOff, nYBlockOff );
+            if( poOtherBlock != NULL )
+            {
+                poBlock->DropLock();
+                delete poBlock;
+                return poOtherBlock;
+            }
+        }
+
         if ( poBandBlockCache->AdoptBlock(poBlock) != CE_None )
         {
             poBlock->DropLock();
@@ -2840,6 +2885,392 @@ GDALDatasetH CPL_STDCALL GDALGetBandDataset( GDALRasterBandH hBand )
     return (GDALDatasetH) poBand->GetDataset();
 }
 
+/************************************************************************/
+/*                     GDALGetStatisticsNumThreads()                    */
+/************************************************************************/
+
+// Number of worker threads used to process the blocks in ComputeStatistics(),
+// ComputeRasterMinMax() and GetHistogram(), from the GDAL_NUM_THREADS
+// configuration option.
+static int GDALGetStatisticsNumThreads()
+{
+    const char* pszValue = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
+    if( pszValue == NULL )
+        return 1;
+    const int nThreads =
+        EQUAL(pszValue, "ALL_CPUS") ? CPLGetNumCPUs() : atoi(pszValue);
+    return std::max(1, std::min(128, nThreads));
+}
+
+/************************************************************************/
+/*                         GDALSampledBlockJob                          */
+/************************************************************************/
+
+template<class Accumulator> struct GDALSampledBlockJob
+{
+    Accumulator      *poAccumulator;
+    GDALRasterBlock  *poBlock;
+    int               nXCheck;
+    int               nYCheck;
+    int               iSlot;
+    std::vector<int> *panFreeSlots;
+    CPLMutex         *hMutex;
+    CPLCond          *hCond;
+};
+
+/************************************************************************/
+/*                       GDALSampledBlockJobFunc()                      */
+/************************************************************************/
+
+template<class Accumulator> static void GDALSampledBlockJobFunc( void* pData )
+{
+    GDALSampledBlockJob<Accumulator>* psJob =
+        static_cast<GDALSampledBlockJob<Accumulator>*>(pData);
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    psJob->poBlock->GetBand()->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    psJob->poAccumulator->ProcessBlock(
+        psJob->poBlock->GetDataRef(), psJob->nXCheck, psJob->nYCheck,
+        nBlockXSize, nBlockYSize);
+    psJob->poBlock->DropLock();
+
+    CPLAcquireMutex(psJob->hMutex, 1000.0);
+    psJob->panFreeSlots->push_back(psJob->iSlot);
+    CPLCondSignal(psJob->hCond);
+    CPLReleaseMutex(psJob->hMutex);
+}
+
+/************************************************************************/
+/*                      GDALProcessSampledBlocks()                      */
+/************************************************************************/
+
+// Feed oAccumulator with one block every nSampleRate blocks of poBand.
+//
+// Blocks are always fetched from the calling thread, since drivers generally
+// cannot read concurrently from the same dataset. When GDAL_NUM_THREADS is
+// greater than 1, the processing of the blocks is dispatched to a pool of
+// worker threads, each job feeding one of a set of private copies of
+// oAccumulator, which are merged into oAccumulator at the end. The number of
+// blocks locked at the same time is limited to the number of those copies.
+//
+// The Accumulator class must provide a copy constructor, and the
+// ProcessBlock() and Merge() methods.
+
+template<class Accumulator>
+static CPLErr GDALProcessSampledBlocks( GDALRasterBand* poBand,
+                                        int nSampleRate,
+                                        bool bIgnoreMissingBlocks,
+                                        Accumulator& oAccumulator,
+                                        const char* pszMessage,
+                                        GDALProgressFunc pfnProgress,
+                                        void *pProgressData )
+{
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    poBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    const int nXSize = poBand->GetXSize();
+    const int nYSize = poBand->GetYSize();
+    const int nBlocksPerRow = DIV_ROUND_UP(nXSize, nBlockXSize);
+    const int nBlocksPerColumn = DIV_ROUND_UP(nYSize, nBlockYSize);
+    const int nBlocks = nBlocksPerRow * nBlocksPerColumn;
+    const int nSampledBlocks = DIV_ROUND_UP(nBlocks, nSampleRate);
+
+    const int nThreads =
+        std::min(GDALGetStatisticsNumThreads(), nSampledBlocks);
+    CPLWorkerThreadPool oThreadPool;
+    std::vector<Accumulator> aoAccumulators;
+    std::vector<GDALSampledBlockJob<Accumulator> > asJobs;
+    std::vector<int> anFreeSlots;
+    CPLMutex* hMutex = NULL;
+    CPLCond* hCond = NULL;
+    if( nThreads > 1 )
+    {
+        hMutex = CPLCreateMutex();
+        if( hMutex )
+            CPLReleaseMutex(hMutex);
+        hCond = CPLCreateCond();
+        if( hMutex != NULL && hCond != NULL &&
+            oThreadPool.Setup(nThreads, NULL, NULL) )
+        {
+            const int nSlots = 2 * nThreads;
+            aoAccumulators.resize(nSlots, oAccumulator);
+            asJobs.resize(nSlots);
+            for( int i = 0; i < nSlots; i++ )
+            {
+                asJobs[i].poAccumulator = &aoAccumulators[i];
+                asJobs[i].poBlock = NULL;
+                asJobs[i].nXCheck = 0;
+                asJobs[i].nYCheck = 0;
+                asJobs[i].iSlot = i;
+                asJobs[i].panFreeSlots = &anFreeSlots;
+                asJobs[i].hMutex = hMutex;
+                asJobs[i].hCond = hCond;
+                anFreeSlots.push_back(nSlots - 1 - i);
+            }
+        }
+    }
+    const bool bMultiThreaded = !asJobs.empty();
+
+    CPLErr eErr = CE_None;
+    for( int iSampleBlock = 0;
+         iSampleBlock < nBlocks;
+         iSampleBlock += nSampleRate )
+    {
+        if( !pfnProgress( iSampleBlock / static_cast<double>(nBlocks),
+                          pszMessage, pProgressData ) )
+        {
+            poBand->ReportError( CE_Failure, CPLE_UserInterrupt,
+                                 "User terminated" );
+            eErr = CE_Failure;
+            break;
+        }
+
+        const int iYBlock = iSampleBlock / nBlocksPerRow;
+        const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
+
+        int iSlot = 0;
+        if( bMultiThreaded )
+        {
+            CPLAcquireMutex(hMutex, 1000.0);
+            while( anFreeSlots.empty() )
+                CPLCondWait(hCond, hMutex);
+            iSlot = anFreeSlots.back();
+            anFreeSlots.pop_back();
+            CPLReleaseMutex(hMutex);
+        }
+
+        GDALRasterBlock * const poBlock =
+            poBand->GetLockedBlockRef( iXBlock, iYBlock );
+        if( poBlock == NULL )
+        {
+            if( bMultiThreaded )
+            {
+                CPLAcquireMutex(hMutex, 1000.0);
+                anFreeSlots.push_back(iSlot);
+                CPLReleaseMutex(hMutex);
+            }
+            if( bIgnoreMissingBlocks )
+                continue;
+            eErr = CE_Failure;
+            break;
+        }
+
+        const int nXCheck =
+            std::min(nBlockXSize, nXSize - iXBlock * nBlockXSize);
+        const int nYCheck =
+            std::min(nBlockYSize, nYSize - iYBlock * nBlockYSize);
+
+        if( bMultiThreaded )
+        {
+            asJobs[iSlot].poBlock = poBlock;
+            asJobs[iSlot].nXCheck = nXCheck;
+            asJobs[iSlot].nYCheck = nYCheck;
+            oThreadPool.SubmitJob(GDALSampledBlockJobFunc<Accumulator>,
+                                  &asJobs[iSlot]);
+        }
+        else
+        {
+            oAccumulator.ProcessBlock( poBlock->GetDataRef(),
+                                       nXCheck, nYCheck,
+                                       nBlockXSize, nBlockYSize );
+            poBlock->DropLock();
+        }
+    }
+
+    if( bMultiThreaded )
+    {
+        oThreadPool.WaitCompletion();
+        oAccumulator = aoAccumulators[0];
+        for( size_t i = 1; i < aoAccumulators.size(); i++ )
+            oAccumulator.Merge(aoAccumulators[i]);
+    }
+    if( hCond != NULL )
+        CPLDestroyCond(hCond);
+    if( hMutex != NULL )
+        CPLDestroyMutex(hMutex);
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                       GDALHistogramAccumulator                       */
+/************************************************************************/
+
+// Block processing of GDALRasterBand::GetHistogram()
+class GDALHistogramAccumulator
+{
+  public:
+    GDALHistogramAccumulator( GDALDataType eDataTypeIn, bool bSignedByteIn,
+                              bool bGotNoDataValueIn, double dfNoDataValueIn,
+                              double dfMinIn, double dfScaleIn, int nBuckets,
+                              bool bIncludeOutOfRangeIn ) :
+        eDataType(eDataTypeIn),
+        bSignedByte(bSignedByteIn),
+        bGotNoDataValue(bGotNoDataValueIn),
+        dfNoDataValue(dfNoDataValueIn),
+        dfMin(dfMinIn),
+        dfScale(dfScaleIn),
+        bIncludeOutOfRange(bIncludeOutOfRangeIn),
+        anHistogram(nBuckets, 0)
+    {}
+
+    void ProcessBlock( const void* pData, int nXCheck, int nYCheck,
+                       int nBlockXSize, int nBlockYSize );
+    void Merge( const GDALHistogramAccumulator& oOther );
+
+    GDALDataType eDataType;
+    bool         bSignedByte;
+    bool         bGotNoDataValue;
+    double       dfNoDataValue;
+    double       dfMin;
+    double       dfScale;
+    bool         bIncludeOutOfRange;
+    std::vector<GUIntBig> anHistogram;
+};
+
+void GDALHistogramAccumulator::Merge( const GDALHistogramAccumulator& oOther )
+{
+    for( size_t i = 0; i < anHistogram.size(); i++ )
+        anHistogram[i] += oOther.anHistogram[i];
+}
+
+void GDALHistogramAccumulator::ProcessBlock( const void* pData,
+                                             int nXCheck, int nYCheck,
+                                             int nBlockXSize, int nBlockYSize )
+{
+    const int nBuckets = static_cast<int>(anHistogram.size());
+    GUIntBig* panHistogram = &anHistogram[0];
+
+    // this is a special case for a common situation.
+    if( eDataType == GDT_Byte && !bSignedByte
+        && dfScale == 1.0 && (dfMin >= -0.5 && dfMin <= 0.5)
+        && nYCheck == nBlockYSize && nXCheck == nBlockXSize
+        && nBuckets == 256 )
+    {
+        const int nPixels = nXCheck * nYCheck;
+        const GByte *pabyData = static_cast<const GByte *>(pData);
+
+        for( int i = 0; i < nPixels; i++ )
+            if( ! (bGotNoDataValue &&
+                   (pabyData[i] == (GByte)dfNoDataValue)))
+            {
+                panHistogram[pabyData[i]]++;
+            }
+
+        return;
+    }
+
+    // This isn't the fastest way to do this, but is easier for now.
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        for( int iX = 0; iX < nXCheck; iX++ )
+        {
+            const int iOffset = iX + iY * nBlockXSize;
+            double dfValue = 0.0;
+
+            switch( eDataType )
+            {
+              case GDT_Byte:
+              {
+                if( bSignedByte )
+                    dfValue =
+                        static_cast<const signed char *>(pData)[iOffset];
+                else
+                    dfValue = static_cast<const GByte *>(pData)[iOffset];
+                break;
+              }
+              case GDT_UInt16:
+                dfValue = static_cast<const GUInt16 *>(pData)[iOffset];
+                break;
+              case GDT_Int16:
+                dfValue = static_cast<const GInt16 *>(pData)[iOffset];
+                break;
+              case GDT_UInt32:
+                dfValue = static_cast<const GUInt32 *>(pData)[iOffset];
+                break;
+              case GDT_Int32:
+                dfValue = static_cast<const GInt32 *>(pData)[iOffset];
+                break;
+              case GDT_Float32:
+                dfValue = static_cast<const float *>(pData)[iOffset];
+                if( CPLIsNan(dfValue) )
+                    continue;
+                break;
+              case GDT_Float64:
+                dfValue = static_cast<const double *>(pData)[iOffset];
+                if( CPLIsNan(dfValue) )
+                    continue;
+                break;
+              case GDT_CInt16:
+                {
+                    double  dfReal =
+                        static_cast<const GInt16 *>(pData)[iOffset*2];
+                    double  dfImag =
+                        static_cast<const GInt16 *>(pData)[iOffset*2+1];
+                    dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
+                }
+                break;
+              case GDT_CInt32:
+                {
+                    double  dfReal =
+                        static_cast<const GInt32 *>(pData)[iOffset*2];
+                    double  dfImag =
+                        static_cast<const GInt32 *>(pData)[iOffset*2+1];
+                    dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
+                }
+                break;
+              case GDT_CFloat32:
+                {
+                    double  dfReal =
+                        static_cast<const float *>(pData)[iOffset*2];
+                    double  dfImag =
+                        static_cast<const float *>(pData)[iOffset*2+1];
+                    if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
+                        continue;
+                    dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
+                }
+                break;
+              case GDT_CFloat64:
+                {
+                    double  dfReal =
+                        static_cast<const double *>(pData)[iOffset*2];
+                    double  dfImag =
+                        static_cast<const double *>(pData)[iOffset*2+1];
+                    if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
+                        continue;
+                    dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
+                }
+                break;
+              default:
+                CPLAssert( false );
+                return;
+            }
+
+            if( bGotNoDataValue &&
+                ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
+                continue;
+
+            const int nIndex =
+                static_cast<int>(floor((dfValue - dfMin) * dfScale));
+
+            if( nIndex < 0 )
+            {
+                if( bIncludeOutOfRange )
+                    ++panHistogram[0];
+            }
+            else if( nIndex >= nBuckets )
+            {
+                if( bIncludeOutOfRange )
+                    ++panHistogram[nBuckets-1];
+            }
+            else
+            {
+                panHistogram[nIndex]++;
+            }
+        }
+    }
+}
+
 /************************************************************************/
 /*                            GetHistogram()                            */
 /************************************************************************/
@@ -2866,6 +3297,10 @@ GDALDatasetH CPL_STDCALL GDALGetBandDataset( GDALRasterBandH hBand )
  * in generating histogram based luts for instance.  Generally bApproxOK is
  * much faster than an exactly computed histogram.
  *
+ * Starting with GDAL 2.2, the GDAL_NUM_THREADS configuration option can be
+ * set to a number of threads (or ALL_CPUS) to compute the histogram of the
+ * blocks in parallel.
+ *
  * This method is the same as the C functions GDALGetRasterHistogram() and
  * GDALGetRasterHistogramEx().
  *
@@ -3119,165 +3554,16 @@ CPLErr GDALRasterBand::GetHistogram( double dfMin, double dfMax,
 /* -------------------------------------------------------------------- */
 /*      Read the blocks, and add to histogram.                          */
 /* -------------------------------------------------------------------- */
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
-        {
-            if( !pfnProgress(
-                    iSampleBlock /
-                        (static_cast<double>(nBlocksPerRow) * nBlocksPerColumn),
-                    "Compute Histogram", pProgressData ) )
-                return CE_Failure;
-
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock *poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == NULL )
-                return CE_Failure;
-
-            void *pData = poBlock->GetDataRef();
-
-            int nXCheck = nBlockXSize;
-            if( (iXBlock+1) * nBlockXSize > GetXSize() )
-                nXCheck = GetXSize() - iXBlock * nBlockXSize;
-
-            int nYCheck = nBlockYSize;
-            if( (iYBlock+1) * nBlockYSize > GetYSize() )
-                nYCheck = GetYSize() - iYBlock * nBlockYSize;
-
-            // this is a special case for a common situation.
-            if( eDataType == GDT_Byte && !bSignedByte
-                && dfScale == 1.0 && (dfMin >= -0.5 && dfMin <= 0.5)
-                && nYCheck == nBlockYSize && nXCheck == nBlockXSize
-                && nBuckets == 256 )
-            {
-                const int nPixels = nXCheck * nYCheck;
-                GByte *pabyData = static_cast<GByte *>(pData);
-
-                for( int i = 0; i < nPixels; i++ )
-                    if( ! (bGotNoDataValue &&
-                           (pabyData[i] == (GByte)dfNoDataValue)))
-                    {
-                        panHistogram[pabyData[i]]++;
-                    }
-
-                poBlock->DropLock();
-                continue;  // To next sample block.
-            }
-
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
-            {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const int iOffset = iX + iY * nBlockXSize;
-                    double dfValue = 0.0;
-
-                    switch( eDataType )
-                    {
-                      case GDT_Byte:
-                      {
-                        if( bSignedByte )
-                            dfValue =
-                                static_cast<signed char *>(pData)[iOffset];
-                        else
-                            dfValue = static_cast<GByte *>(pData)[iOffset];
-                        break;
-                      }
-                      case GDT_UInt16:
-                        dfValue = static_cast<GUInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_UInt32:
-                        dfValue = static_cast<GUInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Float32:
-                        dfValue = static_cast<float *>(pData)[iOffset];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_Float64:
-                        dfValue = static_cast<double *>(pData)[iOffset];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CInt16:
-                        {
-                            double  dfReal =
-                                static_cast<GInt16 *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<GInt16 *>(pData)[iOffset*2+1];
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      case GDT_CInt32:
-                        {
-                            double  dfReal =
-                                static_cast<GInt32 *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<GInt32 *>(pData)[iOffset*2+1];
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      case GDT_CFloat32:
-                        {
-                            double  dfReal =
-                                static_cast<float *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<float *>(pData)[iOffset*2+1];
-                            if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                                continue;
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      case GDT_CFloat64:
-                        {
-                            double  dfReal =
-                                static_cast<double *>(pData)[iOffset*2];
-                            double  dfImag =
-                                static_cast<double *>(pData)[iOffset*2+1];
-                            if ( CPLIsNan(dfReal) || CPLIsNan(dfImag) )
-                                continue;
-                            dfValue = sqrt( dfReal * dfReal + dfImag * dfImag );
-                        }
-                        break;
-                      default:
-                        CPLAssert( false );
-                        return CE_Failure;
-                    }
-
-                    if( bGotNoDataValue &&
-                        ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
-                        continue;
-
-                    const int nIndex =
-                        static_cast<int>(floor((dfValue - dfMin) * dfScale));
-
-                    if( nIndex < 0 )
-                    {
-                        if( bIncludeOutOfRange )
-                            ++panHistogram[0];
-                    }
-                    else if( nIndex >= nBuckets )
-                    {
-                        if( bIncludeOutOfRange )
-                            ++panHistogram[nBuckets-1];
-                    }
-                    else
-                    {
-                        panHistogram[nIndex]++;
-                    }
-                }
-            }
-
-            poBlock->DropLock();
-        }
+        GDALHistogramAccumulator oAccumulator(
+            eDataType, bSignedByte, CPL_TO_BOOL(bGotNoDataValue),
+            dfNoDataValue, dfMin, dfScale, nBuckets,
+            CPL_TO_BOOL(bIncludeOutOfRange));
+        if( GDALProcessSampledBlocks( this, nSampleRate, false, oAccumulator,
+                                      "Compute Histogram",
+                                      pfnProgress, pProgressData ) != CE_None )
+            return CE_Failure;
+        memcpy( panHistogram, &oAccumulator.anHistogram[0],
+                sizeof(GUIntBig) * nBuckets );
     }
 
     pfnProgress( 1.0, "Compute Histogram", pProgressData );
@@ -3594,6 +3880,17 @@ CPLErr CPL_STDCALL GDALGetDefaultHistogramEx(
  * Many drivers just ignore the AdviseRead() call, but it can dramatically
  * accelerate access via some drivers.
  *
+ * Starting with GDAL 2.2, when the GDAL_ADVISE_READ_PREFETCH configuration
+ * option is set to YES, the default implementation schedules the blocks
+ * intersecting the region to be loaded into the block cache by a background
+ * thread of the dataset, so that I/O and decoding overlap with the processing
+ * done by the caller. This is only done for datasets opened in read-only mode,
+ * when the region is read at full resolution (or the band has no overviews),
+ * and for no more blocks than half of the block cache. Reads of the dataset
+ * are then serialized with its read-write mutex, so this should not be used
+ * if the same underlying file handle is also accessed through another
+ * dataset object.
+ *
  * @param nXOff The pixel offset to the top left corner of the region
  * of the band to be accessed.  This would be zero to start from the left side.
  *
@@ -3625,16 +3922,45 @@ CPLErr CPL_STDCALL GDALGetDefaultHistogramEx(
 /**/
 
 CPLErr GDALRasterBand::AdviseRead(
-    int /*nXOff*/,
-    int /*nYOff*/,
-    int /*nXSize*/,
-    int /*nYSize*/,
-    int /*nBufXSize*/,
-    int /*nBufYSize*/,
+    int nXOff,
+    int nYOff,
+    int nXSize,
+    int nYSize,
+    int nBufXSize,
+    int nBufYSize,
     GDALDataType /*eBufType*/,
     char ** /*papszOptions*/ )
 {
-    return CE_None;
+    if( poDS == NULL || nBand < 1 || eAccess != GA_ReadOnly ||
+        !CPLTestBool(CPLGetConfigOption("GDAL_ADVISE_READ_PREFETCH", "NO")) )
+        return CE_None;
+
+    if( nXOff < 0 || nYOff < 0 || nXSize < 1 || nYSize < 1 ||
+        nXSize > nRasterXSize - nXOff || nYSize > nRasterYSize - nYOff )
+    {
+        ReportError( CE_Failure, CPLE_IllegalArg,
+                     "Access window out of range in AdviseRead().  Requested\n"
+                     "(%d,%d) of size %dx%d on raster of %dx%d.",
+                     nXOff, nYOff, nXSize, nYSize,
+                     nRasterXSize, nRasterYSize );
+        return CE_Failure;
+    }
+
+    // Subsampled requests will likely be served from overviews, which are
+    // generally not attached to this dataset.
+    if( (nBufXSize < nXSize || nBufYSize < nYSize) && GetOverviewCount() > 0 )
+        return CE_None;
+
+    if( !InitBlockInfo() )
+        return CE_Failure;
+
+    const int nXBlockOff = nXOff / nBlockXSize;
+    const int nYBlockOff = nYOff / nBlockYSize;
+    return poDS->PrefetchBlocks( this, nXBlockOff, nYBlockOff,
+                                 (nXOff + nXSize - 1) / nBlockXSize -
+                                     nXBlockOff + 1,
+                                 (nYOff + nYSize - 1) / nBlockYSize -
+                                     nYBlockOff + 1 );
 }
 
 /************************************************************************/
@@ -3798,17 +4124,31 @@ class GDALUInt128
         GDALUInt128(__uint128_t valIn) : val(valIn) {}
 
     public:
+        explicit GDALUInt128(GUIntBig valIn) : val(valIn) {}
+
         static GDALUInt128 Mul(GUIntBig first, GUIntBig second)
         {
             // Evaluates to just a single mul on x86_64
             return GDALUInt128((__uint128_t)first * second);
         }
 
+        // The result must fit on 128 bits.
+        static GDALUInt128 Mul(const GDALUInt128& first, GUIntBig second)
+        {
+            return GDALUInt128(first.val * second);
+        }
+
         GDALUInt128 operator- (const GDALUInt128& other) const
         {
             return GDALUInt128(val - other.val);
         }
 
+        GDALUInt128& operator+= (const GDALUInt128& other)
+        {
+            val += other.val;
+            return *this;
+        }
+
         operator double() const
         {
             return static_cast<double>(val);
@@ -3828,6 +4168,8 @@ class GDALUInt128
                                         low(lowIn), high(highIn) {}
 
     public:
+        explicit GDALUInt128(GUIntBig lowIn) : low(lowIn), high(0) {}
+
         static GDALUInt128 Mul(GUIntBig first, GUIntBig second)
         {
 #if defined(_MSC_VER) && defined(_M_X64)
@@ -3858,6 +4200,14 @@ class GDALUInt128
 #endif
         }
 
+        // The result must fit on 128 bits.
+        static GDALUInt128 Mul(const GDALUInt128& first, GUIntBig second)
+        {
+            GDALUInt128 res(Mul(first.low, second));
+            res.high += first.high * second;
+            return res;
+        }
+
         GDALUInt128 operator- (const GDALUInt128& other) const
         {
             GUIntBig highRes = high - other.high;
@@ -3867,6 +4217,16 @@ class GDALUInt128
             return GDALUInt128(lowRes, highRes);
         }
 
+        GDALUInt128& operator+= (const GDALUInt128& other)
+        {
+            const GUIntBig lowRes = low + other.low;
+            high += other.high;
+            if( lowRes < low ) // check for overflow
+                ++high;
+            low = lowRes;
+            return *this;
+        }
+
         operator double() const
         {
             const double twoPow64 = 18446744073709551616.0;
@@ -4623,6 +4983,446 @@ void ComputeStatisticsInternal<GUInt16>( int nXCheck,
 
 #endif // (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
 
+/************************************************************************/
+/*                    GDALIntegerStatsAccumulator                       */
+/************************************************************************/
+
+// Block processing of GDALRasterBand::ComputeStatistics() for GByte and
+// GUInt16, with integer intermediate results, so that merging the results
+// of several threads is exact.
+template<class T> class GDALIntegerStatsAccumulator
+{
+  public:
+    GDALIntegerStatsAccumulator( GUInt32 nMaxValueType,
+                                 bool bHasNoDataIn,
+                                 GUInt32 nNoDataValueIn ) :
+        bHasNoData(bHasNoDataIn),
+        nNoDataValue(nNoDataValueIn),
+        nMin(nMaxValueType),
+        nMax(0),
+        nSum(0),
+        nSumSquare(0),
+        nSampleCount(0)
+    {}
+
+    void ProcessBlock( const void* pData, int nXCheck, int nYCheck,
+                       int nBlockXSize, int /* nBlockYSize */ )
+    {
+        ComputeStatisticsInternal( nXCheck, nBlockXSize, nYCheck,
+                                   static_cast<const T*>(pData),
+                                   bHasNoData, nNoDataValue,
+                                   nMin, nMax, nSum, nSumSquare,
+                                   nSampleCount );
+    }
+
+    void Merge( const GDALIntegerStatsAccumulator& oOther )
+    {
+        nMin = std::min(nMin, oOther.nMin);
+        nMax = std::max(nMax, oOther.nMax);
+        nSum += oOther.nSum;
+        nSumSquare += oOther.nSumSquare;
+        nSampleCount += oOther.nSampleCount;
+    }
+
+    bool     bHasNoData;
+    GUInt32  nNoDataValue;
+    GUInt32  nMin;
+    GUInt32  nMax;
+    GUIntBig nSum;
+    GUIntBig nSumSquare;
+    GUIntBig nSampleCount;
+};
+
+/************************************************************************/
+/*                  GDALWideIntegerStatsAccumulator                     */
+/************************************************************************/
+
+// Block processing of GDALRasterBand::ComputeStatistics() for the other
+// integer data types (signed Byte, Int16, UInt32, Int32, and the real part
+// of CInt16 and CInt32), nStride being 2 for complex types. Values are
+// offset by nOffset, the opposite of the lowest value of the type, so that
+// their sum and sum of squares can be accumulated on unsigned integers,
+// the latter on 128 bits. Merging the results of several threads is thus
+// exact. The caller must check that the number of samples multiplied by
+// the range of the type fits on 64 bits.
+template<class T, int nStride> class GDALWideIntegerStatsAccumulator
+{
+  public:
+    GDALWideIntegerStatsAccumulator( GIntBig nOffsetIn,
+                                     bool bHasNoDataIn,
+                                     GIntBig nNoDataValueIn ) :
+        nOffset(nOffsetIn),
+        bHasNoData(bHasNoDataIn),
+        nNoDataValue(nNoDataValueIn),
+        nMin(std::numeric_limits<GIntBig>::max()),
+        nMax(std::numeric_limits<GIntBig>::min()),
+        nSum(0),
+        nSumSquare(static_cast<GUIntBig>(0)),
+        nSampleCount(0)
+    {}
+
+    void ProcessBlock( const void* pData, int nXCheck, int nYCheck,
+                       int nBlockXSize, int /* nBlockYSize */ )
+    {
+        const T* paData = static_cast<const T*>(pData);
+        for( int iY = 0; iY < nYCheck; iY++ )
+        {
+            const T* paLine =
+                paData + static_cast<size_t>(iY) * nBlockXSize * nStride;
+            for( int iX = 0; iX < nXCheck; iX++ )
+            {
+                const GIntBig nValue = paLine[iX * nStride];
+                if( bHasNoData && nValue == nNoDataValue )
+                    continue;
+                if( nValue < nMin )
+                    nMin = nValue;
+                if( nValue > nMax )
+                    nMax = nValue;
+                const GUIntBig nShifted =
+                    static_cast<GUIntBig>(nValue + nOffset);
+                nSum += nShifted;
+                nSumSquare += GDALUInt128::Mul(nShifted, nShifted);
+                nSampleCount++;
+            }
+        }
+    }
+
+    void Merge( const GDALWideIntegerStatsAccumulator& oOther )
+    {
+        nMin = std::min(nMin, oOther.nMin);
+        nMax = std::max(nMax, oOther.nMax);
+        nSum += oOther.nSum;
+        nSumSquare += oOther.nSumSquare;
+        nSampleCount += oOther.nSampleCount;
+    }
+
+    // Mean and sum of squares of differences to the mean of the values.
+    void GetMoments( double& dfMean, double& dfM2 ) const
+    {
+        if( nSampleCount == 0 )
+        {
+            dfMean = 0.0;
+            dfM2 = 0.0;
+            return;
+        }
+        // The sum of the values themselves, nSum - nSampleCount * nOffset,
+        // is computed by its sign and absolute value, to keep the precision
+        // of the mean of values close to zero.
+        const GUIntBig nSumOffset = nSampleCount * static_cast<GUIntBig>(nOffset);
+        if( nSum >= nSumOffset )
+            dfMean = static_cast<double>(nSum - nSumOffset) / nSampleCount;
+        else
+            dfMean = -static_cast<double>(nSumOffset - nSum) / nSampleCount;
+        // The variance does not depend on the offset.
+        const GDALUInt128 nTmpForM2(
+            GDALUInt128::Mul(nSumSquare, nSampleCount) -
+            GDALUInt128::Mul(nSum, nSum));
+        dfM2 = static_cast<double>(nTmpForM2) / nSampleCount;
+    }
+
+    GIntBig     nOffset;
+    bool        bHasNoData;
+    GIntBig     nNoDataValue;
+    GIntBig     nMin;
+    GIntBig     nMax;
+    GUIntBig    nSum;
+    GDALUInt128 nSumSquare;
+    GUIntBig    nSampleCount;
+};
+
+/************************************************************************/
+/*                       GDALMinMaxFloat32SSE2()                        */
+/************************************************************************/
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
+
+// Min/max of the non-NaN values of a Float32 block. Returns false if
+// there is no such value.
+static bool GDALMinMaxFloat32SSE2( const float* pafData,
+                                   int nXCheck, int nYCheck, int nBlockXSize,
+                                   float& fMin, float& fMax )
+{
+    const float fInf = std::numeric_limits<float>::infinity();
+    __m128 xmm_min = _mm_set1_ps(fInf);
+    __m128 xmm_max = _mm_set1_ps(-fInf);
+    __m128 xmm_valid = _mm_setzero_ps();
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        const float* pafLine = pafData + static_cast<size_t>(iY) * nBlockXSize;
+        int iX = 0;
+        for( ; iX + 3 < nXCheck; iX += 4 )
+        {
+            const __m128 xmm = _mm_loadu_ps(pafLine + iX);
+            // _mm_min_ps() and _mm_max_ps() return their second argument
+            // if any of them is NaN, so NaN values are ignored.
+            xmm_min = _mm_min_ps(xmm, xmm_min);
+            xmm_max = _mm_max_ps(xmm, xmm_max);
+            xmm_valid = _mm_or_ps(xmm_valid, _mm_cmpord_ps(xmm, xmm));
+        }
+        for( ; iX < nXCheck; iX++ )
+        {
+            const __m128 xmm = _mm_load_ss(pafLine + iX);
+            xmm_min = _mm_min_ss(xmm, xmm_min);
+            xmm_max = _mm_max_ss(xmm, xmm_max);
+            xmm_valid = _mm_or_ps(xmm_valid,
+                                  _mm_and_ps(_mm_cmpord_ss(xmm, xmm),
+                                             _mm_castsi128_ps(
+                                                 _mm_cvtsi32_si128(-1))));
+        }
+    }
+    if( _mm_movemask_ps(xmm_valid) == 0 )
+        return false;
+
+    float afMin[4];
+    float afMax[4];
+    _mm_storeu_ps(afMin, xmm_min);
+    _mm_storeu_ps(afMax, xmm_max);
+    fMin = std::min(std::min(afMin[0], afMin[1]), std::min(afMin[2], afMin[3]));
+    fMax = std::max(std::max(afMax[0], afMax[1]), std::max(afMax[2], afMax[3]));
+    return true;
+}
+
+#endif // (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
+
+/************************************************************************/
+/*                      GDALGenericStatsAccumulator                     */
+/************************************************************************/
+
+// Block processing of GDALRasterBand::ComputeStatistics() and
+// GDALRasterBand::ComputeRasterMinMax() for all data types.
+// When bComputeMoments is set, the mean and the sum of squares of
+// differences to the mean are computed with the Welford algorithm:
+// http://en.wikipedia.org/wiki/Algorithms_for_calculating_variance
+// to compute standard deviation in a more numerically robust way than
+// the difference of the sum of square values with the square of the sum.
+class GDALGenericStatsAccumulator
+{
+  public:
+    GDALGenericStatsAccumulator( GDALDataType eDataTypeIn, bool bSignedByteIn,
+                                 bool bGotNoDataValueIn,
+                                 double dfNoDataValueIn,
+                                 bool bComputeMomentsIn ) :
+        eDataType(eDataTypeIn),
+        bSignedByte(bSignedByteIn),
+        bGotNoDataValue(bGotNoDataValueIn),
+        dfNoDataValue(dfNoDataValueIn),
+        bComputeMoments(bComputeMomentsIn),
+        bFirstValue(true),
+        dfMin(0.0),
+        dfMax(0.0),
+        dfMean(0.0),
+        dfM2(0.0),
+        nSampleCount(0)
+    {}
+
+    void ProcessBlock( const void* pData, int nXCheck, int nYCheck,
+                       int nBlockXSize, int nBlockYSize );
+    void Merge( const GDALGenericStatsAccumulator& oOther );
+
+    GDALDataType eDataType;
+    bool         bSignedByte;
+    bool         bGotNoDataValue;
+    double       dfNoDataValue;
+    bool         bComputeMoments;
+    bool         bFirstValue;
+    double       dfMin;
+    double       dfMax;
+    // dfM2 is the sum of square of differences to the current mean.
+    double       dfMean;
+    double       dfM2;
+    GUIntBig     nSampleCount;
+};
+
+void GDALGenericStatsAccumulator::Merge(
+                                const GDALGenericStatsAccumulator& oOther )
+{
+    if( oOther.bFirstValue )
+        return;
+    if( bFirstValue )
+    {
+        *this = oOther;
+        return;
+    }
+    dfMin = std::min(dfMin, oOther.dfMin);
+    dfMax = std::max(dfMax, oOther.dfMax);
+    if( bComputeMoments && oOther.nSampleCount > 0 )
+    {
+        // Parallel variant of the Welford algorithm (Chan et al.)
+        const GUIntBig nNewSampleCount = nSampleCount + oOther.nSampleCount;
+        const double dfDelta = oOther.dfMean - dfMean;
+        const double dfRatio =
+            static_cast<double>(oOther.nSampleCount) / nNewSampleCount;
+        dfMean += dfDelta * dfRatio;
+        dfM2 += oOther.dfM2 +
+                dfDelta * dfDelta * static_cast<double>(nSampleCount) * dfRatio;
+        nSampleCount = nNewSampleCount;
+    }
+}
+
+void GDALGenericStatsAccumulator::ProcessBlock( const void* pData,
+                                                int nXCheck, int nYCheck,
+                                                int nBlockXSize,
+                                                int /* nBlockYSize */ )
+{
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
+    if( eDataType == GDT_Float32 && !bComputeMoments && !bGotNoDataValue )
+    {
+        float fBlockMin = 0.0f;
+        float fBlockMax = 0.0f;
+        if( GDALMinMaxFloat32SSE2( static_cast<const float*>(pData),
+                                   nXCheck, nYCheck, nBlockXSize,
+                                   fBlockMin, fBlockMax ) )
+        {
+            if( bFirstValue )
+            {
+                dfMin = fBlockMin;
+                dfMax = fBlockMax;
+                bFirstValue = false;
+            }
+            else
+            {
+                dfMin = std::min(dfMin, static_cast<double>(fBlockMin));
+                dfMax = std::max(dfMax, static_cast<double>(fBlockMax));
+            }
+        }
+        return;
+    }
+#endif
+
+    // This isn't the fastest way to do this, but is easier for now.
+    for( int iY = 0; iY < nYCheck; iY++ )
+    {
+        for( int iX = 0; iX < nXCheck; iX++ )
+        {
+            const int iOffset = iX + iY * nBlockXSize;
+            double dfValue = 0.0;
+
+            switch( eDataType )
+            {
+              case GDT_Byte:
+              {
+                if( bSignedByte )
+                    dfValue =
+                        static_cast<const signed char *>(pData)[iOffset];
+                else
+                    dfValue = static_cast<const GByte *>(pData)[iOffset];
+                break;
+              }
+              case GDT_UInt16:
+                dfValue = static_cast<const GUInt16 *>(pData)[iOffset];
+                break;
+              case GDT_Int16:
+                dfValue = static_cast<const GInt16 *>(pData)[iOffset];
+                break;
+              case GDT_UInt32:
+                dfValue = static_cast<const GUInt32 *>(pData)[iOffset];
+                break;
+              case GDT_Int32:
+                dfValue = static_cast<const GInt32 *>(pData)[iOffset];
+                break;
+              case GDT_Float32:
+                dfValue = static_cast<const float *>(pData)[iOffset];
+                if( CPLIsNan(dfValue) )
+                    continue;
+                break;
+              case GDT_Float64:
+                dfValue = static_cast<const double *>(pData)[iOffset];
+                if( CPLIsNan(dfValue) )
+                    continue;
+                break;
+              case GDT_CInt16:
+                dfValue = static_cast<const GInt16 *>(pData)[iOffset*2];
+                break;
+              case GDT_CInt32:
+                dfValue = static_cast<const GInt32 *>(pData)[iOffset*2];
+                break;
+              case GDT_CFloat32:
+                dfValue = static_cast<const float *>(pData)[iOffset*2];
+                if( CPLIsNan(dfValue) )
+                    continue;
+                break;
+              case GDT_CFloat64:
+                dfValue = static_cast<const double *>(pData)[iOffset*2];
+                if( CPLIsNan(dfValue) )
+                    continue;
+                break;
+              default:
+                CPLAssert( false );
+            }
+
+            if( bGotNoDataValue &&
+                ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
+                continue;
+
+            if( bFirstValue )
+            {
+                dfMin = dfValue;
+                dfMax = dfValue;
+                bFirstValue = false;
+            }
+            else
+            {
+                dfMin = std::min(dfMin, dfValue);
+                dfMax = std::max(dfMax, dfValue);
+            }
+
+            if( bComputeMoments )
+            {
+                nSampleCount++;
+                const double dfDelta = dfValue - dfMean;
+                dfMean += dfDelta / nSampleCount;
+                dfM2 += dfDelta * (dfValue - dfMean);
+            }
+        }
+    }
+}
+
+/************************************************************************/
+/*                  GDALComputeWideIntegerStatistics()                  */
+/************************************************************************/
+
+// Statistics of the samples of poBand with GDALWideIntegerStatsAccumulator.
+// dfM2 is the sum of square of differences to the mean.
+template<class T, int nStride>
+static CPLErr GDALComputeWideIntegerStatistics( GDALRasterBand* poBand,
+                                                int nSampleRate,
+                                                bool bGotNoDataValue,
+                                                double dfNoDataValue,
+                                                GDALProgressFunc pfnProgress,
+                                                void *pProgressData,
+                                                double& dfMin,
+                                                double& dfMax,
+                                                double& dfMean,
+                                                double& dfM2,
+                                                GUIntBig& nSampleCount )
+{
+    // A nodata value that is not a value of the type matches no pixel.
+    const double dfNoDataRounded = floor(dfNoDataValue + 0.5);
+    const bool bHasNoData =
+        bGotNoDataValue &&
+        dfNoDataValue >= std::numeric_limits<T>::min() &&
+        dfNoDataValue <= std::numeric_limits<T>::max() &&
+        fabs(dfNoDataValue - dfNoDataRounded) < 1e-10;
+
+    GDALWideIntegerStatsAccumulator<T, nStride> oAccumulator(
+        -static_cast<GIntBig>(std::numeric_limits<T>::min()),
+        bHasNoData,
+        bHasNoData ? static_cast<GIntBig>(dfNoDataRounded) : 0 );
+    if( GDALProcessSampledBlocks( poBand, nSampleRate, true, oAccumulator,
+                                  "Compute Statistics",
+                                  pfnProgress, pProgressData ) != CE_None )
+        return CE_Failure;
+
+    nSampleCount = oAccumulator.nSampleCount;
+    if( nSampleCount > 0 )
+    {
+        dfMin = static_cast<double>(oAccumulator.nMin);
+        dfMax = static_cast<double>(oAccumulator.nMax);
+    }
+    oAccumulator.GetMoments(dfMean, dfM2);
+    return CE_None;
+}
+
 /************************************************************************/
 /*                         ComputeStatistics()                          */
 /************************************************************************/
@@ -4638,6 +5438,10 @@ void ComputeStatisticsInternal<GUInt16>( int nXCheck,
  * Once computed, the statistics will generally be "set" back on the
  * raster band using SetStatistics().
  *
+ * Starting with GDAL 2.2, the GDAL_NUM_THREADS configuration option can be
+ * set to a number of threads (or ALL_CPUS) to process the blocks in
+ * parallel. Blocks are still read from the calling thread.
+ *
  * This method is the same as the C function GDALComputeRasterStatistics().
  *
  * @param bApproxOK If TRUE statistics may be computed based on overviews
@@ -4883,10 +5687,6 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
                         static_cast<GUInt32>(nBlockXSize * nBlockYSize)) )
         {
             const GUInt32 nMaxValueType = (eDataType == GDT_Byte) ? 255 : 65535;
-            GUInt32 nMin = nMaxValueType;
-            GUInt32 nMax = 0;
-            GUIntBig nSum = 0;
-            GUIntBig nSumSquare = 0;
             // If no valid nodata, map to invalid value (256 for Byte)
             const GUInt32 nNoDataValue =
                 (bGotNoDataValue && dfNoDataValue >= 0 &&
@@ -4896,63 +5696,43 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
                             static_cast<GUInt32>(dfNoDataValue + 1e-10) :
                             nMaxValueType+1;
 
-            for( int iSampleBlock = 0;
-                iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-                iSampleBlock += nSampleRate )
+            GUInt32 nMin = 0;
+            GUInt32 nMax = 0;
+            GUIntBig nSum = 0;
+            GUIntBig nSumSquare = 0;
+            if( eDataType == GDT_Byte )
             {
-                const int iYBlock = iSampleBlock / nBlocksPerRow;
-                const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-                GDALRasterBlock * const poBlock =
-                    GetLockedBlockRef( iXBlock, iYBlock );
-                if( poBlock == NULL )
-                    continue;
-
-                void* const pData = poBlock->GetDataRef();
-
-                int nXCheck = nBlockXSize;
-                if( (iXBlock+1) * nBlockXSize > GetXSize() )
-                    nXCheck = GetXSize() - iXBlock * nBlockXSize;
-
-                int nYCheck = nBlockYSize;
-                if( (iYBlock+1) * nBlockYSize > GetYSize() )
-                    nYCheck = GetYSize() - iYBlock * nBlockYSize;
-
-                if( eDataType == GDT_Byte )
-                {
-                    ComputeStatisticsInternal( nXCheck,
-                                               nBlockXSize,
-                                               nYCheck,
-                                               static_cast<const GByte*>(pData),
-                                               nNoDataValue <= nMaxValueType,
-                                               nNoDataValue,
-                                               nMin, nMax, nSum,
-                                               nSumSquare,
-                                               nSampleCount );
-                }
-                else
-                {
-                    ComputeStatisticsInternal( nXCheck,
-                                               nBlockXSize,
-                                               nYCheck,
-                                               static_cast<const GUInt16*>(pData),
-                                               nNoDataValue <= nMaxValueType,
-                                               nNoDataValue,
-                                               nMin, nMax, nSum,
-                                               nSumSquare,
-                                               nSampleCount );
-                }
-
-                poBlock->DropLock();
-
-                if ( !pfnProgress( iSampleBlock
-                        / static_cast<double>(nBlocksPerRow*nBlocksPerColumn),
-                        "Compute Statistics", pProgressData) )
-                {
-                    ReportError( CE_Failure, CPLE_UserInterrupt,
-                                 "User terminated" );
+                GDALIntegerStatsAccumulator<GByte> oAccumulator(
+                    nMaxValueType, nNoDataValue <= nMaxValueType,
+                    nNoDataValue );
+                if( GDALProcessSampledBlocks( this, nSampleRate, true,
+                                              oAccumulator,
+                                              "Compute Statistics",
+                                              pfnProgress,
+                                              pProgressData ) != CE_None )
                     return CE_Failure;
-                }
+                nMin = oAccumulator.nMin;
+                nMax = oAccumulator.nMax;
+                nSum = oAccumulator.nSum;
+                nSumSquare = oAccumulator.nSumSquare;
+                nSampleCount = oAccumulator.nSampleCount;
+            }
+            else
+            {
+                GDALIntegerStatsAccumulator<GUInt16> oAccumulator(
+                    nMaxValueType, nNoDataValue <= nMaxValueType,
+                    nNoDataValue );
+                if( GDALProcessSampledBlocks( this, nSampleRate, true,
+                                              oAccumulator,
+                                              "Compute Statistics",
+                                              pfnProgress,
+                                              pProgressData ) != CE_None )
+                    return CE_Failure;
+                nMin = oAccumulator.nMin;
+                nMax = oAccumulator.nMax;
+                nSum = oAccumulator.nSum;
+                nSumSquare = oAccumulator.nSumSquare;
+                nSampleCount = oAccumulator.nSampleCount;
             }
 
             if( !pfnProgress( 1.0, "Compute Statistics", pProgressData ) )
@@ -5005,121 +5785,83 @@ GDALRasterBand::ComputeStatistics( int bApproxOK,
             return CE_Failure;
         }
 
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
+        // Other integer types also use integral intermediate results, so
+        // that the result does not depend on how blocks are split between
+        // threads, if the number of pixels multiplied by the range of the
+        // type fits on a uint64 (4 giga pixels for 32 bit types).
+        GUInt32 nTypeRange = 0;
+        if( eDataType == GDT_Byte && bSignedByte )
+            nTypeRange = 255U;
+        else if( eDataType == GDT_Int16 || eDataType == GDT_CInt16 )
+            nTypeRange = 65535U;
+        else if( eDataType == GDT_UInt32 || eDataType == GDT_Int32 ||
+                 eDataType == GDT_CInt32 )
+            nTypeRange = 0xFFFFFFFFU;
+        if( nTypeRange != 0 &&
+            static_cast<GUIntBig>(nBlocksPerRow)*nBlocksPerColumn/nSampleRate <
+                GUINTBIG_MAX / nTypeRange /
+                        static_cast<GUInt32>(nBlockXSize * nBlockYSize) )
         {
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock * const poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == NULL )
-                continue;
-
-            void* const pData = poBlock->GetDataRef();
-
-            int nXCheck = nBlockXSize;
-            if( (iXBlock+1) * nBlockXSize > GetXSize() )
-                nXCheck = GetXSize() - iXBlock * nBlockXSize;
-
-            int nYCheck = nBlockYSize;
-            if( (iYBlock+1) * nBlockYSize > GetYSize() )
-                nYCheck = GetYSize() - iYBlock * nBlockYSize;
-
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
+            CPLErr eErr = CE_None;
+            const bool bNoData = CPL_TO_BOOL(bGotNoDataValue);
+            switch( eDataType )
             {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const int iOffset = iX + iY * nBlockXSize;
-                    double dfValue = 0.0;
-
-                    switch( eDataType )
-                    {
-                      case GDT_Byte:
-                      {
-                        if( bSignedByte )
-                            dfValue =
-                                static_cast<signed char *>(pData)[iOffset];
-                        else
-                            dfValue = static_cast<GByte *>(pData)[iOffset];
-                        break;
-                      }
-                      case GDT_UInt16:
-                        dfValue = static_cast<GUInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_UInt32:
-                        dfValue = static_cast<GUInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Float32:
-                        dfValue = static_cast<float *>(pData)[iOffset];
-                        if (CPLIsNan(dfValue))
-                            continue;
-                        break;
-                      case GDT_Float64:
-                        dfValue = ((double *)pData)[iOffset];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CInt16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset*2];
-                        break;
-                      case GDT_CInt32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset*2];
-                        break;
-                      case GDT_CFloat32:
-                        dfValue = static_cast<float *>(pData)[iOffset*2];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CFloat64:
-                        dfValue = static_cast<double *>(pData)[iOffset*2];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      default:
-                        CPLAssert( false );
-                    }
-
-                    if( bGotNoDataValue &&
-                        ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
-                        continue;
-
-                    if( bFirstValue )
-                    {
-                        dfMin = dfValue;
-                        dfMax = dfValue;
-                        bFirstValue = false;
-                    }
-                    else
-                    {
-                        dfMin = std::min(dfMin, dfValue);
-                        dfMax = std::max(dfMax, dfValue);
-                    }
-
-                    nSampleCount++;
-                    const double dfDelta = dfValue - dfMean;
-                    dfMean += dfDelta / nSampleCount;
-                    dfM2 += dfDelta * (dfValue - dfMean);
-                }
+              case GDT_Byte:
+                eErr = GDALComputeWideIntegerStatistics<signed char, 1>(
+                    this, nSampleRate, bNoData, dfNoDataValue,
+                    pfnProgress, pProgressData,
+                    dfMin, dfMax, dfMean, dfM2, nSampleCount );
+                break;
+              case GDT_Int16:
+                eErr = GDALComputeWideIntegerStatistics<GInt16, 1>(
+                    this, nSampleRate, bNoData, dfNoDataValue,
+                    pfnProgress, pProgressData,
+                    dfMin, dfMax, dfMean, dfM2, nSampleCount );
+                break;
+              case GDT_UInt32:
+                eErr = GDALComputeWideIntegerStatistics<GUInt32, 1>(
+                    this, nSampleRate, bNoData, dfNoDataValue,
+                    pfnProgress, pProgressData,
+                    dfMin, dfMax, dfMean, dfM2, nSampleCount );
+                break;
+              case GDT_Int32:
+                eErr = GDALComputeWideIntegerStatistics<GInt32, 1>(
+                    this, nSampleRate, bNoData, dfNoDataValue,
+                    pfnProgress, pProgressData,
+                    dfMin, dfMax, dfMean, dfM2, nSampleCount );
+                break;
+              case GDT_CInt16:
+                eErr = GDALComputeWideIntegerStatistics<GInt16, 2>(
+                    this, nSampleRate, bNoData, dfNoDataValue,
+                    pfnProgress, pProgressData,
+                    dfMin, dfMax, dfMean, dfM2, nSampleCount );
+                break;
+              default:
+                CPLAssert( eDataType == GDT_CInt32 );
+                eErr = GDALComputeWideIntegerStatistics<GInt32, 2>(
+                    this, nSampleRate, bNoData, dfNoDataValue,
+                    pfnProgress, pProgressData,
+                    dfMin, dfMax, dfMean, dfM2, nSampleCount );
+                break;
             }
-
-            poBlock->DropLock();
-
-            if ( !pfnProgress(
-                     iSampleBlock
-                         / static_cast<double>(nBlocksPerRow*nBlocksPerColumn),
-                     "Compute Statistics", pProgressData) )
-            {
-                ReportError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            if( eErr != CE_None )
                 return CE_Failure;
-            }
+        }
+        else
+        {
+            GDALGenericStatsAccumulator oAccumulator(
+                eDataType, bSignedByte, CPL_TO_BOOL(bGotNoDataValue),
+                dfNoDataValue, true );
+            if( GDALProcessSampledBlocks( this, nSampleRate, true,
+                                          oAccumulator, "Compute Statistics",
+                                          pfnProgress,
+                                          pProgressData ) != CE_None )
+                return CE_Failure;
+            dfMin = oAccumulator.dfMin;
+            dfMax = oAccumulator.dfMax;
+            dfMean = oAccumulator.dfMean;
+            dfM2 = oAccumulator.dfM2;
+            nSampleCount = oAccumulator.nSampleCount;
         }
     }
 
@@ -5271,6 +6013,9 @@ CPLErr CPL_STDCALL GDALSetRasterStatistics(
  * If bApprox is FALSE, then all pixels will be read and used to compute
  * an exact range.
  *
+ * The GDAL_NUM_THREADS configuration option is honoured as in
+ * ComputeStatistics().
+ *
  * This method is the same as the C function GDALComputeRasterMinMax().
  *
  * @param bApproxOK TRUE if an approximate (faster) answer is OK, otherwise
@@ -5474,107 +6219,16 @@ CPLErr GDALRasterBand::ComputeRasterMinMax( int bApproxOK,
               nSampleRate += 1;
         }
 
-        for( int iSampleBlock = 0;
-             iSampleBlock < nBlocksPerRow * nBlocksPerColumn;
-             iSampleBlock += nSampleRate )
-        {
-            const int iYBlock = iSampleBlock / nBlocksPerRow;
-            const int iXBlock = iSampleBlock - nBlocksPerRow * iYBlock;
-
-            GDALRasterBlock *poBlock = GetLockedBlockRef( iXBlock, iYBlock );
-            if( poBlock == NULL )
-                continue;
-
-            void * const pData = poBlock->GetDataRef();
-
-            int nXCheck = nBlockXSize;
-            if( (iXBlock+1) * nBlockXSize > GetXSize() )
-                nXCheck = GetXSize() - iXBlock * nBlockXSize;
-
-            int nYCheck = nBlockYSize;
-            if( (iYBlock+1) * nBlockYSize > GetYSize() )
-                nYCheck = GetYSize() - iYBlock * nBlockYSize;
-
-            // This isn't the fastest way to do this, but is easier for now.
-            for( int iY = 0; iY < nYCheck; iY++ )
-            {
-                for( int iX = 0; iX < nXCheck; iX++ )
-                {
-                    const int iOffset = iX + iY * nBlockXSize;
-                    double dfValue = 0.0;
-
-                    switch( eDataType )
-                    {
-                      case GDT_Byte:
-                      {
-                        if (bSignedByte)
-                            dfValue = static_cast<signed char *>(pData)[iOffset];
-                        else
-                            dfValue = static_cast<GByte *>(pData)[iOffset];
-                        break;
-                      }
-                      case GDT_UInt16:
-                        dfValue = static_cast<GUInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset];
-                        break;
-                      case GDT_UInt32:
-                        dfValue = static_cast<GUInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Int32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset];
-                        break;
-                      case GDT_Float32:
-                        dfValue = static_cast<float *>(pData)[iOffset];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_Float64:
-                        dfValue = static_cast<double *>(pData)[iOffset];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CInt16:
-                        dfValue = static_cast<GInt16 *>(pData)[iOffset*2];
-                        break;
-                      case GDT_CInt32:
-                        dfValue = static_cast<GInt32 *>(pData)[iOffset*2];
-                        break;
-                      case GDT_CFloat32:
-                        dfValue = static_cast<float *>(pData)[iOffset*2];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      case GDT_CFloat64:
-                        dfValue = static_cast<double *>(pData)[iOffset*2];
-                        if( CPLIsNan(dfValue) )
-                            continue;
-                        break;
-                      default:
-                        CPLAssert( false );
-                    }
-
-                    if( bGotNoDataValue &&
-                        ARE_REAL_EQUAL(dfValue, dfNoDataValue) )
-                        continue;
-
-                    if( bFirstValue )
-                    {
-                        dfMin = dfValue;
-                        dfMax = dfValue;
-                        bFirstValue = false;
-                    }
-                    else
-                    {
-                        dfMin = std::min(dfMin, dfValue);
-                        dfMax = std::max(dfMax, dfValue);
-                    }
-                }
-            }
-
-            poBlock->DropLock();
-        }
+        GDALGenericStatsAccumulator oAccumulator(
+            eDataType, bSignedByte, CPL_TO_BOOL(bGotNoDataValue),
+            dfNoDataValue, false );
+        if( GDALProcessSampledBlocks( this, nSampleRate, true, oAccumulator,
+                                      "Compute Min/Max",
+                                      GDALDummyProgress, NULL ) != CE_None )
+            return CE_Failure;
+        bFirstValue = oAccumulator.bFirstValue;
+        dfMin = oAccumulator.dfMin;
+        dfMax = oAccumulator.dfMax;
     }
 
     adfMinMax[0] = dfMin;
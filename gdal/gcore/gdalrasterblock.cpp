@@ -31,24 +31,32 @@
 #include "cpl_multiproc.h"
 #include "gdal_priv.h"
 
+#include <algorithm>
+
 CPL_CVSID("$Id$");
 
 static bool bCacheMaxInitialized = false;
 // Will later be overridden by the default 5% if GDAL_CACHEMAX not defined.
 static GIntBig nCacheMax = 40 * 1024 * 1024;
-static volatile GIntBig nCacheUsed = 0;
 
-static GDALRasterBlock *poOldest = NULL;  // Tail.
-static GDALRasterBlock *poNewest = NULL;  // Head.
+// The LRU list of cached blocks can be split into several independent lists
+// ("shards"), each with its own lock, so that threads working on different
+// blocks do not contend on a single lock. A block is assigned to a shard
+// according to a hash of its band and position. Each shard is normally kept
+// under its share of the cache maximum.
+#define MAX_CACHE_SHARDS 64
 
-#if 0
-static CPLMutex *hRBLock = NULL;
-#define INITIALIZE_LOCK CPLMutexHolderD( &hRBLock )
-#define TAKE_LOCK       CPLMutexHolderOptionalLockD( hRBLock )
-#define DESTROY_LOCK    CPLDestroyMutex( hRBLock )
-#else
+struct GDALRasterBlockCacheShard
+{
+    CPLLock         *hRBLock;
+    GDALRasterBlock *poOldest;  // Tail.
+    GDALRasterBlock *poNewest;  // Head.
+    volatile GIntBig nCacheUsed;
+};
+
+static GDALRasterBlockCacheShard asShards[MAX_CACHE_SHARDS];
+static int nShards = 0;
 
-static CPLLock* hRBLock = NULL;
 static bool bDebugContention = false;
 static bool bSleepsForBockCacheDebug = false;
 static CPLLockType GetLockType()
@@ -78,12 +86,69 @@ static CPLLockType GetLockType()
     return (CPLLockType) nLockType;
 }
 
-#define INITIALIZE_LOCK         CPLLockHolderD( &hRBLock, GetLockType() ); \
-                                CPLLockSetDebugPerf(hRBLock, bDebugContention)
-#define TAKE_LOCK               CPLLockHolderOptionalLockD( hRBLock )
-#define DESTROY_LOCK            CPLDestroyLock( hRBLock )
+#define INITIALIZE_LOCK(psShard) \
+                CPLLockHolderD( &((psShard)->hRBLock), GetLockType() ); \
+                CPLLockSetDebugPerf((psShard)->hRBLock, bDebugContention)
+#define TAKE_LOCK(psShard)      CPLLockHolderOptionalLockD( (psShard)->hRBLock )
+#define DESTROY_LOCK(psShard)   CPLDestroyLock( (psShard)->hRBLock )
 
-#endif
+/************************************************************************/
+/*                          InitializeShards()                          */
+/************************************************************************/
+
+// Reads the GDAL_RB_CACHE_SHARDS configuration option the first time, and
+// makes sure that the lock of each shard exists, so that TAKE_LOCK() can
+// be used afterwards.
+static void InitializeShards()
+{
+    int nVal = nShards;
+    if( nVal == 0 )
+    {
+        const char* pszShards =
+            CPLGetConfigOption("GDAL_RB_CACHE_SHARDS", "1");
+        nVal = EQUAL(pszShards, "ALL_CPUS") ? CPLGetNumCPUs()
+                                            : atoi(pszShards);
+        if( nVal < 1 )
+        {
+            CPLError(CE_Warning, CPLE_NotSupported,
+                     "Invalid value for GDAL_RB_CACHE_SHARDS: %s. "
+                     "Using 1 instead",
+                     pszShards);
+            nVal = 1;
+        }
+        else if( nVal > MAX_CACHE_SHARDS )
+        {
+            CPLDebug("GDAL", "GDAL_RB_CACHE_SHARDS limited to %d",
+                     MAX_CACHE_SHARDS);
+            nVal = MAX_CACHE_SHARDS;
+        }
+    }
+    // Locks must exist before nShards is published to other threads.
+    for( int i = 0; i < nVal; ++i )
+    {
+        INITIALIZE_LOCK(&asShards[i]);
+    }
+    nShards = nVal;
+}
+
+/************************************************************************/
+/*                            GetShard()                                */
+/************************************************************************/
+
+static GDALRasterBlockCacheShard* GetShard( const GDALRasterBand* poBand,
+                                            int nXOff, int nYOff )
+{
+    if( nShards <= 1 )
+        return &asShards[0];
+    // Neighbouring blocks of a band must be spread among shards, since
+    // they are typically accessed by different threads at the same time.
+    GUIntBig nHash = static_cast<GUIntBig>(
+        reinterpret_cast<size_t>(poBand)) >> 4;
+    nHash = nHash * 31 + static_cast<unsigned>(nXOff) * 0x9E3779B1U;
+    nHash = nHash * 31 + static_cast<unsigned>(nYOff) * 0x85EBCA6BU;
+    nHash ^= nHash >> 17;
+    return &asShards[nHash % nShards];
+}
 
 //#define ENABLE_DEBUG
 
@@ -124,6 +189,12 @@ void CPL_STDCALL GDALSetCacheMax( int nNewSizeInBytes )
  * capabilities. This function will not make any attempt to check the
  * consistency of the passed value with the effective capabilities of the OS.
  *
+ * When the GDAL_RB_CACHE_SHARDS configuration option is set to a value
+ * greater than 1 (or ALL_CPUS), the cache is split into that number of
+ * independently locked shards (up to 64), each one being kept under its share
+ * of the maximum. This reduces lock contention in multi-threaded reading
+ * scenarios. Its value is read the first time the cache is used.
+ *
  * @param nNewSizeInBytes the maximum number of bytes for caching.
  *
  * @since GDAL 1.8.0
@@ -140,9 +211,7 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
     }
 #endif
 
-    {
-        INITIALIZE_LOCK;
-    }
+    InitializeShards();
     bCacheMaxInitialized = true;
     nCacheMax = nNewSizeInBytes;
 
@@ -150,13 +219,13 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
 /*      Flush blocks till we are under the new limit or till we         */
 /*      can't seem to flush anymore.                                    */
 /* -------------------------------------------------------------------- */
-    while( nCacheUsed > nCacheMax )
+    while( GDALGetCacheUsed64() > nCacheMax )
     {
-        const GIntBig nOldCacheUsed = nCacheUsed;
+        const GIntBig nOldCacheUsed = GDALGetCacheUsed64();
 
         GDALFlushCacheBlock();
 
-        if( nCacheUsed == nOldCacheUsed )
+        if( GDALGetCacheUsed64() == nOldCacheUsed )
             break;
     }
 }
@@ -226,9 +295,7 @@ GIntBig CPL_STDCALL GDALGetCacheMax64()
 {
     if( !bCacheMaxInitialized )
     {
-        {
-            INITIALIZE_LOCK;
-        }
+        InitializeShards();
         bSleepsForBockCacheDebug = CPLTestBool(
             CPLGetConfigOption("GDAL_DEBUG_BLOCK_CACHE", "NO"));
 
@@ -310,6 +377,7 @@ GIntBig CPL_STDCALL GDALGetCacheMax64()
 
 int CPL_STDCALL GDALGetCacheUsed()
 {
+    const GIntBig nCacheUsed = GDALGetCacheUsed64();
     if (nCacheUsed > INT_MAX)
     {
         static bool bHasWarned = false;
@@ -338,7 +406,15 @@ int CPL_STDCALL GDALGetCacheUsed()
  * @since GDAL 1.8.0
  */
 
-GIntBig CPL_STDCALL GDALGetCacheUsed64() { return nCacheUsed; }
+GIntBig CPL_STDCALL GDALGetCacheUsed64()
+{
+    // Approximate when several shards are used, as their individual usage
+    // is read without taking their locks.
+    GIntBig nCacheUsed = asShards[0].nCacheUsed;
+    for( int i = 1; i < nShards; ++i )
+        nCacheUsed += asShards[i].nCacheUsed;
+    return nCacheUsed;
+}
 
 /************************************************************************/
 /*                        GDALFlushCacheBlock()                         */
@@ -416,12 +492,41 @@ int CPL_STDCALL GDALFlushCacheBlock()
 
 int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
 
+{
+    if( nShards <= 1 )
+        return FlushCacheBlock( &asShards[0], bDirtyBlocksOnly );
+
+    // Try the most used shards first.
+    bool abTried[MAX_CACHE_SHARDS] = { false };
+    for( int iIter = 0; iIter < nShards; ++iIter )
+    {
+        int iBestShard = -1;
+        for( int i = 0; i < nShards; ++i )
+        {
+            if( !abTried[i] &&
+                (iBestShard < 0 ||
+                 asShards[i].nCacheUsed > asShards[iBestShard].nCacheUsed) )
+            {
+                iBestShard = i;
+            }
+        }
+        abTried[iBestShard] = true;
+        if( FlushCacheBlock( &asShards[iBestShard], bDirtyBlocksOnly ) )
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/*! @cond Doxygen_Suppress */
+int GDALRasterBlock::FlushCacheBlock( struct GDALRasterBlockCacheShard* psShard,
+                                      int bDirtyBlocksOnly )
+
 {
     GDALRasterBlock *poTarget;
 
     {
-        INITIALIZE_LOCK;
-        poTarget = poOldest;
+        INITIALIZE_LOCK(psShard);
+        poTarget = psShard->poOldest;
 
         while( poTarget != NULL )
         {
@@ -465,6 +570,7 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
 
     return TRUE;
 }
+/*! @endcond */
 
 /************************************************************************/
 /*                          FlushDirtyBlocks()                          */
@@ -636,19 +742,20 @@ void GDALRasterBlock::Detach()
 {
     if( bMustDetach )
     {
-        TAKE_LOCK;
+        TAKE_LOCK(GetShard(poBand, nXOff, nYOff));
         Detach_unlocked();
     }
 }
 
 void GDALRasterBlock::Detach_unlocked()
 {
-    if( poOldest == this )
-        poOldest = poPrevious;
+    GDALRasterBlockCacheShard* psShard = GetShard(poBand, nXOff, nYOff);
+    if( psShard->poOldest == this )
+        psShard->poOldest = poPrevious;
 
-    if( poNewest == this )
+    if( psShard->poNewest == this )
     {
-        poNewest = poNext;
+        psShard->poNewest = poNext;
     }
 
     if( poPrevious != NULL )
@@ -662,7 +769,7 @@ void GDALRasterBlock::Detach_unlocked()
     bMustDetach = false;
 
     if( pData )
-        nCacheUsed -= GetBlockSize();
+        psShard->nCacheUsed -= GetBlockSize();
 
 #ifdef ENABLE_DEBUG
     Verify();
@@ -682,27 +789,35 @@ void GDALRasterBlock::Detach_unlocked()
 void GDALRasterBlock::Verify()
 
 {
-    TAKE_LOCK;
-
-    CPLAssert( (poNewest == NULL && poOldest == NULL)
-               || (poNewest != NULL && poOldest != NULL) );
-
-    if( poNewest != NULL )
+    for( int i = 0; i < nShards; ++i )
     {
-        CPLAssert( poNewest->poPrevious == NULL );
-        CPLAssert( poOldest->poNext == NULL );
+        GDALRasterBlockCacheShard* psShard = &asShards[i];
+        TAKE_LOCK(psShard);
+        GDALRasterBlock* poNewest = psShard->poNewest;
+        GDALRasterBlock* poOldest = psShard->poOldest;
 
-        GDALRasterBlock* poLast = NULL;
-        for( GDALRasterBlock *poBlock = poNewest;
-             poBlock != NULL;
-             poBlock = poBlock->poNext )
+        CPLAssert( (poNewest == NULL && poOldest == NULL)
+                   || (poNewest != NULL && poOldest != NULL) );
+
+        if( poNewest != NULL )
         {
-            CPLAssert( poBlock->poPrevious == poLast );
+            CPLAssert( poNewest->poPrevious == NULL );
+            CPLAssert( poOldest->poNext == NULL );
 
-            poLast = poBlock;
-        }
+            GDALRasterBlock* poLast = NULL;
+            for( GDALRasterBlock *poBlock = poNewest;
+                 poBlock != NULL;
+                 poBlock = poBlock->poNext )
+            {
+                CPLAssert( poBlock->poPrevious == poLast );
+                CPLAssert( GetShard(poBlock->poBand, poBlock->nXOff,
+                                    poBlock->nYOff) == psShard );
 
-        CPLAssert( poOldest == poLast );
+                poLast = poBlock;
+            }
+
+            CPLAssert( poOldest == poLast );
+        }
     }
 }
 
@@ -713,8 +828,10 @@ void GDALRasterBlock::Verify() {}
 #ifdef notdef
 void GDALRasterBlock::CheckNonOrphanedBlocks( GDALRasterBand* poBand )
 {
-    TAKE_LOCK;
-    for( GDALRasterBlock *poBlock = poNewest;
+  for( int i = 0; i < nShards; ++i )
+  {
+    TAKE_LOCK(&asShards[i]);
+    for( GDALRasterBlock *poBlock = asShards[i].poNewest;
                           poBlock != NULL;
                           poBlock = poBlock->poNext )
     {
@@ -734,6 +851,7 @@ void GDALRasterBlock::CheckNonOrphanedBlocks( GDALRasterBand* poBand )
                        poBand->GetDataset()->GetDescription());
         }
     }
+  }
 }
 #endif
 
@@ -787,11 +905,13 @@ CPLErr GDALRasterBlock::Write()
 void GDALRasterBlock::Touch()
 
 {
+    GDALRasterBlockCacheShard* psShard = GetShard(poBand, nXOff, nYOff);
+
     // Can be safely tested outside the lock
-    if( poNewest == this )
+    if( psShard->poNewest == this )
         return;
 
-    TAKE_LOCK;
+    TAKE_LOCK(psShard);
     Touch_unlocked();
 }
 
@@ -804,6 +924,9 @@ void GDALRasterBlock::Touch_unlocked()
     // 1. Thread 1 calls Touch() and poNewest != this at that point
     // 2. Thread 2 detaches poNewest
     // 3. Thread 1 arrives here
+    GDALRasterBlockCacheShard* psShard = GetShard(poBand, nXOff, nYOff);
+    GDALRasterBlock*& poNewest = psShard->poNewest;
+    GDALRasterBlock*& poOldest = psShard->poOldest;
     if( poNewest == this )
         return;
 
@@ -812,7 +935,7 @@ void GDALRasterBlock::Touch_unlocked()
     if( !bMustDetach )
     {
         if( pData )
-            nCacheUsed += GetBlockSize();
+            psShard->nCacheUsed += GetBlockSize();
 
         bMustDetach = true;
     }
@@ -868,13 +991,17 @@ CPLErr GDALRasterBlock::Internalize()
 
     void        *pNewData = NULL;
 
-    // This call will initialize the hRBLock mutex. Other call places can
+    // This call will initialize the shard locks. Other call places can
     // only be called if we have go through there.
     const GIntBig nCurCacheMax = GDALGetCacheMax64();
 
     // No risk of overflow as it is checked in GDALRasterBand::InitBlockInfo().
     const int nSizeInBytes = GetBlockSize();
 
+    // Each shard is kept under its share of the cache maximum.
+    GDALRasterBlockCacheShard* psShard = GetShard(poBand, nXOff, nYOff);
+    const GIntBig nShardCacheMax = nCurCacheMax / std::max(1, nShards);
+
 /* -------------------------------------------------------------------- */
 /*      Flush old blocks if we are nearing our memory limit.            */
 /* -------------------------------------------------------------------- */
@@ -886,12 +1013,12 @@ CPLErr GDALRasterBlock::Internalize()
         GDALRasterBlock* apoBlocksToFree[64] = { NULL };
         int nBlocksToFree = 0;
         {
-            TAKE_LOCK;
+            TAKE_LOCK(psShard);
 
             if( bFirstIter )
-                nCacheUsed += nSizeInBytes;
-            GDALRasterBlock *poTarget = poOldest;
-            while( nCacheUsed > nCurCacheMax )
+                psShard->nCacheUsed += nSizeInBytes;
+            GDALRasterBlock *poTarget = psShard->poOldest;
+            while( psShard->nCacheUsed > nShardCacheMax )
             {
                 while( poTarget != NULL )
                 {
@@ -920,12 +1047,12 @@ CPLErr GDALRasterBlock::Internalize()
                         // Only free one dirty block at a time so that
                         // other dirty blocks of other bands with the same
                         // coordinates can be found with TryGetLockedBlock()
-                        bLoopAgain = nCacheUsed > nCurCacheMax;
+                        bLoopAgain = psShard->nCacheUsed > nShardCacheMax;
                         break;
                     }
                     if( nBlocksToFree == 64 )
                     {
-                        bLoopAgain = ( nCacheUsed > nCurCacheMax );
+                        bLoopAgain = ( psShard->nCacheUsed > nShardCacheMax );
                         break;
                     }
 
@@ -990,6 +1117,20 @@ CPLErr GDALRasterBlock::Internalize()
 
     pData = pNewData;
 
+/* -------------------------------------------------------------------- */
+/*      With several shards, blocks of the other shards may have to be  */
+/*      flushed if this one could not get under its share (because of   */
+/*      locked blocks), or if the usage of the others is above theirs.  */
+/* -------------------------------------------------------------------- */
+    if( nShards > 1 )
+    {
+        while( GDALGetCacheUsed64() > nCurCacheMax )
+        {
+            if( !FlushCacheBlock() )
+                break;
+        }
+    }
+
     return CE_None;
 }
 
@@ -1031,9 +1172,12 @@ void GDALRasterBlock::MarkClean() { bDirty = false; }
 /*! @cond Doxygen_Suppress */
 void GDALRasterBlock::DestroyRBMutex()
 {
-    if( hRBLock != NULL )
-        DESTROY_LOCK;
-    hRBLock = NULL;
+    for( int i = 0; i < MAX_CACHE_SHARDS; ++i )
+    {
+        if( asShards[i].hRBLock != NULL )
+            DESTROY_LOCK(&asShards[i]);
+        asShards[i].hRBLock = NULL;
+    }
 }
 /*! @endcond */
 
@@ -1074,7 +1218,7 @@ int GDALRasterBlock::TakeLock()
         DropLock();
 
         // wait for the block having been unreferenced
-        TAKE_LOCK;
+        TAKE_LOCK(GetShard(poBand, nXOff, nYOff));
 
         return FALSE;
     }
@@ -1110,7 +1254,7 @@ int GDALRasterBlock::DropLockForRemovalFromStorage()
 #endif
 
     // Wait for the block for having been unreferenced.
-    TAKE_LOCK;
+    TAKE_LOCK(GetShard(poBand, nXOff, nYOff));
 
     return FALSE;
 }
@@ -1119,14 +1263,17 @@ int GDALRasterBlock::DropLockForRemovalFromStorage()
 void GDALRasterBlock::DumpAll()
 {
     int iBlock = 0;
-    for( GDALRasterBlock *poBlock = poNewest;
-         poBlock != NULL;
-         poBlock = poBlock->poNext )
+    for( int i = 0; i < nShards; ++i )
     {
-        printf("Block %d\n", iBlock);
-        poBlock->DumpBlock();
-        printf("\n");
-        iBlock++;
+        for( GDALRasterBlock *poBlock = asShards[i].poNewest;
+             poBlock != NULL;
+             poBlock = poBlock->poNext )
+        {
+            printf("Block %d\n", iBlock);
+            poBlock->DumpBlock();
+            printf("\n");
+            iBlock++;
+        }
     }
 }
 
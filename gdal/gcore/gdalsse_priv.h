@@ -327,6 +327,14 @@ class XMMReg2Double
         xmm = _mm_add_pd(xmm, xmm2);
     }
 
+    /* (a0,a1),(b0,b1) -> (a0,b0),(a1,b1) */
+    static inline void Transpose(XMMReg2Double& a, XMMReg2Double& b)
+    {
+        __m128d xmm2 = _mm_unpacklo_pd(a.xmm, b.xmm);
+        b.xmm = _mm_unpackhi_pd(a.xmm, b.xmm);
+        a.xmm = xmm2;
+    }
+
     inline void Store2Double(double* pval) const
     {
         _mm_storeu_pd(pval, xmm);
@@ -653,6 +661,14 @@ class XMMReg2Double
         high = add;
     }
 
+    /* (a0,a1),(b0,b1) -> (a0,b0),(a1,b1) */
+    static inline void Transpose(XMMReg2Double& a, XMMReg2Double& b)
+    {
+        double dfTmp = a.high;
+        a.high = b.low;
+        b.low = dfTmp;
+    }
+
     inline void Store2Double(double* pval) const
     {
         pval[0] = low;
@@ -27,14 +27,28 @@
  * DEALINGS IN THE SOFTWARE.
  ****************************************************************************/
 
+#include <deque>
 #include <limits>
 #include <vector>
 
+#include "cpl_cpu_features.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_priv.h"
 #include "gdalwarper.h"
+#include "memdataset.h"
 
 #include <algorithm>
 
+// Restrict to 64bit processors because they are guaranteed to have SSE2.
+// Could possibly be used too on 32bit, but we would need to check at runtime.
+#if defined(__x86_64) || defined(_M_X64)
+#define USE_SSE2
+#endif
+
+#ifdef USE_SSE2
+#include <gdalsse_priv.h>
+#endif
+
 CPL_CVSID("$Id$");
 
 /************************************************************************/
@@ -230,6 +244,487 @@ static bool ReadColorTableAsArray( const GDALColorTable* poColorTable,
     return true;
 }
 
+/************************************************************************/
+/*                     2x2 average decimation kernels                   */
+/************************************************************************/
+
+// The kernels below compute the average of 2x2 source pixels, for the
+// common case of an overview by a factor of 2 of a Byte, UInt16 or Float32
+// band. They return the number of destination pixels processed, the
+// remaining ones being processed by the generic code, and give exactly
+// the same results as it.
+
+#if defined(USE_SSE2) && defined(HAVE_AVX2_AT_COMPILE_TIME)
+int GDALAverage2x2_Byte_AVX2( const GByte* pSrc0, const GByte* pSrc1,
+                              int nDstXWidth, GByte* pDst );
+int GDALAverage2x2_UInt16_AVX2( const GUInt16* pSrc0, const GUInt16* pSrc1,
+                                int nDstXWidth, GUInt16* pDst );
+int GDALAverage2x2_Float_AVX2( const float* pSrc0, const float* pSrc1,
+                               int nDstXWidth, float* pDst );
+int GDALAverage2x2WithMask_Byte_AVX2( const GByte* pSrc0, const GByte* pSrc1,
+                                      const GByte* pabyMask0,
+                                      const GByte* pabyMask1,
+                                      int nDstXWidth, GByte nNoDataValue,
+                                      GByte* pDst );
+int GDALAverage2x2WithMask_UInt16_AVX2( const GUInt16* pSrc0,
+                                        const GUInt16* pSrc1,
+                                        const GByte* pabyMask0,
+                                        const GByte* pabyMask1,
+                                        int nDstXWidth,
+                                        GUInt16 nNoDataValue,
+                                        GUInt16* pDst );
+int GDALAverage2x2WithMask_Float_AVX2( const float* pSrc0, const float* pSrc1,
+                                       const GByte* pabyMask0,
+                                       const GByte* pabyMask1,
+                                       int nDstXWidth, float fNoDataValue,
+                                       float* pDst );
+#endif
+
+#ifdef USE_SSE2
+
+/************************************************************************/
+/*                     GDALAverage2x2_Byte_SSE2()                       */
+/************************************************************************/
+
+static int GDALAverage2x2_Byte_SSE2( const GByte* pSrc0, const GByte* pSrc1,
+                                     int nDstXWidth, GByte* pDst )
+{
+    const __m128i xmmMaskLow = _mm_set1_epi16(0xFF);
+    const __m128i xmmTwo = _mm_set1_epi16(2);
+    int i = 0;
+    for( ; i + 15 < nDstXWidth; i += 16 )
+    {
+        __m128i axmmSum[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            const __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(pSrc0 + 2 * i + 16 * k));
+            const __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(pSrc1 + 2 * i + 16 * k));
+            // Sum of the even and odd bytes of each line, in 16 bit words.
+            const __m128i xmmSum0 = _mm_add_epi16(
+                _mm_and_si128(xmm0, xmmMaskLow), _mm_srli_epi16(xmm0, 8));
+            const __m128i xmmSum1 = _mm_add_epi16(
+                _mm_and_si128(xmm1, xmmMaskLow), _mm_srli_epi16(xmm1, 8));
+            axmmSum[k] = _mm_srli_epi16(
+                _mm_add_epi16(_mm_add_epi16(xmmSum0, xmmSum1), xmmTwo), 2);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i),
+                         _mm_packus_epi16(axmmSum[0], axmmSum[1]));
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                      GDALPackUInt32ToUInt16SSE2()                    */
+/************************************************************************/
+
+// Equivalent of SSE4.1 _mm_packus_epi32() for values in [0, 65535].
+static inline __m128i GDALPackUInt32ToUInt16SSE2( __m128i xmm0, __m128i xmm1 )
+{
+    const __m128i xmmShift32 = _mm_set1_epi32(32768);
+    const __m128i xmmShift16 = _mm_set1_epi16(-32768);
+    return _mm_xor_si128(
+        _mm_packs_epi32(_mm_sub_epi32(xmm0, xmmShift32),
+                        _mm_sub_epi32(xmm1, xmmShift32)),
+        xmmShift16);
+}
+
+/************************************************************************/
+/*                     GDALAverage2x2_UInt16_SSE2()                     */
+/************************************************************************/
+
+static int GDALAverage2x2_UInt16_SSE2( const GUInt16* pSrc0,
+                                       const GUInt16* pSrc1,
+                                       int nDstXWidth, GUInt16* pDst )
+{
+    const __m128i xmmMaskLow = _mm_set1_epi32(0xFFFF);
+    const __m128i xmmTwo = _mm_set1_epi32(2);
+    int i = 0;
+    for( ; i + 7 < nDstXWidth; i += 8 )
+    {
+        __m128i axmmSum[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            const __m128i xmm0 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(pSrc0 + 2 * i + 8 * k));
+            const __m128i xmm1 = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(pSrc1 + 2 * i + 8 * k));
+            // Sum of the even and odd words of each line, in 32 bit words.
+            const __m128i xmmSum0 = _mm_add_epi32(
+                _mm_and_si128(xmm0, xmmMaskLow), _mm_srli_epi32(xmm0, 16));
+            const __m128i xmmSum1 = _mm_add_epi32(
+                _mm_and_si128(xmm1, xmmMaskLow), _mm_srli_epi32(xmm1, 16));
+            axmmSum[k] = _mm_srli_epi32(
+                _mm_add_epi32(_mm_add_epi32(xmmSum0, xmmSum1), xmmTwo), 2);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i),
+                         GDALPackUInt32ToUInt16SSE2(axmmSum[0], axmmSum[1]));
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                          GDALSum4SSE2()                              */
+/************************************************************************/
+
+// Sum, in double precision and in the same order as the generic code, of
+// the 4 float vectors, and multiplication of the result by 0.25 or
+// division by the corresponding element of *pxmmDivisor.
+static inline __m128 GDALSum4SSE2( __m128 xmmA, __m128 xmmB,
+                                   __m128 xmmC, __m128 xmmD,
+                                   const __m128* pxmmDivisor )
+{
+    __m128d axmmRes[2];
+    for( int k = 0; k < 2; k++ )
+    {
+        const __m128 xmmA_k = k == 0 ? xmmA : _mm_movehl_ps(xmmA, xmmA);
+        const __m128 xmmB_k = k == 0 ? xmmB : _mm_movehl_ps(xmmB, xmmB);
+        const __m128 xmmC_k = k == 0 ? xmmC : _mm_movehl_ps(xmmC, xmmC);
+        const __m128 xmmD_k = k == 0 ? xmmD : _mm_movehl_ps(xmmD, xmmD);
+        __m128d xmmSum = _mm_add_pd(_mm_setzero_pd(), _mm_cvtps_pd(xmmA_k));
+        xmmSum = _mm_add_pd(xmmSum, _mm_cvtps_pd(xmmB_k));
+        xmmSum = _mm_add_pd(xmmSum, _mm_cvtps_pd(xmmC_k));
+        xmmSum = _mm_add_pd(xmmSum, _mm_cvtps_pd(xmmD_k));
+        if( pxmmDivisor == NULL )
+        {
+            axmmRes[k] = _mm_mul_pd(xmmSum, _mm_set1_pd(0.25));
+        }
+        else
+        {
+            const __m128 xmmDivisor_k = k == 0 ? *pxmmDivisor :
+                _mm_movehl_ps(*pxmmDivisor, *pxmmDivisor);
+            axmmRes[k] = _mm_div_pd(xmmSum, _mm_cvtps_pd(xmmDivisor_k));
+        }
+    }
+    return _mm_movelh_ps(_mm_cvtpd_ps(axmmRes[0]), _mm_cvtpd_ps(axmmRes[1]));
+}
+
+/************************************************************************/
+/*                      GDALAverage2x2_Float_SSE2()                     */
+/************************************************************************/
+
+static int GDALAverage2x2_Float_SSE2( const float* pSrc0, const float* pSrc1,
+                                      int nDstXWidth, float* pDst )
+{
+    int i = 0;
+    for( ; i + 3 < nDstXWidth; i += 4 )
+    {
+        const __m128 xmmA0 = _mm_loadu_ps(pSrc0 + 2 * i);
+        const __m128 xmmB0 = _mm_loadu_ps(pSrc0 + 2 * i + 4);
+        const __m128 xmmA1 = _mm_loadu_ps(pSrc1 + 2 * i);
+        const __m128 xmmB1 = _mm_loadu_ps(pSrc1 + 2 * i + 4);
+        _mm_storeu_ps(pDst + i, GDALSum4SSE2(
+            _mm_shuffle_ps(xmmA0, xmmB0, _MM_SHUFFLE(2,0,2,0)),
+            _mm_shuffle_ps(xmmA0, xmmB0, _MM_SHUFFLE(3,1,3,1)),
+            _mm_shuffle_ps(xmmA1, xmmB1, _MM_SHUFFLE(2,0,2,0)),
+            _mm_shuffle_ps(xmmA1, xmmB1, _MM_SHUFFLE(3,1,3,1)),
+            NULL));
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                     GDALAverageDivRoundSSE2()                        */
+/************************************************************************/
+
+// (nTotal + nCount / 2) / nCount on 32 bit words, or nNoDataValue where
+// nCount is 0. With nCount <= 4 and nTotal < 2^22, the single precision
+// division is exact enough for the truncation to give the integer quotient.
+static inline __m128i GDALAverageDivRoundSSE2( __m128i xmmTotal,
+                                               __m128i xmmCount,
+                                               __m128i xmmNoData )
+{
+    const __m128 xmmNum = _mm_cvtepi32_ps(
+        _mm_add_epi32(xmmTotal, _mm_srli_epi32(xmmCount, 1)));
+    const __m128i xmmRes = _mm_cvttps_epi32(
+        _mm_div_ps(xmmNum, _mm_cvtepi32_ps(xmmCount)));
+    const __m128i xmmZeroCount =
+        _mm_cmpeq_epi32(xmmCount, _mm_setzero_si128());
+    return _mm_or_si128(_mm_andnot_si128(xmmZeroCount, xmmRes),
+                        _mm_and_si128(xmmZeroCount, xmmNoData));
+}
+
+/************************************************************************/
+/*                  GDALAverage2x2WithMask_Byte_SSE2()                  */
+/************************************************************************/
+
+static int GDALAverage2x2WithMask_Byte_SSE2( const GByte* pSrc0,
+                                             const GByte* pSrc1,
+                                             const GByte* pabyMask0,
+                                             const GByte* pabyMask1,
+                                             int nDstXWidth,
+                                             GByte nNoDataValue,
+                                             GByte* pDst )
+{
+    const __m128i xmmZero = _mm_setzero_si128();
+    const __m128i xmmMaskLow = _mm_set1_epi16(0xFF);
+    const __m128i xmmOne = _mm_set1_epi8(1);
+    const __m128i xmmNoData = _mm_set1_epi32(nNoDataValue);
+    int i = 0;
+    for( ; i + 7 < nDstXWidth; i += 8 )
+    {
+        __m128i xmmTotal = xmmZero;
+        __m128i xmmCount = xmmZero;
+        for( int iLine = 0; iLine < 2; iLine++ )
+        {
+            const GByte* pSrc = iLine == 0 ? pSrc0 : pSrc1;
+            const GByte* pabyMask = iLine == 0 ? pabyMask0 : pabyMask1;
+            // 0xFF for valid pixels.
+            const __m128i xmmValid = _mm_xor_si128(
+                _mm_cmpeq_epi8(
+                    _mm_loadu_si128(
+                        reinterpret_cast<const __m128i*>(pabyMask + 2 * i)),
+                    xmmZero),
+                _mm_set1_epi8(-1));
+            const __m128i xmmVal = _mm_and_si128(
+                _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(pSrc + 2 * i)),
+                xmmValid);
+            const __m128i xmmValidOne = _mm_and_si128(xmmValid, xmmOne);
+            xmmTotal = _mm_add_epi16(xmmTotal,
+                _mm_add_epi16(_mm_and_si128(xmmVal, xmmMaskLow),
+                              _mm_srli_epi16(xmmVal, 8)));
+            xmmCount = _mm_add_epi16(xmmCount,
+                _mm_add_epi16(_mm_and_si128(xmmValidOne, xmmMaskLow),
+                              _mm_srli_epi16(xmmValidOne, 8)));
+        }
+        const __m128i xmmRes0 = GDALAverageDivRoundSSE2(
+            _mm_unpacklo_epi16(xmmTotal, xmmZero),
+            _mm_unpacklo_epi16(xmmCount, xmmZero), xmmNoData);
+        const __m128i xmmRes1 = GDALAverageDivRoundSSE2(
+            _mm_unpackhi_epi16(xmmTotal, xmmZero),
+            _mm_unpackhi_epi16(xmmCount, xmmZero), xmmNoData);
+        const __m128i xmmRes = _mm_packs_epi32(xmmRes0, xmmRes1);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pDst + i),
+                         _mm_packus_epi16(xmmRes, xmmRes));
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                 GDALAverage2x2WithMask_UInt16_SSE2()                 */
+/************************************************************************/
+
+static int GDALAverage2x2WithMask_UInt16_SSE2( const GUInt16* pSrc0,
+                                               const GUInt16* pSrc1,
+                                               const GByte* pabyMask0,
+                                               const GByte* pabyMask1,
+                                               int nDstXWidth,
+                                               GUInt16 nNoDataValue,
+                                               GUInt16* pDst )
+{
+    const __m128i xmmZero = _mm_setzero_si128();
+    const __m128i xmmMaskLow = _mm_set1_epi32(0xFFFF);
+    const __m128i xmmOne = _mm_set1_epi16(1);
+    const __m128i xmmNoData = _mm_set1_epi32(nNoDataValue);
+    int i = 0;
+    for( ; i + 3 < nDstXWidth; i += 4 )
+    {
+        __m128i xmmTotal = xmmZero;
+        __m128i xmmCount = xmmZero;
+        for( int iLine = 0; iLine < 2; iLine++ )
+        {
+            const GUInt16* pSrc = iLine == 0 ? pSrc0 : pSrc1;
+            const GByte* pabyMask = iLine == 0 ? pabyMask0 : pabyMask1;
+            const __m128i xmmValid = _mm_xor_si128(
+                _mm_cmpeq_epi16(
+                    _mm_unpacklo_epi8(_mm_loadl_epi64(
+                        reinterpret_cast<const __m128i*>(pabyMask + 2 * i)),
+                        xmmZero),
+                    xmmZero),
+                _mm_set1_epi8(-1));
+            const __m128i xmmVal = _mm_and_si128(
+                _mm_loadu_si128(
+                    reinterpret_cast<const __m128i*>(pSrc + 2 * i)),
+                xmmValid);
+            const __m128i xmmValidOne = _mm_and_si128(xmmValid, xmmOne);
+            xmmTotal = _mm_add_epi32(xmmTotal,
+                _mm_add_epi32(_mm_and_si128(xmmVal, xmmMaskLow),
+                              _mm_srli_epi32(xmmVal, 16)));
+            xmmCount = _mm_add_epi32(xmmCount,
+                _mm_add_epi32(_mm_and_si128(xmmValidOne, xmmMaskLow),
+                              _mm_srli_epi32(xmmValidOne, 16)));
+        }
+        const __m128i xmmRes =
+            GDALAverageDivRoundSSE2(xmmTotal, xmmCount, xmmNoData);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pDst + i),
+                         GDALPackUInt32ToUInt16SSE2(xmmRes, xmmRes));
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                 GDALAverage2x2WithMask_Float_SSE2()                  */
+/************************************************************************/
+
+static int GDALAverage2x2WithMask_Float_SSE2( const float* pSrc0,
+                                              const float* pSrc1,
+                                              const GByte* pabyMask0,
+                                              const GByte* pabyMask1,
+                                              int nDstXWidth,
+                                              float fNoDataValue,
+                                              float* pDst )
+{
+    const __m128i xmmZero = _mm_setzero_si128();
+    const __m128 xmmOne = _mm_set1_ps(1.0f);
+    const __m128 xmmNoData = _mm_set1_ps(fNoDataValue);
+    int i = 0;
+    for( ; i + 3 < nDstXWidth; i += 4 )
+    {
+        __m128 axmmEven[2], axmmOdd[2];
+        __m128 xmmCount = _mm_setzero_ps();
+        for( int iLine = 0; iLine < 2; iLine++ )
+        {
+            const float* pSrc = iLine == 0 ? pSrc0 : pSrc1;
+            const GByte* pabyMask = iLine == 0 ? pabyMask0 : pabyMask1;
+            const __m128i xmmMask16 = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(pabyMask + 2 * i)),
+                xmmZero);
+            // Invalid values are replaced by +0.0, which does not modify
+            // the sum.
+            const __m128 xmmValidA = _mm_castsi128_ps(_mm_xor_si128(
+                _mm_cmpeq_epi32(_mm_unpacklo_epi16(xmmMask16, xmmZero),
+                                xmmZero),
+                _mm_set1_epi8(-1)));
+            const __m128 xmmValidB = _mm_castsi128_ps(_mm_xor_si128(
+                _mm_cmpeq_epi32(_mm_unpackhi_epi16(xmmMask16, xmmZero),
+                                xmmZero),
+                _mm_set1_epi8(-1)));
+            const __m128 xmmA =
+                _mm_and_ps(_mm_loadu_ps(pSrc + 2 * i), xmmValidA);
+            const __m128 xmmB =
+                _mm_and_ps(_mm_loadu_ps(pSrc + 2 * i + 4), xmmValidB);
+            axmmEven[iLine] = _mm_shuffle_ps(xmmA, xmmB, _MM_SHUFFLE(2,0,2,0));
+            axmmOdd[iLine] = _mm_shuffle_ps(xmmA, xmmB, _MM_SHUFFLE(3,1,3,1));
+            const __m128 xmmCountA = _mm_and_ps(xmmOne, xmmValidA);
+            const __m128 xmmCountB = _mm_and_ps(xmmOne, xmmValidB);
+            xmmCount = _mm_add_ps(xmmCount, _mm_add_ps(
+                _mm_shuffle_ps(xmmCountA, xmmCountB, _MM_SHUFFLE(2,0,2,0)),
+                _mm_shuffle_ps(xmmCountA, xmmCountB, _MM_SHUFFLE(3,1,3,1))));
+        }
+        const __m128 xmmRes = GDALSum4SSE2(axmmEven[0], axmmOdd[0],
+                                           axmmEven[1], axmmOdd[1],
+                                           &xmmCount);
+        const __m128 xmmZeroCount = _mm_cmpeq_ps(xmmCount, _mm_setzero_ps());
+        _mm_storeu_ps(pDst + i,
+                      _mm_or_ps(_mm_andnot_ps(xmmZeroCount, xmmRes),
+                                _mm_and_ps(xmmZeroCount, xmmNoData)));
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                     GDALUseAverageAVX2()                             */
+/************************************************************************/
+
+// The GDAL_USE_AVX2 configuration option can be set to NO to compare the
+// performance of the SSE2 and AVX2 code paths.
+static bool GDALUseAverageAVX2()
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    return CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX2", "YES")) &&
+           CPLHaveRuntimeAVX2();
+#else
+    return false;
+#endif
+}
+
+/************************************************************************/
+/*                          GDALAverage2x2()                            */
+/************************************************************************/
+
+static int GDALAverage2x2( CPL_UNUSED bool bUseAVX2,
+                           const GByte* pSrc0, const GByte* pSrc1,
+                           int nDstXWidth, GByte* pDst )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+        return GDALAverage2x2_Byte_AVX2(pSrc0, pSrc1, nDstXWidth, pDst);
+#endif
+    return GDALAverage2x2_Byte_SSE2(pSrc0, pSrc1, nDstXWidth, pDst);
+}
+
+static int GDALAverage2x2( CPL_UNUSED bool bUseAVX2,
+                           const GUInt16* pSrc0, const GUInt16* pSrc1,
+                           int nDstXWidth, GUInt16* pDst )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+        return GDALAverage2x2_UInt16_AVX2(pSrc0, pSrc1, nDstXWidth, pDst);
+#endif
+    return GDALAverage2x2_UInt16_SSE2(pSrc0, pSrc1, nDstXWidth, pDst);
+}
+
+static int GDALAverage2x2( CPL_UNUSED bool bUseAVX2,
+                           const float* pSrc0, const float* pSrc1,
+                           int nDstXWidth, float* pDst )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+        return GDALAverage2x2_Float_AVX2(pSrc0, pSrc1, nDstXWidth, pDst);
+#endif
+    return GDALAverage2x2_Float_SSE2(pSrc0, pSrc1, nDstXWidth, pDst);
+}
+
+/************************************************************************/
+/*                       GDALAverage2x2WithMask()                       */
+/************************************************************************/
+
+static int GDALAverage2x2WithMask( CPL_UNUSED bool bUseAVX2,
+                                   const GByte* pSrc0, const GByte* pSrc1,
+                                   const GByte* pabyMask0,
+                                   const GByte* pabyMask1,
+                                   int nDstXWidth, GByte nNoDataValue,
+                                   GByte* pDst )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+        return GDALAverage2x2WithMask_Byte_AVX2(
+            pSrc0, pSrc1, pabyMask0, pabyMask1, nDstXWidth, nNoDataValue,
+            pDst);
+#endif
+    return GDALAverage2x2WithMask_Byte_SSE2(
+        pSrc0, pSrc1, pabyMask0, pabyMask1, nDstXWidth, nNoDataValue, pDst);
+}
+
+static int GDALAverage2x2WithMask( CPL_UNUSED bool bUseAVX2,
+                                   const GUInt16* pSrc0, const GUInt16* pSrc1,
+                                   const GByte* pabyMask0,
+                                   const GByte* pabyMask1,
+                                   int nDstXWidth, GUInt16 nNoDataValue,
+                                   GUInt16* pDst )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+        return GDALAverage2x2WithMask_UInt16_AVX2(
+            pSrc0, pSrc1, pabyMask0, pabyMask1, nDstXWidth, nNoDataValue,
+            pDst);
+#endif
+    return GDALAverage2x2WithMask_UInt16_SSE2(
+        pSrc0, pSrc1, pabyMask0, pabyMask1, nDstXWidth, nNoDataValue, pDst);
+}
+
+static int GDALAverage2x2WithMask( CPL_UNUSED bool bUseAVX2,
+                                   const float* pSrc0, const float* pSrc1,
+                                   const GByte* pabyMask0,
+                                   const GByte* pabyMask1,
+                                   int nDstXWidth, float fNoDataValue,
+                                   float* pDst )
+{
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    if( bUseAVX2 )
+        return GDALAverage2x2WithMask_Float_AVX2(
+            pSrc0, pSrc1, pabyMask0, pabyMask1, nDstXWidth, fNoDataValue,
+            pDst);
+#endif
+    return GDALAverage2x2WithMask_Float_SSE2(
+        pSrc0, pSrc1, pabyMask0, pabyMask1, nDstXWidth, fNoDataValue, pDst);
+}
+
+#endif  // USE_SSE2
+
 /************************************************************************/
 /*                    GDALResampleChunk32R_Average()                    */
 /************************************************************************/
@@ -356,10 +851,18 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
         panSrcXOffShifted[2 * (iDstPixel - nDstXOff)] = nSrcXOff - nChunkXOff;
         panSrcXOffShifted[2 * (iDstPixel - nDstXOff) + 1] =
             nSrcXOff2 - nChunkXOff;
-        if( nSrcXOff2 - nSrcXOff != 2 )
+        if( nSrcXOff2 - nSrcXOff != 2 ||
+            nSrcXOff - nChunkXOff !=
+                panSrcXOffShifted[0] + 2 * (iDstPixel - nDstXOff) )
             bSrcXSpacingIsTwo = false;
     }
 
+#ifdef USE_SSE2
+    const bool bUseSSE2 =
+        CPLTestBool(CPLGetConfigOption("GDAL_USE_SSE2", "YES"));
+    const bool bUseAVX2 = bUseSSE2 && GDALUseAverageAVX2();
+#endif
+
 /* ==================================================================== */
 /*      Loop over destination scanlines.                                */
 /* ==================================================================== */
@@ -408,7 +911,18 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
                 const T* pSrcScanlineShifted =
                     pChunk + panSrcXOffShifted[0] +
                     (nSrcYOff - nChunkYOff) * nChunkXSize;
-                for( int iDstPixel = 0; iDstPixel < nDstXWidth; ++iDstPixel )
+                int iDstPixel = 0;
+#ifdef USE_SSE2
+                if( bUseSSE2 )
+                {
+                    iDstPixel = GDALAverage2x2(
+                        bUseAVX2, pSrcScanlineShifted,
+                        pSrcScanlineShifted + nChunkXSize,
+                        nDstXWidth, pDstScanline);
+                    pSrcScanlineShifted += 2 * iDstPixel;
+                }
+#endif
+                for( ; iDstPixel < nDstXWidth; ++iDstPixel )
                 {
                     const Tsum nTotal =
                         pSrcScanlineShifted[0]
@@ -425,7 +939,34 @@ GDALResampleChunk32R_AverageT( double dfXRatioDstToSrc,
                 nSrcYOff -= nChunkYOff;
                 nSrcYOff2 -= nChunkYOff;
 
-                for( int iDstPixel = 0; iDstPixel < nDstXWidth; ++iDstPixel )
+                int iDstPixel = 0;
+#ifdef USE_SSE2
+                if( bUseSSE2 && bSrcXSpacingIsTwo &&
+                    nSrcYOff2 == nSrcYOff + 2 )
+                {
+                    // Overview by a factor of 2 with nodata, or of a
+                    // Float32 band.
+                    const int nSrcOffset =
+                        panSrcXOffShifted[0] + nSrcYOff * nChunkXSize;
+                    if( pabyChunkNodataMask == NULL )
+                    {
+                        iDstPixel = GDALAverage2x2(
+                            bUseAVX2, pChunk + nSrcOffset,
+                            pChunk + nSrcOffset + nChunkXSize,
+                            nDstXWidth, pDstScanline);
+                    }
+                    else
+                    {
+                        iDstPixel = GDALAverage2x2WithMask(
+                            bUseAVX2, pChunk + nSrcOffset,
+                            pChunk + nSrcOffset + nChunkXSize,
+                            pabyChunkNodataMask + nSrcOffset,
+                            pabyChunkNodataMask + nSrcOffset + nChunkXSize,
+                            nDstXWidth, tNoDataValue, pDstScanline);
+                    }
+                }
+#endif
+                for( ; iDstPixel < nDstXWidth; ++iDstPixel )
                 {
                     const int nSrcXOff = panSrcXOffShifted[2 * iDstPixel];
                     const int nSrcXOff2 = panSrcXOffShifted[2 * iDstPixel + 1];
@@ -1254,15 +1795,7 @@ template<class T> static inline void GDALResampleConvolutionVertical_2cols(
     dfRes2 = dfVal3 + dfVal4;
 }
 
-// TODO(schwehr): Move define of USE_SSE2 and include to the top of the file.
-// Restrict to 64bit processors because they are guaranteed to have SSE2.
-// Could possibly be used too on 32bit, but we would need to check at runtime.
-#if defined(__x86_64) || defined(_M_X64)
-#define USE_SSE2
-#endif
-
 #ifdef USE_SSE2
-#include <gdalsse_priv.h>
 
 /************************************************************************/
 /*              GDALResampleConvolutionHorizontalSSE2<T>                */
@@ -2506,6 +3039,457 @@ GDALDataType GDALGetOvrWorkDataType( const char* pszResampling,
     return GDT_Float32;
 }
 
+/************************************************************************/
+/*                     GDALGetOverviewNumThreads()                      */
+/************************************************************************/
+
+// Number of worker threads used to resample overview chunks, from the
+// GDAL_NUM_THREADS configuration option.
+static int GDALGetOverviewNumThreads()
+{
+    const char* pszNumThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
+    int nThreads = EQUAL(pszNumThreads, "ALL_CPUS") ? CPLGetNumCPUs()
+                                                     : atoi(pszNumThreads);
+    if( nThreads > 128 )
+        nThreads = 128;
+    return std::max(1, nThreads);
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                        GDALOverviewChunk                             */
+/* ==================================================================== */
+/************************************************************************/
+
+// Resampling of the data of a source chunk into a window of an overview band.
+typedef struct
+{
+    int             iSrcBuffer;
+    GDALRasterBand *poDstBand;
+    CPLString       osDstNBITS;
+    double          dfXRatioDstToSrc;
+    double          dfYRatioDstToSrc;
+    int             nDstXOff;
+    int             nDstXOff2;
+    int             nDstYOff;
+    int             nDstYOff2;
+    int             bHasNoData;
+    float           fNoDataValue;
+    void           *pDstBuffer;  // Only used when resampled by a worker.
+} GDALOverviewResampleTask;
+
+// Source data read from one or several bands, with the optional nodata mask
+// and the resampling tasks that consume it.
+class GDALOverviewChunk
+{
+    CPL_DISALLOW_COPY_ASSIGN(GDALOverviewChunk)
+
+  public:
+    std::vector<void*>  apSrcBuffers;
+    GByte              *pabyChunkNodataMask;
+    int                 nSrcWidth;
+    int                 nSrcHeight;
+    int                 nChunkXOff;
+    int                 nChunkXSize;
+    int                 nChunkYOff;
+    int                 nChunkYSize;
+    std::vector<GDALOverviewResampleTask> aoTasks;
+
+    class GDALOverviewPipeline *poPipeline;
+    CPLErr              eErr;
+    bool                bFinished;
+
+    GDALOverviewChunk() : pabyChunkNodataMask(NULL),
+                          nSrcWidth(0), nSrcHeight(0),
+                          nChunkXOff(0), nChunkXSize(0),
+                          nChunkYOff(0), nChunkYSize(0),
+                          poPipeline(NULL), eErr(CE_None), bFinished(false) {}
+    ~GDALOverviewChunk();
+
+    bool                Allocate( int nBuffers, GDALDataType eWrkDataType,
+                                  int nXSize, int nYSize, bool bWithMask );
+    void                AddTask( int iSrcBuffer, GDALRasterBand* poDstBand,
+                                 double dfXRatioDstToSrc,
+                                 double dfYRatioDstToSrc,
+                                 int nDstXOff, int nDstXOff2,
+                                 int nDstYOff, int nDstYOff2,
+                                 int bHasNoData, float fNoDataValue );
+};
+
+GDALOverviewChunk::~GDALOverviewChunk()
+{
+    for( size_t i = 0; i < apSrcBuffers.size(); ++i )
+        VSIFree(apSrcBuffers[i]);
+    VSIFree(pabyChunkNodataMask);
+    for( size_t i = 0; i < aoTasks.size(); ++i )
+        VSIFree(aoTasks[i].pDstBuffer);
+}
+
+bool GDALOverviewChunk::Allocate( int nBuffers, GDALDataType eWrkDataType,
+                                  int nXSize, int nYSize, bool bWithMask )
+{
+    for( int i = 0; i < nBuffers; ++i )
+    {
+        void* pBuffer = VSI_MALLOC3_VERBOSE(
+            GDALGetDataTypeSizeBytes(eWrkDataType), nXSize, nYSize );
+        if( pBuffer == NULL )
+            return false;
+        apSrcBuffers.push_back(pBuffer);
+    }
+    if( bWithMask )
+    {
+        pabyChunkNodataMask =
+            static_cast<GByte*>( VSI_MALLOC2_VERBOSE( nXSize, nYSize ) );
+        if( pabyChunkNodataMask == NULL )
+            return false;
+    }
+    return true;
+}
+
+void GDALOverviewChunk::AddTask( int iSrcBuffer, GDALRasterBand* poDstBand,
+                                 double dfXRatioDstToSrc,
+                                 double dfYRatioDstToSrc,
+                                 int nDstXOff, int nDstXOff2,
+                                 int nDstYOff, int nDstYOff2,
+                                 int bHasNoData, float fNoDataValue )
+{
+    if( nDstXOff2 <= nDstXOff || nDstYOff2 <= nDstYOff )
+        return;
+
+    GDALOverviewResampleTask oTask;
+    oTask.iSrcBuffer = iSrcBuffer;
+    oTask.poDstBand = poDstBand;
+    oTask.dfXRatioDstToSrc = dfXRatioDstToSrc;
+    oTask.dfYRatioDstToSrc = dfYRatioDstToSrc;
+    oTask.nDstXOff = nDstXOff;
+    oTask.nDstXOff2 = nDstXOff2;
+    oTask.nDstYOff = nDstYOff;
+    oTask.nDstYOff2 = nDstYOff2;
+    oTask.bHasNoData = bHasNoData;
+    oTask.fNoDataValue = fNoDataValue;
+    oTask.pDstBuffer = NULL;
+    aoTasks.push_back(oTask);
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                        GDALOverviewPipeline                          */
+/* ==================================================================== */
+/************************************************************************/
+
+// Pipeline of chunks read by the calling thread, resampled by a pool of
+// worker threads into temporary buffers, and written back in order by the
+// calling thread, so that the source and overview bands are only accessed
+// from a single thread. The number of chunks in flight is bounded to limit
+// the memory used.
+//
+// Without worker threads, each chunk is resampled and written directly
+// into the overview bands when submitted.
+class GDALOverviewPipeline
+{
+    CPL_DISALLOW_COPY_ASSIGN(GDALOverviewPipeline)
+
+    GDALResampleFunction pfnResampleFn;  // NULL for complex data.
+    GDALDataType         eWrkDataType;
+    const char          *pszResampling;
+    GDALColorTable      *poColorTable;
+    GDALDataType         eSrcDataType;
+
+    CPLWorkerThreadPool *poPool;
+    CPLMutex            *hMutex;
+    CPLCond             *hCond;
+    std::deque<GDALOverviewChunk*> apoPending;
+    size_t               nMaxPending;
+
+    static void          ProcessChunkFunc( void* pData );
+    CPLErr               ResampleTask( GDALOverviewChunk* poChunk,
+                                       GDALOverviewResampleTask& oTask,
+                                       GDALRasterBand* poDstBand );
+    CPLErr               ResampleTaskIntoBuffer(
+                                       GDALOverviewChunk* poChunk,
+                                       GDALOverviewResampleTask& oTask );
+    CPLErr               WriteOldest();
+
+  public:
+    GDALOverviewPipeline( GDALResampleFunction pfnResampleFnIn,
+                          GDALDataType eWrkDataTypeIn,
+                          const char* pszResamplingIn,
+                          GDALColorTable* poColorTableIn,
+                          GDALDataType eSrcDataTypeIn );
+    ~GDALOverviewPipeline();
+
+    CPLErr               Submit( GDALOverviewChunk* poChunk );
+    CPLErr               Finish();
+};
+
+/************************************************************************/
+/*                        GDALOverviewPipeline()                        */
+/************************************************************************/
+
+GDALOverviewPipeline::GDALOverviewPipeline(
+    GDALResampleFunction pfnResampleFnIn,
+    GDALDataType eWrkDataTypeIn,
+    const char* pszResamplingIn,
+    GDALColorTable* poColorTableIn,
+    GDALDataType eSrcDataTypeIn ) :
+    pfnResampleFn(pfnResampleFnIn),
+    eWrkDataType(eWrkDataTypeIn),
+    pszResampling(pszResamplingIn),
+    poColorTable(poColorTableIn),
+    eSrcDataType(eSrcDataTypeIn),
+    poPool(NULL),
+    hMutex(NULL),
+    hCond(NULL),
+    nMaxPending(0)
+{
+    const int nThreads = GDALGetOverviewNumThreads();
+    if( nThreads > 1 )
+    {
+        poPool = new CPLWorkerThreadPool();
+        if( !poPool->Setup(nThreads, NULL, NULL) )
+        {
+            delete poPool;
+            poPool = NULL;
+        }
+        else
+        {
+            hMutex = CPLCreateMutex();
+            CPLReleaseMutex(hMutex);
+            hCond = CPLCreateCond();
+            // Allow the calling thread to read and write chunks while
+            // all the workers are busy.
+            nMaxPending = 2 * static_cast<size_t>(nThreads);
+        }
+    }
+}
+
+/************************************************************************/
+/*                       ~GDALOverviewPipeline()                        */
+/************************************************************************/
+
+GDALOverviewPipeline::~GDALOverviewPipeline()
+{
+    if( poPool != NULL )
+    {
+        poPool->WaitCompletion();
+        delete poPool;
+    }
+    for( size_t i = 0; i < apoPending.size(); ++i )
+        delete apoPending[i];
+    if( hCond != NULL )
+        CPLDestroyCond(hCond);
+    if( hMutex != NULL )
+        CPLDestroyMutex(hMutex);
+}
+
+/************************************************************************/
+/*                           ResampleTask()                             */
+/************************************************************************/
+
+CPLErr GDALOverviewPipeline::ResampleTask( GDALOverviewChunk* poChunk,
+                                           GDALOverviewResampleTask& oTask,
+                                           GDALRasterBand* poDstBand )
+{
+    void* pChunk = poChunk->apSrcBuffers[oTask.iSrcBuffer];
+    if( pfnResampleFn == NULL )
+    {
+        return GDALResampleChunkC32R(
+            poChunk->nSrcWidth, poChunk->nSrcHeight,
+            static_cast<float*>(pChunk),
+            poChunk->nChunkYOff, poChunk->nChunkYSize,
+            oTask.nDstYOff, oTask.nDstYOff2,
+            poDstBand, pszResampling );
+    }
+    return pfnResampleFn(
+        oTask.dfXRatioDstToSrc, oTask.dfYRatioDstToSrc,
+        0.0, 0.0,
+        eWrkDataType,
+        pChunk,
+        poChunk->pabyChunkNodataMask,
+        poChunk->nChunkXOff, poChunk->nChunkXSize,
+        poChunk->nChunkYOff, poChunk->nChunkYSize,
+        oTask.nDstXOff, oTask.nDstXOff2,
+        oTask.nDstYOff, oTask.nDstYOff2,
+        poDstBand, pszResampling,
+        oTask.bHasNoData, oTask.fNoDataValue, poColorTable,
+        eSrcDataType );
+}
+
+/************************************************************************/
+/*                       ResampleTaskIntoBuffer()                       */
+/************************************************************************/
+
+// Resample into oTask.pDstBuffer, through a MEM band that has the
+// dimensions of the overview band and wraps the buffer at the location
+// of the destination window.
+CPLErr GDALOverviewPipeline::ResampleTaskIntoBuffer(
+    GDALOverviewChunk* poChunk, GDALOverviewResampleTask& oTask )
+{
+    const GDALDataType eDstDataType = oTask.poDstBand->GetRasterDataType();
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDstDataType);
+    const int nXSize = oTask.nDstXOff2 - oTask.nDstXOff;
+    const int nYSize = oTask.nDstYOff2 - oTask.nDstYOff;
+    oTask.pDstBuffer = VSI_MALLOC3_VERBOSE(nDTSize, nXSize, nYSize);
+    if( oTask.pDstBuffer == NULL )
+        return CE_Failure;
+
+    GDALDataset* poMEMDS =
+        MEMDataset::Create( "", oTask.poDstBand->GetXSize(),
+                            oTask.poDstBand->GetYSize(), 0,
+                            eDstDataType, NULL );
+    if( poMEMDS == NULL )
+        return CE_Failure;
+
+    const GSpacing nLineSpace = static_cast<GSpacing>(nDTSize) * nXSize;
+    char szBuffer[64] = { '\0' };
+    int nRet =
+        CPLPrintPointer(
+            szBuffer, static_cast<GByte*>(oTask.pDstBuffer)
+            - static_cast<GSpacing>(nDTSize) * oTask.nDstXOff
+            - nLineSpace * oTask.nDstYOff, sizeof(szBuffer));
+    szBuffer[nRet] = '\0';
+
+    char szBuffer0[96] = { '\0' };
+    snprintf(szBuffer0, sizeof(szBuffer0), "DATAPOINTER=%s", szBuffer);
+    char szBuffer1[64] = { '\0' };
+    snprintf( szBuffer1, sizeof(szBuffer1),
+              "PIXELOFFSET=%d", nDTSize );
+    char szBuffer2[64] = { '\0' };
+    snprintf( szBuffer2, sizeof(szBuffer2),
+              "LINEOFFSET=" CPL_FRMT_GIB, static_cast<GIntBig>(nLineSpace) );
+    char* apszOptions[4] = { szBuffer0, szBuffer1, szBuffer2, NULL };
+
+    poMEMDS->AddBand(eDstDataType, apszOptions);
+    GDALRasterBand* poMEMBand = poMEMDS->GetRasterBand(1);
+    if( !oTask.osDstNBITS.empty() )
+        poMEMBand->SetMetadataItem("NBITS", oTask.osDstNBITS,
+                                   "IMAGE_STRUCTURE");
+
+    const CPLErr eErr = ResampleTask(poChunk, oTask, poMEMBand);
+
+    delete poMEMDS;
+    return eErr;
+}
+
+/************************************************************************/
+/*                         ProcessChunkFunc()                           */
+/************************************************************************/
+
+void GDALOverviewPipeline::ProcessChunkFunc( void* pData )
+{
+    GDALOverviewChunk* poChunk = static_cast<GDALOverviewChunk*>(pData);
+    GDALOverviewPipeline* poThis = poChunk->poPipeline;
+
+    CPLErr eErr = CE_None;
+    for( size_t i = 0; eErr == CE_None && i < poChunk->aoTasks.size(); ++i )
+        eErr = poThis->ResampleTaskIntoBuffer(poChunk, poChunk->aoTasks[i]);
+
+    CPLMutexHolderD(&(poThis->hMutex));
+    poChunk->eErr = eErr;
+    poChunk->bFinished = true;
+    CPLCondBroadcast(poThis->hCond);
+}
+
+/************************************************************************/
+/*                            WriteOldest()                             */
+/************************************************************************/
+
+// Wait for the oldest pending chunk to be resampled, and write it.
+CPLErr GDALOverviewPipeline::WriteOldest()
+{
+    GDALOverviewChunk* poChunk = apoPending.front();
+    apoPending.pop_front();
+
+    CPLAcquireMutex(hMutex, 1000.0);
+    while( !poChunk->bFinished )
+        CPLCondWait(hCond, hMutex);
+    CPLReleaseMutex(hMutex);
+
+    CPLErr eErr = poChunk->eErr;
+    for( size_t i = 0; eErr == CE_None && i < poChunk->aoTasks.size(); ++i )
+    {
+        GDALOverviewResampleTask& oTask = poChunk->aoTasks[i];
+        const int nXSize = oTask.nDstXOff2 - oTask.nDstXOff;
+        const int nYSize = oTask.nDstYOff2 - oTask.nDstYOff;
+        eErr = oTask.poDstBand->RasterIO(
+            GF_Write, oTask.nDstXOff, oTask.nDstYOff, nXSize, nYSize,
+            oTask.pDstBuffer, nXSize, nYSize,
+            oTask.poDstBand->GetRasterDataType(), 0, 0, NULL );
+    }
+    delete poChunk;
+    return eErr;
+}
+
+/************************************************************************/
+/*                               Submit()                               */
+/************************************************************************/
+
+// Takes ownership of poChunk.
+CPLErr GDALOverviewPipeline::Submit( GDALOverviewChunk* poChunk )
+{
+    if( poPool == NULL )
+    {
+        CPLErr eErr = CE_None;
+        for( size_t i = 0; eErr == CE_None && i < poChunk->aoTasks.size();
+             ++i )
+        {
+            eErr = ResampleTask(poChunk, poChunk->aoTasks[i],
+                                poChunk->aoTasks[i].poDstBand);
+        }
+        delete poChunk;
+        return eErr;
+    }
+
+    CPLErr eErr = CE_None;
+    while( eErr == CE_None && apoPending.size() >= nMaxPending )
+        eErr = WriteOldest();
+    if( eErr != CE_None )
+    {
+        delete poChunk;
+        return eErr;
+    }
+
+    for( size_t i = 0; i < poChunk->aoTasks.size(); ++i )
+    {
+        GDALOverviewResampleTask& oTask = poChunk->aoTasks[i];
+        const char* pszNBITS =
+            oTask.poDstBand->GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
+        if( pszNBITS )
+            oTask.osDstNBITS = pszNBITS;
+    }
+
+    poChunk->poPipeline = this;
+    apoPending.push_back(poChunk);
+    poPool->SubmitJob(ProcessChunkFunc, poChunk);
+    return CE_None;
+}
+
+/************************************************************************/
+/*                               Finish()                               */
+/************************************************************************/
+
+// Write all the pending chunks.
+CPLErr GDALOverviewPipeline::Finish()
+{
+    CPLErr eErr = CE_None;
+    while( !apoPending.empty() )
+    {
+        if( eErr == CE_None )
+        {
+            eErr = WriteOldest();
+        }
+        else
+        {
+            // Drop the remaining chunks once they have been processed.
+            poPool->WaitCompletion();
+            for( size_t i = 0; i < apoPending.size(); ++i )
+                delete apoPending[i];
+            apoPending.clear();
+        }
+    }
+    return eErr;
+}
+
 /************************************************************************/
 /*                      GDALRegenerateOverviews()                       */
 /************************************************************************/
@@ -2687,30 +3671,16 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
             nMaxOvrFactor,
             static_cast<int>(static_cast<double>(nHeight) / nDstHeight + 0.5) );
     }
-    const int nMaxChunkYSizeQueried =
-        nFullResYChunk + 2 * nKernelRadius * nMaxOvrFactor;
-
-    GByte *pabyChunkNodataMask = NULL;
-    void *pChunk =
-        VSI_MALLOC3_VERBOSE(
-            GDALGetDataTypeSizeBytes(eType), nMaxChunkYSizeQueried, nWidth );
-    if( bUseNoDataMask )
-    {
-        pabyChunkNodataMask =
-            (GByte*) VSI_MALLOC2_VERBOSE( nMaxChunkYSizeQueried, nWidth );
-    }
-
-    if( pChunk == NULL || (bUseNoDataMask && pabyChunkNodataMask == NULL))
-    {
-        CPLFree(pChunk);
-        CPLFree(pabyChunkNodataMask);
-        return CE_Failure;
-    }
-
     int bHasNoData = FALSE;
     const float fNoDataValue =
         static_cast<float>( poSrcBand->GetNoDataValue(&bHasNoData) );
 
+    // Chunks are resampled by worker threads if GDAL_NUM_THREADS is set.
+    GDALOverviewPipeline oPipeline(
+        eType == GDT_CFloat32 ? NULL : pfnResampleFn,
+        eType, pszResampling, poColorTable,
+        poSrcBand->GetRasterDataType() );
+
 /* -------------------------------------------------------------------- */
 /*      Loop over image operating on chunks.                            */
 /* -------------------------------------------------------------------- */
@@ -2742,9 +3712,28 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
         if( nChunkYOffQueried + nChunkYSizeQueried > nHeight )
             nChunkYSizeQueried = nHeight - nChunkYOffQueried;
 
+        if( eErr != CE_None )
+            break;
+
+        GDALOverviewChunk* poChunk = new GDALOverviewChunk();
+        if( !poChunk->Allocate(1, eType, nWidth, nChunkYSizeQueried,
+                               bUseNoDataMask) )
+        {
+            delete poChunk;
+            eErr = CE_Failure;
+            break;
+        }
+        void* pChunk = poChunk->apSrcBuffers[0];
+        GByte* pabyChunkNodataMask = poChunk->pabyChunkNodataMask;
+        poChunk->nSrcWidth = nWidth;
+        poChunk->nSrcHeight = nHeight;
+        poChunk->nChunkXOff = 0;
+        poChunk->nChunkXSize = nWidth;
+        poChunk->nChunkYOff = nChunkYOffQueried;
+        poChunk->nChunkYSize = nChunkYSizeQueried;
+
         // Read chunk.
-        if( eErr == CE_None )
-            eErr = poSrcBand->RasterIO(
+        eErr = poSrcBand->RasterIO(
                 GF_Read, 0, nChunkYOffQueried, nWidth, nChunkYSizeQueried,
                 pChunk, nWidth, nChunkYSizeQueried, eType,
                 0, 0, NULL );
@@ -2828,9 +3817,7 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
             }
         }
 
-        for( int iOverview = 0;
-             iOverview < nOverviewCount && eErr == CE_None;
-             ++iOverview )
+        for( int iOverview = 0; iOverview < nOverviewCount; ++iOverview )
         {
             const int nDstWidth = papoOvrBands[iOverview]->GetXSize();
             const int nDstHeight = papoOvrBands[iOverview]->GetYSize();
@@ -2857,34 +3844,23 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
                       "nDstYOff=%d, nDstYOff2=%d", nDstYOff, nDstYOff2 );
 #endif
 
-            if( eType == GDT_Byte ||
-                eType == GDT_UInt16 ||
-                eType == GDT_Float32 )
-                eErr = pfnResampleFn(
-                    dfXRatioDstToSrc, dfYRatioDstToSrc,
-                    0.0, 0.0,
-                    eType,
-                    pChunk,
-                    pabyChunkNodataMask,
-                    0, nWidth,
-                    nChunkYOffQueried, nChunkYSizeQueried,
-                    0, nDstWidth,
-                    nDstYOff, nDstYOff2,
-                    papoOvrBands[iOverview], pszResampling,
-                    bHasNoData, fNoDataValue, poColorTable,
-                    poSrcBand->GetRasterDataType());
-            else
-                eErr = GDALResampleChunkC32R(
-                    nWidth, nHeight,
-                    static_cast<float*>(pChunk),
-                    nChunkYOffQueried, nChunkYSizeQueried,
-                    nDstYOff, nDstYOff2,
-                    papoOvrBands[iOverview], pszResampling);
+            poChunk->AddTask( 0, papoOvrBands[iOverview],
+                              dfXRatioDstToSrc, dfYRatioDstToSrc,
+                              0, nDstWidth, nDstYOff, nDstYOff2,
+                              bHasNoData, fNoDataValue );
         }
+
+        if( eErr == CE_None )
+            eErr = oPipeline.Submit(poChunk);
+        else
+            delete poChunk;
     }
 
-    VSIFree( pChunk );
-    VSIFree( pabyChunkNodataMask );
+    {
+        const CPLErr eErrFinish = oPipeline.Finish();
+        if( eErr == CE_None )
+            eErr = eErrFinish;
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Renormalized overview mean / stddev if needed.                  */
@@ -3098,6 +4074,10 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
             papoSrcBands[iBand]->GetNoDataValue(&pabHasNoData[iBand]) );
     }
 
+    // Chunks are resampled by worker threads if GDAL_NUM_THREADS is set.
+    GDALOverviewPipeline oPipeline( pfnResampleFn, eWrkDataType,
+                                    pszResampling, NULL, eDataType );
+
     // Second pass to do the real job.
     double dfCurPixelCount = 0;
     CPLErr eErr = CE_None;
@@ -3130,63 +4110,21 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
         const double dfYRatioDstToSrc =
             static_cast<double>(nSrcHeight) / nDstHeight;
 
+        int nOvrFactor = std::max( static_cast<int>(0.5 + dfXRatioDstToSrc),
+                                   static_cast<int>(0.5 + dfYRatioDstToSrc) );
+        if( nOvrFactor == 0 ) nOvrFactor = 1;
+#ifdef DEBUG
         // Compute the maximum chunk size of the source such as it will match
         // the size of a block of the overview.
         const int nFullResXChunk =
             1 + static_cast<int>(nDstBlockXSize * dfXRatioDstToSrc);
         const int nFullResYChunk =
             1 + static_cast<int>(nDstBlockYSize * dfYRatioDstToSrc);
-
-        int nOvrFactor = std::max( static_cast<int>(0.5 + dfXRatioDstToSrc),
-                                   static_cast<int>(0.5 + dfYRatioDstToSrc) );
-        if( nOvrFactor == 0 ) nOvrFactor = 1;
         const int nFullResXChunkQueried =
             nFullResXChunk + 2 * nKernelRadius * nOvrFactor;
         const int nFullResYChunkQueried =
             nFullResYChunk + 2 * nKernelRadius * nOvrFactor;
-
-        void** papaChunk = static_cast<void **>(
-            VSI_MALLOC_VERBOSE(nBands * sizeof(void*)) );
-        if( papaChunk == NULL )
-        {
-            CPLFree(pabHasNoData);
-            CPLFree(pafNoDataValue);
-            return CE_Failure;
-        }
-        GByte* pabyChunkNoDataMask = NULL;
-        for( int iBand = 0; iBand < nBands; ++iBand )
-        {
-            papaChunk[iBand] = VSI_MALLOC3_VERBOSE(
-                nFullResXChunkQueried,
-                nFullResYChunkQueried,
-                GDALGetDataTypeSizeBytes(eWrkDataType) );
-            if( papaChunk[iBand] == NULL )
-            {
-                while ( --iBand >= 0)
-                    CPLFree(papaChunk[iBand]);
-                CPLFree(papaChunk);
-                CPLFree(pabHasNoData);
-                CPLFree(pafNoDataValue);
-                return CE_Failure;
-            }
-        }
-        if( bUseNoDataMask )
-        {
-            pabyChunkNoDataMask = static_cast<GByte *>(
-                VSI_MALLOC2_VERBOSE( nFullResXChunkQueried,
-                                     nFullResYChunkQueried ) );
-            if( pabyChunkNoDataMask == NULL )
-            {
-                for( int iBand = 0; iBand < nBands; ++iBand )
-                {
-                    CPLFree(papaChunk[iBand]);
-                }
-                CPLFree(papaChunk);
-                CPLFree(pabHasNoData);
-                CPLFree(pafNoDataValue);
-                return CE_Failure;
-            }
-        }
+#endif
 
         int nDstYOff = 0;
         // Iterate on destination overview, block by block.
@@ -3270,6 +4208,22 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                     nDstXOff, nDstYOff, nDstXCount, nDstYCount );
 #endif
 
+                GDALOverviewChunk* poChunk = new GDALOverviewChunk();
+                if( !poChunk->Allocate(nBands, eWrkDataType,
+                                       nChunkXSizeQueried, nChunkYSizeQueried,
+                                       bUseNoDataMask) )
+                {
+                    delete poChunk;
+                    eErr = CE_Failure;
+                    break;
+                }
+                poChunk->nSrcWidth = nSrcWidth;
+                poChunk->nSrcHeight = nSrcHeight;
+                poChunk->nChunkXOff = nChunkXOffQueried;
+                poChunk->nChunkXSize = nChunkXSizeQueried;
+                poChunk->nChunkYOff = nChunkYOffQueried;
+                poChunk->nChunkYSize = nChunkYSizeQueried;
+
                 // Read the source buffers for all the bands.
                 for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
                 {
@@ -3282,7 +4236,7 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                         GF_Read,
                         nChunkXOffQueried, nChunkYOffQueried,
                         nChunkXSizeQueried, nChunkYSizeQueried,
-                        papaChunk[iBand],
+                        poChunk->apSrcBuffers[iBand],
                         nChunkXSizeQueried, nChunkYSizeQueried,
                         eWrkDataType, 0, 0, NULL );
                 }
@@ -3298,44 +4252,45 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                         GF_Read,
                         nChunkXOffQueried, nChunkYOffQueried,
                         nChunkXSizeQueried, nChunkYSizeQueried,
-                        pabyChunkNoDataMask,
+                        poChunk->pabyChunkNodataMask,
                         nChunkXSizeQueried, nChunkYSizeQueried,
                         GDT_Byte, 0, 0, NULL );
                 }
 
                 // Compute the resulting overview block.
-                for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
+                for( int iBand = 0; iBand < nBands; ++iBand )
                 {
-                    eErr = pfnResampleFn(
-                        dfXRatioDstToSrc, dfYRatioDstToSrc,
-                        0.0, 0.0,
-                        eWrkDataType,
-                        papaChunk[iBand],
-                        pabyChunkNoDataMask,
-                        nChunkXOffQueried, nChunkXSizeQueried,
-                        nChunkYOffQueried, nChunkYSizeQueried,
-                        nDstXOff, nDstXOff + nDstXCount,
-                        nDstYOff, nDstYOff + nDstYCount,
-                        papapoOverviewBands[iBand][iOverview],
-                        pszResampling,
-                        pabHasNoData[iBand],
-                        pafNoDataValue[iBand],
-                        /*poColorTable*/ NULL,
-                        eDataType);
+                    poChunk->AddTask( iBand,
+                                      papapoOverviewBands[iBand][iOverview],
+                                      dfXRatioDstToSrc, dfYRatioDstToSrc,
+                                      nDstXOff, nDstXOff + nDstXCount,
+                                      nDstYOff, nDstYOff + nDstYCount,
+                                      pabHasNoData[iBand],
+                                      pafNoDataValue[iBand] );
                 }
+
+                if( eErr == CE_None )
+                    eErr = oPipeline.Submit(poChunk);
+                else
+                    delete poChunk;
             }
 
             dfCurPixelCount += static_cast<double>(nYCount) * nSrcWidth;
         }
 
+        // The next level may be computed from this one, so all its chunks
+        // must have been written.
+        {
+            const CPLErr eErrFinish = oPipeline.Finish();
+            if( eErr == CE_None )
+                eErr = eErrFinish;
+        }
+
         // Flush the data to overviews.
         for( int iBand = 0; iBand < nBands; ++iBand )
         {
-            CPLFree(papaChunk[iBand]);
             papapoOverviewBands[iBand][iOverview]->FlushCache();
         }
-        CPLFree(papaChunk);
-        CPLFree(pabyChunkNoDataMask);
     }
 
     CPLFree(pabHasNoData);
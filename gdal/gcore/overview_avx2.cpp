@@ -0,0 +1,414 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Core
+ * Purpose:  AVX2 specializations of overview computation
+ * Author:   Even Rouault <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+
+CPL_CVSID("$Id$");
+
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && ( defined(__x86_64) || defined(_M_X64) )
+
+#include <immintrin.h>
+
+// The kernels below compute the 2x2 average decimation of two source lines
+// into one destination line, as done by GDALResampleChunk32R_AverageT() with
+// a ratio of 2 in both directions. They return the number of destination
+// pixels processed, the remaining ones being left to the caller.
+// They give exactly the same results as the generic code.
+
+int GDALAverage2x2_Byte_AVX2( const GByte* pSrc0, const GByte* pSrc1,
+                              int nDstXWidth, GByte* pDst );
+int GDALAverage2x2_UInt16_AVX2( const GUInt16* pSrc0, const GUInt16* pSrc1,
+                                int nDstXWidth, GUInt16* pDst );
+int GDALAverage2x2_Float_AVX2( const float* pSrc0, const float* pSrc1,
+                               int nDstXWidth, float* pDst );
+int GDALAverage2x2WithMask_Byte_AVX2( const GByte* pSrc0, const GByte* pSrc1,
+                                      const GByte* pabyMask0,
+                                      const GByte* pabyMask1,
+                                      int nDstXWidth, GByte nNoDataValue,
+                                      GByte* pDst );
+int GDALAverage2x2WithMask_UInt16_AVX2( const GUInt16* pSrc0,
+                                        const GUInt16* pSrc1,
+                                        const GByte* pabyMask0,
+                                        const GByte* pabyMask1,
+                                        int nDstXWidth,
+                                        GUInt16 nNoDataValue,
+                                        GUInt16* pDst );
+int GDALAverage2x2WithMask_Float_AVX2( const float* pSrc0, const float* pSrc1,
+                                       const GByte* pabyMask0,
+                                       const GByte* pabyMask1,
+                                       int nDstXWidth, float fNoDataValue,
+                                       float* pDst );
+
+/************************************************************************/
+/*                      GDALAverage2x2_Byte_AVX2()                      */
+/************************************************************************/
+
+int GDALAverage2x2_Byte_AVX2( const GByte* pSrc0, const GByte* pSrc1,
+                              int nDstXWidth, GByte* pDst )
+{
+    const __m256i ymmMaskLow = _mm256_set1_epi16(0xFF);
+    const __m256i ymmTwo = _mm256_set1_epi16(2);
+    int i = 0;
+    for( ; i + 31 < nDstXWidth; i += 32 )
+    {
+        __m256i ymmSum[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            const __m256i ymm0 = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(pSrc0 + 2 * i + 32 * k));
+            const __m256i ymm1 = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(pSrc1 + 2 * i + 32 * k));
+            // Sum of the even and odd bytes of each line, in 16 bit words.
+            const __m256i ymmSum0 =
+                _mm256_add_epi16(_mm256_and_si256(ymm0, ymmMaskLow),
+                                 _mm256_srli_epi16(ymm0, 8));
+            const __m256i ymmSum1 =
+                _mm256_add_epi16(_mm256_and_si256(ymm1, ymmMaskLow),
+                                 _mm256_srli_epi16(ymm1, 8));
+            ymmSum[k] = _mm256_srli_epi16(
+                _mm256_add_epi16(_mm256_add_epi16(ymmSum0, ymmSum1), ymmTwo),
+                2);
+        }
+        // Packing operates on each 128 bit lane, so reorder the 64 bit words.
+        const __m256i ymmRes = _mm256_permute4x64_epi64(
+            _mm256_packus_epi16(ymmSum[0], ymmSum[1]), _MM_SHUFFLE(3,1,2,0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), ymmRes);
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                     GDALAverage2x2_UInt16_AVX2()                     */
+/************************************************************************/
+
+int GDALAverage2x2_UInt16_AVX2( const GUInt16* pSrc0, const GUInt16* pSrc1,
+                                int nDstXWidth, GUInt16* pDst )
+{
+    const __m256i ymmMaskLow = _mm256_set1_epi32(0xFFFF);
+    const __m256i ymmTwo = _mm256_set1_epi32(2);
+    int i = 0;
+    for( ; i + 15 < nDstXWidth; i += 16 )
+    {
+        __m256i ymmSum[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            const __m256i ymm0 = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(pSrc0 + 2 * i + 16 * k));
+            const __m256i ymm1 = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(pSrc1 + 2 * i + 16 * k));
+            // Sum of the even and odd words of each line, in 32 bit words.
+            const __m256i ymmSum0 =
+                _mm256_add_epi32(_mm256_and_si256(ymm0, ymmMaskLow),
+                                 _mm256_srli_epi32(ymm0, 16));
+            const __m256i ymmSum1 =
+                _mm256_add_epi32(_mm256_and_si256(ymm1, ymmMaskLow),
+                                 _mm256_srli_epi32(ymm1, 16));
+            ymmSum[k] = _mm256_srli_epi32(
+                _mm256_add_epi32(_mm256_add_epi32(ymmSum0, ymmSum1), ymmTwo),
+                2);
+        }
+        const __m256i ymmRes = _mm256_permute4x64_epi64(
+            _mm256_packus_epi32(ymmSum[0], ymmSum[1]), _MM_SHUFFLE(3,1,2,0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), ymmRes);
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                        GDALDeinterleaveAVX2()                        */
+/************************************************************************/
+
+// Split 16 consecutive floats into their even and odd elements.
+static inline void GDALDeinterleaveAVX2( __m256 ymmA, __m256 ymmB,
+                                         __m256& ymmEven, __m256& ymmOdd )
+{
+    ymmEven = _mm256_castpd_ps(_mm256_permute4x64_pd(
+        _mm256_castps_pd(_mm256_shuffle_ps(ymmA, ymmB, _MM_SHUFFLE(2,0,2,0))),
+        _MM_SHUFFLE(3,1,2,0)));
+    ymmOdd = _mm256_castpd_ps(_mm256_permute4x64_pd(
+        _mm256_castps_pd(_mm256_shuffle_ps(ymmA, ymmB, _MM_SHUFFLE(3,1,3,1))),
+        _MM_SHUFFLE(3,1,2,0)));
+}
+
+/************************************************************************/
+/*                      GDALAverage2x2_Float_AVX2()                     */
+/************************************************************************/
+
+int GDALAverage2x2_Float_AVX2( const float* pSrc0, const float* pSrc1,
+                               int nDstXWidth, float* pDst )
+{
+    const __m256d ymmQuarter = _mm256_set1_pd(0.25);
+    int i = 0;
+    for( ; i + 7 < nDstXWidth; i += 8 )
+    {
+        __m256 ymmEven0, ymmOdd0, ymmEven1, ymmOdd1;
+        GDALDeinterleaveAVX2(_mm256_loadu_ps(pSrc0 + 2 * i),
+                             _mm256_loadu_ps(pSrc0 + 2 * i + 8),
+                             ymmEven0, ymmOdd0);
+        GDALDeinterleaveAVX2(_mm256_loadu_ps(pSrc1 + 2 * i),
+                             _mm256_loadu_ps(pSrc1 + 2 * i + 8),
+                             ymmEven1, ymmOdd1);
+        for( int k = 0; k < 2; k++ )
+        {
+            // Same order of additions, in double precision, as the generic
+            // code.
+            const __m128 xmmE0 = k == 0 ? _mm256_castps256_ps128(ymmEven0) :
+                                          _mm256_extractf128_ps(ymmEven0, 1);
+            const __m128 xmmO0 = k == 0 ? _mm256_castps256_ps128(ymmOdd0) :
+                                          _mm256_extractf128_ps(ymmOdd0, 1);
+            const __m128 xmmE1 = k == 0 ? _mm256_castps256_ps128(ymmEven1) :
+                                          _mm256_extractf128_ps(ymmEven1, 1);
+            const __m128 xmmO1 = k == 0 ? _mm256_castps256_ps128(ymmOdd1) :
+                                          _mm256_extractf128_ps(ymmOdd1, 1);
+            __m256d ymmSum = _mm256_add_pd(_mm256_setzero_pd(),
+                                           _mm256_cvtps_pd(xmmE0));
+            ymmSum = _mm256_add_pd(ymmSum, _mm256_cvtps_pd(xmmO0));
+            ymmSum = _mm256_add_pd(ymmSum, _mm256_cvtps_pd(xmmE1));
+            ymmSum = _mm256_add_pd(ymmSum, _mm256_cvtps_pd(xmmO1));
+            _mm_storeu_ps(pDst + i + 4 * k,
+                          _mm256_cvtpd_ps(_mm256_mul_pd(ymmSum, ymmQuarter)));
+        }
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                     GDALAverageDivRoundAVX2()                        */
+/************************************************************************/
+
+// (nTotal + nCount / 2) / nCount on 32 bit words, or nNoDataValue where
+// nCount is 0. With nCount <= 4 and nTotal < 2^22, the single precision
+// division is exact enough for the truncation to give the integer quotient.
+static inline __m256i GDALAverageDivRoundAVX2( __m256i ymmTotal,
+                                               __m256i ymmCount,
+                                               __m256i ymmNoData )
+{
+    const __m256 ymmNum = _mm256_cvtepi32_ps(
+        _mm256_add_epi32(ymmTotal, _mm256_srli_epi32(ymmCount, 1)));
+    const __m256i ymmRes = _mm256_cvttps_epi32(
+        _mm256_div_ps(ymmNum, _mm256_cvtepi32_ps(ymmCount)));
+    const __m256i ymmZeroCount =
+        _mm256_cmpeq_epi32(ymmCount, _mm256_setzero_si256());
+    return _mm256_blendv_epi8(ymmRes, ymmNoData, ymmZeroCount);
+}
+
+/************************************************************************/
+/*                  GDALAverage2x2WithMask_Byte_AVX2()                  */
+/************************************************************************/
+
+int GDALAverage2x2WithMask_Byte_AVX2( const GByte* pSrc0, const GByte* pSrc1,
+                                      const GByte* pabyMask0,
+                                      const GByte* pabyMask1,
+                                      int nDstXWidth, GByte nNoDataValue,
+                                      GByte* pDst )
+{
+    const __m256i ymmZero = _mm256_setzero_si256();
+    const __m256i ymmMaskLow = _mm256_set1_epi16(0xFF);
+    const __m256i ymmOne = _mm256_set1_epi8(1);
+    const __m256i ymmNoData = _mm256_set1_epi32(nNoDataValue);
+    int i = 0;
+    for( ; i + 15 < nDstXWidth; i += 16 )
+    {
+        __m256i ymmTotal = ymmZero;
+        __m256i ymmCount = ymmZero;
+        for( int iLine = 0; iLine < 2; iLine++ )
+        {
+            const GByte* pSrc = iLine == 0 ? pSrc0 : pSrc1;
+            const GByte* pabyMask = iLine == 0 ? pabyMask0 : pabyMask1;
+            // 0xFF for valid pixels.
+            const __m256i ymmValid = _mm256_xor_si256(
+                _mm256_cmpeq_epi8(
+                    _mm256_loadu_si256(
+                        reinterpret_cast<const __m256i*>(pabyMask + 2 * i)),
+                    ymmZero),
+                _mm256_set1_epi8(-1));
+            const __m256i ymmVal = _mm256_and_si256(
+                _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(pSrc + 2 * i)),
+                ymmValid);
+            const __m256i ymmValidOne = _mm256_and_si256(ymmValid, ymmOne);
+            ymmTotal = _mm256_add_epi16(ymmTotal,
+                _mm256_add_epi16(_mm256_and_si256(ymmVal, ymmMaskLow),
+                                 _mm256_srli_epi16(ymmVal, 8)));
+            ymmCount = _mm256_add_epi16(ymmCount,
+                _mm256_add_epi16(_mm256_and_si256(ymmValidOne, ymmMaskLow),
+                                 _mm256_srli_epi16(ymmValidOne, 8)));
+        }
+        __m256i aymmRes[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            const __m128i xmmTotal = k == 0 ?
+                _mm256_castsi256_si128(ymmTotal) :
+                _mm256_extracti128_si256(ymmTotal, 1);
+            const __m128i xmmCount = k == 0 ?
+                _mm256_castsi256_si128(ymmCount) :
+                _mm256_extracti128_si256(ymmCount, 1);
+            aymmRes[k] = GDALAverageDivRoundAVX2(
+                _mm256_cvtepu16_epi32(xmmTotal),
+                _mm256_cvtepu16_epi32(xmmCount), ymmNoData);
+        }
+        const __m128i xmmRes0 =
+            _mm_packus_epi32(_mm256_castsi256_si128(aymmRes[0]),
+                             _mm256_extracti128_si256(aymmRes[0], 1));
+        const __m128i xmmRes1 =
+            _mm_packus_epi32(_mm256_castsi256_si128(aymmRes[1]),
+                             _mm256_extracti128_si256(aymmRes[1], 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i),
+                         _mm_packus_epi16(xmmRes0, xmmRes1));
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                 GDALAverage2x2WithMask_UInt16_AVX2()                 */
+/************************************************************************/
+
+int GDALAverage2x2WithMask_UInt16_AVX2( const GUInt16* pSrc0,
+                                        const GUInt16* pSrc1,
+                                        const GByte* pabyMask0,
+                                        const GByte* pabyMask1,
+                                        int nDstXWidth,
+                                        GUInt16 nNoDataValue,
+                                        GUInt16* pDst )
+{
+    const __m256i ymmZero = _mm256_setzero_si256();
+    const __m256i ymmMaskLow = _mm256_set1_epi32(0xFFFF);
+    const __m256i ymmOne = _mm256_set1_epi16(1);
+    const __m256i ymmNoData = _mm256_set1_epi32(nNoDataValue);
+    int i = 0;
+    for( ; i + 15 < nDstXWidth; i += 16 )
+    {
+        __m256i aymmRes[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            __m256i ymmTotal = ymmZero;
+            __m256i ymmCount = ymmZero;
+            for( int iLine = 0; iLine < 2; iLine++ )
+            {
+                const GUInt16* pSrc = iLine == 0 ? pSrc0 : pSrc1;
+                const GByte* pabyMask = iLine == 0 ? pabyMask0 : pabyMask1;
+                const __m256i ymmValid = _mm256_xor_si256(
+                    _mm256_cmpeq_epi16(
+                        _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                            reinterpret_cast<const __m128i*>(
+                                pabyMask + 2 * i + 16 * k))),
+                        ymmZero),
+                    _mm256_set1_epi8(-1));
+                const __m256i ymmVal = _mm256_and_si256(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+                        pSrc + 2 * i + 16 * k)),
+                    ymmValid);
+                const __m256i ymmValidOne = _mm256_and_si256(ymmValid, ymmOne);
+                ymmTotal = _mm256_add_epi32(ymmTotal,
+                    _mm256_add_epi32(_mm256_and_si256(ymmVal, ymmMaskLow),
+                                     _mm256_srli_epi32(ymmVal, 16)));
+                ymmCount = _mm256_add_epi32(ymmCount,
+                    _mm256_add_epi32(_mm256_and_si256(ymmValidOne, ymmMaskLow),
+                                     _mm256_srli_epi32(ymmValidOne, 16)));
+            }
+            aymmRes[k] = GDALAverageDivRoundAVX2(ymmTotal, ymmCount, ymmNoData);
+        }
+        const __m256i ymmRes = _mm256_permute4x64_epi64(
+            _mm256_packus_epi32(aymmRes[0], aymmRes[1]), _MM_SHUFFLE(3,1,2,0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), ymmRes);
+    }
+    return i;
+}
+
+/************************************************************************/
+/*                 GDALAverage2x2WithMask_Float_AVX2()                  */
+/************************************************************************/
+
+int GDALAverage2x2WithMask_Float_AVX2( const float* pSrc0, const float* pSrc1,
+                                       const GByte* pabyMask0,
+                                       const GByte* pabyMask1,
+                                       int nDstXWidth, float fNoDataValue,
+                                       float* pDst )
+{
+    const __m256i ymmZero = _mm256_setzero_si256();
+    const __m256 ymmOne = _mm256_set1_ps(1.0f);
+    const __m128 xmmNoData = _mm_set1_ps(fNoDataValue);
+    int i = 0;
+    for( ; i + 7 < nDstXWidth; i += 8 )
+    {
+        __m256 aymmEven[2], aymmOdd[2], aymmEvenCount[2], aymmOddCount[2];
+        for( int iLine = 0; iLine < 2; iLine++ )
+        {
+            const float* pSrc = iLine == 0 ? pSrc0 : pSrc1;
+            const GByte* pabyMask = iLine == 0 ? pabyMask0 : pabyMask1;
+            __m256 aymmValid[2];
+            for( int k = 0; k < 2; k++ )
+            {
+                aymmValid[k] = _mm256_castsi256_ps(_mm256_xor_si256(
+                    _mm256_cmpeq_epi32(
+                        _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+                            reinterpret_cast<const __m128i*>(
+                                pabyMask + 2 * i + 8 * k))),
+                        ymmZero),
+                    _mm256_set1_epi8(-1)));
+            }
+            // Invalid values are replaced by +0.0, which does not modify
+            // the sum.
+            GDALDeinterleaveAVX2(
+                _mm256_and_ps(_mm256_loadu_ps(pSrc + 2 * i), aymmValid[0]),
+                _mm256_and_ps(_mm256_loadu_ps(pSrc + 2 * i + 8), aymmValid[1]),
+                aymmEven[iLine], aymmOdd[iLine]);
+            GDALDeinterleaveAVX2(
+                _mm256_and_ps(ymmOne, aymmValid[0]),
+                _mm256_and_ps(ymmOne, aymmValid[1]),
+                aymmEvenCount[iLine], aymmOddCount[iLine]);
+        }
+        const __m256 ymmCount = _mm256_add_ps(
+            _mm256_add_ps(aymmEvenCount[0], aymmOddCount[0]),
+            _mm256_add_ps(aymmEvenCount[1], aymmOddCount[1]));
+        for( int k = 0; k < 2; k++ )
+        {
+#define GET_HALF(ymm) (k == 0 ? _mm256_castps256_ps128(ymm) : \
+                                _mm256_extractf128_ps(ymm, 1))
+            __m256d ymmSum = _mm256_add_pd(_mm256_setzero_pd(),
+                                _mm256_cvtps_pd(GET_HALF(aymmEven[0])));
+            ymmSum = _mm256_add_pd(ymmSum,
+                                   _mm256_cvtps_pd(GET_HALF(aymmOdd[0])));
+            ymmSum = _mm256_add_pd(ymmSum,
+                                   _mm256_cvtps_pd(GET_HALF(aymmEven[1])));
+            ymmSum = _mm256_add_pd(ymmSum,
+                                   _mm256_cvtps_pd(GET_HALF(aymmOdd[1])));
+            const __m128 xmmCount = GET_HALF(ymmCount);
+#undef GET_HALF
+            const __m128 xmmRes = _mm256_cvtpd_ps(
+                _mm256_div_pd(ymmSum, _mm256_cvtps_pd(xmmCount)));
+            const __m128 xmmZeroCount =
+                _mm_cmpeq_ps(xmmCount, _mm_setzero_ps());
+            _mm_storeu_ps(pDst + i + 4 * k,
+                          _mm_blendv_ps(xmmRes, xmmNoData, xmmZeroCount));
+        }
+    }
+    return i;
+}
+
+#endif // HAVE_AVX2_AT_COMPILE_TIME
@@ -39,6 +39,7 @@
 #include <algorithm>
 #include <limits>
 #include <stdexcept>
+#include <vector>
 
 CPL_CVSID("$Id$");
 
@@ -3857,6 +3858,236 @@ static void GDALCopyWholeRasterGetSwathSize(
     *pnSwathLines = nSwathLines;
 }
 
+/************************************************************************/
+/*                    GDALCopyWholeRasterSwath                          */
+/************************************************************************/
+
+// Window of the source and target datasets transferred at once.
+typedef struct
+{
+    int nBand;  // 0 when all bands are transferred at once (interleaved case)
+    int iX;
+    int iY;
+    int nCols;
+    int nLines;
+} GDALCopyWholeRasterSwath;
+
+/************************************************************************/
+/*                  GDALCopyWholeRasterSwathHasData()                   */
+/************************************************************************/
+
+static bool GDALCopyWholeRasterSwathHasData( GDALDataset* poSrcDS,
+                                             int nBandCount,
+                                             const GDALCopyWholeRasterSwath&
+                                                                    sSwath )
+{
+    const int iFirstBand = sSwath.nBand > 0 ? sSwath.nBand : 1;
+    const int iLastBand = sSwath.nBand > 0 ? sSwath.nBand : nBandCount;
+    for( int iBand = iFirstBand; iBand <= iLastBand; iBand++ )
+    {
+        if( poSrcDS->GetRasterBand(iBand)->GetDataCoverageStatus(
+                sSwath.iX, sSwath.iY, sSwath.nCols, sSwath.nLines,
+                GDAL_DATA_COVERAGE_STATUS_DATA) &
+                                            GDAL_DATA_COVERAGE_STATUS_DATA )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/************************************************************************/
+/*                    GDALCopyWholeRasterSwathIO()                      */
+/************************************************************************/
+
+static CPLErr GDALCopyWholeRasterSwathIO( GDALRWFlag eRWFlag,
+                                          GDALDataset* poDS,
+                                          int nBandCount,
+                                          const GDALCopyWholeRasterSwath&
+                                                                    sSwath,
+                                          void* pSwathBuf,
+                                          GDALDataType eDT,
+                                          GDALRasterIOExtraArg* psExtraArg )
+{
+    int nBand = sSwath.nBand;
+    return poDS->RasterIO( eRWFlag,
+                           sSwath.iX, sSwath.iY, sSwath.nCols, sSwath.nLines,
+                           pSwathBuf, sSwath.nCols, sSwath.nLines,
+                           eDT,
+                           nBand > 0 ? 1 : nBandCount,
+                           nBand > 0 ? &nBand : NULL,
+                           0, 0, 0, psExtraArg );
+}
+
+/************************************************************************/
+/*                  GDALCopyWholeRasterErrorDesc                        */
+/************************************************************************/
+
+class GDALCopyWholeRasterErrorDesc
+{
+    public:
+        GDALCopyWholeRasterErrorDesc( CPLErr eErrIn, CPLErrorNum nErrNoIn,
+                                      const CPLString& osMsgIn ) :
+                eErr(eErrIn), nErrNo(nErrNoIn), osErrorMsg(osMsgIn) {}
+
+        CPLErr      eErr;
+        CPLErrorNum nErrNo;
+        CPLString   osErrorMsg;
+};
+
+/************************************************************************/
+/*                  GDALCopyWholeRasterReadAheadJob                     */
+/************************************************************************/
+
+// State shared between GDALDatasetCopyWholeRaster(), that writes the swaths
+// into the target dataset, and the thread that reads the next swaths from
+// the source dataset into a ring of buffers.
+typedef struct
+{
+    GDALDataset     *poSrcDS;
+    int              nBandCount;
+    GDALDataType     eDT;
+    bool             bCheckHoles;
+    const std::vector<GDALCopyWholeRasterSwath>* paoSwaths;
+    std::vector<void*> apBuffers;
+    std::vector<bool>  abHasData;
+
+    CPLMutex        *hMutex;
+    CPLCond         *hCond;
+    size_t           nSwathsRead;     // protected by hMutex
+    size_t           nSwathsWritten;  // protected by hMutex
+    bool             bStop;           // protected by hMutex
+    bool             bReadFinished;   // protected by hMutex
+    // Errors emitted in the read-ahead thread, protected by hMutex.
+    std::vector<GDALCopyWholeRasterErrorDesc> aoErrors;
+} GDALCopyWholeRasterReadAheadJob;
+
+/************************************************************************/
+/*                  GDALCopyWholeRasterReadAheadErrorHandler()          */
+/************************************************************************/
+
+// Collect the errors of the read-ahead thread, so that they can be emitted
+// again in the calling thread, with the error handler installed by the caller.
+static void CPL_STDCALL GDALCopyWholeRasterReadAheadErrorHandler(
+    CPLErr eErr, CPLErrorNum nErrNo, const char* pszErrorMsg )
+{
+    if( eErr == CE_Debug )
+    {
+        CPLDefaultErrorHandler(eErr, nErrNo, pszErrorMsg);
+        return;
+    }
+    GDALCopyWholeRasterReadAheadJob* psJob =
+        static_cast<GDALCopyWholeRasterReadAheadJob*>(
+            CPLGetErrorHandlerUserData());
+    CPLAcquireMutex(psJob->hMutex, 1000.0);
+    psJob->aoErrors.push_back(
+        GDALCopyWholeRasterErrorDesc(eErr, nErrNo, pszErrorMsg));
+    CPLReleaseMutex(psJob->hMutex);
+}
+
+/************************************************************************/
+/*                 GDALCopyWholeRasterEmitReadAheadErrors()             */
+/************************************************************************/
+
+static void GDALCopyWholeRasterEmitReadAheadErrors(
+    GDALCopyWholeRasterReadAheadJob* psJob )
+{
+    std::vector<GDALCopyWholeRasterErrorDesc> aoErrors;
+    CPLAcquireMutex(psJob->hMutex, 1000.0);
+    aoErrors.swap(psJob->aoErrors);
+    CPLReleaseMutex(psJob->hMutex);
+    for( size_t i = 0; i < aoErrors.size(); i++ )
+    {
+        CPLError( aoErrors[i].eErr, aoErrors[i].nErrNo, "%s",
+                  aoErrors[i].osErrorMsg.c_str() );
+    }
+}
+
+/************************************************************************/
+/*                    GDALCopyWholeRasterReadAheadFunc()                */
+/************************************************************************/
+
+static void GDALCopyWholeRasterReadAheadFunc( void* pData )
+{
+    GDALCopyWholeRasterReadAheadJob* psJob =
+        static_cast<GDALCopyWholeRasterReadAheadJob*>(pData);
+    const size_t nBuffers = psJob->apBuffers.size();
+    const std::vector<GDALCopyWholeRasterSwath>& aoSwaths = *psJob->paoSwaths;
+
+    GDALRasterIOExtraArg sExtraArg;
+    INIT_RASTERIO_EXTRA_ARG(sExtraArg);
+
+    CPLPushErrorHandlerEx(GDALCopyWholeRasterReadAheadErrorHandler, psJob);
+
+    for( size_t iSwath = 0; iSwath < aoSwaths.size(); iSwath++ )
+    {
+        // Wait for the buffer to be released by the writer.
+        CPLAcquireMutex(psJob->hMutex, 1000.0);
+        while( !psJob->bStop && iSwath >= psJob->nSwathsWritten + nBuffers )
+            CPLCondWait(psJob->hCond, psJob->hMutex);
+        const bool bStop = psJob->bStop;
+        CPLReleaseMutex(psJob->hMutex);
+        if( bStop )
+            break;
+
+        const size_t iBuffer = iSwath % nBuffers;
+        const bool bHasData =
+            !psJob->bCheckHoles ||
+            GDALCopyWholeRasterSwathHasData(psJob->poSrcDS, psJob->nBandCount,
+                                            aoSwaths[iSwath]);
+        CPLErr eErr = CE_None;
+        if( bHasData )
+        {
+            eErr = GDALCopyWholeRasterSwathIO(
+                GF_Read, psJob->poSrcDS, psJob->nBandCount, aoSwaths[iSwath],
+                psJob->apBuffers[iBuffer], psJob->eDT, &sExtraArg);
+        }
+
+        CPLAcquireMutex(psJob->hMutex, 1000.0);
+        if( eErr == CE_None )
+        {
+            psJob->abHasData[iBuffer] = bHasData;
+            psJob->nSwathsRead = iSwath + 1;
+        }
+        CPLCondBroadcast(psJob->hCond);
+        CPLReleaseMutex(psJob->hMutex);
+        if( eErr != CE_None )
+            break;
+    }
+
+    CPLPopErrorHandler();
+
+    CPLAcquireMutex(psJob->hMutex, 1000.0);
+    psJob->bReadFinished = true;
+    CPLCondBroadcast(psJob->hCond);
+    CPLReleaseMutex(psJob->hMutex);
+}
+
+/************************************************************************/
+/*                  GDALCopyWholeRasterGetNumThreads()                  */
+/************************************************************************/
+
+static int GDALCopyWholeRasterGetNumThreads( char** papszOptions )
+{
+    const char* pszValue = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
+    if( pszValue == NULL )
+        pszValue = CPLGetConfigOption("GDAL_NUM_THREADS", NULL);
+    if( pszValue == NULL )
+        return 1;
+
+    const int nThreads =
+        EQUAL(pszValue, "ALL_CPUS") ? CPLGetNumCPUs() : atoi(pszValue);
+    if( nThreads < 0 ||
+        (nThreads <= 1 && !EQUAL(pszValue, "0") && !EQUAL(pszValue, "1")
+         && !EQUAL(pszValue, "ALL_CPUS")) )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Invalid value for NUM_THREADS: %s", pszValue);
+        return 1;
+    }
+    return std::max(1, nThreads);
+}
+
 /************************************************************************/
 /*                     GDALDatasetCopyWholeRaster()                     */
 /************************************************************************/
@@ -3881,6 +4112,12 @@ static void GDALCopyWholeRasterGetSwathSize(
  * achieve best compression.</li>
  * <li>"SKIP_HOLES=YES" to skip chunks for which GDALGetDataCoverageStatus()
  * returns GDAL_DATA_COVERAGE_STATUS_EMPTY (GDAL &gt;= 2.2)</li>
+ * <li>"NUM_THREADS=val" where val is an integer or ALL_CPUS. When greater
+ * than 1, the next swaths are read from the source dataset in a background
+ * thread, while the current one is written into the target dataset, with up
+ * to val swaths in flight. If not specified, the GDAL_NUM_THREADS
+ * configuration option is used. Progress is then only reported after each
+ * swath is written (GDAL &gt;= 2.2)</li>
  * </ul>
  * More options may be supported in the future.
  *
@@ -4011,177 +4248,212 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
                              nBandCount, NULL, NULL);
     }
 
-/* ==================================================================== */
-/*      Band oriented (uninterleaved) case.                             */
-/* ==================================================================== */
+/* -------------------------------------------------------------------- */
+/*      Collect the swaths to transfer. In the band oriented            */
+/*      (uninterleaved) case, each band is transferred separately.      */
+/* -------------------------------------------------------------------- */
+    std::vector<GDALCopyWholeRasterSwath> aoSwaths;
+    for( int iBand = 0; iBand < (bInterleave ? 1 : nBandCount); iBand++ )
+    {
+        for( int iY = 0; iY < nYSize; iY += nSwathLines )
+        {
+            for( int iX = 0; iX < nXSize; iX += nSwathCols )
+            {
+                GDALCopyWholeRasterSwath sSwath;
+                sSwath.nBand = bInterleave ? 0 : iBand + 1;
+                sSwath.iX = iX;
+                sSwath.iY = iY;
+                sSwath.nCols = std::min(nSwathCols, nXSize - iX);
+                sSwath.nLines = std::min(nSwathLines, nYSize - iY);
+                aoSwaths.push_back(sSwath);
+            }
+        }
+    }
+    const double dfTotalBlocks = static_cast<double>(aoSwaths.size());
+
     CPLErr eErr = CE_None;
     const bool bCheckHoles = CPLTestBool( CSLFetchNameValueDef(
                                         papszOptions, "SKIP_HOLES", "NO" ) );
 
-    if( !bInterleave )
+/* -------------------------------------------------------------------- */
+/*      Do we want to read the next swaths in a background thread?      */
+/* -------------------------------------------------------------------- */
+    GDALCopyWholeRasterReadAheadJob sJob;
+    sJob.poSrcDS = poSrcDS;
+    sJob.nBandCount = nBandCount;
+    sJob.eDT = eDT;
+    sJob.bCheckHoles = bCheckHoles;
+    sJob.paoSwaths = &aoSwaths;
+    sJob.hMutex = NULL;
+    sJob.hCond = NULL;
+    sJob.nSwathsRead = 0;
+    sJob.nSwathsWritten = 0;
+    sJob.bStop = false;
+    sJob.bReadFinished = false;
+
+    const int nThreads = GDALCopyWholeRasterGetNumThreads(papszOptions);
+    if( nThreads > 1 && aoSwaths.size() > 1 )
     {
-        GDALRasterIOExtraArg sExtraArg;
-        INIT_RASTERIO_EXTRA_ARG(sExtraArg);
-
-        const int nTotalBlocks =
-            nBandCount *
-            ((nYSize + nSwathLines - 1) / nSwathLines) *
-            ((nXSize + nSwathCols - 1) / nSwathCols);
-        int nBlocksDone = 0;
+        // Do not use more than the block cache size for the swath buffers,
+        // unless that would prevent reading ahead at all.
+        const GIntBig nSwathBufSize =
+            static_cast<GIntBig>(nSwathCols) * nSwathLines * nPixelSize;
+        const size_t nMaxBuffers = static_cast<size_t>(std::max(
+            static_cast<GIntBig>(2), GDALGetCacheMax64() / nSwathBufSize));
+        const size_t nBuffers = std::min(
+            std::min(static_cast<size_t>(nThreads), nMaxBuffers),
+            aoSwaths.size());
+
+        sJob.apBuffers.push_back(pSwathBuf);
+        while( sJob.apBuffers.size() < nBuffers )
+        {
+            void* pBuffer = VSIMalloc3(nSwathCols, nSwathLines, nPixelSize);
+            if( pBuffer == NULL )
+                break;
+            sJob.apBuffers.push_back(pBuffer);
+        }
+        sJob.abHasData.resize(sJob.apBuffers.size());
+    }
 
-        for( int iBand = 0; iBand < nBandCount && eErr == CE_None; iBand++ )
+    CPLJoinableThread* hThread = NULL;
+    if( sJob.apBuffers.size() > 1 )
+    {
+        sJob.hCond = CPLCreateCond();
+        sJob.hMutex = CPLCreateMutex();
+        CPLReleaseMutex(sJob.hMutex);
+        if( sJob.hCond != NULL && sJob.hMutex != NULL )
+        {
+            hThread = CPLCreateJoinableThread(
+                GDALCopyWholeRasterReadAheadFunc, &sJob);
+        }
+        if( hThread == NULL )
         {
-            int nBand = iBand + 1;
+            CPLDebug( "GDAL",
+                      "GDALDatasetCopyWholeRaster(): cannot start read-ahead "
+                      "thread. Reading sequentially" );
+        }
+        else
+        {
+            CPLDebug( "GDAL",
+                      "GDALDatasetCopyWholeRaster(): reading up to %d swaths "
+                      "ahead in a background thread",
+                      static_cast<int>(sJob.apBuffers.size()) );
+        }
+    }
 
-            for( int iY = 0; iY < nYSize && eErr == CE_None; iY += nSwathLines )
+/* ==================================================================== */
+/*      Pipelined case: the swaths have been read by the read-ahead     */
+/*      thread. Write them in order.                                    */
+/* ==================================================================== */
+    if( hThread != NULL )
+    {
+        const size_t nBuffers = sJob.apBuffers.size();
+        for( size_t iSwath = 0;
+             iSwath < aoSwaths.size() && eErr == CE_None;
+             iSwath++ )
+        {
+            CPLAcquireMutex(sJob.hMutex, 1000.0);
+            while( sJob.nSwathsRead <= iSwath && !sJob.bReadFinished )
+                CPLCondWait(sJob.hCond, sJob.hMutex);
+            const bool bSwathRead = sJob.nSwathsRead > iSwath;
+            const bool bHasData = bSwathRead && sJob.abHasData[iSwath % nBuffers];
+            CPLReleaseMutex(sJob.hMutex);
+
+            GDALCopyWholeRasterEmitReadAheadErrors(&sJob);
+            if( !bSwathRead )
             {
-                int nThisLines = nSwathLines;
-
-                if( iY + nThisLines > nYSize )
-                    nThisLines = nYSize - iY;
-
-                for( int iX = 0;
-                     iX < nXSize && eErr == CE_None;
-                     iX += nSwathCols )
-                {
-                    int nThisCols = nSwathCols;
+                eErr = CE_Failure;
+                break;
+            }
 
-                    if( iX + nThisCols > nXSize )
-                        nThisCols = nXSize - iX;
+            if( bHasData )
+            {
+                eErr = GDALCopyWholeRasterSwathIO(
+                    GF_Write, poDstDS, nBandCount, aoSwaths[iSwath],
+                    sJob.apBuffers[iSwath % nBuffers], eDT, NULL);
+            }
 
-                    int nStatus = GDAL_DATA_COVERAGE_STATUS_DATA;
-                    if( bCheckHoles )
-                    {
-                        nStatus = poSrcDS->GetRasterBand(nBand)->GetDataCoverageStatus(
-                              iX, iY, nThisCols, nThisLines,
-                              GDAL_DATA_COVERAGE_STATUS_DATA);
-                    }
-                    if( nStatus & GDAL_DATA_COVERAGE_STATUS_DATA )
-                    {
-                        sExtraArg.pfnProgress = GDALScaledProgress;
-                        sExtraArg.pProgressData =
-                            GDALCreateScaledProgress(
-                                nBlocksDone / static_cast<double>(nTotalBlocks),
-                                (nBlocksDone + 0.5) /
-                                static_cast<double>(nTotalBlocks),
-                                pfnProgress,
-                                pProgressData );
-                        if( sExtraArg.pProgressData == NULL )
-                            sExtraArg.pfnProgress = NULL;
-
-                        eErr = poSrcDS->RasterIO( GF_Read,
-                                                  iX, iY, nThisCols, nThisLines,
-                                                  pSwathBuf, nThisCols, nThisLines,
-                                                  eDT, 1, &nBand,
-                                                  0, 0, 0, &sExtraArg );
-
-                        GDALDestroyScaledProgress( sExtraArg.pProgressData );
-
-                        if( eErr == CE_None )
-                            eErr = poDstDS->RasterIO( GF_Write,
-                                                      iX, iY, nThisCols, nThisLines,
-                                                      pSwathBuf, nThisCols,
-                                                      nThisLines,
-                                                      eDT, 1, &nBand,
-                                                      0, 0, 0, NULL );
-                    }
+            CPLAcquireMutex(sJob.hMutex, 1000.0);
+            sJob.nSwathsWritten = iSwath + 1;
+            CPLCondBroadcast(sJob.hCond);
+            CPLReleaseMutex(sJob.hMutex);
 
-                    nBlocksDone++;
-                    if( eErr == CE_None
-                        && !pfnProgress(
-                            nBlocksDone / static_cast<double>(nTotalBlocks),
-                            NULL, pProgressData ) )
-                    {
-                        eErr = CE_Failure;
-                        CPLError( CE_Failure, CPLE_UserInterrupt,
-                                  "User terminated CreateCopy()" );
-                    }
-                }
+            if( eErr == CE_None &&
+                !pfnProgress( (iSwath + 1) / dfTotalBlocks,
+                              NULL, pProgressData ) )
+            {
+                eErr = CE_Failure;
+                CPLError( CE_Failure, CPLE_UserInterrupt,
+                          "User terminated CreateCopy()" );
             }
         }
+
+        CPLAcquireMutex(sJob.hMutex, 1000.0);
+        sJob.bStop = true;
+        CPLCondBroadcast(sJob.hCond);
+        CPLReleaseMutex(sJob.hMutex);
+        CPLJoinThread(hThread);
+        GDALCopyWholeRasterEmitReadAheadErrors(&sJob);
     }
 
 /* ==================================================================== */
-/*      Pixel interleaved case.                                         */
+/*      Sequential case.                                                */
 /* ==================================================================== */
-    else /* if( bInterleave ) */
+    else
     {
         GDALRasterIOExtraArg sExtraArg;
         INIT_RASTERIO_EXTRA_ARG(sExtraArg);
 
-        const int nTotalBlocks =
-            ((nYSize + nSwathLines - 1) / nSwathLines) *
-            ((nXSize + nSwathCols - 1) / nSwathCols);
-        int nBlocksDone = 0;
-
-        for( int iY = 0; iY < nYSize && eErr == CE_None; iY += nSwathLines )
+        for( size_t iSwath = 0;
+             iSwath < aoSwaths.size() && eErr == CE_None;
+             iSwath++ )
         {
-            int nThisLines = nSwathLines;
-
-            if( iY + nThisLines > nYSize )
-                nThisLines = nYSize - iY;
-
-            for( int iX = 0; iX < nXSize && eErr == CE_None; iX += nSwathCols )
+            const int nBlocksDone = static_cast<int>(iSwath);
+            if( !bCheckHoles ||
+                GDALCopyWholeRasterSwathHasData(poSrcDS, nBandCount,
+                                                aoSwaths[iSwath]) )
             {
-                int nThisCols = nSwathCols;
-
-                if( iX + nThisCols > nXSize )
-                    nThisCols = nXSize - iX;
+                sExtraArg.pfnProgress = GDALScaledProgress;
+                sExtraArg.pProgressData =
+                    GDALCreateScaledProgress(
+                        nBlocksDone / dfTotalBlocks,
+                        (nBlocksDone + 0.5) / dfTotalBlocks,
+                        pfnProgress,
+                        pProgressData );
+                if( sExtraArg.pProgressData == NULL )
+                    sExtraArg.pfnProgress = NULL;
+
+                eErr = GDALCopyWholeRasterSwathIO(
+                    GF_Read, poSrcDS, nBandCount, aoSwaths[iSwath],
+                    pSwathBuf, eDT, &sExtraArg);
+
+                GDALDestroyScaledProgress( sExtraArg.pProgressData );
 
-                int nStatus = GDAL_DATA_COVERAGE_STATUS_DATA;
-                if( bCheckHoles )
-                {
-                    for( int iBand = 0; iBand < nBandCount; iBand++ )
-                    {
-                        nStatus |= poSrcDS->GetRasterBand(iBand+1)->GetDataCoverageStatus(
-                          iX, iY, nThisCols, nThisLines,
-                          GDAL_DATA_COVERAGE_STATUS_DATA);
-                        if( nStatus & GDAL_DATA_COVERAGE_STATUS_DATA )
-                            break;
-                    }
-                }
-                if( nStatus & GDAL_DATA_COVERAGE_STATUS_DATA )
-                {
-                    sExtraArg.pfnProgress = GDALScaledProgress;
-                    sExtraArg.pProgressData =
-                        GDALCreateScaledProgress(
-                            nBlocksDone / static_cast<double>(nTotalBlocks),
-                            (nBlocksDone + 0.5) / static_cast<double>(nTotalBlocks),
-                            pfnProgress,
-                            pProgressData );
-                    if( sExtraArg.pProgressData == NULL )
-                        sExtraArg.pfnProgress = NULL;
-
-                    eErr = poSrcDS->RasterIO( GF_Read,
-                                              iX, iY, nThisCols, nThisLines,
-                                              pSwathBuf, nThisCols, nThisLines,
-                                              eDT, nBandCount, NULL,
-                                              0, 0, 0, &sExtraArg );
-
-                    GDALDestroyScaledProgress( sExtraArg.pProgressData );
-
-                    if( eErr == CE_None )
-                        eErr = poDstDS->RasterIO( GF_Write,
-                                                  iX, iY, nThisCols, nThisLines,
-                                                  pSwathBuf, nThisCols, nThisLines,
-                                                  eDT, nBandCount, NULL,
-                                                  0, 0, 0, NULL );
-                }
+                if( eErr == CE_None )
+                    eErr = GDALCopyWholeRasterSwathIO(
+                        GF_Write, poDstDS, nBandCount, aoSwaths[iSwath],
+                        pSwathBuf, eDT, NULL);
+            }
 
-                nBlocksDone++;
-                if( eErr == CE_None &&
-                    !pfnProgress(
-                        nBlocksDone / static_cast<double>( nTotalBlocks ),
-                        NULL, pProgressData ) )
-                {
-                    eErr = CE_Failure;
-                    CPLError( CE_Failure, CPLE_UserInterrupt,
-                            "User terminated CreateCopy()" );
-                }
+            if( eErr == CE_None
+                && !pfnProgress( (nBlocksDone + 1) / dfTotalBlocks,
+                                 NULL, pProgressData ) )
+            {
+                eErr = CE_Failure;
+                CPLError( CE_Failure, CPLE_UserInterrupt,
+                          "User terminated CreateCopy()" );
             }
         }
     }
 
+    if( sJob.hCond != NULL )
+        CPLDestroyCond(sJob.hCond);
+    if( sJob.hMutex != NULL )
+        CPLDestroyMutex(sJob.hMutex);
+    // The first buffer is pSwathBuf, freed below.
+    for( size_t i = 1; i < sJob.apBuffers.size(); i++ )
+        VSIFree(sJob.apBuffers[i]);
+
 /* -------------------------------------------------------------------- */
 /*      Cleanup                                                         */
 /* -------------------------------------------------------------------- */
@@ -4211,6 +4483,12 @@ CPLErr CPL_STDCALL GDALDatasetCopyWholeRaster(
  * achieve best compression.</li>
  * <li>"SKIP_HOLES=YES" to skip chunks for which GDALGetDataCoverageStatus()
  * returns GDAL_DATA_COVERAGE_STATUS_EMPTY (GDAL &gt;= 2.2)</li>
+ * <li>"NUM_THREADS=val" where val is an integer or ALL_CPUS. When greater
+ * than 1, the next swaths are read from the source dataset in a background
+ * thread, while the current one is written into the target dataset, with up
+ * to val swaths in flight. If not specified, the GDAL_NUM_THREADS
+ * configuration option is used. Progress is then only reported after each
+ * swath is written (GDAL &gt;= 2.2)</li>
  * </ul>
  *
  * @param hSrcBand the source band
@@ -281,6 +281,7 @@ typedef struct OGRFieldDefnHS   *OGRFieldDefnH;
 typedef struct OGRFeatureDefnHS *OGRFeatureDefnH;
 typedef struct OGRFeatureHS     *OGRFeatureH;
 typedef struct OGRStyleTableHS *OGRStyleTableH;
+typedef struct OGRFeatureBatchHS *OGRFeatureBatchH;
 #else
 /** Opaque type for a field definition (OGRFieldDefn) */
 typedef void *OGRFieldDefnH;
@@ -290,6 +291,8 @@ typedef void *OGRFeatureDefnH;
 typedef void *OGRFeatureH;
 /** Opaque type for a style table (OGRStyleTable) */
 typedef void *OGRStyleTableH;
+/** Opaque type for a feature batch (OGRFeatureBatch) */
+typedef void *OGRFeatureBatchH;
 #endif
 /** Opaque type for a geometry field definition (OGRGeomFieldDefn) */
 typedef struct OGRGeomFieldDefnHS *OGRGeomFieldDefnH;
@@ -473,6 +476,20 @@ void   CPL_DLL OGR_F_FillUnsetWithDefault( OGRFeatureH hFeat,
                                            char** papszOptions );
 int    CPL_DLL OGR_F_Validate( OGRFeatureH, int nValidateFlags, int bEmitError );
 
+/* OGRFeatureBatch */
+
+OGRFeatureBatchH CPL_DLL OGR_FB_Create( OGRFeatureDefnH ) CPL_WARN_UNUSED_RESULT;
+void   CPL_DLL OGR_FB_Destroy( OGRFeatureBatchH );
+int    CPL_DLL OGR_FB_GetFeatureCount( OGRFeatureBatchH );
+const GIntBig CPL_DLL *OGR_FB_GetFIDs( OGRFeatureBatchH );
+const GByte CPL_DLL *OGR_FB_GetFieldValidity( OGRFeatureBatchH, int );
+const void CPL_DLL *OGR_FB_GetFieldValues( OGRFeatureBatchH, int );
+const int CPL_DLL *OGR_FB_GetFieldOffsets( OGRFeatureBatchH, int );
+const GByte CPL_DLL *OGR_FB_GetGeomFieldValidity( OGRFeatureBatchH, int );
+const int CPL_DLL *OGR_FB_GetGeomFieldOffsets( OGRFeatureBatchH, int );
+const GByte CPL_DLL *OGR_FB_GetGeomFieldData( OGRFeatureBatchH, int );
+OGRFeatureH CPL_DLL OGR_FB_GetFeature( OGRFeatureBatchH, int ) CPL_WARN_UNUSED_RESULT;
+
 /* -------------------------------------------------------------------- */
 /*      ogrsf_frmts.h                                                   */
 /* -------------------------------------------------------------------- */
@@ -506,6 +523,10 @@ void     CPL_DLL OGR_L_SetSpatialFilterRectEx( OGRLayerH, int iGeomField,
 OGRErr CPL_DLL OGR_L_SetAttributeFilter( OGRLayerH, const char * );
 void   CPL_DLL OGR_L_ResetReading( OGRLayerH );
 OGRFeatureH CPL_DLL OGR_L_GetNextFeature( OGRLayerH ) CPL_WARN_UNUSED_RESULT;
+int    CPL_DLL OGR_L_GetNextFeatureBatch( OGRLayerH, OGRFeatureBatchH,
+                                          int nMaxFeatures );
+void   CPL_DLL OGR_L_SetFeaturePooling( OGRLayerH, int bEnable );
+int    CPL_DLL OGR_L_GetFeaturePooling( OGRLayerH );
 OGRErr CPL_DLL OGR_L_SetNextByIndex( OGRLayerH, GIntBig );
 OGRFeatureH CPL_DLL OGR_L_GetFeature( OGRLayerH, GIntBig )  CPL_WARN_UNUSED_RESULT;
 OGRErr CPL_DLL OGR_L_SetFeature( OGRLayerH, OGRFeatureH ) CPL_WARN_UNUSED_RESULT;
@@ -34,6 +34,7 @@
 #include "ogr_geometry.h"
 #include "ogr_featurestyle.h"
 #include "cpl_atomic_ops.h"
+#include "cpl_multiproc.h"
 
 /**
  * \file ogr_feature.h
@@ -278,6 +279,8 @@ class CPL_DLL OGRFeatureDefn
  * A simple feature, including geometry and attributes.
  */
 
+class OGRFeaturePool;
+
 class CPL_DLL OGRFeature
 {
   private:
@@ -289,8 +292,22 @@ class CPL_DLL OGRFeature
     char                *m_pszNativeData;
     char                *m_pszNativeMediaType;
 
+    OGRFeaturePool      *m_poPool;
+    GByte               *m_pabyArena;
+    size_t               m_nArenaSize;
+    size_t               m_nArenaUsed;
+    size_t               m_nArenaRequested;
+
     bool                SetFieldInternal( int i, OGRField * puValue );
 
+    void               *AllocFieldContent( size_t nSize );
+    char               *StrdupFieldContent( const char *pszValue );
+    void                FreeFieldContent( void *pData );
+    void                FreeFieldStringList( char **papszList );
+    void                ResetForReuse();
+
+    friend class OGRFeaturePool;
+
   protected:
 //! @cond Doxygen_Suppress
     char *              m_pszStyleString;
@@ -473,6 +490,184 @@ class CPL_DLL OGRFeature
     CPL_DISALLOW_COPY_ASSIGN(OGRFeature)
 };
 
+/************************************************************************/
+/*                            OGRFeaturePool                            */
+/************************************************************************/
+
+/**
+ * A pool of reusable features of a feature definition.
+ *
+ * Features obtained with GetFeature() are regular OGRFeature objects, but
+ * OGRFeature::DestroyFeature() (and OGR_F_Destroy()) gives them back to the
+ * pool instead of freeing them. A later GetFeature() call then returns the
+ * same object, with all its fields unset and no geometry, without
+ * allocating its field array again. String, binary and list field values
+ * of pooled features are stored in a buffer owned by the feature, that is
+ * rewound when the feature is reused, and grown to the size the feature
+ * needed the previous time. Values that do not fit in that buffer are
+ * allocated on the heap as usual.
+ *
+ * Pools are normally used through OGRLayer::SetFeaturePooling(). Features
+ * may outlive the pool: a feature destroyed after Release() has been
+ * called is freed.
+ *
+ * @since GDAL 2.2
+ */
+
+class CPL_DLL OGRFeaturePool
+{
+    OGRFeatureDefn     *poDefn;
+    int                 nFieldCount;
+    int                 nGeomFieldCount;
+    OGRFeature        **papoFreeFeatures;
+    int                 nFreeFeatures;
+    int                 nMaxFreeFeatures;
+    volatile int        nRefCount;
+    bool                bReleased;
+    CPLMutex           *hMutex;
+
+    void                DiscardFreeFeatures();
+    void                Dereference();
+
+                        ~OGRFeaturePool();
+
+    friend class OGRFeature;
+
+  public:
+    explicit            OGRFeaturePool( OGRFeatureDefn *poDefnIn,
+                                        int nMaxFreeFeaturesIn = 16 );
+
+    /** Return the feature definition of the features of the pool.
+     * @return feature definition.
+     */
+    OGRFeatureDefn     *GetDefnRef() { return poDefn; }
+
+    OGRFeature         *GetFeature();
+    void                ReturnFeature( OGRFeature *poFeature );
+    void                Release();
+
+  private:
+    CPL_DISALLOW_COPY_ASSIGN(OGRFeaturePool)
+};
+
+/************************************************************************/
+/*                           OGRFeatureBatch                            */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+class OGRFeatureBatchColumn;
+//! @endcond
+
+/**
+ * A set of features stored column by column.
+ *
+ * A feature batch is filled by OGRLayer::GetNextFeatureBatch(), and its
+ * buffers are reused from one call to the next, so that reading a layer
+ * this way does not allocate memory per feature once the buffers have
+ * grown to the batch size.
+ *
+ * For each attribute field, the batch holds a validity bitmap (bit i, in
+ * least significant bit order, set if the field of feature i is set) and
+ * the values of the features:
+ * <ul>
+ * <li>OFTInteger: array of int.</li>
+ * <li>OFTInteger64: array of GIntBig.</li>
+ * <li>OFTReal: array of double.</li>
+ * <li>OFTDate, OFTTime and OFTDateTime: array of OGRField, of which the
+ *     Date member is set.</li>
+ * <li>OFTString, OFTBinary, OFTIntegerList, OFTInteger64List, OFTRealList
+ *     and OFTStringList: variable size values, stored one after the other.
+ *     GetFieldOffsets() returns nFeatureCount + 1 offsets, the value of
+ *     feature i being at bytes [offset[i], offset[i+1]). String values are
+ *     followed by a nul character, included in their range. List values are
+ *     the packed elements, and each string of a string list is nul
+ *     terminated.</li>
+ * </ul>
+ * Each geometry field is stored as a validity bitmap and variable size
+ * values, which are the geometries as ISO WKB in little endian byte order.
+ *
+ * Style strings and native data are not part of feature batches.
+ *
+ * The batch also has methods to append features, used by the
+ * implementations of OGRLayer::GetNextFeatureBatch(). SetField(),
+ * SetGeometryDirectly() and similar methods apply to the feature last
+ * added with AddEmptyFeature() or AddFeature(), and convert values the
+ * same way as the methods of the same name of OGRFeature.
+ *
+ * @since GDAL 2.2
+ */
+
+class CPL_DLL OGRFeatureBatch
+{
+  private:
+    OGRFeatureDefn         *poDefn;
+    int                     nFeatureCount;
+    int                     nCapacity;
+    GIntBig                *panFIDs;
+    int                     nFieldCount;
+    OGRFeatureBatchColumn  *pasFields;
+    int                     nGeomFieldCount;
+    OGRFeatureBatchColumn  *pasGeomFields;
+    OGRFeature             *poScratchFeature;
+
+    void                InitColumns();
+    void                FreeColumns();
+    bool                Grow();
+    void                SetFieldFrom( int iField, OGRFeature *poFeature );
+    void                SetGeomFieldFrom( int iField,
+                                          const OGRGeometry *poGeom );
+
+  public:
+    explicit            OGRFeatureBatch( OGRFeatureDefn *poDefnIn );
+                       ~OGRFeatureBatch();
+
+    OGRFeatureDefn     *GetDefnRef() { return poDefn; }
+    int                 GetFeatureCount() const { return nFeatureCount; }
+    void                Reset();
+
+    const GIntBig      *GetFIDs() const { return panFIDs; }
+
+    const GByte        *GetFieldValidity( int iField ) const;
+    int                 IsFieldSet( int iFeature, int iField ) const;
+    const void         *GetFieldValues( int iField ) const;
+    const int          *GetFieldOffsets( int iField ) const;
+    const char         *GetFieldAsString( int iFeature, int iField ) const;
+
+    const GByte        *GetGeomFieldValidity( int iGeomField ) const;
+    const int          *GetGeomFieldOffsets( int iGeomField ) const;
+    const GByte        *GetGeomFieldData( int iGeomField ) const;
+    const GByte        *GetGeomFieldAsWKB( int iFeature, int iGeomField,
+                                           int *pnBytes ) const;
+
+    OGRFeature         *GetFeature( int iFeature ) const
+                                                    CPL_WARN_UNUSED_RESULT;
+
+    int                 AddEmptyFeature( GIntBig nFID );
+    int                 AddFeature( OGRFeature *poFeature );
+
+    void                SetFID( GIntBig nFID );
+    int                 IsFieldSet( int iField ) const
+                            { return IsFieldSet( nFeatureCount - 1, iField ); }
+    void                UnsetField( int iField );
+    void                SetField( int i, int nValue );
+    void                SetField( int i, GIntBig nValue );
+    void                SetField( int i, double dfValue );
+    void                SetField( int i, const char * pszValue );
+    void                SetField( int i, OGRField * puValue );
+    void                SetField( int i, int nCount, GByte * pabyBinary );
+    void                SetField( int i, int nYear, int nMonth, int nDay,
+                                  int nHour=0, int nMinute=0, float fSecond=0.f,
+                                  int nTZFlag = 0 );
+    OGRErr              SetGeometryDirectly( OGRGeometry *poGeom )
+                            { return SetGeomFieldDirectly( 0, poGeom ); }
+    OGRErr              SetGeomFieldDirectly( int iField, OGRGeometry *poGeom );
+    OGRErr              SetGeomFieldWKB( int iField, const GByte *pabyWKB,
+                                         int nBytes );
+
+  private:
+    CPL_DISALLOW_COPY_ASSIGN(OGRFeatureBatch)
+};
+
 /************************************************************************/
 /*                           OGRFeatureQuery                            */
 /************************************************************************/
@@ -482,11 +677,19 @@ class OGRLayer;
 class swq_expr_node;
 class swq_custom_func_registrar;
 
+/* Evaluate() is not reentrant: the expression is compiled into a program
+ * on first use, and that program keeps its intermediate values in a
+ * register file owned by the query.  A given OGRFeatureQuery must thus
+ * not be evaluated from several threads at the same time; use one
+ * instance per thread instead.
+ */
 class CPL_DLL OGRFeatureQuery
 {
   private:
     OGRFeatureDefn *poTargetDefn;
     void           *pSWQExpr;
+    void           *pCompiledExpr;
+    bool            bTryCompiledExpr;
 
     char          **FieldCollector( void *, char ** );
 
@@ -461,6 +461,12 @@ class CPL_DLL OGRSimpleCurve: public OGRCurve
                                        OGRRawPoint*& paoPointsIn, int& nMaxPoints,
                                        double*& padfZIn );
 
+    void        importPointsFromWkb( const unsigned char *pabyData,
+                                     OGRwkbByteOrder eByteOrder );
+    void        exportPointsToWkb( unsigned char *pabyData,
+                                   OGRwkbByteOrder eByteOrder,
+                                   int nWkbFlags ) const;
+
 //! @endcond
 
     virtual double get_LinearArea() const;
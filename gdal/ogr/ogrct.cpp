@@ -923,23 +923,18 @@ OGRSpatialReference *OGRProj4CT::GetTargetCS()
 int OGRProj4CT::Transform( int nCount, double *x, double *y, double *z )
 
 {
-    int *pabSuccess = (int *) CPLMalloc(sizeof(int) * nCount );
-
-    bool bOverallSuccess =
-        CPL_TO_BOOL(TransformEx( nCount, x, y, z, pabSuccess ));
+    // No need for a temporary success array: TransformEx() flags failed
+    // points by setting them to HUGE_VAL, so just scan for those.
+    if( !TransformEx( nCount, x, y, z, NULL ) )
+        return FALSE;
 
     for( int i = 0; i < nCount; i++ )
     {
-        if( !pabSuccess[i] )
-        {
-            bOverallSuccess = false;
-            break;
-        }
+        if( x[i] == HUGE_VAL || y[i] == HUGE_VAL )
+            return FALSE;
     }
 
-    CPLFree( pabSuccess );
-
-    return bOverallSuccess;
+    return TRUE;
 }
 
 /************************************************************************/
@@ -985,28 +980,24 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
     int   err;
 
 /* -------------------------------------------------------------------- */
-/*      Potentially transform to radians.                               */
+/*      Potentially wrap and transform to radians, in a single pass     */
+/*      over the arrays.                                                */
 /* -------------------------------------------------------------------- */
     if( bSourceLatLong )
     {
-        if( bSourceWrap )
+        const double dfWrapMin = dfSourceWrapLong - 180.0;
+        const double dfWrapMax = dfSourceWrapLong + 180.0;
+        for( int i = 0; i < nCount; i++ )
         {
-            for( int i = 0; i < nCount; i++ )
+            if( x[i] != HUGE_VAL )
             {
-                if( x[i] != HUGE_VAL && y[i] != HUGE_VAL )
+                if( bSourceWrap && y[i] != HUGE_VAL )
                 {
-                    if( x[i] < dfSourceWrapLong - 180.0 )
+                    if( x[i] < dfWrapMin )
                         x[i] += 360.0;
-                    else if( x[i] > dfSourceWrapLong + 180 )
+                    else if( x[i] > dfWrapMax )
                         x[i] -= 360.0;
                 }
-            }
-        }
-
-        for( int i = 0; i < nCount; i++ )
-        {
-            if( x[i] != HUGE_VAL )
-            {
                 x[i] *= dfSourceToRadians;
                 y[i] *= dfSourceToRadians;
             }
@@ -1195,38 +1186,32 @@ int OGRProj4CT::TransformEx( int nCount, double *x, double *y, double *z,
         CPLReleaseMutex(hPROJMutex);
 
 /* -------------------------------------------------------------------- */
-/*      Potentially transform back to degrees.                          */
+/*      Potentially transform back to degrees and wrap, and establish  */
+/*      error information if pabSuccess provided, in a single pass.     */
 /* -------------------------------------------------------------------- */
     if( bTargetLatLong )
     {
+        const double dfWrapMin = dfTargetWrapLong - 180.0;
+        const double dfWrapMax = dfTargetWrapLong + 180.0;
         for( int i = 0; i < nCount; i++ )
         {
             if( x[i] != HUGE_VAL && y[i] != HUGE_VAL )
             {
                 x[i] *= dfTargetFromRadians;
                 y[i] *= dfTargetFromRadians;
-            }
-        }
-
-        if( bTargetWrap )
-        {
-            for( int i = 0; i < nCount; i++ )
-            {
-                if( x[i] != HUGE_VAL && y[i] != HUGE_VAL )
+                if( bTargetWrap )
                 {
-                    if( x[i] < dfTargetWrapLong - 180.0 )
+                    if( x[i] < dfWrapMin )
                         x[i] += 360.0;
-                    else if( x[i] > dfTargetWrapLong + 180 )
+                    else if( x[i] > dfWrapMax )
                         x[i] -= 360.0;
                 }
             }
+            if( pabSuccess )
+                pabSuccess[i] = ( x[i] != HUGE_VAL && y[i] != HUGE_VAL );
         }
     }
-
-/* -------------------------------------------------------------------- */
-/*      Establish error information if pabSuccess provided.             */
-/* -------------------------------------------------------------------- */
-    if( pabSuccess )
+    else if( pabSuccess )
     {
         for( int i = 0; i < nCount; i++ )
         {
@@ -33,6 +33,7 @@
 
 #include <errno.h>
 
+#include <algorithm>
 #include <new>
 #include <vector>
 
@@ -67,6 +68,11 @@ OGRFeature::OGRFeature( OGRFeatureDefn * poDefnIn ) :
             poDefn(poDefnIn),
             m_pszNativeData(NULL),
             m_pszNativeMediaType(NULL),
+            m_poPool(NULL),
+            m_pabyArena(NULL),
+            m_nArenaSize(0),
+            m_nArenaUsed(0),
+            m_nArenaRequested(0),
             m_pszStyleString(NULL),
             m_poStyleTable(NULL),
             m_pszTmpFieldValue(NULL)
@@ -137,22 +143,22 @@ OGRFeature::~OGRFeature()
         {
           case OFTString:
             if( pauFields[i].String != NULL )
-                VSIFree( pauFields[i].String );
+                FreeFieldContent( pauFields[i].String );
             break;
 
           case OFTBinary:
             if( pauFields[i].Binary.paData != NULL )
-                VSIFree( pauFields[i].Binary.paData );
+                FreeFieldContent( pauFields[i].Binary.paData );
             break;
 
           case OFTStringList:
-            CSLDestroy( pauFields[i].StringList.paList );
+            FreeFieldStringList( pauFields[i].StringList.paList );
             break;
 
           case OFTIntegerList:
           case OFTInteger64List:
           case OFTRealList:
-            CPLFree( pauFields[i].IntegerList.paList );
+            FreeFieldContent( pauFields[i].IntegerList.paList );
             break;
 
           default:
@@ -175,6 +181,10 @@ OGRFeature::~OGRFeature()
     CPLFree(m_pszTmpFieldValue);
     CPLFree( m_pszNativeData );
     CPLFree( m_pszNativeMediaType );
+    CPLFree( m_pabyArena );
+
+    if( m_poPool != NULL )
+        m_poPool->Dereference();
 }
 
 /************************************************************************/
@@ -197,7 +207,7 @@ OGRFeature::~OGRFeature()
 void OGR_F_Destroy( OGRFeatureH hFeat )
 
 {
-    delete (OGRFeature *) hFeat;
+    OGRFeature::DestroyFeature( (OGRFeature *) hFeat );
 }
 
 /************************************************************************/
@@ -248,6 +258,9 @@ OGRFeature *OGRFeature::CreateFeature( OGRFeatureDefn *poDefn )
  * delete is done in the calling application the memory will be freed onto
  * the application heap which is inappropriate.
  *
+ * If the feature was obtained from a OGRFeaturePool, it is given back to
+ * the pool instead.
+ *
  * This method is the same as the C function OGR_F_Destroy().
  *
  * @param poFeature the feature to delete.
@@ -256,7 +269,137 @@ OGRFeature *OGRFeature::CreateFeature( OGRFeatureDefn *poDefn )
 void OGRFeature::DestroyFeature( OGRFeature *poFeature )
 
 {
-    delete poFeature;
+    if( poFeature != NULL && poFeature->m_poPool != NULL )
+        poFeature->m_poPool->ReturnFeature( poFeature );
+    else
+        delete poFeature;
+}
+
+/************************************************************************/
+/*                         AllocFieldContent()                          */
+/*                                                                      */
+/*      Allocate memory for a string, binary or list field value, from  */
+/*      the arena of the feature if it has one with enough room left,   */
+/*      or from the heap otherwise.                                     */
+/************************************************************************/
+
+void *OGRFeature::AllocFieldContent( size_t nSize )
+
+{
+    // Keep list values 8 byte aligned, and never hand out a zero sized
+    // block that would point at the end of the arena.
+    const size_t nAlignedSize =
+        (std::max(nSize, static_cast<size_t>(1)) + 7) & ~static_cast<size_t>(7);
+    m_nArenaRequested += nAlignedSize;
+
+    if( m_pabyArena != NULL && nAlignedSize <= m_nArenaSize - m_nArenaUsed )
+    {
+        void *pRet = m_pabyArena + m_nArenaUsed;
+        m_nArenaUsed += nAlignedSize;
+        return pRet;
+    }
+
+    return VSI_MALLOC_VERBOSE( nSize );
+}
+
+/************************************************************************/
+/*                         StrdupFieldContent()                         */
+/************************************************************************/
+
+char *OGRFeature::StrdupFieldContent( const char *pszValue )
+
+{
+    const size_t nLen = strlen( pszValue );
+    char *pszRet = static_cast<char *>( AllocFieldContent( nLen + 1 ) );
+    if( pszRet != NULL )
+        memcpy( pszRet, pszValue, nLen + 1 );
+    return pszRet;
+}
+
+/************************************************************************/
+/*                          FreeFieldContent()                          */
+/*                                                                      */
+/*      Memory from the arena is only reclaimed when the feature is     */
+/*      reused.                                                         */
+/************************************************************************/
+
+void OGRFeature::FreeFieldContent( void *pData )
+
+{
+    const GUIntptr_t nPtr = reinterpret_cast<GUIntptr_t>( pData );
+    const GUIntptr_t nArenaStart = reinterpret_cast<GUIntptr_t>( m_pabyArena );
+    if( m_pabyArena != NULL && nPtr >= nArenaStart &&
+        nPtr < nArenaStart + m_nArenaSize )
+        return;
+
+    VSIFree( pData );
+}
+
+/************************************************************************/
+/*                        FreeFieldStringList()                         */
+/************************************************************************/
+
+void OGRFeature::FreeFieldStringList( char **papszList )
+
+{
+    if( papszList == NULL )
+        return;
+
+    for( char **papszIter = papszList; *papszIter != NULL; ++papszIter )
+        FreeFieldContent( *papszIter );
+    FreeFieldContent( papszList );
+}
+
+/************************************************************************/
+/*                           ResetForReuse()                            */
+/*                                                                      */
+/*      Bring a feature of a OGRFeaturePool back to the state of a      */
+/*      newly created feature, and rewind its arena. If the feature     */
+/*      needed more field memory than its arena had, grow the arena     */
+/*      to that size, up to a limit.                                    */
+/************************************************************************/
+
+static const size_t MAX_FEATURE_ARENA_SIZE = 64 * 1024;
+
+void OGRFeature::ResetForReuse()
+
+{
+    const int nFieldCount = ( pauFields != NULL ) ? poDefn->GetFieldCount() : 0;
+    for( int i = 0; i < nFieldCount; i++ )
+        UnsetField( i );
+
+    const int nGeomFieldCount =
+        ( papoGeometries != NULL ) ? poDefn->GetGeomFieldCount() : 0;
+    for( int i = 0; i < nGeomFieldCount; i++ )
+    {
+        delete papoGeometries[i];
+        papoGeometries[i] = NULL;
+    }
+
+    nFID = OGRNullFID;
+
+    CPLFree( m_pszStyleString );
+    m_pszStyleString = NULL;
+    delete m_poStyleTable;
+    m_poStyleTable = NULL;
+    CPLFree( m_pszTmpFieldValue );
+    m_pszTmpFieldValue = NULL;
+    CPLFree( m_pszNativeData );
+    m_pszNativeData = NULL;
+    CPLFree( m_pszNativeMediaType );
+    m_pszNativeMediaType = NULL;
+
+    if( m_nArenaRequested > m_nArenaSize &&
+        m_nArenaSize < MAX_FEATURE_ARENA_SIZE )
+    {
+        const size_t nNewSize =
+            std::min( m_nArenaRequested, MAX_FEATURE_ARENA_SIZE );
+        CPLFree( m_pabyArena );
+        m_pabyArena = static_cast<GByte *>( VSIMalloc( nNewSize ) );
+        m_nArenaSize = ( m_pabyArena != NULL ) ? nNewSize : 0;
+    }
+    m_nArenaUsed = 0;
+    m_nArenaRequested = 0;
 }
 
 /************************************************************************/
@@ -1313,19 +1456,19 @@ void OGRFeature::UnsetField( int iField )
       case OFTRealList:
       case OFTIntegerList:
       case OFTInteger64List:
-        CPLFree( pauFields[iField].IntegerList.paList );
+        FreeFieldContent( pauFields[iField].IntegerList.paList );
         break;
 
       case OFTStringList:
-        CSLDestroy( pauFields[iField].StringList.paList );
+        FreeFieldStringList( pauFields[iField].StringList.paList );
         break;
 
       case OFTString:
-        CPLFree( pauFields[iField].String );
+        FreeFieldContent( pauFields[iField].String );
         break;
 
       case OFTBinary:
-        CPLFree( pauFields[iField].Binary.paData );
+        FreeFieldContent( pauFields[iField].Binary.paData );
         break;
 
       default:
@@ -2989,9 +3132,9 @@ void OGRFeature::SetField( int iField, int nValue )
         snprintf( szTempBuffer, sizeof(szTempBuffer), "%d", nValue );
 
         if( IsFieldSet( iField) )
-            CPLFree( pauFields[iField].String );
+            FreeFieldContent( pauFields[iField].String );
 
-        pauFields[iField].String = VSI_STRDUP_VERBOSE( szTempBuffer );
+        pauFields[iField].String = StrdupFieldContent( szTempBuffer );
         if( pauFields[iField].String == NULL )
         {
             pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
@@ -3131,9 +3274,9 @@ void OGRFeature::SetField( int iField, GIntBig nValue )
         snprintf( szTempBuffer, sizeof(szTempBuffer), CPL_FRMT_GIB, nValue );
 
         if( IsFieldSet( iField) )
-            CPLFree( pauFields[iField].String );
+            FreeFieldContent( pauFields[iField].String );
 
-        pauFields[iField].String = VSI_STRDUP_VERBOSE( szTempBuffer );
+        pauFields[iField].String = StrdupFieldContent( szTempBuffer );
         if( pauFields[iField].String == NULL )
         {
             pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
@@ -3264,9 +3407,9 @@ void OGRFeature::SetField( int iField, double dfValue )
         CPLsnprintf( szTempBuffer, sizeof(szTempBuffer), "%.16g", dfValue );
 
         if( IsFieldSet( iField) )
-            CPLFree( pauFields[iField].String );
+            FreeFieldContent( pauFields[iField].String );
 
-        pauFields[iField].String = VSI_STRDUP_VERBOSE( szTempBuffer );
+        pauFields[iField].String = StrdupFieldContent( szTempBuffer );
         if( pauFields[iField].String == NULL )
         {
             pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
@@ -3363,9 +3506,9 @@ void OGRFeature::SetField( int iField, const char * pszValue )
     if( eType == OFTString )
     {
         if( IsFieldSet(iField) )
-            CPLFree( pauFields[iField].String );
+            FreeFieldContent( pauFields[iField].String );
 
-        pauFields[iField].String = VSI_STRDUP_VERBOSE( pszValue ? pszValue : "" );
+        pauFields[iField].String = StrdupFieldContent( pszValue ? pszValue : "" );
         if( pauFields[iField].String == NULL )
         {
             pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
@@ -4390,7 +4533,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
     else if( poFDefn->GetType() == OFTString )
     {
         if( IsFieldSet( iField ) )
-            CPLFree( pauFields[iField].String );
+            FreeFieldContent( pauFields[iField].String );
 
         if( puValue->String == NULL )
             pauFields[iField].String = NULL;
@@ -4399,7 +4542,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
             pauFields[iField] = *puValue;
         else
         {
-            pauFields[iField].String = VSI_STRDUP_VERBOSE( puValue->String );
+            pauFields[iField].String = StrdupFieldContent( puValue->String );
             if( pauFields[iField].String == NULL )
             {
                 pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
@@ -4419,7 +4562,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
         int     nCount = puValue->IntegerList.nCount;
 
         if( IsFieldSet( iField ) )
-            CPLFree( pauFields[iField].IntegerList.paList );
+            FreeFieldContent( pauFields[iField].IntegerList.paList );
 
         if( puValue->Set.nMarker1 == OGRUnsetMarker
             && puValue->Set.nMarker2 == OGRUnsetMarker )
@@ -4429,7 +4572,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
         else
         {
             pauFields[iField].IntegerList.paList =
-                static_cast<int *>( VSI_MALLOC_VERBOSE(sizeof(int) * nCount) );
+                static_cast<int *>( AllocFieldContent(sizeof(int) * nCount) );
             if( pauFields[iField].IntegerList.paList == NULL )
             {
                 pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
@@ -4447,7 +4590,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
         int     nCount = puValue->Integer64List.nCount;
 
         if( IsFieldSet( iField ) )
-            CPLFree( pauFields[iField].Integer64List.paList );
+            FreeFieldContent( pauFields[iField].Integer64List.paList );
 
         if( puValue->Set.nMarker1 == OGRUnsetMarker
             && puValue->Set.nMarker2 == OGRUnsetMarker )
@@ -4457,7 +4600,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
         else
         {
             pauFields[iField].Integer64List.paList = static_cast<GIntBig *>(
-                VSI_MALLOC_VERBOSE(sizeof(GIntBig) * nCount) );
+                AllocFieldContent(sizeof(GIntBig) * nCount) );
             if( pauFields[iField].Integer64List.paList == NULL )
             {
                 pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
@@ -4475,7 +4618,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
         int     nCount = puValue->RealList.nCount;
 
         if( IsFieldSet( iField ) )
-            CPLFree( pauFields[iField].RealList.paList );
+            FreeFieldContent( pauFields[iField].RealList.paList );
 
         if( puValue->Set.nMarker1 == OGRUnsetMarker
             && puValue->Set.nMarker2 == OGRUnsetMarker )
@@ -4485,7 +4628,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
         else
         {
             pauFields[iField].RealList.paList = static_cast<double *>(
-                VSI_MALLOC_VERBOSE(sizeof(double) * nCount) );
+                AllocFieldContent(sizeof(double) * nCount) );
             if( pauFields[iField].RealList.paList == NULL )
             {
                 pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
@@ -4501,7 +4644,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
     else if( poFDefn->GetType() == OFTStringList )
     {
         if( IsFieldSet( iField ) )
-            CSLDestroy( pauFields[iField].StringList.paList );
+            FreeFieldStringList( pauFields[iField].StringList.paList );
 
         if( puValue->Set.nMarker1 == OGRUnsetMarker
             && puValue->Set.nMarker2 == OGRUnsetMarker )
@@ -4510,20 +4653,32 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
         }
         else
         {
+            const int nCount = CSLCount( puValue->StringList.paList );
             char** papszNewList = NULL;
-            for( char** papszIter = puValue->StringList.paList;
-                 papszIter != NULL && *papszIter != NULL;
-                 ++papszIter )
+            if( nCount > 0 )
             {
-                char** papszNewList2 = CSLAddStringMayFail(papszNewList, *papszIter);
-                if( papszNewList2 == NULL )
+                papszNewList = static_cast<char **>(
+                    AllocFieldContent( sizeof(char*) * (nCount + 1) ) );
+                if( papszNewList == NULL )
                 {
-                    CSLDestroy(papszNewList);
                     pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
                     pauFields[iField].Set.nMarker2 = OGRUnsetMarker;
                     return false;
                 }
-                papszNewList = papszNewList2;
+                for( int i = 0; i <= nCount; i++ )
+                    papszNewList[i] = NULL;
+                for( int i = 0; i < nCount; i++ )
+                {
+                    papszNewList[i] =
+                        StrdupFieldContent( puValue->StringList.paList[i] );
+                    if( papszNewList[i] == NULL )
+                    {
+                        FreeFieldStringList( papszNewList );
+                        pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
+                        pauFields[iField].Set.nMarker2 = OGRUnsetMarker;
+                        return false;
+                    }
+                }
             }
             pauFields[iField].StringList.paList = papszNewList;
             pauFields[iField].StringList.nCount = puValue->StringList.nCount;
@@ -4534,7 +4689,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
     else if( poFDefn->GetType() == OFTBinary )
     {
         if( IsFieldSet( iField ) )
-            CPLFree( pauFields[iField].Binary.paData );
+            FreeFieldContent( pauFields[iField].Binary.paData );
 
         if( puValue->Set.nMarker1 == OGRUnsetMarker
             && puValue->Set.nMarker2 == OGRUnsetMarker )
@@ -4544,7 +4699,7 @@ bool OGRFeature::SetFieldInternal( int iField, OGRField * puValue )
         else
         {
             pauFields[iField].Binary.paData = static_cast<GByte *>(
-                VSI_MALLOC_VERBOSE(puValue->Binary.nCount) );
+                AllocFieldContent(puValue->Binary.nCount) );
             if( pauFields[iField].Binary.paData == NULL )
             {
                 pauFields[iField].Set.nMarker1 = OGRUnsetMarker;
@@ -6216,3 +6371,193 @@ void OGR_F_SetNativeMediaType( OGRFeatureH hFeat, const char* pszNativeMediaType
 
     ((OGRFeature *) hFeat)->SetNativeMediaType(pszNativeMediaType);
 }
+
+/************************************************************************/
+/*                           OGRFeaturePool()                           */
+/************************************************************************/
+
+/**
+ * \brief Constructor.
+ *
+ * The pool increments the reference count of the feature definition.
+ *
+ * @param poDefnIn feature definition of the features of the pool.
+ * @param nMaxFreeFeaturesIn maximum number of destroyed features kept for
+ * reuse. Features destroyed while the pool already holds that many features
+ * are freed.
+ */
+
+OGRFeaturePool::OGRFeaturePool( OGRFeatureDefn *poDefnIn,
+                                int nMaxFreeFeaturesIn ) :
+    poDefn(poDefnIn),
+    nFieldCount(poDefnIn->GetFieldCount()),
+    nGeomFieldCount(poDefnIn->GetGeomFieldCount()),
+    papoFreeFeatures(NULL),
+    nFreeFeatures(0),
+    nMaxFreeFeatures(std::max(0, nMaxFreeFeaturesIn)),
+    nRefCount(1),
+    bReleased(false),
+    hMutex(NULL)
+{
+    poDefn->Reference();
+    papoFreeFeatures = static_cast<OGRFeature **>(
+        CPLCalloc( std::max(1, nMaxFreeFeatures), sizeof(OGRFeature *) ) );
+}
+
+/************************************************************************/
+/*                          ~OGRFeaturePool()                           */
+/************************************************************************/
+
+OGRFeaturePool::~OGRFeaturePool()
+
+{
+    DiscardFreeFeatures();
+    CPLFree( papoFreeFeatures );
+    poDefn->Release();
+    if( hMutex != NULL )
+        CPLDestroyMutex( hMutex );
+}
+
+/************************************************************************/
+/*                        DiscardFreeFeatures()                         */
+/************************************************************************/
+
+void OGRFeaturePool::DiscardFreeFeatures()
+
+{
+    for( int i = 0; i < nFreeFeatures; i++ )
+    {
+        // Free features have no field value nor geometry, but the feature
+        // definition may have got fields since they were reset, so do not
+        // let the destructor look at their arrays.
+        OGRFeature *poFeature = papoFreeFeatures[i];
+        CPLFree( poFeature->pauFields );
+        poFeature->pauFields = NULL;
+        CPLFree( poFeature->papoGeometries );
+        poFeature->papoGeometries = NULL;
+        delete poFeature;
+    }
+    nFreeFeatures = 0;
+}
+
+/************************************************************************/
+/*                            Dereference()                             */
+/************************************************************************/
+
+void OGRFeaturePool::Dereference()
+
+{
+    if( CPLAtomicDec( &nRefCount ) == 0 )
+        delete this;
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/************************************************************************/
+
+/**
+ * \brief Get a feature from the pool.
+ *
+ * The returned feature has all its fields unset, no geometry and a null
+ * FID, like a newly created feature. It should be destroyed with
+ * OGRFeature::DestroyFeature() or OGR_F_Destroy() to be given back to the
+ * pool. Deleting it with the delete operator is safe, but frees it.
+ *
+ * This method is thread-safe.
+ *
+ * @return a feature.
+ */
+
+OGRFeature *OGRFeaturePool::GetFeature()
+
+{
+    OGRFeature *poFeature = NULL;
+    {
+        CPLMutexHolderD( &hMutex );
+
+        if( poDefn->GetFieldCount() != nFieldCount ||
+            poDefn->GetGeomFieldCount() != nGeomFieldCount )
+        {
+            DiscardFreeFeatures();
+            nFieldCount = poDefn->GetFieldCount();
+            nGeomFieldCount = poDefn->GetGeomFieldCount();
+        }
+
+        if( nFreeFeatures > 0 )
+            poFeature = papoFreeFeatures[--nFreeFeatures];
+    }
+
+    if( poFeature == NULL )
+        poFeature = new OGRFeature( poDefn );
+
+    CPLAtomicInc( &nRefCount );
+    poFeature->m_poPool = this;
+    return poFeature;
+}
+
+/************************************************************************/
+/*                           ReturnFeature()                            */
+/************************************************************************/
+
+/**
+ * \brief Give back a feature to the pool.
+ *
+ * This is what OGRFeature::DestroyFeature() does for features obtained
+ * from GetFeature(). The feature is reset and kept for reuse, or freed if
+ * the pool has been released or is full.
+ *
+ * This method is thread-safe.
+ *
+ * @param poFeature a feature obtained from GetFeature().
+ */
+
+void OGRFeaturePool::ReturnFeature( OGRFeature *poFeature )
+
+{
+    CPLAssert( poFeature->m_poPool == this );
+
+    poFeature->ResetForReuse();
+
+    bool bKept = false;
+    {
+        CPLMutexHolderD( &hMutex );
+
+        if( !bReleased && nFreeFeatures < nMaxFreeFeatures &&
+            poDefn->GetFieldCount() == nFieldCount &&
+            poDefn->GetGeomFieldCount() == nGeomFieldCount )
+        {
+            poFeature->m_poPool = NULL;
+            papoFreeFeatures[nFreeFeatures++] = poFeature;
+            bKept = true;
+        }
+    }
+
+    if( bKept )
+        Dereference();
+    else
+        delete poFeature;
+}
+
+/************************************************************************/
+/*                              Release()                               */
+/************************************************************************/
+
+/**
+ * \brief Release the pool.
+ *
+ * This is to be called by the owner of the pool instead of deleting it.
+ * The features kept for reuse are freed. Features obtained from the pool
+ * and not destroyed yet remain valid, and will be freed when destroyed.
+ * The pool object itself is deleted once all of them are.
+ */
+
+void OGRFeaturePool::Release()
+
+{
+    {
+        CPLMutexHolderD( &hMutex );
+        bReleased = true;
+        DiscardFreeFeatures();
+    }
+    Dereference();
+}
@@ -0,0 +1,1503 @@
+/******************************************************************************
+ *
+ * Project:  OpenGIS Simple Features Reference Implementation
+ * Purpose:  The OGRFeatureBatch class implementation: a set of features
+ *           stored column by column.
+ * Author:   Even Rouault, <even dot rouault at spatialys dot com>
+ *
+ ******************************************************************************
+ * Copyright (c) 2016, Even Rouault <even dot rouault at spatialys dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "ogr_feature.h"
+#include "ogr_api.h"
+#include "ogr_p.h"
+#include "cpl_string.h"
+
+#include <limits.h>
+#include <algorithm>
+
+CPL_CVSID("$Id$");
+
+/************************************************************************/
+/*                        OGRFeatureBatchColumn                         */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+class OGRFeatureBatchColumn
+{
+  public:
+    OGRFieldType    eType;
+    OGRFieldSubType eSubType;
+
+    // Size of a value of a fixed size type, 0 for variable size types.
+    int             nValueSize;
+
+    // One bit per feature.
+    GByte          *pabyValidity;
+
+    // Fixed size types.
+    GByte          *pabyValues;
+
+    // Variable size types: nCapacity + 1 offsets into pabyData.
+    int            *panOffsets;
+    GByte          *pabyData;
+    size_t          nDataAlloc;
+
+    OGRFeatureBatchColumn() : eType(OFTBinary), eSubType(OFSTNone),
+                              nValueSize(0), pabyValidity(NULL),
+                              pabyValues(NULL), panOffsets(NULL),
+                              pabyData(NULL), nDataAlloc(0) {}
+    ~OGRFeatureBatchColumn()
+    {
+        CPLFree(pabyValidity);
+        CPLFree(pabyValues);
+        CPLFree(panOffsets);
+        CPLFree(pabyData);
+    }
+
+    bool            Grow( int nNewCapacity );
+    void            SetValid( int iFeature )
+        { pabyValidity[iFeature >> 3] |= (GByte)(1 << (iFeature & 7)); }
+    void            SetInvalid( int iFeature )
+        { pabyValidity[iFeature >> 3] &= (GByte)~(1 << (iFeature & 7)); }
+    bool            IsValid( int iFeature ) const
+        { return (pabyValidity[iFeature >> 3] & (1 << (iFeature & 7))) != 0; }
+    GByte          *ReserveData( int iFeature, size_t nBytes );
+
+  private:
+    CPL_DISALLOW_COPY_ASSIGN(OGRFeatureBatchColumn)
+};
+
+/************************************************************************/
+/*                                Grow()                                */
+/************************************************************************/
+
+bool OGRFeatureBatchColumn::Grow( int nNewCapacity )
+
+{
+    GByte* pabyNewValidity = static_cast<GByte*>(
+        VSI_REALLOC_VERBOSE(pabyValidity, (nNewCapacity + 7) / 8));
+    if( pabyNewValidity == NULL )
+        return false;
+    pabyValidity = pabyNewValidity;
+
+    if( nValueSize > 0 )
+    {
+        GByte* pabyNewValues = static_cast<GByte*>(
+            VSI_REALLOC_VERBOSE(pabyValues,
+                                static_cast<size_t>(nNewCapacity) *
+                                                            nValueSize));
+        if( pabyNewValues == NULL )
+            return false;
+        pabyValues = pabyNewValues;
+    }
+    else
+    {
+        const bool bFirst = panOffsets == NULL;
+        int* panNewOffsets = static_cast<int*>(
+            VSI_REALLOC_VERBOSE(panOffsets,
+                        (static_cast<size_t>(nNewCapacity) + 1) * sizeof(int)));
+        if( panNewOffsets == NULL )
+            return false;
+        panOffsets = panNewOffsets;
+        if( bFirst )
+            panOffsets[0] = 0;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                            ReserveData()                             */
+/*                                                                      */
+/*      Replace the value of iFeature, which must be the last feature   */
+/*      of the batch, by nBytes uninitialized bytes, and return them.   */
+/************************************************************************/
+
+GByte* OGRFeatureBatchColumn::ReserveData( int iFeature, size_t nBytes )
+
+{
+    const size_t nStart = static_cast<size_t>(panOffsets[iFeature]);
+    panOffsets[iFeature + 1] = panOffsets[iFeature];
+    if( nBytes > static_cast<size_t>(INT_MAX) - nStart )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Too much data in feature batch column");
+        return NULL;
+    }
+    if( nStart + nBytes > nDataAlloc || pabyData == NULL )
+    {
+        size_t nNewAlloc = nDataAlloc + nDataAlloc / 2 + nBytes;
+        if( nNewAlloc < 1024 )
+            nNewAlloc = 1024;
+        if( nNewAlloc > static_cast<size_t>(INT_MAX) )
+            nNewAlloc = static_cast<size_t>(INT_MAX);
+        GByte* pabyNewData = static_cast<GByte*>(
+            VSI_REALLOC_VERBOSE(pabyData, nNewAlloc));
+        if( pabyNewData == NULL )
+            return NULL;
+        pabyData = pabyNewData;
+        nDataAlloc = nNewAlloc;
+    }
+    panOffsets[iFeature + 1] = static_cast<int>(nStart + nBytes);
+    return pabyData + nStart;
+}
+//! @endcond
+
+/************************************************************************/
+/*                          OGRFeatureBatch()                           */
+/************************************************************************/
+
+/**
+ * \brief Constructor
+ *
+ * The batch holds a reference on the passed feature definition, and is
+ * empty until filled by OGRLayer::GetNextFeatureBatch() or AddFeature().
+ *
+ * This method is the same as the C function OGR_FB_Create().
+ *
+ * @param poDefnIn feature class (layer) definition of the features of the
+ * batch.
+ */
+
+OGRFeatureBatch::OGRFeatureBatch( OGRFeatureDefn * poDefnIn ) :
+    poDefn(poDefnIn),
+    nFeatureCount(0),
+    nCapacity(0),
+    panFIDs(NULL),
+    nFieldCount(0),
+    pasFields(NULL),
+    nGeomFieldCount(0),
+    pasGeomFields(NULL),
+    poScratchFeature(NULL)
+{
+    poDefn->Reference();
+    InitColumns();
+}
+
+/************************************************************************/
+/*                          ~OGRFeatureBatch()                          */
+/************************************************************************/
+
+OGRFeatureBatch::~OGRFeatureBatch()
+
+{
+    FreeColumns();
+    poDefn->Release();
+}
+
+/************************************************************************/
+/*                            InitColumns()                             */
+/************************************************************************/
+
+void OGRFeatureBatch::InitColumns()
+
+{
+    nFieldCount = poDefn->GetFieldCount();
+    if( nFieldCount > 0 )
+        pasFields = new OGRFeatureBatchColumn[nFieldCount];
+    for( int i = 0; i < nFieldCount; i++ )
+    {
+        OGRFieldDefn* poFieldDefn = poDefn->GetFieldDefn(i);
+        OGRFeatureBatchColumn& oCol = pasFields[i];
+        oCol.eType = poFieldDefn->GetType();
+        oCol.eSubType = poFieldDefn->GetSubType();
+        switch( oCol.eType )
+        {
+            case OFTInteger:
+                oCol.nValueSize = static_cast<int>(sizeof(int));
+                break;
+            case OFTInteger64:
+                oCol.nValueSize = static_cast<int>(sizeof(GIntBig));
+                break;
+            case OFTReal:
+                oCol.nValueSize = static_cast<int>(sizeof(double));
+                break;
+            case OFTDate:
+            case OFTTime:
+            case OFTDateTime:
+                oCol.nValueSize = static_cast<int>(sizeof(OGRField));
+                break;
+            default:
+                oCol.nValueSize = 0;
+                break;
+        }
+    }
+
+    nGeomFieldCount = poDefn->GetGeomFieldCount();
+    if( nGeomFieldCount > 0 )
+        pasGeomFields = new OGRFeatureBatchColumn[nGeomFieldCount];
+}
+
+/************************************************************************/
+/*                            FreeColumns()                             */
+/************************************************************************/
+
+void OGRFeatureBatch::FreeColumns()
+
+{
+    delete[] pasFields;
+    pasFields = NULL;
+    nFieldCount = 0;
+    delete[] pasGeomFields;
+    pasGeomFields = NULL;
+    nGeomFieldCount = 0;
+    CPLFree(panFIDs);
+    panFIDs = NULL;
+    nCapacity = 0;
+    nFeatureCount = 0;
+    delete poScratchFeature;
+    poScratchFeature = NULL;
+}
+
+/************************************************************************/
+/*                                Grow()                                */
+/************************************************************************/
+
+bool OGRFeatureBatch::Grow()
+
+{
+    if( nCapacity > INT_MAX / 2 - 1 )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Too many features in feature batch");
+        return false;
+    }
+    const int nNewCapacity = nCapacity == 0 ? 64 : nCapacity * 2;
+
+    GIntBig* panNewFIDs = static_cast<GIntBig*>(
+        VSI_REALLOC_VERBOSE(panFIDs,
+                            static_cast<size_t>(nNewCapacity) *
+                                                        sizeof(GIntBig)));
+    if( panNewFIDs == NULL )
+        return false;
+    panFIDs = panNewFIDs;
+
+    // Columns already grown keep their larger buffers if a later one fails.
+    for( int i = 0; i < nFieldCount; i++ )
+    {
+        if( !pasFields[i].Grow(nNewCapacity) )
+            return false;
+    }
+    for( int i = 0; i < nGeomFieldCount; i++ )
+    {
+        if( !pasGeomFields[i].Grow(nNewCapacity) )
+            return false;
+    }
+
+    nCapacity = nNewCapacity;
+    return true;
+}
+
+/************************************************************************/
+/*                               Reset()                                */
+/************************************************************************/
+
+/**
+ * \brief Remove all the features of the batch.
+ *
+ * The buffers of the batch are kept, so as to be reused for the next
+ * features. If fields have been added to or removed from the feature
+ * definition since the batch was created or last reset, the columns are
+ * recreated to match it.
+ */
+
+void OGRFeatureBatch::Reset()
+
+{
+    bool bDefnChanged = nFieldCount != poDefn->GetFieldCount() ||
+                        nGeomFieldCount != poDefn->GetGeomFieldCount();
+    for( int i = 0; !bDefnChanged && i < nFieldCount; i++ )
+    {
+        OGRFieldDefn* poFieldDefn = poDefn->GetFieldDefn(i);
+        bDefnChanged = pasFields[i].eType != poFieldDefn->GetType() ||
+                       pasFields[i].eSubType != poFieldDefn->GetSubType();
+    }
+    if( bDefnChanged )
+    {
+        FreeColumns();
+        InitColumns();
+    }
+    nFeatureCount = 0;
+}
+
+/************************************************************************/
+/*                          GetFieldValidity()                          */
+/************************************************************************/
+
+/**
+ * \brief Fetch the validity bitmap of a field.
+ *
+ * Bit i (in byte i / 8, with mask 1 << (i % 8)) is set if the field is
+ * set for feature i.
+ *
+ * This method is the same as the C function OGR_FB_GetFieldValidity().
+ *
+ * @param iField the field to fetch, from 0 to GetFieldCount()-1 of the
+ * feature definition.
+ *
+ * @return the bitmap, owned by the batch, or NULL if the batch is empty
+ * or the index is invalid.
+ */
+
+const GByte *OGRFeatureBatch::GetFieldValidity( int iField ) const
+
+{
+    if( iField < 0 || iField >= nFieldCount )
+        return NULL;
+    return pasFields[iField].pabyValidity;
+}
+
+/************************************************************************/
+/*                             IsFieldSet()                             */
+/************************************************************************/
+
+/**
+ * \brief Test if a field of a feature of the batch is set.
+ *
+ * @param iFeature index of the feature in the batch.
+ * @param iField the field to test.
+ *
+ * @return TRUE if the field is set, otherwise FALSE.
+ */
+
+int OGRFeatureBatch::IsFieldSet( int iFeature, int iField ) const
+
+{
+    if( iFeature < 0 || iFeature >= nFeatureCount ||
+        iField < 0 || iField >= nFieldCount )
+        return FALSE;
+    return pasFields[iField].IsValid(iFeature);
+}
+
+/************************************************************************/
+/*                           GetFieldValues()                           */
+/************************************************************************/
+
+/**
+ * \brief Fetch the values of a field.
+ *
+ * For fixed size types, this is an array of nFeatureCount values. For
+ * variable size types, this is the data to which GetFieldOffsets() refers.
+ * The values of unset fields are undefined.
+ *
+ * This method is the same as the C function OGR_FB_GetFieldValues().
+ *
+ * @param iField the field to fetch.
+ *
+ * @return the values, owned by the batch, or NULL if the batch is empty
+ * or the index is invalid.
+ */
+
+const void *OGRFeatureBatch::GetFieldValues( int iField ) const
+
+{
+    if( iField < 0 || iField >= nFieldCount )
+        return NULL;
+    if( pasFields[iField].nValueSize > 0 )
+        return pasFields[iField].pabyValues;
+    return pasFields[iField].pabyData;
+}
+
+/************************************************************************/
+/*                          GetFieldOffsets()                           */
+/************************************************************************/
+
+/**
+ * \brief Fetch the offsets of the values of a variable size field.
+ *
+ * This method is the same as the C function OGR_FB_GetFieldOffsets().
+ *
+ * @param iField the field to fetch.
+ *
+ * @return an array of nFeatureCount + 1 offsets into GetFieldValues(),
+ * owned by the batch, or NULL if the batch is empty, the index is invalid
+ * or the field is of a fixed size type.
+ */
+
+const int *OGRFeatureBatch::GetFieldOffsets( int iField ) const
+
+{
+    if( iField < 0 || iField >= nFieldCount )
+        return NULL;
+    return pasFields[iField].panOffsets;
+}
+
+/************************************************************************/
+/*                          GetFieldAsString()                          */
+/************************************************************************/
+
+/**
+ * \brief Fetch the value of a string field of a feature of the batch.
+ *
+ * @param iFeature index of the feature in the batch.
+ * @param iField the field to fetch.
+ *
+ * @return the string, owned by the batch, or NULL if the field is unset or
+ * not of type OFTString.
+ */
+
+const char *OGRFeatureBatch::GetFieldAsString( int iFeature,
+                                               int iField ) const
+
+{
+    if( !IsFieldSet(iFeature, iField) || pasFields[iField].eType != OFTString )
+        return NULL;
+    const OGRFeatureBatchColumn& oCol = pasFields[iField];
+    return reinterpret_cast<const char*>(oCol.pabyData +
+                                         oCol.panOffsets[iFeature]);
+}
+
+/************************************************************************/
+/*                        GetGeomFieldValidity()                        */
+/************************************************************************/
+
+/**
+ * \brief Fetch the validity bitmap of a geometry field.
+ *
+ * Bit i (in byte i / 8, with mask 1 << (i % 8)) is set if feature i has
+ * a geometry.
+ *
+ * This method is the same as the C function OGR_FB_GetGeomFieldValidity().
+ *
+ * @param iGeomField the geometry field to fetch.
+ *
+ * @return the bitmap, owned by the batch, or NULL if the batch is empty
+ * or the index is invalid.
+ */
+
+const GByte *OGRFeatureBatch::GetGeomFieldValidity( int iGeomField ) const
+
+{
+    if( iGeomField < 0 || iGeomField >= nGeomFieldCount )
+        return NULL;
+    return pasGeomFields[iGeomField].pabyValidity;
+}
+
+/************************************************************************/
+/*                        GetGeomFieldOffsets()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the offsets of the geometries of a geometry field.
+ *
+ * This method is the same as the C function OGR_FB_GetGeomFieldOffsets().
+ *
+ * @param iGeomField the geometry field to fetch.
+ *
+ * @return an array of nFeatureCount + 1 offsets into GetGeomFieldData(),
+ * owned by the batch, or NULL if the batch is empty or the index is
+ * invalid.
+ */
+
+const int *OGRFeatureBatch::GetGeomFieldOffsets( int iGeomField ) const
+
+{
+    if( iGeomField < 0 || iGeomField >= nGeomFieldCount )
+        return NULL;
+    return pasGeomFields[iGeomField].panOffsets;
+}
+
+/************************************************************************/
+/*                          GetGeomFieldData()                          */
+/************************************************************************/
+
+/**
+ * \brief Fetch the WKB geometries of a geometry field.
+ *
+ * This method is the same as the C function OGR_FB_GetGeomFieldData().
+ *
+ * @param iGeomField the geometry field to fetch.
+ *
+ * @return the geometries as ISO WKB in little endian byte order, one
+ * after the other, owned by the batch, or NULL if there are none or the
+ * index is invalid.
+ */
+
+const GByte *OGRFeatureBatch::GetGeomFieldData( int iGeomField ) const
+
+{
+    if( iGeomField < 0 || iGeomField >= nGeomFieldCount )
+        return NULL;
+    return pasGeomFields[iGeomField].pabyData;
+}
+
+/************************************************************************/
+/*                         GetGeomFieldAsWKB()                          */
+/************************************************************************/
+
+/**
+ * \brief Fetch the geometry of a feature of the batch as WKB.
+ *
+ * @param iFeature index of the feature in the batch.
+ * @param iGeomField the geometry field to fetch.
+ * @param pnBytes pointer to an int, set to the size of the WKB.
+ *
+ * @return the ISO WKB geometry in little endian byte order, owned by the
+ * batch, or NULL if the feature has no geometry.
+ */
+
+const GByte *OGRFeatureBatch::GetGeomFieldAsWKB( int iFeature,
+                                                 int iGeomField,
+                                                 int *pnBytes ) const
+
+{
+    if( pnBytes )
+        *pnBytes = 0;
+    if( iFeature < 0 || iFeature >= nFeatureCount ||
+        iGeomField < 0 || iGeomField >= nGeomFieldCount ||
+        !pasGeomFields[iGeomField].IsValid(iFeature) )
+        return NULL;
+    const OGRFeatureBatchColumn& oCol = pasGeomFields[iGeomField];
+    if( pnBytes )
+        *pnBytes = oCol.panOffsets[iFeature + 1] - oCol.panOffsets[iFeature];
+    return oCol.pabyData + oCol.panOffsets[iFeature];
+}
+
+/************************************************************************/
+/*                             GetFeature()                             */
+/************************************************************************/
+
+/**
+ * \brief Build a feature from a feature of the batch.
+ *
+ * This method is the same as the C function OGR_FB_GetFeature().
+ *
+ * @param iFeature index of the feature in the batch.
+ *
+ * @return a new feature, to be freed by the caller, or NULL if the index
+ * is invalid.
+ */
+
+OGRFeature *OGRFeatureBatch::GetFeature( int iFeature ) const
+
+{
+    if( iFeature < 0 || iFeature >= nFeatureCount )
+        return NULL;
+
+    OGRFeature* poFeature = new OGRFeature(poDefn);
+    poFeature->SetFID(panFIDs[iFeature]);
+
+    for( int i = 0; i < nFieldCount; i++ )
+    {
+        const OGRFeatureBatchColumn& oCol = pasFields[i];
+        if( !oCol.IsValid(iFeature) )
+            continue;
+
+        const GByte* pabyValue = NULL;
+        int nBytes = 0;
+        if( oCol.nValueSize > 0 )
+        {
+            pabyValue = oCol.pabyValues +
+                            static_cast<size_t>(iFeature) * oCol.nValueSize;
+        }
+        else
+        {
+            pabyValue = oCol.pabyData + oCol.panOffsets[iFeature];
+            nBytes = oCol.panOffsets[iFeature + 1] - oCol.panOffsets[iFeature];
+        }
+
+        switch( oCol.eType )
+        {
+            case OFTInteger:
+                poFeature->SetField(i,
+                            *reinterpret_cast<const int*>(pabyValue));
+                break;
+            case OFTInteger64:
+                poFeature->SetField(i,
+                            *reinterpret_cast<const GIntBig*>(pabyValue));
+                break;
+            case OFTReal:
+                poFeature->SetField(i,
+                            *reinterpret_cast<const double*>(pabyValue));
+                break;
+            case OFTDate:
+            case OFTTime:
+            case OFTDateTime:
+            {
+                OGRField sField;
+                memcpy(&sField, pabyValue, sizeof(OGRField));
+                poFeature->SetField(i, &sField);
+                break;
+            }
+            case OFTString:
+                poFeature->SetField(i,
+                            reinterpret_cast<const char*>(pabyValue));
+                break;
+            case OFTBinary:
+                poFeature->SetField(i, nBytes,
+                            const_cast<GByte*>(pabyValue));
+                break;
+            case OFTIntegerList:
+                poFeature->SetField(i,
+                    nBytes / static_cast<int>(sizeof(int)),
+                    const_cast<int*>(
+                        reinterpret_cast<const int*>(pabyValue)));
+                break;
+            case OFTInteger64List:
+                poFeature->SetField(i,
+                    nBytes / static_cast<int>(sizeof(GIntBig)),
+                    const_cast<GIntBig*>(
+                        reinterpret_cast<const GIntBig*>(pabyValue)));
+                break;
+            case OFTRealList:
+                poFeature->SetField(i,
+                    nBytes / static_cast<int>(sizeof(double)),
+                    const_cast<double*>(
+                        reinterpret_cast<const double*>(pabyValue)));
+                break;
+            case OFTStringList:
+            {
+                CPLStringList aosList;
+                int nOffset = 0;
+                while( nOffset < nBytes )
+                {
+                    const char* pszItem =
+                        reinterpret_cast<const char*>(pabyValue) + nOffset;
+                    aosList.AddString(pszItem);
+                    nOffset += static_cast<int>(strlen(pszItem)) + 1;
+                }
+                poFeature->SetField(i, aosList.List());
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    for( int i = 0; i < nGeomFieldCount; i++ )
+    {
+        int nBytes = 0;
+        const GByte* pabyWKB = GetGeomFieldAsWKB(iFeature, i, &nBytes);
+        if( pabyWKB == NULL )
+            continue;
+        OGRGeometry* poGeom = NULL;
+        if( OGRGeometryFactory::createFromWkb(const_cast<GByte*>(pabyWKB),
+                                              NULL, &poGeom, nBytes)
+                                                            != OGRERR_NONE )
+        {
+            continue;
+        }
+        poGeom->assignSpatialReference(
+                            poDefn->GetGeomFieldDefn(i)->GetSpatialRef());
+        poFeature->SetGeomFieldDirectly(i, poGeom);
+    }
+
+    return poFeature;
+}
+
+/************************************************************************/
+/*                          AddEmptyFeature()                           */
+/************************************************************************/
+
+/**
+ * \brief Append a feature, with all its fields unset, to the batch.
+ *
+ * The SetField() and SetGeomFieldDirectly() methods can then be used to
+ * set the fields of the new feature.
+ *
+ * @param nFID feature identifier of the new feature.
+ *
+ * @return the index of the new feature in the batch, or -1 in case of
+ * memory allocation failure.
+ */
+
+int OGRFeatureBatch::AddEmptyFeature( GIntBig nFID )
+
+{
+    if( nFeatureCount == nCapacity && !Grow() )
+        return -1;
+
+    const int iFeature = nFeatureCount;
+    nFeatureCount++;
+    panFIDs[iFeature] = nFID;
+
+    for( int i = 0; i < nFieldCount; i++ )
+    {
+        OGRFeatureBatchColumn& oCol = pasFields[i];
+        oCol.SetInvalid(iFeature);
+        if( oCol.nValueSize > 0 )
+            memset(oCol.pabyValues + static_cast<size_t>(iFeature) *
+                                                            oCol.nValueSize,
+                   0, oCol.nValueSize);
+        else
+            oCol.panOffsets[iFeature + 1] = oCol.panOffsets[iFeature];
+    }
+    for( int i = 0; i < nGeomFieldCount; i++ )
+    {
+        OGRFeatureBatchColumn& oCol = pasGeomFields[i];
+        oCol.SetInvalid(iFeature);
+        oCol.panOffsets[iFeature + 1] = oCol.panOffsets[iFeature];
+    }
+
+    return iFeature;
+}
+
+/************************************************************************/
+/*                             AddFeature()                             */
+/************************************************************************/
+
+/**
+ * \brief Append a copy of a feature to the batch.
+ *
+ * The feature must be of the feature definition of the batch, or of a
+ * feature definition with the same fields.
+ *
+ * @param poFeature the feature to copy.
+ *
+ * @return the index of the new feature in the batch, or -1 in case of
+ * memory allocation failure.
+ */
+
+int OGRFeatureBatch::AddFeature( OGRFeature *poFeature )
+
+{
+    const int iFeature = AddEmptyFeature(poFeature->GetFID());
+    if( iFeature < 0 )
+        return -1;
+
+    const int nSrcFieldCount =
+        std::min(nFieldCount, poFeature->GetFieldCount());
+    for( int i = 0; i < nSrcFieldCount; i++ )
+    {
+        if( poFeature->IsFieldSet(i) )
+            SetFieldFrom(i, poFeature);
+    }
+
+    const int nSrcGeomFieldCount =
+        std::min(nGeomFieldCount, poFeature->GetGeomFieldCount());
+    for( int i = 0; i < nSrcGeomFieldCount; i++ )
+        SetGeomFieldFrom(i, poFeature->GetGeomFieldRef(i));
+
+    return iFeature;
+}
+
+/************************************************************************/
+/*                            SetFieldFrom()                            */
+/*                                                                      */
+/*      Copy the value of a field of poFeature, which must be set and   */
+/*      of the same type, to the last feature of the batch.             */
+/************************************************************************/
+
+void OGRFeatureBatch::SetFieldFrom( int iField, OGRFeature *poFeature )
+
+{
+    const int iFeature = nFeatureCount - 1;
+    OGRFeatureBatchColumn& oCol = pasFields[iField];
+    const OGRField* psField = poFeature->GetRawFieldRef(iField);
+
+    if( oCol.nValueSize > 0 )
+    {
+        GByte* pabyValue = oCol.pabyValues +
+                            static_cast<size_t>(iFeature) * oCol.nValueSize;
+        switch( oCol.eType )
+        {
+            case OFTInteger:
+                memcpy(pabyValue, &psField->Integer, sizeof(int));
+                break;
+            case OFTInteger64:
+                memcpy(pabyValue, &psField->Integer64, sizeof(GIntBig));
+                break;
+            case OFTReal:
+                memcpy(pabyValue, &psField->Real, sizeof(double));
+                break;
+            default:
+                memcpy(pabyValue, psField, sizeof(OGRField));
+                break;
+        }
+        oCol.SetValid(iFeature);
+        return;
+    }
+
+    const void* pData = NULL;
+    size_t nBytes = 0;
+    switch( oCol.eType )
+    {
+        case OFTString:
+            pData = psField->String;
+            nBytes = strlen(psField->String) + 1;
+            break;
+        case OFTBinary:
+            pData = psField->Binary.paData;
+            nBytes = static_cast<size_t>(psField->Binary.nCount);
+            break;
+        case OFTIntegerList:
+            pData = psField->IntegerList.paList;
+            nBytes = static_cast<size_t>(psField->IntegerList.nCount) *
+                                                                sizeof(int);
+            break;
+        case OFTInteger64List:
+            pData = psField->Integer64List.paList;
+            nBytes = static_cast<size_t>(psField->Integer64List.nCount) *
+                                                            sizeof(GIntBig);
+            break;
+        case OFTRealList:
+            pData = psField->RealList.paList;
+            nBytes = static_cast<size_t>(psField->RealList.nCount) *
+                                                            sizeof(double);
+            break;
+        case OFTStringList:
+        {
+            for( int i = 0; i < psField->StringList.nCount; i++ )
+                nBytes += strlen(psField->StringList.paList[i]) + 1;
+            GByte* pabyDst = oCol.ReserveData(iFeature, nBytes);
+            if( pabyDst == NULL )
+                return;
+            for( int i = 0; i < psField->StringList.nCount; i++ )
+            {
+                const size_t nLen = strlen(psField->StringList.paList[i]) + 1;
+                memcpy(pabyDst, psField->StringList.paList[i], nLen);
+                pabyDst += nLen;
+            }
+            oCol.SetValid(iFeature);
+            return;
+        }
+        default:
+            // Deprecated wide string types are not supported.
+            return;
+    }
+
+    GByte* pabyDst = oCol.ReserveData(iFeature, nBytes);
+    if( pabyDst == NULL )
+        return;
+    if( nBytes )
+        memcpy(pabyDst, pData, nBytes);
+    oCol.SetValid(iFeature);
+}
+
+/************************************************************************/
+/*                          SetGeomFieldFrom()                          */
+/************************************************************************/
+
+void OGRFeatureBatch::SetGeomFieldFrom( int iField, const OGRGeometry *poGeom )
+
+{
+    const int iFeature = nFeatureCount - 1;
+    OGRFeatureBatchColumn& oCol = pasGeomFields[iField];
+    oCol.SetInvalid(iFeature);
+    oCol.panOffsets[iFeature + 1] = oCol.panOffsets[iFeature];
+    if( poGeom == NULL )
+        return;
+
+    GByte* pabyWKB = oCol.ReserveData(iFeature, poGeom->WkbSize());
+    if( pabyWKB == NULL )
+        return;
+    poGeom->exportToWkb(wkbNDR, pabyWKB, wkbVariantIso);
+    oCol.SetValid(iFeature);
+}
+
+/************************************************************************/
+/*                               SetFID()                               */
+/************************************************************************/
+
+/**
+ * \brief Set the feature identifier of the last feature of the batch.
+ *
+ * @param nFID the new feature identifier value to assign.
+ */
+
+void OGRFeatureBatch::SetFID( GIntBig nFID )
+
+{
+    if( nFeatureCount > 0 )
+        panFIDs[nFeatureCount - 1] = nFID;
+}
+
+/************************************************************************/
+/*                             UnsetField()                             */
+/************************************************************************/
+
+/**
+ * \brief Clear a field of the last feature of the batch, marking it as
+ * unset.
+ *
+ * @param iField the field to unset.
+ */
+
+void OGRFeatureBatch::UnsetField( int iField )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nFieldCount )
+        return;
+    const int iFeature = nFeatureCount - 1;
+    OGRFeatureBatchColumn& oCol = pasFields[iField];
+    oCol.SetInvalid(iFeature);
+    if( oCol.nValueSize == 0 )
+        oCol.panOffsets[iFeature + 1] = oCol.panOffsets[iFeature];
+}
+
+/************************************************************************/
+/*                             SetField()                               */
+/*                                                                      */
+/*      The common cases of values of the type of the field are stored  */
+/*      directly. Other values are converted by setting them on a       */
+/*      scratch feature, so that the result is the same as with         */
+/*      OGRFeature.                                                     */
+/************************************************************************/
+
+#define OGRFB_SET_THROUGH_SCRATCH_FEATURE(iField, args) \
+    do { \
+        if( poScratchFeature == NULL ) \
+            poScratchFeature = new OGRFeature(poDefn); \
+        poScratchFeature->SetField args; \
+        if( poScratchFeature->IsFieldSet(iField) ) \
+        { \
+            SetFieldFrom(iField, poScratchFeature); \
+            poScratchFeature->UnsetField(iField); \
+        } \
+        else \
+        { \
+            UnsetField(iField); \
+        } \
+    } while( false )
+
+/**
+ * \brief Set field of the last feature of the batch to integer value.
+ *
+ * @param iField the field to set.
+ * @param nValue the value to assign.
+ *
+ * @see OGRFeature::SetField(int, int)
+ */
+
+void OGRFeatureBatch::SetField( int iField, int nValue )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nFieldCount )
+        return;
+    OGRFeatureBatchColumn& oCol = pasFields[iField];
+    if( oCol.eType == OFTInteger && oCol.eSubType == OFSTNone )
+    {
+        const int iFeature = nFeatureCount - 1;
+        reinterpret_cast<int*>(oCol.pabyValues)[iFeature] = nValue;
+        oCol.SetValid(iFeature);
+        return;
+    }
+    OGRFB_SET_THROUGH_SCRATCH_FEATURE(iField, (iField, nValue));
+}
+
+/**
+ * \brief Set field of the last feature of the batch to 64 bit integer
+ * value.
+ *
+ * @param iField the field to set.
+ * @param nValue the value to assign.
+ *
+ * @see OGRFeature::SetField(int, GIntBig)
+ */
+
+void OGRFeatureBatch::SetField( int iField, GIntBig nValue )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nFieldCount )
+        return;
+    OGRFeatureBatchColumn& oCol = pasFields[iField];
+    if( oCol.eType == OFTInteger64 )
+    {
+        const int iFeature = nFeatureCount - 1;
+        reinterpret_cast<GIntBig*>(oCol.pabyValues)[iFeature] = nValue;
+        oCol.SetValid(iFeature);
+        return;
+    }
+    OGRFB_SET_THROUGH_SCRATCH_FEATURE(iField, (iField, nValue));
+}
+
+/**
+ * \brief Set field of the last feature of the batch to double value.
+ *
+ * @param iField the field to set.
+ * @param dfValue the value to assign.
+ *
+ * @see OGRFeature::SetField(int, double)
+ */
+
+void OGRFeatureBatch::SetField( int iField, double dfValue )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nFieldCount )
+        return;
+    OGRFeatureBatchColumn& oCol = pasFields[iField];
+    if( oCol.eType == OFTReal )
+    {
+        const int iFeature = nFeatureCount - 1;
+        reinterpret_cast<double*>(oCol.pabyValues)[iFeature] = dfValue;
+        oCol.SetValid(iFeature);
+        return;
+    }
+    OGRFB_SET_THROUGH_SCRATCH_FEATURE(iField, (iField, dfValue));
+}
+
+/**
+ * \brief Set field of the last feature of the batch to string value.
+ *
+ * @param iField the field to set.
+ * @param pszValue the value to assign.
+ *
+ * @see OGRFeature::SetField(int, const char*)
+ */
+
+void OGRFeatureBatch::SetField( int iField, const char * pszValue )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nFieldCount )
+        return;
+    OGRFeatureBatchColumn& oCol = pasFields[iField];
+    if( oCol.eType == OFTString )
+    {
+        if( pszValue == NULL )
+            pszValue = "";
+        const int iFeature = nFeatureCount - 1;
+        const size_t nBytes = strlen(pszValue) + 1;
+        GByte* pabyDst = oCol.ReserveData(iFeature, nBytes);
+        if( pabyDst == NULL )
+        {
+            oCol.SetInvalid(iFeature);
+            return;
+        }
+        memcpy(pabyDst, pszValue, nBytes);
+        oCol.SetValid(iFeature);
+        return;
+    }
+    OGRFB_SET_THROUGH_SCRATCH_FEATURE(iField, (iField, pszValue));
+}
+
+/**
+ * \brief Set field of the last feature of the batch from a raw field
+ * value.
+ *
+ * @param iField the field to set.
+ * @param puValue the value to assign.
+ *
+ * @see OGRFeature::SetField(int, OGRField*)
+ */
+
+void OGRFeatureBatch::SetField( int iField, OGRField * puValue )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nFieldCount )
+        return;
+    OGRFB_SET_THROUGH_SCRATCH_FEATURE(iField, (iField, puValue));
+}
+
+/**
+ * \brief Set field of the last feature of the batch to binary data.
+ *
+ * @param iField the field to set.
+ * @param nBytes bytes of data being set.
+ * @param pabyData the raw data being applied.
+ *
+ * @see OGRFeature::SetField(int, int, GByte*)
+ */
+
+void OGRFeatureBatch::SetField( int iField, int nBytes, GByte *pabyData )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nFieldCount )
+        return;
+    OGRFeatureBatchColumn& oCol = pasFields[iField];
+    if( oCol.eType == OFTBinary && nBytes >= 0 )
+    {
+        const int iFeature = nFeatureCount - 1;
+        GByte* pabyDst = oCol.ReserveData(iFeature, nBytes);
+        if( pabyDst == NULL )
+        {
+            oCol.SetInvalid(iFeature);
+            return;
+        }
+        if( nBytes )
+            memcpy(pabyDst, pabyData, nBytes);
+        oCol.SetValid(iFeature);
+        return;
+    }
+    OGRFB_SET_THROUGH_SCRATCH_FEATURE(iField, (iField, nBytes, pabyData));
+}
+
+/**
+ * \brief Set field of the last feature of the batch to date.
+ *
+ * @see OGRFeature::SetField(int, int, int, int, int, int, float, int)
+ */
+
+void OGRFeatureBatch::SetField( int iField, int nYear, int nMonth, int nDay,
+                                int nHour, int nMinute, float fSecond,
+                                int nTZFlag )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nFieldCount )
+        return;
+    OGRFB_SET_THROUGH_SCRATCH_FEATURE(iField,
+        (iField, nYear, nMonth, nDay, nHour, nMinute, fSecond, nTZFlag));
+}
+
+#undef OGRFB_SET_THROUGH_SCRATCH_FEATURE
+
+/************************************************************************/
+/*                        SetGeomFieldDirectly()                        */
+/************************************************************************/
+
+/**
+ * \brief Set a geometry field of the last feature of the batch.
+ *
+ * The geometry is converted to WKB, and then destroyed.
+ *
+ * @param iField geometry field to set.
+ * @param poGeom new geometry to apply to the feature. Passing NULL value
+ * here is correct and it will result in deallocation of currently assigned
+ * geometry without assigning new one.
+ *
+ * @return OGRERR_NONE if successful, or OGRERR_FAILURE if the index is
+ * invalid.
+ */
+
+OGRErr OGRFeatureBatch::SetGeomFieldDirectly( int iField,
+                                              OGRGeometry *poGeom )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nGeomFieldCount )
+    {
+        delete poGeom;
+        return OGRERR_FAILURE;
+    }
+    SetGeomFieldFrom(iField, poGeom);
+    delete poGeom;
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                          SetGeomFieldWKB()                           */
+/************************************************************************/
+
+/**
+ * \brief Set a geometry field of the last feature of the batch from WKB.
+ *
+ * The WKB must be ISO WKB in little endian byte order. It is copied
+ * without being checked.
+ *
+ * @param iField geometry field to set.
+ * @param pabyWKB the geometry, or NULL to unset the geometry field.
+ * @param nBytes size of the WKB.
+ *
+ * @return OGRERR_NONE if successful, or OGRERR_FAILURE otherwise.
+ */
+
+OGRErr OGRFeatureBatch::SetGeomFieldWKB( int iField, const GByte *pabyWKB,
+                                         int nBytes )
+
+{
+    if( nFeatureCount == 0 || iField < 0 || iField >= nGeomFieldCount ||
+        nBytes < 0 )
+        return OGRERR_FAILURE;
+    const int iFeature = nFeatureCount - 1;
+    OGRFeatureBatchColumn& oCol = pasGeomFields[iField];
+    oCol.SetInvalid(iFeature);
+    oCol.panOffsets[iFeature + 1] = oCol.panOffsets[iFeature];
+    if( pabyWKB == NULL )
+        return OGRERR_NONE;
+    GByte* pabyDst = oCol.ReserveData(iFeature, nBytes);
+    if( pabyDst == NULL )
+        return OGRERR_FAILURE;
+    memcpy(pabyDst, pabyWKB, nBytes);
+    oCol.SetValid(iFeature);
+    return OGRERR_NONE;
+}
+
+/************************************************************************/
+/*                           OGR_FB_Create()                            */
+/************************************************************************/
+
+/**
+ * \brief Create an empty feature batch.
+ *
+ * This function is the same as the C++ method
+ * OGRFeatureBatch::OGRFeatureBatch().
+ *
+ * @param hDefn handle to the feature class (layer) definition of the
+ * features of the batch.
+ *
+ * @return a handle to the new feature batch, to be destroyed with
+ * OGR_FB_Destroy().
+ *
+ * @since GDAL 2.2
+ */
+
+OGRFeatureBatchH OGR_FB_Create( OGRFeatureDefnH hDefn )
+
+{
+    VALIDATE_POINTER1( hDefn, "OGR_FB_Create", NULL );
+
+    return (OGRFeatureBatchH) new OGRFeatureBatch( (OGRFeatureDefn *) hDefn );
+}
+
+/************************************************************************/
+/*                           OGR_FB_Destroy()                           */
+/************************************************************************/
+
+/**
+ * \brief Destroy a feature batch.
+ *
+ * @param hBatch handle to the feature batch to destroy.
+ *
+ * @since GDAL 2.2
+ */
+
+void OGR_FB_Destroy( OGRFeatureBatchH hBatch )
+
+{
+    delete (OGRFeatureBatch *) hBatch;
+}
+
+/************************************************************************/
+/*                       OGR_FB_GetFeatureCount()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the number of features in a feature batch.
+ *
+ * This function is the same as the C++ method
+ * OGRFeatureBatch::GetFeatureCount().
+ *
+ * @param hBatch handle to the feature batch.
+ *
+ * @return the number of features.
+ *
+ * @since GDAL 2.2
+ */
+
+int OGR_FB_GetFeatureCount( OGRFeatureBatchH hBatch )
+
+{
+    VALIDATE_POINTER1( hBatch, "OGR_FB_GetFeatureCount", 0 );
+
+    return ((OGRFeatureBatch *) hBatch)->GetFeatureCount();
+}
+
+/************************************************************************/
+/*                           OGR_FB_GetFIDs()                           */
+/************************************************************************/
+
+/**
+ * \brief Fetch the feature identifiers of the features of a feature batch.
+ *
+ * This function is the same as the C++ method OGRFeatureBatch::GetFIDs().
+ *
+ * @param hBatch handle to the feature batch.
+ *
+ * @return an array of OGR_FB_GetFeatureCount() identifiers, owned by the
+ * batch.
+ *
+ * @since GDAL 2.2
+ */
+
+const GIntBig *OGR_FB_GetFIDs( OGRFeatureBatchH hBatch )
+
+{
+    VALIDATE_POINTER1( hBatch, "OGR_FB_GetFIDs", NULL );
+
+    return ((OGRFeatureBatch *) hBatch)->GetFIDs();
+}
+
+/************************************************************************/
+/*                      OGR_FB_GetFieldValidity()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the validity bitmap of a field of a feature batch.
+ *
+ * This function is the same as the C++ method
+ * OGRFeatureBatch::GetFieldValidity().
+ *
+ * @param hBatch handle to the feature batch.
+ * @param iField the field to fetch.
+ *
+ * @return the bitmap, owned by the batch, or NULL.
+ *
+ * @since GDAL 2.2
+ */
+
+const GByte *OGR_FB_GetFieldValidity( OGRFeatureBatchH hBatch, int iField )
+
+{
+    VALIDATE_POINTER1( hBatch, "OGR_FB_GetFieldValidity", NULL );
+
+    return ((OGRFeatureBatch *) hBatch)->GetFieldValidity(iField);
+}
+
+/************************************************************************/
+/*                       OGR_FB_GetFieldValues()                        */
+/************************************************************************/
+
+/**
+ * \brief Fetch the values of a field of a feature batch.
+ *
+ * This function is the same as the C++ method
+ * OGRFeatureBatch::GetFieldValues().
+ *
+ * @param hBatch handle to the feature batch.
+ * @param iField the field to fetch.
+ *
+ * @return the values, owned by the batch, or NULL.
+ *
+ * @since GDAL 2.2
+ */
+
+const void *OGR_FB_GetFieldValues( OGRFeatureBatchH hBatch, int iField )
+
+{
+    VALIDATE_POINTER1( hBatch, "OGR_FB_GetFieldValues", NULL );
+
+    return ((OGRFeatureBatch *) hBatch)->GetFieldValues(iField);
+}
+
+/************************************************************************/
+/*                       OGR_FB_GetFieldOffsets()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the offsets of the values of a variable size field of a
+ * feature batch.
+ *
+ * This function is the same as the C++ method
+ * OGRFeatureBatch::GetFieldOffsets().
+ *
+ * @param hBatch handle to the feature batch.
+ * @param iField the field to fetch.
+ *
+ * @return the offsets, owned by the batch, or NULL.
+ *
+ * @since GDAL 2.2
+ */
+
+const int *OGR_FB_GetFieldOffsets( OGRFeatureBatchH hBatch, int iField )
+
+{
+    VALIDATE_POINTER1( hBatch, "OGR_FB_GetFieldOffsets", NULL );
+
+    return ((OGRFeatureBatch *) hBatch)->GetFieldOffsets(iField);
+}
+
+/************************************************************************/
+/*                    OGR_FB_GetGeomFieldValidity()                     */
+/************************************************************************/
+
+/**
+ * \brief Fetch the validity bitmap of a geometry field of a feature batch.
+ *
+ * This function is the same as the C++ method
+ * OGRFeatureBatch::GetGeomFieldValidity().
+ *
+ * @param hBatch handle to the feature batch.
+ * @param iGeomField the geometry field to fetch.
+ *
+ * @return the bitmap, owned by the batch, or NULL.
+ *
+ * @since GDAL 2.2
+ */
+
+const GByte *OGR_FB_GetGeomFieldValidity( OGRFeatureBatchH hBatch,
+                                          int iGeomField )
+
+{
+    VALIDATE_POINTER1( hBatch, "OGR_FB_GetGeomFieldValidity", NULL );
+
+    return ((OGRFeatureBatch *) hBatch)->GetGeomFieldValidity(iGeomField);
+}
+
+/************************************************************************/
+/*                     OGR_FB_GetGeomFieldOffsets()                     */
+/************************************************************************/
+
+/**
+ * \brief Fetch the offsets of the geometries of a geometry field of a
+ * feature batch.
+ *
+ * This function is the same as the C++ method
+ * OGRFeatureBatch::GetGeomFieldOffsets().
+ *
+ * @param hBatch handle to the feature batch.
+ * @param iGeomField the geometry field to fetch.
+ *
+ * @return the offsets, owned by the batch, or NULL.
+ *
+ * @since GDAL 2.2
+ */
+
+const int *OGR_FB_GetGeomFieldOffsets( OGRFeatureBatchH hBatch,
+                                       int iGeomField )
+
+{
+    VALIDATE_POINTER1( hBatch, "OGR_FB_GetGeomFieldOffsets", NULL );
+
+    return ((OGRFeatureBatch *) hBatch)->GetGeomFieldOffsets(iGeomField);
+}
+
+/************************************************************************/
+/*                      OGR_FB_GetGeomFieldData()                       */
+/************************************************************************/
+
+/**
+ * \brief Fetch the WKB geometries of a geometry field of a feature batch.
+ *
+ * This function is the same as the C++ method
+ * OGRFeatureBatch::GetGeomFieldData().
+ *
+ * @param hBatch handle to the feature batch.
+ * @param iGeomField the geometry field to fetch.
+ *
+ * @return the geometries, owned by the batch, or NULL.
+ *
+ * @since GDAL 2.2
+ */
+
+const GByte *OGR_FB_GetGeomFieldData( OGRFeatureBatchH hBatch,
+                                      int iGeomField )
+
+{
+    VALIDATE_POINTER1( hBatch, "OGR_FB_GetGeomFieldData", NULL );
+
+    return ((OGRFeatureBatch *) hBatch)->GetGeomFieldData(iGeomField);
+}
+
+/************************************************************************/
+/*                         OGR_FB_GetFeature()                          */
+/************************************************************************/
+
+/**
+ * \brief Build a feature from a feature of a feature batch.
+ *
+ * This function is the same as the C++ method
+ * OGRFeatureBatch::GetFeature().
+ *
+ * @param hBatch handle to the feature batch.
+ * @param iFeature index of the feature in the batch.
+ *
+ * @return a handle to a new feature, to be destroyed with OGR_F_Destroy(),
+ * or NULL.
+ *
+ * @since GDAL 2.2
+ */
+
+OGRFeatureH OGR_FB_GetFeature( OGRFeatureBatchH hBatch, int iFeature )
+
+{
+    VALIDATE_POINTER1( hBatch, "OGR_FB_GetFeature", NULL );
+
+    return (OGRFeatureH) ((OGRFeatureBatch *) hBatch)->GetFeature(iFeature);
+}
@@ -35,6 +35,7 @@
 #include "ogr_attrind.h"
 
 #include <algorithm>
+#include <vector>
 
 //! @cond Doxygen_Suppress
 
@@ -49,6 +50,836 @@ const char* const SpecialFieldNames[SPECIAL_FIELD_COUNT]
 const swq_field_type SpecialFieldTypes[SPECIAL_FIELD_COUNT]
 = {SWQ_INTEGER, SWQ_STRING, SWQ_STRING, SWQ_STRING, SWQ_FLOAT};
 
+/************************************************************************/
+/*                       OGRFeatureQueryProgram                         */
+/*                                                                      */
+/*      Flat form of a checked expression tree: an array of typed       */
+/*      instructions working on a register file allocated once, so     */
+/*      that evaluating a feature does not allocate any node.  Each     */
+/*      register holds what the swq_expr_node returned at the same      */
+/*      place of the tree by swq_expr_node::Evaluate() would hold, so   */
+/*      that results, including the handling of NULL values by          */
+/*      SWQGeneralEvaluator(), are unchanged.  Sub-expressions that     */
+/*      are not handled here (arithmetic, functions, CAST, ...) are     */
+/*      evaluated by the tree walker and their result copied into      */
+/*      their register.                                                 */
+/************************************************************************/
+
+static swq_expr_node *OGRFeatureFetcher( swq_expr_node *op, void *pFeatureIn );
+
+typedef enum
+{
+    OFQ_LOAD_INTEGER,
+    OFQ_LOAD_INTEGER64,
+    OFQ_LOAD_FLOAT,
+    OFQ_LOAD_STRING,
+    OFQ_LOAD_STRING_COPY,
+    OFQ_LOAD_GEOMETRY,
+    OFQ_SKIP_AND,
+    OFQ_SKIP_OR,
+    OFQ_AND,
+    OFQ_OR,
+    OFQ_NOT,
+    OFQ_ISNULL,
+    OFQ_CMP_INTEGER,
+    OFQ_CMP_FLOAT,
+    OFQ_CMP_STRING,
+    OFQ_IN_INTEGER,
+    OFQ_IN_FLOAT,
+    OFQ_IN_STRING,
+    OFQ_BETWEEN_INTEGER,
+    OFQ_BETWEEN_FLOAT,
+    OFQ_BETWEEN_STRING,
+    OFQ_LIKE,
+    OFQ_EVALUATE_NODE
+} OGRFeatureQueryOpcode;
+
+typedef struct
+{
+    OGRFeatureQueryOpcode eOpcode;
+    swq_op                eOperation;   /* OFQ_CMP_xxx */
+    int                   iDst;
+    int                   iFirstArg;    /* index of first operand in anArgs */
+    int                   nArgCount;
+    int                   iField;       /* OFQ_LOAD_xxx */
+    int                   iSkipTo;      /* OFQ_SKIP_xxx */
+    bool                  bSkipOnTrue;  /* OFQ_SKIP_OR */
+    swq_expr_node        *poNode;       /* OFQ_EVALUATE_NODE */
+} OGRFeatureQueryInstr;
+
+class OGRFeatureQueryRegister
+{
+  public:
+    swq_field_type eType;
+    int            bIsNull;
+    GIntBig        nValue;
+    double         dfValue;
+    const char    *pszValue;
+    CPLString      osValue;   // storage for pszValue when it is a copy.
+
+    OGRFeatureQueryRegister() : eType(SWQ_INTEGER), bIsNull(FALSE),
+                                nValue(0), dfValue(0.0), pszValue(NULL) {}
+};
+
+class OGRFeatureQueryProgram
+{
+    OGRFeatureDefn                      *poDefn;
+    std::vector<OGRFeatureQueryInstr>    aoInstr;
+    std::vector<int>                     anArgs;
+    std::vector<OGRFeatureQueryRegister> aoRegs;
+    int                                  iResult;
+
+    static swq_field_type GetValueType( swq_expr_node *poNode );
+    static bool     GetOpcode( swq_expr_node *poNode,
+                               OGRFeatureQueryOpcode &eOpcode );
+    static bool     IsFullyCompilable( swq_expr_node *poNode );
+    static bool     CanBeNull( swq_expr_node *poNode );
+
+    int             NewRegister( swq_field_type eType );
+    int             Emit( OGRFeatureQueryOpcode eOpcode, int iDst,
+                          const int *panOperands, int nOperandCount );
+    int             CompileNode( swq_expr_node *poNode );
+
+  public:
+    explicit        OGRFeatureQueryProgram( OGRFeatureDefn *poDefnIn ) :
+                        poDefn(poDefnIn), iResult(-1) {}
+
+    bool            Compile( swq_expr_node *poRoot );
+    bool            Evaluate( OGRFeature *poFeature, int &bResult );
+};
+
+typedef enum
+{
+    OFQ_CAT_INTEGER,
+    OFQ_CAT_FLOAT,
+    OFQ_CAT_STRING,
+    OFQ_CAT_OTHER
+} OGRFeatureQueryCategory;
+
+/* Which of the members of a swq_expr_node SWQGeneralEvaluator() uses */
+/* for a value of the given type. */
+static OGRFeatureQueryCategory OFQGetCategory( swq_field_type eType )
+{
+    switch( eType )
+    {
+      case SWQ_INTEGER:
+      case SWQ_INTEGER64:
+      case SWQ_BOOLEAN:
+        return OFQ_CAT_INTEGER;
+
+      case SWQ_FLOAT:
+        return OFQ_CAT_FLOAT;
+
+      case SWQ_STRING:
+      case SWQ_DATE:
+      case SWQ_TIME:
+      case SWQ_TIMESTAMP:
+        return OFQ_CAT_STRING;
+
+      default:
+        return OFQ_CAT_OTHER;
+    }
+}
+
+/************************************************************************/
+/*                            GetValueType()                            */
+/*                                                                      */
+/*      Type of the node returned by swq_expr_node::Evaluate() for     */
+/*      this node.                                                      */
+/************************************************************************/
+
+swq_field_type OGRFeatureQueryProgram::GetValueType( swq_expr_node *poNode )
+
+{
+    if( poNode->eNodeType != SNT_COLUMN )
+        return poNode->field_type;
+
+    // Mirrors OGRFeatureFetcher().
+    switch( poNode->field_type )
+    {
+      case SWQ_GEOMETRY:
+        return SWQ_GEOMETRY;
+
+      case SWQ_INTEGER:
+      case SWQ_BOOLEAN:
+        return SWQ_INTEGER;
+
+      case SWQ_INTEGER64:
+        return SWQ_INTEGER64;
+
+      case SWQ_FLOAT:
+        return SWQ_FLOAT;
+
+      default:
+        return SWQ_STRING;
+    }
+}
+
+/************************************************************************/
+/*                             GetOpcode()                              */
+/*                                                                      */
+/*      Select the specialised instruction for an operation node, in    */
+/*      the same way as SWQGeneralEvaluator() selects its code path     */
+/*      from the types of the operands.  Returns false if the node     */
+/*      must be left to the tree walker.                                */
+/************************************************************************/
+
+bool OGRFeatureQueryProgram::GetOpcode( swq_expr_node *poNode,
+                                        OGRFeatureQueryOpcode &eOpcode )
+
+{
+    if( poNode->eNodeType != SNT_OPERATION ||
+        poNode->field_type != SWQ_BOOLEAN )
+        return false;
+
+    const swq_op eOp = static_cast<swq_op>(poNode->nOperation);
+    const swq_operation *poOp = swq_op_registrar::GetOperator( eOp );
+    if( poOp == NULL || poOp->pfnEvaluator != SWQGeneralEvaluator )
+        return false;
+
+    const int nCount = poNode->nSubExprCount;
+    switch( eOp )
+    {
+      case SWQ_AND:
+      case SWQ_OR:
+      case SWQ_EQ:
+      case SWQ_NE:
+      case SWQ_GE:
+      case SWQ_LE:
+      case SWQ_LT:
+      case SWQ_GT:
+        if( nCount != 2 )
+            return false;
+        break;
+
+      case SWQ_NOT:
+      case SWQ_ISNULL:
+        if( nCount != 1 )
+            return false;
+        break;
+
+      case SWQ_LIKE:
+        if( nCount != 2 && nCount != 3 )
+            return false;
+        break;
+
+      case SWQ_IN:
+        if( nCount < 2 )
+            return false;
+        break;
+
+      case SWQ_BETWEEN:
+        if( nCount != 3 )
+            return false;
+        break;
+
+      default:
+        return false;
+    }
+
+    if( eOp == SWQ_ISNULL )
+    {
+        eOpcode = OFQ_ISNULL;
+        return true;
+    }
+
+    const OGRFeatureQueryCategory eCat0 =
+        OFQGetCategory( GetValueType(poNode->papoSubExpr[0]) );
+    const OGRFeatureQueryCategory eCat1 = nCount > 1 ?
+        OFQGetCategory( GetValueType(poNode->papoSubExpr[1]) ) : OFQ_CAT_OTHER;
+
+    if( eCat0 == OFQ_CAT_FLOAT || eCat1 == OFQ_CAT_FLOAT )
+    {
+        for( int i = 0; i < nCount; i++ )
+        {
+            const OGRFeatureQueryCategory eCat =
+                OFQGetCategory( GetValueType(poNode->papoSubExpr[i]) );
+            if( eCat != OFQ_CAT_INTEGER && eCat != OFQ_CAT_FLOAT )
+                return false;
+        }
+        if( eOp == SWQ_IN )
+            eOpcode = OFQ_IN_FLOAT;
+        else if( eOp == SWQ_BETWEEN )
+            eOpcode = OFQ_BETWEEN_FLOAT;
+        else if( eOp >= SWQ_EQ && eOp <= SWQ_GT )
+            eOpcode = OFQ_CMP_FLOAT;
+        else
+            return false;
+        return true;
+    }
+
+    const OGRFeatureQueryCategory eCat =
+        (eCat0 == OFQ_CAT_INTEGER) ? OFQ_CAT_INTEGER : OFQ_CAT_STRING;
+    for( int i = 0; i < nCount; i++ )
+    {
+        if( OFQGetCategory( GetValueType(poNode->papoSubExpr[i]) ) != eCat )
+            return false;
+    }
+
+    if( eCat == OFQ_CAT_INTEGER )
+    {
+        switch( eOp )
+        {
+          case SWQ_AND: eOpcode = OFQ_AND; break;
+          case SWQ_OR: eOpcode = OFQ_OR; break;
+          case SWQ_NOT: eOpcode = OFQ_NOT; break;
+          case SWQ_IN: eOpcode = OFQ_IN_INTEGER; break;
+          case SWQ_BETWEEN: eOpcode = OFQ_BETWEEN_INTEGER; break;
+          case SWQ_LIKE: return false;
+          default: eOpcode = OFQ_CMP_INTEGER; break;
+        }
+    }
+    else
+    {
+        switch( eOp )
+        {
+          case SWQ_AND:
+          case SWQ_OR:
+          case SWQ_NOT:
+            return false;
+          case SWQ_IN: eOpcode = OFQ_IN_STRING; break;
+          case SWQ_BETWEEN: eOpcode = OFQ_BETWEEN_STRING; break;
+          case SWQ_LIKE: eOpcode = OFQ_LIKE; break;
+          default: eOpcode = OFQ_CMP_STRING; break;
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                         IsFullyCompilable()                          */
+/************************************************************************/
+
+bool OGRFeatureQueryProgram::IsFullyCompilable( swq_expr_node *poNode )
+
+{
+    if( poNode->eNodeType != SNT_OPERATION )
+        return true;
+
+    OGRFeatureQueryOpcode eOpcode;
+    if( !GetOpcode( poNode, eOpcode ) )
+        return false;
+
+    for( int i = 0; i < poNode->nSubExprCount; i++ )
+    {
+        if( !IsFullyCompilable( poNode->papoSubExpr[i] ) )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                             CanBeNull()                              */
+/************************************************************************/
+
+bool OGRFeatureQueryProgram::CanBeNull( swq_expr_node *poNode )
+
+{
+    if( poNode->eNodeType == SNT_CONSTANT )
+        return CPL_TO_BOOL(poNode->is_null);
+    if( poNode->eNodeType == SNT_COLUMN )
+        return true;
+
+    // Boolean operations of SWQGeneralEvaluator() return FALSE, and
+    // not NULL, when one of their operands is NULL.
+    OGRFeatureQueryOpcode eOpcode;
+    return !GetOpcode( poNode, eOpcode );
+}
+
+/************************************************************************/
+/*                            NewRegister()                             */
+/************************************************************************/
+
+int OGRFeatureQueryProgram::NewRegister( swq_field_type eType )
+
+{
+    aoRegs.push_back( OGRFeatureQueryRegister() );
+    aoRegs.back().eType = eType;
+    return static_cast<int>(aoRegs.size()) - 1;
+}
+
+/************************************************************************/
+/*                                Emit()                                */
+/************************************************************************/
+
+int OGRFeatureQueryProgram::Emit( OGRFeatureQueryOpcode eOpcode, int iDst,
+                                  const int *panOperands, int nOperandCount )
+
+{
+    OGRFeatureQueryInstr sInstr;
+    sInstr.eOpcode = eOpcode;
+    sInstr.eOperation = SWQ_EQ;
+    sInstr.iDst = iDst;
+    sInstr.iFirstArg = static_cast<int>(anArgs.size());
+    sInstr.nArgCount = nOperandCount;
+    sInstr.iField = -1;
+    sInstr.iSkipTo = -1;
+    sInstr.bSkipOnTrue = false;
+    sInstr.poNode = NULL;
+    for( int i = 0; i < nOperandCount; i++ )
+        anArgs.push_back( panOperands[i] );
+
+    aoInstr.push_back( sInstr );
+    return static_cast<int>(aoInstr.size()) - 1;
+}
+
+/************************************************************************/
+/*                            CompileNode()                             */
+/*                                                                      */
+/*      Emit the instructions computing a node, and return the         */
+/*      register holding its value.                                     */
+/************************************************************************/
+
+int OGRFeatureQueryProgram::CompileNode( swq_expr_node *poNode )
+
+{
+/* -------------------------------------------------------------------- */
+/*      Constants are stored in their register once for all.            */
+/* -------------------------------------------------------------------- */
+    if( poNode->eNodeType == SNT_CONSTANT )
+    {
+        const int iReg = NewRegister( poNode->field_type );
+        OGRFeatureQueryRegister &sReg = aoRegs[iReg];
+        sReg.bIsNull = poNode->is_null;
+        sReg.nValue = poNode->int_value;
+        sReg.dfValue = poNode->float_value;
+        sReg.pszValue = poNode->string_value;
+        return iReg;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Field values.                                                   */
+/* -------------------------------------------------------------------- */
+    if( poNode->eNodeType == SNT_COLUMN )
+    {
+        const swq_field_type eType = GetValueType( poNode );
+        const int iReg = NewRegister( eType );
+        OGRFeatureQueryOpcode eOpcode;
+        int iField = poNode->field_index;
+
+        switch( eType )
+        {
+          case SWQ_GEOMETRY:
+            eOpcode = OFQ_LOAD_GEOMETRY;
+            iField -= poDefn->GetFieldCount() + SPECIAL_FIELD_COUNT;
+            break;
+
+          case SWQ_INTEGER:
+            eOpcode = OFQ_LOAD_INTEGER;
+            break;
+
+          case SWQ_INTEGER64:
+            eOpcode = OFQ_LOAD_INTEGER64;
+            break;
+
+          case SWQ_FLOAT:
+            eOpcode = OFQ_LOAD_FLOAT;
+            break;
+
+          default:
+          {
+            // GetFieldAsString() returns a pointer that remains valid
+            // while the feature is not modified only for string fields,
+            // and for the OGR_GEOMETRY and OGR_STYLE special fields.
+            // Other values are formatted in a temporary buffer that the
+            // next call frees.
+            const int iSpecialField = iField - poDefn->GetFieldCount();
+            if( (iSpecialField < 0 &&
+                 poDefn->GetFieldDefn(iField)->GetType() == OFTString) ||
+                iSpecialField == SPF_OGR_GEOMETRY ||
+                iSpecialField == SPF_OGR_STYLE )
+                eOpcode = OFQ_LOAD_STRING;
+            else
+                eOpcode = OFQ_LOAD_STRING_COPY;
+            break;
+          }
+        }
+
+        aoInstr[Emit( eOpcode, iReg, NULL, 0 )].iField = iField;
+        return iReg;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Operations we do not specialise are left to the tree walker.   */
+/* -------------------------------------------------------------------- */
+    OGRFeatureQueryOpcode eOpcode;
+    if( !GetOpcode( poNode, eOpcode ) )
+    {
+        const int iReg = NewRegister( poNode->field_type );
+        aoInstr[Emit( OFQ_EVALUATE_NODE, iReg, NULL, 0 )].poNode = poNode;
+        return iReg;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      AND and OR skip the evaluation of their second operand when     */
+/*      the first one determines the result.  This is only done when   */
+/*      the second operand is entirely compiled, so that the errors     */
+/*      of the tree walker are still reported in the same way.          */
+/* -------------------------------------------------------------------- */
+    const int iReg = NewRegister( SWQ_BOOLEAN );
+
+    if( eOpcode == OFQ_AND || eOpcode == OFQ_OR )
+    {
+        int aiOperands[2];
+        aiOperands[0] = CompileNode( poNode->papoSubExpr[0] );
+
+        int iSkip = -1;
+        if( IsFullyCompilable( poNode->papoSubExpr[1] ) )
+        {
+            iSkip = Emit( eOpcode == OFQ_AND ? OFQ_SKIP_AND : OFQ_SKIP_OR,
+                          iReg, aiOperands, 1 );
+            aoInstr[iSkip].bSkipOnTrue =
+                !CanBeNull( poNode->papoSubExpr[1] );
+        }
+
+        aiOperands[1] = CompileNode( poNode->papoSubExpr[1] );
+        Emit( eOpcode, iReg, aiOperands, 2 );
+
+        if( iSkip >= 0 )
+            aoInstr[iSkip].iSkipTo = static_cast<int>(aoInstr.size());
+        return iReg;
+    }
+
+    std::vector<int> aiOperands;
+    for( int i = 0; i < poNode->nSubExprCount; i++ )
+        aiOperands.push_back( CompileNode( poNode->papoSubExpr[i] ) );
+
+    aoInstr[Emit( eOpcode, iReg, &aiOperands[0],
+                  static_cast<int>(aiOperands.size()) )].eOperation =
+        static_cast<swq_op>(poNode->nOperation);
+    return iReg;
+}
+
+/************************************************************************/
+/*                              Compile()                               */
+/************************************************************************/
+
+bool OGRFeatureQueryProgram::Compile( swq_expr_node *poRoot )
+
+{
+    // Nothing to gain if the tree walker has to evaluate everything.
+    OGRFeatureQueryOpcode eOpcode;
+    if( poRoot->eNodeType == SNT_OPERATION && !GetOpcode( poRoot, eOpcode ) )
+        return false;
+
+    iResult = CompileNode( poRoot );
+    return true;
+}
+
+/************************************************************************/
+/*                      Comparison helper functions.                    */
+/************************************************************************/
+
+template<class T> static inline int OFQCompare( swq_op eOp, T a, T b )
+{
+    switch( eOp )
+    {
+      case SWQ_EQ: return a == b;
+      case SWQ_NE: return a != b;
+      case SWQ_GE: return a >= b;
+      case SWQ_LE: return a <= b;
+      case SWQ_LT: return a < b;
+      case SWQ_GT: return a > b;
+      default: return FALSE;
+    }
+}
+
+/* Operands beyond the second one are not converted to floating point */
+/* by SWQGeneralEvaluator(). */
+static inline double OFQGetFloat( const OGRFeatureQueryRegister &sReg,
+                                  int iOperand )
+{
+    if( iOperand < 2 && OFQGetCategory(sReg.eType) == OFQ_CAT_INTEGER )
+        return static_cast<double>(sReg.nValue);
+    return sReg.dfValue;
+}
+
+/* Same as the SWQ_EQ case of the string operations in */
+/* SWQGeneralEvaluator(): when comparing timestamps, the +00 at the end */
+/* might be discarded if the other member has no explicit timezone. */
+static int OFQStringEqual( const OGRFeatureQueryRegister &sA,
+                           const OGRFeatureQueryRegister &sB )
+{
+    const char *pszA = sA.pszValue;
+    const char *pszB = sB.pszValue;
+    if( (sA.eType == SWQ_TIMESTAMP || sA.eType == SWQ_STRING) &&
+        (sB.eType == SWQ_TIMESTAMP || sB.eType == SWQ_STRING) )
+    {
+        const size_t nLenA = strlen(pszA);
+        const size_t nLenB = strlen(pszB);
+        if( nLenA > 3 && nLenB > 3 )
+        {
+            if( strcmp(pszA + nLenA - 3, "+00") == 0 && pszB[nLenB - 3] == ':' )
+                return EQUALN(pszA, pszB, nLenB);
+            if( pszA[nLenA - 3] == ':' && strcmp(pszB + nLenB - 3, "+00") == 0 )
+                return EQUALN(pszA, pszB, nLenA);
+        }
+    }
+    return strcasecmp(pszA, pszB) == 0;
+}
+
+/************************************************************************/
+/*                              Evaluate()                              */
+/*                                                                      */
+/*      Returns false if the result of a sub-expression evaluated by    */
+/*      the tree walker does not have the expected type, in which case  */
+/*      the whole expression must be evaluated by the tree walker.      */
+/*                                                                      */
+/*      The registers are owned by the program and overwritten on each  */
+/*      call, so this is not reentrant.                                 */
+/************************************************************************/
+
+bool OGRFeatureQueryProgram::Evaluate( OGRFeature *poFeature, int &bResult )
+
+{
+    OGRFeatureQueryRegister *pasRegs = &aoRegs[0];
+    const int *panArgs = anArgs.empty() ? NULL : &anArgs[0];
+    const int nInstrCount = static_cast<int>(aoInstr.size());
+
+    for( int iInstr = 0; iInstr < nInstrCount; iInstr++ )
+    {
+        const OGRFeatureQueryInstr &sInstr = aoInstr[iInstr];
+        OGRFeatureQueryRegister &sDst = pasRegs[sInstr.iDst];
+        const int *panOp = panArgs + sInstr.iFirstArg;
+        const int nOpCount = sInstr.nArgCount;
+
+        // Except IS NULL, operations return FALSE if an operand is NULL.
+        if( sInstr.eOpcode >= OFQ_AND && sInstr.eOpcode != OFQ_ISNULL &&
+            sInstr.eOpcode != OFQ_EVALUATE_NODE )
+        {
+            bool bHasNull = false;
+            for( int i = 0; i < nOpCount; i++ )
+            {
+                if( pasRegs[panOp[i]].bIsNull )
+                {
+                    bHasNull = true;
+                    break;
+                }
+            }
+            if( bHasNull )
+            {
+                sDst.nValue = FALSE;
+                continue;
+            }
+        }
+
+        switch( sInstr.eOpcode )
+        {
+          case OFQ_LOAD_INTEGER:
+            sDst.nValue = poFeature->GetFieldAsInteger( sInstr.iField );
+            sDst.bIsNull = !poFeature->IsFieldSet( sInstr.iField );
+            break;
+
+          case OFQ_LOAD_INTEGER64:
+            sDst.nValue = poFeature->GetFieldAsInteger64( sInstr.iField );
+            sDst.bIsNull = !poFeature->IsFieldSet( sInstr.iField );
+            break;
+
+          case OFQ_LOAD_FLOAT:
+            sDst.dfValue = poFeature->GetFieldAsDouble( sInstr.iField );
+            sDst.bIsNull = !poFeature->IsFieldSet( sInstr.iField );
+            break;
+
+          case OFQ_LOAD_STRING:
+            sDst.pszValue = poFeature->GetFieldAsString( sInstr.iField );
+            sDst.bIsNull = !poFeature->IsFieldSet( sInstr.iField );
+            break;
+
+          case OFQ_LOAD_STRING_COPY:
+            sDst.osValue = poFeature->GetFieldAsString( sInstr.iField );
+            sDst.pszValue = sDst.osValue.c_str();
+            sDst.bIsNull = !poFeature->IsFieldSet( sInstr.iField );
+            break;
+
+          case OFQ_LOAD_GEOMETRY:
+            sDst.bIsNull = poFeature->GetGeomFieldRef( sInstr.iField ) == NULL;
+            break;
+
+          case OFQ_SKIP_AND:
+          {
+            const OGRFeatureQueryRegister &sA = pasRegs[panOp[0]];
+            if( sA.bIsNull || !sA.nValue )
+            {
+                sDst.nValue = FALSE;
+                iInstr = sInstr.iSkipTo - 1;
+            }
+            break;
+          }
+
+          case OFQ_SKIP_OR:
+          {
+            const OGRFeatureQueryRegister &sA = pasRegs[panOp[0]];
+            if( sA.bIsNull )
+            {
+                sDst.nValue = FALSE;
+                iInstr = sInstr.iSkipTo - 1;
+            }
+            else if( sInstr.bSkipOnTrue && sA.nValue )
+            {
+                sDst.nValue = TRUE;
+                iInstr = sInstr.iSkipTo - 1;
+            }
+            break;
+          }
+
+          case OFQ_AND:
+            sDst.nValue = pasRegs[panOp[0]].nValue && pasRegs[panOp[1]].nValue;
+            break;
+
+          case OFQ_OR:
+            sDst.nValue = pasRegs[panOp[0]].nValue || pasRegs[panOp[1]].nValue;
+            break;
+
+          case OFQ_NOT:
+            sDst.nValue = !pasRegs[panOp[0]].nValue;
+            break;
+
+          case OFQ_ISNULL:
+            sDst.nValue = pasRegs[panOp[0]].bIsNull;
+            break;
+
+          case OFQ_CMP_INTEGER:
+            sDst.nValue = OFQCompare( sInstr.eOperation,
+                                      pasRegs[panOp[0]].nValue,
+                                      pasRegs[panOp[1]].nValue );
+            break;
+
+          case OFQ_CMP_FLOAT:
+            sDst.nValue = OFQCompare( sInstr.eOperation,
+                                      OFQGetFloat(pasRegs[panOp[0]], 0),
+                                      OFQGetFloat(pasRegs[panOp[1]], 1) );
+            break;
+
+          case OFQ_CMP_STRING:
+            if( sInstr.eOperation == SWQ_EQ )
+                sDst.nValue = OFQStringEqual( pasRegs[panOp[0]],
+                                              pasRegs[panOp[1]] );
+            else
+                sDst.nValue = OFQCompare( sInstr.eOperation,
+                                          strcasecmp(pasRegs[panOp[0]].pszValue,
+                                                     pasRegs[panOp[1]].pszValue),
+                                          0 );
+            break;
+
+          case OFQ_IN_INTEGER:
+          {
+            const GIntBig nValue = pasRegs[panOp[0]].nValue;
+            sDst.nValue = FALSE;
+            for( int i = 1; i < nOpCount; i++ )
+            {
+                if( nValue == pasRegs[panOp[i]].nValue )
+                {
+                    sDst.nValue = TRUE;
+                    break;
+                }
+            }
+            break;
+          }
+
+          case OFQ_IN_FLOAT:
+          {
+            const double dfValue = OFQGetFloat(pasRegs[panOp[0]], 0);
+            sDst.nValue = FALSE;
+            for( int i = 1; i < nOpCount; i++ )
+            {
+                if( dfValue == OFQGetFloat(pasRegs[panOp[i]], i) )
+                {
+                    sDst.nValue = TRUE;
+                    break;
+                }
+            }
+            break;
+          }
+
+          case OFQ_IN_STRING:
+          {
+            const char *pszValue = pasRegs[panOp[0]].pszValue;
+            sDst.nValue = FALSE;
+            for( int i = 1; i < nOpCount; i++ )
+            {
+                if( strcasecmp(pszValue, pasRegs[panOp[i]].pszValue) == 0 )
+                {
+                    sDst.nValue = TRUE;
+                    break;
+                }
+            }
+            break;
+          }
+
+          case OFQ_BETWEEN_INTEGER:
+          {
+            const GIntBig nValue = pasRegs[panOp[0]].nValue;
+            sDst.nValue = nValue >= pasRegs[panOp[1]].nValue &&
+                          nValue <= pasRegs[panOp[2]].nValue;
+            break;
+          }
+
+          case OFQ_BETWEEN_FLOAT:
+          {
+            const double dfValue = OFQGetFloat(pasRegs[panOp[0]], 0);
+            sDst.nValue = dfValue >= OFQGetFloat(pasRegs[panOp[1]], 1) &&
+                          dfValue <= OFQGetFloat(pasRegs[panOp[2]], 2);
+            break;
+          }
+
+          case OFQ_BETWEEN_STRING:
+          {
+            const char *pszValue = pasRegs[panOp[0]].pszValue;
+            sDst.nValue =
+                strcasecmp(pszValue, pasRegs[panOp[1]].pszValue) >= 0 &&
+                strcasecmp(pszValue, pasRegs[panOp[2]].pszValue) <= 0;
+            break;
+          }
+
+          case OFQ_LIKE:
+          {
+            const char chEscape =
+                nOpCount == 3 ? pasRegs[panOp[2]].pszValue[0] : '\0';
+            sDst.nValue = swq_test_like( pasRegs[panOp[0]].pszValue,
+                                         pasRegs[panOp[1]].pszValue,
+                                         chEscape );
+            break;
+          }
+
+          case OFQ_EVALUATE_NODE:
+          {
+            swq_expr_node *poValue =
+                sInstr.poNode->Evaluate( OGRFeatureFetcher, poFeature );
+            if( poValue == NULL )
+            {
+                // An error makes the whole expression evaluate to FALSE.
+                bResult = FALSE;
+                return true;
+            }
+            if( OFQGetCategory(poValue->field_type) !=
+                OFQGetCategory(sInstr.poNode->field_type) )
+            {
+                delete poValue;
+                return false;
+            }
+            sDst.eType = poValue->field_type;
+            sDst.bIsNull = poValue->is_null;
+            sDst.nValue = poValue->int_value;
+            sDst.dfValue = poValue->float_value;
+            if( poValue->string_value != NULL )
+            {
+                sDst.osValue = poValue->string_value;
+                sDst.pszValue = sDst.osValue.c_str();
+            }
+            else
+                sDst.pszValue = NULL;
+            delete poValue;
+            break;
+          }
+        }
+    }
+
+    const OGRFeatureQueryRegister &sResult = pasRegs[iResult];
+    bResult = OFQGetCategory(sResult.eType) == OFQ_CAT_INTEGER &&
+              static_cast<int>(sResult.nValue) != 0;
+    return true;
+}
+
 /************************************************************************/
 /*                          OGRFeatureQuery()                           */
 /************************************************************************/
@@ -58,6 +889,8 @@ OGRFeatureQuery::OGRFeatureQuery()
 {
     poTargetDefn = NULL;
     pSWQExpr = NULL;
+    pCompiledExpr = NULL;
+    bTryCompiledExpr = false;
 }
 
 /************************************************************************/
@@ -67,6 +900,7 @@ OGRFeatureQuery::OGRFeatureQuery()
 OGRFeatureQuery::~OGRFeatureQuery()
 
 {
+    delete (OGRFeatureQueryProgram *) pCompiledExpr;
     delete (swq_expr_node *) pSWQExpr;
 }
 
@@ -83,6 +917,10 @@ OGRErr OGRFeatureQuery::Compile( OGRFeatureDefn *poDefn,
 /* -------------------------------------------------------------------- */
 /*      Clear any existing expression.                                  */
 /* -------------------------------------------------------------------- */
+    delete (OGRFeatureQueryProgram *) pCompiledExpr;
+    pCompiledExpr = NULL;
+    bTryCompiledExpr = false;
+
     if( pSWQExpr != NULL )
     {
         delete (swq_expr_node *) pSWQExpr;
@@ -184,6 +1022,11 @@ OGRErr OGRFeatureQuery::Compile( OGRFeatureDefn *poDefn,
         eErr = OGRERR_CORRUPT_DATA;
         pSWQExpr = NULL;
     }
+    else
+    {
+        // The instruction array relies on the types set by the check.
+        bTryCompiledExpr = CPL_TO_BOOL(bCheck);
+    }
 
     CPLFree( papszFieldNames );
     CPLFree( paeFieldTypes );
@@ -247,6 +1090,36 @@ int OGRFeatureQuery::Evaluate( OGRFeature *poFeature )
     if( pSWQExpr == NULL )
         return FALSE;
 
+/* -------------------------------------------------------------------- */
+/*      Build the instruction array on first use rather than in        */
+/*      Compile(), since some drivers rewrite the expression tree       */
+/*      they get with GetSWQExpr() after it has been compiled.          */
+/*      This and the register file of the program make Evaluate() not   */
+/*      reentrant for a given OGRFeatureQuery.                          */
+/* -------------------------------------------------------------------- */
+    if( bTryCompiledExpr )
+    {
+        bTryCompiledExpr = false;
+        if( CPLTestBool(CPLGetConfigOption("OGR_FEATURE_QUERY_COMPILE",
+                                           "YES")) )
+        {
+            OGRFeatureQueryProgram *poProgram =
+                new OGRFeatureQueryProgram( poTargetDefn );
+            if( poProgram->Compile( (swq_expr_node *) pSWQExpr ) )
+                pCompiledExpr = poProgram;
+            else
+                delete poProgram;
+        }
+    }
+
+    if( pCompiledExpr != NULL && poFeature->GetDefnRef() == poTargetDefn )
+    {
+        int bResult = FALSE;
+        if( ((OGRFeatureQueryProgram *) pCompiledExpr)->Evaluate( poFeature,
+                                                                  bResult ) )
+            return bResult;
+    }
+
     swq_expr_node *poResult =
         ((swq_expr_node *) pSWQExpr)->Evaluate( OGRFeatureFetcher,
                                                 (void *) poFeature );
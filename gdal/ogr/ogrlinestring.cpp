@@ -1446,6 +1446,132 @@ void OGRSimpleCurve::addSubLineString( const OGRLineString *poOtherLine,
     }
 }
 
+/************************************************************************/
+/*                           OGRSwapDoubles()                           */
+/*                                                                      */
+/*      Byte swap in place an array of doubles, that does not need to   */
+/*      be aligned, with a single byte swap instruction per value where */
+/*      the compiler provides one.                                      */
+/************************************************************************/
+
+static void OGRSwapDoubles( GByte *pabyData, size_t nCount )
+
+{
+    for( size_t i = 0; i < nCount; i++ )
+    {
+#ifdef CPL_SWAP64
+        GUIntBig nVal;
+        memcpy( &nVal, pabyData + i * 8, 8 );
+        nVal = CPL_SWAP64( nVal );
+        memcpy( pabyData + i * 8, &nVal, 8 );
+#else
+        CPL_SWAP64PTR( pabyData + i * 8 );
+#endif
+    }
+}
+
+//! @cond Doxygen_Suppress
+/************************************************************************/
+/*                        importPointsFromWkb()                         */
+/*                                                                      */
+/*      Read the nPointCount vertices, with the dimension of the        */
+/*      curve, of a WKB point list. The coordinates are copied in       */
+/*      blocks and byte swapped afterwards in the arrays of the curve,  */
+/*      rather than one by one.                                         */
+/************************************************************************/
+
+void OGRSimpleCurve::importPointsFromWkb( const unsigned char *pabyData,
+                                          OGRwkbByteOrder eByteOrder )
+
+{
+    const bool bHasZ = (flags & OGR_G_3D) != 0;
+    const bool bHasM = (flags & OGR_G_MEASURED) != 0;
+
+    if( bHasZ && bHasM )
+    {
+        for( int i = 0; i < nPointCount; i++ )
+        {
+            memcpy( paoPoints + i, pabyData + i * 32, 16 );
+            memcpy( padfZ + i, pabyData + i * 32 + 16, 8 );
+            memcpy( padfM + i, pabyData + i * 32 + 24, 8 );
+        }
+    }
+    else if( bHasM )
+    {
+        for( int i = 0; i < nPointCount; i++ )
+        {
+            memcpy( paoPoints + i, pabyData + i * 24, 16 );
+            memcpy( padfM + i, pabyData + i * 24 + 16, 8 );
+        }
+    }
+    else if( bHasZ )
+    {
+        for( int i = 0; i < nPointCount; i++ )
+        {
+            memcpy( paoPoints + i, pabyData + i * 24, 16 );
+            memcpy( padfZ + i, pabyData + i * 24 + 16, 8 );
+        }
+    }
+    else if( nPointCount > 0 )
+    {
+        memcpy( paoPoints, pabyData, 16 * static_cast<size_t>(nPointCount) );
+    }
+
+    if( OGR_SWAP( eByteOrder ) && nPointCount > 0 )
+    {
+        OGRSwapDoubles( reinterpret_cast<GByte *>(paoPoints),
+                        2 * static_cast<size_t>(nPointCount) );
+        if( bHasZ )
+            OGRSwapDoubles( reinterpret_cast<GByte *>(padfZ), nPointCount );
+        if( bHasM )
+            OGRSwapDoubles( reinterpret_cast<GByte *>(padfM), nPointCount );
+    }
+}
+
+/************************************************************************/
+/*                         exportPointsToWkb()                          */
+/*                                                                      */
+/*      Write the vertices as a WKB point list (without the point       */
+/*      count) of the dimension given by nWkbFlags. Missing Z or M      */
+/*      values are written as 0.                                        */
+/************************************************************************/
+
+void OGRSimpleCurve::exportPointsToWkb( unsigned char *pabyData,
+                                        OGRwkbByteOrder eByteOrder,
+                                        int nWkbFlags ) const
+
+{
+    const bool bHasZ = (nWkbFlags & OGR_G_3D) != 0;
+    const bool bHasM = (nWkbFlags & OGR_G_MEASURED) != 0;
+    const int nPointSize = 16 + (bHasZ ? 8 : 0) + (bHasM ? 8 : 0);
+    const double dfZero = 0.0;
+
+    if( !bHasZ && !bHasM )
+    {
+        if( nPointCount > 0 )
+            memcpy( pabyData, paoPoints,
+                    16 * static_cast<size_t>(nPointCount) );
+    }
+    else
+    {
+        const int nMOffset = bHasZ ? 24 : 16;
+        for( int i = 0; i < nPointCount; i++ )
+        {
+            GByte *pabyPoint = pabyData + i * nPointSize;
+            memcpy( pabyPoint, paoPoints + i, 16 );
+            if( bHasZ )
+                memcpy( pabyPoint + 16, padfZ ? padfZ + i : &dfZero, 8 );
+            if( bHasM )
+                memcpy( pabyPoint + nMOffset, padfM ? padfM + i : &dfZero, 8 );
+        }
+    }
+
+    if( OGR_SWAP( eByteOrder ) )
+        OGRSwapDoubles( pabyData,
+                        static_cast<size_t>(nPointCount) * (nPointSize / 8) );
+}
+//! @endcond
+
 /************************************************************************/
 /*                           importFromWkb()                            */
 /*                                                                      */
@@ -1495,65 +1621,7 @@ OGRErr OGRSimpleCurve::importFromWkb( unsigned char * pabyData,
 /* -------------------------------------------------------------------- */
 /*      Get the vertex.                                                 */
 /* -------------------------------------------------------------------- */
-    int i = 0;
-
-    if( (flags & OGR_G_3D) && (flags & OGR_G_MEASURED) )
-    {
-        for( i = 0; i < nPointCount; i++ )
-        {
-            memcpy( paoPoints + i, pabyData + 9 + i*32, 16 );
-            memcpy( padfZ + i, pabyData + 9 + 16 + i*32, 8 );
-            memcpy( padfM + i, pabyData + 9 + 24 + i*32, 8 );
-        }
-    }
-    else if( flags & OGR_G_MEASURED )
-    {
-        for( i = 0; i < nPointCount; i++ )
-        {
-            memcpy( paoPoints + i, pabyData + 9 + i*24, 16 );
-            memcpy( padfM + i, pabyData + 9 + 16 + i*24, 8 );
-        }
-    }
-    else if( flags & OGR_G_3D )
-    {
-        for( i = 0; i < nPointCount; i++ )
-        {
-            memcpy( paoPoints + i, pabyData + 9 + i*24, 16 );
-            memcpy( padfZ + i, pabyData + 9 + 16 + i*24, 8 );
-        }
-    }
-    else if( nPointCount )
-    {
-        memcpy( paoPoints, pabyData + 9, 16 * nPointCount );
-    }
-
-/* -------------------------------------------------------------------- */
-/*      Byte swap if needed.                                            */
-/* -------------------------------------------------------------------- */
-    if( OGR_SWAP( eByteOrder ) )
-    {
-        for( i = 0; i < nPointCount; i++ )
-        {
-            CPL_SWAPDOUBLE( &(paoPoints[i].x) );
-            CPL_SWAPDOUBLE( &(paoPoints[i].y) );
-        }
-
-        if( flags & OGR_G_3D )
-        {
-            for( i = 0; i < nPointCount; i++ )
-            {
-                CPL_SWAPDOUBLE( padfZ + i );
-            }
-        }
-
-        if( flags & OGR_G_MEASURED )
-        {
-            for( i = 0; i < nPointCount; i++ )
-            {
-                CPL_SWAPDOUBLE( padfM + i );
-            }
-        }
-    }
+    importPointsFromWkb( pabyData + 9, eByteOrder );
 
     return OGRERR_NONE;
 }
@@ -1606,46 +1674,12 @@ OGRErr  OGRSimpleCurve::exportToWkb( OGRwkbByteOrder eByteOrder,
 /* -------------------------------------------------------------------- */
 /*      Copy in the raw data.                                           */
 /* -------------------------------------------------------------------- */
-    if( (flags & OGR_G_3D) && (flags & OGR_G_MEASURED) )
-    {
-        for( int i = 0; i < nPointCount; i++ )
-        {
-            memcpy( pabyData + 9 + 32*i, paoPoints+i, 16 );
-            memcpy( pabyData + 9 + 16 + 32*i, padfZ+i, 8 );
-            memcpy( pabyData + 9 + 24 + 32*i, padfM+i, 8 );
-        }
-    }
-    else if( flags & OGR_G_MEASURED )
-    {
-        for( int i = 0; i < nPointCount; i++ )
-        {
-            memcpy( pabyData + 9 + 24*i, paoPoints+i, 16 );
-            memcpy( pabyData + 9 + 16 + 24*i, padfM+i, 8 );
-        }
-    }
-    else if( flags & OGR_G_3D )
-    {
-        for( int i = 0; i < nPointCount; i++ )
-        {
-            memcpy( pabyData + 9 + 24*i, paoPoints+i, 16 );
-            memcpy( pabyData + 9 + 16 + 24*i, padfZ+i, 8 );
-        }
-    }
-    else if( nPointCount )
-        memcpy( pabyData+9, paoPoints, 16 * nPointCount );
+    exportPointsToWkb( pabyData + 9, eByteOrder, flags );
 
-/* -------------------------------------------------------------------- */
-/*      Swap if needed.                                                 */
-/* -------------------------------------------------------------------- */
     if( OGR_SWAP( eByteOrder ) )
     {
         int nCount = CPL_SWAP32( nPointCount );
         memcpy( pabyData+5, &nCount, 4 );
-
-        for( int i = CoordinateDimension() * nPointCount - 1; i >= 0; i-- )
-        {
-            CPL_SWAP64PTR( pabyData + 9 + 8 * i );
-        }
     }
 
     return OGRERR_NONE;
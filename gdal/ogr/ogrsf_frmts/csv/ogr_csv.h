@@ -74,6 +74,7 @@ class OGRCSVLayer : public OGRLayer
     bool                bHasFieldNames;
 
     OGRFeature *        GetNextUnfilteredFeature();
+    template<class T> void TranslateTokens( char **papszTokens, T* poTarget );
 
     bool                bNew;
     bool                bInWriteMode;
@@ -146,6 +147,8 @@ class OGRCSVLayer : public OGRLayer
 
     void                ResetReading();
     OGRFeature *        GetNextFeature();
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures );
     virtual OGRFeature* GetFeature( GIntBig nFID );
 
     OGRFeatureDefn *    GetLayerDefn() { return poFeatureDefn; }
@@ -1376,27 +1376,16 @@ OGRFeature* OGRCSVLayer::GetFeature(GIntBig nFID)
 }
 
 /************************************************************************/
-/*                      GetNextUnfilteredFeature()                      */
+/*                          TranslateTokens()                           */
+/*                                                                      */
+/*      Set the fields and geometries of an OGRFeature or of the last   */
+/*      feature of an OGRFeatureBatch from the tokens of a record.      */
 /************************************************************************/
 
-OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
+template<class T> void OGRCSVLayer::TranslateTokens( char **papszTokens,
+                                                     T* poTarget )
 
 {
-    if (fpCSV == NULL)
-        return NULL;
-
-/* -------------------------------------------------------------------- */
-/*      Read the CSV record.                                            */
-/* -------------------------------------------------------------------- */
-    char **papszTokens = GetNextLineTokens();
-    if( papszTokens == NULL )
-        return NULL;
-
-/* -------------------------------------------------------------------- */
-/*      Create the OGR feature.                                         */
-/* -------------------------------------------------------------------- */
-    OGRFeature *poFeature = new OGRFeature( poFeatureDefn );
-
 /* -------------------------------------------------------------------- */
 /*      Set attributes for any indicated attribute records.             */
 /* -------------------------------------------------------------------- */
@@ -1440,19 +1429,19 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                 {
                     poGeom->assignSpatialReference(
                         poFeatureDefn->GetGeomFieldDefn(iGeom)->GetSpatialRef());
-                    poFeature->SetGeomFieldDirectly( iGeom, poGeom );
+                    poTarget->SetGeomFieldDirectly( iGeom, poGeom );
                 }
                 else if( *pszStr == '{' &&
                     (poGeom = (OGRGeometry*)OGR_G_CreateGeometryFromJson(pszStr)) != NULL )
                 {
-                    poFeature->SetGeomFieldDirectly( iGeom, poGeom );
+                    poTarget->SetGeomFieldDirectly( iGeom, poGeom );
                 }
                 else if( ((*pszStr >= '0' && *pszStr <= '9') ||
                         (*pszStr >= 'a' && *pszStr <= 'z') ||
                         (*pszStr >= 'A' && *pszStr <= 'Z') ) &&
                         (poGeom = OGRGeometryFromHexEWKB(pszStr, NULL, FALSE)) != NULL )
                 {
-                    poFeature->SetGeomFieldDirectly( iGeom, poGeom );
+                    poTarget->SetGeomFieldDirectly( iGeom, poGeom );
                 }
                 CPLPopErrorHandler();
             }
@@ -1470,12 +1459,12 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                 if( OGRCSVIsTrue(papszTokens[iAttr]) ||
                     strcmp(papszTokens[iAttr], "1") == 0 )
                 {
-                    poFeature->SetField( iOGRField, 1 );
+                    poTarget->SetField( iOGRField, 1 );
                 }
                 else if( OGRCSVIsFalse(papszTokens[iAttr]) ||
                     strcmp(papszTokens[iAttr], "0") == 0 )
                 {
-                    poFeature->SetField( iOGRField, 0 );
+                    poTarget->SetField( iOGRField, 0 );
                 }
                 else if( !bWarningBadTypeOrWidth )
                 {
@@ -1501,7 +1490,7 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                 eType = CPLGetValueType(papszTokens[iAttr]);
                 if ( eType == CPL_VALUE_INTEGER || eType == CPL_VALUE_REAL )
                 {
-                    poFeature->SetField( iOGRField, papszTokens[iAttr] );
+                    poTarget->SetField( iOGRField, papszTokens[iAttr] );
                     if( !bWarningBadTypeOrWidth &&
                         (eFieldType == OFTInteger ||
                          eFieldType == OFTInteger64) &&
@@ -1559,9 +1548,9 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
         {
             if (papszTokens[iAttr][0] != '\0' && !poFieldDefn->IsIgnored())
             {
-                poFeature->SetField( iOGRField, papszTokens[iAttr] );
+                poTarget->SetField( iOGRField, papszTokens[iAttr] );
                 if( !bWarningBadTypeOrWidth &&
-                    !poFeature->IsFieldSet(iOGRField) )
+                    !poTarget->IsFieldSet(iOGRField) )
                 {
                     bWarningBadTypeOrWidth = true;
                     CPLError(CE_Warning, CPLE_AppDefined,
@@ -1576,7 +1565,7 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
             if( !poFieldDefn->IsIgnored() &&
                 (!bEmptyStringNull || papszTokens[iAttr][0] != '\0') )
             {
-                poFeature->SetField( iOGRField, papszTokens[iAttr] );
+                poTarget->SetField( iOGRField, papszTokens[iAttr] );
                 if( !bWarningBadTypeOrWidth && poFieldDefn->GetWidth() > 0 &&
                     (int)strlen(papszTokens[iAttr]) > poFieldDefn->GetWidth() )
                 {
@@ -1596,7 +1585,7 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
             if( papszTokens[iAttr][0] != '\0' &&
                 !poFeatureDefn->GetFieldDefn(iOGRField)->IsIgnored() )
             {
-                poFeature->SetField( iOGRField, papszTokens[iAttr] );
+                poTarget->SetField( iOGRField, papszTokens[iAttr] );
             }
         }
 
@@ -1620,7 +1609,7 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
             for( int iSubAttr = 0; iSubAttr < nEurostatDims; iSubAttr ++ )
             {
                 if( !poFeatureDefn->GetFieldDefn(iSubAttr)->IsIgnored() )
-                    poFeature->SetField( iSubAttr, papszDims[iSubAttr] );
+                    poTarget->SetField( iSubAttr, papszDims[iSubAttr] );
             }
             CSLDestroy(papszDims);
         }
@@ -1633,12 +1622,12 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
                    eType == CPL_VALUE_REAL ) )
             {
                 if( !poFeatureDefn->GetFieldDefn(nEurostatDims + 2 * (iAttr - 1))->IsIgnored() )
-                    poFeature->SetField( nEurostatDims + 2 * (iAttr - 1), papszVals[0] );
+                    poTarget->SetField( nEurostatDims + 2 * (iAttr - 1), papszVals[0] );
             }
             if( CSLCount(papszVals) == 2 )
             {
                 if( !poFeatureDefn->GetFieldDefn(nEurostatDims + 2 * (iAttr - 1) + 1)->IsIgnored() )
-                    poFeature->SetField( nEurostatDims + 2 * (iAttr - 1) + 1, papszVals[1] );
+                    poTarget->SetField( nEurostatDims + 2 * (iAttr - 1) + 1, papszVals[1] );
             }
             CSLDestroy(papszVals);
         }
@@ -1662,7 +1651,7 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
         if (strchr(papszTokens[iNfdcLatitudeS], 'S'))
             dfLat *= -1;
         if( !(poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored()) )
-            poFeature->SetGeometryDirectly( new OGRPoint(dfLon, dfLat) );
+            poTarget->SetGeometryDirectly( new OGRPoint(dfLon, dfLat) );
     }
 
 /* -------------------------------------------------------------------- */
@@ -1686,12 +1675,37 @@ OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
             if( !(poFeatureDefn->GetGeomFieldDefn(0)->IsIgnored()) )
             {
                 if( iZField != -1 && nAttrCount > iZField && papszTokens[iZField][0] != 0 )
-                    poFeature->SetGeometryDirectly( new OGRPoint(dfLon, dfLat, CPLAtof(papszTokens[iZField])) );
+                    poTarget->SetGeometryDirectly( new OGRPoint(dfLon, dfLat, CPLAtof(papszTokens[iZField])) );
                 else
-                    poFeature->SetGeometryDirectly( new OGRPoint(dfLon, dfLat) );
+                    poTarget->SetGeometryDirectly( new OGRPoint(dfLon, dfLat) );
             }
         }
     }
+}
+
+/************************************************************************/
+/*                      GetNextUnfilteredFeature()                      */
+/************************************************************************/
+
+OGRFeature * OGRCSVLayer::GetNextUnfilteredFeature()
+
+{
+    if (fpCSV == NULL)
+        return NULL;
+
+/* -------------------------------------------------------------------- */
+/*      Read the CSV record.                                            */
+/* -------------------------------------------------------------------- */
+    char **papszTokens = GetNextLineTokens();
+    if( papszTokens == NULL )
+        return NULL;
+
+/* -------------------------------------------------------------------- */
+/*      Create the OGR feature.                                         */
+/* -------------------------------------------------------------------- */
+    OGRFeature *poFeature = AllocateFeature( poFeatureDefn );
+
+    TranslateTokens( papszTokens, poFeature );
 
     CSLDestroy( papszTokens );
 
@@ -1733,12 +1747,59 @@ OGRFeature *OGRCSVLayer::GetNextFeature()
                 || m_poAttrQuery->Evaluate( poFeature )) )
             break;
 
-        delete poFeature;
+        OGRFeature::DestroyFeature( poFeature );
     }
 
     return poFeature;
 }
 
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/*                                                                      */
+/*      Without filters, records are translated directly into the      */
+/*      batch.                                                          */
+/************************************************************************/
+
+int OGRCSVLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                      int nMaxFeatures )
+
+{
+    if( m_poFilterGeom != NULL || m_poAttrQuery != NULL )
+        return OGRLayer::GetNextFeatureBatch( poBatch, nMaxFeatures );
+
+    if( !ResetFeatureBatch( poBatch ) )
+        return 0;
+
+    if( bNeedRewindBeforeRead )
+        ResetReading();
+
+    if (fpCSV == NULL)
+        return 0;
+
+    while( poBatch->GetFeatureCount() < nMaxFeatures )
+    {
+        char **papszTokens = GetNextLineTokens();
+        if( papszTokens == NULL )
+            break;
+
+        if( poBatch->AddEmptyFeature( nNextFID ) < 0 )
+        {
+            CSLDestroy( papszTokens );
+            break;
+        }
+
+        TranslateTokens( papszTokens, poBatch );
+
+        CSLDestroy( papszTokens );
+
+        nNextFID++;
+
+        m_nFeaturesRead++;
+    }
+
+    return poBatch->GetFeatureCount();
+}
+
 /************************************************************************/
 /*                           TestCapability()                           */
 /************************************************************************/
@@ -50,7 +50,8 @@ OGRLayer::OGRLayer() :
     m_pszAttrQueryString(NULL),
     m_poAttrIndex(NULL),
     m_nRefCount(0),
-    m_nFeaturesRead(0)
+    m_nFeaturesRead(0),
+    m_poFeaturePool(NULL)
 {}
 
 /************************************************************************/
@@ -91,6 +92,9 @@ OGRLayer::~OGRLayer()
         OGRDestroyPreparedGeometry(m_pPreparedFilterGeom);
         m_pPreparedFilterGeom = NULL;
     }
+
+    if( m_poFeaturePool != NULL )
+        m_poFeaturePool->Release();
 }
 
 /************************************************************************/
@@ -549,6 +553,241 @@ OGRFeatureH OGR_L_GetNextFeature( OGRLayerH hLayer )
     return (OGRFeatureH) ((OGRLayer *)hLayer)->GetNextFeature();
 }
 
+/************************************************************************/
+/*                         ResetFeatureBatch()                          */
+/*                                                                      */
+/*      Common checks of GetNextFeatureBatch() implementations.         */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+int OGRLayer::ResetFeatureBatch( OGRFeatureBatch *poBatch )
+
+{
+    if( poBatch->GetDefnRef() != GetLayerDefn() )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Feature batch not created with the layer definition "
+                  "of layer %s", GetName() );
+        return FALSE;
+    }
+    poBatch->Reset();
+    return TRUE;
+}
+//! @endcond
+
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/************************************************************************/
+
+/**
+ * \brief Fetch the next available features from this layer, column by
+ * column.
+ *
+ * The features are read as GetNextFeature() would return them, taking into
+ * account the spatial and attribute filters, and are stored in the passed
+ * batch, replacing those of the previous call.
+ *
+ * The batch must have been created with the layer definition, as returned
+ * by GetLayerDefn(). Reusing the same batch for all the calls avoids
+ * allocating memory for each feature, as its buffers are kept from one
+ * call to the next.
+ *
+ * The default implementation calls GetNextFeature(). Drivers may
+ * implement it more efficiently, by filling the batch directly.
+ *
+ * This method is the same as the C function OGR_L_GetNextFeatureBatch().
+ *
+ * @param poBatch the batch to fill.
+ * @param nMaxFeatures maximum number of features to read.
+ *
+ * @return the number of features read, or 0 when no more features are
+ * available or in case of error.
+ *
+ * @since GDAL 2.2
+ */
+
+int OGRLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                   int nMaxFeatures )
+
+{
+    if( !ResetFeatureBatch(poBatch) )
+        return 0;
+
+    while( poBatch->GetFeatureCount() < nMaxFeatures )
+    {
+        OGRFeature *poFeature = GetNextFeature();
+        if( poFeature == NULL )
+            break;
+        const int iFeature = poBatch->AddFeature(poFeature);
+        OGRFeature::DestroyFeature(poFeature);
+        if( iFeature < 0 )
+            break;
+    }
+
+    return poBatch->GetFeatureCount();
+}
+
+/************************************************************************/
+/*                     OGR_L_GetNextFeatureBatch()                      */
+/************************************************************************/
+
+/**
+ * \brief Fetch the next available features from this layer, column by
+ * column.
+ *
+ * This function is the same as the C++ method
+ * OGRLayer::GetNextFeatureBatch().
+ *
+ * @param hLayer handle to the layer from which features are read.
+ * @param hBatch handle to a feature batch, created with OGR_FB_Create()
+ * from the layer definition.
+ * @param nMaxFeatures maximum number of features to read.
+ *
+ * @return the number of features read, or 0 when no more features are
+ * available or in case of error.
+ *
+ * @since GDAL 2.2
+ */
+
+int OGR_L_GetNextFeatureBatch( OGRLayerH hLayer, OGRFeatureBatchH hBatch,
+                               int nMaxFeatures )
+
+{
+    VALIDATE_POINTER1( hLayer, "OGR_L_GetNextFeatureBatch", 0 );
+    VALIDATE_POINTER1( hBatch, "OGR_L_GetNextFeatureBatch", 0 );
+
+    return ((OGRLayer *)hLayer)->GetNextFeatureBatch(
+                                    (OGRFeatureBatch *)hBatch, nMaxFeatures );
+}
+
+/************************************************************************/
+/*                         SetFeaturePooling()                          */
+/************************************************************************/
+
+/**
+ * \brief Set whether the layer may return features from a pool.
+ *
+ * When feature pooling is enabled, the features returned by
+ * GetNextFeature() may come from a OGRFeaturePool owned by the layer:
+ * destroying them with OGRFeature::DestroyFeature() or OGR_F_Destroy()
+ * gives them back to the layer, which reuses them for the next features,
+ * with their field values stored in memory that is recycled as well. This
+ * saves memory allocations in loops that destroy each feature before
+ * reading the next one. Features deleted with the delete operator are
+ * simply freed.
+ *
+ * Pooled features remain valid after pooling has been disabled or the
+ * layer destroyed, but they reference the layer definition as any feature
+ * does.
+ *
+ * Pooling is disabled by default. Drivers that do not support it ignore
+ * this setting.
+ *
+ * This method is the same as the C function OGR_L_SetFeaturePooling().
+ *
+ * @param bEnable TRUE to enable feature pooling, FALSE to disable it.
+ *
+ * @since GDAL 2.2
+ */
+
+void OGRLayer::SetFeaturePooling( int bEnable )
+
+{
+    if( m_poFeaturePool != NULL &&
+        (!bEnable || m_poFeaturePool->GetDefnRef() != GetLayerDefn()) )
+    {
+        m_poFeaturePool->Release();
+        m_poFeaturePool = NULL;
+    }
+    if( bEnable && m_poFeaturePool == NULL )
+        m_poFeaturePool = new OGRFeaturePool( GetLayerDefn() );
+}
+
+/************************************************************************/
+/*                      OGR_L_SetFeaturePooling()                       */
+/************************************************************************/
+
+/**
+ * \brief Set whether the layer may return features from a pool.
+ *
+ * This function is the same as the C++ method
+ * OGRLayer::SetFeaturePooling().
+ *
+ * @param hLayer handle to the layer.
+ * @param bEnable TRUE to enable feature pooling, FALSE to disable it.
+ *
+ * @since GDAL 2.2
+ */
+
+void OGR_L_SetFeaturePooling( OGRLayerH hLayer, int bEnable )
+
+{
+    VALIDATE_POINTER0( hLayer, "OGR_L_SetFeaturePooling" );
+
+    ((OGRLayer *)hLayer)->SetFeaturePooling( bEnable );
+}
+
+/************************************************************************/
+/*                         GetFeaturePooling()                          */
+/************************************************************************/
+
+/**
+ * \brief Return whether feature pooling is enabled on the layer.
+ *
+ * This method is the same as the C function OGR_L_GetFeaturePooling().
+ *
+ * @return TRUE if SetFeaturePooling() has enabled pooling, FALSE otherwise.
+ *
+ * @since GDAL 2.2
+ */
+
+int OGRLayer::GetFeaturePooling()
+
+{
+    return m_poFeaturePool != NULL;
+}
+
+/************************************************************************/
+/*                      OGR_L_GetFeaturePooling()                       */
+/************************************************************************/
+
+/**
+ * \brief Return whether feature pooling is enabled on the layer.
+ *
+ * This function is the same as the C++ method
+ * OGRLayer::GetFeaturePooling().
+ *
+ * @param hLayer handle to the layer.
+ * @return TRUE if pooling is enabled, FALSE otherwise.
+ *
+ * @since GDAL 2.2
+ */
+
+int OGR_L_GetFeaturePooling( OGRLayerH hLayer )
+
+{
+    VALIDATE_POINTER1( hLayer, "OGR_L_GetFeaturePooling", FALSE );
+
+    return ((OGRLayer *)hLayer)->GetFeaturePooling();
+}
+
+/************************************************************************/
+/*                          AllocateFeature()                           */
+/*                                                                      */
+/*      To be used by drivers to instantiate the features they return.  */
+/*      Takes them from the feature pool when pooling is enabled.       */
+/************************************************************************/
+
+//! @cond Doxygen_Suppress
+OGRFeature *OGRLayer::AllocateFeature( OGRFeatureDefn *poDefn )
+
+{
+    if( m_poFeaturePool != NULL && m_poFeaturePool->GetDefnRef() == poDefn )
+        return m_poFeaturePool->GetFeature();
+    return new OGRFeature( poDefn );
+}
+//! @endcond
+
 /************************************************************************/
 /*                       ConvertGeomsIfNecessary()                      */
 /************************************************************************/
@@ -109,6 +109,27 @@ OGRFeature *OGRLayerDecorator::GetFeature( GIntBig nFID )
     return m_poDecoratedLayer->GetFeature(nFID);
 }
 
+int         OGRLayerDecorator::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                                    int nMaxFeatures )
+{
+    if( !m_poDecoratedLayer ) return 0;
+    // Not forwarded to the decorated layer, as sub-classes may override
+    // GetNextFeature() to alter features.
+    return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures);
+}
+
+void        OGRLayerDecorator::SetFeaturePooling( int bEnable )
+{
+    if( !m_poDecoratedLayer ) return;
+    m_poDecoratedLayer->SetFeaturePooling(bEnable);
+}
+
+int         OGRLayerDecorator::GetFeaturePooling()
+{
+    if( !m_poDecoratedLayer ) return FALSE;
+    return m_poDecoratedLayer->GetFeaturePooling();
+}
+
 OGRErr      OGRLayerDecorator::ISetFeature( OGRFeature *poFeature )
 {
     if( !m_poDecoratedLayer ) return OGRERR_FAILURE;
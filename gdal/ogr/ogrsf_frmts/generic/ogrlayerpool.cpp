@@ -307,6 +307,21 @@ OGRFeature *OGRProxiedLayer::GetFeature( GIntBig nFID )
     return poUnderlyingLayer->GetFeature(nFID);
 }
 
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/************************************************************************/
+
+int         OGRProxiedLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                                  int nMaxFeatures )
+{
+    if( poUnderlyingLayer == NULL && !OpenUnderlyingLayer() ) return 0;
+    // The underlying layer may have been reopened since our layer
+    // definition was fetched.
+    if( poBatch->GetDefnRef() != poUnderlyingLayer->GetLayerDefn() )
+        return OGRLayer::GetNextFeatureBatch(poBatch, nMaxFeatures);
+    return poUnderlyingLayer->GetNextFeatureBatch(poBatch, nMaxFeatures);
+}
+
 /************************************************************************/
 /*                             ISetFeature()                             */
 /************************************************************************/
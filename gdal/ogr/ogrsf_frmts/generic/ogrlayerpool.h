@@ -122,6 +122,8 @@ class OGRProxiedLayer : public OGRAbstractProxiedLayer
     virtual OGRFeature *GetNextFeature();
     virtual OGRErr      SetNextByIndex( GIntBig nIndex );
     virtual OGRFeature *GetFeature( GIntBig nFID );
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures );
     virtual OGRErr      ISetFeature( OGRFeature *poFeature );
     virtual OGRErr      ICreateFeature( OGRFeature *poFeature );
     virtual OGRErr      DeleteFeature( GIntBig nFID );
@@ -105,6 +105,25 @@ OGRFeature *OGRMutexedLayer::GetFeature( GIntBig nFID )
     return OGRLayerDecorator::GetFeature(nFID);
 }
 
+int         OGRMutexedLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                                  int nMaxFeatures )
+{
+    CPLMutexHolderOptionalLockD(m_hMutex);
+    return OGRLayerDecorator::GetNextFeatureBatch(poBatch, nMaxFeatures);
+}
+
+void        OGRMutexedLayer::SetFeaturePooling( int bEnable )
+{
+    CPLMutexHolderOptionalLockD(m_hMutex);
+    OGRLayerDecorator::SetFeaturePooling(bEnable);
+}
+
+int         OGRMutexedLayer::GetFeaturePooling()
+{
+    CPLMutexHolderOptionalLockD(m_hMutex);
+    return OGRLayerDecorator::GetFeaturePooling();
+}
+
 OGRErr      OGRMutexedLayer::ISetFeature( OGRFeature *poFeature )
 {
     CPLMutexHolderOptionalLockD(m_hMutex);
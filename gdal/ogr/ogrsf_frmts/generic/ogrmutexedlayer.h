@@ -71,6 +71,10 @@ class CPL_DLL OGRMutexedLayer : public OGRLayerDecorator
     virtual OGRFeature *GetNextFeature();
     virtual OGRErr      SetNextByIndex( GIntBig nIndex );
     virtual OGRFeature *GetFeature( GIntBig nFID );
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures );
+    virtual void        SetFeaturePooling( int bEnable );
+    virtual int         GetFeaturePooling();
     virtual OGRErr      ISetFeature( OGRFeature *poFeature );
     virtual OGRErr      ICreateFeature( OGRFeature *poFeature );
     virtual OGRErr      DeleteFeature( GIntBig nFID );
@@ -273,7 +273,14 @@ class OGRGeoPackageLayer : public OGRLayer, public IOGRSQLiteGetSpatialWhere
     void                BuildFeatureDefn( const char *pszLayerName,
                                            sqlite3_stmt *hStmt );
 
+    bool                FetchNextRow();
+    template<class T> void TranslateFields( sqlite3_stmt* hStmt,
+                                            T* poTarget );
     OGRFeature*         TranslateFeature(sqlite3_stmt* hStmt);
+    bool                TranslateFeature( sqlite3_stmt* hStmt,
+                                          OGRFeatureBatch* poBatch );
+    int                 GetNextFeatureBatchFromStatement(
+                                OGRFeatureBatch *poBatch, int nMaxFeatures );
 
   public:
 
@@ -362,6 +369,8 @@ class OGRGeoPackageTableLayer CPL_FINAL : public OGRGeoPackageLayer
     OGRErr              SetAttributeFilter( const char *pszQuery );
     OGRErr              SyncToDisk();
     OGRFeature*         GetNextFeature();
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures );
     OGRFeature*         GetFeature(GIntBig nFID);
     OGRErr              StartTransaction();
     OGRErr              CommitTransaction();
@@ -112,28 +112,8 @@ OGRFeature *OGRGeoPackageLayer::GetNextFeature()
     /* -------------------------------------------------------------------- */
     /*      Fetch a record (unless otherwise instructed)                    */
     /* -------------------------------------------------------------------- */
-        if( bDoStep )
-        {
-            int rc = sqlite3_step( m_poQueryStatement );
-            if( rc != SQLITE_ROW )
-            {
-                if ( rc != SQLITE_DONE )
-                {
-                    sqlite3_reset(m_poQueryStatement);
-                    CPLError( CE_Failure, CPLE_AppDefined,
-                            "In GetNextRawFeature(): sqlite3_step() : %s",
-                            sqlite3_errmsg(m_poDS->GetDB()) );
-                }
-
-                ClearStatement();
-
-                return NULL;
-            }
-        }
-        else
-        {
-            bDoStep = true;
-        }
+        if( !FetchNextRow() )
+            return NULL;
 
         OGRFeature *poFeature = TranslateFeature(m_poQueryStatement);
         if( poFeature == NULL )
@@ -150,56 +130,84 @@ OGRFeature *OGRGeoPackageLayer::GetNextFeature()
 }
 
 /************************************************************************/
-/*                         TranslateFeature()                           */
+/*                            FetchNextRow()                            */
+/*                                                                      */
+/*      Step the query statement, unless the current row has not been   */
+/*      consumed yet.  Returns false at the end of the result set.      */
 /************************************************************************/
 
-OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
+bool OGRGeoPackageLayer::FetchNextRow()
 
 {
-/* -------------------------------------------------------------------- */
-/*      Create a feature from the current result.                       */
-/* -------------------------------------------------------------------- */
-    OGRFeature *poFeature = new OGRFeature( m_poFeatureDefn );
+    if( !bDoStep )
+    {
+        bDoStep = true;
+        return true;
+    }
 
-/* -------------------------------------------------------------------- */
-/*      Set FID if we have a column to set it from.                     */
-/* -------------------------------------------------------------------- */
-    if( iFIDCol >= 0 )
-        poFeature->SetFID( sqlite3_column_int64( hStmt, iFIDCol ) );
-    else
-        poFeature->SetFID( iNextShapeId );
+    int rc = sqlite3_step( m_poQueryStatement );
+    if( rc != SQLITE_ROW )
+    {
+        if ( rc != SQLITE_DONE )
+        {
+            sqlite3_reset(m_poQueryStatement);
+            CPLError( CE_Failure, CPLE_AppDefined,
+                    "In GetNextRawFeature(): sqlite3_step() : %s",
+                    sqlite3_errmsg(m_poDS->GetDB()) );
+        }
 
-    iNextShapeId++;
+        ClearStatement();
 
-    m_nFeaturesRead++;
+        return false;
+    }
+    return true;
+}
 
-/* -------------------------------------------------------------------- */
-/*      Process Geometry if we have a column.                           */
-/* -------------------------------------------------------------------- */
-    if( iGeomCol >= 0 )
+/************************************************************************/
+/*                  GetNextFeatureBatchFromStatement()                  */
+/*                                                                      */
+/*      Read the rows of the query statement directly into a feature    */
+/*      batch.  Only valid when no filter has to be evaluated on        */
+/*      the features.                                                   */
+/************************************************************************/
+
+int OGRGeoPackageLayer::GetNextFeatureBatchFromStatement(
+                                OGRFeatureBatch *poBatch, int nMaxFeatures )
+
+{
+    if( !ResetFeatureBatch(poBatch) )
+        return 0;
+
+    while( poBatch->GetFeatureCount() < nMaxFeatures )
     {
-        OGRGeomFieldDefn* poGeomFieldDefn = m_poFeatureDefn->GetGeomFieldDefn(0);
-        if ( sqlite3_column_type(hStmt, iGeomCol) != SQLITE_NULL &&
-            !poGeomFieldDefn->IsIgnored() )
+        if( m_poQueryStatement == NULL )
         {
-            OGRSpatialReference* poSrs = poGeomFieldDefn->GetSpatialRef();
-            int iGpkgSize = sqlite3_column_bytes(hStmt, iGeomCol);
-            // coverity[tainted_data_return]
-            GByte *pabyGpkg = (GByte *)sqlite3_column_blob(hStmt, iGeomCol);
-            OGRGeometry *poGeom = GPkgGeometryToOGR(pabyGpkg, iGpkgSize, poSrs);
-            if ( ! poGeom )
-            {
-                // Try also spatialite geometry blobs
-                if( OGRSQLiteLayer::ImportSpatiaLiteGeometry( pabyGpkg, iGpkgSize,
-                                                              &poGeom ) != OGRERR_NONE )
-                {
-                    CPLError( CE_Failure, CPLE_AppDefined, "Unable to read geometry");
-                }
-            }
-            poFeature->SetGeometryDirectly( poGeom );
+            ResetStatement();
+            if (m_poQueryStatement == NULL)
+                break;
         }
+
+        if( !FetchNextRow() )
+            break;
+
+        if( !TranslateFeature(m_poQueryStatement, poBatch) )
+            break;
     }
 
+    return poBatch->GetFeatureCount();
+}
+
+/************************************************************************/
+/*                          TranslateFields()                           */
+/*                                                                      */
+/*      Set the attribute fields of an OGRFeature or of the last        */
+/*      feature of an OGRFeatureBatch from the current result.          */
+/************************************************************************/
+
+template<class T> void OGRGeoPackageLayer::TranslateFields( sqlite3_stmt* hStmt,
+                                                            T* poTarget )
+
+{
 /* -------------------------------------------------------------------- */
 /*      set the fields.                                                 */
 /* -------------------------------------------------------------------- */
@@ -217,17 +225,17 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
         switch( poFieldDefn->GetType() )
         {
             case OFTInteger:
-                poFeature->SetField( iField,
+                poTarget->SetField( iField,
                     sqlite3_column_int( hStmt, iRawField ) );
                 break;
 
             case OFTInteger64:
-                poFeature->SetField( iField,
+                poTarget->SetField( iField,
                     sqlite3_column_int64( hStmt, iRawField ) );
                 break;
 
             case OFTReal:
-                poFeature->SetField( iField,
+                poTarget->SetField( iField,
                     sqlite3_column_double( hStmt, iRawField ) );
                 break;
 
@@ -237,7 +245,7 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
                 // coverity[tainted_data_return]
                 const GByte* pabyData = reinterpret_cast<const GByte*>(
                     sqlite3_column_blob( hStmt, iRawField ) );
-                poFeature->SetField( iField, nBytes,
+                poTarget->SetField( iField, nBytes,
                                      const_cast<GByte*>(pabyData) );
                 break;
             }
@@ -247,7 +255,7 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
                 const char* pszTxt = (const char*)sqlite3_column_text( hStmt, iRawField );
                 int nYear, nMonth, nDay;
                 if( sscanf(pszTxt, "%d-%d-%d", &nYear, &nMonth, &nDay) == 3 )
-                    poFeature->SetField(iField, nYear, nMonth, nDay, 0, 0, 0, 0);
+                    poTarget->SetField(iField, nYear, nMonth, nDay, 0, 0, 0, 0);
                 break;
             }
 
@@ -256,12 +264,12 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
                 const char* pszTxt = (const char*)sqlite3_column_text( hStmt, iRawField );
                 OGRField sField;
                 if( OGRParseXMLDateTime(pszTxt, &sField) )
-                    poFeature->SetField(iField, &sField);
+                    poTarget->SetField(iField, &sField);
                 break;
             }
 
             case OFTString:
-                poFeature->SetField( iField,
+                poTarget->SetField( iField,
                         (const char *) sqlite3_column_text( hStmt, iRawField ) );
                 break;
 
@@ -269,6 +277,219 @@ OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
                 break;
         }
     }
+}
+
+/************************************************************************/
+/*                       GPkgGetIsoNDRWKBSize()                         */
+/*                                                                      */
+/*      Return the size of the geometry at the start of pabyWKB if it   */
+/*      is ISO WKB in little endian byte order, made only of points,    */
+/*      line strings and polygons, and has consistent sizes.            */
+/*      Otherwise return 0.                                             */
+/************************************************************************/
+
+static size_t GPkgGetIsoNDRWKBSize( const GByte* pabyWKB, size_t nSize,
+                                    GUInt32 nParentType, int nDepth )
+
+{
+    if( nSize < 5 || pabyWKB[0] != wkbNDR || nDepth > 32 )
+        return 0;
+
+    GUInt32 nType = 0;
+    memcpy(&nType, pabyWKB + 1, 4);
+    CPL_LSBPTR32(&nType);
+    if( nType >= 4000 )
+        return 0;
+    const GUInt32 nFlatType = nType % 1000;
+    const GUInt32 nDimFlags = nType / 1000;  // 0: XY, 1: Z, 2: M, 3: ZM.
+    const size_t nPointSize =
+        sizeof(double) * (nDimFlags == 0 ? 2 : nDimFlags == 3 ? 4 : 3);
+
+    // Members of collections must have the dimensions of the collection,
+    // and the type of the members of multi geometries.
+    if( nParentType != 0 )
+    {
+        if( nDimFlags != nParentType / 1000 )
+            return 0;
+        const GUInt32 nParentFlatType = nParentType % 1000;
+        if( nParentFlatType != wkbGeometryCollection &&
+            nFlatType != nParentFlatType - 3 )
+            return 0;
+    }
+
+    if( nFlatType == wkbPoint )
+        return nSize >= 5 + nPointSize ? 5 + nPointSize : 0;
+
+    if( nSize < 9 )
+        return 0;
+    GUInt32 nCount = 0;
+    memcpy(&nCount, pabyWKB + 5, 4);
+    CPL_LSBPTR32(&nCount);
+    size_t nOffset = 9;
+
+    if( nFlatType == wkbLineString )
+    {
+        if( nCount > (nSize - nOffset) / nPointSize )
+            return 0;
+        return nOffset + nCount * nPointSize;
+    }
+
+    if( nFlatType == wkbPolygon )
+    {
+        for( GUInt32 i = 0; i < nCount; i++ )
+        {
+            if( nSize - nOffset < 4 )
+                return 0;
+            GUInt32 nPoints = 0;
+            memcpy(&nPoints, pabyWKB + nOffset, 4);
+            CPL_LSBPTR32(&nPoints);
+            nOffset += 4;
+            if( nPoints > (nSize - nOffset) / nPointSize )
+                return 0;
+            nOffset += nPoints * nPointSize;
+        }
+        return nOffset;
+    }
+
+    if( nFlatType >= wkbMultiPoint && nFlatType <= wkbGeometryCollection )
+    {
+        for( GUInt32 i = 0; i < nCount; i++ )
+        {
+            const size_t nSubSize =
+                GPkgGetIsoNDRWKBSize(pabyWKB + nOffset, nSize - nOffset,
+                                     nType, nDepth + 1);
+            if( nSubSize == 0 )
+                return 0;
+            nOffset += nSubSize;
+        }
+        return nOffset;
+    }
+
+    return 0;
+}
+
+/************************************************************************/
+/*                         TranslateFeature()                           */
+/*                                                                      */
+/*      Append the current result to a feature batch.                   */
+/************************************************************************/
+
+bool OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt,
+                                           OGRFeatureBatch* poBatch )
+
+{
+    const GIntBig nFID = iFIDCol >= 0 ?
+        sqlite3_column_int64( hStmt, iFIDCol ) : iNextShapeId;
+    if( poBatch->AddEmptyFeature( nFID ) < 0 )
+        return false;
+
+    iNextShapeId++;
+
+    m_nFeaturesRead++;
+
+/* -------------------------------------------------------------------- */
+/*      Process Geometry if we have a column.  Geometries that are      */
+/*      already ISO WKB in little endian byte order are copied          */
+/*      without being parsed.                                           */
+/* -------------------------------------------------------------------- */
+    if( iGeomCol >= 0 )
+    {
+        OGRGeomFieldDefn* poGeomFieldDefn = m_poFeatureDefn->GetGeomFieldDefn(0);
+        if ( sqlite3_column_type(hStmt, iGeomCol) != SQLITE_NULL &&
+            !poGeomFieldDefn->IsIgnored() )
+        {
+            int iGpkgSize = sqlite3_column_bytes(hStmt, iGeomCol);
+            // coverity[tainted_data_return]
+            GByte *pabyGpkg = (GByte *)sqlite3_column_blob(hStmt, iGeomCol);
+            GPkgHeader oHeader;
+            size_t nWKBSize = 0;
+            if( GPkgHeaderFromWKB(pabyGpkg, iGpkgSize, &oHeader) == OGRERR_NONE )
+            {
+                nWKBSize = GPkgGetIsoNDRWKBSize(pabyGpkg + oHeader.szHeader,
+                                                iGpkgSize - oHeader.szHeader,
+                                                0, 0);
+            }
+            if( nWKBSize > 0 )
+            {
+                poBatch->SetGeomFieldWKB( 0, pabyGpkg + oHeader.szHeader,
+                                          static_cast<int>(nWKBSize) );
+            }
+            else
+            {
+                OGRGeometry *poGeom = GPkgGeometryToOGR(pabyGpkg, iGpkgSize,
+                                                        NULL);
+                if ( ! poGeom )
+                {
+                    // Try also spatialite geometry blobs
+                    if( OGRSQLiteLayer::ImportSpatiaLiteGeometry(
+                                pabyGpkg, iGpkgSize, &poGeom ) != OGRERR_NONE )
+                    {
+                        CPLError( CE_Failure, CPLE_AppDefined,
+                                  "Unable to read geometry");
+                    }
+                }
+                poBatch->SetGeometryDirectly( poGeom );
+            }
+        }
+    }
+
+    TranslateFields( hStmt, poBatch );
+
+    return true;
+}
+
+/************************************************************************/
+/*                         TranslateFeature()                           */
+/************************************************************************/
+
+OGRFeature *OGRGeoPackageLayer::TranslateFeature( sqlite3_stmt* hStmt )
+
+{
+/* -------------------------------------------------------------------- */
+/*      Create a feature from the current result.                       */
+/* -------------------------------------------------------------------- */
+    OGRFeature *poFeature = new OGRFeature( m_poFeatureDefn );
+
+/* -------------------------------------------------------------------- */
+/*      Set FID if we have a column to set it from.                     */
+/* -------------------------------------------------------------------- */
+    if( iFIDCol >= 0 )
+        poFeature->SetFID( sqlite3_column_int64( hStmt, iFIDCol ) );
+    else
+        poFeature->SetFID( iNextShapeId );
+
+    iNextShapeId++;
+
+    m_nFeaturesRead++;
+
+/* -------------------------------------------------------------------- */
+/*      Process Geometry if we have a column.                           */
+/* -------------------------------------------------------------------- */
+    if( iGeomCol >= 0 )
+    {
+        OGRGeomFieldDefn* poGeomFieldDefn = m_poFeatureDefn->GetGeomFieldDefn(0);
+        if ( sqlite3_column_type(hStmt, iGeomCol) != SQLITE_NULL &&
+            !poGeomFieldDefn->IsIgnored() )
+        {
+            OGRSpatialReference* poSrs = poGeomFieldDefn->GetSpatialRef();
+            int iGpkgSize = sqlite3_column_bytes(hStmt, iGeomCol);
+            // coverity[tainted_data_return]
+            GByte *pabyGpkg = (GByte *)sqlite3_column_blob(hStmt, iGeomCol);
+            OGRGeometry *poGeom = GPkgGeometryToOGR(pabyGpkg, iGpkgSize, poSrs);
+            if ( ! poGeom )
+            {
+                // Try also spatialite geometry blobs
+                if( OGRSQLiteLayer::ImportSpatiaLiteGeometry( pabyGpkg, iGpkgSize,
+                                                              &poGeom ) != OGRERR_NONE )
+                {
+                    CPLError( CE_Failure, CPLE_AppDefined, "Unable to read geometry");
+                }
+            }
+            poFeature->SetGeometryDirectly( poGeom );
+        }
+    }
+
+    TranslateFields( hStmt, poFeature );
 
     return poFeature;
 }
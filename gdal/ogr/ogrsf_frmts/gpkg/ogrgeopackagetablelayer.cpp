@@ -1551,6 +1551,27 @@ OGRFeature* OGRGeoPackageTableLayer::GetNextFeature()
     return poFeature;
 }
 
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/************************************************************************/
+
+int OGRGeoPackageTableLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                                  int nMaxFeatures )
+{
+    // The attribute filter is part of the SQL request, but the spatial
+    // filter must be evaluated on each feature.
+    if( m_poFilterGeom != NULL || m_poAttrQuery != NULL ||
+        m_iFIDAsRegularColumnIndex >= 0 )
+        return OGRLayer::GetNextFeatureBatch( poBatch, nMaxFeatures );
+
+    if( m_bDeferredCreation && RunDeferredCreationIfNecessary() != OGRERR_NONE )
+        return 0;
+
+    CreateSpatialIndexIfNecessary();
+
+    return GetNextFeatureBatchFromStatement( poBatch, nMaxFeatures );
+}
+
 /************************************************************************/
 /*                        GetFeature()                                  */
 /************************************************************************/
@@ -84,6 +84,8 @@ class CPL_DLL OGRLayer : public GDALMajorObject
     int          InstallFilter( OGRGeometry * );
 
     OGRErr       GetExtentInternal(int iGeomField, OGREnvelope *psExtent, int bForce );
+    int          ResetFeatureBatch( OGRFeatureBatch *poBatch );
+    OGRFeature  *AllocateFeature( OGRFeatureDefn *poDefn );
 //! @endcond
 
     virtual OGRErr      ISetFeature( OGRFeature *poFeature ) CPL_WARN_UNUSED_RESULT;
@@ -109,6 +111,10 @@ class CPL_DLL OGRLayer : public GDALMajorObject
     virtual OGRFeature *GetNextFeature() CPL_WARN_UNUSED_RESULT = 0;
     virtual OGRErr      SetNextByIndex( GIntBig nIndex );
     virtual OGRFeature *GetFeature( GIntBig nFID )  CPL_WARN_UNUSED_RESULT;
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures );
+    virtual void        SetFeaturePooling( int bEnable );
+    virtual int         GetFeaturePooling();
 
     OGRErr      SetFeature( OGRFeature *poFeature )  CPL_WARN_UNUSED_RESULT;
     OGRErr      CreateFeature( OGRFeature *poFeature ) CPL_WARN_UNUSED_RESULT;
@@ -218,6 +224,8 @@ class CPL_DLL OGRLayer : public GDALMajorObject
     int                  m_nRefCount;
 
     GIntBig              m_nFeaturesRead;
+
+    OGRFeaturePool      *m_poFeaturePool;
 //! @endcond
 };
 
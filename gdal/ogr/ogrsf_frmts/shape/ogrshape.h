@@ -49,7 +49,12 @@
 /* ==================================================================== */
 OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                                OGRFeatureDefn * poDefn, int iShape,
-                               SHPObject *psShape, const char *pszSHPEncoding );
+                               SHPObject *psShape, const char *pszSHPEncoding,
+                               OGRFeaturePool *poPool = NULL );
+int SHPReadOGRFeatureBatch( SHPHandle hSHP, DBFHandle hDBF,
+                            OGRFeatureDefn * poDefn, OGRFeatureBatch *poBatch,
+                            int iShape, SHPObject *psShape,
+                            const char *pszSHPEncoding );
 OGRGeometry *SHPReadOGRObject( SHPHandle hSHP, int iShape, SHPObject *psShape );
 OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
                                        SHPHandle hSHP, DBFHandle hDBF,
@@ -207,6 +212,8 @@ class OGRShapeLayer CPL_FINAL: public OGRAbstractProxiedLayer
 
     void                ResetReading();
     OGRFeature *        GetNextFeature();
+    virtual int         GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                             int nMaxFeatures );
     virtual OGRErr      SetNextByIndex( GIntBig nIndex );
 
     OGRFeature         *GetFeature( GIntBig nFeatureId );
@@ -747,7 +747,8 @@ OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
             || psShape->nSHPType == SHPT_NULL )
         {
             poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+                                           iShapeId, psShape, osEncoding,
+                                           m_poFeaturePool );
         }
         else if( m_sFilterEnvelope.MaxX < psShape->dfXMin
                  || m_sFilterEnvelope.MaxY < psShape->dfYMin
@@ -760,13 +761,15 @@ OGRFeature *OGRShapeLayer::FetchShape( int iShapeId )
         else
         {
             poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                           iShapeId, psShape, osEncoding );
+                                           iShapeId, psShape, osEncoding,
+                                           m_poFeaturePool );
         }
     }
     else
     {
         poFeature = SHPReadOGRFeature( hSHP, hDBF, poFeatureDefn,
-                                       iShapeId, NULL, osEncoding );
+                                       iShapeId, NULL, osEncoding,
+                                       m_poFeaturePool );
     }
 
     return poFeature;
@@ -853,11 +856,52 @@ OGRFeature *OGRShapeLayer::GetNextFeature()
                 return poFeature;
             }
 
-            delete poFeature;
+            OGRFeature::DestroyFeature( poFeature );
         }
     }
 }
 
+/************************************************************************/
+/*                        GetNextFeatureBatch()                         */
+/*                                                                      */
+/*      Without filters, shapes are read directly into the batch.       */
+/************************************************************************/
+
+int OGRShapeLayer::GetNextFeatureBatch( OGRFeatureBatch *poBatch,
+                                        int nMaxFeatures )
+
+{
+    if( m_poAttrQuery != NULL || m_poFilterGeom != NULL )
+        return OGRLayer::GetNextFeatureBatch( poBatch, nMaxFeatures );
+
+    if( !TouchLayer() || !ResetFeatureBatch( poBatch ) )
+        return 0;
+
+    while( poBatch->GetFeatureCount() < nMaxFeatures &&
+           iNextShapeId < nTotalShapeCount )
+    {
+        if( hDBF )
+        {
+            if( DBFIsRecordDeleted( hDBF, iNextShapeId ) )
+            {
+                iNextShapeId++;
+                continue;
+            }
+            if( VSIFEofL(VSI_SHP_GetVSIL(hDBF->fp)) )
+                break;  // I/O error.
+        }
+
+        if( SHPReadOGRFeatureBatch( hSHP, hDBF, poFeatureDefn, poBatch,
+                                    iNextShapeId, NULL, osEncoding ) )
+        {
+            m_nFeaturesRead++;
+        }
+        iNextShapeId++;
+    }
+
+    return poBatch->GetFeatureCount();
+}
+
 /************************************************************************/
 /*                             GetFeature()                             */
 /************************************************************************/
@@ -1220,12 +1220,11 @@ OGRFeatureDefn *SHPReadOGRFeatureDefn( const char * pszName,
 }
 
 /************************************************************************/
-/*                         SHPReadOGRFeature()                          */
+/*                     SHPCheckReadOGRFeatureIndex()                    */
 /************************************************************************/
 
-OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
-                               OGRFeatureDefn * poDefn, int iShape,
-                               SHPObject *psShape, const char *pszSHPEncoding )
+static bool SHPCheckReadOGRFeatureIndex( SHPHandle hSHP, DBFHandle hDBF,
+                                         int iShape, SHPObject *psShape )
 
 {
     if( iShape < 0
@@ -1235,7 +1234,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
         CPLError( CE_Failure, CPLE_AppDefined,
                   "Attempt to read shape with feature id (%d) out of available"
                   " range.", iShape );
-        return NULL;
+        return false;
     }
 
     if( hDBF && DBFIsRecordDeleted( hDBF, iShape ) )
@@ -1246,13 +1245,28 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                   iShape );
         if( psShape != NULL )
             SHPDestroyObject(psShape);
-        return NULL;
+        return false;
     }
 
-    OGRFeature  *poFeature = new OGRFeature( poDefn );
+    return true;
+}
+
+/************************************************************************/
+/*                       SHPReadOGRFeatureContent()                     */
+/*                                                                      */
+/*      Read the geometry and attributes of a shape into an OGRFeature  */
+/*      or an OGRFeatureBatch.                                          */
+/************************************************************************/
+
+template<class T> static void SHPReadOGRFeatureContent(
+                                SHPHandle hSHP, DBFHandle hDBF,
+                                OGRFeatureDefn * poDefn, int iShape,
+                                SHPObject *psShape, const char *pszSHPEncoding,
+                                T* poTarget )
 
+{
 /* -------------------------------------------------------------------- */
-/*      Fetch geometry from Shapefile to OGRFeature.                    */
+/*      Fetch geometry from Shapefile to the target.                    */
 /* -------------------------------------------------------------------- */
     if( hSHP != NULL )
     {
@@ -1273,7 +1287,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
             {
                 // Set/unset flags.
                 const OGRwkbGeometryType eMyGeomType =
-                    poFeature->GetDefnRef()->GetGeomFieldDefn(0)->GetType();
+                    poDefn->GetGeomFieldDefn(0)->GetType();
 
                 if( eMyGeomType != wkbUnknown )
                 {
@@ -1298,7 +1312,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                 }
             }
 
-            poFeature->SetGeometryDirectly( poGeometry );
+            poTarget->SetGeometryDirectly( poGeometry );
         }
         else if( psShape != NULL )
         {
@@ -1307,7 +1321,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
     }
 
 /* -------------------------------------------------------------------- */
-/*      Fetch feature attributes to OGRFeature fields.                  */
+/*      Fetch feature attributes to the target fields.                  */
 /* -------------------------------------------------------------------- */
 
     for( int iField = 0;
@@ -1330,11 +1344,11 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                 {
                     char * const pszUTF8Field =
                         CPLRecode( pszFieldVal, pszSHPEncoding, CPL_ENC_UTF8);
-                    poFeature->SetField( iField, pszUTF8Field );
+                    poTarget->SetField( iField, pszUTF8Field );
                     CPLFree( pszUTF8Field );
                 }
                 else
-                    poFeature->SetField( iField, pszFieldVal );
+                    poTarget->SetField( iField, pszFieldVal );
               }
               break;
           }
@@ -1343,7 +1357,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
           case OFTReal:
           {
               if( !DBFIsAttributeNULL( hDBF, iShape, iField ) )
-                  poFeature->SetField(
+                  poTarget->SetField(
                       iField,
                       DBFReadStringAttribute( hDBF, iShape, iField ) );
               break;
@@ -1380,7 +1394,7 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
                   sFld.Date.Day = static_cast<GByte>(nFullDate % 100);
               }
 
-              poFeature->SetField( iField, &sFld );
+              poTarget->SetField( iField, &sFld );
           }
           break;
 
@@ -1388,13 +1402,61 @@ OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
             CPLAssert( false );
         }
     }
+}
+
+/************************************************************************/
+/*                         SHPReadOGRFeature()                          */
+/************************************************************************/
+
+OGRFeature *SHPReadOGRFeature( SHPHandle hSHP, DBFHandle hDBF,
+                               OGRFeatureDefn * poDefn, int iShape,
+                               SHPObject *psShape, const char *pszSHPEncoding,
+                               OGRFeaturePool *poPool )
 
-    if( poFeature != NULL )
-        poFeature->SetFID( iShape );
+{
+    if( !SHPCheckReadOGRFeatureIndex( hSHP, hDBF, iShape, psShape ) )
+        return NULL;
+
+    OGRFeature  *poFeature = ( poPool != NULL ) ? poPool->GetFeature() :
+                                                  new OGRFeature( poDefn );
+
+    SHPReadOGRFeatureContent( hSHP, hDBF, poDefn, iShape, psShape,
+                              pszSHPEncoding, poFeature );
+
+    poFeature->SetFID( iShape );
 
     return poFeature;
 }
 
+/************************************************************************/
+/*                       SHPReadOGRFeatureBatch()                       */
+/*                                                                      */
+/*      Same as SHPReadOGRFeature(), but appending the feature to a     */
+/*      batch.                                                          */
+/************************************************************************/
+
+int SHPReadOGRFeatureBatch( SHPHandle hSHP, DBFHandle hDBF,
+                            OGRFeatureDefn * poDefn, OGRFeatureBatch *poBatch,
+                            int iShape, SHPObject *psShape,
+                            const char *pszSHPEncoding )
+
+{
+    if( !SHPCheckReadOGRFeatureIndex( hSHP, hDBF, iShape, psShape ) )
+        return FALSE;
+
+    if( poBatch->AddEmptyFeature( iShape ) < 0 )
+    {
+        if( psShape != NULL )
+            SHPDestroyObject( psShape );
+        return FALSE;
+    }
+
+    SHPReadOGRFeatureContent( hSHP, hDBF, poDefn, iShape, psShape,
+                              pszSHPEncoding, poBatch );
+
+    return TRUE;
+}
+
 /************************************************************************/
 /*                             GrowField()                              */
 /************************************************************************/
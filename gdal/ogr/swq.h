@@ -239,7 +239,7 @@ CPLErr swq_expr_compile2( const char *where_clause,
 /*
 ** Evaluation related.
 */
-int swq_test_like( const char *input, const char *pattern );
+int swq_test_like( const char *input, const char *pattern, char chEscape );
 
 swq_expr_node *SWQGeneralEvaluator( swq_expr_node *, swq_expr_node **);
 swq_field_type SWQGeneralChecker( swq_expr_node *node, int bAllowMismatchTypeOnFieldComparison );
@@ -40,6 +40,8 @@ CPL_CVSID("$Id$");
 
 #define CPUID_SSE_EDX_BIT       25
 
+#define CPUID_AVX2_EBX_BIT      5
+
 #define BIT_XMM_STATE           (1 << 1)
 #define BIT_YMM_STATE           (2 << 1)
 
@@ -67,6 +69,25 @@ CPL_CVSID("$Id$");
 
 #define CPL_CPUID(level, array) GCC_CPUID(level, array[0], array[1], array[2], array[3])
 
+#if defined(__x86_64)
+#define GCC_CPUID_COUNT(level, count, a, b, c, d)  \
+  __asm__ ("xchgq %%rbx, %q1\n"                 \
+           "cpuid\n"                            \
+           "xchgq %%rbx, %q1"                   \
+       : "=a" (a), "=r" (b), "=c" (c), "=d" (d) \
+       : "0" (level), "2" (count))
+#else
+#define GCC_CPUID_COUNT(level, count, a, b, c, d)  \
+  __asm__ ("xchgl %%ebx, %1\n"                  \
+           "cpuid\n"                            \
+           "xchgl %%ebx, %1"                    \
+       : "=a" (a), "=r" (b), "=c" (c), "=d" (d) \
+       : "0" (level), "2" (count))
+#endif
+
+#define CPL_CPUID_COUNT(level, count, array) \
+    GCC_CPUID_COUNT(level, count, array[0], array[1], array[2], array[3])
+
 #elif defined(_MSC_VER) && defined(_M_IX86) && _MSC_VER <= 1310
 static void inline __cpuid( int cpuinfo[4], int level )
 {
@@ -94,6 +115,7 @@ static void inline __cpuid( int cpuinfo[4], int level )
 
 #include <intrin.h>
 #define CPL_CPUID(level, array) __cpuid(array, level)
+#define CPL_CPUID_COUNT(level, count, array) __cpuidex(array, level, count)
 
 #endif
 
@@ -211,4 +233,101 @@ int CPLHaveRuntimeAVX()
 
 #endif // defined(HAVE_AVX_AT_COMPILE_TIME) && !defined(CPLHaveRuntimeAVX)
 
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && !defined(HAVE_INLINE_AVX2)
+
+/************************************************************************/
+/*                         CPLHaveRuntimeAVX2()                         */
+/************************************************************************/
+
+#if defined(__GNUC__) && (defined(__i386__) ||defined(__x86_64))
+
+bool CPLHaveRuntimeAVX2()
+{
+#ifdef DEBUG
+    if( !CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX2", "YES")) )
+        return false;
+#endif
+    int cpuinfo[4] = {0,0,0,0};
+    CPL_CPUID(0, cpuinfo);
+    if( cpuinfo[REG_EAX] < 7 )
+        return false;
+
+    /* Check OSXSAVE and AVX features */
+    CPL_CPUID(1, cpuinfo);
+    if( (cpuinfo[REG_ECX] & (1 << CPUID_OSXSAVE_ECX_BIT)) == 0 ||
+        (cpuinfo[REG_ECX] & (1 << CPUID_AVX_ECX_BIT)) == 0 )
+    {
+        return false;
+    }
+
+    /* Check AVX2 feature */
+    CPL_CPUID_COUNT(7, 0, cpuinfo);
+    if( (cpuinfo[REG_EBX] & (1 << CPUID_AVX2_EBX_BIT)) == 0 )
+    {
+        return false;
+    }
+
+    /* Issue XGETBV and check the XMM and YMM state bit */
+    unsigned int nXCRLow;
+    unsigned int nXCRHigh;
+    __asm__ ("xgetbv" : "=a" (nXCRLow), "=d" (nXCRHigh) : "c" (0));
+    if( (nXCRLow & ( BIT_XMM_STATE | BIT_YMM_STATE )) !=
+                ( BIT_XMM_STATE | BIT_YMM_STATE ) )
+    {
+        return false;
+    }
+
+    return true;
+}
+
+#elif defined(_MSC_FULL_VER) && (_MSC_FULL_VER >= 160040219) && (defined(_M_IX86) || defined(_M_X64))
+
+bool CPLHaveRuntimeAVX2()
+{
+#ifdef DEBUG
+    if( !CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX2", "YES")) )
+        return false;
+#endif
+    int cpuinfo[4] = {0,0,0,0};
+    CPL_CPUID(0, cpuinfo);
+    if( cpuinfo[REG_EAX] < 7 )
+        return false;
+
+    /* Check OSXSAVE and AVX features */
+    CPL_CPUID(1, cpuinfo);
+    if( (cpuinfo[REG_ECX] & (1 << CPUID_OSXSAVE_ECX_BIT)) == 0 ||
+        (cpuinfo[REG_ECX] & (1 << CPUID_AVX_ECX_BIT)) == 0 )
+    {
+        return false;
+    }
+
+    /* Check AVX2 feature */
+    CPL_CPUID_COUNT(7, 0, cpuinfo);
+    if( (cpuinfo[REG_EBX] & (1 << CPUID_AVX2_EBX_BIT)) == 0 )
+    {
+        return false;
+    }
+
+    /* Issue XGETBV and check the XMM and YMM state bit */
+    unsigned __int64 xcrFeatureMask = _xgetbv(_XCR_XFEATURE_ENABLED_MASK);
+    if( (xcrFeatureMask & ( BIT_XMM_STATE | BIT_YMM_STATE )) !=
+                          ( BIT_XMM_STATE | BIT_YMM_STATE ) )
+    {
+        return false;
+    }
+
+    return true;
+}
+
+#else
+
+bool CPLHaveRuntimeAVX2()
+{
+    return false;
+}
+
+#endif
+
+#endif // defined(HAVE_AVX2_AT_COMPILE_TIME) && !defined(HAVE_INLINE_AVX2)
+
 //! @endcond
@@ -101,6 +101,12 @@ struct CPLVirtualMem
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <time.h>       /* clock_gettime */
+
+#include <algorithm>
+
+#include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 
 // FIXME? gcore/virtualmem.py tests fail/crash when HAVE_5ARGS_MREMAP
 // is not defined
@@ -172,6 +178,29 @@ typedef struct
     CPLVirtualMemCachePageCbk     pfnCachePage;       /* called when a page is mapped */
     CPLVirtualMemUnCachePageCbk   pfnUnCachePage;     /* called when a (writable) page is unmapped */
 
+    /* Protects the state of the pages, the statistics and the read-ahead */
+    /* state, and serializes the calls to the callbacks, between the helper */
+    /* thread and the prefetch job */
+    CPLMutex    *hMutexPages;
+
+    bool         bClockEviction;
+    GByte       *pabitReferencedPages;   /* pages accessed since last eviction round (CLOCK) */
+    GByte       *pabitDormantPages;      /* mapped pages made PROT_NONE to detect their access */
+
+    /* Read-ahead state. Pages in [iPrefetchNextPage, iPrefetchEndPage[ */
+    /* remain to be prefetched */
+    int          nMaxPrefetchPages;      /* 0 if read-ahead is disabled */
+    int          nPrefetchWindow;        /* current size of the read-ahead window */
+    int          iLastFaultPage;         /* last page filled on demand */
+    int          iPrefetchNextPage;
+    int          iPrefetchEndPage;
+    int          iPrefetchMarkerPage;    /* page whose access triggers the next window */
+    bool         bPrefetchJobPending;
+    bool         bStopPrefetch;
+    CPLCond     *hCondPrefetch;          /* signaled when the prefetch job ends */
+
+    CPLVirtualMemStats sStats;
+
 #ifndef HAVE_5ARGS_MREMAP
     CPLMutex               *hMutexThreadArray;
     int                     nThreads;
@@ -190,6 +219,9 @@ typedef struct
     int              pipefd_wait_thread[2];
     CPLJoinableThread *hHelperThread;
 
+    /* Worker threads that run the read-ahead of all mappings */
+    CPLWorkerThreadPool *poPrefetchPool;
+
     struct sigaction oldact;
 } CPLVirtualMemManager;
 
@@ -198,6 +230,7 @@ typedef struct
     void            *pFaultAddr;
     OpType           opType;
     pthread_t        hRequesterThread;
+    struct timespec  sFaultTime;
 } CPLVirtualMemMsgToWorkerThread;
 
 // TODO: Singletons.
@@ -414,6 +447,46 @@ CPLVirtualMem* CPLVirtualMemNew(size_t nSize,
     ctxt->pfnCachePage = pfnCachePage;
     ctxt->pfnUnCachePage = pfnUnCachePage;
 
+    ctxt->pabitReferencedPages = (GByte*)VSI_CALLOC_VERBOSE(1, (nRoundedMappingSize / nPageSize + 7) / 8);
+    ctxt->pabitDormantPages = (GByte*)VSI_CALLOC_VERBOSE(1, (nRoundedMappingSize / nPageSize + 7) / 8);
+    ctxt->hMutexPages = CPLCreateMutex();
+    if( ctxt->pabitReferencedPages == NULL ||
+        ctxt->pabitDormantPages == NULL || ctxt->hMutexPages == NULL )
+    {
+        CPLVirtualMemFreeFileMemoryMapped(ctxt);
+        CPLFree(ctxt);
+        return NULL;
+    }
+    CPLReleaseMutex(ctxt->hMutexPages);
+
+    ctxt->bClockEviction =
+        EQUAL(CPLGetConfigOption("CPL_VIRTUAL_MEM_EVICTION", "FIFO"), "CLOCK");
+
+/* -------------------------------------------------------------------- */
+/*      Setup read-ahead. Prefetched pages are filled in a temporary    */
+/*      page that is then remapped, as other threads keep running.      */
+/* -------------------------------------------------------------------- */
+    ctxt->iLastFaultPage = -1;
+    ctxt->iPrefetchMarkerPage = -1;
+#ifdef HAVE_5ARGS_MREMAP
+    if( CPLTestBool(CPLGetConfigOption("CPL_VIRTUAL_MEM_PREFETCH",
+                                       bSingleThreadUsage ? "NO" : "YES")) )
+    {
+        ctxt->nMaxPrefetchPages = std::min(
+            atoi(CPLGetConfigOption("CPL_VIRTUAL_MEM_PREFETCH_MAX_PAGES", "32")),
+            ctxt->nCacheMaxSizeInPages / 2);
+        // Not worth it with a tiny cache.
+        if( ctxt->nMaxPrefetchPages < 2 )
+            ctxt->nMaxPrefetchPages = 0;
+    }
+    if( ctxt->nMaxPrefetchPages > 0 )
+    {
+        ctxt->hCondPrefetch = CPLCreateCond();
+        if( ctxt->hCondPrefetch == NULL )
+            ctxt->nMaxPrefetchPages = 0;
+    }
+#endif
+
 #ifndef HAVE_5ARGS_MREMAP
     if( !ctxt->sBase.bSingleThreadUsage )
     {
@@ -432,6 +505,27 @@ CPLVirtualMem* CPLVirtualMemNew(size_t nSize,
         return NULL;
     }
 
+    if( ctxt->nMaxPrefetchPages > 0 )
+    {
+        CPLAcquireMutex(hVirtualMemManagerMutex, 1000.0);
+        if( pVirtualMemManager->poPrefetchPool == NULL )
+        {
+            const char* pszThreads =
+                CPLGetConfigOption("CPL_VIRTUAL_MEM_PREFETCH_THREADS", "2");
+            int nThreads = EQUAL(pszThreads, "ALL_CPUS") ?
+                                CPLGetNumCPUs() : atoi(pszThreads);
+            nThreads = std::max(1, std::min(nThreads, 128));
+            CPLWorkerThreadPool* poPool = new CPLWorkerThreadPool();
+            if( poPool->Setup(nThreads, NULL, NULL) )
+                pVirtualMemManager->poPrefetchPool = poPool;
+            else
+                delete poPool;
+        }
+        if( pVirtualMemManager->poPrefetchPool == NULL )
+            ctxt->nMaxPrefetchPages = 0;
+        CPLReleaseMutex(hVirtualMemManagerMutex);
+    }
+
     return (CPLVirtualMem*) ctxt;
 }
 
@@ -441,6 +535,16 @@ CPLVirtualMem* CPLVirtualMemNew(size_t nSize,
 
 static void CPLVirtualMemFreeFileMemoryMapped(CPLVirtualMemVMA* ctxt)
 {
+    /* Wait for the read-ahead of the mapping to be finished */
+    if( ctxt->hCondPrefetch != NULL )
+    {
+        CPLAcquireMutex(ctxt->hMutexPages, 1000.0);
+        ctxt->bStopPrefetch = true;
+        while( ctxt->bPrefetchJobPending )
+            CPLCondWait(ctxt->hCondPrefetch, ctxt->hMutexPages);
+        CPLReleaseMutex(ctxt->hMutexPages);
+    }
+
     CPLVirtualMemManagerUnregisterVirtualMem(ctxt);
 
     size_t nRoundedMappingSize = ((ctxt->sBase.nSize + 2 * ctxt->sBase.nPageSize - 1) /
@@ -454,6 +558,12 @@ static void CPLVirtualMemFreeFileMemoryMapped(CPLVirtualMemVMA* ctxt)
             if( TEST_BIT(ctxt->pabitRWMappedPages, i) )
             {
                 void* addr = (char*)ctxt->sBase.pData + i * ctxt->sBase.nPageSize;
+                if( TEST_BIT(ctxt->pabitDormantPages, i) )
+                {
+                    const int nRet =
+                        mprotect(addr, ctxt->sBase.nPageSize, PROT_READ);
+                    IGNORE_OR_ASSERT_IN_DEBUG(nRet == 0);
+                }
                 ctxt->pfnUnCachePage((CPLVirtualMem*)ctxt,
                                  i * ctxt->sBase.nPageSize,
                                  addr,
@@ -466,7 +576,13 @@ static void CPLVirtualMemFreeFileMemoryMapped(CPLVirtualMemVMA* ctxt)
     IGNORE_OR_ASSERT_IN_DEBUG(nRet == 0);
     CPLFree(ctxt->pabitMappedPages);
     CPLFree(ctxt->pabitRWMappedPages);
+    CPLFree(ctxt->pabitReferencedPages);
+    CPLFree(ctxt->pabitDormantPages);
     CPLFree(ctxt->panLRUPageIndices);
+    if( ctxt->hMutexPages != NULL )
+        CPLDestroyMutex(ctxt->hMutexPages);
+    if( ctxt->hCondPrefetch != NULL )
+        CPLDestroyCond(ctxt->hCondPrefetch);
 #ifndef HAVE_5ARGS_MREMAP
     if( !ctxt->sBase.bSingleThreadUsage )
     {
@@ -602,13 +718,39 @@ void* CPLVirtualMemGetPageToFill(CPLVirtualMemVMA* ctxt, void* start_page_addr)
 /*                        CPLVirtualMemAddPage()                        */
 /************************************************************************/
 
+/* If pPageToFill is not target_addr, it is a temporary page that is */
+/* remapped onto target_addr. bReferenced is set if the page is filled */
+/* because it is accessed. */
 static
 void CPLVirtualMemAddPage(CPLVirtualMemVMA* ctxt, void* target_addr, void* pPageToFill,
-                       OpType opType, pthread_t hRequesterThread)
+                       OpType opType, pthread_t hRequesterThread,
+                       bool bReferenced)
 {
     int iPage = static_cast<int>(((char*)target_addr - (char*)ctxt->sBase.pData) / ctxt->sBase.nPageSize);
     if( ctxt->nLRUSize == ctxt->nCacheMaxSizeInPages )
     {
+        if( ctxt->bClockEviction )
+        {
+            /* Give a second chance to the pages accessed since the */
+            /* previous round, and make them inaccessible to detect whether */
+            /* they are accessed again before the next one */
+            for( int i = 0; i < ctxt->nLRUSize; i++ )
+            {
+                const int nCandidatePage =
+                    ctxt->panLRUPageIndices[ctxt->iLRUStart];
+                if( !TEST_BIT(ctxt->pabitReferencedPages, nCandidatePage) )
+                    break;
+                UNSET_BIT(ctxt->pabitReferencedPages, nCandidatePage);
+                SET_BIT(ctxt->pabitDormantPages, nCandidatePage);
+                const int nRet =
+                    mprotect((char*)ctxt->sBase.pData +
+                                nCandidatePage * ctxt->sBase.nPageSize,
+                             ctxt->sBase.nPageSize, PROT_NONE);
+                IGNORE_OR_ASSERT_IN_DEBUG(nRet == 0);
+                ctxt->iLRUStart = (ctxt->iLRUStart + 1) % ctxt->nCacheMaxSizeInPages;
+            }
+        }
+
 #if defined DEBUG_VIRTUALMEM && defined DEBUG_VERBOSE
         fprintfstderr("uncaching page %d\n", iPage);
 #endif
@@ -618,6 +760,12 @@ void CPLVirtualMemAddPage(CPLVirtualMemVMA* ctxt, void* target_addr, void* pPage
             ctxt->pfnUnCachePage != NULL &&
             TEST_BIT(ctxt->pabitRWMappedPages, nOldPage) )
         {
+            if( TEST_BIT(ctxt->pabitDormantPages, nOldPage) )
+            {
+                const int nRet =
+                    mprotect(addr, ctxt->sBase.nPageSize, PROT_READ);
+                IGNORE_OR_ASSERT_IN_DEBUG(nRet == 0);
+            }
             size_t nToBeEvicted = ctxt->sBase.nPageSize;
             if( (char*)addr + nToBeEvicted >= (char*) ctxt->sBase.pData + ctxt->sBase.nSize )
                 nToBeEvicted = (char*) ctxt->sBase.pData + ctxt->sBase.nSize - (char*)addr;
@@ -631,6 +779,9 @@ void CPLVirtualMemAddPage(CPLVirtualMemVMA* ctxt, void* target_addr, void* pPage
         /* "Free" the least recently used page */
         UNSET_BIT(ctxt->pabitMappedPages, nOldPage);
         UNSET_BIT(ctxt->pabitRWMappedPages, nOldPage);
+        UNSET_BIT(ctxt->pabitReferencedPages, nOldPage);
+        UNSET_BIT(ctxt->pabitDormantPages, nOldPage);
+        ctxt->sStats.nEvictedPages ++;
         /* Free the old page */
         /* Not sure how portable it is to do that that way... */
         const void * const pRet = mmap(addr, ctxt->sBase.nPageSize, PROT_NONE,
@@ -644,8 +795,10 @@ void CPLVirtualMemAddPage(CPLVirtualMemVMA* ctxt, void* target_addr, void* pPage
         ctxt->nLRUSize ++;
     }
     SET_BIT(ctxt->pabitMappedPages, iPage);
+    if( bReferenced )
+        SET_BIT(ctxt->pabitReferencedPages, iPage);
 
-    if( ctxt->sBase.bSingleThreadUsage )
+    if( ctxt->sBase.bSingleThreadUsage && pPageToFill == target_addr )
     {
         if( opType == OP_STORE && ctxt->sBase.eAccessMode == VIRTUALMEM_READWRITE )
         {
@@ -768,6 +921,156 @@ void CPLVirtualMemAddPage(CPLVirtualMemVMA* ctxt, void* target_addr, void* pPage
     }
 }
 
+/************************************************************************/
+/*                   CPLVirtualMemGetPageProtection()                   */
+/************************************************************************/
+
+/* Protection of a mapped page when it is accessible */
+static int CPLVirtualMemGetPageProtection(CPLVirtualMemVMA* ctxt, int iPage)
+{
+    if( ctxt->sBase.eAccessMode == VIRTUALMEM_READONLY ||
+        TEST_BIT(ctxt->pabitRWMappedPages, iPage) )
+        return PROT_READ | PROT_WRITE;
+    return PROT_READ;
+}
+
+/************************************************************************/
+/*                     CPLVirtualMemWakeUpPage()                        */
+/************************************************************************/
+
+/* Make accessible again a mapped page that was made inaccessible to */
+/* detect its access */
+static void CPLVirtualMemWakeUpPage(CPLVirtualMemVMA* ctxt, int iPage,
+                                    OpType opType)
+{
+    UNSET_BIT(ctxt->pabitDormantPages, iPage);
+    SET_BIT(ctxt->pabitReferencedPages, iPage);
+    if( opType != OP_LOAD &&
+        ctxt->sBase.eAccessMode == VIRTUALMEM_READWRITE )
+    {
+        SET_BIT(ctxt->pabitRWMappedPages, iPage);
+    }
+    const int nRet =
+        mprotect((char*)ctxt->sBase.pData + iPage * ctxt->sBase.nPageSize,
+                 ctxt->sBase.nPageSize,
+                 CPLVirtualMemGetPageProtection(ctxt, iPage));
+    IGNORE_OR_ASSERT_IN_DEBUG(nRet == 0);
+}
+
+/************************************************************************/
+/*                       CPLVirtualMemPrefetchJob()                     */
+/************************************************************************/
+
+static void CPLVirtualMemPrefetchJob(void* pData)
+{
+    CPLVirtualMemVMA* ctxt = static_cast<CPLVirtualMemVMA*>(pData);
+    const size_t nPageSize = ctxt->sBase.nPageSize;
+
+    CPLAcquireMutex(ctxt->hMutexPages, 1000.0);
+    while( !ctxt->bStopPrefetch &&
+           ctxt->iPrefetchNextPage < ctxt->iPrefetchEndPage )
+    {
+        const int iPage = ctxt->iPrefetchNextPage;
+        ctxt->iPrefetchNextPage ++;
+        if( TEST_BIT(ctxt->pabitMappedPages, iPage) )
+            continue;
+
+        char * const start_page_addr =
+            (char*)ctxt->sBase.pData + iPage * nPageSize;
+        void * const pPageToFill = mmap(NULL, nPageSize,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if( pPageToFill == MAP_FAILED )
+            break;
+
+        size_t nToFill = nPageSize;
+        if( start_page_addr + nToFill >= (char*) ctxt->sBase.pData + ctxt->sBase.nSize )
+            nToFill = (char*) ctxt->sBase.pData + ctxt->sBase.nSize - start_page_addr;
+
+        ctxt->pfnCachePage(
+                (CPLVirtualMem*)ctxt,
+                start_page_addr - (char*) ctxt->sBase.pData,
+                pPageToFill,
+                nToFill,
+                ctxt->sBase.pCbkUserData);
+
+        CPLVirtualMemAddPage(ctxt, start_page_addr, pPageToFill,
+                             OP_LOAD, pthread_self(), false);
+        ctxt->sStats.nPrefetchedPages ++;
+
+        /* The access to the first page of the window will schedule the */
+        /* next one */
+        if( iPage == ctxt->iPrefetchMarkerPage )
+        {
+            SET_BIT(ctxt->pabitDormantPages, iPage);
+            const int nRet = mprotect(start_page_addr, nPageSize, PROT_NONE);
+            IGNORE_OR_ASSERT_IN_DEBUG(nRet == 0);
+        }
+
+        /* Let the helper thread service the pending faults */
+        CPLReleaseMutex(ctxt->hMutexPages);
+        CPLAcquireMutex(ctxt->hMutexPages, 1000.0);
+    }
+    ctxt->bPrefetchJobPending = false;
+    CPLCondSignal(ctxt->hCondPrefetch);
+    CPLReleaseMutex(ctxt->hMutexPages);
+}
+
+/************************************************************************/
+/*                   CPLVirtualMemUpdateReadAhead()                     */
+/************************************************************************/
+
+/* Called by the helper thread, with hMutexPages held, when a page has */
+/* been filled on demand (bMarker = false), or when the first page of a */
+/* read-ahead window is accessed (bMarker = true). */
+static void CPLVirtualMemUpdateReadAhead(CPLVirtualMemVMA* ctxt, int iPage,
+                                         bool bMarker)
+{
+    if( ctxt->nMaxPrefetchPages == 0 )
+        return;
+
+    const bool bSequential =
+        bMarker || iPage == ctxt->iLastFaultPage + 1 ||
+        (ctxt->nPrefetchWindow > 0 && iPage >= ctxt->iPrefetchNextPage &&
+         iPage <= ctxt->iPrefetchEndPage);
+    ctxt->iLastFaultPage = iPage;
+    if( !bSequential )
+    {
+        /* Random access: cancel the pending read-ahead */
+        ctxt->nPrefetchWindow = 0;
+        ctxt->iPrefetchEndPage = ctxt->iPrefetchNextPage;
+        ctxt->iPrefetchMarkerPage = -1;
+        return;
+    }
+
+    ctxt->nPrefetchWindow = (ctxt->nPrefetchWindow == 0) ?
+        std::min(4, ctxt->nMaxPrefetchPages) :
+        std::min(2 * ctxt->nPrefetchWindow, ctxt->nMaxPrefetchPages);
+
+    const int nPages = static_cast<int>(
+        (ctxt->sBase.nSize + ctxt->sBase.nPageSize - 1) / ctxt->sBase.nPageSize);
+    if( ctxt->iPrefetchNextPage <= iPage )
+        ctxt->iPrefetchNextPage = iPage + 1;
+    const int iWindowStart =
+        std::max(ctxt->iPrefetchNextPage, ctxt->iPrefetchEndPage);
+    ctxt->iPrefetchEndPage =
+        std::min(nPages, std::max(ctxt->iPrefetchEndPage,
+                                  iPage + 1 + ctxt->nPrefetchWindow));
+    if( iWindowStart >= ctxt->iPrefetchEndPage )
+        return;
+    ctxt->iPrefetchMarkerPage = iWindowStart;
+
+    if( !ctxt->bPrefetchJobPending && !ctxt->bStopPrefetch )
+    {
+        ctxt->bPrefetchJobPending = true;
+        if( !pVirtualMemManager->poPrefetchPool->SubmitJob(
+                                        CPLVirtualMemPrefetchJob, ctxt) )
+        {
+            ctxt->bPrefetchJobPending = false;
+        }
+    }
+}
+
 /************************************************************************/
 /*                    CPLVirtualMemGetOpTypeImm()                       */
 /************************************************************************/
@@ -1539,6 +1842,7 @@ void CPLVirtualMemPin(CPLVirtualMem* ctxt,
     for(i=0; i<n; i++)
     {
         msg.pFaultAddr = (char*) pBase + i * ctxt->nPageSize;
+        clock_gettime(CLOCK_MONOTONIC, &msg.sFaultTime);
         CPLVirtualMemManagerPinAddrInternal(&msg);
     }
 }
@@ -1570,6 +1874,8 @@ static void CPLVirtualMemManagerSIGSEGVHandler(int the_signal,
     msg.pFaultAddr = the_info->si_addr;
     msg.hRequesterThread = pthread_self();
     msg.opType = OP_UNKNOWN;
+    /* clock_gettime() is async-signal-safe */
+    clock_gettime(CLOCK_MONOTONIC, &msg.sFaultTime);
 
 #if defined(__x86_64__) || defined(__i386__)
     ucontext_t* the_ucontext = (ucontext_t* )the_ctxt;
@@ -1693,7 +1999,18 @@ static void CPLVirtualMemManagerThread(void* unused_param)
                 ((char*)start_page_addr -
                  (char*)ctxt->sBase.pData) / ctxt->sBase.nPageSize);
 
-            if( iPage == ctxt->iLastPage )
+            CPLAcquireMutex(ctxt->hMutexPages, 1000.0);
+
+            if( TEST_BIT(ctxt->pabitDormantPages, iPage) )
+            {
+                /* Page made inaccessible by the CLOCK eviction or as */
+                /* read-ahead marker: its content is still there */
+                CPLVirtualMemWakeUpPage(ctxt, iPage, msg.opType);
+                ctxt->sStats.nSoftFaults ++;
+                if( iPage == ctxt->iPrefetchMarkerPage )
+                    CPLVirtualMemUpdateReadAhead(ctxt, iPage, true);
+            }
+            else if( iPage == ctxt->iLastPage )
             {
                 /* In case 2 threads try to access the same page */
                 /* concurrently it is possible that we are asked to mapped */
@@ -1709,8 +2026,10 @@ static void CPLVirtualMemManagerThread(void* unused_param)
                 fprintfstderr("retry on page %d : %d\n",
                               iPage, ctxt->nRetry);
 #endif
+                ctxt->sStats.nSoftFaults ++;
                 if( ctxt->nRetry >= 100 )
                 {
+                    CPLReleaseMutex(ctxt->hMutexPages);
                     CPLError(CE_Failure, CPLE_AppDefined,
                              "CPLVirtualMemManagerThread: trying to "
                              "write into read-only mapping");
@@ -1741,6 +2060,7 @@ static void CPLVirtualMemManagerThread(void* unused_param)
 
                 if( TEST_BIT(ctxt->pabitMappedPages, iPage) )
                 {
+                    ctxt->sStats.nSoftFaults ++;
                     if( msg.opType != OP_LOAD &&
                         ctxt->sBase.eAccessMode == VIRTUALMEM_READWRITE &&
                         !TEST_BIT(ctxt->pabitRWMappedPages, iPage) )
@@ -1782,10 +2102,24 @@ static void CPLVirtualMemManagerThread(void* unused_param)
                     /* Now remap this page to its target address and */
                     /* register it in the LRU */
                     CPLVirtualMemAddPage(ctxt, start_page_addr, pPageToFill,
-                                      msg.opType, msg.hRequesterThread);
+                                      msg.opType, msg.hRequesterThread, true);
+                    ctxt->sStats.nPageFaults ++;
+
+                    CPLVirtualMemUpdateReadAhead(ctxt, iPage, false);
                 }
             }
 
+            struct timespec sNow;
+            clock_gettime(CLOCK_MONOTONIC, &sNow);
+            const double dfWaitTime =
+                static_cast<double>(sNow.tv_sec - msg.sFaultTime.tv_sec) +
+                static_cast<double>(sNow.tv_nsec - msg.sFaultTime.tv_nsec) * 1e-9;
+            ctxt->sStats.dfFaultWaitTime += dfWaitTime;
+            ctxt->sStats.dfMaxFaultWaitTime =
+                std::max(ctxt->sStats.dfMaxFaultWaitTime, dfWaitTime);
+
+            CPLReleaseMutex(ctxt->hMutexPages);
+
             /* Warn the segfault handler that we have finished our job */
             nRetWrite = write(pVirtualMemManager->pipefd_from_thread[1],
                             MAPPING_FOUND, 4);
@@ -1822,6 +2156,7 @@ static bool CPLVirtualMemManagerInit(void)
         return false;
     pVirtualMemManager->pasVirtualMem = NULL;
     pVirtualMemManager->nVirtualMemCount = 0;
+    pVirtualMemManager->poPrefetchPool = NULL;
     int nRet = pipe(pVirtualMemManager->pipefd_to_thread);
     IGNORE_OR_ASSERT_IN_DEBUG(nRet == 0);
     nRet = pipe(pVirtualMemManager->pipefd_from_thread);
@@ -1881,6 +2216,8 @@ void CPLVirtualMemManagerTerminate(void)
         CPLVirtualMemFree((CPLVirtualMem*)pVirtualMemManager->pasVirtualMem[pVirtualMemManager->nVirtualMemCount - 1]);
     CPLFree(pVirtualMemManager->pasVirtualMem);
 
+    delete pVirtualMemManager->poPrefetchPool;
+
     close(pVirtualMemManager->pipefd_to_thread[0]);
     close(pVirtualMemManager->pipefd_to_thread[1]);
     close(pVirtualMemManager->pipefd_from_thread[0]);
@@ -2180,6 +2517,47 @@ int CPLVirtualMemIsAccessThreadSafe(CPLVirtualMem* ctxt)
     return !ctxt->bSingleThreadUsage;
 }
 
+/************************************************************************/
+/*                        CPLVirtualMemGetStats()                       */
+/************************************************************************/
+
+int CPLVirtualMemGetStats(CPLVirtualMem* ctxt, CPLVirtualMemStats* psStats)
+{
+    memset(psStats, 0, sizeof(CPLVirtualMemStats));
+    if( ctxt->pVMemBase != NULL )
+        ctxt = ctxt->pVMemBase;
+#ifdef HAVE_VIRTUAL_MEM_VMA
+    if( ctxt->eType == VIRTUAL_MEM_TYPE_VMA )
+    {
+        CPLVirtualMemVMA* ctxtVMA = reinterpret_cast<CPLVirtualMemVMA*>(ctxt);
+        CPLAcquireMutex(ctxtVMA->hMutexPages, 1000.0);
+        *psStats = ctxtVMA->sStats;
+        CPLReleaseMutex(ctxtVMA->hMutexPages);
+        return TRUE;
+    }
+#endif
+    return FALSE;
+}
+
+/************************************************************************/
+/*                       CPLVirtualMemResetStats()                      */
+/************************************************************************/
+
+void CPLVirtualMemResetStats(CPLVirtualMem* ctxt)
+{
+    if( ctxt->pVMemBase != NULL )
+        ctxt = ctxt->pVMemBase;
+#ifdef HAVE_VIRTUAL_MEM_VMA
+    if( ctxt->eType == VIRTUAL_MEM_TYPE_VMA )
+    {
+        CPLVirtualMemVMA* ctxtVMA = reinterpret_cast<CPLVirtualMemVMA*>(ctxt);
+        CPLAcquireMutex(ctxtVMA->hMutexPages, 1000.0);
+        memset(&ctxtVMA->sStats, 0, sizeof(CPLVirtualMemStats));
+        CPLReleaseMutex(ctxtVMA->hMutexPages);
+    }
+#endif
+}
+
 /************************************************************************/
 /*                       CPLVirtualMemDerivedNew()                      */
 /************************************************************************/
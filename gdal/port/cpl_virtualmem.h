@@ -135,6 +135,27 @@ size_t CPL_DLL CPLGetPageSize(void);
  * Note that on Linux, this function will install a SIGSEGV handler. The
  * original handler will be restored by CPLVirtualMemManagerTerminate().
  *
+ * Starting with GDAL 2.2, when pages are accessed in sequence, the following
+ * pages are filled ahead of their access by a pool of worker threads, with a
+ * read-ahead window that doubles as long as the sequential access goes on.
+ * As pfnCachePage might then be called while the threads that use the
+ * mapping keep running, this is only enabled by default when
+ * bSingleThreadUsage = FALSE. The following configuration options, read when
+ * the mapping is created, control that behaviour and the cache:
+ * <ul>
+ * <li>CPL_VIRTUAL_MEM_PREFETCH=YES/NO: whether to enable read-ahead.</li>
+ * <li>CPL_VIRTUAL_MEM_PREFETCH_MAX_PAGES=n: maximum size of the read-ahead
+ *     window, in pages. Defaults to 32, and is always capped to half the
+ *     number of pages of the cache.</li>
+ * <li>CPL_VIRTUAL_MEM_PREFETCH_THREADS=n or ALL_CPUS: number of worker threads
+ *     shared by all mappings. Defaults to 2.</li>
+ * <li>CPL_VIRTUAL_MEM_EVICTION=FIFO/CLOCK: when the cache is full, FIFO
+ *     (the default) evicts the page that was mapped first. CLOCK gives a
+ *     second chance to pages that have been accessed since the previous
+ *     eviction round, at the price of an extra fault per such access.</li>
+ * </ul>
+ * CPLVirtualMemGetStats() can be used to monitor the faults.
+ *
  * @param nSize size in bytes of the virtual memory mapping.
  * @param nCacheSize   size in bytes of the maximum memory that will be really
  *                     allocated (must ideally fit into RAM).
@@ -373,6 +394,54 @@ void CPL_DLL CPLVirtualMemUnDeclareThread(CPLVirtualMem* ctxt);
 void CPL_DLL CPLVirtualMemPin(CPLVirtualMem* ctxt,
                               void* pAddr, size_t nSize, int bWriteOp);
 
+/** Statistics on the faults of a virtual memory mapping.
+ *
+ * @since GDAL 2.2
+ */
+typedef struct
+{
+    /*! Number of pages filled by pfnCachePage when they were accessed. */
+    GUIntBig nPageFaults;
+    /*! Number of faults that did not require filling a page (first write
+        access to a page, access to a page under CLOCK eviction or to the
+        first page of a read-ahead window...). */
+    GUIntBig nSoftFaults;
+    /*! Number of pages filled ahead of their access. */
+    GUIntBig nPrefetchedPages;
+    /*! Number of pages evicted from the cache. */
+    GUIntBig nEvictedPages;
+    /*! Cumulated time, in seconds, during which threads were blocked on
+        faults. */
+    double   dfFaultWaitTime;
+    /*! Longest time, in seconds, a thread has been blocked on a fault. */
+    double   dfMaxFaultWaitTime;
+} CPLVirtualMemStats;
+
+/** Return statistics on the faults of a virtual memory mapping.
+ *
+ * Those statistics are cumulated since the creation of the mapping, or the
+ * last call to CPLVirtualMemResetStats(). For a mapping created with
+ * CPLVirtualMemDerivedNew(), the statistics of the base mapping are returned.
+ *
+ * @param ctxt context returned by CPLVirtualMemNew().
+ * @param psStats structure to fill.
+ * @return TRUE in case of success, or FALSE if the mapping does not involve
+ *         faults handled by GDAL (file mapping, or unsupported platform),
+ *         in which case psStats is zeroed.
+ *
+ * @since GDAL 2.2
+ */
+int CPL_DLL CPLVirtualMemGetStats(CPLVirtualMem* ctxt,
+                                  CPLVirtualMemStats* psStats);
+
+/** Reset the statistics on the faults of a virtual memory mapping.
+ *
+ * @param ctxt context returned by CPLVirtualMemNew().
+ *
+ * @since GDAL 2.2
+ */
+void CPL_DLL CPLVirtualMemResetStats(CPLVirtualMem* ctxt);
+
 /** Cleanup any resource and handlers related to virtual memory.
  *
  * This function must be called after the last CPLVirtualMem object has
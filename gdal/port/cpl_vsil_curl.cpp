@@ -29,11 +29,13 @@
 #include "cpl_vsi_virtual.h"
 #include "cpl_string.h"
 #include "cpl_multiproc.h"
+#include "cpl_atomic_ops.h"
 #include "cpl_hash_set.h"
 #include "cpl_time.h"
 #include "cpl_vsil_curl_priv.h"
 #include "cpl_aws.h"
 #include "cpl_minixml.h"
+#include "cpl_sha256.h"
 
 #include <algorithm>
 
@@ -83,11 +85,29 @@ void CPLHTTPSetOptions(CURL *http_handle, char** papszOptions);
 void VSICurlSetOptions(CURL* hCurlHandle, const char* pszURL);
 
 #include <map>
+#include <vector>
+
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
 
 #define ENABLE_DEBUG 1
 
 static const int N_MAX_REGIONS = 1000;
-static const int DOWNLOAD_CHUNK_SIZE = 16384;
+
+/************************************************************************/
+/*                    VSICURLGetDownloadChunkSize()                     */
+/************************************************************************/
+
+// Granularity of the downloads and of the region cache.
+static int VSICURLGetDownloadChunkSize()
+{
+    const int nVal = atoi(CPLGetConfigOption("CPL_VSIL_CURL_CHUNK_SIZE",
+                                             "16384"));
+    return std::max(1024, std::min(10 * 1024 * 1024, nVal));
+}
 
 namespace {
 
@@ -109,6 +129,8 @@ class CachedFileProp
     bool            bS3Redirect;
     time_t          nExpireTimestampLocal;
     CPLString       osRedirectURL;
+    CPLString       osETag;
+    CPLString       osLastModified;
 
                     CachedFileProp() : eExists(EXIST_UNKNOWN),
                                        bHasComputedFileSize(false),
@@ -161,6 +183,38 @@ static const char* VSICurlGetCacheFileName()
     return "gdal_vsicurl_cache.bin";
 }
 
+/************************************************************************/
+/*                      VSICurlGetHeaderValue()                         */
+/************************************************************************/
+
+// Return the value of the last occurrence of a HTTP header field (there
+// might be several responses in case of redirections).
+static CPLString VSICurlGetHeaderValue( const char* pszHeaders,
+                                        const char* pszKey )
+{
+    CPLString osValue;
+    const size_t nKeyLen = strlen(pszKey);
+    const char* pszIter = pszHeaders;
+    while( *pszIter != '\0' )
+    {
+        if( EQUALN(pszIter, pszKey, nKeyLen) && pszIter[nKeyLen] == ':' )
+        {
+            const char* pszValue = pszIter + nKeyLen + 1;
+            while( *pszValue == ' ' )
+                pszValue ++;
+            const char* pszEnd = pszValue;
+            while( *pszEnd != '\0' && *pszEnd != '\r' && *pszEnd != '\n' )
+                pszEnd ++;
+            osValue.assign(pszValue, pszEnd - pszValue);
+        }
+        const char* pszEOL = strchr(pszIter, '\n');
+        if( pszEOL == NULL )
+            break;
+        pszIter = pszEOL + 1;
+    }
+    return osValue;
+}
+
 /************************************************************************/
 /*          VSICurlFindStringSensitiveExceptEscapeSequences()           */
 /************************************************************************/
@@ -235,6 +289,7 @@ typedef struct
 {
     CPLString       osURL;
     CURL           *hCurlHandle;
+    CURLM          *hCurlMultiHandle;
 } CachedConnection;
 
 class VSICurlHandle;
@@ -248,6 +303,11 @@ class VSICurlFilesystemHandler : public VSIFilesystemHandler
     std::map<CPLString, CachedDirList*>        cacheDirList;
 
     bool            bUseCacheDisk;
+    int             nDownloadChunkSize;
+
+    /* Bytes written in the persistent cache since its last trimming */
+    GIntBig         nPersistentCacheBytesWritten;
+    bool            bPersistentCacheTrimmed;
 
     /* Per-thread Curl connection cache */
     std::map<GIntBig, CachedConnection*> mapConnections;
@@ -308,7 +368,29 @@ public:
     const CachedRegion* GetRegionFromCacheDisk(const char*     pszURL,
                                                vsi_l_offset nFileOffsetStart);
 
+    bool                GetPersistentCacheFilename(const char* pszURL,
+                                                   vsi_l_offset nFileOffsetStart,
+                                                   CPLString& osKey,
+                                                   CPLString& osFilename);
+    const CachedRegion* GetRegionFromPersistentCache(const char* pszURL,
+                                                     vsi_l_offset nFileOffsetStart);
+    void                AddRegionToPersistentCache(const char* pszURL,
+                                                   vsi_l_offset nFileOffsetStart,
+                                                   size_t nSize,
+                                                   const char* pData);
+    void                TrimPersistentCache(const CPLString& osCacheDir,
+                                            GIntBig nMaxSize);
+
     CURL               *GetCurlHandleFor(CPLString osURL);
+    CURLM              *GetCurlMultiHandleFor(CPLString osURL);
+
+    int                 GetDownloadChunkSize();
+
+  private:
+    CachedRegion*       AddRegionInMemory(const char*  pszURL,
+                                          vsi_l_offset nFileOffsetStart,
+                                          size_t       nSize,
+                                          const char  *pData);
 };
 
 /************************************************************************/
@@ -334,10 +416,19 @@ class VSICurlHandle : public VSIVirtualHandle
 
     vsi_l_offset    lastDownloadedOffset;
     int             nBlocksToDownload;
+    int             nDownloadChunkSize;
     bool            bEOF;
 
     bool            DownloadRegion(vsi_l_offset startOffset, int nBlocks);
 
+    int             ReadMultiRangeSingleGet( int nRanges, void ** ppData,
+                                             const vsi_l_offset* panOffsets,
+                                             const size_t* panSizes );
+    int             ReadMultiRangeParallel( int nRanges, void ** ppData,
+                                            const vsi_l_offset* panOffsets,
+                                            const size_t* panSizes,
+                                            int nMaxInFlight );
+
     VSICurlReadCbkFunc  pfnReadCbk;
     void               *pReadCbkUserData;
     bool                bStopOnInterruptUntilUninstall;
@@ -392,6 +483,7 @@ VSICurlHandle::VSICurlHandle(VSICurlFilesystemHandler* poFSIn, const char* pszUR
     curOffset(0),
     lastDownloadedOffset(VSI_L_OFFSET_MAX),
     nBlocksToDownload(1),
+    nDownloadChunkSize(poFSIn->GetDownloadChunkSize()),
     bEOF(false),
     pfnReadCbk(NULL),
     pReadCbkUserData(NULL),
@@ -905,6 +997,16 @@ retry:
                     osURL.c_str(), fileSize, (int)response_code);
     }
 
+    // Validators of the content, used by the persistent cache.
+    CPLString osETag;
+    CPLString osLastModified;
+    if( eExists == EXIST_YES && sWriteFuncHeaderData.pBuffer != NULL )
+    {
+        osETag = VSICurlGetHeaderValue(sWriteFuncHeaderData.pBuffer, "ETag");
+        osLastModified = VSICurlGetHeaderValue(sWriteFuncHeaderData.pBuffer,
+                                               "Last-Modified");
+    }
+
     CPLFree(sWriteFuncData.pBuffer);
     CPLFree(sWriteFuncHeaderData.pBuffer);
 
@@ -913,6 +1015,8 @@ retry:
     cachedFileProp->fileSize = fileSize;
     cachedFileProp->eExists = eExists;
     cachedFileProp->bIsDirectory = bIsDirectory;
+    cachedFileProp->osETag = osETag;
+    cachedFileProp->osLastModified = osLastModified;
 
     return fileSize;
 }
@@ -992,7 +1096,7 @@ retry:
     curl_easy_setopt(hCurlHandle, CURLOPT_HEADERFUNCTION, VSICurlHandleWriteFunc);
     sWriteFuncHeaderData.bIsHTTP = STARTS_WITH(pszURL, "http");
     sWriteFuncHeaderData.nStartOffset = startOffset;
-    sWriteFuncHeaderData.nEndOffset = startOffset + nBlocks * DOWNLOAD_CHUNK_SIZE - 1;
+    sWriteFuncHeaderData.nEndOffset = startOffset + nBlocks * nDownloadChunkSize - 1;
     /* Some servers don't like we try to read after end-of-file (#5786) */
     if( cachedFileProp->bHasComputedFileSize &&
         sWriteFuncHeaderData.nEndOffset >= cachedFileProp->fileSize )
@@ -1176,18 +1280,18 @@ retry:
         }
     }
 
-    lastDownloadedOffset = startOffset + nBlocks * DOWNLOAD_CHUNK_SIZE;
+    lastDownloadedOffset = startOffset + nBlocks * nDownloadChunkSize;
 
     char* pBuffer = sWriteFuncData.pBuffer;
     size_t nSize = sWriteFuncData.nSize;
 
-    if (nSize > static_cast<size_t>(nBlocks) * DOWNLOAD_CHUNK_SIZE)
+    if (nSize > static_cast<size_t>(nBlocks) * nDownloadChunkSize)
     {
         if (ENABLE_DEBUG)
             CPLDebug(
                 "VSICURL", "Got more data than expected : %u instead of %u",
                 static_cast<unsigned int>(nSize),
-                static_cast<unsigned int>(nBlocks * DOWNLOAD_CHUNK_SIZE));
+                static_cast<unsigned int>(nBlocks * nDownloadChunkSize));
     }
 
     vsi_l_offset l_startOffset = startOffset;
@@ -1200,10 +1304,10 @@ retry:
                 "Add region %u - %u",
                 static_cast<unsigned int>(startOffset),
                 static_cast<unsigned int>(
-                    std::min(static_cast<size_t>(DOWNLOAD_CHUNK_SIZE), nSize)));
+                    std::min(static_cast<size_t>(nDownloadChunkSize), nSize)));
 #endif
         const size_t nChunkSize =
-            std::min(static_cast<size_t>(DOWNLOAD_CHUNK_SIZE), nSize);
+            std::min(static_cast<size_t>(nDownloadChunkSize), nSize);
         poFS->AddRegion(pszURL, l_startOffset, nChunkSize, pBuffer);
         l_startOffset += nChunkSize;
         pBuffer += nChunkSize;
@@ -1236,7 +1340,7 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const  nSize, size_t
         if (psRegion == NULL)
         {
             vsi_l_offset nOffsetToDownload =
-                (iterOffset / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
+                (iterOffset / nDownloadChunkSize) * nDownloadChunkSize;
 
             if (nOffsetToDownload == lastDownloadedOffset)
             {
@@ -1256,16 +1360,16 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const  nSize, size_t
             /* Ensure that we will request at least the number of blocks */
             /* to satisfy the remaining buffer size to read */
             vsi_l_offset nEndOffsetToDownload =
-                ((iterOffset + nBufferRequestSize) / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
+                ((iterOffset + nBufferRequestSize) / nDownloadChunkSize) * nDownloadChunkSize;
             int nMinBlocksToDownload = 1 + (int)
-                ((nEndOffsetToDownload - nOffsetToDownload) / DOWNLOAD_CHUNK_SIZE);
+                ((nEndOffsetToDownload - nOffsetToDownload) / nDownloadChunkSize);
             if (nBlocksToDownload < nMinBlocksToDownload)
                 nBlocksToDownload = nMinBlocksToDownload;
 
             /* Avoid reading already cached data */
             for( int i=1; i < nBlocksToDownload; i++ )
             {
-                if (poFS->GetRegion(pszURL, nOffsetToDownload + i * DOWNLOAD_CHUNK_SIZE) != NULL)
+                if (poFS->GetRegion(pszURL, nOffsetToDownload + i * nDownloadChunkSize) != NULL)
                 {
                     nBlocksToDownload = i;
                     break;
@@ -1297,7 +1401,7 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const  nSize, size_t
         pBuffer = (char*) pBuffer + nToCopy;
         iterOffset += nToCopy;
         nBufferRequestSize -= nToCopy;
-        if (psRegion->nSize != (size_t)DOWNLOAD_CHUNK_SIZE && nBufferRequestSize != 0)
+        if (psRegion->nSize != (size_t)nDownloadChunkSize && nBufferRequestSize != 0)
         {
             break;
         }
@@ -1319,6 +1423,276 @@ size_t VSICurlHandle::Read( void * const pBufferIn, size_t const  nSize, size_t
 int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
                                    const vsi_l_offset* const panOffsets,
                                    const size_t* const panSizes )
+{
+    const char* pszStrategy =
+        CPLGetConfigOption("GDAL_HTTP_MULTIRANGE", "PARALLEL");
+    if( EQUAL(pszStrategy, "SINGLE_GET") )
+        return ReadMultiRangeSingleGet(nRanges, ppData, panOffsets, panSizes);
+
+    int nMaxInFlight = 1;
+    // Data must be passed in order to the read callback, and FTP servers
+    // generally limit the number of connections.
+    if( !EQUAL(pszStrategy, "SERIAL") && pfnReadCbk == NULL &&
+        STARTS_WITH(pszURL, "http") )
+    {
+        nMaxInFlight = atoi(CPLGetConfigOption(
+            "CPL_VSIL_CURL_MAX_PARALLEL_REQUESTS", "10"));
+        if( nMaxInFlight <= 0 )
+            nMaxInFlight = 10;
+    }
+    return ReadMultiRangeParallel(nRanges, ppData, panOffsets, panSizes,
+                                  nMaxInFlight);
+}
+
+/************************************************************************/
+/*                       VSICURLMultiWait()                             */
+/************************************************************************/
+
+static void VSICURLMultiWait( CURLM* hCurlMultiHandle )
+{
+#if LIBCURL_VERSION_NUM >= 0x071C00
+    int nFDs = 0;
+    curl_multi_wait(hCurlMultiHandle, NULL, 0, 1000, &nFDs);
+#else
+    (void)hCurlMultiHandle;
+    CPLSleep(0.005);
+#endif
+}
+
+/************************************************************************/
+/*                       ReadMultiRangeParallel()                       */
+/************************************************************************/
+
+// Fetch each set of contiguous ranges with its own range GET, with up to
+// nMaxInFlight concurrent requests.
+int VSICurlHandle::ReadMultiRangeParallel( int const nRanges,
+                                           void ** const ppData,
+                                           const vsi_l_offset* const panOffsets,
+                                           const size_t* const panSizes,
+                                           int nMaxInFlight )
+{
+    if (bInterrupted && bStopOnInterruptUntilUninstall)
+        return -1;
+
+    CachedFileProp* cachedFileProp = poFS->GetCachedFileProp(pszURL);
+    if (cachedFileProp->eExists == EXIST_NO)
+        return -1;
+
+    // Merge contiguous ranges.
+    std::vector<int> anFirstRange;
+    std::vector<int> anLastRange;
+    for( int i = 0; i < nRanges; i++ )
+    {
+        anFirstRange.push_back(i);
+        while( i + 1 < nRanges &&
+               panOffsets[i] + panSizes[i] == panOffsets[i+1] )
+        {
+            i ++;
+        }
+        anLastRange.push_back(i);
+    }
+    const int nRequests = static_cast<int>(anFirstRange.size());
+
+    if (ENABLE_DEBUG)
+        CPLDebug("VSICURL",
+                 "Downloading %d ranges with up to %d parallel requests (%s)",
+                 nRequests, nMaxInFlight, pszURL);
+
+    CURLM* hCurlMultiHandle = poFS->GetCurlMultiHandleFor(pszURL);
+
+    std::vector<CURL*> ahCurlHandles(nRequests, static_cast<CURL*>(NULL));
+    std::vector<WriteFuncStruct> asWriteFuncData(nRequests);
+    std::vector<WriteFuncStruct> asWriteFuncHeaderData(nRequests);
+    std::vector<struct curl_slist*> apsHeaders(nRequests,
+                                    static_cast<struct curl_slist*>(NULL));
+    std::vector<CPLString> aosRanges(nRequests);
+    std::vector<CPLString> aosCurlErrBuf(nRequests);
+    std::vector<bool> abDone(nRequests, false);
+
+    int iNextRequest = 0;
+    int nInFlight = 0;
+    bool bMultiError = false;
+    while( true )
+    {
+        // Keep up to nMaxInFlight requests running.
+        while( nInFlight < nMaxInFlight && iNextRequest < nRequests )
+        {
+            const int i = iNextRequest;
+            const vsi_l_offset nStartOffset = panOffsets[anFirstRange[i]];
+            const vsi_l_offset nEndOffset =
+                panOffsets[anLastRange[i]] + panSizes[anLastRange[i]] - 1;
+
+            CURL* hCurlHandle = curl_easy_init();
+            ahCurlHandles[i] = hCurlHandle;
+            VSICurlSetOptions(hCurlHandle, pszURL);
+
+            VSICURLInitWriteFuncStruct(&asWriteFuncData[i], (VSILFILE*)this,
+                                       pfnReadCbk, pReadCbkUserData);
+            curl_easy_setopt(hCurlHandle, CURLOPT_WRITEDATA,
+                             &asWriteFuncData[i]);
+            curl_easy_setopt(hCurlHandle, CURLOPT_WRITEFUNCTION,
+                             VSICurlHandleWriteFunc);
+
+            VSICURLInitWriteFuncStruct(&asWriteFuncHeaderData[i],
+                                       NULL, NULL, NULL);
+            curl_easy_setopt(hCurlHandle, CURLOPT_HEADERDATA,
+                             &asWriteFuncHeaderData[i]);
+            curl_easy_setopt(hCurlHandle, CURLOPT_HEADERFUNCTION,
+                             VSICurlHandleWriteFunc);
+            asWriteFuncHeaderData[i].bIsHTTP = STARTS_WITH(pszURL, "http");
+            asWriteFuncHeaderData[i].nStartOffset = nStartOffset;
+            asWriteFuncHeaderData[i].nEndOffset = nEndOffset;
+
+            aosRanges[i].Printf(CPL_FRMT_GUIB "-" CPL_FRMT_GUIB,
+                                nStartOffset, nEndOffset);
+            curl_easy_setopt(hCurlHandle, CURLOPT_RANGE,
+                             aosRanges[i].c_str());
+
+            aosCurlErrBuf[i].resize(CURL_ERROR_SIZE+1);
+            aosCurlErrBuf[i][0] = '\0';
+            curl_easy_setopt(hCurlHandle, CURLOPT_ERRORBUFFER,
+                             &aosCurlErrBuf[i][0] );
+
+            apsHeaders[i] = GetCurlHeaders("GET");
+            if( apsHeaders[i] != NULL )
+                curl_easy_setopt(hCurlHandle, CURLOPT_HTTPHEADER,
+                                 apsHeaders[i]);
+
+            curl_multi_add_handle(hCurlMultiHandle, hCurlHandle);
+            nInFlight ++;
+            iNextRequest ++;
+        }
+
+        int nRunning = 0;
+        CURLMcode eMultiRet = CURLM_OK;
+        do
+        {
+            eMultiRet = curl_multi_perform(hCurlMultiHandle, &nRunning);
+        } while( eMultiRet == CURLM_CALL_MULTI_PERFORM );
+        if( eMultiRet != CURLM_OK )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "curl_multi_perform() failed: %s",
+                     curl_multi_strerror(eMultiRet));
+            bMultiError = true;
+            break;
+        }
+
+        // Collect the completed requests.
+        int nMsgsInQueue = 0;
+        CURLMsg* psMsg = NULL;
+        while( (psMsg = curl_multi_info_read(hCurlMultiHandle,
+                                             &nMsgsInQueue)) != NULL )
+        {
+            if( psMsg->msg != CURLMSG_DONE )
+                continue;
+            for( int i = 0; i < iNextRequest; i++ )
+            {
+                if( ahCurlHandles[i] == psMsg->easy_handle && !abDone[i] )
+                {
+                    curl_multi_remove_handle(hCurlMultiHandle,
+                                             ahCurlHandles[i]);
+                    abDone[i] = true;
+                    nInFlight --;
+                    break;
+                }
+            }
+        }
+
+        if( nInFlight == 0 && iNextRequest == nRequests )
+            break;
+        if( nRunning > 0 )
+            VSICURLMultiWait(hCurlMultiHandle);
+    }
+
+    int nRet = bMultiError ? -1 : 0;
+    for( int i = 0; i < nRequests; i++ )
+    {
+        if( nRet != 0 )
+            break;
+
+        if (asWriteFuncData[i].bInterrupted)
+        {
+            bInterrupted = true;
+            nRet = -1;
+            break;
+        }
+
+        long response_code = 0;
+        curl_easy_getinfo(ahCurlHandles[i], CURLINFO_HTTP_CODE,
+                          &response_code);
+
+        if (ENABLE_DEBUG)
+            CPLDebug("VSICURL", "Got response_code=%ld for range %s",
+                     response_code, aosRanges[i].c_str());
+
+        if ((response_code != 200 && response_code != 206 &&
+             response_code != 225 && response_code != 226 &&
+             response_code != 426) ||
+            asWriteFuncHeaderData[i].bError)
+        {
+            const char* pszCurlErrBuf = aosCurlErrBuf[i].c_str();
+            if (response_code >= 400 && pszCurlErrBuf[0] != '\0')
+            {
+                if (strcmp(pszCurlErrBuf, "Couldn't use REST") == 0)
+                    CPLError(CE_Failure, CPLE_AppDefined, "%d: %s, %s",
+                             (int)response_code, pszCurlErrBuf,
+                             "Range downloading not supported by this server !");
+                else
+                    CPLError(CE_Failure, CPLE_AppDefined, "%d: %s",
+                             (int)response_code, pszCurlErrBuf);
+            }
+            nRet = -1;
+            break;
+        }
+
+        const vsi_l_offset nExpectedSize =
+            panOffsets[anLastRange[i]] + panSizes[anLastRange[i]] -
+            panOffsets[anFirstRange[i]];
+        if( static_cast<vsi_l_offset>(asWriteFuncData[i].nSize) <
+                                                            nExpectedSize )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Got only %d bytes for range %s",
+                     static_cast<int>(asWriteFuncData[i].nSize),
+                     aosRanges[i].c_str());
+            nRet = -1;
+            break;
+        }
+
+        size_t nAccSize = 0;
+        for( int iRange = anFirstRange[i]; iRange <= anLastRange[i]; iRange++ )
+        {
+            memcpy(ppData[iRange], asWriteFuncData[i].pBuffer + nAccSize,
+                   panSizes[iRange]);
+            nAccSize += panSizes[iRange];
+        }
+    }
+
+    for( int i = 0; i < iNextRequest; i++ )
+    {
+        if( !abDone[i] )
+            curl_multi_remove_handle(hCurlMultiHandle, ahCurlHandles[i]);
+        curl_easy_cleanup(ahCurlHandles[i]);
+        if( apsHeaders[i] != NULL )
+            curl_slist_free_all(apsHeaders[i]);
+        CPLFree(asWriteFuncData[i].pBuffer);
+        CPLFree(asWriteFuncHeaderData[i].pBuffer);
+    }
+
+    return nRet;
+}
+
+/************************************************************************/
+/*                      ReadMultiRangeSingleGet()                       */
+/************************************************************************/
+
+// Fetch all ranges with a single GET request, and parse the multipart
+// response.
+int VSICurlHandle::ReadMultiRangeSingleGet( int const nRanges,
+                                            void ** const ppData,
+                                            const vsi_l_offset* const panOffsets,
+                                            const size_t* const panSizes )
 {
     WriteFuncStruct sWriteFuncData;
     WriteFuncStruct sWriteFuncHeaderData;
@@ -1362,10 +1736,10 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
     if (nMergedRanges > nMaxRanges)
     {
         int nHalf = nRanges / 2;
-        int nRet = ReadMultiRange(nHalf, ppData, panOffsets, panSizes);
+        int nRet = ReadMultiRangeSingleGet(nHalf, ppData, panOffsets, panSizes);
         if (nRet != 0)
             return nRet;
-        return ReadMultiRange(nRanges - nHalf, ppData + nHalf, panOffsets + nHalf, panSizes + nHalf);
+        return ReadMultiRangeSingleGet(nRanges - nHalf, ppData + nHalf, panOffsets + nHalf, panSizes + nHalf);
     }
 
     CURL* hCurlHandle = poFS->GetCurlHandleFor(pszURL);
@@ -1717,6 +2091,24 @@ VSICurlFilesystemHandler::VSICurlFilesystemHandler()
     nRegions = 0;
     bUseCacheDisk =
         CPLTestBool(CPLGetConfigOption("CPL_VSIL_CURL_USE_CACHE", "NO"));
+    nDownloadChunkSize = 0;
+    nPersistentCacheBytesWritten = 0;
+    bPersistentCacheTrimmed = false;
+}
+
+/************************************************************************/
+/*                        GetDownloadChunkSize()                        */
+/************************************************************************/
+
+// Read when the first file is opened, so that the option can still be set
+// after the handler is installed, and then kept since changing it would
+// invalidate the cached regions.
+int VSICurlFilesystemHandler::GetDownloadChunkSize()
+{
+    CPLMutexHolder oHolder( &hMutex );
+    if( nDownloadChunkSize == 0 )
+        nDownloadChunkSize = VSICURLGetDownloadChunkSize();
+    return nDownloadChunkSize;
 }
 
 /************************************************************************/
@@ -1751,6 +2143,8 @@ VSICurlFilesystemHandler::~VSICurlFilesystemHandler()
     for( iterConnections = mapConnections.begin(); iterConnections != mapConnections.end(); iterConnections++ )
     {
         curl_easy_cleanup(iterConnections->second->hCurlHandle);
+        if( iterConnections->second->hCurlMultiHandle != NULL )
+            curl_multi_cleanup(iterConnections->second->hCurlMultiHandle);
         delete iterConnections->second;
     }
 
@@ -1776,6 +2170,7 @@ CURL* VSICurlFilesystemHandler::GetCurlHandleFor(CPLString osURL)
         CachedConnection* psCachedConnection = new CachedConnection;
         psCachedConnection->osURL = osURL;
         psCachedConnection->hCurlHandle = hCurlHandle;
+        psCachedConnection->hCurlMultiHandle = NULL;
         mapConnections[CPLGetPID()] = psCachedConnection;
         return hCurlHandle;
     }
@@ -1806,6 +2201,26 @@ CURL* VSICurlFilesystemHandler::GetCurlHandleFor(CPLString osURL)
     }
 }
 
+/************************************************************************/
+/*                      GetCurlMultiHandleFor()                         */
+/************************************************************************/
+
+// Per-thread multi handle, whose connection cache is shared by the easy
+// handles of concurrent requests, so that connections are reused from one
+// ReadMultiRange() call to another.
+CURLM* VSICurlFilesystemHandler::GetCurlMultiHandleFor(CPLString osURL)
+{
+    // Make sure the per-thread cached connection exists.
+    GetCurlHandleFor(osURL);
+
+    CPLMutexHolder oHolder( &hMutex );
+
+    CachedConnection* psCachedConnection = mapConnections[CPLGetPID()];
+    if( psCachedConnection->hCurlMultiHandle == NULL )
+        psCachedConnection->hCurlMultiHandle = curl_multi_init();
+    return psCachedConnection->hCurlMultiHandle;
+}
+
 /************************************************************************/
 /*                   GetRegionFromCacheDisk()                           */
 /************************************************************************/
@@ -1814,7 +2229,8 @@ const CachedRegion*
 VSICurlFilesystemHandler::GetRegionFromCacheDisk(const char* pszURL,
                                                  vsi_l_offset nFileOffsetStart)
 {
-    nFileOffsetStart = (nFileOffsetStart / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
+    const int nChunkSize = GetDownloadChunkSize();
+    nFileOffsetStart = (nFileOffsetStart / nChunkSize) * nChunkSize;
     VSILFILE* fp = VSIFOpenL(VSICurlGetCacheFileName(), "rb");
     if (fp)
     {
@@ -1843,12 +2259,12 @@ VSICurlFilesystemHandler::GetRegionFromCacheDisk(const char* pszURL,
                         CPLFree(pBuffer);
                         break;
                     }
-                    AddRegion(pszURL, nFileOffsetStart, nSizeCached, pBuffer);
+                    AddRegionInMemory(pszURL, nFileOffsetStart, nSizeCached, pBuffer);
                     CPLFree(pBuffer);
                 }
                 else
                 {
-                    AddRegion(pszURL, nFileOffsetStart, 0, NULL);
+                    AddRegionInMemory(pszURL, nFileOffsetStart, 0, NULL);
                 }
                 CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
                 return GetRegion(pszURL, nFileOffsetStart);
@@ -1924,36 +2340,40 @@ void VSICurlFilesystemHandler::AddRegionToCacheDisk(CachedRegion* psRegion)
 const CachedRegion* VSICurlFilesystemHandler::GetRegion(const char* pszURL,
                                                         vsi_l_offset nFileOffsetStart)
 {
-    CPLMutexHolder oHolder( &hMutex );
+    const int nChunkSize = GetDownloadChunkSize();
+    nFileOffsetStart = (nFileOffsetStart / nChunkSize) * nChunkSize;
 
-    unsigned long   pszURLHash = CPLHashSetHashStr(pszURL);
+    {
+        CPLMutexHolder oHolder( &hMutex );
 
-    nFileOffsetStart = (nFileOffsetStart / DOWNLOAD_CHUNK_SIZE) * DOWNLOAD_CHUNK_SIZE;
+        unsigned long   pszURLHash = CPLHashSetHashStr(pszURL);
 
-    for( int i=0; i < nRegions; i++ )
-    {
-        CachedRegion* psRegion = papsRegions[i];
-        if (psRegion->pszURLHash == pszURLHash &&
-            nFileOffsetStart == psRegion->nFileOffsetStart)
+        for( int i=0; i < nRegions; i++ )
         {
-            memmove(papsRegions + 1, papsRegions, i * sizeof(CachedRegion*));
-            papsRegions[0] = psRegion;
-            return psRegion;
+            CachedRegion* psRegion = papsRegions[i];
+            if (psRegion->pszURLHash == pszURLHash &&
+                nFileOffsetStart == psRegion->nFileOffsetStart)
+            {
+                memmove(papsRegions + 1, papsRegions, i * sizeof(CachedRegion*));
+                papsRegions[0] = psRegion;
+                return psRegion;
+            }
         }
+        if( bUseCacheDisk )
+            return GetRegionFromCacheDisk(pszURL, nFileOffsetStart);
     }
-    if( bUseCacheDisk )
-        return GetRegionFromCacheDisk(pszURL, nFileOffsetStart);
-    return NULL;
+
+    return GetRegionFromPersistentCache(pszURL, nFileOffsetStart);
 }
 
 /************************************************************************/
-/*                          AddRegion()                                 */
+/*                         AddRegionInMemory()                          */
 /************************************************************************/
 
-void  VSICurlFilesystemHandler::AddRegion(const char* pszURL,
-                                          vsi_l_offset    nFileOffsetStart,
-                                          size_t          nSize,
-                                          const char     *pData)
+CachedRegion* VSICurlFilesystemHandler::AddRegionInMemory(const char* pszURL,
+                                                    vsi_l_offset    nFileOffsetStart,
+                                                    size_t          nSize,
+                                                    const char     *pData)
 {
     CPLMutexHolder oHolder( &hMutex );
 
@@ -1983,8 +2403,332 @@ void  VSICurlFilesystemHandler::AddRegion(const char* pszURL,
     if (nSize)
         memcpy(psRegion->pData, pData, nSize);
 
-    if( bUseCacheDisk )
-        AddRegionToCacheDisk(psRegion);
+    return psRegion;
+}
+
+/************************************************************************/
+/*                          AddRegion()                                 */
+/************************************************************************/
+
+void  VSICurlFilesystemHandler::AddRegion(const char* pszURL,
+                                          vsi_l_offset    nFileOffsetStart,
+                                          size_t          nSize,
+                                          const char     *pData)
+{
+    {
+        CPLMutexHolder oHolder( &hMutex );
+
+        CachedRegion* psRegion =
+            AddRegionInMemory(pszURL, nFileOffsetStart, nSize, pData);
+
+        if( bUseCacheDisk )
+            AddRegionToCacheDisk(psRegion);
+    }
+
+    AddRegionToPersistentCache(pszURL, nFileOffsetStart, nSize, pData);
+}
+
+/************************************************************************/
+/*                     GetPersistentCacheFilename()                     */
+/************************************************************************/
+
+// The persistent cache is a directory, set with the
+// CPL_VSIL_CURL_PERSISTENT_CACHE_DIR configuration option, with one file per
+// downloaded chunk. The file name is the SHA256 hash of a key made of the
+// URL, of the ETag (or Last-Modified date) of the remote resource, of the
+// offset and of the chunk size, so that chunks of resources that have been
+// modified since they were cached are not used. The key is also stored in
+// the file and checked on reading.
+bool VSICurlFilesystemHandler::GetPersistentCacheFilename(
+    const char* pszURL, vsi_l_offset nFileOffsetStart,
+    CPLString& osKey, CPLString& osFilename )
+{
+    const char* pszCacheDir =
+        CPLGetConfigOption("CPL_VSIL_CURL_PERSISTENT_CACHE_DIR", NULL);
+    if( pszCacheDir == NULL || pszCacheDir[0] == '\0' )
+        return false;
+
+    CPLString osValidator;
+    {
+        CPLMutexHolder oHolder( &hMutex );
+
+        CachedFileProp* cachedFileProp = GetCachedFileProp(pszURL);
+        if( !cachedFileProp->osETag.empty() )
+            osValidator = "ETag: " + cachedFileProp->osETag;
+        else if( !cachedFileProp->osLastModified.empty() )
+            osValidator = "Last-Modified: " + cachedFileProp->osLastModified;
+        else if( cachedFileProp->mTime != 0 &&
+                 cachedFileProp->bHasComputedFileSize )
+            osValidator.Printf("mtime: " CPL_FRMT_GIB ", size: " CPL_FRMT_GUIB,
+                               static_cast<GIntBig>(cachedFileProp->mTime),
+                               cachedFileProp->fileSize);
+    }
+    // Without a way of knowing if the remote resource has changed, do not
+    // use the persistent cache.
+    if( osValidator.empty() )
+        return false;
+
+    osKey.Printf("%s\n%s\n" CPL_FRMT_GUIB "\n%d",
+                 pszURL, osValidator.c_str(), nFileOffsetStart,
+                 GetDownloadChunkSize());
+
+    GByte abyHash[CPL_SHA256_HASH_SIZE];
+    CPL_SHA256(osKey.c_str(), osKey.size(), abyHash);
+    char* pszHash = CPLBinaryToHex(CPL_SHA256_HASH_SIZE, abyHash);
+    // Spread files into 256 sub-directories.
+    const CPLString osSubDir(
+        CPLFormFilename(pszCacheDir, CPLString(pszHash).substr(0, 2).c_str(),
+                        NULL));
+    osFilename = CPLFormFilename(osSubDir, pszHash, NULL);
+    CPLFree(pszHash);
+    return true;
+}
+
+static const char achPersistentCacheMagic[8] =
+    { 'G', 'D', 'A', 'L', 'V', 'C', 'C', '1' };
+
+/************************************************************************/
+/*                    GetRegionFromPersistentCache()                    */
+/************************************************************************/
+
+const CachedRegion*
+VSICurlFilesystemHandler::GetRegionFromPersistentCache(const char* pszURL,
+                                                       vsi_l_offset nFileOffsetStart)
+{
+    CPLString osKey;
+    CPLString osFilename;
+    if( !GetPersistentCacheFilename(pszURL, nFileOffsetStart,
+                                    osKey, osFilename) )
+        return NULL;
+
+    VSILFILE* fp = VSIFOpenL(osFilename, "rb");
+    if( fp == NULL )
+        return NULL;
+
+    // File layout: magic, key size (LSB uint32), key, data size (LSB uint64),
+    // data.
+    bool bOK = false;
+    char achMagic[sizeof(achPersistentCacheMagic)];
+    GUInt32 nKeySize = 0;
+    GUIntBig nDataSize = 0;
+    char* pBuffer = NULL;
+    if( VSIFReadL(achMagic, sizeof(achMagic), 1, fp) == 1 &&
+        memcmp(achMagic, achPersistentCacheMagic, sizeof(achMagic)) == 0 &&
+        VSIFReadL(&nKeySize, sizeof(nKeySize), 1, fp) == 1 )
+    {
+        CPL_LSBPTR32(&nKeySize);
+        if( nKeySize == osKey.size() )
+        {
+            CPLString osKeyCached;
+            osKeyCached.resize(nKeySize);
+            if( VSIFReadL(&osKeyCached[0], 1, nKeySize, fp) == nKeySize &&
+                osKeyCached == osKey &&
+                VSIFReadL(&nDataSize, sizeof(nDataSize), 1, fp) == 1 )
+            {
+                CPL_LSBPTR64(&nDataSize);
+                if( nDataSize <= static_cast<GUIntBig>(GetDownloadChunkSize()) )
+                {
+                    const size_t nSize = static_cast<size_t>(nDataSize);
+                    pBuffer = static_cast<char*>(
+                        VSI_MALLOC_VERBOSE(std::max<size_t>(1, nSize)));
+                    bOK = pBuffer != NULL &&
+                          VSIFReadL(pBuffer, 1, nSize, fp) == nSize;
+                }
+            }
+        }
+    }
+    CPL_IGNORE_RET_VAL(VSIFCloseL(fp));
+
+    if( !bOK )
+    {
+        CPLFree(pBuffer);
+        return NULL;
+    }
+
+    // Update the modification time, which is used for the LRU eviction.
+#ifdef _WIN32
+    _utime(osFilename, NULL);
+#else
+    utime(osFilename, NULL);
+#endif
+
+    if (ENABLE_DEBUG)
+        CPLDebug("VSICURL", "Got data at offset " CPL_FRMT_GUIB
+                 " from persistent cache", nFileOffsetStart);
+
+    CPLMutexHolder oHolder( &hMutex );
+    const CachedRegion* psRegion =
+        AddRegionInMemory(pszURL, nFileOffsetStart,
+                          static_cast<size_t>(nDataSize), pBuffer);
+    CPLFree(pBuffer);
+    return psRegion;
+}
+
+/************************************************************************/
+/*                    AddRegionToPersistentCache()                      */
+/************************************************************************/
+
+void VSICurlFilesystemHandler::AddRegionToPersistentCache(const char* pszURL,
+                                                    vsi_l_offset nFileOffsetStart,
+                                                    size_t nSize,
+                                                    const char* pData)
+{
+    CPLString osKey;
+    CPLString osFilename;
+    if( !GetPersistentCacheFilename(pszURL, nFileOffsetStart,
+                                    osKey, osFilename) )
+        return;
+
+    const CPLString osCacheDir(
+        CPLGetConfigOption("CPL_VSIL_CURL_PERSISTENT_CACHE_DIR", ""));
+    const GIntBig nMaxSize = CPLAtoGIntBig(
+        CPLGetConfigOption("CPL_VSIL_CURL_PERSISTENT_CACHE_MAX_SIZE",
+                           "1073741824"));
+
+    // Other processes may be reading or writing the same file, so write a
+    // temporary file that is then atomically renamed.
+    static int nTempFileCounter = 0;
+    CPLString osTmpFilename;
+    osTmpFilename.Printf("%s.%d_%d.tmp", osFilename.c_str(),
+                         CPLGetCurrentProcessID(),
+                         CPLAtomicInc(&nTempFileCounter));
+
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    VSILFILE* fp = VSIFOpenL(osTmpFilename, "wb");
+    if( fp == NULL )
+    {
+        VSIMkdir(osCacheDir, 0755);
+        VSIMkdir(CPLGetPath(osFilename), 0755);
+        fp = VSIFOpenL(osTmpFilename, "wb");
+    }
+    CPLPopErrorHandler();
+    if( fp == NULL )
+    {
+        CPLDebug("VSICURL", "Cannot create %s", osTmpFilename.c_str());
+        return;
+    }
+
+    GUInt32 nKeySize = static_cast<GUInt32>(osKey.size());
+    CPL_LSBPTR32(&nKeySize);
+    GUIntBig nDataSize = nSize;
+    CPL_LSBPTR64(&nDataSize);
+    bool bOK =
+        VSIFWriteL(achPersistentCacheMagic,
+                   sizeof(achPersistentCacheMagic), 1, fp) == 1 &&
+        VSIFWriteL(&nKeySize, sizeof(nKeySize), 1, fp) == 1 &&
+        VSIFWriteL(osKey.c_str(), 1, osKey.size(), fp) == osKey.size() &&
+        VSIFWriteL(&nDataSize, sizeof(nDataSize), 1, fp) == 1 &&
+        (nSize == 0 || VSIFWriteL(pData, 1, nSize, fp) == nSize);
+    if( VSIFCloseL(fp) != 0 )
+        bOK = false;
+    if( !bOK || VSIRename(osTmpFilename, osFilename) != 0 )
+    {
+        VSIUnlink(osTmpFilename);
+        return;
+    }
+
+    if (ENABLE_DEBUG)
+        CPLDebug("VSICURL", "Write data at offset " CPL_FRMT_GUIB
+                 " to persistent cache", nFileOffsetStart);
+
+    // Trim the cache at the first write of the process, and then every time
+    // a tenth of its maximum size has been written.
+    bool bTrim = false;
+    {
+        CPLMutexHolder oHolder( &hMutex );
+        nPersistentCacheBytesWritten += static_cast<GIntBig>(nSize);
+        if( !bPersistentCacheTrimmed ||
+            nPersistentCacheBytesWritten > nMaxSize / 10 )
+        {
+            bPersistentCacheTrimmed = true;
+            nPersistentCacheBytesWritten = 0;
+            bTrim = true;
+        }
+    }
+    if( bTrim )
+        TrimPersistentCache(osCacheDir, nMaxSize);
+}
+
+/************************************************************************/
+/*                        TrimPersistentCache()                         */
+/************************************************************************/
+
+namespace {
+typedef struct
+{
+    GIntBig         nMTime;
+    GIntBig         nSize;
+    CPLString       osFilename;
+} PersistentCacheEntry;
+
+static bool ComparePersistentCacheEntry( const PersistentCacheEntry& a,
+                                         const PersistentCacheEntry& b )
+{
+    return a.nMTime < b.nMTime;
+}
+} // namespace
+
+// Remove the least recently used files until the size of the cache is below
+// nMaxSize. Several processes might do that at the same time, in which case
+// some of the unlinks will fail, which is harmless.
+void VSICurlFilesystemHandler::TrimPersistentCache(const CPLString& osCacheDir,
+                                                   GIntBig nMaxSize)
+{
+    std::vector<PersistentCacheEntry> asEntries;
+    GIntBig nTotalSize = 0;
+    const GIntBig nNow = static_cast<GIntBig>(time(NULL));
+
+    char** papszSubDirs = VSIReadDir(osCacheDir);
+    for( int i = 0; papszSubDirs != NULL && papszSubDirs[i] != NULL; i++ )
+    {
+        // Only consider the sub-directories created by
+        // GetPersistentCacheFilename().
+        if( strlen(papszSubDirs[i]) != 2 ||
+            !isxdigit(static_cast<unsigned char>(papszSubDirs[i][0])) ||
+            !isxdigit(static_cast<unsigned char>(papszSubDirs[i][1])) )
+            continue;
+        const CPLString osSubDir(
+            CPLFormFilename(osCacheDir, papszSubDirs[i], NULL));
+        char** papszFiles = VSIReadDir(osSubDir);
+        for( int j = 0; papszFiles != NULL && papszFiles[j] != NULL; j++ )
+        {
+            if( papszFiles[j][0] == '.' )
+                continue;
+            PersistentCacheEntry sEntry;
+            sEntry.osFilename = CPLFormFilename(osSubDir, papszFiles[j], NULL);
+            VSIStatBufL sStat;
+            if( VSIStatL(sEntry.osFilename, &sStat) != 0 ||
+                !VSI_ISREG(sStat.st_mode) )
+                continue;
+            // Leftovers of interrupted writes.
+            if( EQUAL(CPLGetExtension(papszFiles[j]), "tmp") )
+            {
+                if( nNow - static_cast<GIntBig>(sStat.st_mtime) > 3600 )
+                    VSIUnlink(sEntry.osFilename);
+                continue;
+            }
+            sEntry.nMTime = static_cast<GIntBig>(sStat.st_mtime);
+            sEntry.nSize = static_cast<GIntBig>(sStat.st_size);
+            nTotalSize += sEntry.nSize;
+            asEntries.push_back(sEntry);
+        }
+        CSLDestroy(papszFiles);
+    }
+    CSLDestroy(papszSubDirs);
+
+    if( nTotalSize <= nMaxSize )
+        return;
+
+    std::sort(asEntries.begin(), asEntries.end(), ComparePersistentCacheEntry);
+    int nRemoved = 0;
+    for( size_t i = 0; i < asEntries.size() && nTotalSize > nMaxSize; i++ )
+    {
+        VSIUnlink(asEntries[i].osFilename);
+        nTotalSize -= asEntries[i].nSize;
+        nRemoved ++;
+    }
+    CPLDebug("VSICURL", "Removed %d files from persistent cache %s",
+             nRemoved, osCacheDir.c_str());
 }
 
 /************************************************************************/
@@ -4265,7 +5009,18 @@ void VSICurlSetOptions(CURL* hCurlHandle, const char* pszURL)
  * Partial downloads (requires the HTTP server to support random reading) are done
  * with a 16 KB granularity by default. If the driver detects sequential reading
  * it will progressively increase the chunk size up to 2 MB to improve download
- * performance.
+ * performance. Starting with GDAL 2.2, the granularity can be changed with the
+ * CPL_VSIL_CURL_CHUNK_SIZE configuration option (in bytes, between 1 KB and
+ * 10 MB), the maximum size of sequential requests being 100 times this value.
+ *
+ * Starting with GDAL 2.2, reading of several non-contiguous ranges (for
+ * example several tiles of a GeoTIFF file through VSIFReadMultiRangeL()) is
+ * done with concurrent range requests. The number of requests in flight can be
+ * set with the CPL_VSIL_CURL_MAX_PARALLEL_REQUESTS configuration option
+ * (defaults to 10). Setting the GDAL_HTTP_MULTIRANGE configuration option to
+ * SERIAL will issue the requests one after the other, and setting it to
+ * SINGLE_GET will issue a single request with multiple ranges, which is the
+ * behaviour of previous versions.
  *
  * The GDAL_HTTP_PROXY, GDAL_HTTP_PROXYUSERPWD and GDAL_PROXY_AUTH configuration options can be
  * used to define a proxy server. The syntax to use is the one of Curl CURLOPT_PROXY,
@@ -4275,6 +5030,14 @@ void VSICurlSetOptions(CURL* hCurlHandle, const char* pszURL)
  * VSI_CACHE to TRUE. The cache size defaults to 25 MB, but can be modified by setting
  * the configuration option VSI_CACHE_SIZE (in bytes).
  *
+ * Starting with GDAL 2.2, downloaded chunks can also be kept in a persistent
+ * on-disk cache, shared by all processes using it, by setting the
+ * CPL_VSIL_CURL_PERSISTENT_CACHE_DIR configuration option to a directory.
+ * Chunks are only reused if the ETag (or the Last-Modified date) of the remote
+ * resource has not changed. The least recently used chunks are removed when
+ * the cache exceeds CPL_VSIL_CURL_PERSISTENT_CACHE_MAX_SIZE bytes (1 GB by
+ * default).
+ *
  * Starting with GDAL 2.1, /vsicurl/ will try to query directly redirected URLs to Amazon S3
  * signed URLs during their validity period, so as to minimize round-trips. This behaviour
  * can be disabled by setting the configuration option CPL_VSIL_CURL_USE_S3_REDIRECT to NO.
@@ -4316,6 +5079,10 @@ void VSIInstallCurlFileHandler(void)
  * If the driver detects sequential reading
  * it will progressively increase the chunk size up to 2 MB to improve download
  * performance.
+ * The CPL_VSIL_CURL_CHUNK_SIZE, CPL_VSIL_CURL_MAX_PARALLEL_REQUESTS,
+ * GDAL_HTTP_MULTIRANGE, CPL_VSIL_CURL_PERSISTENT_CACHE_DIR and
+ * CPL_VSIL_CURL_PERSISTENT_CACHE_MAX_SIZE configuration options described in
+ * VSIInstallCurlFileHandler() are also honoured.
  *
  * The AWS_SECRET_ACCESS_KEY and AWS_ACCESS_KEY_ID configuration options *must* be
  * set.